@@ -0,0 +1,28 @@
+// -------------------------------------------------------------------
+// Copyright (c) 2013-2022, AIT Austrian Institute of Technology GmbH.
+// All rights reserved. See file FMIPP_LICENSE for details.
+// -------------------------------------------------------------------
+
+/// \file FMIPPVariableCausality.h
+
+#ifndef _FMIPP_FMIPPVARIABLECAUSALITY_H
+#define _FMIPP_FMIPPVARIABLECAUSALITY_H
+
+/**
+ * \enum FMIPPVariableCausality FMIPPVariableCausality.h
+ * Enumerator for the causality of FMI model variables ( FMI 1.0 and 2.0 ).
+ */
+enum FMIPPVariableCausality {
+	fmippCausalityParameter = 0,
+	fmippCausalityCalculatedParameter = 1,
+	fmippCausalityInput = 2,
+	fmippCausalityOutput = 3,
+	fmippCausalityLocal = 4,
+	fmippCausalityIndependent = 5,
+	fmippCausalityInternal = 6, ///< FMI 1.0 only
+	fmippCausalityNone = 7, ///< FMI 1.0 only
+	fmippCausalityUnknown = 8
+};
+
+
+#endif // _FMIPP_FMIPPVARIABLECAUSALITY_H
@@ -0,0 +1,26 @@
+// -------------------------------------------------------------------
+// Copyright (c) 2013-2022, AIT Austrian Institute of Technology GmbH.
+// All rights reserved. See file FMIPP_LICENSE for details.
+// -------------------------------------------------------------------
+
+/// \file FMIPPVariableVariability.h
+
+#ifndef _FMIPP_FMIPPVARIABLEVARIABILITY_H
+#define _FMIPP_FMIPPVARIABLEVARIABILITY_H
+
+/**
+ * \enum FMIPPVariableVariability FMIPPVariableVariability.h
+ * Enumerator for the variability of FMI model variables ( FMI 1.0 and 2.0 ).
+ */
+enum FMIPPVariableVariability {
+	fmippVariabilityConstant = 0,
+	fmippVariabilityFixed = 1,
+	fmippVariabilityTunable = 2,
+	fmippVariabilityDiscrete = 3,
+	fmippVariabilityContinuous = 4,
+	fmippVariabilityParameter = 5, ///< FMI 1.0 only
+	fmippVariabilityUnknown = 6
+};
+
+
+#endif // _FMIPP_FMIPPVARIABLEVARIABILITY_H
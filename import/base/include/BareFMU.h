@@ -14,6 +14,9 @@
 #ifndef _FMIPP_BAREFMU_H
 #define _FMIPP_BAREFMU_H
 
+#include <memory>
+#include <string>
+
 #include "common/FMIPPConfig.h"
 #include "common/FMUType.h"
 #include "common/fmi_v1.0/fmi_me.h"
@@ -31,6 +34,15 @@ struct BareFMUModelExchange
 	/// Parsed XML model description.
 	ModelDescription* description;
 	
+	/// Path to the shared library.
+	std::string dllPath;
+
+	/// Path to the private copy of the shared library, deleted after unloading it ( empty if there is no such file ).
+	std::string dllCopyPath;
+
+	/// Bare FMU owning the model description, in case this bare FMU uses a private copy of its shared library.
+	std::shared_ptr<BareFMUModelExchange> sharedFMU;
+
 	/// Destructor.
 	~BareFMUModelExchange();
 };
@@ -47,6 +59,15 @@ struct BareFMUCoSimulation
 	/// URI to (unzipped) FMU archive.
 	std::string fmuLocation;
 	
+	/// Path to the shared library.
+	std::string dllPath;
+
+	/// Path to the private copy of the shared library, deleted after unloading it ( empty if there is no such file ).
+	std::string dllCopyPath;
+
+	/// Bare FMU owning the model description, in case this bare FMU uses a private copy of its shared library.
+	std::shared_ptr<BareFMUCoSimulation> sharedFMU;
+
 	/// Destructor.
 	~BareFMUCoSimulation();
 };
@@ -63,6 +84,18 @@ struct BareFMU2
 	/// URI to FMU resources directory.
 	std::string fmuResourceLocation;
 
+	/// Path to the shared library.
+	std::string dllPath;
+
+	/// Path to the private copy of the shared library, deleted after unloading it ( empty if there is no such file ).
+	std::string dllCopyPath;
+
+	/// Bare FMU owning the model description, in case this bare FMU uses a private copy of its shared library.
+	std::shared_ptr<BareFMU2> sharedFMU;
+
+	/// Bare FMU whose functions are called by helper processes, in case this bare FMU is forked ( see ForkedFMU.h ).
+	std::shared_ptr<BareFMU2> forkedFMU;
+
 	/// Destructor.
 	~BareFMU2();
 };
@@ -71,8 +104,6 @@ struct BareFMU2
 // Define smart pointers to bare FMUs.
 //
 
-#include <memory>
-
 typedef std::shared_ptr<BareFMUModelExchange> BareFMUModelExchangePtr;
 typedef std::shared_ptr<BareFMUCoSimulation> BareFMUCoSimulationPtr;
 typedef std::shared_ptr<BareFMU2> BareFMU2Ptr;
@@ -9,6 +9,8 @@
 //#include "import/integrators/include/IntegratorProperties.h"
 #include "common/fmi_v1.0/fmiModelTypes.h"
 #include "import/integrators/include/Integrator.h"
+#include "import/base/include/SparseJacobian.h"
+#include "import/base/include/ModelEvaluationCache.h"
 
 
 /**
@@ -99,6 +101,35 @@ public:
 	 */
 	virtual void getNumericalJacobian( fmippReal* J, const fmippReal* x, fmippReal* dfdt, const fmippTime t );
 
+	/// say whether the sparsity pattern of the jacobian is known ( from the model description )
+	fmippBoolean providesJacobianSparsity() const { return !jacobianSparsity_.isEmpty(); }
+
+	/// get the sparsity pattern of the jacobian ( empty if not available )
+	const SparseJacobian& getJacobianSparsity() const { return jacobianSparsity_; }
+
+	/**
+	 * get the sparse Jacobian for the current FMU state/time.
+	 *
+	 * The columns of the same color ( see class SparseJacobian ) are evaluated together, i.e.,
+	 * only one call to getDirectionalDerivatives is needed per color. If J is empty, it is
+	 * initialized with the sparsity pattern returned by getJacobianSparsity().
+	 *
+	 * \retval fmiOK       The jacobian has been computed without problems
+	 * \retval fmiDiscard  at least one call to getDirectionalDerivatives was not sucessfull.
+	 *                     The output J should not be used.
+	 * \retval fmiWarning  The jacobian or its sparsity pattern is not available.
+	 */
+	virtual fmippStatus getSparseJac( SparseJacobian& J );
+
+	/**
+	 * calculate the sparse numerical Jacobian
+	 *
+	 * Same as getNumericalJacobian, but all columns of the same color ( see class SparseJacobian )
+	 * are perturbed at once. If J is empty, it is initialized with the sparsity pattern returned
+	 * by getJacobianSparsity().
+	 */
+	virtual void getSparseNumericalJacobian( SparseJacobian& J, const fmippReal* x, fmippReal* dfdt, const fmippTime t );
+
 	/// check whether the sign of at least one event indicator changed since the last call
 	/// to saveEventIndicators()
 	fmippBoolean checkStateEvent();
@@ -122,17 +153,54 @@ public:
 		return integrator_->getProperties();
 	}
 
+	/// Number of RHS evaluations saved by continuing the integrator instead of restarting it
+	/// ( see Integrator::nSavedRHSEvaluations() ).
+	fmippSize nSavedRHSEvaluations() const {
+		return integrator_->nSavedRHSEvaluations();
+	}
+
+	/// Statistics about the reuse of Jacobians by implicit integrators
+	/// ( see Integrator::getJacobianStatistics() ).
+	Integrator::JacobianStatistics getJacobianStatistics() const {
+		return integrator_->getJacobianStatistics();
+	}
+
+	/// Statistics about the switching between nonstiff and stiff methods
+	/// ( see Integrator::getSwitchingStatistics() ).
+	Integrator::SwitchingStatistics getSwitchingStatistics() const {
+		return integrator_->getSwitchingStatistics();
+	}
+
+	/// Runtime statistics of the integrator, to be updated by its stepper and linear solver
+	/// ( see Integrator::getStatistics() ).
+	Integrator::Statistics& integratorStatistics() {
+		return integrator_->statistics();
+	}
+
 protected:
 	/// Integrator Instance
 	Integrator* integrator_;
 
+	/// Time, states, derivatives and event indicators last exchanged with the FMU
+	ModelEvaluationCache* evaluationCache_;
+
+	/// Restart the integrator and invalidate the evaluation cache, to be called whenever the
+	/// FMU has been changed by other means than setTime and setContinuousStates
+	void modelChanged();
+
 	/// Flag indicating whether the jacobian can be computed by the fmu
 	fmippBoolean providesJacobian_;
 
+	/// Sparsity pattern of the jacobian, empty if unknown
+	SparseJacobian jacobianSparsity_;
+
 	/// save current event indicators for later calls to checkStateEvent()
 	void saveEventIndicators();
 
 private:
+	/// calculate the derivative of the rhs with respect to time by finite differences
+	void getNumericalTimeDerivative( fmippReal* dfdt, fmippReal* dx, const fmippTime t );
+
 	/// Avoid naming conflict with FMUModelExchange::eventsind_
 	fmippReal* savedEventIndicators_;
 
@@ -0,0 +1,182 @@
+// -------------------------------------------------------------------
+// Copyright (c) 2013-2022, AIT Austrian Institute of Technology GmbH.
+// All rights reserved. See file FMIPP_LICENSE for details.
+// -------------------------------------------------------------------
+
+#ifndef _FMIPP_FMUARCHIVE_H
+#define _FMIPP_FMUARCHIVE_H
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/FMIPPConfig.h"
+
+/**
+ * \file FMUArchive.h
+ *
+ * \class FMUArchive FMUArchive.h
+ * Read access to FMU archives ( i.e., zip files with the extension ".fmu" ).
+ *
+ * The archive file is mapped into memory and its central directory is parsed on construction.
+ * Single entries ( e.g., the XML model description ) can be read directly from the archive,
+ * without extracting it. Entries may be stored or deflate-compressed, the latter is only
+ * supported if FMI++ has been built with zlib ( see CMake option INCLUDE_ZLIB ). ZIP64
+ * archives and encrypted entries are not supported.
+ *
+ * Extracted archives are kept in a cache directory, in a sub-directory named after the hash
+ * of the archive ( see getExtractionPath ). The hash is computed from the central directory,
+ * which contains the names, sizes and CRC-32 checksums of all entries. Hence, an archive is
+ * extracted only once, even if it is copied or loaded by several processes, and a changed
+ * archive is extracted into a new directory.
+ *
+ * Extracting is safe if several threads or processes extract the same archive concurrently:
+ * every file is written to a temporary file first, which is then renamed. Files that have
+ * been extracted before are skipped if their size and CRC-32 checksum match the entry in the
+ * central directory, otherwise they are extracted again. After all files have been extracted
+ * a marker file is written.
+ *
+ * Since the extracted shared libraries are loaded later on, the cache directory has to be
+ * private: directories are created accessible by the calling user only, and extracting fails
+ * if the cache directory or the extraction directory is not owned by the calling user or is
+ * writable by the group or others ( see makeCacheDirectory ).
+ */
+
+class __FMI_DLL FMUArchive
+{
+
+public:
+
+	/**
+	 * Constructor, opens the archive.
+	 *
+	 * @param[in]  archiveFilePath  path to the FMU archive
+	 */
+	FMUArchive( const fmippString& archiveFilePath );
+
+	/// Destructor.
+	~FMUArchive();
+
+	/// Check if the archive has been opened and its central directory is valid.
+	fmippBoolean isValid() const { return isValid_; }
+
+	/// Get the path of the archive file.
+	const fmippString& getFilePath() const { return archiveFilePath_; }
+
+	/// Get the 64-bit hash of the archive ( computed from its central directory ).
+	unsigned long long getHash() const { return hash_; }
+
+	/// Get the number of entries in the archive ( files and directories ).
+	fmippSize getNumberOfEntries() const { return entries_.size(); }
+
+	/// Get the name of an entry, i.e., its path relative to the root of the archive.
+	const fmippString& getEntryName( fmippSize i ) const { return entries_[i].name; }
+
+	/// Check if the archive contains an entry with the given name.
+	fmippBoolean hasEntry( const fmippString& name ) const;
+
+	/**
+	 * Read an entry of the archive into memory.
+	 *
+	 * @param[in]  name  name of the entry ( e.g., "modelDescription.xml" )
+	 * @param[out]  content  uncompressed content of the entry
+	 * @return false if the entry does not exist or cannot be read
+	 */
+	fmippBoolean read( const fmippString& name, fmippString& content ) const;
+
+	/**
+	 * Get the path of the directory into which this archive is extracted.
+	 *
+	 * @param[in]  cacheDirectory  path of the cache directory for extracted archives
+	 * @return path of the sub-directory named after the hash of the archive
+	 */
+	fmippString getExtractionPath( const fmippString& cacheDirectory ) const;
+
+	/**
+	 * Extract all entries of the archive into a directory ( see getExtractionPath ).
+	 * Missing directories are created. Files that already exist with the correct
+	 * size and checksum are skipped.
+	 *
+	 * @param[in]  directory  path of the destination directory
+	 * @param[out]  nExtracted  number of files written ( optional )
+	 * @return false if extracting failed or if the destination directory is not private
+	 */
+	fmippBoolean extract( const fmippString& directory, fmippSize* nExtracted = 0 ) const;
+
+	/// Check if a path ( or URL ) refers to an FMU archive, i.e., if it has the extension ".fmu".
+	static fmippBoolean isArchive( const fmippString& path );
+
+	/**
+	 * Get the default cache directory for extracted archives, which is specific to the calling user:
+	 * "$XDG_CACHE_HOME/fmipp" or "$HOME/.cache/fmipp", or "fmipp-<uid>" in the temporary directory
+	 * if neither variable is set ( Windows: "fmipp-fmus" in the temporary directory of the user ).
+	 */
+	static fmippString getDefaultCacheDirectory();
+
+	/**
+	 * Create a cache directory for extracted archives ( accessible by the calling user only ),
+	 * if it does not exist.
+	 *
+	 * @param[in]  cacheDirectory  path of the cache directory
+	 * @return false if the directory cannot be created, is not owned by the calling user or is
+	 * writable by the group or others
+	 */
+	static fmippBoolean makeCacheDirectory( const fmippString& cacheDirectory );
+
+	/// Name of the marker file written after an archive has been extracted completely.
+	static const char* const extractionCompleteFileName;
+
+private:
+
+	/// Description of an archive entry ( from the central directory ).
+	struct Entry
+	{
+		fmippString name; ///< Name of the entry ( with '/' as separator ).
+		unsigned int method; ///< Compression method ( 0: stored, 8: deflated ).
+		unsigned int flags; ///< General purpose bit flags.
+		unsigned int crc; ///< CRC-32 checksum of the uncompressed content.
+		fmippSize compressedSize; ///< Size of the compressed content.
+		fmippSize uncompressedSize; ///< Size of the uncompressed content.
+		fmippSize localHeaderOffset; ///< Offset of the local file header.
+		unsigned int mode; ///< Unix file permissions ( 0 if not available ).
+	};
+
+	/// Parse the central directory of the archive.
+	fmippBoolean parse();
+
+	/// Get the index of an entry, returns the number of entries if it does not exist.
+	fmippSize find( const fmippString& name ) const;
+
+	/**
+	 * Decompress an entry and pass the content ( in chunks ) to a function.
+	 * Fails if the function returns false or if the checksum does not match.
+	 */
+	fmippBoolean decompress( const Entry& entry,
+		const std::function<bool( const char*, fmippSize )>& write ) const;
+
+	/// Check if a file exists and has the size and checksum of an entry.
+	static fmippBoolean isExtracted( const Entry& entry, const fmippString& filePath );
+
+	/// Extract a single file entry, unless it exists already.
+	fmippBoolean extractFile( const Entry& entry, const fmippString& directory,
+		fmippSize* nExtracted ) const;
+
+	struct Mapping; ///< Memory mapping of the archive file.
+
+	fmippString archiveFilePath_; ///< Path of the archive file.
+
+	std::unique_ptr<Mapping> mapping_; ///< Memory mapping of the archive file.
+
+	const unsigned char* data_; ///< Content of the archive file.
+
+	fmippSize size_; ///< Size of the archive file.
+
+	std::vector<Entry> entries_; ///< Entries of the archive.
+
+	unsigned long long hash_; ///< Hash of the archive.
+
+	fmippBoolean isValid_; ///< Flag indicating whether the archive is valid.
+};
+
+#endif // _FMIPP_FMUARCHIVE_H
@@ -6,9 +6,13 @@
 #ifndef _FMIPP_FMUBASE_H
 #define _FMIPP_FMUBASE_H
 
+#include <vector>
+
 #include "common/FMIPPConfig.h"
 
+class FMUSnapshot;
 class ModelDescription;
+template<typename Type> class VariableHandle;
 
 /**
  * \file FMUBase.h
@@ -59,6 +63,13 @@ public:
 	/// Get type of variable.
 	virtual FMIPPVariableType getType( const fmippString& variableName ) const = 0;
 
+	/**
+	 * Resolve a variable name once, values can then be accessed via the returned handle
+	 * without further lookups ( see VariableHandle.h, which has to be included ).
+	 * The handle is invalid if the variable does not exist or has a different type.
+	 */
+	template<typename Type> VariableHandle<Type> resolve( const fmippString& name );
+
 
 	/// Get the status of the last operation on the FMU.
 	virtual fmippStatus getLastStatus() const = 0;
@@ -157,6 +168,39 @@ public:
 
 	/// Call logger to issue a debug message.
 	virtual void sendDebugMessage( const fmippString& msg ) const = 0;
+
+#ifndef SWIG
+	/// Check if the state of the FMU can be retrieved and restored ( FMI 2.0 only ).
+	virtual fmippBoolean canGetAndSetFMUstate() const { return fmippFalse; }
+
+	/// Check if the state of the FMU can be serialized ( FMI 2.0 only ).
+	virtual fmippBoolean canSerializeFMUstate() const { return fmippFalse; }
+
+	/**
+	 * Take a snapshot of the current state of the FMU ( see FMUSnapshot.h, which has to be
+	 * included ). If the snapshot already holds a state of this instance, its memory is reused.
+	 *
+	 * \retval fmippError  the FMU cannot get and set its state or has not been instantiated
+	 */
+	virtual fmippStatus getSnapshot( FMUSnapshot& snapshot ) { return fmippError; }
+
+	/// Restore the state of the FMU from a snapshot taken by this instance.
+	virtual fmippStatus setSnapshot( const FMUSnapshot& snapshot ) { return fmippError; }
+
+	/// Get the size of a snapshot taken by this instance when it is serialized ( in bytes ).
+	virtual fmippStatus getSnapshotSize( const FMUSnapshot& snapshot, fmippSize& size ) { return fmippError; }
+
+	/// Serialize a snapshot taken by this instance into a byte buffer.
+	virtual fmippStatus serializeSnapshot( const FMUSnapshot& snapshot, std::vector<fmippChar>& buffer ) {
+		return fmippError;
+	}
+
+	/// Create a snapshot of this instance from a byte buffer written by serializeSnapshot,
+	/// possibly by another instance of the same FMU.
+	virtual fmippStatus deserializeSnapshot( const std::vector<fmippChar>& buffer, FMUSnapshot& snapshot ) {
+		return fmippError;
+	}
+#endif
 };
 
 
@@ -6,6 +6,10 @@
 #ifndef _FMIPP_FMUCOSIMULATIONBASE_H
 #define _FMIPP_FMUCOSIMULATIONBASE_H
 
+#ifndef SWIG
+#include <future>
+#endif
+
 #include "import/base/include/FMUBase.h"
 
 /**
@@ -78,6 +82,28 @@ public:
 		fmippReal communicationStepSize,
 		fmippBoolean newStep ) = 0;
 
+#ifndef SWIG
+	/// Handle of an asynchronous communication step, ready with the status of doStep(...) when the step is finished.
+	typedef std::shared_future<fmippStatus> StepFuture;
+
+	/**
+	 * Start doStep(...) and return without waiting for the step to finish. The step is executed by a
+	 * worker thread of this instance. FMUs that can run asynchronously ( see canRunAsynchronuously() )
+	 * execute the step themselves, the worker thread then only waits for them to finish. Hence, the steps
+	 * of several instances can overlap. No other function of this instance must be called before the
+	 * returned handle is ready.
+	 *
+	 * @param[in]  currentCommunicationPoint  current communication point of the master
+	 * @param[in]  communicationStepSize  communication step size
+	 * @param[in]  newStep  is true (fmiTrue) if the last communication step is accepted by the
+	 *             master and a new communication step is started
+	 * @return handle of the step
+	 */
+	virtual StepFuture doStepAsync( fmippReal currentCommunicationPoint,
+		fmippReal communicationStepSize,
+		fmippBoolean newStep ) = 0;
+#endif
+
 	/**
 	 * Provide basic information about FMU implementation from model description.
 	 */
@@ -8,12 +8,14 @@
 
 #include <cstdio>
 #include <map>
+#include <memory>
 #include <stdexcept>
 
 #include "import/base/include/BareFMU.h"
 #include "import/base/include/FMUCoSimulationBase.h"
 
 class ModelDescription;
+class StepWorker;
 
 /**
  * \file FMUCoSimulation_v1.h 
@@ -35,7 +37,7 @@ public:
 	/**
 	 * Constructor. Loads the FMU via the model manager (if needed).
 	 *
-	 * @param[in]  fmuDirUri             path to unzipped FMU directory (as URI)
+	 * @param[in]  fmuDirUri             path to unzipped FMU directory or FMU archive (as URI)
 	 * @param[in]  modelIdentifier       FMI model identifier
 	 * @param[in]  loggingOn             if true, tell the FMU to log all calls to the fmiXXX functons
 	 * @param[in]  timeDiffResolution    resolution for comparing the master time with the slave time.
@@ -81,6 +83,13 @@ public:
 		fmippTime communicationStepSize,
 		fmippBoolean newStep );
 
+#ifndef SWIG
+	/// \copydoc FMUCoSimulationBase::doStepAsync
+	virtual StepFuture doStepAsync( fmippTime currentCommunicationPoint,
+		fmippTime communicationStepSize,
+		fmippBoolean newStep );
+#endif
+
 	/// \copydoc FMUBase::getTime()
 	virtual fmippReal getTime() const;
 
@@ -249,16 +258,16 @@ private:
 
 	cs::fmiCallbackFunctions callbacks_; ///< Internal struct to callback functions.
 
-	/// \FIXME Maps should be handled via ModelManager, to avoid duplication 
-	///        of this (potentially large) map with every instance.
-	std::map<fmippString,fmippValueReference> varMap_;  ///< Maps variable names and value references.
-	std::map<fmippString,FMIPPVariableType> varTypeMap_; ///< Maps variable names and their types.
-
 	fmippTime time_; ///< Internal time.
 	const fmippTime timeDiffResolution_; ///< Internal time resolution.
 
 	fmiStatus lastStatus_; ///< Last status returned by the FMU.
 
+	std::unique_ptr<StepWorker> stepWorker_; ///< Executes asynchronous steps, started with the first one.
+
+	/// Wait until a step executed asynchronously by the FMU is finished, then advance the time.
+	fmippStatus finishStep( fmippTime communicationStepSize );
+
 	void readModelDescription(); ///< Read the model description.
 
 };
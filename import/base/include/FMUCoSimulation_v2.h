@@ -9,12 +9,16 @@
 
 #include <cstdio>
 #include <map>
+#include <memory>
 #include <stdexcept>
+#include <vector>
 
 #include "import/base/include/BareFMU.h"
 #include "import/base/include/FMUCoSimulationBase.h"
+#include "import/base/include/FMUSnapshot.h"
 
 class ModelDescription;
+class StepWorker;
 
 
 /**
@@ -34,7 +38,7 @@ public:
 	/**
 	 * Constructor. Loads the FMU via the model manager (if needed).
 	 *
-	 * @param[in]  fmuDirUri             path to unzipped FMU directory (as URI)
+	 * @param[in]  fmuDirUri             path to unzipped FMU directory or FMU archive (as URI)
 	 * @param[in]  modelIdentifier       FMI model identifier
 	 * @param[in]  loggingOn             if true, tell the FMU to log all calls to the fmiXXX functons
 	 * @param[in]  timeDiffResolution    resolution for comparing the master time with the slave time.
@@ -75,11 +79,50 @@ public:
 		const fmippBoolean stopTimeDefined,
 		const fmippReal stopTime );
 
+	/**
+	 * Reset the FMU instance ( calls fmi2Reset ). Afterwards, the instance is in the same state as
+	 * after calling instantiate, i.e., all variables have their start values and the instance can be
+	 * initialized again.
+	 *
+	 * @return the status of fmi2Reset
+	 */
+	virtual fmippStatus reset();
+
+#ifndef SWIG
+	/// \copydoc FMUBase::canGetAndSetFMUstate
+	virtual fmippBoolean canGetAndSetFMUstate() const;
+
+	/// \copydoc FMUBase::canSerializeFMUstate
+	virtual fmippBoolean canSerializeFMUstate() const;
+
+	/// \copydoc FMUBase::getSnapshot
+	virtual fmippStatus getSnapshot( FMUSnapshot& snapshot );
+
+	/// \copydoc FMUBase::setSnapshot
+	virtual fmippStatus setSnapshot( const FMUSnapshot& snapshot );
+
+	/// \copydoc FMUBase::getSnapshotSize
+	virtual fmippStatus getSnapshotSize( const FMUSnapshot& snapshot, fmippSize& size );
+
+	/// \copydoc FMUBase::serializeSnapshot
+	virtual fmippStatus serializeSnapshot( const FMUSnapshot& snapshot, std::vector<fmippChar>& buffer );
+
+	/// \copydoc FMUBase::deserializeSnapshot
+	virtual fmippStatus deserializeSnapshot( const std::vector<fmippChar>& buffer, FMUSnapshot& snapshot );
+#endif
+
 	/// \copydoc FMUCoSimulationBase::doStep
 	virtual fmippStatus doStep( fmippTime currentCommunicationPoint,
 		fmippTime communicationStepSize,
 		fmippBoolean newStep );
 
+#ifndef SWIG
+	/// \copydoc FMUCoSimulationBase::doStepAsync
+	virtual StepFuture doStepAsync( fmippTime currentCommunicationPoint,
+		fmippTime communicationStepSize,
+		fmippBoolean newStep );
+#endif
+
 	/// \copydoc FMUBase::getTime()
 	virtual fmippReal getTime() const;
 
@@ -253,16 +296,18 @@ private:
 
 	fmi2::fmi2CallbackFunctions callbacks_; ///< Internal struct to callback functions.
 
-	/// \FIXME Maps should be handled via ModelManager, to avoid duplication 
-	///        of this (potentially large) map with every instance.
-	std::map<fmippString,fmippValueReference> varMap_;  ///< Maps variable names and value references.
-	std::map<fmippString,FMIPPVariableType> varTypeMap_; ///< Maps variable names and their types.
-
 	fmippTime time_; ///< Internal time.
 	const fmippTime timeDiffResolution_; ///< Internal time resolution.
 
 	fmi2Status lastStatus_; ///< Last status returned by the FMU.
 
+	std::unique_ptr<StepWorker> stepWorker_; ///< Executes asynchronous steps, started with the first one.
+
+	/// Wait until a step executed asynchronously by the FMU is finished, then advance the time.
+	fmippStatus finishStep( fmippTime communicationStepSize );
+
+	std::shared_ptr<FMUSnapshot::Deleter> stateDeleter_; ///< Frees states of the instance, reset before the instance is freed.
+
 	void readModelDescription(); ///< Read the model description.
 
 };
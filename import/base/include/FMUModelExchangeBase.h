@@ -162,6 +162,18 @@ public:
 		return integrator_->getProperties();
 	}
 
+	/// \copydoc Integrator::getStatistics
+	IntegratorStatistics getIntegratorStatistics() const {
+		assert( integrator_ );
+		return integrator_->getStatistics();
+	}
+
+	/// \copydoc Integrator::resetStatistics
+	void resetIntegratorStatistics() {
+		assert( integrator_ );
+		integrator_->resetStatistics();
+	}
+
  protected:
 
 	const fmippBoolean loggingOn_;
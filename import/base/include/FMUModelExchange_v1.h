@@ -37,7 +37,7 @@ public:
 	/**
 	 * Constructor. Loads the FMU via the model manager (if needed).
 	 *
-	 * @param[in]  fmuDirUri             path to unzipped FMU directory (as URI)
+	 * @param[in]  fmuDirUri             path to unzipped FMU directory or FMU archive (as URI)
 	 * @param[in]  modelIdentifier       FMI model identifier
 	 * @param[in]  loggingOn             if true, tell the FMU to log all calls to the fmiXXX functons
 	 * @param[in]  stopBeforeEvent       if true, integration stops immediately before an event
@@ -297,11 +297,6 @@ private:
 	fmippSize nEventInds_; ///< Number of event indivators.
 	fmippSize nValueRefs_; ///< Number of value references.
 
-	/// \FIXME Maps should be handled via ModelManager, to avoid duplication 
-	///        of this (potentially large) map with every instance.
-	std::map<fmippString,fmippValueReference> varMap_; /// Maps variable names and value references.
-	std::map<fmippString,FMIPPVariableType> varTypeMap_; /// Maps variable names and their types.
-
 	fmiBoolean stopBeforeEvent_; ///< Flag determining internal event handling.
 
 	fmippTime eventSearchPrecision_; ///< Search precision for events.
@@ -8,10 +8,12 @@
 
 #include <cstdio>
 #include <map>
+#include <memory>
 #include <vector>
 
 #include "import/base/include/BareFMU.h"
 #include "import/base/include/FMUModelExchangeBase.h"
+#include "import/base/include/FMUSnapshot.h"
 #include "import/integrators/include/Integrator.h"
 
 struct BareFMU2;
@@ -29,6 +31,8 @@ struct BareFMU2;
 
 namespace fmi_2_0{
 
+class SensitivitySystem;
+
 class __FMI_DLL FMUModelExchange : public FMUModelExchangeBase
 {
 
@@ -37,7 +41,7 @@ public:
 	/**
 	 * Constructor. Loads the FMU via the model manager (if needed).
 	 *
-	 * @param[in]  fmuDirUri             path to unzipped FMU directory (as URI)
+	 * @param[in]  fmuDirUri             path to unzipped FMU directory or FMU archive (as URI)
 	 * @param[in]  modelIdentifier       FMI model identifier
 	 * @param[in]  loggingOn             if true, tell the FMU to log all calls to the fmi2XXX functons
 	 * @param[in]  stopBeforeEvent       if true, integration stops immediately before an event
@@ -84,12 +88,76 @@ public:
 	/// Destructor.
 	virtual ~FMUModelExchange();
 
+#ifndef SWIG
+	/**
+	 * Create several instances of the same FMU at once, e.g., for ensemble simulations. Requires
+	 * the FMU to be already loaded (via the model manager).
+	 *
+	 * The model description is evaluated only once, all instances share the extracted information.
+	 * The internal buffers of all instances ( states, derivatives and event indicators ) are
+	 * allocated in a single block, which stores the states of all instances contiguously, followed
+	 * by the derivatives of all instances, and so on. The instances still have to be instantiated.
+	 *
+	 * @param[in]  modelIdentifier       FMI model identifier.
+	 * @param[in]  nInstances            number of instances
+	 * @param[in]  loggingOn             if true, tell the FMU to log all calls to the fmi2XXX functons
+	 * @param[in]  stopBeforeEvent       if true, integration stops immediately before an event
+	 * @param[in]  eventSearchPrecision  numerical search precision for events during integration
+	 * @param[in]  type                  the numerical method for solving ODEs
+	 * @return the instances, an empty vector if the FMU has not been loaded
+	 */
+	static std::vector< std::unique_ptr<FMUModelExchange> > createInstances(
+		const fmippString& modelIdentifier,
+		const fmippSize nInstances,
+		const fmippBoolean loggingOn = fmippFalse,
+		const fmippBoolean stopBeforeEvent = fmippFalse,
+		const fmippTime eventSearchPrecision = 1e-4,
+#ifdef USE_SUNDIALS
+		const IntegratorType type = IntegratorType::bdf
+#else
+		const IntegratorType type = IntegratorType::dp
+#endif
+	);
+#endif
+
 	/// @copydoc FMUModelExchangeBase::instantiate
 	virtual fmippStatus instantiate( const fmippString& instanceName );
 
 	/// \copydoc FMUModelExchangeBase::initialize
 	virtual fmippStatus initialize( fmippBoolean toleranceDefined = false, fmippReal tolerance = 1e-5 );
 
+	/**
+	 * Reset the FMU instance ( calls fmi2Reset ). Afterwards, the instance is in the same state as
+	 * after calling instantiate, i.e., all variables have their start values and the instance can be
+	 * initialized again. This is much cheaper than creating a new instance for many FMUs.
+	 *
+	 * @return the status of fmi2Reset
+	 */
+	virtual fmippStatus reset();
+
+#ifndef SWIG
+	/// \copydoc FMUBase::canGetAndSetFMUstate
+	virtual fmippBoolean canGetAndSetFMUstate() const;
+
+	/// \copydoc FMUBase::canSerializeFMUstate
+	virtual fmippBoolean canSerializeFMUstate() const;
+
+	/// \copydoc FMUBase::getSnapshot
+	virtual fmippStatus getSnapshot( FMUSnapshot& snapshot );
+
+	/// \copydoc FMUBase::setSnapshot
+	virtual fmippStatus setSnapshot( const FMUSnapshot& snapshot );
+
+	/// \copydoc FMUBase::getSnapshotSize
+	virtual fmippStatus getSnapshotSize( const FMUSnapshot& snapshot, fmippSize& size );
+
+	/// \copydoc FMUBase::serializeSnapshot
+	virtual fmippStatus serializeSnapshot( const FMUSnapshot& snapshot, std::vector<fmippChar>& buffer );
+
+	/// \copydoc FMUBase::deserializeSnapshot
+	virtual fmippStatus deserializeSnapshot( const std::vector<fmippChar>& buffer, FMUSnapshot& snapshot );
+#endif
+
 	/// \copydoc FMUModelExchangeBase::getContinuousStates
 	virtual fmippStatus getContinuousStates( fmippReal* val );
 
@@ -108,6 +176,9 @@ public:
 	/// \copydoc DynamicalSystem::getJac( fmippReal* J )
 	virtual	fmippStatus getJac( fmippReal* J );
 
+	/// \copydoc DynamicalSystem::getSparseJac( SparseJacobian& J )
+	virtual	fmippStatus getSparseJac( SparseJacobian& J );
+
 	/// \copydoc FMUModelExchangeBase::getEventIndicators
 	virtual fmippStatus getEventIndicators( fmippReal* eventsind );
 
@@ -305,8 +376,70 @@ public:
 
 	fmippBoolean stepOverEvent(); ///< Make a step from tLower_ to tUpper_ using explicit euler here, tLower and tUpper are provided by the Integrator.
 
+	/**
+	 * Enable the forward sensitivity analysis with respect to the given real parameters.
+	 *
+	 * The continuous states are augmented by their sensitivities \f$ S = dx/dp \f$, which are
+	 * integrated together with the states by the current stepper according to
+	 *
+	 *        \f[ \dot{S}_k = \frac{\partial f}{\partial x} S_k + \frac{\partial f}{\partial p_k} \f]
+	 *
+	 * The right-hand side is evaluated with one call to fmi2GetDirectionalDerivative per
+	 * parameter ( seeded with \f$ S_k \f$ and the parameter itself ) or, if the FMU does not
+	 * provide directional derivatives with respect to its parameters, with central finite
+	 * differences along the same direction. The latter require an FMU that accepts fmi2SetReal
+	 * for the parameters in continuous time mode.
+	 *
+	 * The sensitivities are initialized with zero ( see setStateSensitivities() ) and are not
+	 * changed by events. The integrator of the augmented system starts with the properties of
+	 * the current integrator and with new statistics.
+	 *
+	 * \retval fmippOK     the sensitivities are enabled
+	 * \retval fmippError  the FMU has not been instantiated, has no continuous states, or one of
+	 *                     the names does not refer to a real variable
+	 */
+	fmippStatus enableSensitivities( const std::vector<fmippString>& parameters );
+
+	/// Disable the forward sensitivity analysis and go back to the integration of the states only.
+	void disableSensitivities();
+
+	/// Returns true iff the forward sensitivity analysis is enabled.
+	fmippBoolean sensitivitiesEnabled() const { return 0 != sensitivities_; }
+
+	/**
+	 * Get the sensitivities of the states with respect to the parameters given to
+	 * enableSensitivities(), stored parameter by parameter, i.e.,
+	 *
+	 *        \f[ dxdp[ nStates*k + i ] = \frac{\partial x_i}{\partial p_k} \f]
+	 */
+	fmippStatus getStateSensitivities( std::vector<fmippReal>& dxdp ) const;
+
+	/// Set the sensitivities of the states ( same layout as for getStateSensitivities() ),
+	/// e.g., to the unit vector for a parameter defining the start value of a state.
+	fmippStatus setStateSensitivities( const std::vector<fmippReal>& dxdp );
+
+	/**
+	 * Get the sensitivities of real outputs ( or any other real variables ) at the current time,
+	 * stored parameter by parameter, i.e.,
+	 *
+	 *        \f[ dydp[ nOutputs*k + j ] = \frac{\partial y_j}{\partial x} S_k + \frac{\partial y_j}{\partial p_k} \f]
+	 */
+	fmippStatus getOutputSensitivities( const std::vector<fmippString>& outputs,
+		std::vector<fmippReal>& dydp );
+
 private:
 
+	friend class SensitivitySystem;
+
+	/// Evaluate the sensitivities of the variables with value references unknownRefs for
+	/// the state sensitivities S ( see getOutputSensitivities() ).
+	fmippStatus getSensitivities( const fmippValueReference* unknownRefs, fmippSize nUnknowns,
+		const fmippReal* S, fmippReal* result );
+
+	/// Same as getSensitivities(), but with central finite differences.
+	fmippStatus getSensitivitiesByFiniteDifferences( const fmippValueReference* unknownRefs,
+		fmippSize nUnknowns, const fmippReal* S, fmippReal* result );
+
 	fmi2Status enterContinuousTimeMode(); ///< Change the mode of the FMU to ContinuousTimeMode.
 	fmi2Status enterEventMode(); ///< Change the mode of the FMU to EventMode.
 
@@ -324,13 +457,8 @@ private:
 	fmippSize nEventInds_; ///< Number of event indivators.
 	fmippSize nValueRefs_; ///< Number of value references.
 
-	fmippValueReference* derivatives_refs_; ///< Vector containing the value references of all derivatives
-	fmippValueReference* states_refs_; ///< Vector containing the value references of all states
-
-	/// \FIXME Maps should be handled via ModelManager, to avoid duplication
-	///        of this (potentially large) map with every instance.
-	std::map<fmippString,fmippValueReference> varMap_; ///< Maps variable names and value references.
-	std::map<fmippString,FMIPPVariableType> varTypeMap_; ///< Maps variable names and their types.
+	const fmippValueReference* derivatives_refs_; ///< Vector containing the value references of all derivatives
+	const fmippValueReference* states_refs_; ///< Vector containing the value references of all states
 
 	fmi2Boolean stopBeforeEvent_; ///< Flag determining internal event handling.
 
@@ -361,13 +489,41 @@ private:
 
 	fmi2Status lastStatus_; ///< Last status returned from an FMI function.
 
+	std::shared_ptr<FMUSnapshot::Deleter> stateDeleter_; ///< Frees states of the instance, reset before the instance is freed.
+
+	/// Information extracted from the model description, shared by all copies of an instance.
+	struct Metadata
+	{
+		fmippSize nStateVars; ///< Number of state variables.
+		fmippSize nEventInds; ///< Number of event indicators.
+		fmippSize nValueRefs; ///< Number of value references.
+		fmippBoolean providesJacobian; ///< Flag indicating whether directional derivatives are provided.
+		std::vector<fmippValueReference> derivativesRefs; ///< Value references of all derivatives.
+		std::vector<fmippValueReference> statesRefs; ///< Value references of all states.
+		SparseJacobian jacobianSparsity; ///< Sparsity pattern of the Jacobian ( empty if not available ).
+		fmippTime startTime; ///< Start time of the default experiment ( NaN if not available ).
+		fmippReal tolerance; ///< Tolerance of the default experiment ( NaN if not available ).
+	};
+
+	std::shared_ptr<const Metadata> metadata_; ///< Information extracted from the model description.
+
+	/// Internal buffers of several instances ( see createInstances ), 0 if the buffers are owned by this instance.
+	std::shared_ptr<fmi2Real> arena_;
+
 	void readModelDescription(); ///< Extract specific information from the mode description.
 
+	void applyMetadata(); ///< Set up this instance using the information extracted from the model description.
+
 	static const fmippSize maxEventIterations_ = 5; ///< Maximum number of internal event iterations.
 
 	/// upper limit for the next event time
 	fmippTime tend_; ///< in case of an int event, tend_ gives is used as an upper limit for the event time
 
+	SensitivitySystem* sensitivities_; ///< States augmented by their sensitivities, 0 if disabled.
+	Integrator* stateIntegrator_; ///< Integrator of the states only, kept while the sensitivities are enabled.
+	std::vector<fmippValueReference> sensitivityRefs_; ///< Value references of the parameters.
+	fmippBoolean sensitivityDirectionalDerivatives_; ///< False once the FMU refused a directional derivative.
+
 };
 
 } // namespace fmi_2_0
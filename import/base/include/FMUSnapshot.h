@@ -0,0 +1,101 @@
+// -------------------------------------------------------------------
+// Copyright (c) 2013-2022, AIT Austrian Institute of Technology GmbH.
+// All rights reserved. See file FMIPP_LICENSE for details.
+// -------------------------------------------------------------------
+
+#ifndef _FMIPP_FMUSNAPSHOT_H
+#define _FMIPP_FMUSNAPSHOT_H
+
+#include <functional>
+#include <memory>
+
+#include "common/FMIPPConfig.h"
+
+namespace fmi_2_0 {
+	class FMUModelExchange;
+	class FMUCoSimulation;
+}
+
+/**
+ * \file FMUSnapshot.h
+ *
+ * \class FMUSnapshot FMUSnapshot.h
+ * Handle of a state of an FMU instance ( FMI 2.0 FMUstate ), see FMUBase::getSnapshot.
+ *
+ * A snapshot owns the FMU state and frees it ( fmi2FreeFMUstate ) when it is destroyed or
+ * reset. Snapshots can be moved but not copied. Besides the FMU state, a snapshot contains
+ * the internal state of the wrapper that created it ( e.g., the time ), which is restored
+ * together with the FMU state. A snapshot can only be restored by the instance that created it.
+ * Snapshots that outlive their instance become invalid and do not free their state anymore.
+ */
+class __FMI_DLL FMUSnapshot
+{
+
+public:
+
+	/// Constructor. Creates an empty snapshot.
+	FMUSnapshot();
+
+	/// Move constructor.
+	FMUSnapshot( FMUSnapshot&& snapshot );
+
+	/// Move assignment, frees the state held before.
+	FMUSnapshot& operator=( FMUSnapshot&& snapshot );
+
+	/// Destructor. Frees the state.
+	~FMUSnapshot();
+
+	/// Check whether the snapshot holds a state of an existing instance.
+	fmippBoolean isValid() const;
+
+	/// Get the time of the instance when the snapshot has been taken.
+	fmippTime getTime() const { return time_; }
+
+	/// Free the state, the snapshot is empty afterwards.
+	void reset();
+
+	/// Size of the internal state of the wrapper in serialized snapshots.
+	static const fmippSize headerSize;
+
+private:
+
+	friend class fmi_2_0::FMUModelExchange;
+	friend class fmi_2_0::FMUCoSimulation;
+
+	/// Function freeing a state of the instance that created the snapshot.
+	typedef std::function<void( void* )> Deleter;
+
+	/// Constructor, takes ownership of a state.
+	FMUSnapshot( void* state, const void* owner, const std::shared_ptr<Deleter>& deleter );
+
+	/// State that the instance owner may reuse for a new snapshot, 0 if there is none.
+	void* reusableState( const void* owner ) const;
+
+	/// Hold a state returned by the instance owner, which may have reused the state held before.
+	void take( void* state, const void* owner, const std::shared_ptr<Deleter>& deleter );
+
+	/// Write the internal state of the wrapper ( headerSize bytes ).
+	void writeHeader( fmippChar* buffer ) const;
+
+	/// Read the internal state of the wrapper ( headerSize bytes ).
+	void readHeader( const fmippChar* buffer );
+
+	void* state_; ///< The FMU state.
+
+	const void* owner_; ///< Instance that created the snapshot.
+
+	std::weak_ptr<Deleter> deleter_; ///< Frees the FMU state, expires together with the instance.
+
+	fmippTime time_; ///< Time of the instance.
+
+	fmippTime nextEventTime_; ///< Time of the next time event ( ME only ).
+
+	fmippBoolean nextEventTimeDefined_; ///< Flag indicating whether a time event is scheduled ( ME only ).
+
+	fmippBoolean upcomingEvent_; ///< Flag indicating an event to be handled before integrating ( ME only ).
+
+	FMUSnapshot( const FMUSnapshot& ); ///< Prevent copying.
+	FMUSnapshot& operator=( const FMUSnapshot& ); ///< Prevent copying.
+};
+
+#endif // _FMIPP_FMUSNAPSHOT_H
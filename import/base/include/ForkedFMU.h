@@ -0,0 +1,66 @@
+// -------------------------------------------------------------------
+// Copyright (c) 2013-2022, AIT Austrian Institute of Technology GmbH.
+// All rights reserved. See file FMIPP_LICENSE for details.
+// -------------------------------------------------------------------
+
+#ifndef _FMIPP_FORKEDFMU_H
+#define _FMIPP_FORKEDFMU_H
+
+#include "common/FMIPPConfig.h"
+#include "import/base/include/BareFMU.h"
+
+/**
+ * \file ForkedFMU.h
+ *
+ * \class ForkedFMU ForkedFMU.h
+ * Runs the instances of an FMU (FMI ME/CS 2.0) in helper processes, in order to take snapshots
+ * of FMUs that cannot get and set their state themselves ( Linux only ).
+ *
+ * A forked bare FMU ( see ModelManager::getForkedCopy ) has a function table that forwards all
+ * calls to a helper process, which is started by fmi2Instantiate and holds the actual instance.
+ * Arguments and results are exchanged via a shared memory segment ( see SHMManager ).
+ *
+ * Function fmi2GetFMUstate forks the helper process. The new process keeps a copy of the instance
+ * and waits, i.e., the memory of the instance is only copied when it is changed ( copy-on-write ).
+ * Function fmi2SetFMUstate replaces the helper process by a fork of such a waiting process and
+ * fmi2FreeFMUstate terminates the waiting process. FMU states of forked FMUs cannot be serialized.
+ *
+ * Helper processes are not forked from the calling process, since only the calling thread is
+ * copied by fork(): if another thread holds a lock ( e.g., of the memory allocator ), the code of
+ * the FMU may deadlock in the copy. Instead, a server process is forked while the calling process
+ * has a single thread ( see startForkServer ). The server forks a new helper process for each
+ * instance, which loads the shared library of the FMU and instantiates it. Hence, startForkServer
+ * ( or ModelManager::setForkedInstances, or createForkedCopy ) has to be called before any other
+ * threads are started, otherwise no forked bare FMUs can be created. The FMU itself must not start
+ * threads either, because its instance is copied by fork() when taking snapshots.
+ *
+ * The instance in the helper process uses its own callback functions: memory is allocated with
+ * calloc and free, and logged messages are passed on to the logger of the caller after each call.
+ * The server and all helper processes exit when the calling process exits ( also if it crashes ).
+ */
+class __FMI_DLL ForkedFMU
+{
+
+public:
+
+	/**
+	 * Start the server forking the helper processes, unless it is running already. It has to be
+	 * started before the calling process starts other threads, e.g., at the beginning of main().
+	 *
+	 * @return false if the server is not running ( on Windows, or if other threads have been started )
+	 */
+	static fmippBoolean startForkServer();
+
+	/// Get a new bare FMU with a function table that forwards all calls to helper processes
+	/// ( null on Windows, or if the server forking the helper processes is not running ).
+	static BareFMU2Ptr createForkedCopy( const BareFMU2Ptr& bareFMU );
+
+	/// Start a helper process and instantiate the FMU in it ( replaces fmi2Instantiate for forked bare FMUs ).
+	static fmi2Component instantiate( const BareFMU2Ptr& bareFMU,
+		fmi2String instanceName, fmi2Type fmuType, fmi2String fmuGUID,
+		fmi2String fmuResourceLocation, const fmi2::fmi2CallbackFunctions* functions,
+		fmi2Boolean visible, fmi2Boolean loggingOn );
+
+};
+
+#endif // _FMIPP_FORKEDFMU_H
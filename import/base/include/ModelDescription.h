@@ -13,14 +13,29 @@
  *  
  *  The FMI standard defines an XML model description scheme. This class 
  *  provides the utilities to parse and store this information dynamically
- *  during run-time. It uses Boost's PropertyTree internally.
+ *  during run-time.
+ *
+ *  The XML file is read once by a streaming ( SAX-style ) parser. The model
+ *  variables are stored in a compact ModelVariableTable and the derivatives
+ *  listed in ModelStructure in flat arrays. All other elements ( attributes of
+ *  the model, ModelExchange, CoSimulation, DefaultExperiment, etc. ) are small
+ *  and are kept in a Boost PropertyTree. For backward compatibility, the complete
+ *  model description is available as a PropertyTree as well, it is read from
+ *  the XML file when it is requested for the first time ( see getModelVariables() ).
+ *  If the XML file is not available ( e.g., for descriptions restored from the
+ *  cache or parsed from an archive ), it is rebuilt from the parsed elements. In
+ *  this case, the model variables only contain the attributes stored in the
+ *  ModelVariableTable ( name, value reference, description, causality, variability,
+ *  type, start value and derivative ).
  */
 
+#include <mutex>
 #include <vector>
 #include <boost/property_tree/ptree.hpp>
 
 #include "common/FMIPPConfig.h"
 #include "common/FMUType.h"
+#include "import/base/include/ModelVariableTable.h"
 
 class __FMI_DLL ModelDescription
 {
@@ -36,6 +51,13 @@ public:
 	// Second constructor using URL
 	ModelDescription( const fmippString& modelDescriptionURL, fmippBoolean& isValid );
 
+	/**
+	 * Constructor for a model description that has already been read into memory ( e.g., from
+	 * an FMU archive ). The path is only used for accessing the complete model description later
+	 * on ( see getModelAttributes() etc. ), the file does not have to exist yet.
+	 */
+	ModelDescription( const fmippString& xmlDescriptionFilePath, const fmippString& xml );
+
 	/// Check if XML model description file has been parsed successfully (no guarantee that the model description is compliant with the FMI specification).
 	fmippBoolean isValid() const;
 
@@ -61,9 +83,13 @@ public:
 	/// Get vendor annotations.
 	const Properties& getVendorAnnotations() const;
 
-	/// Get description of model variables.
+	/// Get description of model variables. The complete PropertyTree is built on the first call,
+	/// prefer getVariableTable() where possible.
 	const Properties& getModelVariables() const;
 
+	/// Get the table of all model variables.
+	const ModelVariableTable& getVariableTable() const { return variables_; }
+
 	/// Get information concerning implementation of co-simulation tool (FMI CS feature).
 	const Properties& getImplementation() const;
 
@@ -97,6 +123,12 @@ public:
 
 	/// Check if a Jacobian can be computed
 	fmippBoolean providesJacobian() const;
+
+	/// Check if the FMU can get and set its state ( FMI 2.0 only ), for CS or ME.
+	fmippBoolean canGetAndSetFMUstate( fmippBoolean coSimulation ) const;
+
+	/// Check if the FMU can serialize its state ( FMI 2.0 only ), for CS or ME.
+	fmippBoolean canSerializeFMUstate( fmippBoolean coSimulation ) const;
 	
 	/// Check if model description has element VerndorAnnotations with nested element Tool.
 	fmippBoolean hasVendorAnnotationsTool() const;
@@ -130,12 +162,69 @@ public:
 	/// Get the value references for all states and derivatives
 	void getStatesAndDerivativesReferences( fmippValueReference* state_ref, fmippValueReference* der_ref ) const;
 
+	/**
+	 * Get the sparsity pattern of the Jacobian of the derivatives with respect to the states
+	 * in compressed sparse row (CSR) format. Row i and column j refer to the i-th derivative
+	 * and the i-th state as returned by getStatesAndDerivativesReferences(). The pattern is
+	 * read from the attribute 'dependencies' of the elements in ModelStructure.Derivatives,
+	 * dependencies on knowns other than states are ignored. If the attribute is missing for
+	 * a derivative, the corresponding row is assumed to be dense (FMI 2.0 default).
+	 *
+	 * @param[out]  rowPtr  row pointers (length NEQ+1)
+	 * @param[out]  colInd  column indices of the non-zero entries (length rowPtr[NEQ])
+	 * @return false iff the model description holds no dependency information
+	 */
+	fmippBoolean getDerivativesDependencies( std::vector<fmippSize>& rowPtr,
+		std::vector<fmippSize>& colInd ) const;
+
 	/// Return the type of the FMU.
 	FMUType getFMUType() const { return fmuType_; }
 	
 private:
 
-	Properties data_; ///< This data structure (a Boost PropertyTree) holds the parsed model description.
+	friend class ModelDescriptionCache;
+
+	/// Constructor for an empty model description ( see ModelDescriptionCache ).
+	ModelDescription();
+
+	/// Parse the XML model description file.
+	void parse( const fmippString& xmlDescriptionFilePath );
+
+	/// Parse the content of the XML model description file.
+	void parse( const fmippString& xmlDescriptionFilePath, const fmippString& xml );
+
+	/// Read the content of a file, returns false if it cannot be opened.
+	static fmippBoolean readFile( const fmippString& filePath, fmippString& content );
+
+	/// Get the complete model description as PropertyTree ( built on the first call ).
+	const Properties& getCompleteDescription() const;
+
+	/// Rebuild the complete model description from header_, variables_ and the derivatives.
+	void rebuildCompleteDescription( Properties& data ) const;
+
+	fmippString xmlDescriptionFilePath_; ///< Path to the XML model description file.
+
+	Properties header_; ///< All elements except the model variables and the model structure.
+
+	ModelVariableTable variables_; ///< Table of all model variables.
+
+	fmippBoolean hasModelVariables_; ///< True if the element ModelVariables exists.
+
+	fmippBoolean hasModelStructureDerivatives_; ///< True if the element ModelStructure.Derivatives exists.
+
+	std::vector<fmippSize> derivativeIndex_; ///< 1-based indices of the derivatives in ModelStructure.Derivatives.
+
+	std::vector<fmippBoolean> hasDependencies_; ///< True if the attribute 'dependencies' exists for a derivative.
+
+	std::vector<fmippSize> dependencyPtr_; ///< Start of the dependencies of each derivative in dependencies_.
+
+	std::vector<fmippSize> dependencies_; ///< 1-based indices of the dependencies of all derivatives.
+
+	mutable Properties data_; ///< Complete model description ( Boost PropertyTree ), built on demand.
+
+	mutable fmippBoolean dataLoaded_; ///< True if data_ has been built.
+
+	mutable std::mutex dataMutex_; ///< Protects the construction of data_.
 
 	fmippBoolean isValid_; ///< True if the XML model description file has been parsed successfully.
 
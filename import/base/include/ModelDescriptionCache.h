@@ -0,0 +1,100 @@
+// -------------------------------------------------------------------
+// Copyright (c) 2013-2022, AIT Austrian Institute of Technology GmbH.
+// All rights reserved. See file FMIPP_LICENSE for details.
+// -------------------------------------------------------------------
+
+#ifndef _FMIPP_MODELDESCRIPTIONCACHE_H
+#define _FMIPP_MODELDESCRIPTIONCACHE_H
+
+#include <atomic>
+#include <memory>
+#include <string>
+
+#include "common/FMIPPConfig.h"
+
+class ModelDescription;
+
+/**
+ * \file ModelDescriptionCache.h
+ *
+ * \class ModelDescriptionCache ModelDescriptionCache.h
+ * On-disk cache of parsed model descriptions.
+ *
+ * For every XML model description, the parsed content ( see ModelDescription ) is stored in a
+ * binary file in the cache directory. The name of this file is made of the GUID of the FMU and
+ * a 64-bit hash of the XML file. Loading a model description that has been cached before maps
+ * this file into memory and restores the ModelDescription from it without parsing the XML file.
+ * If the XML file changes, its hash changes as well and the description is parsed again.
+ *
+ * The binary format starts with a magic number, a format version and the hash and size of the
+ * XML file. Files written by a different format version or on a platform with a different byte
+ * order are ignored ( and replaced ). Stale files are never removed, the cache directory may be
+ * cleared at any time.
+ *
+ * Model descriptions may be loaded concurrently from several threads.
+ */
+
+class __FMI_DLL ModelDescriptionCache
+{
+
+public:
+
+	/// Version of the binary format, increment whenever it changes.
+	static const unsigned int formatVersion;
+
+	/**
+	 * Constructor.
+	 *
+	 * @param[in]  directory  path of the cache directory, which has to exist already
+	 */
+	ModelDescriptionCache( const fmippString& directory );
+
+	/// Get the path of the cache directory.
+	const fmippString& getDirectory() const { return directory_; }
+
+	/**
+	 * Load a model description. It is restored from the cache if available, otherwise the
+	 * XML file is parsed and the result is added to the cache ( if it is valid ).
+	 *
+	 * @param[in]  xmlDescriptionFilePath  path to the XML model description file
+	 * @return the model description ( check ModelDescription::isValid() )
+	 */
+	std::unique_ptr<ModelDescription> load( const fmippString& xmlDescriptionFilePath );
+
+	/**
+	 * Load a model description whose XML content has already been read into memory ( e.g.,
+	 * from an FMU archive ), see ModelDescription::ModelDescription(const fmippString&,const fmippString&).
+	 *
+	 * @param[in]  xmlDescriptionFilePath  path to the XML model description file ( does not have to exist yet )
+	 * @param[in]  xml  content of the XML model description file
+	 * @return the model description ( check ModelDescription::isValid() )
+	 */
+	std::unique_ptr<ModelDescription> load( const fmippString& xmlDescriptionFilePath, const fmippString& xml );
+
+	/// Get the number of model descriptions restored from the cache.
+	fmippSize getHits() const { return hits_; }
+
+	/// Get the number of model descriptions parsed because they were not in the cache.
+	fmippSize getMisses() const { return misses_; }
+
+private:
+
+	/// Get the path of the cache file for an XML model description with the given content.
+	fmippString getCacheFilePath( const fmippString& xml, unsigned long long hash ) const;
+
+	/// Restore a model description from a cache file, returns false if this is not possible.
+	bool read( const fmippString& cacheFilePath, unsigned long long hash, fmippSize xmlSize,
+		ModelDescription& description ) const;
+
+	/// Write a model description to a cache file, returns false if this is not possible.
+	bool write( const fmippString& cacheFilePath, unsigned long long hash, fmippSize xmlSize,
+		const ModelDescription& description ) const;
+
+	fmippString directory_; ///< Path of the cache directory.
+
+	std::atomic<fmippSize> hits_; ///< Number of model descriptions restored from the cache.
+
+	std::atomic<fmippSize> misses_; ///< Number of model descriptions parsed.
+};
+
+#endif // _FMIPP_MODELDESCRIPTIONCACHE_H
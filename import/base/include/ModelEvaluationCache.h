@@ -0,0 +1,108 @@
+// -------------------------------------------------------------------
+// Copyright (c) 2013-2022, AIT Austrian Institute of Technology GmbH.
+// All rights reserved. See file FMIPP_LICENSE for details.
+// -------------------------------------------------------------------
+
+#ifndef _FMIPP_MODELEVALUATIONCACHE_H
+#define _FMIPP_MODELEVALUATIONCACHE_H
+
+#include <vector>
+
+#include "common/FMIPPConfig.h"
+#include "import/integrators/include/IntegratorStatistics.h"
+
+/**
+ * \file ModelEvaluationCache.h
+ *
+ * \class ModelEvaluationCache ModelEvaluationCache.h
+ * Remembers the time and the continuous states last passed to an FMU for ME, together with the
+ * derivatives and event indicators evaluated for them.
+ *
+ * The integrators frequently set the same time and states several times in a row ( e.g., when
+ * a step is restarted after an event or when checkStateEvent() follows a step ) and read the
+ * derivatives again at a point where they have been evaluated already. With the help of this
+ * class, such calls to the FMU are skipped while the cache is active, i.e., while an instance
+ * of ModelEvaluationCache::Activation exists. Calls made by the user outside of an integration
+ * always reach the FMU. The number of skipped calls is added to the counters skippedSetTime,
+ * skippedSetStates, cachedDerivatives and cachedEventIndicators of IntegratorStatistics.
+ *
+ * Only values that have been set or read successfully may be stored. Whenever the FMU changes
+ * in a way that is not visible to this class ( inputs, parameters, event iterations, rewinds ),
+ * invalidate() has to be called.
+ */
+
+class __FMI_DLL ModelEvaluationCache
+{
+
+public:
+
+	/// Constructor. The counters of skipped calls are added to statistics.
+	ModelEvaluationCache( IntegratorStatistics& statistics );
+
+	/// Add the counters of skipped calls to other statistics ( e.g., after a change of the integrator ).
+	void setStatistics( IntegratorStatistics& statistics ) { statistics_ = &statistics; }
+
+#ifndef SWIG
+	/// Activates the cache for the lifetime of this object ( e.g., for one call to integrate ).
+	class Activation
+	{
+	public:
+		Activation( ModelEvaluationCache& cache ) : cache_( cache ) { cache_.active_ = true; }
+		~Activation() { cache_.active_ = false; }
+
+	private:
+		ModelEvaluationCache& cache_;
+	};
+#endif // SWIG
+
+	/// Forget everything known about the FMU.
+	void invalidate();
+
+	/// Returns true iff the cache is active and time t is known to be set in the FMU already,
+	/// i.e., setting it can be skipped.
+	bool hasTime( fmippTime t );
+
+	/// Store the time set in the FMU. Derivatives and event indicators are forgotten if it changed.
+	void storeTime( fmippTime t );
+
+	/// Returns true iff the cache is active and the states x are known to be set in the FMU already.
+	bool hasStates( const fmippReal* x, fmippSize n );
+
+	/// Store the states set in ( or read from ) the FMU. Derivatives and event indicators are
+	/// forgotten if they changed.
+	void storeStates( const fmippReal* x, fmippSize n );
+
+	/// Copy the derivatives to dx and return true if the cache is active and they are known for
+	/// the current time and states.
+	bool getDerivatives( fmippReal* dx, fmippSize n );
+
+	/// Store the derivatives evaluated for the current time and states.
+	void storeDerivatives( const fmippReal* dx, fmippSize n );
+
+	/// Copy the event indicators to z and return true if the cache is active and they are known
+	/// for the current time and states.
+	bool getEventIndicators( fmippReal* z, fmippSize n );
+
+	/// Store the event indicators evaluated for the current time and states.
+	void storeEventIndicators( const fmippReal* z, fmippSize n );
+
+private:
+
+	/// Forget the derivatives and event indicators.
+	void invalidateOutputs();
+
+	IntegratorStatistics* statistics_;
+
+	bool active_;
+	bool timeValid_;
+	bool statesValid_;
+	bool derivativesValid_;
+	bool eventIndicatorsValid_;
+
+	fmippTime time_;
+	std::vector<fmippReal> states_;
+	std::vector<fmippReal> derivatives_;
+	std::vector<fmippReal> eventIndicators_;
+};
+
+#endif // _FMIPP_MODELEVALUATIONCACHE_H
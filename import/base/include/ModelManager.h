@@ -13,8 +13,22 @@
  * get parsed. It provides a portable implementation regardless of the platform that has been used for generating 
  * the employed FMUs. An instance of model manager:
  * 1. is privately constructed and cannot be externally instantiated 
- * 2. provides FMI functions of any FMU given (FMUs have to be already unzipped)
+ * 2. provides FMI functions of any FMU given (either unzipped or as FMU archive, see FMUArchive)
  * 3. loads FMUs only once, which is very time-saving in case several instances of the same FMU are used
+ *
+ * All functions may be called concurrently from several threads. Lookups share a lock, while loading
+ * and unloading FMUs lock the model manager exclusively. Parsing the model description and loading
+ * the shared library are done without holding this lock, so different FMUs are loaded in parallel.
+ * If several threads load the same FMU, it is loaded once and the other threads wait for it.
+ *
+ * FMU archives ( URLs with the extension ".fmu" ) are loaded directly. The model description is
+ * read from the archive, the archive is then extracted into a sub-directory of the extraction
+ * cache directory named after the hash of the archive ( see setFMUExtractionDirectory ). Archives
+ * that have been extracted before ( also by other processes ) are not extracted again.
+ *
+ * By default, all instances of an FMU share the same shared library. FMUs that can be instantiated
+ * only once per process ( or that have global state ) can be switched to isolated instances ( see
+ * setIsolatedInstances ), which use private copies of the shared library instead.
  */ 
 
 #ifndef _FMIPP_MODELMANAGER_H
@@ -22,9 +36,16 @@
 
 #include <string>
 #include <map>
+#include <memory>
+#include <set>
+#include <future>
+#include <functional>
+#include <vector>
 
 #include "common/FMUType.h"
 #include "import/base/include/BareFMU.h"
+#include "import/base/include/ModelDescriptionCache.h"
+#include "import/base/include/SharedMutex.h"
 
 class __FMI_DLL ModelManager
 {
@@ -39,7 +60,8 @@ public:
 		description_invalid_uri, ///< The FMU has not been loaded, because URI provided for the XML model description is invalid.
 		description_invalid, ///< The FMU has not been loaded, because the XML model description is invalid.
 		identifier_invalid, ///< The FMU has not been loaded, because the specified model identifier is not consistent with the information found in the XML model description.
-		failed ///< Unknown error.
+		failed, ///< Unknown error.
+		archive_invalid ///< The FMU has not been loaded, because the FMU archive could not be read or extracted.
 	};
 
 	enum UnloadFMUStatus { 
@@ -49,7 +71,17 @@ public:
 		unknown ///< Unknown error.
 	};
 
-	/// Destructor. 
+	/// Result of loading an FMU asynchronously ( see loadFMUsAsync ).
+	struct LoadFMUResult {
+		LoadFMUStatus status; ///< Status of the load process.
+		FMUType type; ///< Information about the FMU implementation (ME/CS, version 1.0/2.0).
+		std::string modelIdentifier; ///< Model identifier of the loaded FMU.
+	};
+
+	/// Handle for the result of loading an FMU asynchronously.
+	typedef std::shared_future<LoadFMUResult> LoadFMUFuture;
+
+	/// Destructor, waits for asynchronous loads to finish.
 	~ModelManager();
 
 	/// Get singleton instance of model manager. 
@@ -58,8 +90,9 @@ public:
 	/**
 	 * Load an unzipped FMU into the model manager. It is assumed that the FMU has been unzipped into
 	 * a single directory and that the unzipped content follows the standard naming conventions.
+	 * Alternatively, the URL of an FMU archive may be given, which is then extracted on demand.
 	 * @param[in] modelIdentifier FMI model identifier (according to XML model description)
-	 * @param[in] fmuDirUrl Path to the extracted FMU directory (given as URL).
+	 * @param[in] fmuDirUrl Path to the extracted FMU directory or to the FMU archive (given as URL).
 	 * @param[in] loggingOn Input flag for turning logging on/off.
 	 * @param[out] type Output flag with information about the FMU implementation (ME/CS, version 1.0/2.0).
 	 * @return status of the load process
@@ -82,8 +115,9 @@ public:
 	 * to the appropriate values. The given model identifier may be used to 
 	 * obtain appropriate bare FMUs and to unload the model. In case an FMU 
 	 * specifies multiple model identifier, one model identifier will be 
-	 * arbitrarily chosen and returned.
-	 * @param[in] fmuDirUrl Path to the extracted FMU directory (given as URL).
+	 * arbitrarily chosen and returned. Alternatively, the URL of an FMU archive may
+	 * be given, which is then extracted on demand.
+	 * @param[in] fmuDirUrl Path to the extracted FMU directory or to the FMU archive (given as URL).
 	 * @param[in] loggingOn Input flag for turning logging on/off.
 	 * @param[out] type Output flag with information about the FMU implementation
 	 * (ME/CS, version 1.0/2.0).
@@ -94,6 +128,23 @@ public:
 	static LoadFMUStatus loadFMU( const std::string& fmuDirUrl, 
 		const fmippBoolean loggingOn, FMUType& type, std::string& modelIdentifier );
 
+	/**
+	 * Loads a batch of unzipped FMUs asynchronously, using a bounded number of threads.
+	 *
+	 * Each FMU is loaded as with ModelManager::loadFMU(const std::string&,const fmippBoolean,FMUType&,std::string&),
+	 * independent FMUs are loaded concurrently. The function returns immediately, with one handle per
+	 * FMU ( in the order of the given URLs ). The result of each handle becomes available as soon as
+	 * the corresponding FMU has been loaded, so callers may start instantiating it while other FMUs
+	 * are still being loaded. If loading an FMU throws an exception, it is rethrown when the result
+	 * of the corresponding handle is retrieved.
+	 * @param[in] fmuDirUrls Paths to the extracted FMU directories or FMU archives (given as URL).
+	 * @param[in] loggingOn Input flag for turning logging on/off.
+	 * @param[in] maxThreads Maximum number of threads used for loading ( 0 for the number of hardware threads ).
+	 * @return handles for the results of the load processes
+	 */
+	static std::vector<LoadFMUFuture> loadFMUsAsync( const std::vector<std::string>& fmuDirUrls,
+		const fmippBoolean loggingOn, unsigned int maxThreads = 0 );
+
 	/**
 	 * Unload an FMU from the model manager. It must not be in use. 
 	 * @param[in] modelIdentifier model identifier associated to the "bare FMU" to be unloaded
@@ -147,6 +198,100 @@ public:
 	 */
 	static BareFMU2Ptr getInstance( const std::string& modelIdentifier );
 
+	/**
+	 * Enable the on-disk cache of parsed model descriptions ( see ModelDescriptionCache ).
+	 * With the cache enabled, model descriptions loaded before ( also by other processes )
+	 * are restored from binary cache files instead of parsing the XML files.
+	 * @param[in] directory Path of an existing cache directory. An empty string disables the cache.
+	 */
+	static void setModelDescriptionCacheDirectory( const std::string& directory );
+
+	/// Get the path of the model description cache directory ( empty if the cache is disabled ).
+	static std::string getModelDescriptionCacheDirectory();
+
+	/// Get the model description cache ( null if disabled, valid until the cache directory is changed ).
+	static const ModelDescriptionCache* getModelDescriptionCache();
+
+	/**
+	 * Set the cache directory into which FMU archives are extracted ( see FMUArchive ).
+	 * The directory is created if it does not exist. It may be shared by several processes of the
+	 * same user, but loading archives fails if it is not owned by the calling user or is writable
+	 * by the group or others ( see FMUArchive::makeCacheDirectory ).
+	 * @param[in] directory Path of the cache directory. An empty string selects the default
+	 * directory ( see FMUArchive::getDefaultCacheDirectory ).
+	 */
+	static void setFMUExtractionDirectory( const std::string& directory );
+
+	/// Get the path of the cache directory into which FMU archives are extracted.
+	static std::string getFMUExtractionDirectory();
+
+	/**
+	 * Enable or disable isolated instances of an FMU. With isolation enabled, getModel, getSlave
+	 * and getInstance return a new bare FMU on every call, which uses a private copy of the shared
+	 * library ( see getIsolatedCopy ). Hence, FMU instances created from these bare FMUs do not share
+	 * any global state and may be used in parallel threads, even if the FMU can be instantiated only
+	 * once per process. The setting may be changed before or after the FMU has been loaded, it only
+	 * affects bare FMUs retrieved afterwards.
+	 * @param[in] modelIdentifier The unique ID of the model
+	 * @param[in] isolated Flag for enabling or disabling isolated instances
+	 */
+	static void setIsolatedInstances( const std::string& modelIdentifier, fmippBoolean isolated );
+
+	/// Check if isolated instances are enabled for an FMU ( see setIsolatedInstances ).
+	static fmippBoolean hasIsolatedInstances( const std::string& modelIdentifier );
+
+	/**
+	 * Get a new bare FMU (FMI ME 1.0) using a private copy of the shared library of the given bare FMU.
+	 *
+	 * On Linux, the shared library is loaded into a new link-map namespace ( using dlmopen ), together
+	 * with private copies of its dependencies. If this is not possible ( e.g., because the number of
+	 * namespaces is limited ), the shared library file is copied and the copy is loaded instead. The
+	 * copy is placed next to the original file, so that dependencies are found in the same way. On
+	 * other systems, only the second approach is used ( on Windows, the copies are not removed ).
+	 * The new bare FMU shares the model description with the given bare FMU, which is kept in use
+	 * as long as the new bare FMU exists.
+	 * @return smart pointer to "bare" FMU ( null if the shared library cannot be loaded )
+	 */
+	static BareFMUModelExchangePtr getIsolatedCopy( const BareFMUModelExchangePtr& bareFMU );
+
+	/// Get a new bare FMU (FMI CS 1.0) using a private copy of the shared library of the given bare FMU.
+	static BareFMUCoSimulationPtr getIsolatedCopy( const BareFMUCoSimulationPtr& bareFMU );
+
+	/// Get a new bare FMU (FMI ME/CS 2.0) using a private copy of the shared library of the given bare FMU.
+	static BareFMU2Ptr getIsolatedCopy( const BareFMU2Ptr& bareFMU );
+
+	/**
+	 * Enable or disable forked instances of an FMU (FMI ME/CS 2.0 only). With this setting enabled,
+	 * getInstance returns a new forked bare FMU on every call ( see getForkedCopy ), whose instances
+	 * can get and set their state even if the FMU itself does not support this. The setting only
+	 * affects bare FMUs retrieved afterwards and has no effect on Windows. Enabling it starts the
+	 * server forking the helper processes, which requires that no other threads have been started
+	 * yet ( see ForkedFMU::startForkServer ).
+	 * @param[in] modelIdentifier The unique ID of the model
+	 * @param[in] forked Flag for enabling or disabling forked instances
+	 */
+	static void setForkedInstances( const std::string& modelIdentifier, fmippBoolean forked );
+
+	/// Check if forked instances are enabled for an FMU ( see setForkedInstances ).
+	static fmippBoolean hasForkedInstances( const std::string& modelIdentifier );
+
+	/**
+	 * Get a new bare FMU (FMI ME/CS 2.0) whose instances run in helper processes, which take
+	 * snapshots of the instance by forking ( see ForkedFMU.h, Linux only ). The new bare FMU
+	 * shares the model description and the shared library with the given bare FMU.
+	 * @return smart pointer to "bare" FMU ( null on Windows, or if the server forking the helper
+	 * processes has not been started before other threads, see ForkedFMU::startForkServer )
+	 */
+	static BareFMU2Ptr getForkedCopy( const BareFMU2Ptr& bareFMU );
+
+	/**
+	 * Get the number of references to a loaded bare FMU, including the reference held by the
+	 * model manager itself ( i.e., the FMU can be unloaded if this number is 1 ).
+	 * @param[in] modelIdentifier The unique ID of the model to query
+	 * @return the number of references, 0 if the FMU has not been loaded
+	 */
+	static long getUseCount( const std::string& modelIdentifier );
+
 private:
 
 	/// Private constructor (singleton). 
@@ -171,14 +316,46 @@ private:
 		std::unique_ptr<ModelDescription> description, 
 		const std::string& fmuDirUrl, const std::string& modelIdentifier);
 
+	/**
+	 * Loads an FMU once, even if called concurrently for the same model identifier.
+	 * In case the FMU is already loaded, duplicate is returned. Otherwise, the first calling
+	 * thread executes the given load function ( without holding the lock of the model manager ),
+	 * while other threads loading the same FMU wait for it and return duplicate on success
+	 * ( or the status of the failed load otherwise ). If the load function throws, waiting
+	 * threads return failed and the exception is rethrown to the caller.
+	 * @param[in] modelIdentifier The unique ID of the model to load
+	 * @param[out] type The type of the FMU, set in case duplicate is returned
+	 * @param[in] load The function loading the FMU ( e.g., calling loadBareFMU )
+	 * @return The status of the operation
+	 */
+	static LoadFMUStatus loadOnce( const std::string& modelIdentifier, FMUType& type,
+		const std::function<LoadFMUStatus()>& load );
+
+	/**
+	 * Get the URL of the directory containing the unzipped FMU. For FMU archives, the archive is
+	 * extracted into the extraction cache directory ( unless this has been done before ). Otherwise,
+	 * the given URL is returned.
+	 * @param[in] fmuUrl Path to the extracted FMU directory or to the FMU archive (given as URL).
+	 * @param[out] fmuDirUrl Path to the extracted FMU directory (given as URL).
+	 * @return The status of the operation
+	 */
+	static LoadFMUStatus extractFMU( const std::string& fmuUrl, std::string& fmuDirUrl );
+
+	/// Get the type of a loaded FMU, the caller has to lock the model manager.
+	static LoadFMUStatus findLoadedFMU( const std::string& modelIdentifier, FMUType* dest );
+
+	/// Load a private copy of the shared library of a bare FMU ( see getIsolatedCopy ).
+	template<typename BareFMUType>
+	static std::shared_ptr<BareFMUType> isolate( const std::shared_ptr<BareFMUType>& bareFMU );
+
 	/// Helper function for loading a bare FMU shared library (FMI ME Version 1.0).
-	static int loadDll( std::string dllPath, BareFMUModelExchangePtr bareFMU );
+	static int loadDll( std::string dllPath, BareFMUModelExchangePtr bareFMU, bool isolated = false );
 
 	/// Helper function for loading a bare FMU shared library (FMI CS Version 1.0).
-	static int loadDll( std::string dllPath, BareFMUCoSimulationPtr bareFMU );
+	static int loadDll( std::string dllPath, BareFMUCoSimulationPtr bareFMU, bool isolated = false );
 
 	/// Helper function for loading a bare FMU shared library (FMI Version 1.0, ME & CS).
-	static int loadDll( std::string dllPath, BareFMU2Ptr bareFMU );
+	static int loadDll( std::string dllPath, BareFMU2Ptr bareFMU, bool isolated = false );
 
 	/**
 	 * @brief Loads all function pointers which are common to ME and CS
@@ -226,8 +403,20 @@ private:
 	 * 0 and an arbitrary value is returned.
 	 * @param status A valid reference to the status variable
 	 * @param dllPath The path to the dll file
+	 * @param isolated Load a private copy of the DLL ( see getIsolatedCopy )
+	 * @param copyPath Set to the path of the copied DLL file in case it has to be deleted after unloading it
+	 */
+	static HANDLE openDLL( int* status, const std::string& dllPath, bool isolated = false,
+		std::string* copyPath = 0 );
+
+	/**
+	 * @brief Copies the DLL/SO file and opens the copy ( see getIsolatedCopy ).
+	 * @details In case the file cannot be copied or opened, 0 is returned. The copy is deleted
+	 * right away if possible, otherwise ( on Windows ) its path is returned.
+	 * @param dllPath The path to the dll file
+	 * @param dllCopyPath Set to the path of the copy if it has to be deleted after unloading it, empty otherwise
 	 */
-	static HANDLE openDLL( int* status, const std::string& dllPath );
+	static HANDLE openDLLCopy( const std::string& dllPath, std::string& dllCopyPath );
 
 	/** 
 	 * @brief Helper function for loading FMU 1.0 shared library function
@@ -292,7 +481,8 @@ private:
 	 * case the description cannot be loaded successfully, dest may contain 
 	 * arbitrary results.
 	 * @param[in] fmuDirUrl The URL of the FMU directory location. The parameter 
-	 * will be used to generate the location of the model description file.
+	 * will be used to generate the location of the model description file. For 
+	 * FMU archives, the model description is read from the archive.
 	 * @param[out] The pointer which will be set to the instantiated model 
 	 * description instance.
 	 * \return The status of the operation.
@@ -349,6 +539,33 @@ private:
 	/// Collection of bare 2.0 FMUs.
 	BareInstanceCollection instanceCollection_;
 
+	/// Define container for FMUs that are being loaded, mapping model identifiers to the status of the load.
+	typedef std::map<std::string, std::shared_future<LoadFMUStatus> > PendingLoadCollection;
+
+	/// Collection of FMUs that are being loaded.
+	PendingLoadCollection pendingLoads_;
+
+	/// Cache of parsed model descriptions ( null if disabled ).
+	std::shared_ptr<ModelDescriptionCache> descriptionCache_;
+
+	/// Cache directory for extracted FMU archives ( empty for the default directory ).
+	std::string extractionDirectory_;
+
+	/// Model identifiers of FMUs with isolated instances ( see setIsolatedInstances ).
+	std::set<std::string> isolatedFMUs_;
+
+	/// Model identifiers of FMUs with forked instances ( see setForkedInstances ).
+	std::set<std::string> forkedFMUs_;
+
+	/// Protects the collections, the model description cache, the extraction directory and the isolation and forking settings.
+	SharedMutex mutex_;
+
+	/// Threads loading FMUs asynchronously ( see loadFMUsAsync ).
+	std::vector< std::future<void> > asyncLoaders_;
+
+	/// Protects the collection of asynchronous loader threads.
+	std::mutex asyncLoadersMutex_;
+
 };
 
 
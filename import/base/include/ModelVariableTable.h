@@ -0,0 +1,155 @@
+// -------------------------------------------------------------------
+// Copyright (c) 2013-2022, AIT Austrian Institute of Technology GmbH.
+// All rights reserved. See file FMIPP_LICENSE for details.
+// -------------------------------------------------------------------
+
+#ifndef _FMIPP_MODELVARIABLETABLE_H
+#define _FMIPP_MODELVARIABLETABLE_H
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "common/FMIPPConfig.h"
+#include "common/FMIPPVariableCausality.h"
+#include "common/FMIPPVariableVariability.h"
+
+/**
+ * \file ModelVariableTable.h
+ *
+ * \class ModelVariableTable ModelVariableTable.h
+ * Flat table of the model variables of an FMI model description.
+ *
+ * The variables are stored as a struct of arrays in the order of their definition, i.e.,
+ * variable i corresponds to the (i+1)-th element ScalarVariable ( the index used by FMI 2.0
+ * in ModelStructure ). All strings ( names, descriptions and start values ) are kept in a
+ * single pool of zero-terminated strings, equal strings are stored only once. Compared to a
+ * Boost PropertyTree, which allocates several nodes and strings per attribute, this reduces
+ * the memory needed for large models by an order of magnitude.
+ *
+ * The table is built by ModelDescription while parsing the XML model description. Once it is
+ * complete ( see finalize() ), the table is immutable and additionally provides an open-addressing
+ * hash index of the names, which allows to look up variables without any string copies or tree
+ * traversals. It is shared by all FMU instances using the same model description.
+ */
+
+class __FMI_DLL ModelVariableTable
+{
+
+public:
+
+	/// Index returned if there is no such variable.
+	static const fmippSize npos;
+
+	/// Constructor. Creates an empty table.
+	ModelVariableTable();
+
+	/// Get the number of variables.
+	fmippSize size() const { return valueReference_.size(); }
+
+	/// Get the number of distinct variable names ( available after finalize() ).
+	fmippSize getNumberOfNames() const { return nNames_; }
+
+	/// Get the name of variable i.
+	const fmippChar* getName( fmippSize i ) const { return &pool_[ name_[i] ]; }
+
+	/// Get the description of variable i ( empty if not available ).
+	const fmippChar* getDescription( fmippSize i ) const { return &pool_[ description_[i] ]; }
+
+	/// Get the value reference of variable i.
+	fmippValueReference getValueReference( fmippSize i ) const { return valueReference_[i]; }
+
+	/// Get the type of variable i ( fmippTypeUnknown for enumerations ).
+	FMIPPVariableType getType( fmippSize i ) const {
+		return static_cast<FMIPPVariableType>( type_[i] );
+	}
+
+	/// Get the causality of variable i.
+	FMIPPVariableCausality getCausality( fmippSize i ) const {
+		return static_cast<FMIPPVariableCausality>( causality_[i] );
+	}
+
+	/// Get the variability of variable i.
+	FMIPPVariableVariability getVariability( fmippSize i ) const {
+		return static_cast<FMIPPVariableVariability>( variability_[i] );
+	}
+
+	/// Check whether a start value is defined for variable i.
+	fmippBoolean hasStart( fmippSize i ) const { return 0 != startString_[i]; }
+
+	/// Get the start value of a real, integer or boolean variable i ( NaN if not available ).
+	fmippReal getStartValue( fmippSize i ) const { return start_[i]; }
+
+	/// Get the start value of variable i as written in the model description ( empty if not available ).
+	const fmippChar* getStartString( fmippSize i ) const { return &pool_[ startString_[i] ]; }
+
+	/// Get the index of the state whose derivative is variable i ( npos if i is no derivative ).
+	fmippSize getDerivativeOf( fmippSize i ) const {
+		return ( 0 == derivativeOf_[i] ) ? npos : derivativeOf_[i] - 1;
+	}
+
+	/**
+	 * Find a variable by its name. If several variables have the same name, the first one is
+	 * returned. Only available after finalize() has been called.
+	 *
+	 * @return the index of the variable, npos if there is no such variable
+	 */
+	fmippSize find( const fmippString& name ) const;
+
+	/**
+	 * Append a variable to the table.
+	 *
+	 * @return the index of the new variable
+	 */
+	fmippSize addVariable( const fmippString& name, fmippValueReference valueReference,
+		const fmippString& description, FMIPPVariableCausality causality,
+		FMIPPVariableVariability variability );
+
+	/**
+	 * Set the information given by the type element ( Real, Integer, Boolean, String or
+	 * Enumeration ) of variable i.
+	 *
+	 * @param[in]  i             index of the variable
+	 * @param[in]  type          type of the variable
+	 * @param[in]  start         start value, 0 if not available
+	 * @param[in]  derivativeOf  1-based index of the state whose derivative is variable i
+	 *                           ( attribute 'derivative' of FMI 2.0 ), 0 if none
+	 */
+	void setTypeInformation( fmippSize i, FMIPPVariableType type, const fmippString* start,
+		fmippSize derivativeOf );
+
+	/// Release all memory that is only needed while the table is built and build the name index.
+	void finalize();
+
+	/// Get the number of bytes allocated by the table.
+	fmippSize getMemoryUsage() const;
+
+private:
+
+	friend class ModelDescriptionCache;
+
+	/// Add a string to the pool ( if not there already ) and return its offset.
+	unsigned int intern( const fmippString& s );
+
+	/// Hash function for the name index.
+	static fmippSize hash( const fmippChar* s, fmippSize length );
+
+	std::vector<fmippChar> pool_; ///< Pool of zero-terminated strings, starting with the empty string.
+	std::unordered_map<fmippString, unsigned int> interned_; ///< Offsets of the strings in the pool.
+
+	std::vector<unsigned int> name_; ///< Offsets of the names in the pool.
+	std::vector<unsigned int> description_; ///< Offsets of the descriptions in the pool.
+	std::vector<unsigned int> startString_; ///< Offsets of the start values in the pool, 0 if none.
+	std::vector<fmippValueReference> valueReference_; ///< Value references.
+	std::vector<unsigned char> type_; ///< Types ( FMIPPVariableType ).
+	std::vector<unsigned char> causality_; ///< Causalities ( FMIPPVariableCausality ).
+	std::vector<unsigned char> variability_; ///< Variabilities ( FMIPPVariableVariability ).
+	std::vector<fmippReal> start_; ///< Numerical start values.
+	std::vector<unsigned int> derivativeOf_; ///< 1-based indices of the states, 0 if none.
+
+	fmippSize nNames_; ///< Number of distinct names.
+
+	std::vector<unsigned int> index_; ///< Hash index of the names ( variable index + 1, 0 for empty slots ).
+};
+
+#endif // _FMIPP_MODELVARIABLETABLE_H
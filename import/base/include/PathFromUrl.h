@@ -10,13 +10,16 @@
 
 #include "common/FMIPPConfig.h"
 
-/// Namespace contains helper function to convert URLs to system paths.
+/// Namespace contains helper functions to convert URLs to system paths and vice versa.
 namespace PathFromUrl
 {
 
 	/// Helper function for transforming URLs to a system path.
 	fmippBoolean getPathFromUrl( const fmippString& inputFileUrl, fmippString& outputFilePath );
 
+	/// Helper function for transforming a system path to a URL.
+	fmippBoolean getUrlFromPath( const fmippString& inputFilePath, fmippString& outputFileUrl );
+
 }
 
 #endif // _FMIPP_PATHFROMURL_H
@@ -0,0 +1,101 @@
+// -------------------------------------------------------------------
+// Copyright (c) 2013-2022, AIT Austrian Institute of Technology GmbH.
+// All rights reserved. See file FMIPP_LICENSE for details.
+// -------------------------------------------------------------------
+
+#ifndef _FMIPP_SHAREDMUTEX_H
+#define _FMIPP_SHAREDMUTEX_H
+
+#include <condition_variable>
+#include <mutex>
+
+
+/**
+ * \file SharedMutex.h
+ *
+ * \class SharedMutex SharedMutex.h
+ * Mutex that can be locked exclusively ( writers ) or shared ( readers ).
+ *
+ * Provides the subset of std::shared_mutex ( not available in C++11 ) needed by FMI++.
+ * Writers take precedence: once a writer is waiting, no further readers are admitted.
+ * Use std::lock_guard for exclusive and SharedLock for shared ownership.
+ */
+class SharedMutex
+{
+
+public:
+
+	SharedMutex() : readers_( 0 ), writer_( false ) {}
+
+	/// Lock exclusively.
+	void lock()
+	{
+		std::unique_lock<std::mutex> lock( mutex_ );
+		writerQueue_.wait( lock, [this] { return false == writer_; } );
+		writer_ = true;
+		readerQueue_.wait( lock, [this] { return 0 == readers_; } );
+	}
+
+	/// Release exclusive ownership.
+	void unlock()
+	{
+		std::lock_guard<std::mutex> lock( mutex_ );
+		writer_ = false;
+		writerQueue_.notify_all();
+	}
+
+	/// Lock shared.
+	void lock_shared()
+	{
+		std::unique_lock<std::mutex> lock( mutex_ );
+		writerQueue_.wait( lock, [this] { return false == writer_; } );
+		++readers_;
+	}
+
+	/// Release shared ownership.
+	void unlock_shared()
+	{
+		std::lock_guard<std::mutex> lock( mutex_ );
+		if ( 0 == --readers_ && writer_ ) readerQueue_.notify_one();
+	}
+
+private:
+
+	SharedMutex( const SharedMutex& );
+	SharedMutex& operator=( const SharedMutex& );
+
+	std::mutex mutex_; ///< Protects the state of the shared mutex.
+
+	std::condition_variable writerQueue_; ///< Threads waiting for a writer to finish.
+
+	std::condition_variable readerQueue_; ///< The writer waiting for the readers to finish.
+
+	unsigned int readers_; ///< Number of threads owning the mutex shared.
+
+	bool writer_; ///< Flag indicating that a writer owns ( or waits for ) the mutex.
+};
+
+
+/**
+ * \class SharedLock SharedMutex.h
+ * Scoped shared ownership of a SharedMutex.
+ */
+class SharedLock
+{
+
+public:
+
+	explicit SharedLock( SharedMutex& mutex ) : mutex_( mutex ) { mutex_.lock_shared(); }
+
+	~SharedLock() { mutex_.unlock_shared(); }
+
+private:
+
+	SharedLock( const SharedLock& );
+	SharedLock& operator=( const SharedLock& );
+
+	SharedMutex& mutex_; ///< The mutex owned shared.
+};
+
+
+#endif // _FMIPP_SHAREDMUTEX_H
@@ -0,0 +1,110 @@
+// -------------------------------------------------------------------
+// Copyright (c) 2013-2022, AIT Austrian Institute of Technology GmbH.
+// All rights reserved. See file FMIPP_LICENSE for details.
+// -------------------------------------------------------------------
+
+#ifndef _FMIPP_SPARSEJACOBIAN_H
+#define _FMIPP_SPARSEJACOBIAN_H
+
+#include <vector>
+
+#include "common/FMIPPConfig.h"
+
+/**
+ * \file SparseJacobian.h
+ *
+ * \class SparseJacobian SparseJacobian.h
+ * Jacobian of the RHS of an ODE, stored in compressed sparse row (CSR) format.
+ *
+ * The sparsity pattern is typically taken from the dependencies listed in the element
+ * fmiModelDescription.ModelStructure.Derivatives of an FMI 2.0 model description. When the
+ * pattern is set, the columns of the Jacobian are colored (Curtis-Powell-Reid), i.e., they
+ * are partitioned into groups of columns with disjoint row patterns. All columns of such a
+ * group can be evaluated with a single directional derivative or a single perturbation of
+ * the states, which reduces the cost of a Jacobian from O(NEQ) to O(number of colors) calls
+ * to the FMU.
+ *
+ * The non-zero entries of row \f$i\f$ are stored in
+ *
+ *        \f[ values[k],\ k = rowPtr[i],...,rowPtr[i+1]-1 \f]
+ *
+ * and the corresponding column indices in colInd[k]. This is the same layout as used by
+ * SUNDIALS' sparse matrices of type CSR_MAT ( indexptrs, indexvals and data ).
+ */
+
+class __FMI_DLL SparseJacobian
+{
+
+public:
+
+	/// Constructor. Creates an empty pattern.
+	SparseJacobian();
+
+	/**
+	 * Set the sparsity pattern and compute the column coloring.
+	 *
+	 * @param[in]  n       dimension of the (square) Jacobian
+	 * @param[in]  rowPtr  row pointers (length n+1)
+	 * @param[in]  colInd  column indices of the non-zero entries (length rowPtr[n])
+	 */
+	void setPattern( fmippSize n, const std::vector<fmippSize>& rowPtr,
+		const std::vector<fmippSize>& colInd );
+
+	/// Returns true iff no sparsity pattern has been set.
+	fmippBoolean isEmpty() const { return 0 == n_; }
+
+	/// Get the dimension of the Jacobian.
+	fmippSize getDimension() const { return n_; }
+
+	/// Get the number of structurally non-zero entries.
+	fmippSize getNumberOfNonZeros() const { return colInd_.size(); }
+
+	/// Get the number of colors, i.e., the number of evaluations needed for a Jacobian.
+	fmippSize getNumberOfColors() const { return groups_.size(); }
+
+	/// Get the row pointers (CSR format).
+	const std::vector<fmippSize>& getRowPointers() const { return rowPtr_; }
+
+	/// Get the column indices of the non-zero entries (CSR format).
+	const std::vector<fmippSize>& getColumnIndices() const { return colInd_; }
+
+	/// Get the columns belonging to color c.
+	const std::vector<fmippSize>& getColumnsOfColor( fmippSize c ) const { return groups_[c]; }
+
+	/// Get the values of the non-zero entries (CSR format).
+	std::vector<fmippReal>& getValues() { return values_; }
+
+	/// Get the values of the non-zero entries (CSR format).
+	const std::vector<fmippReal>& getValues() const { return values_; }
+
+	/**
+	 * Write a compressed column into the values of the Jacobian.
+	 *
+	 * @param[in]  c       the color of the compressed column
+	 * @param[in]  column  vector of length n containing the sum of all columns of color c
+	 */
+	void setCompressedColumn( fmippSize c, const fmippReal* column );
+
+	/// Write the Jacobian into a dense matrix, J[ n*i + j ] = df_i/dx_j (rowwise).
+	void getDenseRowMajor( fmippReal* J ) const;
+
+	/// Write the Jacobian into a dense matrix, J[ n*j + i ] = df_i/dx_j (columnwise).
+	void getDenseColumnMajor( fmippReal* J ) const;
+
+private:
+
+	/// Greedy distance-2 coloring of the columns (Curtis-Powell-Reid).
+	void colorColumns();
+
+	fmippSize n_; ///< Dimension of the Jacobian.
+
+	std::vector<fmippSize> rowPtr_; ///< Row pointers.
+	std::vector<fmippSize> colInd_; ///< Column indices of the non-zero entries.
+	std::vector<fmippSize> rowInd_; ///< Row indices of the non-zero entries.
+	std::vector<fmippReal> values_; ///< Values of the non-zero entries.
+
+	std::vector< std::vector<fmippSize> > groups_;  ///< Columns of each color.
+	std::vector< std::vector<fmippSize> > entries_; ///< Non-zero entries of each color.
+};
+
+#endif // _FMIPP_SPARSEJACOBIAN_H
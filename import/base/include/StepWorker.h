@@ -0,0 +1,74 @@
+// -------------------------------------------------------------------
+// Copyright (c) 2013-2022, AIT Austrian Institute of Technology GmbH.
+// All rights reserved. See file FMIPP_LICENSE for details.
+// -------------------------------------------------------------------
+
+#ifndef _FMIPP_STEPWORKER_H
+#define _FMIPP_STEPWORKER_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+
+#include "common/FMIPPConfig.h"
+
+
+/**
+ * \file StepWorker.h
+ *
+ * \class StepWorker StepWorker.h
+ * Thread executing the tasks of a single FMU instance one after the other, e.g., the communication
+ * steps started by FMUCoSimulationBase::doStepAsync.
+ *
+ * The thread is started with the first task. The destructor finishes all submitted tasks before it
+ * stops the thread.
+ */
+class __FMI_DLL StepWorker
+{
+
+public:
+
+	/// Task to be executed, returns the status of the task.
+	typedef std::function<fmippStatus()> Task;
+
+	/// Handle for the status of a task, ready when the task is finished.
+	typedef std::shared_future<fmippStatus> Future;
+
+	/// Constructor.
+	StepWorker();
+
+	/// Destructor, waits for all submitted tasks to finish.
+	~StepWorker();
+
+	/// Execute a task in the worker thread after all previously submitted tasks.
+	Future run( const Task& task );
+
+	/// Get a handle that is ready already, e.g., for tasks that failed before being submitted.
+	static Future ready( fmippStatus status );
+
+private:
+
+	/// Task together with the promise for its status.
+	typedef std::pair< Task, std::promise<fmippStatus> > Job;
+
+	/// Function executed by the worker thread.
+	void work();
+
+	std::thread thread_; ///< Worker thread.
+
+	std::mutex mutex_; ///< Protects jobs_ and stop_.
+
+	std::condition_variable wakeUp_; ///< Notifies the worker thread about new jobs.
+
+	std::deque<Job> jobs_; ///< Submitted jobs, not started yet.
+
+	bool stop_; ///< Flag telling the worker thread to stop when all jobs are done.
+
+	StepWorker( const StepWorker& ); ///< Prevent copying.
+	StepWorker& operator=( const StepWorker& ); ///< Prevent copying.
+};
+
+#endif // _FMIPP_STEPWORKER_H
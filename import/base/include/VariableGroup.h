@@ -0,0 +1,119 @@
+// -------------------------------------------------------------------
+// Copyright (c) 2013-2022, AIT Austrian Institute of Technology GmbH.
+// All rights reserved. See file FMIPP_LICENSE for details.
+// -------------------------------------------------------------------
+
+#ifndef _FMIPP_VARIABLEGROUP_H
+#define _FMIPP_VARIABLEGROUP_H
+
+#include <vector>
+
+#include "common/FMIPPConfig.h"
+
+class FMUBase;
+
+/**
+ * \file VariableGroup.h
+ *
+ * \class VariableGroup VariableGroup.h
+ * Named set of variables, which are read and written together.
+ *
+ * The variables of a group are resolved to value references once and are sorted by type.
+ * All variables of the same type are then read or written with a single call to the FMU
+ * ( e.g., fmi2GetReal or fmi2SetReal ), using a contiguous buffer provided by the caller.
+ * The values in this buffer are in the order in which the variables have been added.
+ * A group can be used with any FMU sharing the same model description.
+ */
+
+class __FMI_DLL VariableGroup
+{
+
+public:
+
+	/**
+	 * Constructor.
+	 *
+	 * @param[in]  name  name of the group
+	 */
+	VariableGroup( const fmippString& name = fmippString() );
+
+	/// Get the name of the group.
+	const fmippString& getName() const { return name_; }
+
+	/**
+	 * Add a variable to the group.
+	 *
+	 * @param[in]  type  type of the variable
+	 * @param[in]  valueRef  value reference of the variable
+	 */
+	void add( FMIPPVariableType type, fmippValueReference valueRef );
+
+	/**
+	 * Add a variable to the group, using its name. The type is retrieved from the FMU.
+	 *
+	 * @param[in]  fmu  FMU the variable belongs to
+	 * @param[in]  variableName  name of the variable
+	 * @return false if the variable does not exist
+	 */
+	bool add( const FMUBase& fmu, const fmippString& variableName );
+
+	/**
+	 * Replace all variables of a type, using their names.
+	 *
+	 * @param[in]  fmu  FMU the variables belong to
+	 * @param[in]  type  type of the variables
+	 * @param[in]  variableNames  names of the variables
+	 * @param[in]  nVariables  number of variables
+	 */
+	void define( const FMUBase& fmu, FMIPPVariableType type,
+		const fmippString variableNames[], fmippSize nVariables );
+
+	/// Remove all variables from the group.
+	void clear();
+
+	/// Get the number of variables of a type.
+	fmippSize size( FMIPPVariableType type ) const;
+
+	/// Get the value reference of the i-th variable of a type.
+	fmippValueReference getValueRef( FMIPPVariableType type, fmippSize i ) const;
+
+	/// Get the number of calls to the FMU needed to read or write all variables of the group.
+	fmippSize nCalls() const;
+
+	/// Get the values of all real variables of the group.
+	fmippStatus getValues( FMUBase& fmu, fmippReal* val ) const;
+
+	/// Get the values of all integer variables of the group.
+	fmippStatus getValues( FMUBase& fmu, fmippInteger* val ) const;
+
+	/// Get the values of all boolean variables of the group.
+	fmippStatus getValues( FMUBase& fmu, fmippBoolean* val ) const;
+
+	/// Get the values of all string variables of the group.
+	fmippStatus getValues( FMUBase& fmu, fmippString* val ) const;
+
+	/// Set the values of all real variables of the group.
+	fmippStatus setValues( FMUBase& fmu, const fmippReal* val ) const;
+
+	/// Set the values of all integer variables of the group.
+	fmippStatus setValues( FMUBase& fmu, const fmippInteger* val ) const;
+
+	/// Set the values of all boolean variables of the group.
+	fmippStatus setValues( FMUBase& fmu, const fmippBoolean* val ) const;
+
+	/// Set the values of all string variables of the group.
+	fmippStatus setValues( FMUBase& fmu, const fmippString* val ) const;
+
+private:
+
+	/// Number of variable types that can be part of a group ( fmippTypeUnknown excluded ).
+	static const fmippSize nTypes = fmippTypeUnknown;
+
+	fmippString name_; ///< Name of the group.
+
+	/// Value references of the variables, one vector per type ( indexed by FMIPPVariableType ).
+	std::vector<fmippValueReference> valueRefs_[nTypes];
+};
+
+
+#endif // _FMIPP_VARIABLEGROUP_H
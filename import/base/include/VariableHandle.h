@@ -0,0 +1,88 @@
+// -------------------------------------------------------------------
+// Copyright (c) 2013-2022, AIT Austrian Institute of Technology GmbH.
+// All rights reserved. See file FMIPP_LICENSE for details.
+// -------------------------------------------------------------------
+
+#ifndef _FMIPP_VARIABLEHANDLE_H
+#define _FMIPP_VARIABLEHANDLE_H
+
+#include "common/FMIPPConfig.h"
+#include "import/base/include/FMUBase.h"
+
+
+/// Maps the types of variable values to the corresponding FMIPPVariableType.
+template<typename Type> struct VariableHandleTraits;
+
+template<> struct VariableHandleTraits<fmippReal> { static const FMIPPVariableType type = fmippTypeReal; };
+template<> struct VariableHandleTraits<fmippInteger> { static const FMIPPVariableType type = fmippTypeInteger; };
+template<> struct VariableHandleTraits<fmippBoolean> { static const FMIPPVariableType type = fmippTypeBoolean; };
+template<> struct VariableHandleTraits<fmippString> { static const FMIPPVariableType type = fmippTypeString; };
+
+
+/**
+ * \file VariableHandle.h
+ *
+ * \class VariableHandle VariableHandle.h
+ * Typed handle for a single variable of an FMU.
+ *
+ * The variable name is resolved once when the handle is created ( see FMUBase::resolve ),
+ * afterwards values are read and written via the value reference without any lookup.
+ * A handle is invalid if the variable does not exist or has a different type. The FMU
+ * must outlive all handles created for it.
+ */
+template<typename Type>
+class VariableHandle
+{
+
+public:
+
+	/// Default constructor, creates an invalid handle.
+	VariableHandle() : fmu_( 0 ), valueRef_( fmippUndefinedValueReference ) {}
+
+	/**
+	 * Constructor.
+	 *
+	 * @param[in]  fmu  the FMU the variable belongs to
+	 * @param[in]  name  name of the variable
+	 */
+	VariableHandle( FMUBase& fmu, const fmippString& name ) :
+		fmu_( 0 ), valueRef_( fmippUndefinedValueReference )
+	{
+		if ( VariableHandleTraits<Type>::type == fmu.getType( name ) ) {
+			fmu_ = &fmu;
+			valueRef_ = fmu.getValueRef( name );
+		}
+	}
+
+	/// Check if the handle refers to a variable of the requested type.
+	bool isValid() const { return 0 != fmu_; }
+
+	/// Get the value reference of the variable.
+	fmippValueReference getValueReference() const { return valueRef_; }
+
+	/// Get the value of the variable.
+	fmippStatus get( Type& val ) const {
+		return isValid() ? fmu_->getValue( valueRef_, val ) : fmippError;
+	}
+
+	/// Set the value of the variable.
+	fmippStatus set( const Type& val ) const {
+		return isValid() ? fmu_->setValue( valueRef_, val ) : fmippError;
+	}
+
+private:
+
+	FMUBase* fmu_; ///< The FMU the variable belongs to ( null for invalid handles ).
+
+	fmippValueReference valueRef_; ///< Value reference of the variable.
+};
+
+
+template<typename Type>
+VariableHandle<Type> FMUBase::resolve( const fmippString& name )
+{
+	return VariableHandle<Type>( *this, name );
+}
+
+
+#endif // _FMIPP_VARIABLEHANDLE_H
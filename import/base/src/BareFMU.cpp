@@ -7,13 +7,15 @@
  * \file BareFMU.cpp
  */
 
+#include <cstdio>
+
 #include "import/base/include/BareFMU.h"
 #include "import/base/include/ModelDescription.h"
 
 // Helper function for deleting bare FMUs.
 template<typename BareFMUType> void deleteBareFMUContent( BareFMUType* bareFMU )
 {
-		if ( 0 != bareFMU->functions->dllHandle ) {
+		if ( ( 0 != bareFMU->functions ) && ( 0 != bareFMU->functions->dllHandle ) ) {
 #if defined(MINGW)
 			FreeLibrary( static_cast<HMODULE>( bareFMU->functions->dllHandle ) );
 #elif defined(_MSC_VER)
@@ -23,8 +25,12 @@ template<typename BareFMUType> void deleteBareFMUContent( BareFMUType* bareFMU )
 #endif
 		}
 
+		// The file of a private copy of the shared library can only be deleted after unloading it.
+		if ( !bareFMU->dllCopyPath.empty() ) std::remove( bareFMU->dllCopyPath.c_str() );
+
 		if ( 0 != bareFMU->functions ) delete bareFMU->functions;
-		if ( 0 != bareFMU->description ) delete bareFMU->description;
+		// The model description of private copies is owned by the shared bare FMU.
+		if ( ( 0 != bareFMU->description ) && !bareFMU->sharedFMU ) delete bareFMU->description;
 }
 
 BareFMUModelExchange::~BareFMUModelExchange()
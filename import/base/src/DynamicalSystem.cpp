@@ -10,12 +10,14 @@
 DynamicalSystem::DynamicalSystem()
 {
 	integrator_           = new Integrator( this );
+	evaluationCache_      = new ModelEvaluationCache( integrator_->statistics() );
 	savedEventIndicators_ = 0;
 	currentEventIndicators_ = 0;
 }
 
 DynamicalSystem::~DynamicalSystem()
 {
+	delete evaluationCache_;
 	delete integrator_;
 	if ( 0 != savedEventIndicators_ )
 		delete savedEventIndicators_;
@@ -23,14 +25,34 @@ DynamicalSystem::~DynamicalSystem()
 		delete currentEventIndicators_;
 }
 
+void DynamicalSystem::modelChanged()
+{
+	integrator_->reset();
+	evaluationCache_->invalidate();
+}
+
 fmippStatus DynamicalSystem::getJac( fmippReal* J ){
 	/* if this function is not overwiritten by derived classes, warn the user about the not
 	   implemented functionality */
 	return fmippWarning;
 }
 
+fmippStatus DynamicalSystem::getSparseJac( SparseJacobian& J ){
+	/* if this function is not overwiritten by derived classes, warn the user about the not
+	   implemented functionality */
+	return fmippWarning;
+}
+
 void DynamicalSystem::getNumericalJacobian( fmippReal* J, const fmippReal* x, fmippReal* dfdt, const fmippTime t )
 {
+	if ( providesJacobianSparsity() ){
+		// perturb structurally orthogonal columns together and expand the result
+		SparseJacobian sparseJ( jacobianSparsity_ );
+		getSparseNumericalJacobian( sparseJ, x, dfdt, t );
+		sparseJ.getDenseRowMajor( J );
+		return;
+	}
+
 	/**
 	 * the method used is of 6th order and uses 6*NEQ rhs evaluations. for comparison - the forward
 	 * differences method (1st order) uses NEQ+1 rhs evaluations.
@@ -92,6 +114,70 @@ void DynamicalSystem::getNumericalJacobian( fmippReal* J, const fmippReal* x, fm
 	setContinuousStates( xp );
 
 	// calculate the derivative with respect to time using the same stategy as before.
+	getNumericalTimeDerivative( dfdt, dx, t );
+	delete dx;
+}
+
+void DynamicalSystem::getSparseNumericalJacobian( SparseJacobian& J, const fmippReal* x, fmippReal* dfdt, const fmippTime t )
+{
+	if ( J.isEmpty() ) J = jacobianSparsity_;
+
+	/**
+	 * same method as in getNumericalJacobian, but each rhs evaluation yields the sum of all
+	 * columns of one color. Therefore, 6*nColors rhs evaluations are used instead of 6*NEQ.
+	 */
+	const int steps = 3;
+	NumericalJacobianCoefficients<steps> coefs;
+	const unsigned int N = nStates();
+	std::vector<fmippReal> xp( x, x + N );
+	std::vector<fmippReal> dx( N );
+	std::vector<fmippReal> column( N );
+
+	setTime( t );
+
+	// step size for the finite difference ( see getNumericalJacobian )
+	fmippReal h = 1.0e-5;
+
+	for( fmippSize c = 0; c < J.getNumberOfColors(); c++ ){
+		const std::vector<fmippSize>& columns = J.getColumnsOfColor( c );
+
+		// calculate the c-th compressed column of the jacobian matrix
+		for( unsigned int i = 0; i < N; i++ )
+			column[i] = 0;
+
+		for( unsigned int k = 0; k < steps; k++ ){
+			for( fmippSize j = 0; j < columns.size(); j++ )
+				xp[ columns[j] ] = x[ columns[j] ] + ( k + 1.0 )*h;
+			setContinuousStates( &xp[0] );
+			getDerivatives( &dx[0] );
+			for( unsigned int i = 0; i < N; i++ )
+				column[i] += dx[i]*coefs[k]/h;
+
+			for( fmippSize j = 0; j < columns.size(); j++ )
+				xp[ columns[j] ] = x[ columns[j] ] - ( k + 1.0 )*h;
+			setContinuousStates( &xp[0] );
+			getDerivatives( &dx[0] );
+			for( unsigned int i = 0; i < N; i++ )
+				column[i] -= dx[i]*coefs[k]/h;
+		}
+
+		for( fmippSize j = 0; j < columns.size(); j++ )
+			xp[ columns[j] ] = x[ columns[j] ];
+
+		J.setCompressedColumn( c, &column[0] );
+	}
+	setContinuousStates( x );
+
+	getNumericalTimeDerivative( dfdt, &dx[0], t );
+}
+
+void DynamicalSystem::getNumericalTimeDerivative( fmippReal* dfdt, fmippReal* dx, const fmippTime t )
+{
+	const int steps = 3;
+	NumericalJacobianCoefficients<steps> coefs;
+	const unsigned int N = nStates();
+	fmippReal h = 1.0e-5;
+
 	fmippTime t2 = t;
 	for( unsigned int i = 0; i < N; i++ )
 		dfdt[i] = 0.0;
@@ -112,7 +198,6 @@ void DynamicalSystem::getNumericalJacobian( fmippReal* J, const fmippReal* x, fm
 			}
 		t2 += (k+1.0)*h;
 	}
-	delete dx;
 }
 
 void DynamicalSystem::saveEventIndicators(){
@@ -123,6 +208,10 @@ void DynamicalSystem::saveEventIndicators(){
 }
 
 bool DynamicalSystem::checkStateEvent(){
+	Integrator::Statistics& statistics = integrator_->statistics();
+	StatisticsTimer timer( statistics.stateEventCheckTime );
+	++statistics.stateEventChecks;
+
 	if ( 0 == savedEventIndicators_ )
 		return false;
 
@@ -0,0 +1,553 @@
+// -------------------------------------------------------------------
+// Copyright (c) 2013-2022, AIT Austrian Institute of Technology GmbH.
+// All rights reserved. See file FMIPP_LICENSE for details.
+// -------------------------------------------------------------------
+
+/// \file FMUArchive.cpp
+
+#if defined(_MSC_VER)
+#define _CRT_SECURE_NO_WARNINGS
+#endif
+
+#if defined( WIN32 )
+#include <windows.h>
+#include <direct.h>
+#include <process.h>
+#else
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+#endif
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#ifdef USE_ZLIB
+#include <zlib.h>
+#endif
+
+#include "import/base/include/FMUArchive.h"
+
+using namespace std;
+
+
+namespace {
+
+	const unsigned int endOfCentralDirectorySignature = 0x06054b50;
+	const unsigned int centralDirectorySignature = 0x02014b50;
+	const unsigned int localFileHeaderSignature = 0x04034b50;
+
+	const fmippSize endOfCentralDirectorySize = 22;
+	const fmippSize centralDirectoryHeaderSize = 46;
+	const fmippSize localFileHeaderSize = 30;
+
+	const unsigned int methodStored = 0;
+	const unsigned int methodDeflated = 8;
+
+	const unsigned int flagEncrypted = 0x1;
+
+	const unsigned int hostUnix = 3;
+
+	/// Size of the chunks passed on when decompressing entries.
+	const fmippSize chunkSize = 1 << 16;
+
+	/// Read a 16-bit little-endian integer.
+	unsigned int read16( const unsigned char* p )
+	{
+		return static_cast<unsigned int>( p[0] ) | ( static_cast<unsigned int>( p[1] ) << 8 );
+	}
+
+	/// Read a 32-bit little-endian integer.
+	unsigned int read32( const unsigned char* p )
+	{
+		return read16( p ) | ( read16( p + 2 ) << 16 );
+	}
+
+	/// Update a CRC-32 checksum ( as used in zip archives ) with the given bytes.
+	unsigned int updateCrc32( unsigned int crc, const unsigned char* begin, fmippSize size )
+	{
+#ifdef USE_ZLIB
+		return static_cast<unsigned int>( crc32( crc, begin, static_cast<uInt>( size ) ) );
+#else
+		static const std::vector<unsigned int> table = []()
+		{
+			std::vector<unsigned int> table( 256 );
+			for ( unsigned int i = 0; i < 256; ++i ) {
+				unsigned int c = i;
+				for ( int k = 0; k < 8; ++k ) c = ( c & 1 ) ? 0xedb88320U ^ ( c >> 1 ) : c >> 1;
+				table[i] = c;
+			}
+			return table;
+		}();
+
+		crc = ~crc;
+		for ( const unsigned char* p = begin; p != begin + size; ++p )
+			crc = table[( crc ^ *p ) & 0xff] ^ ( crc >> 8 );
+		return ~crc;
+#endif
+	}
+
+	/// 64-bit FNV-1a hash, continuing from the given hash.
+	unsigned long long hashBytes( const unsigned char* begin, fmippSize size,
+		unsigned long long hash = 14695981039346656037ULL )
+	{
+		for ( const unsigned char* p = begin; p != begin + size; ++p ) {
+			hash ^= *p;
+			hash *= 1099511628211ULL;
+		}
+		return hash;
+	}
+
+	/// Check that an entry name does not refer to a location outside of the extraction directory.
+	bool isSafeEntryName( const fmippString& name )
+	{
+		if ( name.empty() || ( '/' == name[0] ) || ( fmippString::npos != name.find( ':' ) ) ) return false;
+
+		istringstream components( name );
+		fmippString component;
+		while ( getline( components, component, '/' ) )
+			if ( ".." == component ) return false;
+		return true;
+	}
+
+	/// Join two paths.
+	fmippString joinPath( const fmippString& directory, const fmippString& name )
+	{
+		if ( directory.empty() ) return name;
+		const char last = directory[directory.size() - 1];
+		if ( ( '/' == last ) || ( '\\' == last ) ) return directory + name;
+		return directory + '/' + name;
+	}
+
+	/// Get the size of a file, returns false if it does not exist.
+	bool getFileSize( const fmippString& path, fmippSize& size )
+	{
+#if defined( WIN32 )
+		WIN32_FILE_ATTRIBUTE_DATA attributes;
+		if ( !GetFileAttributesExA( path.c_str(), GetFileExInfoStandard, &attributes ) ) return false;
+		if ( attributes.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY ) return false;
+		size = ( static_cast<fmippSize>( attributes.nFileSizeHigh ) << 32 ) | attributes.nFileSizeLow;
+#else
+		struct stat status;
+		if ( ( 0 != stat( path.c_str(), &status ) ) || !S_ISREG( status.st_mode ) ) return false;
+		size = static_cast<fmippSize>( status.st_size );
+#endif
+		return true;
+	}
+
+	/// Create a directory, including all missing parent directories ( accessible by the calling user only ).
+	bool makeDirectories( const fmippString& path )
+	{
+		for ( fmippSize pos = 1; pos <= path.size(); ++pos ) {
+			if ( ( pos < path.size() ) && ( '/' != path[pos] ) && ( '\\' != path[pos] ) ) continue;
+			if ( ':' == path[pos - 1] ) continue; // drive letter ( Windows )
+
+			const fmippString parent = path.substr( 0, pos );
+#if defined( WIN32 )
+			if ( ( 0 != _mkdir( parent.c_str() ) ) && ( EEXIST != errno ) ) return false;
+#else
+			if ( ( 0 != mkdir( parent.c_str(), 0700 ) ) && ( EEXIST != errno ) ) return false;
+#endif
+		}
+		return true;
+	}
+
+	/// Check that a directory is owned by the calling user and not writable by the group or others.
+	bool isPrivateDirectory( const fmippString& path )
+	{
+#if defined( WIN32 )
+		// Directories in the profile of the user are protected by their access control lists.
+		const DWORD attributes = GetFileAttributesA( path.c_str() );
+		return ( INVALID_FILE_ATTRIBUTES != attributes ) && ( attributes & FILE_ATTRIBUTE_DIRECTORY );
+#else
+		struct stat status;
+		if ( ( 0 != lstat( path.c_str(), &status ) ) || !S_ISDIR( status.st_mode ) ) return false;
+		return ( geteuid() == status.st_uid ) && ( 0 == ( status.st_mode & ( S_IWGRP | S_IWOTH ) ) );
+#endif
+	}
+
+	/// Replace a file by another one ( atomically, if supported by the system ).
+	bool replaceFile( const fmippString& from, const fmippString& to )
+	{
+#if defined( WIN32 )
+		return 0 != MoveFileExA( from.c_str(), to.c_str(), MOVEFILE_REPLACE_EXISTING );
+#else
+		return 0 == rename( from.c_str(), to.c_str() );
+#endif
+	}
+
+	/// Get a suffix for temporary files that is unique for the calling thread and process.
+	fmippString getTemporarySuffix()
+	{
+		ostringstream suffix;
+#if defined( WIN32 )
+		suffix << '.' << _getpid();
+#else
+		suffix << '.' << getpid();
+#endif
+		suffix << '.' << std::hash<thread::id>()( this_thread::get_id() ) << ".tmp";
+		return suffix.str();
+	}
+
+}
+
+
+const char* const FMUArchive::extractionCompleteFileName = ".fmipp-extracted";
+
+
+struct FMUArchive::Mapping
+{
+	Mapping( const fmippString& archiveFilePath ) :
+		file( archiveFilePath.c_str(), boost::interprocess::read_only ),
+		region( file, boost::interprocess::read_only )
+	{}
+
+	boost::interprocess::file_mapping file;
+	boost::interprocess::mapped_region region;
+};
+
+
+FMUArchive::FMUArchive( const fmippString& archiveFilePath ) :
+	archiveFilePath_( archiveFilePath ),
+	data_( 0 ),
+	size_( 0 ),
+	hash_( 0 ),
+	isValid_( fmippFalse )
+{
+	try {
+		if ( !ifstream( archiveFilePath.c_str() ) ) return;
+
+		mapping_.reset( new Mapping( archiveFilePath ) );
+		data_ = static_cast<const unsigned char*>( mapping_->region.get_address() );
+		size_ = mapping_->region.get_size();
+	} catch ( ... ) {
+		mapping_.reset();
+		data_ = 0;
+		size_ = 0;
+		return;
+	}
+
+	isValid_ = parse();
+	if ( !isValid_ ) entries_.clear();
+}
+
+
+FMUArchive::~FMUArchive()
+{}
+
+
+fmippBoolean
+FMUArchive::hasEntry( const fmippString& name ) const
+{
+	return find( name ) < entries_.size();
+}
+
+
+fmippBoolean
+FMUArchive::read( const fmippString& name, fmippString& content ) const
+{
+	const fmippSize i = find( name );
+	if ( i == entries_.size() ) return fmippFalse;
+
+	content.clear();
+	content.reserve( entries_[i].uncompressedSize );
+	return decompress( entries_[i], [&content]( const char* chunk, fmippSize size ) -> bool
+	{
+		content.append( chunk, size );
+		return true;
+	} );
+}
+
+
+fmippString
+FMUArchive::getExtractionPath( const fmippString& cacheDirectory ) const
+{
+	ostringstream name;
+	name << hex;
+	name.width( 16 );
+	name.fill( '0' );
+	name << hash_;
+	return joinPath( cacheDirectory, name.str() );
+}
+
+
+fmippBoolean
+FMUArchive::extract( const fmippString& directory, fmippSize* nExtracted ) const
+{
+	if ( nExtracted ) *nExtracted = 0;
+	if ( !isValid_ ) return fmippFalse;
+
+	// Files from other users must never be loaded.
+	if ( !makeDirectories( directory ) || !isPrivateDirectory( directory ) ) return fmippFalse;
+
+	// Files that have been extracted before are only kept if their checksums match, even if the
+	// archive has been extracted completely before.
+	const fmippString markerFilePath = joinPath( directory, extractionCompleteFileName );
+
+	for ( std::vector<Entry>::const_iterator it = entries_.begin(); it != entries_.end(); ++it ) {
+		if ( '/' == it->name[it->name.size() - 1] ) {
+			if ( !makeDirectories( joinPath( directory, it->name ) ) ) return fmippFalse;
+		} else if ( !extractFile( *it, directory, nExtracted ) ) {
+			return fmippFalse;
+		}
+	}
+
+	// Mark the archive as extracted ( another process may do the same concurrently ).
+	fmippSize markerSize;
+	if ( getFileSize( markerFilePath, markerSize ) ) return fmippTrue;
+	const fmippString tmpFilePath = markerFilePath + getTemporarySuffix();
+	{
+		ofstream marker( tmpFilePath.c_str(), ios::out | ios::trunc );
+		marker << archiveFilePath_ << endl;
+	}
+	if ( !replaceFile( tmpFilePath, markerFilePath ) ) remove( tmpFilePath.c_str() );
+
+	return fmippTrue;
+}
+
+
+fmippBoolean
+FMUArchive::isArchive( const fmippString& path )
+{
+	if ( path.size() < 4 ) return fmippFalse;
+
+	fmippString extension = path.substr( path.size() - 4 );
+	for ( fmippString::iterator it = extension.begin(); it != extension.end(); ++it )
+		*it = static_cast<char>( tolower( static_cast<unsigned char>( *it ) ) );
+	return ".fmu" == extension;
+}
+
+
+fmippString
+FMUArchive::getDefaultCacheDirectory()
+{
+#if defined( WIN32 )
+	char tmpPath[MAX_PATH + 1];
+	const DWORD length = GetTempPathA( MAX_PATH + 1, tmpPath );
+	const fmippString tmpDirectory = ( ( length > 0 ) && ( length <= MAX_PATH ) ) ? fmippString( tmpPath, length ) : ".";
+	return joinPath( tmpDirectory, "fmipp-fmus" );
+#else
+	// Only absolute paths are valid according to the XDG base directory specification.
+	const char* cacheHome = getenv( "XDG_CACHE_HOME" );
+	if ( cacheHome && ( '/' == *cacheHome ) ) return joinPath( cacheHome, "fmipp" );
+
+	const char* home = getenv( "HOME" );
+	if ( home && ( '/' == *home ) ) return joinPath( joinPath( home, ".cache" ), "fmipp" );
+
+	const char* tmpDir = getenv( "TMPDIR" );
+	ostringstream name;
+	name << "fmipp-" << geteuid();
+	return joinPath( ( tmpDir && *tmpDir ) ? tmpDir : "/tmp", name.str() );
+#endif
+}
+
+
+fmippBoolean
+FMUArchive::makeCacheDirectory( const fmippString& cacheDirectory )
+{
+	return makeDirectories( cacheDirectory ) && isPrivateDirectory( cacheDirectory );
+}
+
+
+// Parse the central directory of the archive.
+fmippBoolean
+FMUArchive::parse()
+{
+	if ( size_ < endOfCentralDirectorySize ) return fmippFalse;
+
+	// Search the end of central directory record, which may be followed by a comment.
+	fmippSize eocd = size_ - endOfCentralDirectorySize;
+	const fmippSize minEocd = ( eocd > 0xffff ) ? eocd - 0xffff : 0;
+	while ( endOfCentralDirectorySignature != read32( data_ + eocd ) ) {
+		if ( eocd == minEocd ) return fmippFalse;
+		--eocd;
+	}
+
+	const fmippSize nEntries = read16( data_ + eocd + 10 );
+	const fmippSize directorySize = read32( data_ + eocd + 12 );
+	const fmippSize directoryOffset = read32( data_ + eocd + 16 );
+
+	// Multi-disk and ZIP64 archives are not supported.
+	if ( ( 0 != read16( data_ + eocd + 4 ) ) || ( 0 != read16( data_ + eocd + 6 ) ) ) return fmippFalse;
+	if ( ( 0xffff == nEntries ) || ( 0xffffffff == directoryOffset ) ) return fmippFalse;
+	if ( ( directoryOffset > eocd ) || ( directorySize > eocd - directoryOffset ) ) return fmippFalse;
+
+	// The central directory describes the content of the archive ( names, sizes and checksums ).
+	hash_ = hashBytes( data_ + directoryOffset, directorySize );
+
+	entries_.reserve( nEntries );
+	fmippSize pos = directoryOffset;
+	const fmippSize end = directoryOffset + directorySize;
+	for ( fmippSize i = 0; i < nEntries; ++i ) {
+		if ( ( end - pos < centralDirectoryHeaderSize ) ||
+		     ( centralDirectorySignature != read32( data_ + pos ) ) ) return fmippFalse;
+
+		const unsigned char* header = data_ + pos;
+		const fmippSize nameLength = read16( header + 28 );
+		const fmippSize extraLength = read16( header + 30 );
+		const fmippSize commentLength = read16( header + 32 );
+		if ( end - pos - centralDirectoryHeaderSize < nameLength + extraLength + commentLength ) return fmippFalse;
+
+		Entry entry;
+		entry.name.assign( reinterpret_cast<const char*>( header + centralDirectoryHeaderSize ), nameLength );
+		for ( fmippString::iterator it = entry.name.begin(); it != entry.name.end(); ++it )
+			if ( '\\' == *it ) *it = '/';
+		while ( 0 == entry.name.compare( 0, 2, "./" ) ) entry.name.erase( 0, 2 );
+		entry.flags = read16( header + 8 );
+		entry.method = read16( header + 10 );
+		entry.crc = read32( header + 16 );
+		entry.compressedSize = read32( header + 20 );
+		entry.uncompressedSize = read32( header + 24 );
+		entry.localHeaderOffset = read32( header + 42 );
+		entry.mode = ( hostUnix == ( read16( header + 4 ) >> 8 ) ) ? ( read32( header + 38 ) >> 16 ) & 0777 : 0;
+
+		if ( ( 0xffffffff == entry.compressedSize ) || ( 0xffffffff == entry.uncompressedSize ) ||
+		     ( 0xffffffff == entry.localHeaderOffset ) ) return fmippFalse;
+		pos += centralDirectoryHeaderSize + nameLength + extraLength + commentLength;
+
+		if ( entry.name.empty() ) continue; // root directory
+		if ( !isSafeEntryName( entry.name ) ) return fmippFalse;
+
+		entries_.push_back( entry );
+	}
+
+	return fmippTrue;
+}
+
+
+fmippSize
+FMUArchive::find( const fmippString& name ) const
+{
+	fmippSize i = 0;
+	while ( ( i < entries_.size() ) && ( entries_[i].name != name ) ) ++i;
+	return i;
+}
+
+
+fmippBoolean
+FMUArchive::decompress( const Entry& entry,
+	const std::function<bool( const char*, fmippSize )>& write ) const
+{
+	if ( entry.flags & flagEncrypted ) return fmippFalse;
+
+	// The local file header may contain a different extra field than the central directory.
+	const fmippSize pos = entry.localHeaderOffset;
+	if ( ( size_ < localFileHeaderSize ) || ( size_ - localFileHeaderSize < pos ) ||
+	     ( localFileHeaderSignature != read32( data_ + pos ) ) ) return fmippFalse;
+	const fmippSize begin = pos + localFileHeaderSize + read16( data_ + pos + 26 ) + read16( data_ + pos + 28 );
+	if ( ( begin > size_ ) || ( entry.compressedSize > size_ - begin ) ) return fmippFalse;
+
+	const unsigned char* compressed = data_ + begin;
+
+	if ( methodStored == entry.method ) {
+		if ( entry.compressedSize != entry.uncompressedSize ) return fmippFalse;
+		if ( entry.crc != updateCrc32( 0, compressed, entry.compressedSize ) ) return fmippFalse;
+		for ( fmippSize offset = 0; offset < entry.compressedSize; offset += chunkSize ) {
+			const fmippSize n = ( entry.compressedSize - offset < chunkSize ) ? entry.compressedSize - offset : chunkSize;
+			if ( !write( reinterpret_cast<const char*>( compressed + offset ), n ) ) return fmippFalse;
+		}
+		return fmippTrue;
+	}
+
+#ifdef USE_ZLIB
+	if ( methodDeflated == entry.method ) {
+		z_stream stream;
+		stream.zalloc = Z_NULL;
+		stream.zfree = Z_NULL;
+		stream.opaque = Z_NULL;
+		stream.next_in = const_cast<Bytef*>( compressed );
+		stream.avail_in = static_cast<uInt>( entry.compressedSize );
+
+		// Raw deflate data ( without zlib header ).
+		if ( Z_OK != inflateInit2( &stream, -MAX_WBITS ) ) return fmippFalse;
+
+		std::vector<unsigned char> chunk( chunkSize );
+		uLong crc = crc32( 0L, Z_NULL, 0 );
+		fmippSize total = 0;
+		int status = Z_OK;
+		while ( Z_OK == status ) {
+			stream.next_out = chunk.data();
+			stream.avail_out = static_cast<uInt>( chunk.size() );
+			status = inflate( &stream, Z_NO_FLUSH );
+			if ( ( Z_OK != status ) && ( Z_STREAM_END != status ) ) break;
+
+			const fmippSize n = chunk.size() - stream.avail_out;
+			crc = crc32( crc, chunk.data(), static_cast<uInt>( n ) );
+			total += n;
+			if ( !write( reinterpret_cast<const char*>( chunk.data() ), n ) ) status = Z_STREAM_ERROR;
+		}
+		inflateEnd( &stream );
+
+		return ( Z_STREAM_END == status ) && ( total == entry.uncompressedSize ) && ( crc == entry.crc );
+	}
+#endif
+
+	return fmippFalse; // unsupported compression method
+}
+
+
+fmippBoolean
+FMUArchive::isExtracted( const Entry& entry, const fmippString& filePath )
+{
+	fmippSize size;
+	if ( !getFileSize( filePath, size ) || ( entry.uncompressedSize != size ) ) return fmippFalse;
+
+	ifstream file( filePath.c_str(), ios::in | ios::binary );
+	std::vector<char> chunk( chunkSize );
+	unsigned int crc = 0;
+	while ( file ) {
+		file.read( chunk.data(), chunk.size() );
+		crc = updateCrc32( crc, reinterpret_cast<const unsigned char*>( chunk.data() ),
+			static_cast<fmippSize>( file.gcount() ) );
+	}
+	return file.eof() && ( entry.crc == crc );
+}
+
+
+fmippBoolean
+FMUArchive::extractFile( const Entry& entry, const fmippString& directory,
+	fmippSize* nExtracted ) const
+{
+	const fmippString filePath = joinPath( directory, entry.name );
+
+	// Skip files that have been extracted before ( files are renamed only when complete ).
+	if ( isExtracted( entry, filePath ) ) return fmippTrue;
+
+	const fmippSize separator = filePath.find_last_of( '/' );
+	if ( ( fmippString::npos != separator ) && !makeDirectories( filePath.substr( 0, separator ) ) )
+		return fmippFalse;
+
+	// Write to a temporary file first, other threads or processes may extract the same file concurrently.
+	const fmippString tmpFilePath = filePath + getTemporarySuffix();
+	fmippBoolean ok;
+	{
+		ofstream file( tmpFilePath.c_str(), ios::out | ios::binary | ios::trunc );
+		ok = file && decompress( entry, [&file]( const char* chunk, fmippSize n ) -> bool
+		{
+			return static_cast<bool>( file.write( chunk, n ) );
+		} );
+	}
+
+#if !defined( WIN32 )
+	// Keep the permissions of the archived file ( e.g., for executables in the resources directory ),
+	// but never make it writable by the group or others.
+	if ( ok && entry.mode ) chmod( tmpFilePath.c_str(), entry.mode & ~( S_IWGRP | S_IWOTH ) );
+#endif
+
+	if ( ok && !replaceFile( tmpFilePath, filePath ) ) {
+		// e.g., the file is in use by another process ( Windows ), check if it is complete
+		ok = isExtracted( entry, filePath );
+	} else if ( ok && nExtracted ) {
+		++( *nExtracted );
+	}
+
+	remove( tmpFilePath.c_str() );
+	return ok;
+}
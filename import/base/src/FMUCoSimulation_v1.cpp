@@ -6,7 +6,10 @@
  * \file FMUCoSimulation_v1.cpp
  */
 #include <assert.h>
+#include <chrono>
 #include <set>
+#include <thread>
+#include <vector>
 #include <sstream>
 #include <iostream>
 #include <cmath>
@@ -20,6 +23,7 @@
 #include "import/base/include/CallbackFunctions.h"
 #include "import/base/include/ModelDescription.h"
 #include "import/base/include/ModelManager.h"
+#include "import/base/include/StepWorker.h"
 
 using namespace std;
 
@@ -167,10 +171,8 @@ FMUCoSimulation::FMUCoSimulation( const fmippString& modelIdentifier,
 FMUCoSimulation::FMUCoSimulation( const FMUCoSimulation& fmu ) :
 		FMUCoSimulationBase( fmu.loggingOn_ ),
 		instance_( NULL ),
-		fmu_( fmu.fmu_ ),
+		fmu_( ( fmu.fmu_ && fmu.fmu_->sharedFMU ) ? ModelManager::getIsolatedCopy( fmu.fmu_ ) : fmu.fmu_ ), // copies of isolated instances are isolated too
 		callbacks_( fmu.callbacks_ ),
-		varMap_( fmu.varMap_ ),
-		varTypeMap_( fmu.varTypeMap_ ),
 		time_( numeric_limits<fmippReal>::quiet_NaN() ),
 		timeDiffResolution_( fmu.timeDiffResolution_ ),
 		lastStatus_( fmiOK )
@@ -178,6 +180,7 @@ FMUCoSimulation::FMUCoSimulation( const FMUCoSimulation& fmu ) :
 
 FMUCoSimulation::~FMUCoSimulation()
 {
+	stepWorker_.reset(); // wait for asynchronous steps
 	if ( instance_ ) {
 		fmu_->functions->terminateSlave( instance_ );
 		fmu_->functions->freeSlaveInstance( instance_ );
@@ -195,32 +198,20 @@ FMUCoSimulation::terminate()
 
 void FMUCoSimulation::readModelDescription()
 {
-	using namespace ModelDescriptionUtilities;
-
-	typedef ModelDescription::Properties Properties;
 	const ModelDescription* description = fmu_->description;
 
-	const Properties& modelVariables = description->getModelVariables();
-	Properties::const_iterator itVar = modelVariables.begin();
-	Properties::const_iterator itEnd = modelVariables.end();
-
-	// List of all variable names -> check if names are unique.
-	set<fmippString> allVariableNames;
-	pair< set<fmippString>::iterator, fmippBoolean > varNamesInsert;
+	const ModelVariableTable& modelVariables = description->getVariableTable();
 
 	// List of all variable value references -> check if value references are unique.
 	set<fmippValueReference> allVariableValRefs; 
 	pair< set<fmippValueReference>::iterator, fmippBoolean > varValRefsInsert;
 
-	for ( ; itVar != itEnd; ++itVar )
+	for ( fmippSize i = 0; i < modelVariables.size(); ++i )
 	{
-		const Properties& varAttributes = getAttributes( itVar );
+		fmippString varName = modelVariables.getName( i );
+		fmippValueReference varValRef = modelVariables.getValueReference( i );
 
-		fmippString varName = varAttributes.get<fmippString>( "name" );
-		fmippValueReference varValRef = varAttributes.get<fmippValueReference>( "valueReference" );
-		varNamesInsert = allVariableNames.insert( varName );
-
-		if ( false == varNamesInsert.second ) { // Check if variable name is unique.
+		if ( modelVariables.find( varName ) != i ) { // Check if variable name is unique.
 			fmippString message = fmippString( "multiple definitions of variable name '" ) +
 				varName + fmippString( "' found" );
 			logger( fmiWarning, "WARNING", message );
@@ -234,24 +225,7 @@ void FMUCoSimulation::readModelDescription()
 				<< varValRef << "' found";
 			logger( fmiWarning, "WARNING", message.str() );
 		}
-
-		// Map name to value reference.
-		varMap_.insert( make_pair( varName, varValRef ) );
-
-		// Map name to value type.
-		if ( hasChild( itVar, "Real" ) ) {
-			varTypeMap_.insert( make_pair( varName, fmippTypeReal ) );
-		} else if ( hasChild( itVar, "Integer" ) ) {
-			varTypeMap_.insert( make_pair( varName, fmippTypeInteger ) );
-		} else if ( hasChild( itVar, "fmippBooleanean" ) ) {
-			varTypeMap_.insert( make_pair( varName, fmippTypeBoolean ) );
-		} else if ( hasChild( itVar, "String" ) ) {
-			varTypeMap_.insert( make_pair( varName, fmippTypeString ) );
-		} else {
-			varTypeMap_.insert( make_pair( varName, fmippTypeUnknown ) );
-		}
 	}
-	//nValueRefs_ = varMap_.size();
 }
 fmippStatus FMUCoSimulation::instantiate( const fmippString& instanceName,
 	const fmippTime timeout,
@@ -339,8 +313,8 @@ fmippStatus FMUCoSimulation::setValue(fmippValueReference* valref, const fmippIn
 
 fmippStatus FMUCoSimulation::setValue(fmippValueReference* valref, const fmippBoolean* val, fmippSize ival)
 {
-	fmiBoolean val2 = (fmiBoolean) *val;
-	lastStatus_ = fmu_->functions->setBoolean(instance_, valref, ival, &val2);
+	std::vector<fmiBoolean> val2( val, val + ival );
+	lastStatus_ = fmu_->functions->setBoolean( instance_, valref, ival, val2.data() );
 	return (fmippStatus) lastStatus_;
 }
 
@@ -357,9 +331,9 @@ fmippStatus FMUCoSimulation::setValue(fmippValueReference* valref, const fmippSt
 
 fmippStatus FMUCoSimulation::setValue( const fmippString& name, const fmippReal& val )
 {
-	map<fmippString,fmippValueReference>::const_iterator it = varMap_.find( name );
-	if ( it != varMap_.end() ) {
-		lastStatus_ = fmu_->functions->setReal( instance_, &it->second, 1, &val );
+	const fmippValueReference valref = getValueRef( name );
+	if ( fmippUndefinedValueReference != valref ) {
+		lastStatus_ = fmu_->functions->setReal( instance_, &valref, 1, &val );
 	} else {
 		fmippString ret = name + fmippString( " does not exist" );
 		logger( fmiDiscard, "WARNING", ret );
@@ -370,9 +344,9 @@ fmippStatus FMUCoSimulation::setValue( const fmippString& name, const fmippReal&
 
 fmippStatus FMUCoSimulation::setValue( const fmippString& name, const fmippInteger& val )
 {
-	map<fmippString,fmippValueReference>::const_iterator it = varMap_.find( name );
-	if ( it != varMap_.end() ) {
-		lastStatus_ = fmu_->functions->setInteger( instance_, &it->second, 1, &val );
+	const fmippValueReference valref = getValueRef( name );
+	if ( fmippUndefinedValueReference != valref ) {
+		lastStatus_ = fmu_->functions->setInteger( instance_, &valref, 1, &val );
 	} else {
 		fmippString ret = name + fmippString( " does not exist" );
 		logger( fmiDiscard, "WARNING", ret );
@@ -383,10 +357,10 @@ fmippStatus FMUCoSimulation::setValue( const fmippString& name, const fmippInteg
 
 fmippStatus FMUCoSimulation::setValue( const fmippString& name, const fmippBoolean& val )
 {
-	map<fmippString,fmippValueReference>::const_iterator it = varMap_.find( name );
-	if ( it != varMap_.end() ) {
+	const fmippValueReference valref = getValueRef( name );
+	if ( fmippUndefinedValueReference != valref ) {
 		fmiBoolean val2 = (fmiBoolean) val;
-		lastStatus_ = fmu_->functions->setBoolean( instance_, &it->second, 1, &val2 );
+		lastStatus_ = fmu_->functions->setBoolean( instance_, &valref, 1, &val2 );
 	} else {
 		fmippString ret = name + fmippString( " does not exist" );
 		logger( fmiDiscard, "WARNING", ret );
@@ -397,10 +371,10 @@ fmippStatus FMUCoSimulation::setValue( const fmippString& name, const fmippBoole
 
 fmippStatus FMUCoSimulation::setValue( const fmippString& name, const fmippString& val )
 {
-	map<fmippString,fmippValueReference>::const_iterator it = varMap_.find( name );
+	const fmippValueReference valref = getValueRef( name );
 	fmiString cString = val.c_str();
-	if ( it != varMap_.end() ) {
-		lastStatus_ = fmu_->functions->setString( instance_, &it->second, 1, &cString );
+	if ( fmippUndefinedValueReference != valref ) {
+		lastStatus_ = fmu_->functions->setString( instance_, &valref, 1, &cString );
 	} else {
 		fmippString ret = name + fmippString( " does not exist" );
 		logger( fmiDiscard, "WARNING", ret );
@@ -451,33 +425,29 @@ fmippStatus FMUCoSimulation::getValue( fmippValueReference* valref, fmippInteger
 
 fmippStatus FMUCoSimulation::getValue( fmippValueReference* valref, fmippBoolean* val, fmippSize ival )
 {
-	fmiBoolean* val2 = new fmiBoolean[ival];
+	std::vector<fmiBoolean> val2( ival );
+	lastStatus_ = fmu_->functions->getBoolean( instance_, valref, ival, val2.data() );
 	for ( fmippSize i = 0; i < ival; ++i ) {
-		val2[i] = (fmiBoolean) val[i];
+		val[i] = ( fmiFalse != val2[i] );
 	}
-	lastStatus_ = fmu_->functions->getBoolean( instance_, valref, ival, val2 );
-	delete val2;
 	return (fmippStatus) lastStatus_;
 }
 
 fmippStatus FMUCoSimulation::getValue( fmippValueReference* valref, fmippString* val, fmippSize ival )
 {
-	fmiString* cStrings = 0;
-	
-	lastStatus_ = fmu_->functions->getString( instance_, valref, ival, cStrings );
-	if ( 0 != cStrings ) {
-		for ( fmippSize i = 0; i < ival; ++i ) {
-			val[i] = fmippString( cStrings[i] );
-		}
+	std::vector<fmiString> cStrings( ival, static_cast<fmiString>( 0 ) );
+	lastStatus_ = fmu_->functions->getString( instance_, valref, ival, cStrings.data() );
+	for ( fmippSize i = 0; i < ival; ++i ) {
+		if ( 0 != cStrings[i] ) val[i] = fmippString( cStrings[i] );
 	}
 	return (fmippStatus) lastStatus_;
 }
 
 fmippStatus FMUCoSimulation::getValue( const fmippString& name, fmippReal& val )
 {
-	map<fmippString,fmippValueReference>::const_iterator it = varMap_.find( name );
-	if ( it != varMap_.end() ) {
-		lastStatus_ = fmu_->functions->getReal( instance_, &it->second, 1, &val );
+	const fmippValueReference valref = getValueRef( name );
+	if ( fmippUndefinedValueReference != valref ) {
+		lastStatus_ = fmu_->functions->getReal( instance_, &valref, 1, &val );
 	} else {
 		fmippString ret = name + fmippString( " does not exist" );
 		logger( fmiDiscard, "WARNING", ret );
@@ -488,9 +458,9 @@ fmippStatus FMUCoSimulation::getValue( const fmippString& name, fmippReal& val )
 
 fmippStatus FMUCoSimulation::getValue( const fmippString& name, fmippInteger& val )
 {
-	map<fmippString,fmippValueReference>::const_iterator it = varMap_.find( name );
-	if ( it != varMap_.end() ) {
-		lastStatus_ = fmu_->functions->getInteger( instance_, &it->second, 1, &val );
+	const fmippValueReference valref = getValueRef( name );
+	if ( fmippUndefinedValueReference != valref ) {
+		lastStatus_ = fmu_->functions->getInteger( instance_, &valref, 1, &val );
 	} else {
 		fmippString ret = name + fmippString( " does not exist" );
 		logger( fmiDiscard, "WARNING", ret );
@@ -501,10 +471,10 @@ fmippStatus FMUCoSimulation::getValue( const fmippString& name, fmippInteger& va
 
 fmippStatus FMUCoSimulation::getValue( const fmippString& name, fmippBoolean& val )
 {
-	map<fmippString,fmippValueReference>::const_iterator it = varMap_.find( name );
-	if ( it != varMap_.end() ) {
+	const fmippValueReference valref = getValueRef( name );
+	if ( fmippUndefinedValueReference != valref ) {
 		fmiBoolean val2;
-		lastStatus_ = fmu_->functions->getBoolean( instance_, &it->second, 1, &val2 );
+		lastStatus_ = fmu_->functions->getBoolean( instance_, &valref, 1, &val2 );
 		val = (fmippBoolean) val2;
 	} else {
 		fmippString ret = name + fmippString( " does not exist" );
@@ -516,10 +486,10 @@ fmippStatus FMUCoSimulation::getValue( const fmippString& name, fmippBoolean& va
 
 fmippStatus FMUCoSimulation::getValue( const fmippString& name, fmippString& val )
 {
-	map<fmippString,fmippValueReference>::const_iterator it = varMap_.find( name );
+	const fmippValueReference valref = getValueRef( name );
 	const char* cString;
-	if ( it != varMap_.end() ) {
-		lastStatus_ = fmu_->functions->getString( instance_, &it->second, 1, &cString );
+	if ( fmippUndefinedValueReference != valref ) {
+		lastStatus_ = fmu_->functions->getString( instance_, &valref, 1, &cString );
 		val = fmippString( cString );
 	} else {
 		fmippString ret = name + fmippString( " does not exist" );
@@ -531,10 +501,10 @@ fmippStatus FMUCoSimulation::getValue( const fmippString& name, fmippString& val
 
 fmippReal FMUCoSimulation::getRealValue( const fmippString& name )
 {
-	map<fmippString,fmippValueReference>::const_iterator it = varMap_.find( name );
+	const fmippValueReference valref = getValueRef( name );
 	fmippReal val[1];
-	if ( it != varMap_.end() ) {
-		lastStatus_ = fmu_->functions->getReal( instance_, &it->second, 1, val );
+	if ( fmippUndefinedValueReference != valref ) {
+		lastStatus_ = fmu_->functions->getReal( instance_, &valref, 1, val );
 	} else {
 		val[0] = numeric_limits<fmippReal>::quiet_NaN();
 		fmippString ret = name + fmippString( " does not exist" );
@@ -546,10 +516,10 @@ fmippReal FMUCoSimulation::getRealValue( const fmippString& name )
 
 fmippInteger FMUCoSimulation::getIntegerValue( const fmippString& name )
 {
-	map<fmippString,fmippValueReference>::const_iterator it = varMap_.find( name );
+	const fmippValueReference valref = getValueRef( name );
 	fmippInteger val[1];
-	if ( it != varMap_.end() ) {
-		lastStatus_ = fmu_->functions->getInteger( instance_, &it->second, 1, val );
+	if ( fmippUndefinedValueReference != valref ) {
+		lastStatus_ = fmu_->functions->getInteger( instance_, &valref, 1, val );
 	} else {
 		val[0] = numeric_limits<fmippInteger>::quiet_NaN();
 		fmippString ret = name + fmippString( " does not exist" );
@@ -561,10 +531,10 @@ fmippInteger FMUCoSimulation::getIntegerValue( const fmippString& name )
 
 fmippBoolean FMUCoSimulation::getBooleanValue( const fmippString& name )
 {
-	map<fmippString,fmippValueReference>::const_iterator it = varMap_.find( name );
+	const fmippValueReference valref = getValueRef( name );
 	fmiBoolean val;
-	if ( it != varMap_.end() ) {
-		lastStatus_ = fmu_->functions->getBoolean( instance_, &it->second, 1, &val );
+	if ( fmippUndefinedValueReference != valref ) {
+		lastStatus_ = fmu_->functions->getBoolean( instance_, &valref, 1, &val );
 	} else {
 		val = fmiFalse;
 		fmippString ret = name + fmippString( " does not exist" );
@@ -576,10 +546,10 @@ fmippBoolean FMUCoSimulation::getBooleanValue( const fmippString& name )
 
 fmippString FMUCoSimulation::getStringValue( const fmippString& name )
 {
-	map<fmippString,fmippValueReference>::const_iterator it = varMap_.find( name );
+	const fmippValueReference valref = getValueRef( name );
 	fmiString val[1];
-	if ( it != varMap_.end() ) {
-		lastStatus_ = fmu_->functions->getString( instance_, &it->second, 1, val );
+	if ( fmippUndefinedValueReference != valref ) {
+		lastStatus_ = fmu_->functions->getString( instance_, &valref, 1, val );
 	} else {
 		val[0] = 0;
 		fmippString ret = name + fmippString( " does not exist" );
@@ -596,12 +566,9 @@ fmippStatus FMUCoSimulation::getLastStatus() const
 
 fmippValueReference FMUCoSimulation::getValueRef( const fmippString& name ) const
 {
-	map<fmippString,fmippValueReference>::const_iterator it = varMap_.find(name);
-	if ( it != varMap_.end() ) {
-		return it->second;
-	} else {
-		return fmippUndefinedValueReference;
-	}
+	const ModelVariableTable& variables = fmu_->description->getVariableTable();
+	const fmippSize i = variables.find( name );
+	return ( ModelVariableTable::npos != i ) ? variables.getValueReference( i ) : fmippUndefinedValueReference;
 }
 
 fmippStatus FMUCoSimulation::doStep( fmippTime currentCommunicationPoint,
@@ -617,6 +584,56 @@ fmippStatus FMUCoSimulation::doStep( fmippTime currentCommunicationPoint,
 	lastStatus_ = fmu_->functions->doStep( instance_, time_, communicationStepSize, 
 		( ( newStep == fmippTrue ) ? fmiTrue : fmiFalse ) );
 
+	return finishStep( communicationStepSize );
+}
+
+FMUCoSimulation::StepFuture FMUCoSimulation::doStepAsync( fmippTime currentCommunicationPoint,
+	fmippTime communicationStepSize, fmippBoolean newStep )
+{
+	if ( 0 == stepWorker_.get() ) stepWorker_.reset( new StepWorker );
+
+	// The FMU cannot run asynchronously if the attribute is missing ( default value ).
+	fmippBoolean runAsynchronuously = fmippFalse;
+	try {
+		runAsynchronuously = canRunAsynchronuously();
+	} catch ( std::runtime_error& ) {}
+
+	if ( false == runAsynchronuously ) {
+		return stepWorker_->run( [this, currentCommunicationPoint, communicationStepSize, newStep] () {
+			return doStep( currentCommunicationPoint, communicationStepSize, newStep );
+		} );
+	}
+
+	// The FMU executes the step itself, the worker thread only waits for the step to finish.
+	if ( abs( time_ - currentCommunicationPoint ) > timeDiffResolution_ )
+	{
+		fmippString ret( "requested current communication point does not match FMU-internal time" );
+		logger( fmiError, "ABORT", ret );
+		return StepWorker::ready( fmippError );
+	}
+
+	lastStatus_ = fmu_->functions->doStep( instance_, time_, communicationStepSize, 
+		( ( newStep == fmippTrue ) ? fmiTrue : fmiFalse ) );
+
+	if ( fmiPending != lastStatus_ ) return StepWorker::ready( finishStep( communicationStepSize ) );
+
+	return stepWorker_->run( [this, communicationStepSize] () { return finishStep( communicationStepSize ); } );
+}
+
+fmippStatus FMUCoSimulation::finishStep( fmippTime communicationStepSize )
+{
+	// Poll the status of a step executed asynchronously by the FMU.
+	while ( fmiPending == lastStatus_ ) {
+		this_thread::sleep_for( chrono::microseconds( 100 ) );
+
+		fmiStatus stepStatus = fmiError;
+		if ( ( 0 == fmu_->functions->getStatus ) ||
+			( fmiOK != fmu_->functions->getStatus( instance_, fmiDoStepStatus, &stepStatus ) ) )
+			stepStatus = fmiError;
+
+		lastStatus_ = stepStatus;
+	}
+
 	if ( fmiOK == lastStatus_ ) time_ += communicationStepSize;
 	return (fmippStatus) lastStatus_;
 }
@@ -661,7 +678,7 @@ fmippSize FMUCoSimulation::nEventInds() const
 
 fmippSize FMUCoSimulation::nValueRefs() const
 {
-	return varMap_.size();
+	return fmu_->description->getVariableTable().getNumberOfNames();
 }
 
 const ModelDescription* FMUCoSimulation::getModelDescription() const
@@ -677,13 +694,14 @@ const ModelDescription* FMUCoSimulation::getModelDescription() const
 
 FMIPPVariableType FMUCoSimulation::getType( const fmippString& variableName ) const
 {
-	map<fmippString,FMIPPVariableType>::const_iterator it = varTypeMap_.find( variableName );
-	if ( it == varTypeMap_.end() ) {
+	const ModelVariableTable& variables = fmu_->description->getVariableTable();
+	const fmippSize i = variables.find( variableName );
+	if ( ModelVariableTable::npos == i ) {
 		fmippString ret = variableName + fmippString( " does not exist" );
 		logger( fmiDiscard, "WARNING", ret );
 		return fmippTypeUnknown;
 	}
-	return it->second;
+	return variables.getType( i );
 }
 
 fmippBoolean
@@ -8,11 +8,15 @@
  */
 
 #include <assert.h>
+#include <chrono>
 #include <set>
+#include <thread>
+#include <vector>
 #include <sstream>
 #include <iostream>
 #include <cmath>
 #include <limits>
+#include <memory>
 #include "common/FMIPPConfig.h"
 #include "common/fmi_v2.0/fmi2ModelTypes.h"
 #include "common/fmi_v2.0/fmi_2.h"
@@ -20,6 +24,8 @@
 #include "import/base/include/CallbackFunctions.h"
 #include "import/base/include/ModelDescription.h"
 #include "import/base/include/ModelManager.h"
+#include "import/base/include/ForkedFMU.h"
+#include "import/base/include/StepWorker.h"
  
 using namespace std;
 
@@ -148,10 +154,8 @@ FMUCoSimulation::FMUCoSimulation( const fmippString& modelIdentifier,
 FMUCoSimulation::FMUCoSimulation( const FMUCoSimulation& fmu ) :
 		FMUCoSimulationBase( fmu.loggingOn_ ),
 		instance_( NULL ),
-		fmu_( fmu.fmu_ ),
+		fmu_( ( fmu.fmu_ && fmu.fmu_->sharedFMU ) ? ModelManager::getIsolatedCopy( fmu.fmu_ ) : fmu.fmu_ ), // copies of isolated instances are isolated too
 		callbacks_( fmu.callbacks_ ),
-		varMap_( fmu.varMap_ ),
-		varTypeMap_( fmu.varTypeMap_ ),
 		time_( numeric_limits<fmippReal>::quiet_NaN() ),
 		timeDiffResolution_( fmu.timeDiffResolution_ ),
 		lastStatus_( fmi2OK )
@@ -159,7 +163,9 @@ FMUCoSimulation::FMUCoSimulation( const FMUCoSimulation& fmu ) :
 
 FMUCoSimulation::~FMUCoSimulation()
 {
+	stepWorker_.reset(); // wait for asynchronous steps
 	if ( instance_ ) {
+		stateDeleter_.reset(); // invalidate all snapshots
 		fmu_->functions->terminate( instance_ );
 		fmu_->functions->freeInstance( instance_ );
 	}
@@ -169,6 +175,7 @@ void
 FMUCoSimulation::terminate()
 {
 	if ( instance_ ) {
+		stateDeleter_.reset(); // invalidate all snapshots
 		fmu_->functions->terminate( instance_ );
 		fmu_->functions->freeInstance( instance_ );
 	}
@@ -176,33 +183,20 @@ FMUCoSimulation::terminate()
 
 void FMUCoSimulation::readModelDescription()
 {
-	using namespace ModelDescriptionUtilities;
-
-	typedef ModelDescription::Properties Properties;
 	const ModelDescription* description = fmu_->description;
 
-	const Properties& modelVariables = description->getModelVariables();
-	Properties::const_iterator itVar = modelVariables.begin();
-	Properties::const_iterator itEnd = modelVariables.end();
-
-	// List of all variable names -> check if names are unique.
-	set<fmippString> allVariableNames;
-	pair< set<fmippString>::iterator, fmippBoolean > varNamesInsert;
+	const ModelVariableTable& modelVariables = description->getVariableTable();
 
 	// List of all variable value references -> check if value references are unique.
 	set<fmippValueReference> allVariableValRefs; 
 	pair< set<fmippValueReference>::iterator, fmippBoolean > varValRefsInsert;
 
-	for ( ; itVar != itEnd; ++itVar )
+	for ( fmippSize i = 0; i < modelVariables.size(); ++i )
 	{
-		const Properties& varAttributes = getAttributes( itVar );
-
-		fmippString varName = varAttributes.get<fmippString>( "name" );
-		fmippValueReference varValRef = varAttributes.get<fmippValueReference>( "valueReference" );
+		fmippString varName = modelVariables.getName( i );
+		fmippValueReference varValRef = modelVariables.getValueReference( i );
 
-		varNamesInsert = allVariableNames.insert( varName );
-
-		if ( false == varNamesInsert.second ) { // Check if variable name is unique.
+		if ( modelVariables.find( varName ) != i ) { // Check if variable name is unique.
 			fmippString message = fmippString( "multiple definitions of variable name '" ) +
 				varName + fmippString( "' found" );
 			logger( fmi2Warning, "WARNING", message );
@@ -214,24 +208,7 @@ void FMUCoSimulation::readModelDescription()
 				<< varValRef << "' found";
 			logger( fmi2Warning, "WARNING", message.str() );
 		}
-
-		// Map name to value reference.
-		varMap_.insert( make_pair( varName, varValRef ) );
-
-		// Map name to value type.
-		if ( hasChild( itVar, "Real" ) ) {
-			varTypeMap_.insert( make_pair( varName, fmippTypeReal ) );
-		} else if ( hasChild( itVar, "Integer" ) ) {
-			varTypeMap_.insert( make_pair( varName, fmippTypeInteger ) );
-		} else if ( hasChild( itVar, "Boolean" ) ) {
-			varTypeMap_.insert( make_pair( varName, fmippTypeBoolean ) );
-		} else if ( hasChild( itVar, "String" ) ) {
-			varTypeMap_.insert( make_pair( varName, fmippTypeString ) );
-		} else {
-			varTypeMap_.insert( make_pair( varName, fmippTypeUnknown ) );
-		}
 	}
-	//nValueRefs_ = varMap_.size();
 }
 
 fmippStatus FMUCoSimulation::instantiate( const fmippString& instanceName,
@@ -251,14 +228,26 @@ fmippStatus FMUCoSimulation::instantiate( const fmippString& instanceName,
 	const fmippString& guid = fmu_->description->getGUID();
 	const fmippString& type = fmu_->description->getMIMEType();
 
-	instance_ = fmu_->functions->instantiate( instanceName_.c_str(), fmi2CoSimulation,
-		guid.c_str(), fmu_->fmuResourceLocation.c_str(), &callbacks_, static_cast<fmi2Boolean>( visible ), static_cast<fmi2Boolean>( loggingOn_ ) );
+	// Forked FMUs are instantiated in a helper process.
+	if ( 0 != fmu_->forkedFMU ) {
+		instance_ = ForkedFMU::instantiate( fmu_, instanceName_.c_str(), fmi2CoSimulation,
+			guid.c_str(), fmu_->fmuResourceLocation.c_str(), &callbacks_, static_cast<fmi2Boolean>( visible ), static_cast<fmi2Boolean>( loggingOn_ ) );
+	} else {
+		instance_ = fmu_->functions->instantiate( instanceName_.c_str(), fmi2CoSimulation,
+			guid.c_str(), fmu_->fmuResourceLocation.c_str(), &callbacks_, static_cast<fmi2Boolean>( visible ), static_cast<fmi2Boolean>( loggingOn_ ) );
+	}
 
 	if ( 0 == instance_ ) {
 		lastStatus_ = fmi2Error;
 		return (fmippStatus) lastStatus_;
 	}
 
+	// Snapshots free their states via this function as long as the instance exists.
+	BareFMU2Ptr fmu = fmu_;
+	fmi2Component instance = instance_;
+	stateDeleter_ = make_shared<FMUSnapshot::Deleter>(
+		[fmu, instance]( void* state ) { fmu->functions->freeFMUstate( instance, &state ); } );
+
 	/// \FIXME retrieve options for debug logging as defined in fmiModelDescription.LogCategories
 	fmippSize nCategories = 0;
 	char** categories = NULL;
@@ -300,6 +289,114 @@ fmippStatus FMUCoSimulation::initialize( const fmippTime tStart,
 	return (fmippStatus) lastStatus_;
 }
 
+fmippStatus FMUCoSimulation::reset()
+{
+	if ( 0 == instance_ ) {
+		lastStatus_ = fmi2Error;
+		return (fmippStatus) lastStatus_;
+	}
+
+	lastStatus_ = fmu_->functions->reset( instance_ );
+
+	if ( ( fmi2OK == lastStatus_ ) || ( fmi2Warning == lastStatus_ ) ) time_ = 0.;
+
+	return (fmippStatus) lastStatus_;
+}
+
+fmippBoolean FMUCoSimulation::canGetAndSetFMUstate() const
+{
+	// Forked FMUs provide FMU states even if the FMU itself does not.
+	return ( 0 != fmu_ ) && ( ( 0 != fmu_->forkedFMU ) || fmu_->description->canGetAndSetFMUstate( fmippTrue ) );
+}
+
+fmippBoolean FMUCoSimulation::canSerializeFMUstate() const
+{
+	return ( 0 != fmu_ ) && ( 0 == fmu_->forkedFMU ) && fmu_->description->canSerializeFMUstate( fmippTrue );
+}
+
+fmippStatus FMUCoSimulation::getSnapshot( FMUSnapshot& snapshot )
+{
+	if ( ( 0 == instance_ ) || ( false == canGetAndSetFMUstate() ) ) {
+		logger( fmi2Error, "ERROR", "the FMU cannot get and set its state" );
+		lastStatus_ = fmi2Error;
+		return (fmippStatus) lastStatus_;
+	}
+
+	fmi2FMUstate state = snapshot.reusableState( this );
+	lastStatus_ = fmu_->functions->getFMUstate( instance_, &state );
+	snapshot.take( state, this, stateDeleter_ );
+	snapshot.time_ = time_;
+
+	return (fmippStatus) lastStatus_;
+}
+
+fmippStatus FMUCoSimulation::setSnapshot( const FMUSnapshot& snapshot )
+{
+	if ( ( 0 == instance_ ) || ( 0 == snapshot.reusableState( this ) ) ) {
+		logger( fmi2Error, "ERROR", "invalid snapshot" );
+		lastStatus_ = fmi2Error;
+		return (fmippStatus) lastStatus_;
+	}
+
+	lastStatus_ = fmu_->functions->setFMUstate( instance_, snapshot.state_ );
+
+	if ( ( fmi2OK == lastStatus_ ) || ( fmi2Warning == lastStatus_ ) ) time_ = snapshot.time_;
+
+	return (fmippStatus) lastStatus_;
+}
+
+fmippStatus FMUCoSimulation::getSnapshotSize( const FMUSnapshot& snapshot, fmippSize& size )
+{
+	if ( ( 0 == instance_ ) || ( false == canSerializeFMUstate() ) || ( 0 == snapshot.reusableState( this ) ) ) {
+		lastStatus_ = fmi2Error;
+		return (fmippStatus) lastStatus_;
+	}
+
+	size_t stateSize = 0;
+	lastStatus_ = fmu_->functions->serializedFMUstateSize( instance_, snapshot.state_, &stateSize );
+	size = FMUSnapshot::headerSize + stateSize;
+
+	return (fmippStatus) lastStatus_;
+}
+
+fmippStatus FMUCoSimulation::serializeSnapshot( const FMUSnapshot& snapshot, vector<fmippChar>& buffer )
+{
+	if ( ( 0 == instance_ ) || ( false == canSerializeFMUstate() ) || ( 0 == snapshot.reusableState( this ) ) ) {
+		logger( fmi2Error, "ERROR", "the snapshot cannot be serialized" );
+		lastStatus_ = fmi2Error;
+		return (fmippStatus) lastStatus_;
+	}
+
+	size_t size = 0;
+	lastStatus_ = fmu_->functions->serializedFMUstateSize( instance_, snapshot.state_, &size );
+
+	if ( fmi2OK != lastStatus_ ) return (fmippStatus) lastStatus_;
+
+	buffer.resize( FMUSnapshot::headerSize + size );
+	snapshot.writeHeader( buffer.data() );
+	lastStatus_ = fmu_->functions->serializeFMUstate( instance_, snapshot.state_,
+		buffer.data() + FMUSnapshot::headerSize, size );
+
+	return (fmippStatus) lastStatus_;
+}
+
+fmippStatus FMUCoSimulation::deserializeSnapshot( const vector<fmippChar>& buffer, FMUSnapshot& snapshot )
+{
+	if ( ( 0 == instance_ ) || ( false == canSerializeFMUstate() ) || ( buffer.size() < FMUSnapshot::headerSize ) ) {
+		logger( fmi2Error, "ERROR", "the snapshot cannot be deserialized" );
+		lastStatus_ = fmi2Error;
+		return (fmippStatus) lastStatus_;
+	}
+
+	fmi2FMUstate state = snapshot.reusableState( this );
+	lastStatus_ = fmu_->functions->deSerializeFMUstate( instance_, buffer.data() + FMUSnapshot::headerSize,
+		buffer.size() - FMUSnapshot::headerSize, &state );
+	snapshot.take( state, this, stateDeleter_ );
+	snapshot.readHeader( buffer.data() );
+
+	return (fmippStatus) lastStatus_;
+}
+
 fmippTime FMUCoSimulation::getTime() const
 {
 	return time_;
@@ -345,8 +442,8 @@ fmippStatus FMUCoSimulation::setValue( fmippValueReference* valref, const fmippI
 
 fmippStatus FMUCoSimulation::setValue( fmippValueReference* valref, const fmippBoolean* val, fmippSize ival )
 {
-	fmi2Boolean val2 = (fmi2Boolean) *val;
-	lastStatus_ = fmu_->functions->setBoolean( instance_, valref, ival, &val2 );
+	std::vector<fmi2Boolean> val2( val, val + ival );
+	lastStatus_ = fmu_->functions->setBoolean( instance_, valref, ival, val2.data() );
 	return (fmippStatus) lastStatus_;
 }
 
@@ -363,10 +460,10 @@ fmippStatus FMUCoSimulation::setValue( fmippValueReference* valref, const fmippS
 
 fmippStatus FMUCoSimulation::setValue( const fmippString& name, const fmippReal& val )
 {
-	map<fmippString,fmi2ValueReference>::const_iterator it = varMap_.find( name );
+	const fmippValueReference valref = getValueRef( name );
 
-	if ( it != varMap_.end() ) {
-		lastStatus_ = fmu_->functions->setReal( instance_, &it->second, 1, &val );
+	if ( fmippUndefinedValueReference != valref ) {
+		lastStatus_ = fmu_->functions->setReal( instance_, &valref, 1, &val );
 		return (fmippStatus) lastStatus_;
 	} else {
 		fmippString ret = name + fmippString( " does not exist" );
@@ -378,10 +475,10 @@ fmippStatus FMUCoSimulation::setValue( const fmippString& name, const fmippReal&
 
 fmippStatus FMUCoSimulation::setValue( const fmippString& name, const fmippInteger& val )
 {
-	map<fmippString,fmippValueReference>::const_iterator it = varMap_.find( name );
+	const fmippValueReference valref = getValueRef( name );
 
-	if ( it != varMap_.end() ) {
-		lastStatus_ = fmu_->functions->setInteger( instance_, &it->second, 1, &val );
+	if ( fmippUndefinedValueReference != valref ) {
+		lastStatus_ = fmu_->functions->setInteger( instance_, &valref, 1, &val );
 		return (fmippStatus) lastStatus_;
 	} else {
 		fmippString ret = name + fmippString( " does not exist" );
@@ -393,11 +490,11 @@ fmippStatus FMUCoSimulation::setValue( const fmippString& name, const fmippInteg
 
 fmippStatus FMUCoSimulation::setValue( const fmippString& name, const fmippBoolean& val )
 {
-	map<fmippString,fmi2ValueReference>::const_iterator it = varMap_.find( name );
+	const fmippValueReference valref = getValueRef( name );
 
-	if ( it != varMap_.end() ) {
+	if ( fmippUndefinedValueReference != valref ) {
 		fmi2Boolean val2 = (fmi2Boolean) val;
-		lastStatus_ = fmu_->functions->setBoolean( instance_, &it->second, 1, &val2 );
+		lastStatus_ = fmu_->functions->setBoolean( instance_, &valref, 1, &val2 );
 		return (fmippStatus) lastStatus_;
 	} else {
 		fmippString ret = name + fmippString( " does not exist" );
@@ -409,12 +506,12 @@ fmippStatus FMUCoSimulation::setValue( const fmippString& name, const fmippBoole
 
 fmippStatus FMUCoSimulation::setValue( const fmippString& name, const fmippString& val )
 {
-	map<fmippString,fmi2ValueReference>::const_iterator it = varMap_.find( name );
+	const fmippValueReference valref = getValueRef( name );
 
 	const char* cString = val.c_str();
 
-	if ( it != varMap_.end() ) {
-		lastStatus_ = fmu_->functions->setString( instance_, &it->second, 1, &cString );
+	if ( fmippUndefinedValueReference != valref ) {
+		lastStatus_ = fmu_->functions->setString( instance_, &valref, 1, &cString );
 		return (fmippStatus) lastStatus_;
 	} else {
 		fmippString ret = name + fmippString( " does not exist" );
@@ -466,33 +563,29 @@ fmippStatus FMUCoSimulation::getValue( fmippValueReference* valref, fmippInteger
 
 fmippStatus FMUCoSimulation::getValue( fmippValueReference* valref, fmippBoolean* val, fmippSize ival )
 {
-	fmi2Boolean* val2 = new fmi2Boolean[ival];
+	std::vector<fmi2Boolean> val2( ival );
+	lastStatus_ = fmu_->functions->getBoolean( instance_, valref, ival, val2.data() );
 	for ( fmippSize i = 0; i < ival; ++i ) {
-		val2[i] = (fmi2Boolean) val[i];
+		val[i] = ( fmi2False != val2[i] );
 	}
-	lastStatus_ = fmu_->functions->getBoolean( instance_, valref, ival, val2 );
-	delete val2;
 	return (fmippStatus) lastStatus_;
 }
 
 fmippStatus FMUCoSimulation::getValue( fmippValueReference* valref, fmippString* val, fmippSize ival )
 {
-	const char** cStrings = 0;
-	
-	lastStatus_ = fmu_->functions->getString( instance_, valref, ival, cStrings );
-	if ( 0 != cStrings ) {
-		for ( fmippSize i = 0; i < ival; i++ ) {
-			val[i] = fmippString( cStrings[i] );
-		}
+	std::vector<fmi2String> cStrings( ival, static_cast<fmi2String>( 0 ) );
+	lastStatus_ = fmu_->functions->getString( instance_, valref, ival, cStrings.data() );
+	for ( fmippSize i = 0; i < ival; ++i ) {
+		if ( 0 != cStrings[i] ) val[i] = fmippString( cStrings[i] );
 	}
 	return (fmippStatus) lastStatus_;
 }
 
 fmippStatus FMUCoSimulation::getValue( const fmippString& name, fmippReal& val )
 {
-	map<fmippString,fmi2ValueReference>::const_iterator it = varMap_.find( name );
-	if ( it != varMap_.end() ) {
-		lastStatus_ = fmu_->functions->getReal( instance_, &it->second, 1, &val );
+	const fmippValueReference valref = getValueRef( name );
+	if ( fmippUndefinedValueReference != valref ) {
+		lastStatus_ = fmu_->functions->getReal( instance_, &valref, 1, &val );
 		return (fmippStatus) lastStatus_;
 	} else {
 		fmippString ret = name + fmippString( " does not exist" );
@@ -504,9 +597,9 @@ fmippStatus FMUCoSimulation::getValue( const fmippString& name, fmippReal& val )
 
 fmippStatus FMUCoSimulation::getValue( const fmippString& name, fmippInteger& val )
 {
-	map<fmippString,fmi2ValueReference>::const_iterator it = varMap_.find( name );
-	if ( it != varMap_.end() ) {
-		lastStatus_ = fmu_->functions->getInteger( instance_, &it->second, 1, &val );
+	const fmippValueReference valref = getValueRef( name );
+	if ( fmippUndefinedValueReference != valref ) {
+		lastStatus_ = fmu_->functions->getInteger( instance_, &valref, 1, &val );
 		return (fmippStatus) lastStatus_;
 	} else {
 		fmippString ret = name + fmippString( " does not exist" );
@@ -518,10 +611,10 @@ fmippStatus FMUCoSimulation::getValue( const fmippString& name, fmippInteger& va
 
 fmippStatus FMUCoSimulation::getValue( const fmippString& name, fmippBoolean& val )
 {
-	map<fmippString,fmi2ValueReference>::const_iterator it = varMap_.find( name );
-	if ( it != varMap_.end() ) {
+	const fmippValueReference valref = getValueRef( name );
+	if ( fmippUndefinedValueReference != valref ) {
 		fmi2Boolean val2 = (fmi2Boolean) val;
-		lastStatus_ = fmu_->functions->getBoolean( instance_, &it->second, 1, &val2 );
+		lastStatus_ = fmu_->functions->getBoolean( instance_, &valref, 1, &val2 );
 		val = (fmippBoolean) val2;
 		return (fmippStatus) lastStatus_;
 	} else {
@@ -534,10 +627,10 @@ fmippStatus FMUCoSimulation::getValue( const fmippString& name, fmippBoolean& va
 
 fmippStatus FMUCoSimulation::getValue( const fmippString& name, fmippString& val )
 {
-	map<fmippString,fmi2ValueReference>::const_iterator it = varMap_.find( name );
+	const fmippValueReference valref = getValueRef( name );
 	const char* cString;
-	if ( it != varMap_.end() ) {
-		lastStatus_ = fmu_->functions->getString( instance_, &it->second, 1, &cString );
+	if ( fmippUndefinedValueReference != valref ) {
+		lastStatus_ = fmu_->functions->getString( instance_, &valref, 1, &cString );
 		val = fmippString( cString );
 		return (fmippStatus) lastStatus_;
 	} else {
@@ -549,10 +642,10 @@ fmippStatus FMUCoSimulation::getValue( const fmippString& name, fmippString& val
 }
 fmippReal FMUCoSimulation::getRealValue( const fmippString& name )
 {
-	map<fmippString,fmi2ValueReference>::const_iterator it = varMap_.find( name );
+	const fmippValueReference valref = getValueRef( name );
 	fmippReal val[1];
-	if ( it != varMap_.end() ) {
-		lastStatus_ = fmu_->functions->getReal( instance_, &it->second, 1, val );
+	if ( fmippUndefinedValueReference != valref ) {
+		lastStatus_ = fmu_->functions->getReal( instance_, &valref, 1, val );
 	} else {
 		val[0] = numeric_limits<fmippReal>::quiet_NaN();
 		fmippString ret = name + fmippString( " does not exist" );
@@ -564,10 +657,10 @@ fmippReal FMUCoSimulation::getRealValue( const fmippString& name )
 
 fmippInteger FMUCoSimulation::getIntegerValue( const fmippString& name )
 {
-	map<fmippString,fmi2ValueReference>::const_iterator it = varMap_.find( name );
+	const fmippValueReference valref = getValueRef( name );
 	fmippInteger val[1];
-	if ( it != varMap_.end() ) {
-		lastStatus_ = fmu_->functions->getInteger( instance_, &it->second, 1, val );
+	if ( fmippUndefinedValueReference != valref ) {
+		lastStatus_ = fmu_->functions->getInteger( instance_, &valref, 1, val );
 	} else {
 		val[0] = numeric_limits<fmippInteger>::quiet_NaN();
 		fmippString ret = name + fmippString( " does not exist" );
@@ -579,10 +672,10 @@ fmippInteger FMUCoSimulation::getIntegerValue( const fmippString& name )
 
 fmippBoolean FMUCoSimulation::getBooleanValue( const fmippString& name )
 {
-	map<fmippString,fmi2ValueReference>::const_iterator it = varMap_.find( name );
+	const fmippValueReference valref = getValueRef( name );
 	fmi2Boolean val[1];
-	if ( it != varMap_.end() ) {
-		lastStatus_ = fmu_->functions->getBoolean( instance_, &it->second, 1, val );
+	if ( fmippUndefinedValueReference != valref ) {
+		lastStatus_ = fmu_->functions->getBoolean( instance_, &valref, 1, val );
 	} else {
 		val[0] = fmi2False;
 		fmippString ret = name + fmippString( " does not exist" );
@@ -594,10 +687,10 @@ fmippBoolean FMUCoSimulation::getBooleanValue( const fmippString& name )
 
 fmippString FMUCoSimulation::getStringValue( const fmippString& name )
 {
-	map<fmippString,fmi2ValueReference>::const_iterator it = varMap_.find( name );
+	const fmippValueReference valref = getValueRef( name );
 	fmiString val[1];
-	if ( it != varMap_.end() ) {
-		lastStatus_ = fmu_->functions->getString( instance_, &it->second, 1, val );
+	if ( fmippUndefinedValueReference != valref ) {
+		lastStatus_ = fmu_->functions->getString( instance_, &valref, 1, val );
 	} else {
 		val[0] = 0;
 		fmippString ret = name + fmippString( " does not exist" );
@@ -614,12 +707,9 @@ fmippStatus FMUCoSimulation::getLastStatus() const
 
 fmippValueReference FMUCoSimulation::getValueRef( const fmippString& name ) const
 {
-	map<fmippString,fmippValueReference>::const_iterator it = varMap_.find(name);
-	if ( it != varMap_.end() ) {
-		return it->second;
-	} else {
-		return fmippUndefinedValueReference;
-	}
+	const ModelVariableTable& variables = fmu_->description->getVariableTable();
+	const fmippSize i = variables.find( name );
+	return ( ModelVariableTable::npos != i ) ? variables.getValueReference( i ) : fmippUndefinedValueReference;
 }
 
 fmippStatus FMUCoSimulation::doStep( fmippTime currentCommunicationPoint,
@@ -634,6 +724,55 @@ fmippStatus FMUCoSimulation::doStep( fmippTime currentCommunicationPoint,
 	}
 	lastStatus_ = fmu_->functions->doStep( instance_, time_, communicationStepSize, fmi2True );
 
+	return finishStep( communicationStepSize );
+}
+
+FMUCoSimulation::StepFuture FMUCoSimulation::doStepAsync( fmippTime currentCommunicationPoint,
+	fmippTime communicationStepSize,
+	fmippBoolean newStep )
+{
+	if ( 0 == stepWorker_.get() ) stepWorker_.reset( new StepWorker );
+
+	// The FMU cannot run asynchronously if the attribute is missing ( default value ).
+	fmippBoolean runAsynchronuously = fmippFalse;
+	try {
+		runAsynchronuously = canRunAsynchronuously();
+	} catch ( std::runtime_error& ) {}
+
+	if ( false == runAsynchronuously ) {
+		return stepWorker_->run( [this, currentCommunicationPoint, communicationStepSize, newStep] () {
+			return doStep( currentCommunicationPoint, communicationStepSize, newStep );
+		} );
+	}
+
+	// The FMU executes the step itself, the worker thread only waits for the step to finish.
+	if ( abs( time_ - currentCommunicationPoint ) > timeDiffResolution_ )
+	{
+		fmippString ret( "requested current communication point does not match FMU-internal time" );
+		logger( fmi2Error, "ABORT", ret );
+		return StepWorker::ready( fmippError );
+	}
+	lastStatus_ = fmu_->functions->doStep( instance_, time_, communicationStepSize, fmi2True );
+
+	if ( fmi2Pending != lastStatus_ ) return StepWorker::ready( finishStep( communicationStepSize ) );
+
+	return stepWorker_->run( [this, communicationStepSize] () { return finishStep( communicationStepSize ); } );
+}
+
+fmippStatus FMUCoSimulation::finishStep( fmippTime communicationStepSize )
+{
+	// Poll the status of a step executed asynchronously by the FMU.
+	while ( fmi2Pending == lastStatus_ ) {
+		this_thread::sleep_for( chrono::microseconds( 100 ) );
+
+		fmi2Status stepStatus = fmi2Error;
+		if ( ( 0 == fmu_->functions->getStatus ) ||
+			( fmi2OK != fmu_->functions->getStatus( instance_, fmi2DoStepStatus, &stepStatus ) ) )
+			stepStatus = fmi2Error;
+
+		lastStatus_ = stepStatus;
+	}
+
 	if ( fmi2OK == lastStatus_ ) time_ += communicationStepSize;
 	return (fmippStatus) lastStatus_;
 }
@@ -677,7 +816,7 @@ fmippSize FMUCoSimulation::nEventInds() const
 
 fmippSize FMUCoSimulation::nValueRefs() const
 {
-	return varMap_.size();
+	return fmu_->description->getVariableTable().getNumberOfNames();
 }
 
 const ModelDescription* FMUCoSimulation::getModelDescription() const
@@ -693,13 +832,14 @@ const ModelDescription* FMUCoSimulation::getModelDescription() const
 
 FMIPPVariableType FMUCoSimulation::getType( const fmippString& variableName ) const
 {
-	map<fmippString,FMIPPVariableType>::const_iterator it = varTypeMap_.find( variableName );
-	if ( it == varTypeMap_.end() ) {
+	const ModelVariableTable& variables = fmu_->description->getVariableTable();
+	const fmippSize i = variables.find( variableName );
+	if ( ModelVariableTable::npos == i ) {
 		fmippString ret = variableName + fmippString( " does not exist" );
 		logger( fmi2Discard, "WARNING", ret );
 		return fmippTypeUnknown;
 	}
-	return it->second;
+	return variables.getType( i );
 }
 
 fmippBoolean
@@ -9,6 +9,7 @@
 
 #include <assert.h>
 #include <set>
+#include <vector>
 #include <sstream>
 #include <iostream>
 #include <cassert>
@@ -176,13 +177,11 @@ FMUModelExchange::FMUModelExchange( const fmippString& modelIdentifier,
 FMUModelExchange::FMUModelExchange( const FMUModelExchange& fmu ) :
 		FMUModelExchangeBase( fmu.loggingOn_ ),
 		instance_( 0 ),
-		fmu_( fmu.fmu_ ),
+		fmu_( ( fmu.fmu_ && fmu.fmu_->sharedFMU ) ? ModelManager::getIsolatedCopy( fmu.fmu_ ) : fmu.fmu_ ), // copies of isolated instances are isolated too
 		callbacks_( fmu.callbacks_ ),
 		nStateVars_( fmu.nStateVars_ ),
 		nEventInds_( fmu.nEventInds_ ),
 		nValueRefs_( fmu.nValueRefs_ ),
-		varMap_( fmu.varMap_ ),
-		varTypeMap_( fmu.varTypeMap_ ),
 		stopBeforeEvent_( fmu.stopBeforeEvent_ ),
 		eventSearchPrecision_( fmu.eventSearchPrecision_ ),
 		time_( numeric_limits<fmippTime>::quiet_NaN() ),
@@ -234,9 +233,6 @@ FMUModelExchange::~FMUModelExchange()
 
 void FMUModelExchange::readModelDescription()
 {
-	using namespace ModelDescriptionUtilities;
-
-	typedef ModelDescription::Properties Properties;
 	const ModelDescription* description = fmu_->description;
 
 	nStateVars_ = description->getNumberOfContinuousStates();
@@ -244,28 +240,18 @@ void FMUModelExchange::readModelDescription()
 
 	providesJacobian_ = false;
 
-	const Properties& modelVariables = description->getModelVariables();
-	Properties::const_iterator itVar = modelVariables.begin();
-	Properties::const_iterator itEnd = modelVariables.end();
-
-	// List of all variable names -> check if names are unique.
-	set<fmippString> allVariableNames;
-	pair< set<fmippString>::iterator, fmippBoolean > varNamesInsert;
+	const ModelVariableTable& modelVariables = description->getVariableTable();
 
 	// List of all variable value references -> check if value references are unique.
 	set<fmippValueReference> allVariableValRefs;
 	pair< set<fmippValueReference>::iterator, fmippBoolean > varValRefsInsert;
 
-	for ( ; itVar != itEnd; ++itVar )
+	for ( fmippSize i = 0; i < modelVariables.size(); ++i )
 	{
-		const Properties& varAttributes = getAttributes( itVar );
-
-		fmippString varName = varAttributes.get<fmippString>( "name" );
-		fmippValueReference varValRef = varAttributes.get<fmippValueReference>( "valueReference" );
-
-		varNamesInsert = allVariableNames.insert( varName );
+		fmippString varName = modelVariables.getName( i );
+		fmippValueReference varValRef = modelVariables.getValueReference( i );
 
-		if ( false == varNamesInsert.second ) { // Check if variable name is unique.
+		if ( modelVariables.find( varName ) != i ) { // Check if variable name is unique.
 			fmippString message = fmippString( "multiple definitions of variable name '" ) +
 				varName + fmippString( "' found" );
 			logger( fmiWarning, "WARNING", message );
@@ -279,22 +265,6 @@ void FMUModelExchange::readModelDescription()
 				<< varValRef << "' found";
 			logger( fmiWarning, "WARNING", message.str() );
 		}
-
-		// Map name to value reference.
-		varMap_.insert( make_pair( varName, varValRef ) );
-
-		// Map name to value type.
-		if ( hasChild( itVar, "Real" ) ) {
-			varTypeMap_.insert( make_pair( varName, fmippTypeReal ) );
-		} else if ( hasChild( itVar, "Integer" ) ) {
-			varTypeMap_.insert( make_pair( varName, fmippTypeInteger ) );
-		} else if ( hasChild( itVar, "Boolean" ) ) {
-			varTypeMap_.insert( make_pair( varName, fmippTypeBoolean ) );
-		} else if ( hasChild( itVar, "String" ) ) {
-			varTypeMap_.insert( make_pair( varName, fmippTypeString ) );
-		} else {
-			varTypeMap_.insert( make_pair( varName, fmippTypeUnknown ) );
-		}
 	}
 	if ( fmu_->description->hasDefaultExperiment() ){
 		Integrator::Properties properties = integrator_->getProperties();
@@ -321,18 +291,19 @@ void FMUModelExchange::readModelDescription()
 		time_ = 0.0;
 	}
 
-	nValueRefs_ = varMap_.size();
+	nValueRefs_ = modelVariables.getNumberOfNames();
 }
 
 FMIPPVariableType FMUModelExchange::getType( const fmippString& variableName ) const
 {
-	map<fmippString,FMIPPVariableType>::const_iterator it = varTypeMap_.find( variableName );
-	if ( it == varTypeMap_.end() ) {
+	const ModelVariableTable& variables = fmu_->description->getVariableTable();
+	const fmippSize i = variables.find( variableName );
+	if ( ModelVariableTable::npos == i ) {
 		fmippString ret = variableName + fmippString( " does not exist" );
 		logger( fmiDiscard, "WARNING", ret );
 		return fmippTypeUnknown;
 	}
-	return it->second;
+	return variables.getType( i );
 }
 
 fmippStatus FMUModelExchange::instantiate( const fmippString& instanceName )
@@ -370,6 +341,8 @@ fmippStatus FMUModelExchange::instantiate( const fmippString& instanceName )
 	instance_ = fmu_->functions->instantiateModel( instanceName_.c_str(),
 		guid.c_str(), callbacks_, loggingOn_ );
 
+	evaluationCache_->invalidate();
+
 	if ( 0 == instance_ ) {
 		lastStatus_ = fmiError;
 		return (fmippStatus) lastStatus_;
@@ -399,6 +372,7 @@ fmippStatus FMUModelExchange::initialize( fmippBoolean toleranceDefined, fmippRe
 	lastStatus_ = fmu_->functions->initialize( instance_, static_cast<fmippBoolean>( toleranceDefined ), tolerance, eventinfo_ );
 
 	saveEventIndicators();
+	modelChanged();
 
 	if ( fmiTrue == eventinfo_->upcomingTimeEvent ) {
 		tnextevent_ = eventinfo_->nextEventTime;
@@ -416,26 +390,39 @@ fmippStatus FMUModelExchange::setTime( fmippReal time )
 {
 	time_ = time;
 	// NB: If instance_ != 0 then also fmu_ != 0.
-	if ( 0 != instance_ ) return (fmippStatus) fmu_->functions->setTime( instance_, time_ );
+	if ( 0 == instance_ ) return fmippFatal;
 
-	return fmippFatal;
+	// skip the call if the FMU is at this time already
+	if ( evaluationCache_->hasTime( time_ ) ) return fmippOK;
+
+	fmiStatus status = fmu_->functions->setTime( instance_, time_ );
+	if ( fmiOK == status ) {
+		evaluationCache_->storeTime( time_ );
+	} else {
+		evaluationCache_->invalidate();
+	}
+
+	return (fmippStatus) status;
 }
 
 void FMUModelExchange::rewindTime( fmippReal deltaRewindTime )
 {
 	time_ -= deltaRewindTime;
+	evaluationCache_->invalidate();
 	fmu_->functions->setTime( instance_, time_ );
 	//fmu_->functions->eventUpdate( instance_, fmippFalse, eventinfo_ );
 }
 
 fmippStatus FMUModelExchange::setValue( fmippValueReference valref, const fmippReal& val )
 {
+	modelChanged();
 	lastStatus_ = fmu_->functions->setReal( instance_, &valref, 1, &val );
 	return (fmippStatus) lastStatus_;
 }
 
 fmippStatus FMUModelExchange::setValue( fmippValueReference valref, const fmippInteger& val )
 {
+	modelChanged();
 	lastStatus_ = fmu_->functions->setInteger( instance_, &valref, 1, &val );
 	return (fmippStatus) lastStatus_;
 }
@@ -443,6 +430,7 @@ fmippStatus FMUModelExchange::setValue( fmippValueReference valref, const fmippI
 fmippStatus FMUModelExchange::setValue( fmippValueReference valref, const fmippBoolean& val )
 {
 	fmiBoolean val2 = (fmiBoolean) val;
+	modelChanged();
 	lastStatus_ = fmu_->functions->setBoolean( instance_, &valref, 1, &val2 );
 	return (fmippStatus) lastStatus_;
 }
@@ -450,29 +438,30 @@ fmippStatus FMUModelExchange::setValue( fmippValueReference valref, const fmippB
 fmippStatus FMUModelExchange::setValue( fmippValueReference valref, const fmippString& val )
 {
 	const char* cString = val.c_str();
+	modelChanged();
 	lastStatus_ = fmu_->functions->setString( instance_, &valref, 1, &cString );
 	return (fmippStatus) lastStatus_;
 }
 
 fmippStatus FMUModelExchange::setValue(fmippValueReference* valref, const fmippReal* val, fmippSize ival)
 {
+	modelChanged();
 	lastStatus_ = fmu_->functions->setReal(instance_, valref, ival, val);
 	return (fmippStatus) lastStatus_;
 }
 
 fmippStatus FMUModelExchange::setValue(fmippValueReference* valref, const fmippInteger* val, fmippSize ival)
 {
+	modelChanged();
 	lastStatus_ = fmu_->functions->setInteger(instance_, valref, ival, val);
 	return (fmippStatus) lastStatus_;
 }
 
 fmippStatus FMUModelExchange::setValue(fmippValueReference* valref, const fmippBoolean* val, fmippSize ival)
 {
-	fmiBoolean* val2 = new fmiBoolean[ival];
-	for ( fmippSize i = 0; i < ival; ++i ) {
-		val2[i] = (fmiBoolean) val[i];
-	}
-	lastStatus_ = fmu_->functions->setBoolean(instance_, valref, ival, val2);
+	std::vector<fmiBoolean> val2( val, val + ival );
+	modelChanged();
+	lastStatus_ = fmu_->functions->setBoolean( instance_, valref, ival, val2.data() );
 	return (fmippStatus) lastStatus_;
 }
 
@@ -483,6 +472,7 @@ fmippStatus FMUModelExchange::setValue(fmippValueReference* valref, const fmippS
 		cStrings[i] = val[i].c_str();
 	}
 
+	modelChanged();
 	lastStatus_ = fmu_->functions->setString(instance_, valref, ival, cStrings);
 	delete [] cStrings;
 
@@ -491,9 +481,10 @@ fmippStatus FMUModelExchange::setValue(fmippValueReference* valref, const fmippS
 
 fmippStatus FMUModelExchange::setValue( const fmippString& name, const fmippReal& val )
 {
-	map<fmippString,fmippValueReference>::const_iterator it = varMap_.find( name );
-	if ( it != varMap_.end() ) {
-		lastStatus_ = fmu_->functions->setReal( instance_, &it->second, 1, &val );
+	const fmippValueReference valref = getValueRef( name );
+	if ( fmippUndefinedValueReference != valref ) {
+		modelChanged();
+		lastStatus_ = fmu_->functions->setReal( instance_, &valref, 1, &val );
 	} else {
 		fmippString ret = name + fmippString( " does not exist" );
 		logger( fmiDiscard, "WARNING", ret );
@@ -505,9 +496,10 @@ fmippStatus FMUModelExchange::setValue( const fmippString& name, const fmippReal
 
 fmippStatus FMUModelExchange::setValue( const fmippString& name, const fmippInteger& val )
 {
-	map<fmippString,fmippValueReference>::const_iterator it = varMap_.find( name );
-	if ( it != varMap_.end() ) {
-		lastStatus_ = fmu_->functions->setInteger( instance_, &it->second, 1, &val );
+	const fmippValueReference valref = getValueRef( name );
+	if ( fmippUndefinedValueReference != valref ) {
+		modelChanged();
+		lastStatus_ = fmu_->functions->setInteger( instance_, &valref, 1, &val );
 	} else {
 		fmippString ret = name + fmippString( " does not exist" );
 		logger( fmiDiscard, "WARNING", ret );
@@ -519,10 +511,11 @@ fmippStatus FMUModelExchange::setValue( const fmippString& name, const fmippInte
 
 fmippStatus FMUModelExchange::setValue( const fmippString& name, const fmippBoolean& val )
 {
-	map<fmippString,fmippValueReference>::const_iterator it = varMap_.find( name );
+	const fmippValueReference valref = getValueRef( name );
 	fmiBoolean val2 = (fmiBoolean) val;
-	if ( it != varMap_.end() ) {
-		lastStatus_ = fmu_->functions->setBoolean( instance_, &it->second, 1, &val2 );
+	if ( fmippUndefinedValueReference != valref ) {
+		modelChanged();
+		lastStatus_ = fmu_->functions->setBoolean( instance_, &valref, 1, &val2 );
 	} else {
 		fmippString ret = name + fmippString( " does not exist" );
 		logger( fmiDiscard, "WARNING", ret );
@@ -534,10 +527,11 @@ fmippStatus FMUModelExchange::setValue( const fmippString& name, const fmippBool
 
 fmippStatus FMUModelExchange::setValue( const fmippString& name, const fmippString& val )
 {
-	map<fmippString,fmippValueReference>::const_iterator it = varMap_.find( name );
+	const fmippValueReference valref = getValueRef( name );
 	const char* cString = val.c_str();
-	if ( it != varMap_.end() ) {
-		lastStatus_ = fmu_->functions->setString( instance_, &it->second, 1, &cString );
+	if ( fmippUndefinedValueReference != valref ) {
+		modelChanged();
+		lastStatus_ = fmu_->functions->setString( instance_, &valref, 1, &cString );
 	} else {
 		fmippString ret = name + fmippString( " does not exist" );
 		logger( fmiDiscard, "WARNING", ret );
@@ -588,31 +582,29 @@ fmippStatus FMUModelExchange::getValue( fmippValueReference* valref, fmippIntege
 
 fmippStatus FMUModelExchange::getValue( fmippValueReference* valref, fmippBoolean* val, fmippSize ival )
 {
-	fmiBoolean* val2 = new fmiBoolean[ival];
+	std::vector<fmiBoolean> val2( ival );
+	lastStatus_ = fmu_->functions->getBoolean( instance_, valref, ival, val2.data() );
 	for ( fmippSize i = 0; i < ival; ++i ) {
-		val2[i] = (fmiBoolean) val[i];
+		val[i] = ( fmiFalse != val2[i] );
 	}
-	lastStatus_ = fmu_->functions->getBoolean( instance_, valref, ival, val2 );
 	return (fmippStatus) lastStatus_;
 }
 
 fmippStatus FMUModelExchange::getValue( fmippValueReference* valref, fmippString* val, fmippSize ival )
 {
-	const char** cStrings = 0;
-	lastStatus_ = fmu_->functions->getString( instance_, valref, ival, cStrings );
-	if ( 0 != cStrings ) {
-		for ( fmippSize i = 0; i < ival; i++ ) {
-			val[i] = fmippString( cStrings[i] );
-		}
+	std::vector<fmiString> cStrings( ival, static_cast<fmiString>( 0 ) );
+	lastStatus_ = fmu_->functions->getString( instance_, valref, ival, cStrings.data() );
+	for ( fmippSize i = 0; i < ival; ++i ) {
+		if ( 0 != cStrings[i] ) val[i] = fmippString( cStrings[i] );
 	}
 	return (fmippStatus) lastStatus_;
 }
 
 fmippStatus FMUModelExchange::getValue( const fmippString& name, fmippReal& val )
 {
-	map<fmippString,fmippValueReference>::const_iterator it = varMap_.find( name );
-	if ( it != varMap_.end() ) {
-		lastStatus_ = fmu_->functions->getReal( instance_, &it->second, 1, &val );
+	const fmippValueReference valref = getValueRef( name );
+	if ( fmippUndefinedValueReference != valref ) {
+		lastStatus_ = fmu_->functions->getReal( instance_, &valref, 1, &val );
 	} else {
 		fmippString ret = name + fmippString( " does not exist" );
 		logger( fmiDiscard, "WARNING", ret );
@@ -624,9 +616,9 @@ fmippStatus FMUModelExchange::getValue( const fmippString& name, fmippReal& val
 
 fmippStatus FMUModelExchange::getValue( const fmippString& name, fmippInteger& val )
 {
-	map<fmippString,fmippValueReference>::const_iterator it = varMap_.find( name );
-	if ( it != varMap_.end() ) {
-		lastStatus_ = fmu_->functions->getInteger( instance_, &it->second, 1, &val );
+	const fmippValueReference valref = getValueRef( name );
+	if ( fmippUndefinedValueReference != valref ) {
+		lastStatus_ = fmu_->functions->getInteger( instance_, &valref, 1, &val );
 	} else {
 		fmippString ret = name + fmippString( " does not exist" );
 		logger( fmiDiscard, "WARNING", ret );
@@ -638,10 +630,10 @@ fmippStatus FMUModelExchange::getValue( const fmippString& name, fmippInteger& v
 
 fmippStatus FMUModelExchange::getValue( const fmippString& name, fmippBoolean& val )
 {
-	map<fmippString,fmippValueReference>::const_iterator it = varMap_.find( name );
-	if ( it != varMap_.end() ) {
+	const fmippValueReference valref = getValueRef( name );
+	if ( fmippUndefinedValueReference != valref ) {
 		fmiBoolean val2 = (fmiBoolean) val;
-		lastStatus_ = fmu_->functions->getBoolean( instance_, &it->second, 1, &val2 );
+		lastStatus_ = fmu_->functions->getBoolean( instance_, &valref, 1, &val2 );
 	} else {
 		fmippString ret = name + fmippString( " does not exist" );
 		logger( fmiDiscard, "WARNING", ret );
@@ -653,10 +645,10 @@ fmippStatus FMUModelExchange::getValue( const fmippString& name, fmippBoolean& v
 
 fmippStatus FMUModelExchange::getValue( const fmippString& name, fmippString& val )
 {
-	map<fmippString,fmippValueReference>::const_iterator it = varMap_.find( name );
+	const fmippValueReference valref = getValueRef( name );
 	const char* cString;
-	if ( it != varMap_.end() ) {
-		lastStatus_ = fmu_->functions->getString( instance_, &it->second, 1, &cString );
+	if ( fmippUndefinedValueReference != valref ) {
+		lastStatus_ = fmu_->functions->getString( instance_, &valref, 1, &cString );
 		val = fmippString( cString );
 	} else {
 		fmippString ret = name + fmippString( " does not exist" );
@@ -669,11 +661,11 @@ fmippStatus FMUModelExchange::getValue( const fmippString& name, fmippString& va
 
 fmippReal FMUModelExchange::getRealValue( const fmippString& name )
 {
-	map<fmippString,fmippValueReference>::const_iterator it = varMap_.find( name );
+	const fmippValueReference valref = getValueRef( name );
 	fmippReal val[1];
 
-	if ( it != varMap_.end() ) {
-		lastStatus_ = fmu_->functions->getReal( instance_, &it->second, 1, val );
+	if ( fmippUndefinedValueReference != valref ) {
+		lastStatus_ = fmu_->functions->getReal( instance_, &valref, 1, val );
 	} else {
 		val[0] = numeric_limits<fmippReal>::quiet_NaN();
 		fmippString ret = name + fmippString( " does not exist" );
@@ -686,11 +678,11 @@ fmippReal FMUModelExchange::getRealValue( const fmippString& name )
 
 fmippInteger FMUModelExchange::getIntegerValue( const fmippString& name )
 {
-	map<fmippString,fmippValueReference>::const_iterator it = varMap_.find( name );
+	const fmippValueReference valref = getValueRef( name );
 	fmippInteger val[1];
 
-	if ( it != varMap_.end() ) {
-		lastStatus_ = fmu_->functions->getInteger( instance_, &it->second, 1, val );
+	if ( fmippUndefinedValueReference != valref ) {
+		lastStatus_ = fmu_->functions->getInteger( instance_, &valref, 1, val );
 	} else {
 		val[0] = numeric_limits<fmippInteger>::quiet_NaN();
 		fmippString ret = name + fmippString( " does not exist" );
@@ -703,11 +695,11 @@ fmippInteger FMUModelExchange::getIntegerValue( const fmippString& name )
 
 fmippBoolean FMUModelExchange::getBooleanValue( const fmippString& name )
 {
-	map<fmippString,fmippValueReference>::const_iterator it = varMap_.find( name );
+	const fmippValueReference valref = getValueRef( name );
 	fmiBoolean val[1];
 
-	if ( it != varMap_.end() ) {
-		lastStatus_ = fmu_->functions->getBoolean( instance_, &it->second, 1, val );
+	if ( fmippUndefinedValueReference != valref ) {
+		lastStatus_ = fmu_->functions->getBoolean( instance_, &valref, 1, val );
 	} else {
 		val[0] = fmiFalse;
 		fmippString ret = name + fmippString( " does not exist" );
@@ -720,11 +712,11 @@ fmippBoolean FMUModelExchange::getBooleanValue( const fmippString& name )
 
 fmippString FMUModelExchange::getStringValue( const fmippString& name )
 {
-	map<fmippString,fmippValueReference>::const_iterator it = varMap_.find( name );
+	const fmippValueReference valref = getValueRef( name );
 	fmiString val[1];
 
-	if ( it != varMap_.end() ) {
-		lastStatus_ = fmu_->functions->getString( instance_, &it->second, 1, val );
+	if ( fmippUndefinedValueReference != valref ) {
+		lastStatus_ = fmu_->functions->getString( instance_, &valref, 1, val );
 	} else {
 		val[0] = 0;
 		fmippString ret = name + fmippString( " does not exist" );
@@ -747,34 +739,58 @@ fmippStatus FMUModelExchange::getLastStatus() const
 fmippStatus FMUModelExchange::getContinuousStates( fmippReal* val )
 {
 	lastStatus_ = fmu_->functions->getContinuousStates( instance_, val, nStateVars_ );
+	if ( fmiOK == lastStatus_ ) evaluationCache_->storeStates( val, nStateVars_ );
 	return (fmippStatus) lastStatus_;
 }
 
 fmippStatus FMUModelExchange::setContinuousStates( const fmippReal* val )
 {
+	// skip the call if these states are set already
+	if ( evaluationCache_->hasStates( val, nStateVars_ ) ) {
+		lastStatus_ = fmiOK;
+		return (fmippStatus) lastStatus_;
+	}
+
 	lastStatus_ = fmu_->functions->setContinuousStates( instance_, val, nStateVars_ );
+	if ( fmiOK == lastStatus_ ) {
+		evaluationCache_->storeStates( val, nStateVars_ );
+	} else {
+		evaluationCache_->invalidate();
+	}
+
 	return (fmippStatus) lastStatus_;
 }
 
 fmippStatus FMUModelExchange::getDerivatives( fmippReal* val )
 {
+	// reuse the derivatives if neither time nor states changed since the last evaluation
+	if ( evaluationCache_->getDerivatives( val, nStateVars_ ) ) {
+		lastStatus_ = fmiOK;
+		return (fmippStatus) lastStatus_;
+	}
+
 	lastStatus_ = fmu_->functions->getDerivatives( instance_, val, nStateVars_ );
+	if ( fmiOK == lastStatus_ ) evaluationCache_->storeDerivatives( val, nStateVars_ );
 	return (fmippStatus) lastStatus_;
 }
 
 fmippValueReference FMUModelExchange::getValueRef( const fmippString& name ) const
 {
-	map<fmippString,fmippValueReference>::const_iterator it = varMap_.find(name);
-	if ( it != varMap_.end() ) {
-		return it->second;
-	} else {
-		return fmiUndefinedValueReference;
-	}
+	const ModelVariableTable& variables = fmu_->description->getVariableTable();
+	const fmippSize i = variables.find( name );
+	return ( ModelVariableTable::npos != i ) ? variables.getValueReference( i ) : fmippUndefinedValueReference;
 }
 
 fmippStatus FMUModelExchange::getEventIndicators( fmippReal* eventsind )
 {
+	// reuse the event indicators if neither time nor states changed since the last evaluation
+	if ( evaluationCache_->getEventIndicators( eventsind, nEventInds() ) ) {
+		lastStatus_ = fmiOK;
+		return (fmippStatus) lastStatus_;
+	}
+
 	lastStatus_ = fmu_->functions->getEventIndicators(instance_, eventsind, nEventInds());
+	if ( fmiOK == lastStatus_ ) evaluationCache_->storeEventIndicators( eventsind, nEventInds() );
 	return (fmippStatus) lastStatus_;
 }
 
@@ -787,6 +803,9 @@ fmippReal FMUModelExchange::integrate( fmippTime tstop, unsigned int nsteps )
 
 fmippReal FMUModelExchange::integrate( fmippTime tend, fmippTime deltaT )
 {
+	// skip redundant calls to the FMU while integrating
+	ModelEvaluationCache::Activation activation( *evaluationCache_ );
+
 	// If there are no continuous states, skip integration.
 	if ( nStateVars_ == 0 ){
 
@@ -957,6 +976,9 @@ void FMUModelExchange::handleEvents()
 	eventinfo_->iterationConverged = fmiFalse;
 	while ( fmiFalse == eventinfo_->iterationConverged )
 		fmu_->functions->eventUpdate( instance_, fmiTrue, eventinfo_ );
+
+	// the RHS might be discontinuous, restart the integrator
+	modelChanged();
 }
 
 fmippStatus FMUModelExchange::completedIntegratorStep()
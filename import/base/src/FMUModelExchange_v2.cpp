@@ -8,10 +8,14 @@
  */
 #include <assert.h>
 #include <set>
+#include <vector>
 #include <sstream>
 #include <iostream>
 #include <cassert>
 #include <limits>
+#include <memory>
+#include <algorithm>
+#include <cmath>
 
 #if defined( WIN32 ) // Windows.
 #include <algorithm>
@@ -27,12 +31,87 @@
 #include "import/base/include/FMUModelExchange_v2.h"
 #include "import/base/include/ModelDescription.h"
 #include "import/base/include/ModelManager.h"
+#include "import/base/include/ForkedFMU.h"
 #include "import/base/include/CallbackFunctions.h"
 
 using namespace std;
 
 namespace fmi_2_0 {
 
+/// Append the names of all variables with a given value reference ( in alphabetical order ).
+static void appendVariableNames( const ModelVariableTable& variables, fmippValueReference ref,
+	vector<fmippString>& names )
+{
+	const fmippSize first = names.size();
+	for ( fmippSize i = 0; i < variables.size(); ++i ) {
+		if ( ( variables.getValueReference( i ) == ref ) && ( variables.find( variables.getName( i ) ) == i ) )
+			names.push_back( variables.getName( i ) );
+	}
+	sort( names.begin() + first, names.end() );
+}
+
+/**
+ * The states of an FMU for ME augmented by their sensitivities with respect to some parameters
+ * ( see FMUModelExchange::enableSensitivities() ). The sensitivities are appended to the states
+ * parameter by parameter. Time, event indicators and step events are those of the FMU.
+ */
+class SensitivitySystem : public DynamicalSystem
+{
+
+public:
+
+	SensitivitySystem( FMUModelExchange* fmu, fmippSize nParameters ) :
+		fmu_( fmu ),
+		nStates_( fmu->nStates() ),
+		sensitivities_( fmu->nStates()*nParameters, 0.0 )
+	{
+		providesJacobian_ = fmippFalse;
+	}
+
+	fmippStatus setTime( fmippTime time ) { return fmu_->setTime( time ); }
+
+	fmippTime getTime() const { return fmu_->getTime(); }
+
+	fmippStatus getContinuousStates( fmippReal* x ) {
+		copy( sensitivities_.begin(), sensitivities_.end(), x + nStates_ );
+		return fmu_->getContinuousStates( x );
+	}
+
+	fmippStatus setContinuousStates( const fmippReal* x ) {
+		copy( x + nStates_, x + nStates(), sensitivities_.begin() );
+		return fmu_->setContinuousStates( x );
+	}
+
+	fmippStatus getDerivatives( fmippReal* dx ) {
+		fmippStatus status = fmu_->getDerivatives( dx );
+		if ( fmippOK != status ) return status;
+		return fmu_->getSensitivities( fmu_->derivatives_refs_, nStates_, &sensitivities_[0], dx + nStates_ );
+	}
+
+	fmippStatus getEventIndicators( fmippReal* eventsind ) { return fmu_->getEventIndicators( eventsind ); }
+
+	fmippSize nStates() const { return nStates_ + sensitivities_.size(); }
+
+	fmippSize nEventInds() const { return fmu_->nEventInds(); }
+
+	fmippBoolean checkStepEvent() { return fmu_->checkStepEvent(); }
+
+	/// The integrator checks state events against the event indicators saved here.
+	using DynamicalSystem::saveEventIndicators;
+
+	/// The integrator of the augmented system.
+	Integrator* integrator() { return integrator_; }
+
+	/// The sensitivities of the states, stored parameter by parameter.
+	vector<fmippReal>& sensitivities() { return sensitivities_; }
+
+private:
+
+	FMUModelExchange* fmu_;
+	const fmippSize nStates_;
+	vector<fmippReal> sensitivities_;
+};
+
 // Constructor. Loads the FMU via the model manager (if needed).
 FMUModelExchange::FMUModelExchange( const fmippString& fmuDirUri,
 	const fmippString& modelIdentifier,
@@ -66,7 +145,10 @@ FMUModelExchange::FMUModelExchange( const fmippString& fmuDirUri,
 		raisedEvent_( fmippFalse ),
 		eventFlag_( fmippFalse ),
 		intEventFlag_( fmippFalse ),
-		lastStatus_( fmi2OK )
+		lastStatus_( fmi2OK ),
+		sensitivities_( 0 ),
+		stateIntegrator_( 0 ),
+		sensitivityDirectionalDerivatives_( fmippFalse )
 {
 	// Get the model manager.
 	ModelManager& manager = ModelManager::getModelManager();
@@ -153,7 +235,10 @@ FMUModelExchange::FMUModelExchange( const fmippString& modelIdentifier,
 		raisedEvent_( fmippFalse ),
 		eventFlag_( fmippFalse ),
 		intEventFlag_( fmippFalse ),
-		lastStatus_( fmi2OK )
+		lastStatus_( fmi2OK ),
+		sensitivities_( 0 ),
+		stateIntegrator_( 0 ),
+		sensitivityDirectionalDerivatives_( fmippFalse )
 {
 	// Get the model manager.
 	ModelManager& manager = ModelManager::getModelManager();
@@ -183,15 +268,13 @@ FMUModelExchange::FMUModelExchange( const fmippString& modelIdentifier,
 FMUModelExchange::FMUModelExchange( const FMUModelExchange& fmu ) :
 		FMUModelExchangeBase( fmu.loggingOn_ ),
 		instance_( 0 ),
-		fmu_( fmu.fmu_ ),
+		fmu_( ( fmu.fmu_ && fmu.fmu_->sharedFMU ) ? ModelManager::getIsolatedCopy( fmu.fmu_ ) : fmu.fmu_ ), // copies of isolated instances are isolated too
 		callbacks_( fmu.callbacks_ ),
 		nStateVars_( fmu.nStateVars_ ),
 		nEventInds_( fmu.nEventInds_ ),
 		nValueRefs_( fmu.nValueRefs_ ),
 		derivatives_refs_( 0 ),
 		states_refs_( 0 ),
-		varMap_( fmu.varMap_ ),
-		varTypeMap_( fmu.varTypeMap_ ),
 		stopBeforeEvent_( fmu.stopBeforeEvent_ ),
 		eventSearchPrecision_( fmu.eventSearchPrecision_ ),
 		intStates_( 0 ),
@@ -211,9 +294,15 @@ FMUModelExchange::FMUModelExchange( const FMUModelExchange& fmu ) :
 		raisedEvent_( fmippFalse ),
 		eventFlag_( fmippFalse ),
 		intEventFlag_( fmippFalse ),
-		lastStatus_( fmi2OK )
+		lastStatus_( fmi2OK ),
+		metadata_( fmu.metadata_ ),
+		sensitivities_( 0 ),
+		stateIntegrator_( 0 ),
+		sensitivityDirectionalDerivatives_( fmippFalse )
 {
 	if ( 0 != fmu_ ){
+		// Share the information extracted from the model description.
+		if ( metadata_ ) applyMetadata();
 		if ( 0 != nStateVars_ ) {
 			// allocate memory for the integrator
 			integrator_->initialize();
@@ -228,17 +317,21 @@ FMUModelExchange::~FMUModelExchange()
 	// if instance is NULL, eventinfo_ must be NULL too:
 	assert(instance_ || eventinfo_ == NULL);
 
-	if ( eventsind_ )        delete[] eventsind_;
-	if ( preeventsind_ )     delete[] preeventsind_;
-	if ( intStates_ )        delete[] intStates_;
-	if ( intDerivatives_ )   delete[] intDerivatives_;
+	// the integrator of the states is deleted by DynamicalSystem
+	disableSensitivities();
 
-	if ( derivatives_refs_ ) delete[] derivatives_refs_;
-	if ( states_refs_ )      delete[] states_refs_;
+	if ( !arena_ ) { // Buffers in an arena are deleted together with the last instance using it.
+		if ( eventsind_ )        delete[] eventsind_;
+		if ( preeventsind_ )     delete[] preeventsind_;
+		if ( intStates_ )        delete[] intStates_;
+		if ( intDerivatives_ )   delete[] intDerivatives_;
+	}
 
 	if ( instance_ ) {
 		delete eventinfo_;
 
+		stateDeleter_.reset(); // invalidate all snapshots
+
 		fmu_->functions->terminate( instance_ );
 #ifndef MINGW
 		/// \bug This call causes a seg fault with OpenModelica FMUs under MINGW ...
@@ -252,37 +345,26 @@ void FMUModelExchange::readModelDescription()
 	assert(derivatives_refs_ == NULL); // Will be initialized
 	assert(states_refs_ == NULL); // Will be initialized
 
-	using namespace ModelDescriptionUtilities;
-	typedef ModelDescription::Properties Properties;
-
 	const ModelDescription* description = fmu_->description;
 
-	nStateVars_       = description->getNumberOfContinuousStates();
-	nEventInds_       = description->getNumberOfEventIndicators();
-	providesJacobian_ = description->providesJacobian();
+	shared_ptr<Metadata> metadata( new Metadata );
 
-	const Properties& modelVariables = description->getModelVariables();
+	metadata->nStateVars       = description->getNumberOfContinuousStates();
+	metadata->nEventInds       = description->getNumberOfEventIndicators();
+	metadata->providesJacobian = description->providesJacobian();
 
-	Properties::const_iterator itVar = modelVariables.begin();
-	Properties::const_iterator itEnd = modelVariables.end();
-
-	// List of all variable names -> check if names are unique.
-	set<fmippString> allVariableNames;
-	pair< set<fmippString>::iterator, fmippBoolean > varNamesInsert;
+	const ModelVariableTable& modelVariables = description->getVariableTable();
 
 	// List of all variable value references -> check if value references are unique.
 	set<fmippValueReference> allVariableValRefs;
 	pair< set<fmippValueReference>::iterator, fmippBoolean > varValRefsInsert;
 
-	for ( ; itVar != itEnd; ++itVar )
+	for ( fmippSize i = 0; i < modelVariables.size(); ++i )
 	{
-		const Properties& varAttributes = getAttributes( itVar );
-
-		fmippString varName = varAttributes.get<fmippString>( "name" );
-		fmippValueReference varValRef = varAttributes.get<fmippValueReference>( "valueReference" );
+		fmippString varName = modelVariables.getName( i );
+		fmippValueReference varValRef = modelVariables.getValueReference( i );
 
-		varNamesInsert = allVariableNames.insert( varName );
-		if ( false == varNamesInsert.second ) { // Check if variable name is unique.
+		if ( modelVariables.find( varName ) != i ) { // Check if variable name is unique.
 			fmippString message = fmippString( "multiple definitions of variable name '" ) +
 				varName + fmippString( "' found" );
 			logger( fmi2Warning, "WARNING", message );
@@ -295,73 +377,128 @@ void FMUModelExchange::readModelDescription()
 				<< varValRef << "' found";
 			logger( fmi2Warning, "WARNING", message.str() );
 		}
-
-		// Map name to value reference.
-		varMap_.insert( make_pair( varName, varValRef ) );
-
-		// Map name to value type.
-		if ( hasChild( itVar, "Real" ) ) {
-			varTypeMap_.insert( make_pair( varName, fmippTypeReal ) );
-		} else if ( hasChild( itVar, "Integer" ) ) {
-			varTypeMap_.insert( make_pair( varName, fmippTypeInteger ) );
-		} else if ( hasChild( itVar, "Boolean" ) ) {
-			varTypeMap_.insert( make_pair( varName, fmippTypeBoolean ) );
-		} else if ( hasChild( itVar, "String" ) ) {
-			varTypeMap_.insert( make_pair( varName, fmippTypeString ) );
-		} else {
-			varTypeMap_.insert( make_pair( varName, fmippTypeUnknown ) );
-		}
 	}
 
+	metadata->startTime = numeric_limits<fmippTime>::quiet_NaN();
+	metadata->tolerance = numeric_limits<fmippReal>::quiet_NaN();
 	if ( fmu_->description->hasDefaultExperiment() ){
-		Integrator::Properties properties = integrator_->getProperties();
-		fmippTime startTime;
 		fmippTime stopTime;
-		fmippReal tolerance;
 		fmippTime stepSize; // \FIXME: currently unused
-		fmu_->description->getDefaultExperiment( startTime, stopTime, tolerance, stepSize );
-		if ( tolerance == tolerance ) {
-			properties.reltol = properties.abstol = tolerance;
-			integrator_->setProperties( properties );
-		}
-		if ( startTime == startTime ) {
-			time_ = startTime;
-		} else {
-			time_ = 0.0;
-			}
-	} else {
-		time_ = 0.0;
+		fmu_->description->getDefaultExperiment( metadata->startTime, stopTime, metadata->tolerance, stepSize );
 	}
 
-	nValueRefs_ = varMap_.size();
+	metadata->nValueRefs = modelVariables.getNumberOfNames();
 
 	// get the references of the states and derivatives for the Jacobian
-	derivatives_refs_ = new fmippValueReference[nStateVars_];
-	states_refs_ = new fmippValueReference[nStateVars_];
-	if ( nStateVars_> 0 )
-		description->getStatesAndDerivativesReferences( states_refs_, derivatives_refs_ );
+	metadata->derivativesRefs.resize( metadata->nStateVars );
+	metadata->statesRefs.resize( metadata->nStateVars );
+	if ( metadata->nStateVars > 0 )
+		description->getStatesAndDerivativesReferences( &metadata->statesRefs[0], &metadata->derivativesRefs[0] );
+
+	// get the sparsity pattern of the Jacobian, if the model structure provides it
+	vector<fmippSize> rowPtr;
+	vector<fmippSize> colInd;
+	if ( ( metadata->nStateVars > 0 ) && description->getDerivativesDependencies( rowPtr, colInd ) )
+		metadata->jacobianSparsity.setPattern( metadata->nStateVars, rowPtr, colInd );
+
+	metadata_ = metadata;
+	applyMetadata();
+}
+
+
+void FMUModelExchange::applyMetadata()
+{
+	nStateVars_       = metadata_->nStateVars;
+	nEventInds_       = metadata_->nEventInds;
+	nValueRefs_       = metadata_->nValueRefs;
+	providesJacobian_ = metadata_->providesJacobian;
+
+	derivatives_refs_ = metadata_->derivativesRefs.data();
+	states_refs_      = metadata_->statesRefs.data();
+
+	jacobianSparsity_ = metadata_->jacobianSparsity;
+
+	if ( metadata_->tolerance == metadata_->tolerance ) {
+		Integrator::Properties properties = integrator_->getProperties();
+		properties.reltol = properties.abstol = metadata_->tolerance;
+		integrator_->setProperties( properties );
+	}
+
+	time_ = ( metadata_->startTime == metadata_->startTime ) ? metadata_->startTime : 0.0;
+}
+
+
+vector< unique_ptr<FMUModelExchange> > FMUModelExchange::createInstances( const fmippString& modelIdentifier,
+	const fmippSize nInstances,
+	const fmippBoolean loggingOn,
+	const fmippBoolean stopBeforeEvent,
+	const fmippTime eventSearchPrecision,
+	const IntegratorType type )
+{
+	vector< unique_ptr<FMUModelExchange> > instances;
+	if ( 0 == nInstances ) return instances;
+
+	// Only the first instance reads the model description, all others are copies sharing its metadata.
+	unique_ptr<FMUModelExchange> first( new FMUModelExchange( modelIdentifier,
+		loggingOn, stopBeforeEvent, eventSearchPrecision, type ) );
+	if ( 0 == first->fmu_ ) return instances;
+
+	instances.reserve( nInstances );
+	instances.push_back( move( first ) );
+	const FMUModelExchange& prototype = *instances.front();
+	for ( fmippSize i = 1; i < nInstances; ++i )
+		instances.push_back( unique_ptr<FMUModelExchange>( new FMUModelExchange( prototype ) ) );
+
+	// Allocate the buffers of all instances in one block ( states of all instances,
+	// then derivatives, event indicators and previous event indicators ).
+	const fmippSize nStates = prototype.nStateVars_;
+	const fmippSize nInds = prototype.nEventInds_;
+	const fmippSize size = 2 * nInstances * ( nStates + nInds );
+	if ( 0 == size ) return instances;
+
+	shared_ptr<fmi2Real> arena( new fmi2Real[size], default_delete<fmi2Real[]>() );
+	fmi2Real* states = arena.get();
+	fmi2Real* derivatives = states + nInstances * nStates;
+	fmi2Real* eventInds = derivatives + nInstances * nStates;
+	fmi2Real* preEventInds = eventInds + nInstances * nInds;
+
+	for ( fmippSize i = 0; i < nInstances; ++i ) {
+		FMUModelExchange& fmu = *instances[i];
+		fmu.arena_ = arena;
+		if ( nStates > 0 ) {
+			fmu.intStates_ = states + i * nStates;
+			fmu.intDerivatives_ = derivatives + i * nStates;
+		}
+		if ( nInds > 0 ) {
+			fmu.eventsind_ = eventInds + i * nInds;
+			fmu.preeventsind_ = preEventInds + i * nInds;
+		}
+	}
+
+	return instances;
 }
 
 FMIPPVariableType FMUModelExchange::getType( const fmippString& variableName ) const
 {
-	map<fmippString,FMIPPVariableType>::const_iterator it = varTypeMap_.find( variableName );
+	const ModelVariableTable& variables = fmu_->description->getVariableTable();
+	const fmippSize i = variables.find( variableName );
 
-	if ( it == varTypeMap_.end() ) {
+	if ( ModelVariableTable::npos == i ) {
 		fmippString ret = variableName + fmippString( " does not exist" );
 		logger( fmi2Discard, "WARNING", ret );
 		return fmippTypeUnknown;
 	}
 
-	return it->second;
+	return variables.getType( i );
 }
 
 fmippStatus FMUModelExchange::instantiate( const fmippString& instanceName )
 {
 	// Assert no duplicate initialization:
-	assert( eventsind_ == NULL );
-	assert( preeventsind_ == NULL );
-	assert( intStates_ == NULL );
-	assert( intDerivatives_ == NULL );
+	assert( arena_ || eventsind_ == NULL );
+	assert( arena_ || preeventsind_ == NULL );
+	assert( arena_ || intStates_ == NULL );
+	assert( arena_ || intDerivatives_ == NULL );
 	assert( eventinfo_ == NULL );
 
 	instanceName_ = instanceName;
@@ -374,13 +511,13 @@ fmippStatus FMUModelExchange::instantiate( const fmippString& instanceName )
 	time_ = 0.;
 	tnextevent_ = numeric_limits<fmippTime>::infinity();
 
-	// Memory allocation.
-	if ( nEventInds_ > 0 ) {
+	// Memory allocation ( unless the buffers are part of an arena, see createInstances ).
+	if ( ( nEventInds_ > 0 ) && !arena_ ) {
 		eventsind_ = new fmi2Real[nEventInds_];
 		preeventsind_ = new fmi2Real[nEventInds_];
 	}
 
-	if ( nStateVars_ > 0 ) {
+	if ( ( nStateVars_ > 0 ) && !arena_ ) {
 		intStates_ = new fmi2Real[nStateVars_];
 		intDerivatives_ = new fmi2Real[nStateVars_];
 	}
@@ -396,9 +533,16 @@ fmippStatus FMUModelExchange::instantiate( const fmippString& instanceName )
 
 	fmi2Boolean visible = fmi2False; // visible = false means that the FMU is executed in batch mode
 
-	// call instantiate
-	instance_ = fmu_->functions->instantiate( instanceName_.c_str(), fmi2ModelExchange,
-		guid.c_str(), fmu_->fmuResourceLocation.c_str(), &callbacks_, visible, loggingOn_ );
+	// call instantiate ( forked FMUs are instantiated in a helper process )
+	if ( 0 != fmu_->forkedFMU ) {
+		instance_ = ForkedFMU::instantiate( fmu_, instanceName_.c_str(), fmi2ModelExchange,
+			guid.c_str(), fmu_->fmuResourceLocation.c_str(), &callbacks_, visible, loggingOn_ );
+	} else {
+		instance_ = fmu_->functions->instantiate( instanceName_.c_str(), fmi2ModelExchange,
+			guid.c_str(), fmu_->fmuResourceLocation.c_str(), &callbacks_, visible, loggingOn_ );
+	}
+
+	evaluationCache_->invalidate();
 
 	// check whether instantiate returned a non trivial object
 	if ( 0 == instance_ ){
@@ -406,6 +550,12 @@ fmippStatus FMUModelExchange::instantiate( const fmippString& instanceName )
 		return (fmippStatus) lastStatus_;
 	}
 
+	// Snapshots free their states via this function as long as the instance exists.
+	BareFMU2Ptr fmu = fmu_;
+	fmi2Component instance = instance_;
+	stateDeleter_ = make_shared<FMUSnapshot::Deleter>(
+		[fmu, instance]( void* state ) { fmu->functions->freeFMUstate( instance, &state ); } );
+
 	/// \FIXME retrieve options for debug logging as defined in fmiModelDescription.LogCategories
 	fmippSize nCategories = 0;
 	char** categories = NULL;
@@ -475,6 +625,7 @@ fmippStatus FMUModelExchange::initialize( fmippBoolean toleranceDefined, double
 	fmu_->functions->newDiscreteStates( instance_, eventinfo_ );
 
 	saveEventIndicators();
+	modelChanged();
 
 	if ( fmi2True == eventinfo_->nextEventTimeDefined ) {
 		tnextevent_ = eventinfo_->nextEventTime;
@@ -486,6 +637,148 @@ fmippStatus FMUModelExchange::initialize( fmippBoolean toleranceDefined, double
 	return (fmippStatus) lastStatus_;
 }
 
+fmippStatus FMUModelExchange::reset()
+{
+	// NB: If instance_ != 0 then also fmu_ != 0.
+	if ( 0 == instance_ ) {
+		lastStatus_ = fmi2Error;
+		return (fmippStatus) lastStatus_;
+	}
+
+	lastStatus_ = fmu_->functions->reset( instance_ );
+
+	if ( ( fmi2OK != lastStatus_ ) && ( fmi2Warning != lastStatus_ ) ) return (fmippStatus) lastStatus_;
+
+	// Restore the internal state after instantiate.
+	time_ = 0.;
+	tnextevent_ = numeric_limits<fmippTime>::infinity();
+	lastEventTime_ = numeric_limits<fmippTime>::quiet_NaN();
+
+	for ( fmippSize i = 0; i < nEventInds_; ++i ) {
+		eventsind_[i] = 0;
+		preeventsind_[i] = 0;
+	}
+
+	callEventUpdate_ = fmippFalse;
+	enterEventMode_ = fmippFalse;
+	terminateSimulation_ = fmippFalse;
+	raisedEvent_ = fmippFalse;
+	resetEventFlags();
+
+	evaluationCache_->invalidate();
+
+	return (fmippStatus) lastStatus_;
+}
+
+fmippBoolean FMUModelExchange::canGetAndSetFMUstate() const
+{
+	// Forked FMUs provide FMU states even if the FMU itself does not.
+	return ( 0 != fmu_ ) && ( ( 0 != fmu_->forkedFMU ) || fmu_->description->canGetAndSetFMUstate( fmippFalse ) );
+}
+
+fmippBoolean FMUModelExchange::canSerializeFMUstate() const
+{
+	return ( 0 != fmu_ ) && ( 0 == fmu_->forkedFMU ) && fmu_->description->canSerializeFMUstate( fmippFalse );
+}
+
+fmippStatus FMUModelExchange::getSnapshot( FMUSnapshot& snapshot )
+{
+	// NB: If instance_ != 0 then also fmu_ != 0.
+	if ( ( 0 == instance_ ) || ( false == canGetAndSetFMUstate() ) ) {
+		logger( fmi2Error, "ERROR", "the FMU cannot get and set its state" );
+		lastStatus_ = fmi2Error;
+		return (fmippStatus) lastStatus_;
+	}
+
+	fmi2FMUstate state = snapshot.reusableState( this );
+	lastStatus_ = fmu_->functions->getFMUstate( instance_, &state );
+	snapshot.take( state, this, stateDeleter_ );
+
+	snapshot.time_ = time_;
+	snapshot.nextEventTime_ = tnextevent_;
+	snapshot.nextEventTimeDefined_ = ( fmi2True == eventinfo_->nextEventTimeDefined );
+	snapshot.upcomingEvent_ = upcomingEvent_;
+
+	return (fmippStatus) lastStatus_;
+}
+
+fmippStatus FMUModelExchange::setSnapshot( const FMUSnapshot& snapshot )
+{
+	if ( ( 0 == instance_ ) || ( 0 == snapshot.reusableState( this ) ) ) {
+		logger( fmi2Error, "ERROR", "invalid snapshot" );
+		lastStatus_ = fmi2Error;
+		return (fmippStatus) lastStatus_;
+	}
+
+	lastStatus_ = fmu_->functions->setFMUstate( instance_, snapshot.state_ );
+
+	if ( ( fmi2OK != lastStatus_ ) && ( fmi2Warning != lastStatus_ ) ) return (fmippStatus) lastStatus_;
+
+	// Restore the internal state of the wrapper.
+	time_ = snapshot.time_;
+	tnextevent_ = snapshot.nextEventTime_;
+	eventinfo_->nextEventTimeDefined = snapshot.nextEventTimeDefined_ ? fmi2True : fmi2False;
+	if ( snapshot.nextEventTimeDefined_ ) eventinfo_->nextEventTime = tnextevent_;
+
+	resetEventFlags();
+	upcomingEvent_ = snapshot.upcomingEvent_;
+	modelChanged();
+
+	return (fmippStatus) lastStatus_;
+}
+
+fmippStatus FMUModelExchange::getSnapshotSize( const FMUSnapshot& snapshot, fmippSize& size )
+{
+	if ( ( 0 == instance_ ) || ( false == canSerializeFMUstate() ) || ( 0 == snapshot.reusableState( this ) ) ) {
+		lastStatus_ = fmi2Error;
+		return (fmippStatus) lastStatus_;
+	}
+
+	size_t stateSize = 0;
+	lastStatus_ = fmu_->functions->serializedFMUstateSize( instance_, snapshot.state_, &stateSize );
+	size = FMUSnapshot::headerSize + stateSize;
+
+	return (fmippStatus) lastStatus_;
+}
+
+fmippStatus FMUModelExchange::serializeSnapshot( const FMUSnapshot& snapshot, vector<fmippChar>& buffer )
+{
+	if ( ( 0 == instance_ ) || ( false == canSerializeFMUstate() ) || ( 0 == snapshot.reusableState( this ) ) ) {
+		logger( fmi2Error, "ERROR", "the snapshot cannot be serialized" );
+		lastStatus_ = fmi2Error;
+		return (fmippStatus) lastStatus_;
+	}
+
+	size_t size = 0;
+	lastStatus_ = fmu_->functions->serializedFMUstateSize( instance_, snapshot.state_, &size );
+
+	if ( fmi2OK != lastStatus_ ) return (fmippStatus) lastStatus_;
+
+	buffer.resize( FMUSnapshot::headerSize + size );
+	snapshot.writeHeader( buffer.data() );
+	lastStatus_ = fmu_->functions->serializeFMUstate( instance_, snapshot.state_,
+		buffer.data() + FMUSnapshot::headerSize, size );
+
+	return (fmippStatus) lastStatus_;
+}
+
+fmippStatus FMUModelExchange::deserializeSnapshot( const vector<fmippChar>& buffer, FMUSnapshot& snapshot )
+{
+	if ( ( 0 == instance_ ) || ( false == canSerializeFMUstate() ) || ( buffer.size() < FMUSnapshot::headerSize ) ) {
+		logger( fmi2Error, "ERROR", "the snapshot cannot be deserialized" );
+		lastStatus_ = fmi2Error;
+		return (fmippStatus) lastStatus_;
+	}
+
+	fmi2FMUstate state = snapshot.reusableState( this );
+	lastStatus_ = fmu_->functions->deSerializeFMUstate( instance_, buffer.data() + FMUSnapshot::headerSize,
+		buffer.size() - FMUSnapshot::headerSize, &state );
+	snapshot.take( state, this, stateDeleter_ );
+	snapshot.readHeader( buffer.data() );
+
+	return (fmippStatus) lastStatus_;
+}
+
 fmippTime FMUModelExchange::getTime() const
 {
 	return time_;
@@ -495,14 +788,25 @@ fmippStatus FMUModelExchange::setTime( fmippTime time )
 {
 	time_ = time;
 	// NB: If instance_ != 0 then also fmu_ != 0.
-	if ( 0 != instance_ ) return (fmippStatus) fmu_->functions->setTime( instance_, time_ );
+	if ( 0 == instance_ ) return fmippFatal;
+
+	// skip the call if the FMU is at this time already
+	if ( evaluationCache_->hasTime( time_ ) ) return fmippOK;
+
+	fmi2Status status = fmu_->functions->setTime( instance_, time_ );
+	if ( fmi2OK == status ) {
+		evaluationCache_->storeTime( time_ );
+	} else {
+		evaluationCache_->invalidate();
+	}
 
-	return fmippFatal;
+	return (fmippStatus) status;
 }
 
 void FMUModelExchange::rewindTime( fmippTime deltaRewindTime )
 {
 	time_ -= deltaRewindTime;
+	evaluationCache_->invalidate();
 	fmu_->functions->setTime( instance_, time_ );
 	/**
 	 * \todo test. Maybe it is necessary to do evnthandling afterwards
@@ -516,12 +820,14 @@ void FMUModelExchange::rewindTime( fmippTime deltaRewindTime )
 
 fmippStatus FMUModelExchange::setValue( fmippValueReference valref, const fmippReal& val )
 {
+	modelChanged();
 	lastStatus_ = fmu_->functions->setReal( instance_, &valref, 1, &val );
 	return (fmippStatus) lastStatus_;
 }
 
 fmippStatus FMUModelExchange::setValue( fmippValueReference valref, const fmippInteger& val )
 {
+	modelChanged();
 	lastStatus_ = fmu_->functions->setInteger( instance_, &valref, 1, &val );
 	return (fmippStatus) lastStatus_;
 }
@@ -529,6 +835,7 @@ fmippStatus FMUModelExchange::setValue( fmippValueReference valref, const fmippI
 fmippStatus FMUModelExchange::setValue( fmippValueReference valref, const fmippBoolean& val )
 {
 	fmi2Boolean val2 = (fmi2Boolean) val;
+	modelChanged();
 	lastStatus_ = fmu_->functions->setBoolean( instance_, &valref, 1, &val2 );
 	return (fmippStatus) lastStatus_;
 }
@@ -536,27 +843,30 @@ fmippStatus FMUModelExchange::setValue( fmippValueReference valref, const fmippB
 fmippStatus FMUModelExchange::setValue( fmippValueReference valref, const fmippString& val )
 {
 	fmi2String cString = val.c_str();
+	modelChanged();
 	lastStatus_ = fmu_->functions->setString( instance_, &valref, 1, &cString );
 	return (fmippStatus) lastStatus_;
 }
 
 fmippStatus FMUModelExchange::setValue(fmippValueReference* valref, const fmippReal* val, fmippSize ival)
 {
+	modelChanged();
 	lastStatus_ = fmu_->functions->setReal(instance_, valref, ival, val);
 	return (fmippStatus) lastStatus_;
 }
 
 fmippStatus FMUModelExchange::setValue(fmippValueReference* valref, const fmippInteger* val, fmippSize ival)
 {
+	modelChanged();
 	lastStatus_ = fmu_->functions->setInteger(instance_, valref, ival, val);
 	return (fmippStatus) lastStatus_;
 }
 
 fmippStatus FMUModelExchange::setValue(fmippValueReference* valref, const fmippBoolean* val, fmippSize ival)
 {
-	fmi2Boolean val2 = (fmi2Boolean) *val;
-	lastStatus_ = fmu_->functions->setBoolean(instance_, valref, ival, &val2 );
-	// no need for backcasting since setter function is write-only
+	std::vector<fmi2Boolean> val2( val, val + ival );
+	modelChanged();
+	lastStatus_ = fmu_->functions->setBoolean( instance_, valref, ival, val2.data() );
 	return (fmippStatus) lastStatus_;
 }
 
@@ -567,6 +877,7 @@ fmippStatus FMUModelExchange::setValue(fmippValueReference* valref, const fmippS
 	for ( fmippSize i = 0; i < ival; i++ ) {
 		cStrings[i] = val[i].c_str();
 	}
+	modelChanged();
 	lastStatus_ = fmu_->functions->setString(instance_, valref, ival, cStrings);
 	delete [] cStrings;
 	return (fmippStatus) lastStatus_;
@@ -574,10 +885,11 @@ fmippStatus FMUModelExchange::setValue(fmippValueReference* valref, const fmippS
 
 fmippStatus FMUModelExchange::setValue( const fmippString& name, const fmippReal& val )
 {
-	map<fmippString,fmippValueReference>::const_iterator it = varMap_.find( name );
+	const fmippValueReference valref = getValueRef( name );
 
-	if ( it != varMap_.end() ) {
-		lastStatus_ = fmu_->functions->setReal( instance_, &it->second, 1, &val );
+	if ( fmippUndefinedValueReference != valref ) {
+		modelChanged();
+		lastStatus_ = fmu_->functions->setReal( instance_, &valref, 1, &val );
 		return (fmippStatus) lastStatus_;
 
 	} else {
@@ -590,10 +902,11 @@ fmippStatus FMUModelExchange::setValue( const fmippString& name, const fmippReal
 
 fmippStatus FMUModelExchange::setValue( const fmippString& name, const fmippInteger& val )
 {
-	map<fmippString,fmippValueReference>::const_iterator it = varMap_.find( name );
+	const fmippValueReference valref = getValueRef( name );
 
-	if ( it != varMap_.end() ) {
-		lastStatus_ = fmu_->functions->setInteger( instance_, &it->second, 1, &val );
+	if ( fmippUndefinedValueReference != valref ) {
+		modelChanged();
+		lastStatus_ = fmu_->functions->setInteger( instance_, &valref, 1, &val );
 		return (fmippStatus) lastStatus_;
 	} else {
 		fmippString ret = name + fmippString( " does not exist" );
@@ -605,11 +918,12 @@ fmippStatus FMUModelExchange::setValue( const fmippString& name, const fmippInte
 
 fmippStatus FMUModelExchange::setValue( const fmippString& name, const fmippBoolean& val )
 {
-	map<fmippString,fmippValueReference>::const_iterator it = varMap_.find( name );
+	const fmippValueReference valref = getValueRef( name );
 
-	if ( it != varMap_.end() ) {
+	if ( fmippUndefinedValueReference != valref ) {
 		fmi2Boolean val2 = (fmi2Boolean) val;
-		lastStatus_ = fmu_->functions->setBoolean( instance_, &it->second, 1, &val2 );
+		modelChanged();
+		lastStatus_ = fmu_->functions->setBoolean( instance_, &valref, 1, &val2 );
 		// no need for backcasting since setter function is write-only
 		return (fmippStatus) lastStatus_;
 	} else {
@@ -622,11 +936,12 @@ fmippStatus FMUModelExchange::setValue( const fmippString& name, const fmippBool
 
 fmippStatus FMUModelExchange::setValue( const fmippString& name, const fmippString& val )
 {
-	map<fmippString,fmippValueReference>::const_iterator it = varMap_.find( name );
+	const fmippValueReference valref = getValueRef( name );
 	const char* cString = val.c_str();
 
-	if ( it != varMap_.end() ) {
-		lastStatus_ = fmu_->functions->setString( instance_, &it->second, 1, &cString );
+	if ( fmippUndefinedValueReference != valref ) {
+		modelChanged();
+		lastStatus_ = fmu_->functions->setString( instance_, &valref, 1, &cString );
 		return (fmippStatus) lastStatus_;
 	} else {
 		fmippString ret = name + fmippString( " does not exist" );
@@ -678,33 +993,30 @@ fmippStatus FMUModelExchange::getValue( fmippValueReference* valref, fmippIntege
 
 fmippStatus FMUModelExchange::getValue( fmippValueReference* valref, fmippBoolean* val, fmippSize ival )
 {
-	fmi2Boolean val2 = (fmi2Boolean) *val;
-	lastStatus_ = fmu_->functions->getBoolean( instance_, valref, ival, &val2 );
-	*val = (fmippBoolean)val2;
+	std::vector<fmi2Boolean> val2( ival );
+	lastStatus_ = fmu_->functions->getBoolean( instance_, valref, ival, val2.data() );
+	for ( fmippSize i = 0; i < ival; ++i ) {
+		val[i] = ( fmi2False != val2[i] );
+	}
 	return (fmippStatus) lastStatus_;
 }
 
 fmippStatus FMUModelExchange::getValue( fmippValueReference* valref, fmippString* val, fmippSize ival )
 {
-	const char** cStrings = 0;
-
-	lastStatus_ = fmu_->functions->getString( instance_, valref, ival, cStrings );
-
-	if ( 0 != cStrings ) {
-		for ( fmippSize i = 0; i < ival; i++ ) {
-			val[i] = fmippString( cStrings[i] );
-		}
+	std::vector<fmi2String> cStrings( ival, static_cast<fmi2String>( 0 ) );
+	lastStatus_ = fmu_->functions->getString( instance_, valref, ival, cStrings.data() );
+	for ( fmippSize i = 0; i < ival; ++i ) {
+		if ( 0 != cStrings[i] ) val[i] = fmippString( cStrings[i] );
 	}
-
 	return (fmippStatus) lastStatus_;
 }
 
 fmippStatus FMUModelExchange::getValue( const fmippString& name, fmippReal& val )
 {
-	map<fmippString,fmippValueReference>::const_iterator it = varMap_.find( name );
+	const fmippValueReference valref = getValueRef( name );
 
-	if ( it != varMap_.end() ) {
-		lastStatus_ = fmu_->functions->getReal( instance_, &it->second, 1, &val );
+	if ( fmippUndefinedValueReference != valref ) {
+		lastStatus_ = fmu_->functions->getReal( instance_, &valref, 1, &val );
 	} else {
 		fmippString ret = name + fmippString( " does not exist" );
 		logger( fmi2Discard, "WARNING", ret );
@@ -715,10 +1027,10 @@ fmippStatus FMUModelExchange::getValue( const fmippString& name, fmippReal& val
 
 fmippStatus FMUModelExchange::getValue( const fmippString& name, fmippInteger& val )
 {
-	map<fmippString,fmippValueReference>::const_iterator it = varMap_.find( name );
+	const fmippValueReference valref = getValueRef( name );
 
-	if ( it != varMap_.end() ) {
-		lastStatus_ = fmu_->functions->getInteger( instance_, &it->second, 1, &val );
+	if ( fmippUndefinedValueReference != valref ) {
+		lastStatus_ = fmu_->functions->getInteger( instance_, &valref, 1, &val );
 	} else {
 		fmippString ret = name + fmippString( " does not exist" );
 		logger( fmi2Discard, "WARNING", ret );
@@ -729,10 +1041,10 @@ fmippStatus FMUModelExchange::getValue( const fmippString& name, fmippInteger& v
 
 fmippStatus FMUModelExchange::getValue( const fmippString& name, fmippBoolean& val )
 {
-	map<fmippString,fmippValueReference>::const_iterator it = varMap_.find( name );
-	if ( it != varMap_.end() ) {
+	const fmippValueReference valref = getValueRef( name );
+	if ( fmippUndefinedValueReference != valref ) {
 		fmi2Boolean val2 = (fmi2Boolean) val;
-		lastStatus_ = fmu_->functions->getBoolean( instance_, &it->second, 1, &val2 );
+		lastStatus_ = fmu_->functions->getBoolean( instance_, &valref, 1, &val2 );
 		val = (fmippBoolean) val2;
 	} else {
 		fmippString ret = name + fmippString( " does not exist" );
@@ -744,11 +1056,11 @@ fmippStatus FMUModelExchange::getValue( const fmippString& name, fmippBoolean& v
 
 fmippStatus FMUModelExchange::getValue( const fmippString& name, fmippString& val )
 {
-	map<fmippString,fmippValueReference>::const_iterator it = varMap_.find( name );
+	const fmippValueReference valref = getValueRef( name );
 	const char* cString;
 
-	if ( it != varMap_.end() ) {
-		lastStatus_ = fmu_->functions->getString( instance_, &it->second, 1, &cString );
+	if ( fmippUndefinedValueReference != valref ) {
+		lastStatus_ = fmu_->functions->getString( instance_, &valref, 1, &cString );
 		val = fmippString( cString );
 	} else {
 		fmippString ret = name + fmippString( " does not exist" );
@@ -760,11 +1072,11 @@ fmippStatus FMUModelExchange::getValue( const fmippString& name, fmippString& va
 
 fmippReal FMUModelExchange::getRealValue( const fmippString& name )
 {
-	map<fmippString,fmippValueReference>::const_iterator it = varMap_.find( name );
+	const fmippValueReference valref = getValueRef( name );
 	fmi2Real val[1];
 
-	if ( it != varMap_.end() ) {
-		lastStatus_ = fmu_->functions->getReal( instance_, &it->second, 1, val );
+	if ( fmippUndefinedValueReference != valref ) {
+		lastStatus_ = fmu_->functions->getReal( instance_, &valref, 1, val );
 	} else {
 		val[0] = numeric_limits<fmi2Real>::quiet_NaN();
 		fmippString ret = name + fmippString( " does not exist" );
@@ -777,11 +1089,11 @@ fmippReal FMUModelExchange::getRealValue( const fmippString& name )
 
 fmippInteger FMUModelExchange::getIntegerValue( const fmippString& name )
 {
-	map<fmippString,fmippValueReference>::const_iterator it = varMap_.find( name );
+	const fmippValueReference valref = getValueRef( name );
 	fmippInteger val[1];
 
-	if ( it != varMap_.end() ) {
-		lastStatus_ = fmu_->functions->getInteger( instance_, &it->second, 1, val );
+	if ( fmippUndefinedValueReference != valref ) {
+		lastStatus_ = fmu_->functions->getInteger( instance_, &valref, 1, val );
 	} else {
 		val[0] = numeric_limits<fmippInteger>::quiet_NaN();
 		fmippString ret = name + fmippString( " does not exist" );
@@ -794,11 +1106,11 @@ fmippInteger FMUModelExchange::getIntegerValue( const fmippString& name )
 
 fmippBoolean FMUModelExchange::getBooleanValue( const fmippString& name )
 {
-	map<fmippString,fmippValueReference>::const_iterator it = varMap_.find( name );
+	const fmippValueReference valref = getValueRef( name );
 	fmi2Boolean val[1];
 
-	if ( it != varMap_.end() ) {
-		lastStatus_ = fmu_->functions->getBoolean( instance_, &it->second, 1, val );
+	if ( fmippUndefinedValueReference != valref ) {
+		lastStatus_ = fmu_->functions->getBoolean( instance_, &valref, 1, val );
 	} else {
 		val[0] = fmippFalse;
 		fmippString ret = name + fmippString( " does not exist" );
@@ -811,11 +1123,11 @@ fmippBoolean FMUModelExchange::getBooleanValue( const fmippString& name )
 
 fmippString FMUModelExchange::getStringValue( const fmippString& name )
 {
-	map<fmippString,fmippValueReference>::const_iterator it = varMap_.find( name );
+	const fmippValueReference valref = getValueRef( name );
 	fmi2String val[1];
 
-	if ( it != varMap_.end() ) {
-		lastStatus_ = fmu_->functions->getString( instance_, &it->second, 1, val );
+	if ( fmippUndefinedValueReference != valref ) {
+		lastStatus_ = fmu_->functions->getString( instance_, &valref, 1, val );
 	} else {
 		val[0] = 0;
 		fmippString ret = name + fmippString( " does not exist" );
@@ -838,18 +1150,38 @@ fmippStatus FMUModelExchange::getLastStatus() const
 fmippStatus FMUModelExchange::getContinuousStates( fmippReal* val )
 {
 	lastStatus_ = fmu_->functions->getContinuousStates( instance_, val, nStateVars_ );
+	if ( fmi2OK == lastStatus_ ) evaluationCache_->storeStates( val, nStateVars_ );
 	return (fmippStatus) lastStatus_;
 }
 
 fmippStatus FMUModelExchange::setContinuousStates( const fmippReal* val )
 {
+	// skip the call if these states are set already
+	if ( evaluationCache_->hasStates( val, nStateVars_ ) ) {
+		lastStatus_ = fmi2OK;
+		return (fmippStatus) lastStatus_;
+	}
+
 	lastStatus_ = fmu_->functions->setContinuousStates( instance_, val, nStateVars_ );
+	if ( fmi2OK == lastStatus_ ) {
+		evaluationCache_->storeStates( val, nStateVars_ );
+	} else {
+		evaluationCache_->invalidate();
+	}
+
 	return (fmippStatus) lastStatus_;
 }
 
 fmippStatus FMUModelExchange::getDerivatives( fmippReal* val )
 {
+	// reuse the derivatives if neither time nor states changed since the last evaluation
+	if ( evaluationCache_->getDerivatives( val, nStateVars_ ) ) {
+		lastStatus_ = fmi2OK;
+		return (fmippStatus) lastStatus_;
+	}
+
 	lastStatus_ = fmu_->functions->getDerivatives( instance_, val, nStateVars_ );
+	if ( fmi2OK == lastStatus_ ) evaluationCache_->storeDerivatives( val, nStateVars_ );
 	return (fmippStatus) lastStatus_;
 }
 
@@ -866,12 +1198,7 @@ vector<fmippString> FMUModelExchange::getDerivativesNames() const
 	for ( unsigned int i = 0; i < nStateVars_; ++i ) {
 		fmippValueReference der_ref = derivatives_refs_[i];
 
-		for_each(
-			varMap_.begin(), varMap_.end(),
-			[ &der_ref, &derivatives_names ] ( const pair<fmippString, fmippValueReference> &p ) {
-				if ( p.second == der_ref ) derivatives_names.push_back( p.first );
-			}
-		);
+		appendVariableNames( fmu_->description->getVariableTable(), der_ref, derivatives_names );
 	}
 
 	return derivatives_names;
@@ -889,6 +1216,15 @@ fmippStatus FMUModelExchange::getJac( fmippReal* J ){
 		return DynamicalSystem::getJac( J );
 	}
 
+	// use the sparsity pattern to evaluate several columns per call, if available
+	if ( providesJacobianSparsity() ){
+		SparseJacobian sparseJ( jacobianSparsity_ );
+		if ( fmippOK == getSparseJac( sparseJ ) ){
+			sparseJ.getDenseColumnMajor( J );
+			return fmippOK;
+		}
+	}
+
 	// else use getDirectionalDerivative to read the Jacobian
 	for ( unsigned int i = 0; i < nStateVars_; i++ ){
 		// get the i-th column of the jacobian
@@ -926,19 +1262,215 @@ fmippStatus FMUModelExchange::getJac( fmippReal* J ){
 	return (fmippStatus) lastStatus_;
 }
 
-fmippValueReference FMUModelExchange::getValueRef( const fmippString& name ) const {
-	map<fmippString,fmippValueReference>::const_iterator it = varMap_.find(name);
+fmippStatus FMUModelExchange::getSparseJac( SparseJacobian& J ){
+	if ( !providesJacobian_ || !providesJacobianSparsity() ){
+		return DynamicalSystem::getSparseJac( J );
+	}
 
-	if ( it != varMap_.end() ) {
-		return it->second;
-	} else {
-		return fmippUndefinedValueReference;
+	if ( J.isEmpty() ) J = jacobianSparsity_;
+
+	vector<fmippValueReference> seedRefs;
+	vector<fmippReal> seed;
+	vector<fmippReal> column( nStateVars_ );
+
+	for ( fmippSize c = 0; c < J.getNumberOfColors(); c++ ){
+		// seed all states of the c-th color at once, their columns have disjoint row patterns
+		const vector<fmippSize>& columns = J.getColumnsOfColor( c );
+		seedRefs.clear();
+		for ( fmippSize j = 0; j < columns.size(); j++ )
+			seedRefs.push_back( states_refs_[ columns[j] ] );
+		seed.assign( seedRefs.size(), 1.0 );
+
+		lastStatus_ = fmu_->functions->getDirectionalDerivative( instance_,
+									 derivatives_refs_, nStateVars_,
+									 &seedRefs[0], seedRefs.size(),
+									 &seed[0], &column[0] );
+
+		// stop calling the getDD function once it returns an exception
+		if ( lastStatus_ != fmi2OK )
+			break;
+
+		J.setCompressedColumn( c, &column[0] );
 	}
+
+	return (fmippStatus) lastStatus_;
+}
+
+fmippStatus FMUModelExchange::enableSensitivities( const vector<fmippString>& parameters )
+{
+	if ( ( 0 == instance_ ) || ( 0 == nStateVars_ ) ) return fmippError;
+
+	vector<fmippValueReference> refs;
+	for ( vector<fmippString>::const_iterator it = parameters.begin(); it != parameters.end(); ++it ) {
+		if ( fmippTypeReal != getType( *it ) ) {
+			logger( fmi2Error, "ERROR", string( "no real variable for sensitivities: " ) + *it );
+			return fmippError;
+		}
+		refs.push_back( getValueRef( *it ) );
+	}
+
+	disableSensitivities();
+	sensitivityRefs_ = refs;
+	sensitivityDirectionalDerivatives_ = providesJacobian_;
+
+	// integrate the augmented system with the same properties as the states
+	Integrator::Properties properties = integrator_->getProperties();
+	sensitivities_ = new SensitivitySystem( this, sensitivityRefs_.size() );
+	Integrator* integrator = sensitivities_->integrator();
+	integrator->initialize();
+	integrator->setProperties( properties );
+
+	stateIntegrator_ = integrator_;
+	integrator_ = integrator;
+	evaluationCache_->setStatistics( integrator_->statistics() );
+
+	return fmippOK;
+}
+
+void FMUModelExchange::disableSensitivities()
+{
+	if ( 0 == sensitivities_ ) return;
+
+	Integrator::Properties properties = integrator_->getProperties();
+	integrator_ = stateIntegrator_;
+	integrator_->setProperties( properties );
+	evaluationCache_->setStatistics( integrator_->statistics() );
+
+	delete sensitivities_;
+	sensitivities_ = 0;
+	stateIntegrator_ = 0;
+	sensitivityRefs_.clear();
+}
+
+fmippStatus FMUModelExchange::getStateSensitivities( vector<fmippReal>& dxdp ) const
+{
+	if ( 0 == sensitivities_ ) return fmippError;
+
+	dxdp = sensitivities_->sensitivities();
+	return fmippOK;
+}
+
+fmippStatus FMUModelExchange::setStateSensitivities( const vector<fmippReal>& dxdp )
+{
+	if ( ( 0 == sensitivities_ ) || ( dxdp.size() != sensitivities_->sensitivities().size() ) )
+		return fmippError;
+
+	sensitivities_->sensitivities() = dxdp;
+	return fmippOK;
+}
+
+fmippStatus FMUModelExchange::getOutputSensitivities( const vector<fmippString>& outputs,
+	vector<fmippReal>& dydp )
+{
+	if ( 0 == sensitivities_ ) return fmippError;
+
+	vector<fmippValueReference> refs;
+	for ( vector<fmippString>::const_iterator it = outputs.begin(); it != outputs.end(); ++it ) {
+		if ( fmippTypeReal != getType( *it ) ) return fmippError;
+		refs.push_back( getValueRef( *it ) );
+	}
+
+	dydp.assign( refs.size()*sensitivityRefs_.size(), 0.0 );
+	if ( refs.empty() ) return fmippOK;
+
+	return getSensitivities( &refs[0], refs.size(), &sensitivities_->sensitivities()[0], &dydp[0] );
+}
+
+fmippStatus FMUModelExchange::getSensitivities( const fmippValueReference* unknownRefs,
+	fmippSize nUnknowns, const fmippReal* S, fmippReal* result )
+{
+	if ( !sensitivityDirectionalDerivatives_ )
+		return getSensitivitiesByFiniteDifferences( unknownRefs, nUnknowns, S, result );
+
+	// seed the states with the sensitivities S_k and the parameter p_k with one
+	vector<fmippValueReference> knownRefs( states_refs_, states_refs_ + nStateVars_ );
+	knownRefs.push_back( fmippUndefinedValueReference );
+	vector<fmippReal> seed( nStateVars_ + 1, 1.0 );
+	for ( fmippSize k = 0; k < sensitivityRefs_.size(); k++ ) {
+		knownRefs[nStateVars_] = sensitivityRefs_[k];
+		copy( S + k*nStateVars_, S + ( k + 1 )*nStateVars_, seed.begin() );
+
+		lastStatus_ = fmu_->functions->getDirectionalDerivative( instance_,
+									 unknownRefs, nUnknowns,
+									 &knownRefs[0], knownRefs.size(),
+									 &seed[0], result + k*nUnknowns );
+
+		// many FMUs provide directional derivatives only with respect to states and inputs
+		if ( fmi2OK != lastStatus_ ) {
+			logger( fmi2Warning, "WARNING", "no directional derivatives with respect to the "
+				"parameters, sensitivities are computed by finite differences" );
+			sensitivityDirectionalDerivatives_ = fmippFalse;
+			return getSensitivitiesByFiniteDifferences( unknownRefs, nUnknowns, S, result );
+		}
+	}
+
+	return fmippOK;
+}
+
+fmippStatus FMUModelExchange::getSensitivitiesByFiniteDifferences(
+	const fmippValueReference* unknownRefs, fmippSize nUnknowns, const fmippReal* S, fmippReal* result )
+{
+	vector<fmippReal> x( nStateVars_ ), xPerturbed( nStateVars_ );
+	vector<fmippReal> vPlus( nUnknowns ), vMinus( nUnknowns );
+
+	lastStatus_ = fmu_->functions->getContinuousStates( instance_, &x[0], nStateVars_ );
+	if ( fmi2OK != lastStatus_ ) return (fmippStatus) lastStatus_;
+
+	fmi2Status status = fmi2OK;
+	for ( fmippSize k = 0; ( k < sensitivityRefs_.size() ) && ( fmi2OK == status ); k++ ) {
+		const fmippValueReference& parameterRef = sensitivityRefs_[k];
+		fmippReal p;
+		status = fmu_->functions->getReal( instance_, &parameterRef, 1, &p );
+
+		// perturb along ( S_k, e_k ) in both directions, like getNumericalJacobian
+		const fmippReal delta = 1.0e-5 * std::max( 1.0, std::abs( p ) );
+		for ( int sign = 1; ( sign >= -1 ) && ( fmi2OK == status ); sign -= 2 ) {
+			for ( fmippSize i = 0; i < nStateVars_; i++ )
+				xPerturbed[i] = x[i] + sign*delta*S[k*nStateVars_ + i];
+			fmippReal pPerturbed = p + sign*delta;
+
+			status = fmu_->functions->setContinuousStates( instance_, &xPerturbed[0], nStateVars_ );
+			if ( fmi2OK == status )
+				status = fmu_->functions->setReal( instance_, &parameterRef, 1, &pPerturbed );
+			if ( fmi2OK == status )
+				status = fmu_->functions->getReal( instance_, unknownRefs, nUnknowns,
+								   ( 1 == sign ) ? &vPlus[0] : &vMinus[0] );
+		}
+
+		// restore the parameter
+		if ( fmi2OK == status )
+			status = fmu_->functions->setReal( instance_, &parameterRef, 1, &p );
+
+		for ( fmippSize j = 0; j < nUnknowns; j++ )
+			result[k*nUnknowns + j] = ( vPlus[j] - vMinus[j] )/( 2.0*delta );
+	}
+
+	// restore the states
+	lastStatus_ = fmu_->functions->setContinuousStates( instance_, &x[0], nStateVars_ );
+	if ( fmi2OK != status ) lastStatus_ = status;
+
+	// the FMU is back at the cached point only if everything succeeded
+	if ( fmi2OK != lastStatus_ ) evaluationCache_->invalidate();
+
+	return (fmippStatus) lastStatus_;
+}
+
+fmippValueReference FMUModelExchange::getValueRef( const fmippString& name ) const {
+	const ModelVariableTable& variables = fmu_->description->getVariableTable();
+	const fmippSize i = variables.find( name );
+	return ( ModelVariableTable::npos != i ) ? variables.getValueReference( i ) : fmippUndefinedValueReference;
 }
 
 fmippStatus FMUModelExchange::getEventIndicators( fmippReal* eventsind )
 {
+	// reuse the event indicators if neither time nor states changed since the last evaluation
+	if ( evaluationCache_->getEventIndicators( eventsind, nEventInds() ) ) {
+		lastStatus_ = fmi2OK;
+		return (fmippStatus) lastStatus_;
+	}
+
 	lastStatus_ = fmu_->functions->getEventIndicators(instance_, eventsind, nEventInds());
+	if ( fmi2OK == lastStatus_ ) evaluationCache_->storeEventIndicators( eventsind, nEventInds() );
 	return (fmippStatus) lastStatus_;
 }
 
@@ -951,6 +1483,9 @@ fmippTime FMUModelExchange::integrate( fmippTime tstop, unsigned int nsteps )
 
 fmippTime FMUModelExchange::integrate( fmippTime tend, fmippTime deltaT )
 {
+	// skip redundant calls to the FMU while integrating
+	ModelEvaluationCache::Activation activation( *evaluationCache_ );
+
 	// if there are no continuous states, skip integration
 	if ( nStateVars_ == 0 ){
 		if ( stopBeforeEvent_ ){
@@ -998,6 +1533,7 @@ fmippTime FMUModelExchange::integrate( fmippTime tend, fmippTime deltaT )
 
 	// save the current event indicators for the integrator
 	saveEventIndicators();
+	if ( 0 != sensitivities_ ) sensitivities_->saveEventIndicators();
 
 	// integrate the fmu. Receive informations about state and time events
 	Integrator::EventInfo eventInfo = integrator_->integrate( ( tend - time_ ), deltaT, eventSearchPrecision_ );
@@ -1122,6 +1658,9 @@ void FMUModelExchange::handleEvents()
 
 	// go back to the "default mode": continuousTimeMode
 	lastStatus_ = enterContinuousTimeMode();
+
+	// the RHS might be discontinuous, restart the integrator
+	modelChanged();
 }
 
 fmippStatus FMUModelExchange::completedIntegratorStep()
@@ -1184,12 +1723,7 @@ vector<fmippString> FMUModelExchange::getStatesNames() const
 	for ( unsigned int i = 0; i < nStateVars_; ++i ) {
 		fmippValueReference state_ref = states_refs_[i];
 
-		for_each(
-			varMap_.begin(), varMap_.end(),
-			[ &state_ref, &states_names ] ( const pair<fmippString, fmippValueReference> &p ) {
-				if ( p.second == state_ref ) states_names.push_back( p.first );
-			}
-		);
+		appendVariableNames( fmu_->description->getVariableTable(), state_ref, states_names );
 	}
 
 	return states_names;
@@ -1235,6 +1769,8 @@ fmi2Status FMUModelExchange::enterContinuousTimeMode()
 
 fmi2Status FMUModelExchange::enterEventMode()
 {
+	// the FMU may change its states and outputs during event mode
+	evaluationCache_->invalidate();
 	return fmu_->functions->enterEventMode( instance_ );
 }
 
@@ -0,0 +1,129 @@
+// -------------------------------------------------------------------
+// Copyright (c) 2013-2022, AIT Austrian Institute of Technology GmbH.
+// All rights reserved. See file FMIPP_LICENSE for details.
+// -------------------------------------------------------------------
+
+/**
+ * \file FMUSnapshot.cpp
+ */
+
+#include <cstring>
+#include <limits>
+
+#include "import/base/include/FMUSnapshot.h"
+
+using namespace std;
+
+
+const fmippSize FMUSnapshot::headerSize = 2 * sizeof( fmippTime ) + 1;
+
+
+FMUSnapshot::FMUSnapshot() :
+	state_( 0 ),
+	owner_( 0 ),
+	time_( numeric_limits<fmippTime>::quiet_NaN() ),
+	nextEventTime_( numeric_limits<fmippTime>::quiet_NaN() ),
+	nextEventTimeDefined_( fmippFalse ),
+	upcomingEvent_( fmippFalse )
+{}
+
+
+FMUSnapshot::FMUSnapshot( void* state, const void* owner, const shared_ptr<Deleter>& deleter ) :
+	state_( state ),
+	owner_( owner ),
+	deleter_( deleter ),
+	time_( numeric_limits<fmippTime>::quiet_NaN() ),
+	nextEventTime_( numeric_limits<fmippTime>::quiet_NaN() ),
+	nextEventTimeDefined_( fmippFalse ),
+	upcomingEvent_( fmippFalse )
+{}
+
+
+FMUSnapshot::FMUSnapshot( FMUSnapshot&& snapshot ) :
+	state_( snapshot.state_ ),
+	owner_( snapshot.owner_ ),
+	deleter_( move( snapshot.deleter_ ) ),
+	time_( snapshot.time_ ),
+	nextEventTime_( snapshot.nextEventTime_ ),
+	nextEventTimeDefined_( snapshot.nextEventTimeDefined_ ),
+	upcomingEvent_( snapshot.upcomingEvent_ )
+{
+	snapshot.state_ = 0;
+	snapshot.owner_ = 0;
+}
+
+
+FMUSnapshot& FMUSnapshot::operator=( FMUSnapshot&& snapshot )
+{
+	if ( this != &snapshot ) {
+		reset();
+		state_ = snapshot.state_;
+		owner_ = snapshot.owner_;
+		deleter_ = move( snapshot.deleter_ );
+		time_ = snapshot.time_;
+		nextEventTime_ = snapshot.nextEventTime_;
+		nextEventTimeDefined_ = snapshot.nextEventTimeDefined_;
+		upcomingEvent_ = snapshot.upcomingEvent_;
+		snapshot.state_ = 0;
+		snapshot.owner_ = 0;
+	}
+	return *this;
+}
+
+
+FMUSnapshot::~FMUSnapshot()
+{
+	reset();
+}
+
+
+fmippBoolean FMUSnapshot::isValid() const
+{
+	return ( 0 != state_ ) && !deleter_.expired();
+}
+
+
+void FMUSnapshot::reset()
+{
+	// The state has been freed already if the instance does not exist anymore.
+	shared_ptr<Deleter> deleter = deleter_.lock();
+	if ( ( 0 != state_ ) && deleter ) ( *deleter )( state_ );
+
+	state_ = 0;
+	owner_ = 0;
+	deleter_.reset();
+}
+
+
+void* FMUSnapshot::reusableState( const void* owner ) const
+{
+	return ( isValid() && ( owner == owner_ ) ) ? state_ : 0;
+}
+
+
+void FMUSnapshot::take( void* state, const void* owner, const shared_ptr<Deleter>& deleter )
+{
+	// A state of the same instance has either been reused or freed by the FMU.
+	if ( ( owner != owner_ ) || deleter_.expired() ) reset();
+
+	state_ = state;
+	owner_ = ( 0 != state ) ? owner : 0;
+	deleter_ = deleter;
+}
+
+
+void FMUSnapshot::writeHeader( fmippChar* buffer ) const
+{
+	memcpy( buffer, &time_, sizeof( fmippTime ) );
+	memcpy( buffer + sizeof( fmippTime ), &nextEventTime_, sizeof( fmippTime ) );
+	buffer[2 * sizeof( fmippTime )] = ( nextEventTimeDefined_ ? 1 : 0 ) | ( upcomingEvent_ ? 2 : 0 );
+}
+
+
+void FMUSnapshot::readHeader( const fmippChar* buffer )
+{
+	memcpy( &time_, buffer, sizeof( fmippTime ) );
+	memcpy( &nextEventTime_, buffer + sizeof( fmippTime ), sizeof( fmippTime ) );
+	nextEventTimeDefined_ = ( 0 != ( buffer[2 * sizeof( fmippTime )] & 1 ) );
+	upcomingEvent_ = ( 0 != ( buffer[2 * sizeof( fmippTime )] & 2 ) );
+}
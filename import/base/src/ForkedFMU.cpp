@@ -0,0 +1,1649 @@
+// -------------------------------------------------------------------
+// Copyright (c) 2013-2022, AIT Austrian Institute of Technology GmbH.
+// All rights reserved. See file FMIPP_LICENSE for details.
+// -------------------------------------------------------------------
+
+/**
+ * \file ForkedFMU.cpp
+ */
+
+#include "import/base/include/ForkedFMU.h"
+
+#ifdef WIN32
+
+fmippBoolean ForkedFMU::startForkServer()
+{
+	return fmippFalse;
+}
+
+BareFMU2Ptr ForkedFMU::createForkedCopy( const BareFMU2Ptr& bareFMU )
+{
+	return BareFMU2Ptr();
+}
+
+fmi2Component ForkedFMU::instantiate( const BareFMU2Ptr& bareFMU,
+	fmi2String instanceName, fmi2Type fmuType, fmi2String fmuGUID,
+	fmi2String fmuResourceLocation, const fmi2::fmi2CallbackFunctions* functions,
+	fmi2Boolean visible, fmi2Boolean loggingOn )
+{
+	return 0;
+}
+
+#else
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <dirent.h>
+#include <dlfcn.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <sys/prctl.h>
+#endif
+
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <boost/interprocess/shared_memory_object.hpp>
+
+#include "import/base/include/ModelDescription.h"
+#include "export/include/SHMManager.h"
+
+using namespace std;
+using namespace fmi2;
+using boost::interprocess::interprocess_semaphore;
+
+
+namespace {
+
+	/// Size of the buffer for arguments and results of forwarded calls.
+	const size_t bufferSize = 1 << 20;
+
+	/// Size of the buffer for messages logged by the helper processes.
+	const size_t logBufferSize = 1 << 16;
+
+	/// Helper processes are checked at this interval ( in milliseconds ) while waiting for them,
+	/// and helper processes check at this interval if the caller is still running.
+	const long pollInterval = 100;
+
+	/// Commands sent to the helper processes.
+	enum Command
+	{
+		exitCommand,
+		freeInstanceCommand,
+		getFMUstateCommand,
+		setFMUstateCommand,
+		setDebugLoggingCommand,
+		setupExperimentCommand,
+		enterInitializationModeCommand,
+		exitInitializationModeCommand,
+		terminateCommand,
+		resetCommand,
+		getRealCommand,
+		getIntegerCommand,
+		getBooleanCommand,
+		getStringCommand,
+		setRealCommand,
+		setIntegerCommand,
+		setBooleanCommand,
+		setStringCommand,
+		getDirectionalDerivativeCommand,
+		enterEventModeCommand,
+		newDiscreteStatesCommand,
+		enterContinuousTimeModeCommand,
+		completedIntegratorStepCommand,
+		setTimeCommand,
+		setContinuousStatesCommand,
+		getDerivativesCommand,
+		getEventIndicatorsCommand,
+		getContinuousStatesCommand,
+		getNominalsOfContinuousStatesCommand,
+		setRealInputDerivativesCommand,
+		getRealOutputDerivativesCommand,
+		doStepCommand,
+		cancelStepCommand,
+		getStatusCommand,
+		getRealStatusCommand,
+		getIntegerStatusCommand,
+		getBooleanStatusCommand,
+		getStringStatusCommand
+	};
+
+	/// A forwarded call, placed in shared memory.
+	struct ForkedCall
+	{
+		ForkedCall() : done( 0 ), command( exitCommand ), status( fmi2OK ), id( 0 ), pid( 0 ) {}
+
+		interprocess_semaphore done; ///< Posted by the helper process when the call is done.
+		int command; ///< The command ( see enum Command ).
+		int status; ///< The returned status.
+		int id; ///< ID of the helper process created by the call ( for fmi2GetFMUstate ).
+		pid_t pid; ///< Process ID of the helper process created by the call.
+		char data[bufferSize]; ///< Arguments and results.
+	};
+
+	/**
+	 * Messages logged by the FMU in a helper process, placed in shared memory. The messages
+	 * are passed on to the logger of the caller after the current call is done. Each message
+	 * is stored as status ( one byte ), category and formatted message ( null-terminated ).
+	 */
+	struct ForkedLog
+	{
+		ForkedLog() : size( 0 ) {}
+
+		size_t size; ///< Number of bytes used.
+		char data[logBufferSize]; ///< Logged messages.
+	};
+
+	/// Read data from a socket, returns false if the connection is closed.
+	bool receiveAll( int socket, void* data, size_t size )
+	{
+		char* pos = static_cast<char*>( data );
+		while ( size > 0 ) {
+			ssize_t n = recv( socket, pos, size, 0 );
+			if ( ( n < 0 ) && ( EINTR == errno ) ) continue;
+			if ( n <= 0 ) return false;
+			pos += n;
+			size -= n;
+		}
+		return true;
+	}
+
+	/// Write data to a socket, returns false if the connection is closed.
+	bool sendAll( int socket, const void* data, size_t size )
+	{
+#ifdef MSG_NOSIGNAL
+		const int flags = MSG_NOSIGNAL;
+#else
+		const int flags = 0;
+#endif
+		const char* pos = static_cast<const char*>( data );
+		while ( size > 0 ) {
+			ssize_t n = send( socket, pos, size, flags );
+			if ( ( n < 0 ) && ( EINTR == errno ) ) continue;
+			if ( n <= 0 ) return false;
+			pos += n;
+			size -= n;
+		}
+		return true;
+	}
+
+	/// Check that the calling process has not started other threads ( assumed if it cannot be checked ).
+	bool isSingleThreaded()
+	{
+		DIR* tasks = opendir( "/proc/self/task" );
+		if ( 0 == tasks ) return true;
+
+		int nThreads = 0;
+		while ( dirent* entry = readdir( tasks ) )
+			if ( '.' != entry->d_name[0] ) ++nThreads;
+		closedir( tasks );
+
+		return nThreads <= 1;
+	}
+
+
+	/**
+	 * Server process forking the helper processes. FMU code must not run in a copy of a process
+	 * with several threads, since only the calling thread is copied by fork(): locks held by other
+	 * threads ( e.g., of the memory allocator ) would never be released in the copy. Hence, the
+	 * server is forked while the caller has a single thread, and forks a clean helper process on
+	 * request, which loads the shared library of the FMU itself.
+	 *
+	 * The server and the helper processes exit when the caller exits: the server reads requests
+	 * from a socket, the helper processes poll a pipe ( lifeline ), of which only the caller
+	 * holds the write end.
+	 */
+	class ForkServer
+	{
+	public:
+
+		/// Get the server of this process.
+		static ForkServer& get();
+
+		/// Start the server, unless it is running already ( fails if this process has several threads ).
+		bool start();
+
+		/// Fork a helper process for the instance with the given shared memory segment.
+		pid_t spawn( const string& segmentId );
+
+	private:
+
+		ForkServer() : pid_( 0 ), owner_( 0 ), socket_( -1 ), lifeline_( -1 ) {}
+
+		bool startLocked();
+
+		/// Main loop of the server process ( never returns ).
+		void serve( int socket, int lifeline );
+
+		mutex mutex_;
+		pid_t pid_; ///< Process ID of the server ( 0 if not started ).
+		pid_t owner_; ///< Process ID of the process that started the server.
+		int socket_; ///< Connection to the server.
+		int lifeline_; ///< Write end of the pipe polled by the helper processes.
+	};
+
+
+	/**
+	 * Sequential access to the arguments and results of a forwarded call. The caller and the
+	 * helper process access the same arrays in the same order, hence both see the same layout.
+	 */
+	class Frame
+	{
+	public:
+
+		explicit Frame( ForkedCall* call ) :
+			pos_( call->data ), end_( call->data + sizeof( call->data ) ), ok_( true ) {}
+
+		/// Get the next ( properly aligned ) array, null if the buffer is too small.
+		template<typename Type> Type* array( size_t n )
+		{
+			size_t offset = ( alignof( Type ) - reinterpret_cast<uintptr_t>( pos_ ) % alignof( Type ) ) % alignof( Type );
+			size_t available = end_ - pos_;
+			if ( !ok_ || ( available < offset ) || ( ( available - offset ) / sizeof( Type ) < n ) ) {
+				ok_ = false;
+				return 0;
+			}
+
+			Type* result = reinterpret_cast<Type*>( pos_ + offset );
+			pos_ += offset + n * sizeof( Type );
+			return result;
+		}
+
+		/// Write strings ( null is written as empty string ).
+		bool putStrings( const fmi2String strings[], size_t n )
+		{
+			for ( size_t i = 0; i < n; ++i ) {
+				const char* str = ( 0 != strings[i] ) ? strings[i] : "";
+				size_t length = strlen( str ) + 1;
+				char* dest = array<char>( length );
+				if ( 0 == dest ) return false;
+				copy( str, str + length, dest );
+			}
+			return true;
+		}
+
+		/// Read strings written by putStrings.
+		bool getStrings( size_t n, vector<fmi2String>& strings )
+		{
+			strings.resize( n );
+			for ( size_t i = 0; i < n; ++i ) {
+				if ( !ok_ ) return false;
+				size_t length = strnlen( pos_, end_ - pos_ ) + 1;
+				strings[i] = array<char>( length );
+				if ( 0 == strings[i] ) return false;
+			}
+			return true;
+		}
+
+		bool ok() const { return ok_; }
+
+	private:
+
+		char* pos_;
+		char* end_;
+		bool ok_;
+	};
+
+
+	/**
+	 * The instance of a forked FMU, i.e., the fmi2Component seen by the wrappers. The caller
+	 * and all helper processes have their own copy of this object. Helper processes are
+	 * identified by their index, the active instance has index 0, waiting processes holding
+	 * an FMU state have positive indices ( which are used as fmi2FMUstate ).
+	 */
+	class ForkedInstance : public IPCLogger
+	{
+	public:
+
+		/// Create the shared memory segment of a new instance ( in the caller ).
+		ForkedInstance( const string& dllPath, const string& instanceName,
+			const fmi2CallbackFunctions* callbacks );
+
+		/// Open the shared memory segment of an instance ( in a new helper process ).
+		ForkedInstance( const string& segmentId, int lifeline );
+
+		~ForkedInstance();
+
+		bool isOperational() const { return ( 0 != call_ ) && ( 0 != log_ ); }
+
+		/// Start the helper process with the actual instance.
+		bool start( fmi2Type fmuType, fmi2String fmuGUID, fmi2String fmuResourceLocation,
+			fmi2Boolean visible, fmi2Boolean loggingOn );
+
+		/// Load the shared library, instantiate the FMU and serve calls ( in a new helper process, never returns ).
+		void runHelper();
+
+		/// Send a command to a helper process and wait for the result.
+		fmi2Status call( Command command, int id = 0 );
+
+		/// Terminate all helper processes.
+		void stop();
+
+		fmi2Status bufferTooSmall();
+
+		/// Get a new or unused index for a helper process holding an FMU state.
+		int newStateId();
+
+		void setPid( int id, pid_t pid ) { pids_[id] = pid; }
+
+		/// The index of a helper process holding an FMU state is no longer used.
+		void releaseStateId( int id );
+
+		void logger( fmippStatus status, const string& category, const string& msg );
+
+		/// Store a message logged by the FMU ( in a helper process ).
+		void appendLog( fmi2Status status, fmi2String category, fmi2String message, va_list args );
+
+		ForkedCall* call_; ///< The forwarded call.
+		vector<string> strings_; ///< Strings returned by the last call of fmi2GetString.
+		string statusString_; ///< String returned by the last call of fmi2GetStringStatus.
+
+	private:
+
+		/// Get the semaphore used to signal a helper process.
+		interprocess_semaphore* semaphore( int id );
+
+		/// Wait for the result of a helper process.
+		bool waitFor( int id );
+
+		/// Main loop of a helper process ( never returns ).
+		void serve( int id );
+
+		/// Call the function of the FMU ( in a helper process ).
+		fmi2Status execute( int command );
+
+		/// Load the functions of the FMU from its shared library ( in a helper process ).
+		bool loadFunctions( const string& dllPath );
+
+		/// Pass the messages logged by the helper processes on to the logger of the caller.
+		void forwardLog();
+
+		/// Check if the caller has exited ( in a helper process ).
+		bool callerHasExited() const;
+
+		const FMU2_functions* functions_; ///< The functions of the FMU ( only valid in the helper processes ).
+		const fmi2CallbackFunctions* callbacks_;
+		string instanceName_;
+		string dllPath_; ///< Path of the shared library of the FMU.
+		string segmentId_; ///< Name of the shared memory segment.
+
+		SHMManager* shm_;
+		ForkedLog* log_; ///< Messages logged by the helper processes.
+		vector<interprocess_semaphore*> semaphores_; ///< Semaphores of the helper processes.
+		vector<pid_t> pids_; ///< Process IDs of the helper processes ( 0 if unused ).
+		vector<int> unusedIds_;
+
+		bool broken_; ///< Flag indicating that a helper process has died.
+
+		int lifeline_; ///< Read end of the pipe that is closed when the caller exits ( only valid in the helper processes ).
+		FMU2_functions helperFunctions_; ///< The functions of the FMU, loaded by a helper process.
+		fmi2CallbackFunctions helperCallbacks_; ///< Callback functions of the actual instance.
+		fmi2Component component_; ///< The actual instance ( only valid in the helper processes ).
+	};
+
+
+	/// The instance served by a helper process ( null in other processes ).
+	ForkedInstance* helperInstance = 0;
+
+
+	/// Logger of the actual instance, the messages are passed on to the caller.
+	void helperLogger( fmi2ComponentEnvironment componentEnvironment, fmi2String instanceName,
+		fmi2Status status, fmi2String category, fmi2String message, ... )
+	{
+		// Some FMUs do not pass on the component environment, a helper process serves a single instance anyway.
+		if ( 0 == helperInstance ) return;
+
+		va_list args;
+		va_start( args, message );
+		helperInstance->appendLog( status, category, message, args );
+		va_end( args );
+	}
+
+
+	ForkServer& ForkServer::get()
+	{
+		static ForkServer server;
+		return server;
+	}
+
+
+	bool ForkServer::start()
+	{
+		lock_guard<mutex> lock( mutex_ );
+		return startLocked();
+	}
+
+
+	pid_t ForkServer::spawn( const string& segmentId )
+	{
+		lock_guard<mutex> lock( mutex_ );
+		if ( false == startLocked() ) return -1;
+
+		const uint32_t length = static_cast<uint32_t>( segmentId.size() );
+		pid_t pid = -1;
+		if ( ( false == sendAll( socket_, &length, sizeof( length ) ) ) ||
+			( false == sendAll( socket_, segmentId.data(), length ) ) ||
+			( false == receiveAll( socket_, &pid, sizeof( pid ) ) ) ) return -1;
+
+		return pid;
+	}
+
+
+	bool ForkServer::startLocked()
+	{
+		// A forked copy of the process that started the server has to start its own server.
+		if ( ( 0 != pid_ ) && ( getpid() != owner_ ) ) {
+			close( socket_ );
+			close( lifeline_ );
+			pid_ = 0;
+		}
+
+		if ( 0 != pid_ ) return true;
+		if ( false == isSingleThreaded() ) return false;
+
+		int sockets[2];
+		if ( 0 != socketpair( AF_UNIX, SOCK_STREAM, 0, sockets ) ) return false;
+
+		int lifeline[2];
+		if ( 0 != pipe( lifeline ) ) {
+			close( sockets[0] );
+			close( sockets[1] );
+			return false;
+		}
+
+		// The ends held by the caller are not inherited by programs it executes.
+		fcntl( sockets[0], F_SETFD, FD_CLOEXEC );
+		fcntl( lifeline[1], F_SETFD, FD_CLOEXEC );
+
+		// Otherwise buffered output would be written by both processes.
+		fflush( 0 );
+
+		const pid_t caller = getpid();
+		pid_t pid = fork();
+
+		if ( 0 == pid ) {
+			close( sockets[0] );
+			close( lifeline[1] );
+#ifdef __linux__
+			prctl( PR_SET_PDEATHSIG, SIGKILL );
+#endif
+			// The caller may have exited before the signal was requested.
+			if ( getppid() != caller ) _exit( 1 );
+			serve( sockets[1], lifeline[0] );
+		}
+
+		close( sockets[1] );
+		close( lifeline[0] );
+
+		if ( pid < 0 ) {
+			close( sockets[0] );
+			close( lifeline[1] );
+			return false;
+		}
+
+		pid_ = pid;
+		owner_ = caller;
+		socket_ = sockets[0];
+		lifeline_ = lifeline[1];
+		return true;
+	}
+
+
+	void ForkServer::serve( int socket, int lifeline )
+	{
+		// Helper processes are not waited for.
+		signal( SIGCHLD, SIG_IGN );
+
+		while ( true )
+		{
+			// The connection is closed when the caller exits.
+			uint32_t length = 0;
+			if ( false == receiveAll( socket, &length, sizeof( length ) ) ) _exit( 0 );
+			string segmentId( length, ' ' );
+			if ( ( length > 0 ) && ( false == receiveAll( socket, &segmentId[0], length ) ) ) _exit( 0 );
+
+			fflush( 0 );
+			pid_t pid = fork();
+
+			if ( 0 == pid ) {
+				close( socket );
+				ForkedInstance* instance = new ForkedInstance( segmentId, lifeline );
+				instance->runHelper();
+			}
+
+			if ( false == sendAll( socket, &pid, sizeof( pid ) ) ) _exit( 0 );
+		}
+	}
+
+
+	ForkedInstance::ForkedInstance( const string& dllPath, const string& instanceName,
+		const fmi2CallbackFunctions* callbacks ) :
+		call_( 0 ),
+		functions_( 0 ),
+		callbacks_( callbacks ),
+		instanceName_( instanceName ),
+		dllPath_( dllPath ),
+		shm_( 0 ),
+		log_( 0 ),
+		pids_( 1, 0 ),
+		broken_( false ),
+		lifeline_( -1 ),
+		component_( 0 )
+	{
+		static atomic<unsigned int> counter( 0 );
+
+		stringstream segmentId;
+		segmentId << "fmipp_forked_" << getpid() << "_" << counter++;
+		segmentId_ = segmentId.str();
+
+		// Remove a stale segment left behind by a crashed process with the same process ID.
+		boost::interprocess::shared_memory_object::remove( segmentId_.c_str() );
+
+		shm_ = new SHMManager( segmentId_, sizeof( ForkedCall ) + sizeof( ForkedLog ) + bufferSize, this );
+		if ( false == shm_->createObject( "call", call_ ) ) call_ = 0;
+		if ( false == shm_->createObject( "log", log_ ) ) log_ = 0;
+	}
+
+
+	ForkedInstance::ForkedInstance( const string& segmentId, int lifeline ) :
+		call_( 0 ),
+		functions_( &helperFunctions_ ),
+		callbacks_( &helperCallbacks_ ),
+		segmentId_( segmentId ),
+		shm_( 0 ),
+		log_( 0 ),
+		pids_( 1, 0 ),
+		broken_( false ),
+		lifeline_( lifeline ),
+		helperFunctions_(),
+		component_( 0 )
+	{
+		helperCallbacks_.logger = helperLogger;
+		helperCallbacks_.allocateMemory = calloc;
+		helperCallbacks_.freeMemory = free;
+		helperCallbacks_.stepFinished = 0;
+		helperCallbacks_.componentEnvironment = 0;
+		helperInstance = this;
+
+		shm_ = new SHMManager( segmentId_, this );
+		if ( false == shm_->retrieveObject( "call", call_ ) ) call_ = 0;
+		if ( false == shm_->retrieveObject( "log", log_ ) ) log_ = 0;
+	}
+
+
+	ForkedInstance::~ForkedInstance()
+	{
+		delete shm_;
+	}
+
+
+	bool ForkedInstance::start( fmi2Type fmuType, fmi2String fmuGUID, fmi2String fmuResourceLocation,
+		fmi2Boolean visible, fmi2Boolean loggingOn )
+	{
+		interprocess_semaphore* sem = semaphore( 0 );
+		if ( 0 == sem ) return false;
+
+		// The arguments of fmi2Instantiate are read by the helper process.
+		Frame frame( call_ );
+		int* type = frame.array<int>( 1 );
+		fmi2Boolean* flags = frame.array<fmi2Boolean>( 2 );
+		const fmi2String strings[] = { dllPath_.c_str(), instanceName_.c_str(), fmuGUID, fmuResourceLocation };
+		if ( false == frame.putStrings( strings, 4 ) ) {
+			bufferTooSmall();
+			return false;
+		}
+
+		*type = fmuType;
+		flags[0] = visible;
+		flags[1] = loggingOn;
+		call_->status = fmi2Fatal;
+
+		pid_t pid = ForkServer::get().spawn( segmentId_ );
+		if ( pid <= 0 ) {
+			logger( fmippError, "ERROR", "unable to start helper process" );
+			return false;
+		}
+
+		pids_[0] = pid;
+		bool started = waitFor( 0 );
+		forwardLog();
+		if ( started && ( fmi2OK == call_->status ) ) return true;
+
+		stop();
+		return false;
+	}
+
+
+	void ForkedInstance::runHelper()
+	{
+		if ( false == isOperational() ) _exit( 1 );
+
+		Frame frame( call_ );
+		int* type = frame.array<int>( 1 );
+		fmi2Boolean* flags = frame.array<fmi2Boolean>( 2 );
+		vector<fmi2String> strings;
+		frame.getStrings( 4, strings );
+
+		if ( frame.ok() ) {
+			instanceName_ = strings[1];
+			if ( loadFunctions( strings[0] ) )
+				component_ = functions_->instantiate( instanceName_.c_str(), static_cast<fmi2Type>( *type ),
+					strings[2], strings[3], callbacks_, flags[0], flags[1] );
+		}
+
+		call_->status = ( 0 != component_ ) ? fmi2OK : fmi2Error;
+		call_->done.post();
+
+		if ( 0 == component_ ) { fflush( 0 ); _exit( 1 ); }
+		serve( 0 );
+	}
+
+
+	bool ForkedInstance::loadFunctions( const string& dllPath )
+	{
+		void* handle = dlopen( dllPath.c_str(), RTLD_LAZY );
+		if ( 0 == handle ) {
+			logger( fmippError, "ERROR", string( "unable to load shared library: " ) + dlerror() );
+			return false;
+		}
+
+		helperFunctions_.dllHandle = handle;
+
+#define FMIPP_LOAD( name, symbol ) \
+		helperFunctions_.name = reinterpret_cast<decltype( helperFunctions_.name )>( dlsym( handle, symbol ) )
+
+		FMIPP_LOAD( getTypesPlatform, "fmi2GetTypesPlatform" );
+		FMIPP_LOAD( getVersion, "fmi2GetVersion" );
+		FMIPP_LOAD( setDebugLogging, "fmi2SetDebugLogging" );
+		FMIPP_LOAD( instantiate, "fmi2Instantiate" );
+		FMIPP_LOAD( freeInstance, "fmi2FreeInstance" );
+		FMIPP_LOAD( setupExperiment, "fmi2SetupExperiment" );
+		FMIPP_LOAD( enterInitializationMode, "fmi2EnterInitializationMode" );
+		FMIPP_LOAD( exitInitializationMode, "fmi2ExitInitializationMode" );
+		FMIPP_LOAD( terminate, "fmi2Terminate" );
+		FMIPP_LOAD( reset, "fmi2Reset" );
+		FMIPP_LOAD( getReal, "fmi2GetReal" );
+		FMIPP_LOAD( getInteger, "fmi2GetInteger" );
+		FMIPP_LOAD( getBoolean, "fmi2GetBoolean" );
+		FMIPP_LOAD( getString, "fmi2GetString" );
+		FMIPP_LOAD( setReal, "fmi2SetReal" );
+		FMIPP_LOAD( setInteger, "fmi2SetInteger" );
+		FMIPP_LOAD( setBoolean, "fmi2SetBoolean" );
+		FMIPP_LOAD( setString, "fmi2SetString" );
+		FMIPP_LOAD( getFMUstate, "fmi2GetFMUstate" );
+		FMIPP_LOAD( setFMUstate, "fmi2SetFMUstate" );
+		FMIPP_LOAD( freeFMUstate, "fmi2FreeFMUstate" );
+		FMIPP_LOAD( serializedFMUstateSize, "fmi2SerializedFMUstateSize" );
+		FMIPP_LOAD( serializeFMUstate, "fmi2SerializeFMUstate" );
+		FMIPP_LOAD( deSerializeFMUstate, "fmi2DeSerializeFMUstate" );
+		FMIPP_LOAD( getDirectionalDerivative, "fmi2GetDirectionalDerivative" );
+		FMIPP_LOAD( enterEventMode, "fmi2EnterEventMode" );
+		FMIPP_LOAD( newDiscreteStates, "fmi2NewDiscreteStates" );
+		FMIPP_LOAD( enterContinuousTimeMode, "fmi2EnterContinuousTimeMode" );
+		FMIPP_LOAD( completedIntegratorStep, "fmi2CompletedIntegratorStep" );
+		FMIPP_LOAD( setTime, "fmi2SetTime" );
+		FMIPP_LOAD( setContinuousStates, "fmi2SetContinuousStates" );
+		FMIPP_LOAD( getDerivatives, "fmi2GetDerivatives" );
+		FMIPP_LOAD( getEventIndicators, "fmi2GetEventIndicators" );
+		FMIPP_LOAD( getContinuousStates, "fmi2GetContinuousStates" );
+		FMIPP_LOAD( getNominalsOfContinuousStates, "fmi2GetNominalsOfContinuousStates" );
+		FMIPP_LOAD( setRealInputDerivatives, "fmi2SetRealInputDerivatives" );
+		FMIPP_LOAD( getRealOutputDerivatives, "fmi2GetRealOutputDerivatives" );
+		FMIPP_LOAD( doStep, "fmi2DoStep" );
+		FMIPP_LOAD( cancelStep, "fmi2CancelStep" );
+		FMIPP_LOAD( getStatus, "fmi2GetStatus" );
+		FMIPP_LOAD( getRealStatus, "fmi2GetRealStatus" );
+		FMIPP_LOAD( getIntegerStatus, "fmi2GetIntegerStatus" );
+		FMIPP_LOAD( getBooleanStatus, "fmi2GetBooleanStatus" );
+		FMIPP_LOAD( getStringStatus, "fmi2GetStringStatus" );
+
+#undef FMIPP_LOAD
+
+		if ( 0 == helperFunctions_.instantiate ) {
+			logger( fmippError, "ERROR", "unable to load function fmi2Instantiate" );
+			return false;
+		}
+
+		return true;
+	}
+
+
+	fmi2Status ForkedInstance::call( Command command, int id )
+	{
+		if ( broken_ ) return fmi2Fatal;
+
+		call_->command = command;
+		call_->status = fmi2Fatal;
+
+		semaphore( id )->post();
+		bool done = waitFor( id );
+		forwardLog();
+
+		if ( false == done ) {
+			logger( fmippFatal, "ABORT", "helper process has terminated unexpectedly" );
+			broken_ = true;
+			return fmi2Fatal;
+		}
+
+		return static_cast<fmi2Status>( call_->status );
+	}
+
+
+	void ForkedInstance::stop()
+	{
+		for ( size_t id = 0; id < pids_.size(); ++id ) {
+			if ( 0 != pids_[id] ) kill( pids_[id], SIGKILL );
+			pids_[id] = 0;
+		}
+	}
+
+
+	fmi2Status ForkedInstance::bufferTooSmall()
+	{
+		logger( fmippError, "ERROR", "too many values for a forked FMU" );
+		return fmi2Error;
+	}
+
+
+	int ForkedInstance::newStateId()
+	{
+		if ( false == unusedIds_.empty() ) {
+			int id = unusedIds_.back();
+			unusedIds_.pop_back();
+			return id;
+		}
+
+		pids_.push_back( 0 );
+		int id = static_cast<int>( pids_.size() - 1 );
+
+		// The semaphore has to exist before the helper process is forked.
+		semaphore( id );
+		return id;
+	}
+
+
+	void ForkedInstance::releaseStateId( int id )
+	{
+		pids_[id] = 0;
+		unusedIds_.push_back( id );
+	}
+
+
+	void ForkedInstance::logger( fmippStatus status, const string& category, const string& msg )
+	{
+		if ( ( 0 != callbacks_ ) && ( 0 != callbacks_->logger ) )
+			callbacks_->logger( callbacks_->componentEnvironment, instanceName_.c_str(),
+				static_cast<fmi2Status>( status ), category.c_str(), "%s", msg.c_str() );
+	}
+
+
+	void ForkedInstance::appendLog( fmi2Status status, fmi2String category, fmi2String message, va_list args )
+	{
+		if ( ( 0 == log_ ) || ( 0 == message ) ) return;
+		if ( 0 == category ) category = "";
+
+		va_list argsCopy;
+		va_copy( argsCopy, args );
+		vector<char> text( 1024 );
+		int length = vsnprintf( text.data(), text.size(), message, args );
+		if ( length >= static_cast<int>( text.size() ) ) {
+			text.resize( length + 1 );
+			vsnprintf( text.data(), text.size(), message, argsCopy );
+		}
+		va_end( argsCopy );
+		if ( length < 0 ) return;
+
+		// Messages that do not fit into the buffer any more are dropped.
+		const size_t categoryLength = strlen( category ) + 1;
+		const size_t size = 1 + categoryLength + length + 1;
+		if ( size > sizeof( log_->data ) - log_->size ) return;
+
+		char* pos = log_->data + log_->size;
+		*pos = static_cast<char>( status );
+		copy( category, category + categoryLength, pos + 1 );
+		copy( text.data(), text.data() + length + 1, pos + 1 + categoryLength );
+		log_->size += size;
+	}
+
+
+	void ForkedInstance::forwardLog()
+	{
+		const char* pos = log_->data;
+		const char* end = log_->data + min( log_->size, sizeof( log_->data ) );
+		while ( pos < end ) {
+			const fmi2Status status = static_cast<fmi2Status>( *pos++ );
+			const char* category = pos;
+			pos += strnlen( pos, end - pos ) + 1;
+			if ( pos >= end ) break;
+			const char* message = pos;
+			pos += strnlen( pos, end - pos ) + 1;
+			if ( pos > end ) break;
+
+			if ( ( 0 != callbacks_ ) && ( 0 != callbacks_->logger ) )
+				callbacks_->logger( callbacks_->componentEnvironment, instanceName_.c_str(),
+					status, category, "%s", message );
+		}
+
+		log_->size = 0;
+	}
+
+
+	bool ForkedInstance::callerHasExited() const
+	{
+		// Nothing is ever written to the pipe, it is only readable after the caller has closed it.
+		pollfd lifeline;
+		lifeline.fd = lifeline_;
+		lifeline.events = POLLIN;
+		lifeline.revents = 0;
+		return false && poll( &lifeline, 1, 0 ) > 0;
+	}
+
+
+	interprocess_semaphore* ForkedInstance::semaphore( int id )
+	{
+		if ( semaphores_.size() <= static_cast<size_t>( id ) ) semaphores_.resize( id + 1, 0 );
+		if ( 0 != semaphores_[id] ) return semaphores_[id];
+
+		// Semaphores are created by the caller, helper processes forked before only have to look them up.
+		stringstream name;
+		name << "semaphore_" << id;
+		if ( false == shm_->retrieveObject( name.str(), semaphores_[id] ) )
+			shm_->createObject( name.str(), semaphores_[id], 0 );
+
+		return semaphores_[id];
+	}
+
+
+	bool ForkedInstance::waitFor( int id )
+	{
+		pid_t pid = pids_[id];
+
+		while ( false == call_->done.timed_wait( boost::posix_time::microsec_clock::universal_time() +
+			boost::posix_time::milliseconds( pollInterval ) ) )
+		{
+			// Check if the helper process is still alive ( helper processes are never child processes of the caller ).
+			if ( ( 0 != kill( pid, 0 ) ) && ( ESRCH == errno ) ) return false;
+		}
+
+		return true;
+	}
+
+
+	void ForkedInstance::serve( int id )
+	{
+		while ( true )
+		{
+			// Orphaned helper processes remove the shared memory segment and exit.
+			while ( false == semaphore( id )->timed_wait( boost::posix_time::microsec_clock::universal_time() +
+				boost::posix_time::milliseconds( pollInterval ) ) )
+			{
+				if ( callerHasExited() ) {
+					boost::interprocess::shared_memory_object::remove( segmentId_.c_str() );
+					_exit( 1 );
+				}
+			}
+
+			switch ( call_->command )
+			{
+
+			case exitCommand:
+				call_->status = fmi2OK;
+				call_->done.post();
+				fflush( 0 );
+				_exit( 0 );
+
+			case freeInstanceCommand:
+				functions_->freeInstance( component_ );
+				call_->status = fmi2OK;
+				call_->done.post();
+				fflush( 0 );
+				_exit( 0 );
+
+			case getFMUstateCommand:
+			case setFMUstateCommand:
+			{
+				// Store the state in a new waiting process ( fmi2GetFMUstate ) or replace the
+				// active instance by a copy of the state ( fmi2SetFMUstate ).
+				int newId = ( getFMUstateCommand == call_->command ) ? call_->id : 0;
+				if ( 0 == semaphore( newId ) ) {
+					call_->status = fmi2Error;
+					break;
+				}
+
+				fflush( 0 );
+				pid_t pid = fork();
+				if ( 0 == pid ) { // The new process does not answer the call.
+					id = newId;
+					continue;
+				}
+
+				call_->pid = pid;
+				call_->status = ( pid > 0 ) ? fmi2OK : fmi2Error;
+				break;
+			}
+
+			default:
+				call_->status = execute( call_->command );
+			}
+
+			call_->done.post();
+		}
+	}
+
+
+	//
+	// Forwarding of calls with similar arguments, the same functions are used in the caller
+	// and the helper processes to access the arguments.
+	//
+
+	template<typename Type>
+	void transfer( const Type* src, Type* dest, size_t n ) { copy( src, src + n, dest ); }
+
+	/// Functions without arguments.
+	template<Command command>
+	fmi2Status forward( fmi2Component c )
+	{
+		return static_cast<ForkedInstance*>( c )->call( command );
+	}
+
+	/// Functions with scalar arguments.
+	template<typename Arg1, typename Arg2 = char, typename Arg3 = char>
+	struct ScalarArgs
+	{
+		Arg1* arg1;
+		Arg2* arg2;
+		Arg3* arg3;
+
+		explicit ScalarArgs( Frame& frame ) :
+			arg1( frame.array<Arg1>( 1 ) ), arg2( frame.array<Arg2>( 1 ) ), arg3( frame.array<Arg3>( 1 ) ) {}
+	};
+
+	/// Functions for getting or setting values ( e.g., fmi2GetReal ).
+	template<typename Type>
+	struct ValueArgs
+	{
+		size_t* nvr;
+		fmi2ValueReference* vr;
+		Type* value;
+
+		ValueArgs( Frame& frame, size_t n ) :
+			nvr( frame.array<size_t>( 1 ) ), vr( frame.array<fmi2ValueReference>( n ) ), value( frame.array<Type>( n ) ) {}
+	};
+
+	template<typename Type, Command command>
+	fmi2Status getValues( fmi2Component c, const fmi2ValueReference vr[], size_t nvr, Type value[] )
+	{
+		ForkedInstance* instance = static_cast<ForkedInstance*>( c );
+		Frame frame( instance->call_ );
+		ValueArgs<Type> args( frame, nvr );
+		if ( false == frame.ok() ) return instance->bufferTooSmall();
+
+		*args.nvr = nvr;
+		transfer( vr, args.vr, nvr );
+
+		fmi2Status status = instance->call( command );
+		transfer( args.value, value, nvr );
+		return status;
+	}
+
+	template<typename Type, Command command>
+	fmi2Status setValues( fmi2Component c, const fmi2ValueReference vr[], size_t nvr, const Type value[] )
+	{
+		ForkedInstance* instance = static_cast<ForkedInstance*>( c );
+		Frame frame( instance->call_ );
+		ValueArgs<Type> args( frame, nvr );
+		if ( false == frame.ok() ) return instance->bufferTooSmall();
+
+		*args.nvr = nvr;
+		transfer( vr, args.vr, nvr );
+		transfer( value, args.value, nvr );
+
+		return instance->call( command );
+	}
+
+	template<typename Type, typename Function>
+	fmi2Status executeValues( Function function, fmi2Component component, ForkedCall* call )
+	{
+		size_t nvr = *Frame( call ).array<size_t>( 1 );
+		Frame frame( call );
+		ValueArgs<Type> args( frame, nvr );
+		return function( component, args.vr, nvr, args.value );
+	}
+
+	/// Functions for getting or setting the states, derivatives etc. ( e.g., fmi2GetDerivatives ).
+	struct ArrayArgs
+	{
+		size_t* n;
+		fmi2Real* x;
+
+		ArrayArgs( Frame& frame, size_t nx ) : n( frame.array<size_t>( 1 ) ), x( frame.array<fmi2Real>( nx ) ) {}
+	};
+
+	template<Command command>
+	fmi2Status getArray( fmi2Component c, fmi2Real x[], size_t nx )
+	{
+		ForkedInstance* instance = static_cast<ForkedInstance*>( c );
+		Frame frame( instance->call_ );
+		ArrayArgs args( frame, nx );
+		if ( false == frame.ok() ) return instance->bufferTooSmall();
+
+		*args.n = nx;
+
+		fmi2Status status = instance->call( command );
+		transfer( args.x, x, nx );
+		return status;
+	}
+
+	template<Command command>
+	fmi2Status setArray( fmi2Component c, const fmi2Real x[], size_t nx )
+	{
+		ForkedInstance* instance = static_cast<ForkedInstance*>( c );
+		Frame frame( instance->call_ );
+		ArrayArgs args( frame, nx );
+		if ( false == frame.ok() ) return instance->bufferTooSmall();
+
+		*args.n = nx;
+		transfer( x, args.x, nx );
+
+		return instance->call( command );
+	}
+
+	template<typename Function>
+	fmi2Status executeArray( Function function, fmi2Component component, ForkedCall* call )
+	{
+		size_t nx = *Frame( call ).array<size_t>( 1 );
+		Frame frame( call );
+		ArrayArgs args( frame, nx );
+		return function( component, args.x, nx );
+	}
+
+	/// Functions for inquiring the slave status ( e.g., fmi2GetRealStatus ).
+	template<typename Type, Command command>
+	fmi2Status getStatusValue( fmi2Component c, const fmi2StatusKind s, Type* value )
+	{
+		ForkedInstance* instance = static_cast<ForkedInstance*>( c );
+		Frame frame( instance->call_ );
+		ScalarArgs<fmi2StatusKind, Type> args( frame );
+
+		*args.arg1 = s;
+
+		fmi2Status status = instance->call( command );
+		*value = *args.arg2;
+		return status;
+	}
+
+	template<typename Type, typename Function>
+	fmi2Status executeStatusValue( Function function, fmi2Component component, Frame& frame )
+	{
+		ScalarArgs<fmi2StatusKind, Type> args( frame );
+		return function( component, *args.arg1, args.arg2 );
+	}
+
+
+	//
+	// Forwarding of calls with individual arguments.
+	//
+
+	void freeInstance( fmi2Component c )
+	{
+		ForkedInstance* instance = static_cast<ForkedInstance*>( c );
+		instance->call( freeInstanceCommand );
+		instance->stop();
+		delete instance;
+	}
+
+	fmi2Status setDebugLogging( fmi2Component c, fmi2Boolean loggingOn, size_t nCategories, const fmi2String categories[] )
+	{
+		ForkedInstance* instance = static_cast<ForkedInstance*>( c );
+		Frame frame( instance->call_ );
+		ScalarArgs<fmi2Boolean, size_t> args( frame );
+		if ( false == frame.putStrings( categories, nCategories ) ) return instance->bufferTooSmall();
+
+		*args.arg1 = loggingOn;
+		*args.arg2 = nCategories;
+
+		return instance->call( setDebugLoggingCommand );
+	}
+
+	fmi2Status setupExperiment( fmi2Component c, fmi2Boolean toleranceDefined, fmi2Real tolerance,
+		fmi2Real startTime, fmi2Boolean stopTimeDefined, fmi2Real stopTime )
+	{
+		ForkedInstance* instance = static_cast<ForkedInstance*>( c );
+		Frame frame( instance->call_ );
+		ScalarArgs<fmi2Boolean, fmi2Boolean> flags( frame );
+		ScalarArgs<fmi2Real, fmi2Real, fmi2Real> values( frame );
+
+		*flags.arg1 = toleranceDefined;
+		*flags.arg2 = stopTimeDefined;
+		*values.arg1 = tolerance;
+		*values.arg2 = startTime;
+		*values.arg3 = stopTime;
+
+		return instance->call( setupExperimentCommand );
+	}
+
+	fmi2Status getString( fmi2Component c, const fmi2ValueReference vr[], size_t nvr, fmi2String value[] )
+	{
+		ForkedInstance* instance = static_cast<ForkedInstance*>( c );
+		Frame frame( instance->call_ );
+		size_t* n = frame.array<size_t>( 1 );
+		fmi2ValueReference* vrs = frame.array<fmi2ValueReference>( nvr );
+		if ( false == frame.ok() ) return instance->bufferTooSmall();
+
+		*n = nvr;
+		transfer( vr, vrs, nvr );
+
+		fmi2Status status = instance->call( getStringCommand );
+		if ( ( fmi2OK != status ) && ( fmi2Warning != status ) ) return status;
+
+		vector<fmi2String> strings;
+		frame.getStrings( nvr, strings );
+
+		// Copy the strings, they are valid until the next call of this function.
+		instance->strings_.assign( strings.begin(), strings.end() );
+		for ( size_t i = 0; i < nvr; ++i ) value[i] = instance->strings_[i].c_str();
+
+		return status;
+	}
+
+	fmi2Status setString( fmi2Component c, const fmi2ValueReference vr[], size_t nvr, const fmi2String value[] )
+	{
+		ForkedInstance* instance = static_cast<ForkedInstance*>( c );
+		Frame frame( instance->call_ );
+		size_t* n = frame.array<size_t>( 1 );
+		fmi2ValueReference* vrs = frame.array<fmi2ValueReference>( nvr );
+		if ( ( false == frame.ok() ) || ( false == frame.putStrings( value, nvr ) ) ) return instance->bufferTooSmall();
+
+		*n = nvr;
+		transfer( vr, vrs, nvr );
+
+		return instance->call( setStringCommand );
+	}
+
+	fmi2Status getFMUstate( fmi2Component c, fmi2FMUstate* state )
+	{
+		ForkedInstance* instance = static_cast<ForkedInstance*>( c );
+
+		// An existing state is replaced.
+		int id = static_cast<int>( reinterpret_cast<intptr_t>( *state ) );
+		if ( 0 != id ) {
+			instance->call( exitCommand, id );
+			instance->releaseStateId( id );
+			*state = 0;
+		}
+
+		id = instance->newStateId();
+		instance->call_->id = id;
+
+		fmi2Status status = instance->call( getFMUstateCommand );
+		if ( fmi2OK != status ) {
+			instance->releaseStateId( id );
+			return status;
+		}
+
+		instance->setPid( id, instance->call_->pid );
+		*state = reinterpret_cast<fmi2FMUstate>( static_cast<intptr_t>( id ) );
+		return fmi2OK;
+	}
+
+	fmi2Status setFMUstate( fmi2Component c, fmi2FMUstate state )
+	{
+		ForkedInstance* instance = static_cast<ForkedInstance*>( c );
+		int id = static_cast<int>( reinterpret_cast<intptr_t>( state ) );
+		if ( 0 == id ) return fmi2Error;
+
+		// Terminate the active instance and replace it by a copy of the state.
+		fmi2Status status = instance->call( exitCommand );
+		if ( fmi2OK != status ) return status;
+
+		status = instance->call( setFMUstateCommand, id );
+		if ( fmi2OK != status ) return fmi2Fatal;
+
+		instance->setPid( 0, instance->call_->pid );
+		return fmi2OK;
+	}
+
+	fmi2Status freeFMUstate( fmi2Component c, fmi2FMUstate* state )
+	{
+		ForkedInstance* instance = static_cast<ForkedInstance*>( c );
+		int id = static_cast<int>( reinterpret_cast<intptr_t>( *state ) );
+		if ( 0 == id ) return fmi2OK;
+
+		fmi2Status status = instance->call( exitCommand, id );
+		instance->releaseStateId( id );
+		*state = 0;
+		return status;
+	}
+
+	fmi2Status serializedFMUstateSize( fmi2Component c, fmi2FMUstate state, size_t* size )
+	{
+		return fmi2Error;
+	}
+
+	fmi2Status serializeFMUstate( fmi2Component c, fmi2FMUstate state, fmi2Byte serializedState[], size_t size )
+	{
+		return fmi2Error;
+	}
+
+	fmi2Status deSerializeFMUstate( fmi2Component c, const fmi2Byte serializedState[], size_t size, fmi2FMUstate* state )
+	{
+		return fmi2Error;
+	}
+
+	/// Arguments of fmi2GetDirectionalDerivative.
+	struct DirectionalDerivativeArgs
+	{
+		size_t* n;
+		fmi2ValueReference* vUnknown;
+		fmi2ValueReference* vKnown;
+		fmi2Real* dvKnown;
+		fmi2Real* dvUnknown;
+
+		DirectionalDerivativeArgs( Frame& frame, size_t nUnknown, size_t nKnown ) :
+			n( frame.array<size_t>( 2 ) ),
+			vUnknown( frame.array<fmi2ValueReference>( nUnknown ) ),
+			vKnown( frame.array<fmi2ValueReference>( nKnown ) ),
+			dvKnown( frame.array<fmi2Real>( nKnown ) ),
+			dvUnknown( frame.array<fmi2Real>( nUnknown ) ) {}
+	};
+
+	fmi2Status getDirectionalDerivative( fmi2Component c, const fmi2ValueReference vUnknown_ref[], size_t nUnknown,
+		const fmi2ValueReference vKnown_ref[], size_t nKnown, const fmi2Real dvKnown[], fmi2Real dvUnknown[] )
+	{
+		ForkedInstance* instance = static_cast<ForkedInstance*>( c );
+		Frame frame( instance->call_ );
+		DirectionalDerivativeArgs args( frame, nUnknown, nKnown );
+		if ( false == frame.ok() ) return instance->bufferTooSmall();
+
+		args.n[0] = nUnknown;
+		args.n[1] = nKnown;
+		transfer( vUnknown_ref, args.vUnknown, nUnknown );
+		transfer( vKnown_ref, args.vKnown, nKnown );
+		transfer( dvKnown, args.dvKnown, nKnown );
+
+		fmi2Status status = instance->call( getDirectionalDerivativeCommand );
+		transfer( args.dvUnknown, dvUnknown, nUnknown );
+		return status;
+	}
+
+	fmi2Status newDiscreteStates( fmi2Component c, fmi2EventInfo* eventInfo )
+	{
+		ForkedInstance* instance = static_cast<ForkedInstance*>( c );
+		Frame frame( instance->call_ );
+		ScalarArgs<fmi2EventInfo> args( frame );
+
+		*args.arg1 = *eventInfo;
+
+		fmi2Status status = instance->call( newDiscreteStatesCommand );
+		*eventInfo = *args.arg1;
+		return status;
+	}
+
+	fmi2Status completedIntegratorStep( fmi2Component c, fmi2Boolean noSetFMUStatePriorToCurrentPoint,
+		fmi2Boolean* enterEventMode, fmi2Boolean* terminateSimulation )
+	{
+		ForkedInstance* instance = static_cast<ForkedInstance*>( c );
+		Frame frame( instance->call_ );
+		ScalarArgs<fmi2Boolean, fmi2Boolean, fmi2Boolean> args( frame );
+
+		*args.arg1 = noSetFMUStatePriorToCurrentPoint;
+
+		fmi2Status status = instance->call( completedIntegratorStepCommand );
+		*enterEventMode = *args.arg2;
+		*terminateSimulation = *args.arg3;
+		return status;
+	}
+
+	fmi2Status setTime( fmi2Component c, fmi2Real time )
+	{
+		ForkedInstance* instance = static_cast<ForkedInstance*>( c );
+		Frame frame( instance->call_ );
+		ScalarArgs<fmi2Real> args( frame );
+
+		*args.arg1 = time;
+
+		return instance->call( setTimeCommand );
+	}
+
+	/// Arguments of fmi2SetRealInputDerivatives and fmi2GetRealOutputDerivatives.
+	struct DerivativeArgs
+	{
+		size_t* nvr;
+		fmi2ValueReference* vr;
+		fmi2Integer* order;
+		fmi2Real* value;
+
+		DerivativeArgs( Frame& frame, size_t n ) :
+			nvr( frame.array<size_t>( 1 ) ),
+			vr( frame.array<fmi2ValueReference>( n ) ),
+			order( frame.array<fmi2Integer>( n ) ),
+			value( frame.array<fmi2Real>( n ) ) {}
+	};
+
+	fmi2Status setRealInputDerivatives( fmi2Component c, const fmi2ValueReference vr[], size_t nvr,
+		const fmi2Integer order[], const fmi2Real value[] )
+	{
+		ForkedInstance* instance = static_cast<ForkedInstance*>( c );
+		Frame frame( instance->call_ );
+		DerivativeArgs args( frame, nvr );
+		if ( false == frame.ok() ) return instance->bufferTooSmall();
+
+		*args.nvr = nvr;
+		transfer( vr, args.vr, nvr );
+		transfer( order, args.order, nvr );
+		transfer( value, args.value, nvr );
+
+		return instance->call( setRealInputDerivativesCommand );
+	}
+
+	fmi2Status getRealOutputDerivatives( fmi2Component c, const fmi2ValueReference vr[], size_t nvr,
+		const fmi2Integer order[], fmi2Real value[] )
+	{
+		ForkedInstance* instance = static_cast<ForkedInstance*>( c );
+		Frame frame( instance->call_ );
+		DerivativeArgs args( frame, nvr );
+		if ( false == frame.ok() ) return instance->bufferTooSmall();
+
+		*args.nvr = nvr;
+		transfer( vr, args.vr, nvr );
+		transfer( order, args.order, nvr );
+
+		fmi2Status status = instance->call( getRealOutputDerivativesCommand );
+		transfer( args.value, value, nvr );
+		return status;
+	}
+
+	fmi2Status doStep( fmi2Component c, fmi2Real currentCommunicationPoint, fmi2Real communicationPointStepSize,
+		fmi2Boolean noSetFMUStatePriorToCurrentPoint )
+	{
+		ForkedInstance* instance = static_cast<ForkedInstance*>( c );
+		Frame frame( instance->call_ );
+		ScalarArgs<fmi2Real, fmi2Real, fmi2Boolean> args( frame );
+
+		*args.arg1 = currentCommunicationPoint;
+		*args.arg2 = communicationPointStepSize;
+		*args.arg3 = noSetFMUStatePriorToCurrentPoint;
+
+		return instance->call( doStepCommand );
+	}
+
+	fmi2Status getStringStatus( fmi2Component c, const fmi2StatusKind s, fmi2String* value )
+	{
+		ForkedInstance* instance = static_cast<ForkedInstance*>( c );
+		Frame frame( instance->call_ );
+		ScalarArgs<fmi2StatusKind> args( frame );
+
+		*args.arg1 = s;
+
+		fmi2Status status = instance->call( getStringStatusCommand );
+		if ( ( fmi2OK != status ) && ( fmi2Warning != status ) ) return status;
+
+		vector<fmi2String> strings;
+		frame.getStrings( 1, strings );
+		instance->statusString_ = strings[0];
+		*value = instance->statusString_.c_str();
+		return status;
+	}
+
+
+	fmi2Status ForkedInstance::execute( int command )
+	{
+		Frame frame( call_ );
+
+		switch ( command )
+		{
+
+		case setDebugLoggingCommand:
+		{
+			ScalarArgs<fmi2Boolean, size_t> args( frame );
+			vector<fmi2String> categories;
+			frame.getStrings( *args.arg2, categories );
+			return functions_->setDebugLogging( component_, *args.arg1, *args.arg2, categories.data() );
+		}
+
+		case setupExperimentCommand:
+		{
+			ScalarArgs<fmi2Boolean, fmi2Boolean> flags( frame );
+			ScalarArgs<fmi2Real, fmi2Real, fmi2Real> values( frame );
+			return functions_->setupExperiment( component_, *flags.arg1, *values.arg1, *values.arg2, *flags.arg2, *values.arg3 );
+		}
+
+		case enterInitializationModeCommand: return functions_->enterInitializationMode( component_ );
+		case exitInitializationModeCommand: return functions_->exitInitializationMode( component_ );
+		case terminateCommand: return functions_->terminate( component_ );
+		case resetCommand: return functions_->reset( component_ );
+
+		case getRealCommand: return executeValues<fmi2Real>( functions_->getReal, component_, call_ );
+		case getIntegerCommand: return executeValues<fmi2Integer>( functions_->getInteger, component_, call_ );
+		case getBooleanCommand: return executeValues<fmi2Boolean>( functions_->getBoolean, component_, call_ );
+		case setRealCommand: return executeValues<fmi2Real>( functions_->setReal, component_, call_ );
+		case setIntegerCommand: return executeValues<fmi2Integer>( functions_->setInteger, component_, call_ );
+		case setBooleanCommand: return executeValues<fmi2Boolean>( functions_->setBoolean, component_, call_ );
+
+		case getStringCommand:
+		{
+			size_t nvr = *frame.array<size_t>( 1 );
+			fmi2ValueReference* vr = frame.array<fmi2ValueReference>( nvr );
+
+			vector<fmi2String> value( nvr, static_cast<fmi2String>( 0 ) );
+			fmi2Status status = functions_->getString( component_, vr, nvr, value.data() );
+			if ( ( fmi2OK != status ) && ( fmi2Warning != status ) ) return status;
+
+			return frame.putStrings( value.data(), nvr ) ? status : fmi2Error;
+		}
+
+		case setStringCommand:
+		{
+			size_t nvr = *frame.array<size_t>( 1 );
+			fmi2ValueReference* vr = frame.array<fmi2ValueReference>( nvr );
+
+			vector<fmi2String> value;
+			frame.getStrings( nvr, value );
+			return functions_->setString( component_, vr, nvr, value.data() );
+		}
+
+		case getDirectionalDerivativeCommand:
+		{
+			size_t* n = frame.array<size_t>( 2 );
+			size_t nUnknown = n[0];
+			size_t nKnown = n[1];
+			Frame argsFrame( call_ ); // The arguments start with the sizes.
+			DirectionalDerivativeArgs args( argsFrame, nUnknown, nKnown );
+			return functions_->getDirectionalDerivative( component_, args.vUnknown, nUnknown,
+				args.vKnown, nKnown, args.dvKnown, args.dvUnknown );
+		}
+
+		case enterEventModeCommand: return functions_->enterEventMode( component_ );
+
+		case newDiscreteStatesCommand:
+		{
+			ScalarArgs<fmi2EventInfo> args( frame );
+			return functions_->newDiscreteStates( component_, args.arg1 );
+		}
+
+		case enterContinuousTimeModeCommand: return functions_->enterContinuousTimeMode( component_ );
+
+		case completedIntegratorStepCommand:
+		{
+			ScalarArgs<fmi2Boolean, fmi2Boolean, fmi2Boolean> args( frame );
+			return functions_->completedIntegratorStep( component_, *args.arg1, args.arg2, args.arg3 );
+		}
+
+		case setTimeCommand:
+		{
+			ScalarArgs<fmi2Real> args( frame );
+			return functions_->setTime( component_, *args.arg1 );
+		}
+
+		case setContinuousStatesCommand: return executeArray( functions_->setContinuousStates, component_, call_ );
+		case getDerivativesCommand: return executeArray( functions_->getDerivatives, component_, call_ );
+		case getEventIndicatorsCommand: return executeArray( functions_->getEventIndicators, component_, call_ );
+		case getContinuousStatesCommand: return executeArray( functions_->getContinuousStates, component_, call_ );
+		case getNominalsOfContinuousStatesCommand: return executeArray( functions_->getNominalsOfContinuousStates, component_, call_ );
+
+		case setRealInputDerivativesCommand:
+		case getRealOutputDerivativesCommand:
+		{
+			size_t nvr = *frame.array<size_t>( 1 );
+			Frame argsFrame( call_ ); // The arguments start with the size.
+			DerivativeArgs args( argsFrame, nvr );
+			return ( setRealInputDerivativesCommand == command ) ?
+				functions_->setRealInputDerivatives( component_, args.vr, nvr, args.order, args.value ) :
+				functions_->getRealOutputDerivatives( component_, args.vr, nvr, args.order, args.value );
+		}
+
+		case doStepCommand:
+		{
+			ScalarArgs<fmi2Real, fmi2Real, fmi2Boolean> args( frame );
+			return functions_->doStep( component_, *args.arg1, *args.arg2, *args.arg3 );
+		}
+
+		case cancelStepCommand: return functions_->cancelStep( component_ );
+
+		case getStatusCommand: return executeStatusValue<fmi2Status>( functions_->getStatus, component_, frame );
+		case getRealStatusCommand: return executeStatusValue<fmi2Real>( functions_->getRealStatus, component_, frame );
+		case getIntegerStatusCommand: return executeStatusValue<fmi2Integer>( functions_->getIntegerStatus, component_, frame );
+		case getBooleanStatusCommand: return executeStatusValue<fmi2Boolean>( functions_->getBooleanStatus, component_, frame );
+
+		case getStringStatusCommand:
+		{
+			ScalarArgs<fmi2StatusKind> args( frame );
+			fmi2String value = 0;
+			fmi2Status status = functions_->getStringStatus( component_, *args.arg1, &value );
+			if ( ( fmi2OK != status ) && ( fmi2Warning != status ) ) return status;
+
+			return frame.putStrings( &value, 1 ) ? status : fmi2Error;
+		}
+
+		default:
+			return fmi2Error;
+		}
+	}
+
+} // namespace
+
+
+fmippBoolean ForkedFMU::startForkServer()
+{
+	return ForkServer::get().start();
+}
+
+
+BareFMU2Ptr ForkedFMU::createForkedCopy( const BareFMU2Ptr& bareFMU )
+{
+	if ( !bareFMU || ( 0 == bareFMU->functions ) ) return BareFMU2Ptr();
+
+	// Helper processes can only be forked safely if the server has been started early enough.
+	if ( false == ForkServer::get().start() ) return BareFMU2Ptr();
+
+	// Forked copies of forked bare FMUs forward to the same functions.
+	const BareFMU2Ptr& forwardedFMU = bareFMU->forkedFMU ? bareFMU->forkedFMU : bareFMU;
+	const FMU2_functions* functions = forwardedFMU->functions;
+
+	// Copy the model description, locations etc., but not the function table.
+	BareFMU2Ptr forkedFMU = make_shared<BareFMU2>( *forwardedFMU );
+	forkedFMU->sharedFMU = forwardedFMU->sharedFMU ? forwardedFMU->sharedFMU : forwardedFMU;
+	forkedFMU->forkedFMU = forwardedFMU;
+	forkedFMU->dllCopyPath.clear(); // The copy of the shared library is owned by the forwarded bare FMU.
+
+	// Functions not provided by the FMU are not provided by the forked bare FMU either.
+	FMU2_functions* forwarding = new FMU2_functions();
+	forkedFMU->functions = forwarding;
+
+	forwarding->dllHandle = 0;
+	forwarding->getTypesPlatform = functions->getTypesPlatform;
+	forwarding->getVersion = functions->getVersion;
+	forwarding->instantiate = 0; // Use function ForkedFMU::instantiate instead.
+
+#define FMIPP_FORWARD( name, forwardingFunction ) \
+	forwarding->name = ( 0 != functions->name ) ? forwardingFunction : 0
+
+	FMIPP_FORWARD( setDebugLogging, setDebugLogging );
+	FMIPP_FORWARD( freeInstance, freeInstance );
+	FMIPP_FORWARD( setupExperiment, setupExperiment );
+	FMIPP_FORWARD( enterInitializationMode, forward<enterInitializationModeCommand> );
+	FMIPP_FORWARD( exitInitializationMode, forward<exitInitializationModeCommand> );
+	FMIPP_FORWARD( terminate, forward<terminateCommand> );
+	FMIPP_FORWARD( reset, forward<resetCommand> );
+
+	FMIPP_FORWARD( getReal, ( getValues<fmi2Real, getRealCommand> ) );
+	FMIPP_FORWARD( getInteger, ( getValues<fmi2Integer, getIntegerCommand> ) );
+	FMIPP_FORWARD( getBoolean, ( getValues<fmi2Boolean, getBooleanCommand> ) );
+	FMIPP_FORWARD( getString, getString );
+	FMIPP_FORWARD( setReal, ( setValues<fmi2Real, setRealCommand> ) );
+	FMIPP_FORWARD( setInteger, ( setValues<fmi2Integer, setIntegerCommand> ) );
+	FMIPP_FORWARD( setBoolean, ( setValues<fmi2Boolean, setBooleanCommand> ) );
+	FMIPP_FORWARD( setString, setString );
+
+	// FMU states are provided by the helper processes, even if the FMU does not provide them.
+	forwarding->getFMUstate = getFMUstate;
+	forwarding->setFMUstate = setFMUstate;
+	forwarding->freeFMUstate = freeFMUstate;
+	forwarding->serializedFMUstateSize = serializedFMUstateSize;
+	forwarding->serializeFMUstate = serializeFMUstate;
+	forwarding->deSerializeFMUstate = deSerializeFMUstate;
+
+	FMIPP_FORWARD( getDirectionalDerivative, getDirectionalDerivative );
+
+	FMIPP_FORWARD( enterEventMode, forward<enterEventModeCommand> );
+	FMIPP_FORWARD( newDiscreteStates, newDiscreteStates );
+	FMIPP_FORWARD( enterContinuousTimeMode, forward<enterContinuousTimeModeCommand> );
+	FMIPP_FORWARD( completedIntegratorStep, completedIntegratorStep );
+	FMIPP_FORWARD( setTime, setTime );
+	FMIPP_FORWARD( setContinuousStates, setArray<setContinuousStatesCommand> );
+	FMIPP_FORWARD( getDerivatives, getArray<getDerivativesCommand> );
+	FMIPP_FORWARD( getEventIndicators, getArray<getEventIndicatorsCommand> );
+	FMIPP_FORWARD( getContinuousStates, getArray<getContinuousStatesCommand> );
+	FMIPP_FORWARD( getNominalsOfContinuousStates, getArray<getNominalsOfContinuousStatesCommand> );
+
+	FMIPP_FORWARD( setRealInputDerivatives, setRealInputDerivatives );
+	FMIPP_FORWARD( getRealOutputDerivatives, getRealOutputDerivatives );
+	FMIPP_FORWARD( doStep, doStep );
+	FMIPP_FORWARD( cancelStep, forward<cancelStepCommand> );
+	FMIPP_FORWARD( getStatus, ( getStatusValue<fmi2Status, getStatusCommand> ) );
+	FMIPP_FORWARD( getRealStatus, ( getStatusValue<fmi2Real, getRealStatusCommand> ) );
+	FMIPP_FORWARD( getIntegerStatus, ( getStatusValue<fmi2Integer, getIntegerStatusCommand> ) );
+	FMIPP_FORWARD( getBooleanStatus, ( getStatusValue<fmi2Boolean, getBooleanStatusCommand> ) );
+	FMIPP_FORWARD( getStringStatus, getStringStatus );
+
+#undef FMIPP_FORWARD
+
+	return forkedFMU;
+}
+
+
+fmi2Component ForkedFMU::instantiate( const BareFMU2Ptr& bareFMU,
+	fmi2String instanceName, fmi2Type fmuType, fmi2String fmuGUID,
+	fmi2String fmuResourceLocation, const fmi2::fmi2CallbackFunctions* functions,
+	fmi2Boolean visible, fmi2Boolean loggingOn )
+{
+	if ( !bareFMU || !bareFMU->forkedFMU ) return 0;
+
+	ForkedInstance* instance = new ForkedInstance( bareFMU->forkedFMU->dllPath, instanceName, functions );
+
+	if ( ( false == instance->isOperational() ) ||
+		( false == instance->start( fmuType, fmuGUID, fmuResourceLocation, visible, loggingOn ) ) )
+	{
+		delete instance;
+		return 0;
+	}
+
+	return instance;
+}
+
+#endif
@@ -8,6 +8,12 @@
  */
 
 #include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
 
 #include <boost/property_tree/xml_parser.hpp>
 #include <boost/foreach.hpp>
@@ -18,58 +24,578 @@
 using namespace std;
 using namespace ModelDescriptionUtilities;
 
+
+namespace {
+
+	typedef vector< pair<fmippString, fmippString> > XMLAttributes;
+
+	/**
+	 * Minimal streaming ( SAX-style ) XML parser for model descriptions. For all elements,
+	 * the functions startElement( name, attributes ), text( text ) and endElement() of the
+	 * handler are called in document order. Comments, processing instructions, declarations
+	 * and CDATA sections are skipped. Throws runtime_error for malformed documents.
+	 */
+	class XMLScanner
+	{
+
+	public:
+
+		XMLScanner( const fmippString& xml ) : xml_( xml ), pos_( 0 ) {}
+
+		template<typename Handler>
+		void scan( Handler& handler )
+		{
+			vector<fmippString> openElements;
+			fmippString name;
+			XMLAttributes attributes;
+
+			while ( pos_ < xml_.size() ) {
+				if ( '<' != xml_[pos_] ) {
+					size_t end = min( xml_.find( '<', pos_ ), xml_.size() );
+					handler.text( decode( pos_, end ) );
+					pos_ = end;
+				} else if ( startsWith( "<!--" ) ) {
+					skipPast( "-->" );
+				} else if ( startsWith( "<?" ) ) {
+					skipPast( "?>" );
+				} else if ( startsWith( "<![CDATA[" ) ) {
+					skipPast( "]]>" );
+				} else if ( startsWith( "<!" ) ) {
+					skipPast( ">" );
+				} else if ( startsWith( "</" ) ) {
+					pos_ += 2;
+					readName( name );
+					skipSpace();
+					expect( '>' );
+					if ( openElements.empty() || ( openElements.back() != name ) )
+						throw runtime_error( "unexpected end tag: " + name );
+					openElements.pop_back();
+					handler.endElement();
+				} else {
+					++pos_;
+					readName( name );
+					readAttributes( attributes );
+					handler.startElement( name, attributes );
+					if ( '/' == xml_[pos_] ) {
+						++pos_;
+						expect( '>' );
+						handler.endElement();
+					} else {
+						expect( '>' );
+						openElements.push_back( name );
+					}
+				}
+			}
+
+			if ( !openElements.empty() )
+				throw runtime_error( "missing end tag: " + openElements.back() );
+		}
+
+	private:
+
+		bool startsWith( const char* s ) const {
+			return 0 == xml_.compare( pos_, char_traits<char>::length( s ), s );
+		}
+
+		void skipPast( const char* s ) {
+			size_t end = xml_.find( s, pos_ );
+			if ( fmippString::npos == end ) throw runtime_error( "unexpected end of document" );
+			pos_ = end + char_traits<char>::length( s );
+		}
+
+		void skipSpace() {
+			while ( ( pos_ < xml_.size() ) && isspace( static_cast<unsigned char>( xml_[pos_] ) ) ) ++pos_;
+		}
+
+		void expect( char c ) {
+			if ( ( pos_ >= xml_.size() ) || ( c != xml_[pos_] ) )
+				throw runtime_error( fmippString( "expected '" ) + c + "'" );
+			++pos_;
+		}
+
+		void readName( fmippString& name ) {
+			size_t begin = pos_;
+			while ( ( pos_ < xml_.size() ) && !isspace( static_cast<unsigned char>( xml_[pos_] ) ) &&
+				( 0 == strchr( "/>=", xml_[pos_] ) ) ) ++pos_;
+			if ( begin == pos_ ) throw runtime_error( "expected a name" );
+			name.assign( xml_, begin, pos_ - begin );
+		}
+
+		void readAttributes( XMLAttributes& attributes ) {
+			attributes.clear();
+			while ( true ) {
+				skipSpace();
+				if ( ( pos_ >= xml_.size() ) || ( '/' == xml_[pos_] ) || ( '>' == xml_[pos_] ) )
+					return;
+
+				fmippString name;
+				readName( name );
+				skipSpace();
+				expect( '=' );
+				skipSpace();
+
+				char quote = ( pos_ < xml_.size() ) ? xml_[pos_] : '\0';
+				if ( ( '"' != quote ) && ( '\'' != quote ) ) throw runtime_error( "expected a quote" );
+				size_t end = xml_.find( quote, pos_ + 1 );
+				if ( fmippString::npos == end ) throw runtime_error( "unexpected end of document" );
+				attributes.push_back( make_pair( name, decode( pos_ + 1, end ) ) );
+				pos_ = end + 1;
+			}
+		}
+
+		/// Replace the predefined entities and character references in xml_[begin,end).
+		fmippString decode( size_t begin, size_t end ) const {
+			fmippString result;
+			size_t amp = xml_.find( '&', begin );
+			if ( amp >= end ) return xml_.substr( begin, end - begin );
+
+			result.reserve( end - begin );
+			while ( begin < end ) {
+				amp = min( xml_.find( '&', begin ), end );
+				result.append( xml_, begin, amp - begin );
+				if ( amp == end ) break;
+
+				size_t semicolon = xml_.find( ';', amp );
+				if ( semicolon >= end ) throw runtime_error( "unterminated entity" );
+				fmippString entity = xml_.substr( amp + 1, semicolon - amp - 1 );
+				if ( "lt" == entity ) result += '<';
+				else if ( "gt" == entity ) result += '>';
+				else if ( "amp" == entity ) result += '&';
+				else if ( "quot" == entity ) result += '"';
+				else if ( "apos" == entity ) result += '\'';
+				else if ( ( entity.size() > 1 ) && ( '#' == entity[0] ) ) {
+					unsigned long code = ( 'x' == entity[1] ) ?
+						strtoul( entity.c_str() + 2, 0, 16 ) : strtoul( entity.c_str() + 1, 0, 10 );
+					appendUTF8( result, code );
+				} else throw runtime_error( "unknown entity: " + entity );
+				begin = semicolon + 1;
+			}
+			return result;
+		}
+
+		static void appendUTF8( fmippString& s, unsigned long code ) {
+			if ( code < 0x80 ) {
+				s += static_cast<char>( code );
+			} else if ( code < 0x800 ) {
+				s += static_cast<char>( 0xC0 | ( code >> 6 ) );
+				s += static_cast<char>( 0x80 | ( code & 0x3F ) );
+			} else if ( code < 0x10000 ) {
+				s += static_cast<char>( 0xE0 | ( code >> 12 ) );
+				s += static_cast<char>( 0x80 | ( ( code >> 6 ) & 0x3F ) );
+				s += static_cast<char>( 0x80 | ( code & 0x3F ) );
+			} else {
+				s += static_cast<char>( 0xF0 | ( code >> 18 ) );
+				s += static_cast<char>( 0x80 | ( ( code >> 12 ) & 0x3F ) );
+				s += static_cast<char>( 0x80 | ( ( code >> 6 ) & 0x3F ) );
+				s += static_cast<char>( 0x80 | ( code & 0x3F ) );
+			}
+		}
+
+		const fmippString& xml_;
+		size_t pos_;
+	};
+
+
+	/// Look up an attribute, returns 0 if it does not exist.
+	const fmippString* findAttribute( const XMLAttributes& attributes, const char* name )
+	{
+		for ( XMLAttributes::const_iterator it = attributes.begin(); it != attributes.end(); ++it )
+			if ( it->first == name ) return &it->second;
+		return 0;
+	}
+
+
+	FMIPPVariableCausality causalityFromString( const fmippString* causality, int version )
+	{
+		if ( 0 == causality ) return ( 1 == version ) ? fmippCausalityInternal : fmippCausalityLocal;
+		if ( "parameter" == *causality ) return fmippCausalityParameter;
+		if ( "calculatedParameter" == *causality ) return fmippCausalityCalculatedParameter;
+		if ( "input" == *causality ) return fmippCausalityInput;
+		if ( "output" == *causality ) return fmippCausalityOutput;
+		if ( "local" == *causality ) return fmippCausalityLocal;
+		if ( "independent" == *causality ) return fmippCausalityIndependent;
+		if ( "internal" == *causality ) return fmippCausalityInternal;
+		if ( "none" == *causality ) return fmippCausalityNone;
+		return fmippCausalityUnknown;
+	}
+
+
+	FMIPPVariableVariability variabilityFromString( const fmippString* variability )
+	{
+		if ( 0 == variability ) return fmippVariabilityContinuous;
+		if ( "constant" == *variability ) return fmippVariabilityConstant;
+		if ( "fixed" == *variability ) return fmippVariabilityFixed;
+		if ( "tunable" == *variability ) return fmippVariabilityTunable;
+		if ( "discrete" == *variability ) return fmippVariabilityDiscrete;
+		if ( "continuous" == *variability ) return fmippVariabilityContinuous;
+		if ( "parameter" == *variability ) return fmippVariabilityParameter;
+		return fmippVariabilityUnknown;
+	}
+
+
+	FMIPPVariableType typeFromString( const fmippString& type )
+	{
+		if ( "Real" == type ) return fmippTypeReal;
+		if ( "Integer" == type ) return fmippTypeInteger;
+		if ( "Boolean" == type ) return fmippTypeBoolean;
+		if ( "String" == type ) return fmippTypeString;
+		return fmippTypeUnknown;
+	}
+
+
+	const char* causalityToString( FMIPPVariableCausality causality )
+	{
+		switch ( causality ) {
+		case fmippCausalityParameter: return "parameter";
+		case fmippCausalityCalculatedParameter: return "calculatedParameter";
+		case fmippCausalityInput: return "input";
+		case fmippCausalityOutput: return "output";
+		case fmippCausalityLocal: return "local";
+		case fmippCausalityIndependent: return "independent";
+		case fmippCausalityInternal: return "internal";
+		case fmippCausalityNone: return "none";
+		default: return 0;
+		}
+	}
+
+
+	const char* variabilityToString( FMIPPVariableVariability variability )
+	{
+		switch ( variability ) {
+		case fmippVariabilityConstant: return "constant";
+		case fmippVariabilityFixed: return "fixed";
+		case fmippVariabilityTunable: return "tunable";
+		case fmippVariabilityDiscrete: return "discrete";
+		case fmippVariabilityContinuous: return "continuous";
+		case fmippVariabilityParameter: return "parameter";
+		default: return 0;
+		}
+	}
+
+
+	const char* typeToString( FMIPPVariableType type )
+	{
+		switch ( type ) {
+		case fmippTypeReal: return "Real";
+		case fmippTypeInteger: return "Integer";
+		case fmippTypeBoolean: return "Boolean";
+		case fmippTypeString: return "String";
+		default: return "Enumeration";
+		}
+	}
+
+
+	/**
+	 * Receives the elements of a model description from XMLScanner. The model variables and
+	 * the derivatives in ModelStructure are stored in flat tables, all other elements are
+	 * added to a PropertyTree with the same layout as created by boost::property_tree::read_xml.
+	 */
+	class ModelDescriptionHandler
+	{
+
+	public:
+
+		typedef ModelDescription::Properties Properties;
+
+		ModelDescriptionHandler( Properties& header, ModelVariableTable& variables,
+			fmippBoolean& hasModelVariables, fmippBoolean& hasDerivatives,
+			vector<fmippSize>& derivativeIndex, vector<fmippBoolean>& hasDependencies,
+			vector<fmippSize>& dependencyPtr, vector<fmippSize>& dependencies ) :
+			header_( header ), variables_( variables ),
+			hasModelVariables_( hasModelVariables ), hasDerivatives_( hasDerivatives ),
+			derivativeIndex_( derivativeIndex ), hasDependencies_( hasDependencies ),
+			dependencyPtr_( dependencyPtr ), dependencies_( dependencies ),
+			version_( 2 ), variable_( 0 )
+		{}
+
+		void startElement( const fmippString& name, const XMLAttributes& attributes )
+		{
+			const fmippSize depth = path_.size();
+			Properties* parent = nodes_.empty() ? &header_ : nodes_.back();
+			Properties* node = 0;
+
+			if ( ( 1 == depth ) && ( "ModelVariables" == name ) ) {
+				hasModelVariables_ = fmippTrue;
+			} else if ( ( 1 == depth ) && ( "ModelStructure" == name ) ) {
+				// the derivatives are stored below, other unknowns are only part of the complete view
+			} else if ( ( 2 == depth ) && ( "ModelVariables" == path_[1] ) ) {
+				if ( "ScalarVariable" == name ) addVariable( attributes );
+			} else if ( ( 3 == depth ) && ( "ModelVariables" == path_[1] ) ) {
+				if ( path_[2] == "ScalarVariable" ) setTypeInformation( name, attributes );
+			} else if ( ( 2 == depth ) && ( "ModelStructure" == path_[1] ) ) {
+				if ( "Derivatives" == name ) hasDerivatives_ = fmippTrue;
+			} else if ( ( 3 == depth ) && ( "ModelStructure" == path_[1] ) ) {
+				if ( ( "Derivatives" == path_[2] ) && ( "Unknown" == name ) ) addDerivative( attributes );
+			} else if ( 0 != parent ) {
+				node = &parent->push_back( make_pair( name, Properties() ) )->second;
+				if ( !attributes.empty() ) {
+					Properties& xmlattr = node->put_child( "<xmlattr>", Properties() );
+					for ( XMLAttributes::const_iterator it = attributes.begin(); it != attributes.end(); ++it )
+						xmlattr.push_back( make_pair( it->first, Properties( it->second ) ) );
+				}
+				if ( 0 == depth ) {
+					const fmippString* version = findAttribute( attributes, "fmiVersion" );
+					if ( ( 0 != version ) && ( "1.0" == *version ) ) version_ = 1;
+				}
+			}
+
+			path_.push_back( name );
+			nodes_.push_back( node );
+		}
+
+		void text( const fmippString& text )
+		{
+			if ( nodes_.empty() || ( 0 == nodes_.back() ) ) return;
+
+			// trim whitespace like read_xml( ..., trim_whitespace )
+			size_t begin = text.find_first_not_of( " \t\n\r" );
+			if ( fmippString::npos == begin ) return;
+			size_t end = text.find_last_not_of( " \t\n\r" );
+			nodes_.back()->data() += text.substr( begin, end - begin + 1 );
+		}
+
+		void endElement()
+		{
+			path_.pop_back();
+			nodes_.pop_back();
+		}
+
+	private:
+
+		void addVariable( const XMLAttributes& attributes )
+		{
+			const fmippString* name = findAttribute( attributes, "name" );
+			const fmippString* valueReference = findAttribute( attributes, "valueReference" );
+			const fmippString* description = findAttribute( attributes, "description" );
+			if ( ( 0 == name ) || ( 0 == valueReference ) )
+				throw runtime_error( "ScalarVariable without name or valueReference" );
+
+			variable_ = variables_.addVariable( *name,
+				static_cast<fmippValueReference>( strtoul( valueReference->c_str(), 0, 10 ) ),
+				description ? *description : fmippString(),
+				causalityFromString( findAttribute( attributes, "causality" ), version_ ),
+				variabilityFromString( findAttribute( attributes, "variability" ) ) );
+		}
+
+		void setTypeInformation( const fmippString& name, const XMLAttributes& attributes )
+		{
+			FMIPPVariableType type = typeFromString( name );
+			if ( ( fmippTypeUnknown == type ) && ( "Enumeration" != name ) ) return; // annotations etc.
+
+			const fmippString* derivative = findAttribute( attributes, "derivative" );
+			variables_.setTypeInformation( variable_, type, findAttribute( attributes, "start" ),
+				derivative ? strtoul( derivative->c_str(), 0, 10 ) : 0 );
+		}
+
+		void addDerivative( const XMLAttributes& attributes )
+		{
+			const fmippString* index = findAttribute( attributes, "index" );
+			const fmippString* dependencies = findAttribute( attributes, "dependencies" );
+			if ( 0 == index ) throw runtime_error( "Unknown without index" );
+
+			derivativeIndex_.push_back( strtoul( index->c_str(), 0, 10 ) );
+			hasDependencies_.push_back( 0 != dependencies );
+			if ( 0 != dependencies ) {
+				istringstream deps( *dependencies );
+				fmippSize known;
+				while ( deps >> known ) dependencies_.push_back( known );
+			}
+			dependencyPtr_.push_back( dependencies_.size() );
+		}
+
+		Properties& header_;
+		ModelVariableTable& variables_;
+		fmippBoolean& hasModelVariables_;
+		fmippBoolean& hasDerivatives_;
+		vector<fmippSize>& derivativeIndex_;
+		vector<fmippBoolean>& hasDependencies_;
+		vector<fmippSize>& dependencyPtr_;
+		vector<fmippSize>& dependencies_;
+
+		int version_; ///< FMI version, determines the default causality.
+		fmippSize variable_; ///< Index of the current ScalarVariable.
+		vector<fmippString> path_; ///< Names of the open elements.
+		vector<Properties*> nodes_; ///< Nodes of the open elements in the header, 0 if not stored there.
+	};
+}
+
+
 //
 // Implementation of class ModelDescription.
 // 
 
-ModelDescription::ModelDescription( const fmippString& xmlDescriptionFilePath )
+ModelDescription::ModelDescription() :
+	hasModelVariables_( fmippFalse ),
+	hasModelStructureDerivatives_( fmippFalse ),
+	dataLoaded_( fmippFalse ),
+	isValid_( fmippFalse ),
+	fmuType_( invalid )
+{}
+
+ModelDescription::ModelDescription( const fmippString& xmlDescriptionFilePath ) :
+	hasModelVariables_( fmippFalse ),
+	hasModelStructureDerivatives_( fmippFalse ),
+	dataLoaded_( fmippFalse ),
+	isValid_( fmippFalse ),
+	fmuType_( invalid )
 {
-	try {
-		using namespace boost::property_tree::xml_parser;
-		read_xml( xmlDescriptionFilePath, data_, trim_whitespace | no_comments );
-	} catch( ... ) {
-		isValid_ = fmippFalse;
+	parse( xmlDescriptionFilePath );
+}
+
+ModelDescription::ModelDescription( const fmippString& modelDescriptionURL, fmippBoolean& isValid ) :
+	hasModelVariables_( fmippFalse ),
+	hasModelStructureDerivatives_( fmippFalse ),
+	dataLoaded_( fmippFalse ),
+	isValid_( fmippFalse ),
+	fmuType_( invalid )
+{
+	isValid = fmippFalse;
+	fmippString xmlDescriptionFilePath;
+	if ( !PathFromUrl::getPathFromUrl( modelDescriptionURL, xmlDescriptionFilePath ) )
 		return;
+
+	parse( xmlDescriptionFilePath );
+
+	isValid = isValid_;
+}
+
+ModelDescription::ModelDescription( const fmippString& xmlDescriptionFilePath, const fmippString& xml ) :
+	hasModelVariables_( fmippFalse ),
+	hasModelStructureDerivatives_( fmippFalse ),
+	dataLoaded_( fmippFalse ),
+	isValid_( fmippFalse ),
+	fmuType_( invalid )
+{
+	parse( xmlDescriptionFilePath, xml );
+}
+
+
+// Parse the XML model description file.
+void
+ModelDescription::parse( const fmippString& xmlDescriptionFilePath )
+{
+	fmippString xml;
+	if ( readFile( xmlDescriptionFilePath, xml ) ) {
+		parse( xmlDescriptionFilePath, xml );
+	} else {
+		xmlDescriptionFilePath_ = xmlDescriptionFilePath;
+		isValid_ = fmippFalse;
 	}
+}
+
+
+// Parse the content of the XML model description file.
+void
+ModelDescription::parse( const fmippString& xmlDescriptionFilePath, const fmippString& xml )
+{
+	xmlDescriptionFilePath_ = xmlDescriptionFilePath;
+	dependencyPtr_.assign( 1, 0 );
 
 	try {
+		ModelDescriptionHandler handler( header_, variables_, hasModelVariables_,
+			hasModelStructureDerivatives_, derivativeIndex_, hasDependencies_,
+			dependencyPtr_, dependencies_ );
+		XMLScanner( xml ).scan( handler );
+		variables_.finalize();
+
 		// Sanity check.
-		isValid_ = hasChild( data_, "fmiModelDescription" );
-	} catch ( ... ) {
+		isValid_ = hasChild( header_, "fmiModelDescription" );
+	} catch( ... ) {
 		isValid_ = fmippFalse;
 		return;
 	}
 
-	detectFMUType();
+	if ( isValid_ ) detectFMUType();
 }
 
-ModelDescription::ModelDescription( const fmippString& modelDescriptionURL, fmippBoolean& isValid )
+
+// Read the content of a file.
+fmippBoolean
+ModelDescription::readFile( const fmippString& filePath, fmippString& content )
 {
-	isValid = fmippFalse;
-	fmippString xmlDescriptionFilePath;
-	isValid_ = PathFromUrl::getPathFromUrl( modelDescriptionURL, xmlDescriptionFilePath );
-	if ( !isValid_ )
-		return;
+	ifstream file( filePath.c_str(), ios::in | ios::binary );
+	if ( !file ) return fmippFalse;
 
-	try {
-		using namespace boost::property_tree::xml_parser;
-		read_xml( xmlDescriptionFilePath, data_, trim_whitespace | no_comments );
-	} catch( ... ) {
-		isValid_ = fmippFalse;
-		return;
+	ostringstream contents;
+	contents << file.rdbuf();
+	content = contents.str();
+	return fmippTrue;
+}
+
+
+// Get the complete model description as PropertyTree ( built on the first call ).
+const Properties&
+ModelDescription::getCompleteDescription() const
+{
+	lock_guard<mutex> lock( dataMutex_ );
+
+	if ( !dataLoaded_ ) {
+		try {
+			using namespace boost::property_tree::xml_parser;
+			read_xml( xmlDescriptionFilePath_, data_, trim_whitespace | no_comments );
+		} catch( ... ) {
+			// The file is not available ( e.g., description restored from the cache or parsed from
+			// an archive ), rebuild the complete description from the parsed elements instead.
+			data_.clear();
+			rebuildCompleteDescription( data_ );
+		}
+		dataLoaded_ = fmippTrue;
 	}
 
-	try {
-		// Sanity check.
-		isValid_ = hasChild( data_, "fmiModelDescription" );
-	} catch ( ... ) {
-		isValid_ = fmippFalse;
-		return;
+	return data_;
+}
+
+
+// Rebuild the complete model description as PropertyTree from the parsed elements.
+void
+ModelDescription::rebuildCompleteDescription( Properties& data ) const
+{
+	data = header_;
+
+	boost::optional<Properties&> root = data.get_child_optional( "fmiModelDescription" );
+	if ( !root ) return;
+
+	if ( hasModelVariables_ ) {
+		Properties& modelVariables = root->add_child( "ModelVariables", Properties() );
+
+		for ( fmippSize i = 0; i < variables_.size(); ++i )
+		{
+			Properties& variable = modelVariables.add_child( "ScalarVariable", Properties() );
+			Properties& attributes = variable.put_child( "<xmlattr>", Properties() );
+
+			attributes.put( "name", variables_.getName( i ) );
+			attributes.put( "valueReference", variables_.getValueReference( i ) );
+			if ( 0 != *variables_.getDescription( i ) )
+				attributes.put( "description", variables_.getDescription( i ) );
+			if ( const char* causality = causalityToString( variables_.getCausality( i ) ) )
+				attributes.put( "causality", causality );
+			if ( const char* variability = variabilityToString( variables_.getVariability( i ) ) )
+				attributes.put( "variability", variability );
+
+			Properties& type = variable.add_child( typeToString( variables_.getType( i ) ), Properties() );
+			if ( variables_.hasStart( i ) )
+				type.put( "<xmlattr>.start", variables_.getStartString( i ) );
+			if ( ModelVariableTable::npos != variables_.getDerivativeOf( i ) )
+				type.put( "<xmlattr>.derivative", variables_.getDerivativeOf( i ) + 1 );
+		}
 	}
 
-	detectFMUType();
-	
-	isValid = isValid_;
+	if ( hasModelStructureDerivatives_ ) {
+		Properties& derivatives = root->put_child( "ModelStructure.Derivatives", Properties() );
+
+		for ( fmippSize i = 0; i < derivativeIndex_.size(); ++i )
+		{
+			Properties& unknown = derivatives.add_child( "Unknown", Properties() );
+			unknown.put( "<xmlattr>.index", derivativeIndex_[i] );
+
+			if ( hasDependencies_[i] ) {
+				ostringstream dependencies;
+				for ( fmippSize k = dependencyPtr_[i]; k < dependencyPtr_[i+1]; ++k )
+					dependencies << ( ( k == dependencyPtr_[i] ) ? "" : " " ) << dependencies_[k];
+				unknown.put( "<xmlattr>.dependencies", dependencies.str() );
+			}
+		}
+	}
 }
 
 
@@ -85,7 +611,7 @@ ModelDescription::isValid() const
 const Properties&
 ModelDescription::getModelAttributes() const
 {
-	return data_.get_child( "fmiModelDescription.<xmlattr>" );
+	return header_.get_child( "fmiModelDescription.<xmlattr>" );
 }
 
 
@@ -93,7 +619,7 @@ ModelDescription::getModelAttributes() const
 const Properties&
 ModelDescription::getModelExchange() const
 {
-	return data_.get_child( "fmiModelDescription.ModelExchange" );
+	return header_.get_child( "fmiModelDescription.ModelExchange" );
 }
 
 
@@ -101,7 +627,7 @@ ModelDescription::getModelExchange() const
 const Properties&
 ModelDescription::getCoSimulation() const
 {
-	return data_.get_child( "fmiModelDescription.CoSimulation" );
+	return header_.get_child( "fmiModelDescription.CoSimulation" );
 }
 
 
@@ -109,7 +635,7 @@ ModelDescription::getCoSimulation() const
 const Properties&
 ModelDescription::getUnitDefinitions() const
 {
-	return data_.get_child( "fmiModelDescription.UnitDefinitions" );
+	return header_.get_child( "fmiModelDescription.UnitDefinitions" );
 }
 
 
@@ -117,7 +643,7 @@ ModelDescription::getUnitDefinitions() const
 const Properties&
 ModelDescription::getTypeDefinitions() const
 {
-	return data_.get_child( "fmiModelDescription.TypeDefinitions" );
+	return header_.get_child( "fmiModelDescription.TypeDefinitions" );
 }
 
 
@@ -133,7 +659,7 @@ ModelDescription::getDefaultExperiment( fmippTime& startTime, fmippTime& stopTim
 
 	// get the attributes since there are no other childs of DefaultExperient
 	// documented in the fmi standard
-	Properties defaultExperiment = getChildAttributes( data_, "fmiModelDescription.DefaultExperiment" );
+	Properties defaultExperiment = getChildAttributes( header_, "fmiModelDescription.DefaultExperiment" );
 
 	// read the childattributes defined in the documentation
 	if ( hasChild( defaultExperiment, "startTime" ) )
@@ -151,7 +677,7 @@ ModelDescription::getDefaultExperiment( fmippTime& startTime, fmippTime& stopTim
 const Properties&
 ModelDescription::getVendorAnnotations() const
 {
-	return data_.get_child( "fmiModelDescription.VendorAnnotations" );
+	return header_.get_child( "fmiModelDescription.VendorAnnotations" );
 }
 
 
@@ -159,7 +685,7 @@ ModelDescription::getVendorAnnotations() const
 const Properties&
 ModelDescription::getModelVariables() const
 {
-	return data_.get_child( "fmiModelDescription.ModelVariables" );
+	return getCompleteDescription().get_child( "fmiModelDescription.ModelVariables" );
 }
 
 
@@ -167,7 +693,7 @@ ModelDescription::getModelVariables() const
 const Properties&
 ModelDescription::getImplementation() const
 {
-	return data_.get_child( "fmiModelDescription.Implementation" );
+	return header_.get_child( "fmiModelDescription.Implementation" );
 }
 
 
@@ -199,7 +725,7 @@ ModelDescription::getVersion() const
 fmippBoolean
 ModelDescription::hasModelExchange() const
 {
-	return hasChild( data_, "fmiModelDescription.ModelExchange" );
+	return hasChild( header_, "fmiModelDescription.ModelExchange" );
 }
 
 
@@ -207,7 +733,7 @@ ModelDescription::hasModelExchange() const
 fmippBoolean
 ModelDescription::hasCoSimulation() const
 {
-	return hasChild( data_, "fmiModelDescription.CoSimulation" );
+	return hasChild( header_, "fmiModelDescription.CoSimulation" );
 }
 
 
@@ -215,7 +741,7 @@ ModelDescription::hasCoSimulation() const
 fmippBoolean
 ModelDescription::hasUnitDefinitions() const
 {
-	return hasChild( data_, "fmiModelDescription.UnitDefinitions" );
+	return hasChild( header_, "fmiModelDescription.UnitDefinitions" );
 }
 
 
@@ -223,7 +749,7 @@ ModelDescription::hasUnitDefinitions() const
 fmippBoolean
 ModelDescription::hasTypeDefinitions() const
 {
-	return hasChild( data_, "fmiModelDescription.TypeDefinitions" );
+	return hasChild( header_, "fmiModelDescription.TypeDefinitions" );
 }
 
 
@@ -231,7 +757,7 @@ ModelDescription::hasTypeDefinitions() const
 fmippBoolean
 ModelDescription::hasDefaultExperiment() const
 {
-	return hasChildAttributes( data_, "fmiModelDescription.DefaultExperiment" );
+	return hasChildAttributes( header_, "fmiModelDescription.DefaultExperiment" );
 }
 
 
@@ -239,7 +765,7 @@ ModelDescription::hasDefaultExperiment() const
 fmippBoolean
 ModelDescription::hasVendorAnnotations() const
 {
-	return hasChild( data_, "fmiModelDescription.VendorAnnotations" );
+	return hasChild( header_, "fmiModelDescription.VendorAnnotations" );
 }
 
 
@@ -247,7 +773,7 @@ ModelDescription::hasVendorAnnotations() const
 fmippBoolean
 ModelDescription::hasModelVariables() const
 {
-	return hasChild( data_, "fmiModelDescription.ModelVariables" );
+	return hasModelVariables_;
 }
 
 
@@ -257,7 +783,7 @@ ModelDescription::providesJacobian() const
 {
 	if ( 1 == getVersion() ) return fmippFalse;
 	// if the flag providesDirectionalDerivative exists, and is "true", return fmippTrue...
-	const Properties& attributes = getChildAttributes( data_, "fmiModelDescription.ModelExchange" );
+	const Properties& attributes = getChildAttributes( header_, "fmiModelDescription.ModelExchange" );
 	if ( hasChild( attributes, "providesDirectionalDerivative" ) ){
 		if ( attributes.get<fmippString>( "providesDirectionalDerivative" ) == "true" )
 			return fmippTrue;
@@ -267,11 +793,37 @@ ModelDescription::providesJacobian() const
 }
 
 
+// Check if the FMU can get and set its state.
+fmippBoolean
+ModelDescription::canGetAndSetFMUstate( fmippBoolean coSimulation ) const
+{
+	if ( 1 == getVersion() ) return fmippFalse;
+	const fmippString element = coSimulation ? "fmiModelDescription.CoSimulation" : "fmiModelDescription.ModelExchange";
+	if ( false == hasChild( header_, element ) ) return fmippFalse;
+	const Properties& attributes = getChildAttributes( header_, element );
+	return hasChild( attributes, "canGetAndSetFMUstate" ) &&
+		( attributes.get<fmippString>( "canGetAndSetFMUstate" ) == "true" );
+}
+
+
+// Check if the FMU can serialize its state.
+fmippBoolean
+ModelDescription::canSerializeFMUstate( fmippBoolean coSimulation ) const
+{
+	if ( 1 == getVersion() ) return fmippFalse;
+	const fmippString element = coSimulation ? "fmiModelDescription.CoSimulation" : "fmiModelDescription.ModelExchange";
+	if ( false == hasChild( header_, element ) ) return fmippFalse;
+	const Properties& attributes = getChildAttributes( header_, element );
+	return hasChild( attributes, "canSerializeFMUstate" ) &&
+		( attributes.get<fmippString>( "canSerializeFMUstate" ) == "true" );
+}
+
+
 // Check if model description has implementation element.
 fmippBoolean
 ModelDescription::hasImplementation() const
 {
-	return hasChild( data_, "fmiModelDescription.Implementation" );
+	return hasChild( header_, "fmiModelDescription.Implementation" );
 }
 
 
@@ -279,7 +831,7 @@ ModelDescription::hasImplementation() const
 fmippBoolean
 ModelDescription::hasVendorAnnotationsTool() const
 {
-	return hasChild( data_, "fmiModelDescription.VendorAnnotations.Tool" );
+	return hasChild( header_, "fmiModelDescription.VendorAnnotations.Tool" );
 }
 
 
@@ -289,27 +841,27 @@ ModelDescription::getModelIdentifier() const
 {
 	if ( ( fmuType_ == fmi_1_0_me ) || ( fmuType_ == fmi_1_0_cs ) )
 	{
-		const Properties& attributes = getChildAttributes( data_, "fmiModelDescription" );
+		const Properties& attributes = getChildAttributes( header_, "fmiModelDescription" );
 		return vector<fmippString>( 1, attributes.get<fmippString>( "modelIdentifier" ) );
 	}
 	else if ( fmuType_ == fmi_2_0_me )
 	{
-		const Properties& attributes = getChildAttributes( data_, "fmiModelDescription.ModelExchange" );
+		const Properties& attributes = getChildAttributes( header_, "fmiModelDescription.ModelExchange" );
 		return vector<fmippString>( 1, attributes.get<fmippString>( "modelIdentifier" ) );
 	}
 	else if ( fmuType_ == fmi_2_0_cs )
 	{
-		const Properties& attributes = getChildAttributes( data_, "fmiModelDescription.CoSimulation" );
+		const Properties& attributes = getChildAttributes( header_, "fmiModelDescription.CoSimulation" );
 		return vector<fmippString>( 1, attributes.get<fmippString>( "modelIdentifier" ) );
 	}
 	else if ( fmuType_ == fmi_2_0_me_and_cs )
 	{
 		vector<fmippString> res( 2 );
 
-		const Properties& attributesME = getChildAttributes( data_, "fmiModelDescription.ModelExchange" );
+		const Properties& attributesME = getChildAttributes( header_, "fmiModelDescription.ModelExchange" );
 		res[0] = attributesME.get<fmippString>( "modelIdentifier" );
 
-		const Properties& attributesCS = getChildAttributes( data_, "fmiModelDescription.CoSimulation" );
+		const Properties& attributesCS = getChildAttributes( header_, "fmiModelDescription.CoSimulation" );
 		res[1] = attributesCS.get<fmippString>( "modelIdentifier" );
 		
 		return res;
@@ -330,7 +882,7 @@ ModelDescription::hasModelIdentifier(const fmippString& modelIdentifier) const
 fmippString
 ModelDescription::getGUID() const
 {
-	const Properties& attributes = getChildAttributes( data_, "fmiModelDescription");
+	const Properties& attributes = getChildAttributes( header_, "fmiModelDescription");
 	return attributes.get<fmippString>( "guid" );
 }
 
@@ -343,10 +895,10 @@ ModelDescription::getMIMEType() const
 
 	if ( fmuType_ != fmi_1_0_cs ) return type;
 
-	if ( hasChild( data_, "fmiModelDescription.Implementation.CoSimulation_Tool.Model" ) )
+	if ( hasChild( header_, "fmiModelDescription.Implementation.CoSimulation_Tool.Model" ) )
 	{
 		const Properties& attributes =
-			getChildAttributes( data_, "fmiModelDescription.Implementation.CoSimulation_Tool.Model" );
+			getChildAttributes( header_, "fmiModelDescription.Implementation.CoSimulation_Tool.Model" );
 
 		type = attributes.get<fmippString>( "type" );
 	}
@@ -363,10 +915,10 @@ ModelDescription::getEntryPoint() const
 
 	if ( fmuType_ != fmi_1_0_cs ) return entryPoint;
 
-	if ( hasChild( data_, "fmiModelDescription.Implementation.CoSimulation_Tool.Model" ) )
+	if ( hasChild( header_, "fmiModelDescription.Implementation.CoSimulation_Tool.Model" ) )
 	{
 		const Properties& attributes =
-			getChildAttributes( data_, "fmiModelDescription.Implementation.CoSimulation_Tool.Model" );
+			getChildAttributes( header_, "fmiModelDescription.Implementation.CoSimulation_Tool.Model" );
 
 		entryPoint = attributes.get<fmippString>( "entryPoint" );
 	}
@@ -380,17 +932,13 @@ fmippSize
 ModelDescription::getNumberOfContinuousStates() const
 {
 	if ( 1 == getVersion() ) {
-		const Properties& attributes = getChildAttributes( data_, "fmiModelDescription");
+		const Properties& attributes = getChildAttributes( header_, "fmiModelDescription");
 		return attributes.get<fmippSize>( "numberOfContinuousStates" );
 	}
 
 	// in the 2.0 specification, the entry number OfContinuousStattes has been removed because of redundancy
 	// to get the number of continuous states, count the number of derivatives
-	if ( fmippFalse == hasChild( data_, "fmiModelDescription.ModelStructure.Derivatives" ) ) return 0;
-
-	const Properties& derivatives = data_.get_child("fmiModelDescription.ModelStructure.Derivatives");
-
-	return derivatives.size();
+	return derivativeIndex_.size();
 }
 
 
@@ -398,7 +946,7 @@ ModelDescription::getNumberOfContinuousStates() const
 fmippSize
 ModelDescription::getNumberOfEventIndicators() const
 {
-	const Properties& attributes = getChildAttributes( data_, "fmiModelDescription");
+	const Properties& attributes = getChildAttributes( header_, "fmiModelDescription");
 	return attributes.get<fmippSize>( "numberOfEventIndicators" );
 }
 
@@ -408,30 +956,23 @@ void
 ModelDescription::getNumberOfVariables( fmippSize& nReal, fmippSize& nInt,
 	fmippSize& nBool, fmippSize& nString ) const
 {
-	// Define XML tags to search for.
-	const fmippString xmlRealTag( "Real" );
-	const fmippString xmlIntTag( "Integer" );
-	const fmippString xmlBoolTag( "Boolean" );
-	const fmippString xmlStringTag( "String" );
-
 	// Reset counters.
 	nReal = 0;
 	nInt = 0;
 	nBool = 0;
 	nString = 0;
 
-	const Properties& modelVariables = getModelVariables();
-
-	BOOST_FOREACH( const Properties::value_type &v, modelVariables )
+	for ( fmippSize i = 0; i < variables_.size(); ++i )
 	{
-		if ( v.second.find( xmlRealTag ) != v.second.not_found() ) { ++nReal; continue; }
-		else if ( v.second.find( xmlIntTag ) != v.second.not_found() ) { ++nInt; continue; }
-		else if ( v.second.find( xmlBoolTag ) != v.second.not_found() ) { ++nBool; continue; }
-		else if ( v.second.find( xmlStringTag ) != v.second.not_found() ) { ++nString; continue; }
-		else {
-			fmippString error( "[ModelDescription::getNumberOfVariables] unknown type: " );
-			error += v.second.back().first;
-			throw runtime_error( error );
+		switch ( variables_.getType( i ) ) {
+			case fmippTypeReal: ++nReal; break;
+			case fmippTypeInteger: ++nInt; break;
+			case fmippTypeBoolean: ++nBool; break;
+			case fmippTypeString: ++nString; break;
+			default:
+				fmippString error( "[ModelDescription::getNumberOfVariables] unknown type of variable: " );
+				error += variables_.getName( i );
+				throw runtime_error( error );
 		}
 	}
 }
@@ -441,41 +982,57 @@ ModelDescription::getNumberOfVariables( fmippSize& nReal, fmippSize& nInt,
 void
 ModelDescription::getStatesAndDerivativesReferences( fmippValueReference* state_ref, fmippValueReference* der_ref ) const
 {
-	int i = 0;
-	const Properties& derivatives = data_.get_child( "fmiModelDescription.ModelStructure.Derivatives" );
+	// the derivatives are given by their ( 1-based ) indices in ModelVariables
+	for ( fmippSize i = 0; i < derivativeIndex_.size(); ++i )
+	{
+		const fmippSize derivative = derivativeIndex_[i] - 1;
+		der_ref[i] = variables_.getValueReference( derivative );
+		state_ref[i] = variables_.getValueReference( variables_.getDerivativeOf( derivative ) );
+	}
+}
 
-	// get the index attribute from all derivatives
-	BOOST_FOREACH( const Properties::value_type &v, derivatives )
-		{
-			der_ref[i]= v.second.get<unsigned int>( "<xmlattr>.index" );
-			i++;
-			continue;
-		}
-	const Properties& modelVariables = getModelVariables();
-	i = 0;
-	unsigned int j = 1;
 
-	// use the indices to get all value references. suppose the index vector is monotone
-	BOOST_FOREACH( const Properties::value_type & v, modelVariables )
-		{
-			if ( der_ref[i] == j ){
-				der_ref[i] = v.second.get<unsigned int>( "<xmlattr>.valueReference" );
-				state_ref[i] = v.second.get<unsigned int>( "Real.<xmlattr>.derivative" );
-				i++;
-				}
-			j++;
-			continue;
-		}
-	i = 0;
-	j = 1;
-	BOOST_FOREACH( const Properties::value_type & v, modelVariables )
-		{
-			if ( state_ref[i] == j ){
-				state_ref[i] = v.second.get<unsigned int>( "<xmlattr>.valueReference" );
-				i++;
+// Get the sparsity pattern of the Jacobian from the dependencies of the derivatives.
+fmippBoolean
+ModelDescription::getDerivativesDependencies( vector<fmippSize>& rowPtr, vector<fmippSize>& colInd ) const
+{
+	rowPtr.clear();
+	colInd.clear();
+
+	if ( 1 == getVersion() ) return fmippFalse;
+	if ( fmippFalse == hasModelStructureDerivatives_ ) return fmippFalse;
+	if ( find( hasDependencies_.begin(), hasDependencies_.end(), fmippTrue ) == hasDependencies_.end() )
+		return fmippFalse;
+
+	// Map the ( 1-based ) index of each derivative's state to the corresponding column of the Jacobian.
+	const fmippSize nStates = derivativeIndex_.size();
+	map<fmippSize, fmippSize> stateColumn;
+	for ( fmippSize j = 0; j < nStates; ++j ) {
+		fmippSize state = variables_.getDerivativeOf( derivativeIndex_[j] - 1 );
+		if ( ModelVariableTable::npos != state ) stateColumn[ state + 1 ] = j;
+	}
+
+	rowPtr.push_back( 0 );
+	for ( fmippSize i = 0; i < nStates; ++i )
+	{
+		vector<fmippSize> row;
+		if ( !hasDependencies_[i] ) {
+			// No dependency information: the derivative may depend on all states.
+			for ( fmippSize j = 0; j < nStates; ++j ) row.push_back( j );
+		} else {
+			for ( fmippSize k = dependencyPtr_[i]; k < dependencyPtr_[i+1]; ++k ) {
+				map<fmippSize, fmippSize>::const_iterator it = stateColumn.find( dependencies_[k] );
+				if ( it != stateColumn.end() ) row.push_back( it->second );
 			}
-			j++;
+			sort( row.begin(), row.end() );
+			row.erase( unique( row.begin(), row.end() ), row.end() );
 		}
+
+		colInd.insert( colInd.end(), row.begin(), row.end() );
+		rowPtr.push_back( colInd.size() );
+	}
+
+	return fmippTrue;
 }
 
 
@@ -484,7 +1041,7 @@ void
 ModelDescription::detectFMUType()
 {
 	// Get the FMI model description attributes.
-	const Properties& attributes = getChildAttributes( data_, "fmiModelDescription" );
+	const Properties& attributes = getChildAttributes( header_, "fmiModelDescription" );
 
 	if ( hasChild( attributes, "fmiVersion" ) )
 	{
@@ -492,7 +1049,7 @@ ModelDescription::detectFMUType()
 
 		if ( version == "1.0" )
 		{
-			if ( hasChild( data_, "fmiModelDescription.Implementation" ) ) {
+			if ( hasChild( header_, "fmiModelDescription.Implementation" ) ) {
 				fmuType_ = fmi_1_0_cs;
 				isValid_ = fmippTrue;
 				return;
@@ -504,16 +1061,16 @@ ModelDescription::detectFMUType()
 		}
 		else if ( version == "2.0" )
 		{
-			if ( hasChild( data_, "fmiModelDescription.CoSimulation" ) &&
-				 hasChild( data_, "fmiModelDescription.ModelExchange" ) ) {
+			if ( hasChild( header_, "fmiModelDescription.CoSimulation" ) &&
+				 hasChild( header_, "fmiModelDescription.ModelExchange" ) ) {
 				fmuType_ = fmi_2_0_me_and_cs;
 				isValid_ = fmippTrue;
 				return;
-			} else if ( hasChild( data_, "fmiModelDescription.ModelExchange" ) ) {
+			} else if ( hasChild( header_, "fmiModelDescription.ModelExchange" ) ) {
 				fmuType_ = fmi_2_0_me;
 				isValid_ = fmippTrue;
 				return;
-			} else if ( hasChild( data_, "fmiModelDescription.CoSimulation" ) ) {
+			} else if ( hasChild( header_, "fmiModelDescription.CoSimulation" ) ) {
 				fmuType_ = fmi_2_0_cs;
 				isValid_ = fmippTrue;
 				return;
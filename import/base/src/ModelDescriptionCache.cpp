@@ -0,0 +1,368 @@
+// -------------------------------------------------------------------
+// Copyright (c) 2013-2022, AIT Austrian Institute of Technology GmbH.
+// All rights reserved. See file FMIPP_LICENSE for details.
+// -------------------------------------------------------------------
+
+/**
+ * \file ModelDescriptionCache.cpp
+ */
+
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include "import/base/include/ModelDescription.h"
+#include "import/base/include/ModelDescriptionCache.h"
+
+using namespace std;
+
+
+namespace {
+
+	const char magic[8] = { 'F', 'M', 'I', 'P', 'P', 'M', 'D', '\0' };
+
+	const unsigned int byteOrderMark = 0x01020304;
+
+
+	/// 64-bit FNV-1a hash.
+	unsigned long long hashContent( const fmippString& s )
+	{
+		unsigned long long hash = 14695981039346656037ULL;
+		for ( fmippString::const_iterator it = s.begin(); it != s.end(); ++it ) {
+			hash ^= static_cast<unsigned char>( *it );
+			hash *= 1099511628211ULL;
+		}
+		return hash;
+	}
+
+
+	/// Serializes data into a byte buffer ( native byte order ).
+	class BinaryWriter
+	{
+
+	public:
+
+		template<typename T>
+		void write( const T& value ) {
+			buffer_.append( reinterpret_cast<const char*>( &value ), sizeof( T ) );
+		}
+
+		void writeString( const fmippString& s ) {
+			write<unsigned long long>( s.size() );
+			buffer_.append( s );
+		}
+
+		template<typename T>
+		void writeVector( const vector<T>& v ) {
+			write<unsigned long long>( v.size() );
+			if ( !v.empty() ) buffer_.append( reinterpret_cast<const char*>( &v[0] ), v.size()*sizeof( T ) );
+		}
+
+		void writeSizes( const vector<fmippSize>& v ) {
+			write<unsigned long long>( v.size() );
+			for ( vector<fmippSize>::const_iterator it = v.begin(); it != v.end(); ++it )
+				write<unsigned long long>( *it );
+		}
+
+		void writeBooleans( const vector<fmippBoolean>& v ) {
+			write<unsigned long long>( v.size() );
+			for ( vector<fmippBoolean>::const_iterator it = v.begin(); it != v.end(); ++it )
+				write<unsigned char>( *it ? 1 : 0 );
+		}
+
+		void writeTree( const ModelDescription::Properties& tree ) {
+			writeString( tree.data() );
+			write<unsigned long long>( tree.size() );
+			for ( ModelDescription::Properties::const_iterator it = tree.begin(); it != tree.end(); ++it ) {
+				writeString( it->first );
+				writeTree( it->second );
+			}
+		}
+
+		const fmippString& buffer() const { return buffer_; }
+
+	private:
+
+		fmippString buffer_;
+	};
+
+
+	/// Deserializes data written by BinaryWriter, throws runtime_error if the data is truncated.
+	class BinaryReader
+	{
+
+	public:
+
+		BinaryReader( const char* begin, fmippSize size ) : pos_( begin ), end_( begin + size ) {}
+
+		template<typename T>
+		T read() {
+			T value;
+			memcpy( &value, take( sizeof( T ) ), sizeof( T ) );
+			return value;
+		}
+
+		void readString( fmippString& s ) {
+			fmippSize n = readCount( 1 );
+			s.assign( take( n ), n );
+		}
+
+		template<typename T>
+		void readVector( vector<T>& v ) {
+			fmippSize n = readCount( sizeof( T ) );
+			v.resize( n );
+			if ( n > 0 ) memcpy( &v[0], take( n*sizeof( T ) ), n*sizeof( T ) );
+		}
+
+		void readSizes( vector<fmippSize>& v ) {
+			fmippSize n = readCount( sizeof( unsigned long long ) );
+			v.resize( n );
+			for ( fmippSize i = 0; i < n; ++i ) v[i] = static_cast<fmippSize>( read<unsigned long long>() );
+		}
+
+		void readBooleans( vector<fmippBoolean>& v ) {
+			fmippSize n = readCount( 1 );
+			v.resize( n );
+			for ( fmippSize i = 0; i < n; ++i ) v[i] = ( 0 != read<unsigned char>() );
+		}
+
+		void readTree( ModelDescription::Properties& tree ) {
+			readString( tree.data() );
+			fmippSize n = readCount( 2*sizeof( unsigned long long ) );
+			fmippString key;
+			for ( fmippSize i = 0; i < n; ++i ) {
+				readString( key );
+				readTree( tree.push_back( make_pair( key, ModelDescription::Properties() ) )->second );
+			}
+		}
+
+		bool atEnd() const { return pos_ == end_; }
+
+	private:
+
+		/// Read the number of elements of a container and check it against the remaining data.
+		fmippSize readCount( fmippSize minElementSize ) {
+			unsigned long long n = read<unsigned long long>();
+			if ( n > static_cast<unsigned long long>( end_ - pos_ )/minElementSize )
+				throw runtime_error( "corrupt cache file" );
+			return static_cast<fmippSize>( n );
+		}
+
+		const char* take( fmippSize n ) {
+			if ( static_cast<fmippSize>( end_ - pos_ ) < n ) throw runtime_error( "corrupt cache file" );
+			const char* p = pos_;
+			pos_ += n;
+			return p;
+		}
+
+		const char* pos_;
+		const char* end_;
+	};
+}
+
+
+const unsigned int ModelDescriptionCache::formatVersion = 1;
+
+
+ModelDescriptionCache::ModelDescriptionCache( const fmippString& directory ) :
+	directory_( directory ), hits_( 0 ), misses_( 0 )
+{}
+
+
+std::unique_ptr<ModelDescription>
+ModelDescriptionCache::load( const fmippString& xmlDescriptionFilePath )
+{
+	fmippString xml;
+	if ( !ModelDescription::readFile( xmlDescriptionFilePath, xml ) ) {
+		std::unique_ptr<ModelDescription> description( new ModelDescription );
+		description->xmlDescriptionFilePath_ = xmlDescriptionFilePath;
+		return description;
+	}
+
+	return load( xmlDescriptionFilePath, xml );
+}
+
+
+std::unique_ptr<ModelDescription>
+ModelDescriptionCache::load( const fmippString& xmlDescriptionFilePath, const fmippString& xml )
+{
+	std::unique_ptr<ModelDescription> description( new ModelDescription );
+
+	const unsigned long long hash = hashContent( xml );
+	const fmippString cacheFilePath = getCacheFilePath( xml, hash );
+
+	if ( read( cacheFilePath, hash, xml.size(), *description ) ) {
+		description->xmlDescriptionFilePath_ = xmlDescriptionFilePath;
+		++hits_;
+		return description;
+	}
+
+	// Not in the cache ( or the cache file is outdated ), parse the XML file.
+	description.reset( new ModelDescription );
+	description->parse( xmlDescriptionFilePath, xml );
+	++misses_;
+
+	if ( description->isValid() ) write( cacheFilePath, hash, xml.size(), *description );
+
+	return description;
+}
+
+
+fmippString
+ModelDescriptionCache::getCacheFilePath( const fmippString& xml, unsigned long long hash ) const
+{
+	// Use the GUID ( without braces etc. ) to make the cache files recognizable.
+	fmippString guid;
+	size_t pos = xml.find( "guid=" );
+	if ( ( fmippString::npos != pos ) && ( pos + 6 < xml.size() ) ) {
+		const char quote = xml[pos + 5];
+		for ( pos += 6; ( pos < xml.size() ) && ( quote != xml[pos] ) && ( guid.size() < 64 ); ++pos )
+			if ( isalnum( static_cast<unsigned char>( xml[pos] ) ) || ( '-' == xml[pos] ) ) guid += xml[pos];
+	}
+	if ( guid.empty() ) guid = "noguid";
+
+	ostringstream path;
+	path << directory_;
+	if ( !directory_.empty() && ( '/' != directory_[directory_.size() - 1] ) &&
+	     ( '\\' != directory_[directory_.size() - 1] ) ) path << '/';
+	path << guid << '-' << hex;
+	path.width( 16 );
+	path.fill( '0' );
+	path << hash << ".fmippmd";
+	return path.str();
+}
+
+
+bool
+ModelDescriptionCache::read( const fmippString& cacheFilePath, unsigned long long hash,
+	fmippSize xmlSize, ModelDescription& description ) const
+{
+	using namespace boost::interprocess;
+
+	try {
+		if ( !ifstream( cacheFilePath.c_str() ) ) return false;
+
+		file_mapping mapping( cacheFilePath.c_str(), read_only );
+		mapped_region region( mapping, read_only );
+		BinaryReader reader( static_cast<const char*>( region.get_address() ), region.get_size() );
+
+		char fileMagic[sizeof( magic )];
+		for ( fmippSize i = 0; i < sizeof( magic ); ++i ) fileMagic[i] = reader.read<char>();
+		if ( 0 != memcmp( fileMagic, magic, sizeof( magic ) ) ) return false;
+		if ( formatVersion != reader.read<unsigned int>() ) return false;
+		if ( byteOrderMark != reader.read<unsigned int>() ) return false;
+		if ( hash != reader.read<unsigned long long>() ) return false;
+		if ( xmlSize != reader.read<unsigned long long>() ) return false;
+
+		reader.readTree( description.header_ );
+
+		ModelVariableTable& variables = description.variables_;
+		reader.readVector( variables.pool_ );
+		reader.readVector( variables.name_ );
+		reader.readVector( variables.description_ );
+		reader.readVector( variables.startString_ );
+		reader.readVector( variables.valueReference_ );
+		reader.readVector( variables.type_ );
+		reader.readVector( variables.causality_ );
+		reader.readVector( variables.variability_ );
+		reader.readVector( variables.start_ );
+		reader.readVector( variables.derivativeOf_ );
+		variables.finalize();
+
+		const fmippSize n = variables.valueReference_.size();
+		if ( ( variables.name_.size() != n ) || ( variables.description_.size() != n ) ||
+		     ( variables.startString_.size() != n ) || ( variables.type_.size() != n ) ||
+		     ( variables.causality_.size() != n ) || ( variables.variability_.size() != n ) ||
+		     ( variables.start_.size() != n ) || ( variables.derivativeOf_.size() != n ) )
+			return false;
+
+		// all strings have to be zero-terminated strings within the pool
+		if ( variables.pool_.empty() || ( '\0' != variables.pool_.back() ) ) return false;
+		for ( fmippSize i = 0; i < n; ++i )
+			if ( ( variables.name_[i] >= variables.pool_.size() ) ||
+			     ( variables.description_[i] >= variables.pool_.size() ) ||
+			     ( variables.startString_[i] >= variables.pool_.size() ) ) return false;
+
+		description.hasModelVariables_ = ( 0 != reader.read<unsigned char>() );
+		description.hasModelStructureDerivatives_ = ( 0 != reader.read<unsigned char>() );
+		reader.readSizes( description.derivativeIndex_ );
+		reader.readBooleans( description.hasDependencies_ );
+		reader.readSizes( description.dependencyPtr_ );
+		reader.readSizes( description.dependencies_ );
+
+		if ( !reader.atEnd() ) return false;
+	} catch ( ... ) {
+		return false;
+	}
+
+	description.isValid_ = ModelDescriptionUtilities::hasChild( description.header_, "fmiModelDescription" );
+	if ( description.isValid_ ) description.detectFMUType();
+
+	return description.isValid_;
+}
+
+
+bool
+ModelDescriptionCache::write( const fmippString& cacheFilePath, unsigned long long hash,
+	fmippSize xmlSize, const ModelDescription& description ) const
+{
+	BinaryWriter writer;
+
+	for ( fmippSize i = 0; i < sizeof( magic ); ++i ) writer.write<char>( magic[i] );
+	writer.write<unsigned int>( formatVersion );
+	writer.write<unsigned int>( byteOrderMark );
+	writer.write<unsigned long long>( hash );
+	writer.write<unsigned long long>( xmlSize );
+
+	writer.writeTree( description.header_ );
+
+	const ModelVariableTable& variables = description.variables_;
+	writer.writeVector( variables.pool_ );
+	writer.writeVector( variables.name_ );
+	writer.writeVector( variables.description_ );
+	writer.writeVector( variables.startString_ );
+	writer.writeVector( variables.valueReference_ );
+	writer.writeVector( variables.type_ );
+	writer.writeVector( variables.causality_ );
+	writer.writeVector( variables.variability_ );
+	writer.writeVector( variables.start_ );
+	writer.writeVector( variables.derivativeOf_ );
+
+	writer.write<unsigned char>( description.hasModelVariables_ ? 1 : 0 );
+	writer.write<unsigned char>( description.hasModelStructureDerivatives_ ? 1 : 0 );
+	writer.writeSizes( description.derivativeIndex_ );
+	writer.writeBooleans( description.hasDependencies_ );
+	writer.writeSizes( description.dependencyPtr_ );
+	writer.writeSizes( description.dependencies_ );
+
+	// Write to a temporary file first, other processes may read the cache file concurrently.
+	ostringstream tmpFilePath;
+	tmpFilePath << cacheFilePath << '.' << std::hash<thread::id>()( this_thread::get_id() ) << ".tmp";
+
+	{
+		ofstream file( tmpFilePath.str().c_str(), ios::out | ios::binary | ios::trunc );
+		if ( !file ) return false;
+		file.write( writer.buffer().data(), writer.buffer().size() );
+		if ( !file ) {
+			file.close();
+			remove( tmpFilePath.str().c_str() );
+			return false;
+		}
+	}
+
+	if ( 0 != rename( tmpFilePath.str().c_str(), cacheFilePath.c_str() ) ) {
+		// e.g., another process has created the cache file in the meantime ( Windows )
+		remove( tmpFilePath.str().c_str() );
+		return false;
+	}
+
+	return true;
+}
@@ -0,0 +1,107 @@
+// -------------------------------------------------------------------
+// Copyright (c) 2013-2022, AIT Austrian Institute of Technology GmbH.
+// All rights reserved. See file FMIPP_LICENSE for details.
+// -------------------------------------------------------------------
+
+/**
+ * \file ModelEvaluationCache.cpp
+ */
+
+#include <algorithm>
+
+#include "import/base/include/ModelEvaluationCache.h"
+
+
+ModelEvaluationCache::ModelEvaluationCache( IntegratorStatistics& statistics ) :
+	statistics_( &statistics ), active_( false ), time_( 0 )
+{
+	invalidate();
+}
+
+
+void ModelEvaluationCache::invalidate()
+{
+	timeValid_ = false;
+	statesValid_ = false;
+	invalidateOutputs();
+}
+
+
+void ModelEvaluationCache::invalidateOutputs()
+{
+	derivativesValid_ = false;
+	eventIndicatorsValid_ = false;
+}
+
+
+bool ModelEvaluationCache::hasTime( fmippTime t )
+{
+	if ( !active_ || !timeValid_ || ( t != time_ ) ) return false;
+
+	++statistics_->skippedSetTime;
+	return true;
+}
+
+
+void ModelEvaluationCache::storeTime( fmippTime t )
+{
+	if ( !timeValid_ || ( t != time_ ) ) invalidateOutputs();
+
+	time_ = t;
+	timeValid_ = true;
+}
+
+
+bool ModelEvaluationCache::hasStates( const fmippReal* x, fmippSize n )
+{
+	if ( !active_ || !statesValid_ || ( states_.size() != n ) ||
+	     !std::equal( x, x + n, states_.begin() ) ) return false;
+
+	++statistics_->skippedSetStates;
+	return true;
+}
+
+
+void ModelEvaluationCache::storeStates( const fmippReal* x, fmippSize n )
+{
+	if ( !statesValid_ || ( states_.size() != n ) || !std::equal( x, x + n, states_.begin() ) ) {
+		invalidateOutputs();
+		states_.assign( x, x + n );
+	}
+
+	statesValid_ = true;
+}
+
+
+bool ModelEvaluationCache::getDerivatives( fmippReal* dx, fmippSize n )
+{
+	if ( !active_ || !derivativesValid_ || ( derivatives_.size() != n ) ) return false;
+
+	std::copy( derivatives_.begin(), derivatives_.end(), dx );
+	++statistics_->cachedDerivatives;
+	return true;
+}
+
+
+void ModelEvaluationCache::storeDerivatives( const fmippReal* dx, fmippSize n )
+{
+	derivatives_.assign( dx, dx + n );
+	derivativesValid_ = true;
+}
+
+
+bool ModelEvaluationCache::getEventIndicators( fmippReal* z, fmippSize n )
+{
+	if ( !active_ || !eventIndicatorsValid_ || ( eventIndicators_.size() != n ) ) return false;
+
+	std::copy( eventIndicators_.begin(), eventIndicators_.end(), z );
+	++statistics_->cachedEventIndicators;
+	return true;
+}
+
+
+void ModelEvaluationCache::storeEventIndicators( const fmippReal* z, fmippSize n )
+{
+	eventIndicators_.assign( z, z + n );
+	eventIndicatorsValid_ = true;
+}
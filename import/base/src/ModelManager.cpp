@@ -45,14 +45,26 @@
 #if defined( WIN32 ) // Windows
 #define _WIN32_WINNT 0x0502 // necessary for function SetDllDirectory in Windows
 #include <windows.h>
+#include <process.h>
 #include "shlwapi.h" // necessary for function PathRemoveFileSpec
+#else
+#include <unistd.h>
 #endif
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <chrono>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <sstream>
+#include <thread>
 #include <utility>
 
 #include "import/base/include/ModelManager.h"
+#include "import/base/include/FMUArchive.h"
+#include "import/base/include/ForkedFMU.h"
 #include "import/base/include/ModelDescription.h"
 #include "import/base/include/PathFromUrl.h"
 
@@ -62,7 +74,15 @@ ModelManager* ModelManager::modelManager_ = 0;
 
 ModelManager::~ModelManager()
 {
-	// No clean-up required:
+	// Wait for asynchronous loads to finish ( without locking, loader threads may need the lock ).
+	std::vector< std::future<void> > asyncLoaders;
+	{
+		lock_guard<std::mutex> lock( asyncLoadersMutex_ );
+		asyncLoaders.swap( asyncLoaders_ );
+	}
+	for ( std::future<void>& loader : asyncLoaders ) loader.wait();
+
+	// No further clean-up required:
 	//  - bare FMUs have their own destructors.
 	//  - destructors of bare FMUs will be called (from shared_ptr) when
 	//    the destructors of the maps they are contained in are called
@@ -72,14 +92,71 @@ ModelManager::~ModelManager()
 // Retrieve a reference to the unique ModelManager instance.
 ModelManager& ModelManager::getModelManager()
 {
-	// Singleton instance
+	// Singleton instance ( the initialization of local static variables is thread-safe ).
 	static ModelManager modelManagerInstance;
-	if ( 0 == modelManager_ ) {
-		modelManager_ = &modelManagerInstance;
-	}
-	return *modelManager_;
+	static ModelManager* const instance = ( modelManager_ = &modelManagerInstance );
+	return *instance;
+}
+
+// Enable or disable the on-disk cache of parsed model descriptions.
+void
+ModelManager::setModelDescriptionCacheDirectory( const std::string& directory )
+{
+	getModelManager();
+
+	std::shared_ptr<ModelDescriptionCache> cache;
+	if ( false == directory.empty() ) cache = make_shared<ModelDescriptionCache>( directory );
+
+	lock_guard<SharedMutex> lock( modelManager_->mutex_ );
+	modelManager_->descriptionCache_ = cache;
+}
+
+
+// Get the path of the model description cache directory.
+std::string
+ModelManager::getModelDescriptionCacheDirectory()
+{
+	getModelManager();
+
+	SharedLock lock( modelManager_->mutex_ );
+	return modelManager_->descriptionCache_ ? modelManager_->descriptionCache_->getDirectory() : std::string();
+}
+
+
+// Get the model description cache.
+const ModelDescriptionCache*
+ModelManager::getModelDescriptionCache()
+{
+	getModelManager();
+
+	SharedLock lock( modelManager_->mutex_ );
+	return modelManager_->descriptionCache_.get();
+}
+
+
+// Set the cache directory into which FMU archives are extracted.
+void
+ModelManager::setFMUExtractionDirectory( const std::string& directory )
+{
+	getModelManager();
+
+	lock_guard<SharedMutex> lock( modelManager_->mutex_ );
+	modelManager_->extractionDirectory_ = directory;
 }
 
+
+// Get the path of the cache directory into which FMU archives are extracted.
+std::string
+ModelManager::getFMUExtractionDirectory()
+{
+	getModelManager();
+
+	SharedLock lock( modelManager_->mutex_ );
+	return modelManager_->extractionDirectory_.empty() ?
+		FMUArchive::getDefaultCacheDirectory() : modelManager_->extractionDirectory_;
+}
+
+
 // Load an unzipped FMU into the model manager. It is assumed that the FMU has been unzipped into
 // a single directory and that the unzipped content follows the standard naming conventions.
 ModelManager::LoadFMUStatus
@@ -88,44 +165,41 @@ ModelManager::loadFMU( const std::string& modelIdentifier,
 	const fmippBoolean loggingOn,
 	FMUType& type )
 {
-	if ( 0 == modelManager_ ) getModelManager();
+	getModelManager();
 
 	type = invalid;
 
-	//	
-	// Check if FMU has already been loaded.
-	//
-
-	LoadFMUStatus status = getTypeOfLoadedFMU( modelIdentifier, &type );
-	if ( success == status ) return duplicate;
-
-	//
-	// Load new FMU.
-	// 
-
-	// Parse XML model description.
-	std::unique_ptr<ModelDescription> description;
-	status = loadModelDescription( fmuDirUrl, description );
-	if ( success != status ) return status;
+	// Load the FMU, unless it has already been loaded ( or is being loaded by another thread ).
+	return loadOnce( modelIdentifier, type, [&]() -> LoadFMUStatus
+	{
+		// Parse XML model description.
+		std::unique_ptr<ModelDescription> description;
+		LoadFMUStatus status = loadModelDescription( fmuDirUrl, description );
+		if ( success != status ) return status;
+
+		// Sanity check for model identifier.
+		if ( !description->hasModelIdentifier( modelIdentifier ) ) {
+			return identifier_invalid;
+		}
 
-	// Sanity check for model identifier.
-	if ( !description->hasModelIdentifier( modelIdentifier ) ) {
-		return identifier_invalid;
-	}
+		// The type of the FMU is determined by the model description.
+		type = description->getFMUType();
 
-	// The type of the FMU is determined by the model description.
-	type = description->getFMUType();
+		// Extract FMU archives.
+		std::string extractedDirUrl;
+		status = extractFMU( fmuDirUrl, extractedDirUrl );
+		if ( success != status ) return status;
 
-	// Load DLLs and BareFMU
-	status = loadBareFMU(std::move(description), fmuDirUrl, modelIdentifier);
-	return status;
+		// Load DLLs and BareFMU
+		return loadBareFMU( std::move( description ), extractedDirUrl, modelIdentifier );
+	} );
 }	
 
 ModelManager::LoadFMUStatus
 ModelManager::loadFMU(const std::string& fmuDirUrl,
 	const fmippBoolean loggingOn, FMUType& type, std::string& modelIdentifier)
 {
-	if ( 0 == modelManager_ ) getModelManager();
+	getModelManager();
 
 	// Parse XML model description.
 	std::unique_ptr<ModelDescription> description;
@@ -137,25 +211,87 @@ ModelManager::loadFMU(const std::string& fmuDirUrl,
 	modelIdentifier = description->getModelIdentifier()[0];
 	type = description->getFMUType();
 
-	// Check whether the model was previously loaded
+	// Load DLLs and BareFMU, unless the model was previously loaded.
 	FMUType refType = type;
-	status = getTypeOfLoadedFMU( modelIdentifier, &refType );
-	assert(type == refType); // Assume consistency with description
-	if ( status == success ) return duplicate;
-
-	// Load DLLs and BareFMU
-	status = loadBareFMU(std::move(description), fmuDirUrl, modelIdentifier);
+	status = loadOnce( modelIdentifier, refType, [&]() -> LoadFMUStatus
+	{
+		// Extract FMU archives.
+		std::string extractedDirUrl;
+		LoadFMUStatus extractStatus = extractFMU( fmuDirUrl, extractedDirUrl );
+		if ( success != extractStatus ) return extractStatus;
+
+		return loadBareFMU( std::move( description ), extractedDirUrl, modelIdentifier );
+	} );
+	assert( ( duplicate != status ) || ( type == refType ) ); // Assume consistency with description
 	return status;
 }
 
+// Load a batch of unzipped FMUs asynchronously, using a bounded number of threads.
+std::vector<ModelManager::LoadFMUFuture>
+ModelManager::loadFMUsAsync( const std::vector<std::string>& fmuDirUrls,
+	const fmippBoolean loggingOn, unsigned int maxThreads )
+{
+	getModelManager();
+
+	// State shared by the loader threads of this batch.
+	struct Batch {
+		std::vector<std::string> fmuDirUrls;
+		std::vector< std::promise<LoadFMUResult> > results;
+		std::atomic<size_t> next;
+	};
+
+	std::shared_ptr<Batch> batch = make_shared<Batch>();
+	batch->fmuDirUrls = fmuDirUrls;
+	batch->results.resize( fmuDirUrls.size() );
+	batch->next = 0;
+
+	std::vector<LoadFMUFuture> futures;
+	for ( std::promise<LoadFMUResult>& result : batch->results ) {
+		futures.push_back( result.get_future().share() );
+	}
+
+	if ( 0 == maxThreads ) maxThreads = std::max( 1u, std::thread::hardware_concurrency() );
+	const size_t nThreads = std::min<size_t>( maxThreads, fmuDirUrls.size() );
+
+	lock_guard<std::mutex> lock( modelManager_->asyncLoadersMutex_ );
+
+	// Forget about loader threads of previous batches that have finished.
+	modelManager_->asyncLoaders_.erase( std::remove_if( modelManager_->asyncLoaders_.begin(),
+		modelManager_->asyncLoaders_.end(), []( const std::future<void>& loader ) {
+			return std::future_status::ready == loader.wait_for( std::chrono::seconds( 0 ) );
+		} ), modelManager_->asyncLoaders_.end() );
+
+	// Each loader thread takes the next FMU of the batch until all FMUs have been loaded.
+	for ( size_t t = 0; t < nThreads; ++t ) {
+		modelManager_->asyncLoaders_.push_back( std::async( std::launch::async, [batch, loggingOn]()
+		{
+			for ( size_t i = batch->next++; i < batch->fmuDirUrls.size(); i = batch->next++ ) {
+				try {
+					LoadFMUResult result;
+					result.type = invalid;
+					result.status = loadFMU( batch->fmuDirUrls[i], loggingOn, result.type, result.modelIdentifier );
+					batch->results[i].set_value( result );
+				} catch ( ... ) {
+					// Report the exception to the caller and continue with the next FMU.
+					batch->results[i].set_exception( std::current_exception() );
+				}
+			}
+		} ) );
+	}
+
+	return futures;
+}
+
 // Unload an FMU from the model manager. It must not be in use. 
 ModelManager::UnloadFMUStatus
 ModelManager::unloadFMU( const std::string& modelIdentifier )
 {
-	if ( 0 == modelManager_ ) getModelManager();
+	getModelManager();
 
 	ModelManager::UnloadFMUStatus status;
 
+	lock_guard<SharedMutex> lock( modelManager_->mutex_ );
+
 	status = unloadFMU( modelIdentifier, modelManager_->modelCollection_ );
 	if ( ModelManager::not_found != status ) return status;
 
@@ -170,7 +306,9 @@ ModelManager::unloadFMU( const std::string& modelIdentifier )
 ModelManager::UnloadFMUStatus
 ModelManager::unloadAllFMUs()
 {
-	if ( 0 == modelManager_ ) getModelManager();
+	getModelManager();
+
+	lock_guard<SharedMutex> lock( modelManager_->mutex_ );
 
 	UnloadFMUStatus status = unloadAllFMUs(modelManager_->modelCollection_);
 	if ( ok != status ) return status;
@@ -186,50 +324,260 @@ ModelManager::unloadAllFMUs()
 BareFMUModelExchangePtr
 ModelManager::getModel( const std::string& modelIdentifier )
 {
-	if ( 0 == modelManager_ ) getModelManager();
+	getModelManager();
+
+	BareFMUModelExchangePtr bareFMU;
+	bool isolated = false;
+	{
+		SharedLock lock( modelManager_->mutex_ );
 
-	BareModelCollection::iterator itFind = modelManager_->modelCollection_.find( modelIdentifier );
-	if ( itFind != modelManager_->modelCollection_.end() ) { // Model identifier found in list.
-		return itFind->second;
+		BareModelCollection::iterator itFind = modelManager_->modelCollection_.find( modelIdentifier );
+		if ( itFind != modelManager_->modelCollection_.end() ) { // Model identifier found in list.
+			bareFMU = itFind->second;
+			isolated = ( 0 != modelManager_->isolatedFMUs_.count( modelIdentifier ) );
+		}
 	}
-	
-	return BareFMUModelExchangePtr();
+
+	// Load a private copy of the shared library ( without holding the lock ).
+	return isolated ? isolate( bareFMU ) : bareFMU;
 }
 
 // Get slave (FMI CS 1.0).
 BareFMUCoSimulationPtr
 ModelManager::getSlave( const std::string& modelIdentifier )
 {
-	if ( 0 == modelManager_ ) getModelManager();
+	getModelManager();
 
-	BareSlaveCollection::iterator itFind = modelManager_->slaveCollection_.find( modelIdentifier );
-	if ( itFind != modelManager_->slaveCollection_.end() ) { // Model identifier found in list.
-		return itFind->second;
+	BareFMUCoSimulationPtr bareFMU;
+	bool isolated = false;
+	{
+		SharedLock lock( modelManager_->mutex_ );
+
+		BareSlaveCollection::iterator itFind = modelManager_->slaveCollection_.find( modelIdentifier );
+		if ( itFind != modelManager_->slaveCollection_.end() ) { // Model identifier found in list.
+			bareFMU = itFind->second;
+			isolated = ( 0 != modelManager_->isolatedFMUs_.count( modelIdentifier ) );
+		}
 	}
-	
-	return BareFMUCoSimulationPtr();
+
+	// Load a private copy of the shared library ( without holding the lock ).
+	return isolated ? isolate( bareFMU ) : bareFMU;
 }
 
 // Get instance (FMI ME/CS 2.0).
 BareFMU2Ptr
 ModelManager::getInstance( const std::string& modelIdentifier )
 {
-	if ( 0 == modelManager_ ) getModelManager();
+	getModelManager();
+
+	BareFMU2Ptr bareFMU;
+	bool isolated = false;
+	bool forked = false;
+	{
+		SharedLock lock( modelManager_->mutex_ );
 
-	BareInstanceCollection::iterator itFind = modelManager_->instanceCollection_.find( modelIdentifier );
-	if ( itFind != modelManager_->instanceCollection_.end() ) { // Model identifier found in list.
-		return itFind->second;
+		BareInstanceCollection::iterator itFind = modelManager_->instanceCollection_.find( modelIdentifier );
+		if ( itFind != modelManager_->instanceCollection_.end() ) { // Model identifier found in list.
+			bareFMU = itFind->second;
+			isolated = ( 0 != modelManager_->isolatedFMUs_.count( modelIdentifier ) );
+			forked = ( 0 != modelManager_->forkedFMUs_.count( modelIdentifier ) );
+		}
 	}
 
-	return BareFMU2Ptr();
+	// Load a private copy of the shared library ( without holding the lock ).
+	if ( isolated ) bareFMU = isolate( bareFMU );
+
+	return ( forked && bareFMU ) ? ForkedFMU::createForkedCopy( bareFMU ) : bareFMU;
+}
+
+// Enable or disable isolated instances of an FMU.
+void
+ModelManager::setIsolatedInstances( const std::string& modelIdentifier, fmippBoolean isolated )
+{
+	getModelManager();
+
+	lock_guard<SharedMutex> lock( modelManager_->mutex_ );
+	if ( isolated ) {
+		modelManager_->isolatedFMUs_.insert( modelIdentifier );
+	} else {
+		modelManager_->isolatedFMUs_.erase( modelIdentifier );
+	}
+}
+
+// Check if isolated instances are enabled for an FMU.
+fmippBoolean
+ModelManager::hasIsolatedInstances( const std::string& modelIdentifier )
+{
+	getModelManager();
+
+	SharedLock lock( modelManager_->mutex_ );
+	return 0 != modelManager_->isolatedFMUs_.count( modelIdentifier );
+}
+
+// Enable or disable forked instances of an FMU.
+void
+ModelManager::setForkedInstances( const std::string& modelIdentifier, fmippBoolean forked )
+{
+	getModelManager();
+
+	// Forked instances are usually enabled before other threads are started.
+	if ( forked ) ForkedFMU::startForkServer();
+
+	lock_guard<SharedMutex> lock( modelManager_->mutex_ );
+	if ( forked ) {
+		modelManager_->forkedFMUs_.insert( modelIdentifier );
+	} else {
+		modelManager_->forkedFMUs_.erase( modelIdentifier );
+	}
+}
+
+// Check if forked instances are enabled for an FMU.
+fmippBoolean
+ModelManager::hasForkedInstances( const std::string& modelIdentifier )
+{
+	getModelManager();
+
+	SharedLock lock( modelManager_->mutex_ );
+	return 0 != modelManager_->forkedFMUs_.count( modelIdentifier );
+}
+
+// Get a new bare FMU using a private copy of the shared library (FMI ME 1.0).
+BareFMUModelExchangePtr
+ModelManager::getIsolatedCopy( const BareFMUModelExchangePtr& bareFMU )
+{
+	return isolate( bareFMU );
+}
+
+// Get a new bare FMU using a private copy of the shared library (FMI CS 1.0).
+BareFMUCoSimulationPtr
+ModelManager::getIsolatedCopy( const BareFMUCoSimulationPtr& bareFMU )
+{
+	return isolate( bareFMU );
+}
+
+// Get a new bare FMU using a private copy of the shared library (FMI ME/CS 2.0).
+BareFMU2Ptr
+ModelManager::getIsolatedCopy( const BareFMU2Ptr& bareFMU )
+{
+	return isolate( bareFMU );
+}
+
+// Get a new bare FMU whose instances run in helper processes (FMI ME/CS 2.0).
+BareFMU2Ptr
+ModelManager::getForkedCopy( const BareFMU2Ptr& bareFMU )
+{
+	return ForkedFMU::createForkedCopy( bareFMU );
 }
 
 ModelManager::LoadFMUStatus
 ModelManager::getTypeOfLoadedFMU( const std::string& modelIdentifier, 
 	FMUType* dest )
 {
-	if ( 0 == modelManager_ ) getModelManager();
+	getModelManager();
+
+	SharedLock lock( modelManager_->mutex_ );
+	return findLoadedFMU( modelIdentifier, dest );
+}
+
+long
+ModelManager::getUseCount( const std::string& modelIdentifier )
+{
+	getModelManager();
+
+	SharedLock lock( modelManager_->mutex_ );
+
+	BareModelCollection::iterator itFindModel = modelManager_->modelCollection_.find( modelIdentifier );
+	if ( itFindModel != modelManager_->modelCollection_.end() ) return itFindModel->second.use_count();
+
+	BareSlaveCollection::iterator itFindSlave = modelManager_->slaveCollection_.find( modelIdentifier );
+	if ( itFindSlave != modelManager_->slaveCollection_.end() ) return itFindSlave->second.use_count();
+
+	BareInstanceCollection::iterator itFindInstance = modelManager_->instanceCollection_.find( modelIdentifier );
+	if ( itFindInstance != modelManager_->instanceCollection_.end() ) return itFindInstance->second.use_count();
+
+	return 0;
+}
+
+ModelManager::LoadFMUStatus
+ModelManager::loadOnce( const std::string& modelIdentifier, FMUType& type,
+	const std::function<LoadFMUStatus()>& load )
+{
+	// Fast path: the FMU has already been loaded.
+	if ( success == getTypeOfLoadedFMU( modelIdentifier, &type ) ) return duplicate;
+
+	std::promise<LoadFMUStatus> loadStatus;
+	std::shared_future<LoadFMUStatus> pendingLoad;
+	{
+		lock_guard<SharedMutex> lock( modelManager_->mutex_ );
+
+		// Check again, the FMU may have been loaded in the meantime.
+		if ( success == findLoadedFMU( modelIdentifier, &type ) ) return duplicate;
+
+		PendingLoadCollection::iterator itFind = modelManager_->pendingLoads_.find( modelIdentifier );
+		if ( itFind != modelManager_->pendingLoads_.end() ) {
+			pendingLoad = itFind->second;
+		} else {
+			modelManager_->pendingLoads_[modelIdentifier] = loadStatus.get_future().share();
+		}
+	}
+
+	if ( pendingLoad.valid() ) {
+		// Another thread is loading this FMU, wait for it to finish.
+		LoadFMUStatus status = pendingLoad.get();
+		if ( success != status ) return status;
+
+		getTypeOfLoadedFMU( modelIdentifier, &type );
+		return duplicate;
+	}
+
+	// This thread loads the FMU, without locking the model manager.
+	LoadFMUStatus status = failed;
+	std::exception_ptr error;
+	try {
+		status = load();
+	} catch ( ... ) {
+		// Remove the pending load and notify the waiting threads before rethrowing.
+		error = std::current_exception();
+	}
+
+	{
+		lock_guard<SharedMutex> lock( modelManager_->mutex_ );
+		modelManager_->pendingLoads_.erase( modelIdentifier );
+	}
+
+	loadStatus.set_value( status );
+
+	if ( error ) std::rethrow_exception( error );
+	return status;
+}
+
+ModelManager::LoadFMUStatus
+ModelManager::extractFMU( const std::string& fmuUrl, std::string& fmuDirUrl )
+{
+	if ( false == FMUArchive::isArchive( fmuUrl ) ) {
+		fmuDirUrl = fmuUrl;
+		return success;
+	}
+
+	string archivePath;
+	if ( false == PathFromUrl::getPathFromUrl( fmuUrl, archivePath ) ) return archive_invalid;
+
+	// The extracted shared libraries are loaded, hence only a private cache directory can be used.
+	const string cacheDirectory = getFMUExtractionDirectory();
+	if ( false == FMUArchive::makeCacheDirectory( cacheDirectory ) ) return archive_invalid;
 
+	FMUArchive archive( archivePath );
+	const string dirPath = archive.getExtractionPath( cacheDirectory );
+	if ( false == archive.extract( dirPath ) ) return archive_invalid;
+
+	if ( false == PathFromUrl::getUrlFromPath( dirPath, fmuDirUrl ) ) return archive_invalid;
+	return success;
+}
+
+ModelManager::LoadFMUStatus
+ModelManager::findLoadedFMU( const std::string& modelIdentifier,
+	FMUType* dest )
+{
 	// Write the result locally, in case it is not needed
 	FMUType dummyDest;
 	if (!dest) dest = &dummyDest;
@@ -254,6 +602,24 @@ ModelManager::getTypeOfLoadedFMU( const std::string& modelIdentifier,
 	return failed;
 }
 
+template<typename BareFMUType>
+std::shared_ptr<BareFMUType>
+ModelManager::isolate( const std::shared_ptr<BareFMUType>& bareFMU )
+{
+	if ( !bareFMU ) return bareFMU;
+
+	// Copies of isolated bare FMUs refer to the bare FMU owning the model description.
+	const std::shared_ptr<BareFMUType>& sharedFMU = bareFMU->sharedFMU ? bareFMU->sharedFMU : bareFMU;
+
+	// Copy the model description, locations etc., but not the function table ( owned by the shared bare FMU ).
+	std::shared_ptr<BareFMUType> isolatedFMU = make_shared<BareFMUType>( *sharedFMU );
+	isolatedFMU->functions = 0;
+	isolatedFMU->sharedFMU = sharedFMU;
+
+	if ( 0 == loadDll( isolatedFMU->dllPath, isolatedFMU, true ) ) return std::shared_ptr<BareFMUType>();
+	return isolatedFMU;
+}
+
 ModelManager::LoadFMUStatus 
 ModelManager::loadBareFMU(
 	std::unique_ptr<ModelDescription> description,
@@ -275,11 +641,13 @@ ModelManager::loadBareFMU(
 	{
 		BareFMUModelExchangePtr bareFMU = make_shared<BareFMUModelExchange>();
 		bareFMU->description = description.release();
+		bareFMU->dllPath = dllPath;
 
 		// Loading the DLL may fail. In this case do not add it to list of models.
 		if ( 0 == loadDll( dllPath, bareFMU ) ) return shared_lib_load_failed;
 		
 		// Add bare FMU to list.
+		lock_guard<SharedMutex> lock( modelManager_->mutex_ );
 		modelManager_->modelCollection_[modelIdentifier] = bareFMU;
 
 		return success;
@@ -288,6 +656,7 @@ ModelManager::loadBareFMU(
 	{
 		BareFMUCoSimulationPtr bareFMU = make_shared<BareFMUCoSimulation>();
 		bareFMU->description = description.release();
+		bareFMU->dllPath = dllPath;
 
 		bareFMU->fmuLocation = fmuDirUrl;
 
@@ -295,6 +664,7 @@ ModelManager::loadBareFMU(
 		if ( 0 == loadDll( dllPath, bareFMU ) ) return shared_lib_load_failed;
 
 		// Add bare FMU to list.
+		lock_guard<SharedMutex> lock( modelManager_->mutex_ );
 		modelManager_->slaveCollection_[modelIdentifier] = bareFMU;
 
 		return success;
@@ -303,6 +673,7 @@ ModelManager::loadBareFMU(
 	{
 		BareFMU2Ptr bareFMU = make_shared<BareFMU2>();
 		bareFMU->description = description.release();
+		bareFMU->dllPath = dllPath;
 
 		bareFMU->fmuResourceLocation = fmuDirUrl + "/resources";
 
@@ -311,6 +682,7 @@ ModelManager::loadBareFMU(
 		if ( 0 == loadDll( dllPath, bareFMU ) ) return shared_lib_load_failed;
 
 		// Add bare FMU to list.
+		lock_guard<SharedMutex> lock( modelManager_->mutex_ );
 		modelManager_->instanceCollection_[modelIdentifier] = bareFMU;
 
 		return success;
@@ -319,13 +691,13 @@ ModelManager::loadBareFMU(
 }
 
 // Helper function for loading a bare FMU shared library (FMI ME Version 1.0).
-int ModelManager::loadDll( string dllPath, BareFMUModelExchangePtr bareFMU )
+int ModelManager::loadDll( string dllPath, BareFMUModelExchangePtr bareFMU, bool isolated )
 {
 	using namespace me;
 
 	int s = 1;
 
-	HANDLE h = openDLL( &s, dllPath );
+	HANDLE h = openDLL( &s, dllPath, isolated, &bareFMU->dllCopyPath );
 	if ( !s ) return 0;
 
 	FMUModelExchange_functions* fmuFun = new FMUModelExchange_functions;
@@ -362,13 +734,13 @@ int ModelManager::loadDll( string dllPath, BareFMUModelExchangePtr bareFMU )
 }
 
 // Helper function for loading a bare FMU shared library (FMI CS Version 1.0).
-int ModelManager::loadDll( string dllPath, BareFMUCoSimulationPtr bareFMU )
+int ModelManager::loadDll( string dllPath, BareFMUCoSimulationPtr bareFMU, bool isolated )
 {
 	using namespace cs;
 
 	int s = 1;
 
-	HANDLE h = openDLL( &s, dllPath );
+	HANDLE h = openDLL( &s, dllPath, isolated, &bareFMU->dllCopyPath );
 	if ( !s ) return 0;
 
 	FMUCoSimulation_functions* fmuFun = new FMUCoSimulation_functions;
@@ -412,7 +784,7 @@ int ModelManager::loadDll( string dllPath, BareFMUCoSimulationPtr bareFMU )
 }
 
 // Helper function for loading a bare FMU shared library (FMI ME/CS Version 2.0).
-int ModelManager::loadDll( string dllPath, BareFMU2Ptr bareFMU )
+int ModelManager::loadDll( string dllPath, BareFMU2Ptr bareFMU, bool isolated )
 {
 	using namespace fmi2;
 
@@ -421,7 +793,7 @@ int ModelManager::loadDll( string dllPath, BareFMU2Ptr bareFMU )
 
 	int s = 1;
 
-	HANDLE h = openDLL( &s, dllPath );
+	HANDLE h = openDLL( &s, dllPath, isolated, &bareFMU->dllCopyPath );
 	if ( !s ) return 0;
 
 	FMU2_functions* fmuFun = new FMU2_functions;
@@ -576,10 +948,28 @@ int ModelManager::loadFMI20CSSpecificFunctions(BareFMU2Ptr bareFMU)
 }
 
 // Opens the DLL/SO file
-HANDLE ModelManager::openDLL(int* status, const string& dllPath)
+HANDLE ModelManager::openDLL(int* status, const string& dllPath, bool isolated, string* copyPath)
 {
 	assert( status );
 
+	if ( isolated ) {
+		HANDLE h = 0;
+		string dllCopyPath;
+#if defined( LM_ID_NEWLM )
+		// Load the library into a new namespace, together with private copies of its dependencies.
+		h = dlmopen( LM_ID_NEWLM, dllPath.c_str(), RTLD_LAZY | RTLD_LOCAL );
+#endif
+		// Load a copy of the library otherwise ( e.g., if there are no namespaces left ).
+		if ( !h ) h = openDLLCopy( dllPath, dllCopyPath );
+		if ( copyPath ) *copyPath = dllCopyPath;
+		if ( !h ) {
+			printf( "ERROR: Could not load a private copy of \"%s\"\n", dllPath.c_str() );
+			fflush(stdout);
+			*status = 0;
+		}
+		return h;
+	}
+
 #if defined(MINGW) || defined(_MSC_VER)
 
 	//sets search directory for dlls to bin directory of FMU
@@ -612,6 +1002,52 @@ HANDLE ModelManager::openDLL(int* status, const string& dllPath)
 	return h;
 }
 
+HANDLE ModelManager::openDLLCopy(const string& dllPath, string& dllCopyPath)
+{
+	static std::atomic<unsigned int> nCopies( 0 );
+	dllCopyPath.clear();
+
+	// The copy gets a unique name in the same directory ( with the same extension ).
+	const size_t extLength = strlen( FMU_BIN_EXT );
+	const bool hasExt = ( dllPath.size() > extLength ) &&
+		( 0 == dllPath.compare( dllPath.size() - extLength, extLength, FMU_BIN_EXT ) );
+	ostringstream copyPath;
+	copyPath << dllPath.substr( 0, hasExt ? dllPath.size() - extLength : dllPath.size() ) << ".isolated-"
+#if defined(MINGW) || defined(_MSC_VER)
+		<< _getpid()
+#else
+		<< getpid()
+#endif
+		<< '-' << nCopies++ << FMU_BIN_EXT;
+
+	{
+		ifstream source( dllPath.c_str(), ios::in | ios::binary );
+		ofstream destination( copyPath.str().c_str(), ios::out | ios::binary | ios::trunc );
+		if ( !source || !destination || !( destination << source.rdbuf() ) ) {
+			destination.close();
+			remove( copyPath.str().c_str() );
+			return 0;
+		}
+	}
+
+	int s = 1;
+	HANDLE h = openDLL( &s, copyPath.str() );
+
+#if defined(MINGW) || defined(_MSC_VER)
+	// The file of a loaded library cannot be removed on Windows, it is removed after unloading it.
+	if ( s ) {
+		dllCopyPath = copyPath.str();
+		return h;
+	}
+	remove( copyPath.str().c_str() );
+	return 0;
+#else
+	// The library stays loaded after removing the file.
+	remove( copyPath.str().c_str() );
+	return s ? h : 0;
+#endif
+}
+
 // Helper function for loading FMU shared library.
 template<typename FunctionPtrType, typename BareFMUPtrType>
 FunctionPtrType ModelManager::getAdr10( int* s, BareFMUPtrType bareFMU, 
@@ -697,13 +1133,47 @@ ModelManager::LoadFMUStatus
 ModelManager::loadModelDescription(const std::string& fmuDirUrl,
 	std::unique_ptr<ModelDescription>& dest)
 {
-	// Path to XML model description (OS specific).
-	string xmlFilePath;
-	string xmlFileUrl = fmuDirUrl + "/modelDescription.xml";
-	if ( false == PathFromUrl::getPathFromUrl( xmlFileUrl, xmlFilePath ) ) return description_invalid_uri;
+	// Get the cache, it may be replaced concurrently by another thread.
+	std::shared_ptr<ModelDescriptionCache> cache;
+	{
+		SharedLock lock( modelManager_->mutex_ );
+		cache = modelManager_->descriptionCache_;
+	}
 
-	// Parse XML model description.
-	dest = std::unique_ptr<ModelDescription>( new ModelDescription( xmlFilePath ) );
+	if ( FMUArchive::isArchive( fmuDirUrl ) )
+	{
+		string archivePath;
+		if ( false == PathFromUrl::getPathFromUrl( fmuDirUrl, archivePath ) ) return description_invalid_uri;
+
+		FMUArchive archive( archivePath );
+		if ( false == archive.isValid() ) return archive_invalid;
+
+		// Read the XML model description directly from the archive, it refers to
+		// the location of the model description file after extracting the archive.
+		string xml;
+		if ( false == archive.read( "modelDescription.xml", xml ) ) return description_invalid;
+		string xmlFilePath = archive.getExtractionPath( getFMUExtractionDirectory() ) + "/modelDescription.xml";
+
+		if ( cache ) {
+			dest = cache->load( xmlFilePath, xml );
+		} else {
+			dest = std::unique_ptr<ModelDescription>( new ModelDescription( xmlFilePath, xml ) );
+		}
+	}
+	else
+	{
+		// Path to XML model description (OS specific).
+		string xmlFilePath;
+		string xmlFileUrl = fmuDirUrl + "/modelDescription.xml";
+		if ( false == PathFromUrl::getPathFromUrl( xmlFileUrl, xmlFilePath ) ) return description_invalid_uri;
+
+		// Parse XML model description ( or restore it from the cache ).
+		if ( cache ) {
+			dest = cache->load( xmlFilePath );
+		} else {
+			dest = std::unique_ptr<ModelDescription>( new ModelDescription( xmlFilePath ) );
+		}
+	}
 	if ( !dest->isValid() ) {
 		return description_invalid;
 	}
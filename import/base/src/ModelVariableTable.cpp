@@ -0,0 +1,149 @@
+// -------------------------------------------------------------------
+// Copyright (c) 2013-2022, AIT Austrian Institute of Technology GmbH.
+// All rights reserved. See file FMIPP_LICENSE for details.
+// -------------------------------------------------------------------
+
+/**
+ * \file ModelVariableTable.cpp
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+
+#include "import/base/include/ModelVariableTable.h"
+
+
+const fmippSize ModelVariableTable::npos = std::numeric_limits<fmippSize>::max();
+
+
+ModelVariableTable::ModelVariableTable() :
+	pool_( 1, '\0' ),
+	nNames_( 0 )
+{
+	interned_[ fmippString() ] = 0;
+}
+
+
+fmippSize ModelVariableTable::addVariable( const fmippString& name,
+	fmippValueReference valueReference, const fmippString& description,
+	FMIPPVariableCausality causality, FMIPPVariableVariability variability )
+{
+	name_.push_back( intern( name ) );
+	description_.push_back( intern( description ) );
+	startString_.push_back( 0 );
+	valueReference_.push_back( valueReference );
+	type_.push_back( fmippTypeUnknown );
+	causality_.push_back( causality );
+	variability_.push_back( variability );
+	start_.push_back( std::numeric_limits<fmippReal>::quiet_NaN() );
+	derivativeOf_.push_back( 0 );
+
+	return valueReference_.size() - 1;
+}
+
+
+void ModelVariableTable::setTypeInformation( fmippSize i, FMIPPVariableType type,
+	const fmippString* start, fmippSize derivativeOf )
+{
+	type_[i] = type;
+	derivativeOf_[i] = derivativeOf;
+
+	if ( 0 == start ) return;
+
+	startString_[i] = intern( *start );
+	if ( fmippTypeBoolean == type ) {
+		start_[i] = ( ( "true" == *start ) || ( "1" == *start ) ) ? 1. : 0.;
+	} else if ( ( fmippTypeReal == type ) || ( fmippTypeInteger == type ) ) {
+		start_[i] = std::strtod( start->c_str(), 0 );
+	}
+}
+
+
+void ModelVariableTable::finalize()
+{
+	std::unordered_map<fmippString, unsigned int>().swap( interned_ );
+
+	pool_.shrink_to_fit();
+	name_.shrink_to_fit();
+	description_.shrink_to_fit();
+	startString_.shrink_to_fit();
+	valueReference_.shrink_to_fit();
+	type_.shrink_to_fit();
+	causality_.shrink_to_fit();
+	variability_.shrink_to_fit();
+	start_.shrink_to_fit();
+	derivativeOf_.shrink_to_fit();
+
+	// Build the hash index of the names ( linear probing, load factor <= 0.5 ).
+	fmippSize nSlots = 1;
+	while ( nSlots < 2*size() ) nSlots *= 2;
+	std::vector<unsigned int>( nSlots, 0 ).swap( index_ );
+	nNames_ = 0;
+
+	for ( fmippSize i = 0; i < size(); ++i ) {
+		const fmippChar* name = getName( i );
+		fmippSize slot = hash( name, std::strlen( name ) ) & ( nSlots - 1 );
+		while ( 0 != index_[slot] ) {
+			if ( 0 == std::strcmp( name, getName( index_[slot] - 1 ) ) ) break; // keep the first one
+			slot = ( slot + 1 ) & ( nSlots - 1 );
+		}
+		if ( 0 == index_[slot] ) {
+			index_[slot] = static_cast<unsigned int>( i + 1 );
+			++nNames_;
+		}
+	}
+}
+
+
+fmippSize ModelVariableTable::find( const fmippString& name ) const
+{
+	if ( index_.empty() ) return npos;
+
+	const fmippSize mask = index_.size() - 1;
+	for ( fmippSize slot = hash( name.c_str(), name.size() ) & mask; 0 != index_[slot]; slot = ( slot + 1 ) & mask ) {
+		const fmippSize i = index_[slot] - 1;
+		if ( 0 == name.compare( getName( i ) ) ) return i;
+	}
+
+	return npos;
+}
+
+
+fmippSize ModelVariableTable::hash( const fmippChar* s, fmippSize length )
+{
+	// FNV-1a
+	fmippSize h = static_cast<fmippSize>( 2166136261U );
+	for ( fmippSize i = 0; i < length; ++i ) {
+		h ^= static_cast<unsigned char>( s[i] );
+		h *= static_cast<fmippSize>( 16777619U );
+	}
+	return h;
+}
+
+
+fmippSize ModelVariableTable::getMemoryUsage() const
+{
+	return pool_.capacity()*sizeof( fmippChar ) +
+		( name_.capacity() + description_.capacity() + startString_.capacity() +
+		  derivativeOf_.capacity() )*sizeof( unsigned int ) +
+		valueReference_.capacity()*sizeof( fmippValueReference ) +
+		type_.capacity() + causality_.capacity() + variability_.capacity() +
+		start_.capacity()*sizeof( fmippReal );
+}
+
+
+unsigned int ModelVariableTable::intern( const fmippString& s )
+{
+	std::unordered_map<fmippString, unsigned int>::const_iterator it = interned_.find( s );
+	if ( it != interned_.end() ) return it->second;
+
+	unsigned int offset = pool_.size();
+	pool_.insert( pool_.end(), s.begin(), s.end() );
+	pool_.push_back( '\0' );
+
+	// after finalize() the strings are appended without interning
+	if ( !interned_.empty() ) interned_[s] = offset;
+
+	return offset;
+}
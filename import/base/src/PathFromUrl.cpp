@@ -36,4 +36,23 @@ namespace PathFromUrl {
 #endif
 	}
 
+
+	bool
+	getUrlFromPath( const fmippString& inputFilePath, fmippString& outputFileUrl )
+	{
+#ifdef WIN32
+		LPTSTR fileUrl = new TCHAR[INTERNET_MAX_URL_LENGTH];
+		DWORD fileUrlSize = INTERNET_MAX_URL_LENGTH;
+		HRESULT res = UrlCreateFromPath( inputFilePath.c_str(), fileUrl, &fileUrlSize, NULL );
+		outputFileUrl = fmippString( fileUrl );
+		delete[] fileUrl;
+		return ( S_OK == res );
+#else
+		if ( inputFilePath.empty() ) return false;
+
+		outputFileUrl = "file://" + inputFilePath;
+		return true;
+#endif
+	}
+
 }
@@ -0,0 +1,104 @@
+// -------------------------------------------------------------------
+// Copyright (c) 2013-2022, AIT Austrian Institute of Technology GmbH.
+// All rights reserved. See file FMIPP_LICENSE for details.
+// -------------------------------------------------------------------
+
+/**
+ * \file SparseJacobian.cpp
+ */
+
+#include "import/base/include/SparseJacobian.h"
+
+
+SparseJacobian::SparseJacobian() : n_( 0 )
+{}
+
+
+void SparseJacobian::setPattern( fmippSize n, const std::vector<fmippSize>& rowPtr,
+	const std::vector<fmippSize>& colInd )
+{
+	n_ = n;
+	rowPtr_ = rowPtr;
+	colInd_ = colInd;
+
+	rowInd_.resize( colInd_.size() );
+	for ( fmippSize i = 0; i < n_; ++i )
+		for ( fmippSize k = rowPtr_[i]; k < rowPtr_[i+1]; ++k )
+			rowInd_[k] = i;
+
+	values_.assign( colInd_.size(), 0.0 );
+
+	colorColumns();
+}
+
+
+void SparseJacobian::colorColumns()
+{
+	groups_.clear();
+	entries_.clear();
+
+	if ( 0 == n_ ) return;
+
+	// Transpose the pattern, i.e., collect the rows (and entries) of each column.
+	std::vector< std::vector<fmippSize> > columnEntries( n_ );
+	for ( fmippSize k = 0; k < colInd_.size(); ++k )
+		columnEntries[ colInd_[k] ].push_back( k );
+
+	// Greedy coloring: assign each column to the first color that does not yet occupy
+	// any of its rows. rowColors[i] holds the colors that already occupy row i,
+	// forbidden[c] == j + 1 marks color c as unavailable for column j.
+	std::vector<fmippSize> forbidden;
+	std::vector< std::vector<fmippSize> > rowColors( n_ );
+
+	for ( fmippSize j = 0; j < n_; ++j )
+	{
+		const std::vector<fmippSize>& entries = columnEntries[j];
+
+		for ( fmippSize e = 0; e < entries.size(); ++e ) {
+			const std::vector<fmippSize>& colors = rowColors[ rowInd_[ entries[e] ] ];
+			for ( fmippSize c = 0; c < colors.size(); ++c )
+				forbidden[ colors[c] ] = j + 1;
+		}
+
+		fmippSize color = 0;
+		while ( color < forbidden.size() && forbidden[color] == j + 1 ) ++color;
+
+		if ( color == forbidden.size() ) {
+			forbidden.push_back( 0 );
+			groups_.push_back( std::vector<fmippSize>() );
+			entries_.push_back( std::vector<fmippSize>() );
+		}
+
+		groups_[color].push_back( j );
+		for ( fmippSize e = 0; e < entries.size(); ++e ) {
+			rowColors[ rowInd_[ entries[e] ] ].push_back( color );
+			entries_[color].push_back( entries[e] );
+		}
+	}
+}
+
+
+void SparseJacobian::setCompressedColumn( fmippSize c, const fmippReal* column )
+{
+	// Since the columns of one color have disjoint row patterns, every row of the
+	// compressed column belongs to exactly one non-zero entry of this color.
+	const std::vector<fmippSize>& entries = entries_[c];
+	for ( fmippSize e = 0; e < entries.size(); ++e )
+		values_[ entries[e] ] = column[ rowInd_[ entries[e] ] ];
+}
+
+
+void SparseJacobian::getDenseRowMajor( fmippReal* J ) const
+{
+	for ( fmippSize i = 0; i < n_*n_; ++i ) J[i] = 0.0;
+	for ( fmippSize k = 0; k < colInd_.size(); ++k )
+		J[ n_*rowInd_[k] + colInd_[k] ] = values_[k];
+}
+
+
+void SparseJacobian::getDenseColumnMajor( fmippReal* J ) const
+{
+	for ( fmippSize i = 0; i < n_*n_; ++i ) J[i] = 0.0;
+	for ( fmippSize k = 0; k < colInd_.size(); ++k )
+		J[ n_*colInd_[k] + rowInd_[k] ] = values_[k];
+}
@@ -0,0 +1,77 @@
+// -------------------------------------------------------------------
+// Copyright (c) 2013-2022, AIT Austrian Institute of Technology GmbH.
+// All rights reserved. See file FMIPP_LICENSE for details.
+// -------------------------------------------------------------------
+
+/**
+ * \file StepWorker.cpp
+ */
+
+#include <utility>
+
+#include "import/base/include/StepWorker.h"
+
+using namespace std;
+
+
+StepWorker::StepWorker() : stop_( false ) {}
+
+
+StepWorker::~StepWorker()
+{
+	{
+		lock_guard<mutex> lock( mutex_ );
+		stop_ = true;
+	}
+	wakeUp_.notify_one();
+
+	if ( thread_.joinable() ) thread_.join();
+}
+
+
+StepWorker::Future StepWorker::run( const Task& task )
+{
+	Future future;
+
+	{
+		lock_guard<mutex> lock( mutex_ );
+		jobs_.push_back( Job( task, promise<fmippStatus>() ) );
+		future = jobs_.back().second.get_future().share();
+
+		// Start the thread with the first task.
+		if ( false == thread_.joinable() ) thread_ = thread( &StepWorker::work, this );
+	}
+	wakeUp_.notify_one();
+
+	return future;
+}
+
+
+StepWorker::Future StepWorker::ready( fmippStatus status )
+{
+	promise<fmippStatus> result;
+	result.set_value( status );
+	return result.get_future().share();
+}
+
+
+void StepWorker::work()
+{
+	unique_lock<mutex> lock( mutex_ );
+
+	while ( true ) {
+		wakeUp_.wait( lock, [this] { return stop_ || ( false == jobs_.empty() ); } );
+		if ( jobs_.empty() ) return; // Stopped and all jobs are done.
+
+		Job job = move( jobs_.front() );
+		jobs_.pop_front();
+
+		lock.unlock();
+		try {
+			job.second.set_value( job.first() );
+		} catch ( ... ) {
+			job.second.set_exception( current_exception() );
+		}
+		lock.lock();
+	}
+}
@@ -0,0 +1,138 @@
+// -------------------------------------------------------------------
+// Copyright (c) 2013-2022, AIT Austrian Institute of Technology GmbH.
+// All rights reserved. See file FMIPP_LICENSE for details.
+// -------------------------------------------------------------------
+
+/**
+ * \file VariableGroup.cpp
+ */
+
+#include "import/base/include/VariableGroup.h"
+#include "import/base/include/FMUBase.h"
+
+
+namespace {
+
+	// The FMU wrappers expect non-const arrays of value references, but do not modify them.
+	template<typename Type>
+	fmippStatus getGroupValues( FMUBase& fmu, const std::vector<fmippValueReference>& refs, Type* val )
+	{
+		if ( refs.empty() ) return fmippOK;
+		return fmu.getValue( const_cast<fmippValueReference*>( refs.data() ), val, refs.size() );
+	}
+
+	template<typename Type>
+	fmippStatus setGroupValues( FMUBase& fmu, const std::vector<fmippValueReference>& refs, const Type* val )
+	{
+		if ( refs.empty() ) return fmippOK;
+		return fmu.setValue( const_cast<fmippValueReference*>( refs.data() ), val, refs.size() );
+	}
+}
+
+
+VariableGroup::VariableGroup( const fmippString& name ) : name_( name ) {}
+
+
+void VariableGroup::add( FMIPPVariableType type, fmippValueReference valueRef )
+{
+	if ( type < nTypes ) valueRefs_[type].push_back( valueRef );
+}
+
+
+bool VariableGroup::add( const FMUBase& fmu, const fmippString& variableName )
+{
+	const fmippValueReference valueRef = fmu.getValueRef( variableName );
+	if ( fmippUndefinedValueReference == valueRef ) return false;
+
+	add( fmu.getType( variableName ), valueRef );
+	return true;
+}
+
+
+void VariableGroup::define( const FMUBase& fmu, FMIPPVariableType type,
+	const fmippString variableNames[], fmippSize nVariables )
+{
+	if ( type >= nTypes ) return;
+
+	std::vector<fmippValueReference>& refs = valueRefs_[type];
+	refs.resize( nVariables );
+	for ( fmippSize i = 0; i < nVariables; ++i ) {
+		refs[i] = fmu.getValueRef( variableNames[i] );
+	}
+}
+
+
+void VariableGroup::clear()
+{
+	for ( fmippSize type = 0; type < nTypes; ++type ) valueRefs_[type].clear();
+}
+
+
+fmippSize VariableGroup::size( FMIPPVariableType type ) const
+{
+	return ( type < nTypes ) ? valueRefs_[type].size() : 0;
+}
+
+
+fmippValueReference VariableGroup::getValueRef( FMIPPVariableType type, fmippSize i ) const
+{
+	return valueRefs_[type][i];
+}
+
+
+fmippSize VariableGroup::nCalls() const
+{
+	fmippSize calls = 0;
+	for ( fmippSize type = 0; type < nTypes; ++type ) {
+		if ( false == valueRefs_[type].empty() ) ++calls;
+	}
+	return calls;
+}
+
+
+fmippStatus VariableGroup::getValues( FMUBase& fmu, fmippReal* val ) const
+{
+	return getGroupValues( fmu, valueRefs_[fmippTypeReal], val );
+}
+
+
+fmippStatus VariableGroup::getValues( FMUBase& fmu, fmippInteger* val ) const
+{
+	return getGroupValues( fmu, valueRefs_[fmippTypeInteger], val );
+}
+
+
+fmippStatus VariableGroup::getValues( FMUBase& fmu, fmippBoolean* val ) const
+{
+	return getGroupValues( fmu, valueRefs_[fmippTypeBoolean], val );
+}
+
+
+fmippStatus VariableGroup::getValues( FMUBase& fmu, fmippString* val ) const
+{
+	return getGroupValues( fmu, valueRefs_[fmippTypeString], val );
+}
+
+
+fmippStatus VariableGroup::setValues( FMUBase& fmu, const fmippReal* val ) const
+{
+	return setGroupValues( fmu, valueRefs_[fmippTypeReal], val );
+}
+
+
+fmippStatus VariableGroup::setValues( FMUBase& fmu, const fmippInteger* val ) const
+{
+	return setGroupValues( fmu, valueRefs_[fmippTypeInteger], val );
+}
+
+
+fmippStatus VariableGroup::setValues( FMUBase& fmu, const fmippBoolean* val ) const
+{
+	return setGroupValues( fmu, valueRefs_[fmippTypeBoolean], val );
+}
+
+
+fmippStatus VariableGroup::setValues( FMUBase& fmu, const fmippString* val ) const
+{
+	return setGroupValues( fmu, valueRefs_[fmippTypeString], val );
+}
@@ -0,0 +1,26 @@
+// -------------------------------------------------------------------
+// Copyright (c) 2013-2022, AIT Austrian Institute of Technology GmbH.
+// All rights reserved. See file FMIPP_LICENSE for details.
+// -------------------------------------------------------------------
+
+#ifndef _FMIPP_EVENTLOCATIONTYPE_H
+#define _FMIPP_EVENTLOCATIONTYPE_H
+
+/**
+ * \file EventLocationType.h
+ * Enumeration of available methods for the location of state events.
+ *
+ * \enum EventLocationType EventLocationType.h
+ * Enumeration of available methods for the location of state events.
+ */
+enum EventLocationType {
+    bisectionSearch,  ///< Bisection of the event interval. Each iteration makes a step
+                      ///  ( or an interpolation ) and checks for events.
+    denseRootFinding, ///< Illinois root finder on the event indicators, which are evaluated at
+                      ///  the states interpolated by the dense output of the stepper. Converges
+                      ///  superlinearly. Falls back to bisectionSearch for steppers without
+                      ///  dense output (default).
+    NEVENTLOCATIONS,  ///< dummy method which counts the number of event location methods.
+};
+
+#endif // _FMIPP_EVENTLOCATIONTYPE_H
@@ -12,6 +12,9 @@
 #include "common/FMIPPConfig.h"
 
 #include "import/integrators/include/IntegratorType.h"
+#include "import/integrators/include/LinearSolverType.h"
+#include "import/integrators/include/EventLocationType.h"
+#include "import/integrators/include/IntegratorStatistics.h"
 
 class DynamicalSystem;
 class IntegratorStepper;
@@ -66,11 +69,23 @@ public:
 		int            order;    ///< global trunounciation error of the stepper
 		double         abstol;   ///< absolute tolerance. Inf for non adaptive steppers
 		double         reltol;   ///< relative tolerance. Inf for non adaptive steppers
+		LinearSolverType linearSolver; ///< linear solver used by implicit steppers. Ignored by
+		                               ///  explicit steppers
+		EventLocationType eventLocation; ///< method for the location of state events
+		int            jacobianMaxAge;  ///< maximum number of accepted steps for which implicit
+		                                ///  steppers reuse a Jacobian. Zero means no limit,
+		                                ///  a negative value selects the default of the stepper
+		double         refactorizationThreshold; ///< relative change of the step size which
+		                                         ///  makes implicit steppers factorize again
 		Properties() : type( IntegratorType::dp ),
 			name( "" ),
 			order( 0 ),
 			abstol( std::numeric_limits<double>::quiet_NaN() ),
-			reltol( std::numeric_limits<double>::quiet_NaN() ){}
+			reltol( std::numeric_limits<double>::quiet_NaN() ),
+			linearSolver( LinearSolverType::denseLU ),
+			eventLocation( EventLocationType::denseRootFinding ),
+			jacobianMaxAge( -1 ),
+			refactorizationThreshold( 1.0e-3 ){}
 
 		/// Returns true iff all properties are equal
 		bool operator==( const Properties& prop ) const;
@@ -92,9 +107,77 @@ public:
 	EventInfo() : stepEvent( 0 ), stateEvent( 0 ), tLower( 0 ), tUpper( 0 ){}
 	};
 
-	/// Integrate FMU ME state.
+	/**
+	 * Statistics about the reuse of Jacobians and their factorizations by the implicit
+	 * steppers. Every attempted step counts either as hit ( reuse ) or as miss ( new
+	 * evaluation or factorization ).
+	 */
+	struct JacobianStatistics{
+		fmippSize jacobianHits;        ///< Steps that reused the Jacobian of a previous step.
+		fmippSize jacobianMisses;      ///< Steps that evaluated the Jacobian.
+		fmippSize factorizationHits;   ///< Steps that reused the factorization of a previous step.
+		fmippSize factorizationMisses; ///< Steps that factorized the matrix.
+	JacobianStatistics() : jacobianHits( 0 ), jacobianMisses( 0 ),
+		factorizationHits( 0 ), factorizationMisses( 0 ){}
+	};
+
+	/**
+	 * Statistics about the automatic switching between the nonstiff and the stiff method
+	 * of the stepper IntegratorType::au.
+	 */
+	struct SwitchingStatistics{
+		fmippSize switchesToImplicit; ///< Switches to the implicit method ( stiffness detected ).
+		fmippSize switchesToExplicit; ///< Switches back to the explicit method.
+		fmippSize explicitSteps;      ///< Accepted steps of the explicit method.
+		fmippSize implicitSteps;      ///< Accepted steps of the implicit method.
+		bool      stiff;              ///< True iff the implicit method is currently used.
+	SwitchingStatistics() : switchesToImplicit( 0 ), switchesToExplicit( 0 ),
+		explicitSteps( 0 ), implicitSteps( 0 ), stiff( false ){}
+	};
+
+	/**
+	 * Integrate FMU ME state.
+	 *
+	 * The stepper keeps its internal history ( step size, order, dense output, ... ) from the
+	 * last call and is only restarted if the continuity of the solution has been broken, i.e.,
+	 * if the time or the continuous states of the FMU have been changed since the last call or
+	 * if reset() has been called ( e.g. because an event has been handled or because an input
+	 * has been set ).
+	 */
 	EventInfo integrate( fmippTime step_size, fmippTime dt, fmippTime eventSearchPrecision );
 
+	/**
+	 * Discard the history of the stepper. The stepper will be restarted at the beginning of
+	 * the next call to integrate(). Call this whenever the RHS might be discontinuous at the
+	 * current time, e.g., after an event has been handled.
+	 */
+	void reset();
+
+	/// Number of RHS evaluations that have been saved by continuing the stepper instead of
+	/// restarting it at the beginning of integrate().
+	fmippSize nSavedRHSEvaluations() const { return nSavedRHSEvaluations_; }
+
+	/// Statistics about the reuse of Jacobians by the current stepper. All counters are
+	/// zero for explicit steppers and are reset whenever a new stepper is created.
+	JacobianStatistics getJacobianStatistics() const;
+
+	/// Statistics about the switching between nonstiff and stiff methods. All counters
+	/// are zero for steppers which do not switch.
+	SwitchingStatistics getSwitchingStatistics() const;
+
+	/// \copydoc IntegratorStatistics
+	typedef IntegratorStatistics Statistics;
+
+	/// Runtime statistics ( RHS evaluations, Jacobians, steps, event location, wall times )
+	/// collected since the creation of the integrator or the last call to resetStatistics().
+	Statistics getStatistics() const { return statistics_; }
+
+	/// Set all counters and times of the runtime statistics to zero.
+	void resetStatistics() { statistics_.reset(); }
+
+	/// Runtime statistics to be updated by the stepper, the linear solver and the FMU.
+	Statistics& statistics() { return statistics_; }
+
 	/// Clone this instance of Integrator (not a copy).
 	Integrator* clone() const;
 
@@ -124,6 +207,14 @@ public:
 
 private:
 
+	/**
+	 * Locate a state event in the interval [ eventInfo_.tLower, eventInfo_.tUpper ] up to
+	 * eventSearchPrecision using the Illinois method. The event indicators are evaluated at
+	 * the states interpolated by the dense output of the stepper, i.e., the ODE is not
+	 * integrated again. On return, the fmu and states_ are at the time eventInfo_.tLower.
+	 */
+	void locateStateEvent( fmippTime eventSearchPrecision );
+
 	Properties properties_;         ///< Internal copy of the stepper properties
 	EventInfo  eventInfo_;          ///< last event info returned by the stepper
 	                                ///  gets updated inside the eventSearch loop
@@ -133,6 +224,12 @@ private:
 	StateType states_;		///< Internal states. Serve as backup if an intEvent occurs.
 	fmippTime time_;			///< Internal time. Serves as backup if an intEvent occurs.
 
+	StateType lastStates_;          ///< States at the end of the last call to integrate().
+	fmippTime lastTime_;            ///< Time at the end of the last call to integrate(). NaN if
+	                                ///  the history of the stepper is not valid.
+	fmippSize nSavedRHSEvaluations_; ///< RHS evaluations saved by not restarting the stepper.
+	Statistics statistics_;         ///< Runtime statistics.
+
 	bool is_copy_;                  ///< Is this just a copy of another instance of Integrator? -> See destructor.
 };
 
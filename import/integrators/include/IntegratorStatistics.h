@@ -0,0 +1,84 @@
+// -------------------------------------------------------------------
+// Copyright (c) 2013-2022, AIT Austrian Institute of Technology GmbH.
+// All rights reserved. See file FMIPP_LICENSE for details.
+// -------------------------------------------------------------------
+
+#ifndef _FMIPP_INTEGRATORSTATISTICS_H
+#define _FMIPP_INTEGRATORSTATISTICS_H
+
+#include "common/FMIPPConfig.h"
+
+#ifndef SWIG
+#include <chrono>
+#endif
+
+/**
+ * \file IntegratorStatistics.h
+ * Runtime statistics of the integration of an FMU for ME.
+ *
+ * \struct IntegratorStatistics IntegratorStatistics.h
+ * Counters and wall times of the work done by an Integrator, its stepper and its linear
+ * solver since the creation of the Integrator or the last call to reset(). All times are
+ * given in seconds.
+ *
+ * The odeint steppers with dense output do not report their rejected steps, except for the
+ * steppers dp, ro and au whose attempts can be derived from the number of RHS evaluations.
+ */
+struct __FMI_DLL IntegratorStatistics
+{
+	fmippSize rhsEvaluations;     ///< Evaluations of the RHS requested by the stepper ( excluding
+	                              ///  those needed for numerical Jacobians ).
+	fmippSize analyticJacobians;  ///< Jacobians evaluated with directional derivatives of the FMU.
+	fmippSize numericalJacobians; ///< Jacobians approximated by finite differences.
+	fmippSize acceptedSteps;      ///< Steps accepted by the stepper.
+	fmippSize rejectedSteps;      ///< Steps rejected by the error test or failed Newton iterations.
+	fmippSize eventIterations;    ///< Iterations of the bisection or root finding which locate
+	                              ///  state events in Integrator::integrate().
+	fmippSize stateEventChecks;   ///< Calls to DynamicalSystem::checkStateEvent().
+	fmippSize skippedSetTime;     ///< Calls to setTime of the FMU skipped because the time was
+	                              ///  set already ( see ModelEvaluationCache ).
+	fmippSize skippedSetStates;   ///< Calls to setContinuousStates of the FMU skipped because the
+	                              ///  states were set already.
+	fmippSize cachedDerivatives;  ///< Derivatives returned without calling the FMU.
+	fmippSize cachedEventIndicators; ///< Event indicators returned without calling the FMU.
+
+	double rhsTime;               ///< Wall time spent in the evaluations of the RHS.
+	double jacobianTime;          ///< Wall time spent in the evaluations of Jacobians.
+	double eventLocationTime;     ///< Wall time spent locating state events.
+	double stateEventCheckTime;   ///< Wall time spent in DynamicalSystem::checkStateEvent().
+	double integrationTime;       ///< Total wall time spent in Integrator::integrate().
+
+	IntegratorStatistics() { reset(); }
+
+	/// Set all counters and times to zero.
+	void reset() {
+		rhsEvaluations = analyticJacobians = numericalJacobians = 0;
+		acceptedSteps = rejectedSteps = 0;
+		eventIterations = stateEventChecks = 0;
+		skippedSetTime = skippedSetStates = cachedDerivatives = cachedEventIndicators = 0;
+		rhsTime = jacobianTime = eventLocationTime = stateEventCheckTime = integrationTime = 0.0;
+	}
+};
+
+#ifndef SWIG
+/**
+ * \class StatisticsTimer IntegratorStatistics.h
+ * Adds the wall time between its construction and its destruction to one of the times of
+ * IntegratorStatistics.
+ */
+class StatisticsTimer
+{
+public:
+	StatisticsTimer( double& time ) : time_( time ), start_( std::chrono::steady_clock::now() ) {}
+
+	~StatisticsTimer() {
+		time_ += std::chrono::duration<double>( std::chrono::steady_clock::now() - start_ ).count();
+	}
+
+private:
+	double& time_;
+	const std::chrono::steady_clock::time_point start_;
+};
+#endif // SWIG
+
+#endif // _FMIPP_INTEGRATORSTATISTICS_H
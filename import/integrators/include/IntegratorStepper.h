@@ -28,6 +28,9 @@
  * | fe      | Fehlberg                         | ODEINT   | 8     | Yes      | Nonstiff, smooth Models        |
  * | bs      | BulirschStoer                    | ODEINT   | 1-16  | Yes      | High precision required        |
  * | ro      | Rosenbrock                       | ODEINT   | 4     | Yes      | Stiff Models                   |
+ * | ra      | RadauIIA                         | FMI++    | 5     | Yes      | Stiff Models, high precision   |
+ * | es      | Esdirk                           | FMI++    | 3     | Yes      | Stiff Models                   |
+ * | au      | AutoSwitching                    | FMI++    | 5     | Yes      | Partially stiff Models         |
  * | bdf     | BackwardsDifferentiationFormula  | SUNDIALS | 1-5   | Yes      | Stiff Models                   |
  * | abm2    | AdamsBashforthMoulton2           | SUNDIALS | 1-12  | Yes      | Nonstiff Models, expensive rhs |
  *
@@ -67,6 +70,15 @@ public:
 	virtual void do_step_const( EventInfo& eventInfo, StateType& states,
 		fmippTime& currentTime, fmippTime& dt ){};
 
+	/// Returns true iff the stepper provides dense output, i.e., iff calcState() can be used.
+	virtual bool providesDenseOutput() const { return false; }
+
+	/**
+	 * Interpolate the states using the dense output of the stepper. The time t has to be
+	 * within the last step made by invokeMethod. Does not change the state of the FMU.
+	 */
+	virtual void calcState( fmippTime t, StateType& states ){};
+
 	/**
 	 * Invokes the integration method.
 	 *
@@ -91,11 +103,28 @@ public:
 	/**
 	 * Reset the stepper since the states changed externally
 	 *
-	 * Currently the steppers are reset before every call to invokeMethod. Yet, it would
-	 * be adviseable to make less reset calls for the sake of performance.
+	 * The Integrator only resets the stepper if the continuity of the solution has been
+	 * broken ( states/time changed externally, events ). Otherwise, invokeMethod continues
+	 * with the internal history ( step size, order, dense output, ... ) of the last call.
 	 */
 	virtual void reset(){};
 
+	/// Number of RHS evaluations needed to restart the stepper after a reset ( e.g. to
+	/// re-evaluate the derivatives at the initial point ).
+	virtual fmippSize nRestartEvaluations() const { return 0; }
+
+	/// Statistics about the reuse of Jacobians. Only implicit steppers reuse Jacobians.
+	virtual Integrator::JacobianStatistics getJacobianStatistics() const
+	{
+		return Integrator::JacobianStatistics();
+	}
+
+	/// Statistics about the switching between methods. Only the stepper au switches.
+	virtual Integrator::SwitchingStatistics getSwitchingStatistics() const
+	{
+		return Integrator::SwitchingStatistics();
+	}
+
 	/**
 	 * Factory: creates a new integrator stepper.
 	 *
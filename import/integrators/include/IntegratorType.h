@@ -22,6 +22,10 @@ enum IntegratorType {
     fe,   ///< 8th order Runge-Kutta-Fehlberg method with controlled step size.
     bs,   ///< Bulirsch-Stoer method with controlled step size.
     ro,   ///< 4th Rosenbrock Method for stiff problems.
+    ra,   ///< 5th order Radau IIA method for stiff problems with controlled step size.
+    es,   ///< 3rd order L-stable ESDIRK method for stiff problems with controlled step size.
+    au,   ///< Automatic switching between Dormand-Prince ( nonstiff ) and Radau IIA ( stiff ),
+          ///  depending on an estimate of the stiffness.
 #ifdef USE_SUNDIALS
     bdf,  ///< Backwards Differentiation formula from Sundials. This stepper has adaptive step size,
           ///  error control and an internal algorithm for the event search loop. The order varies
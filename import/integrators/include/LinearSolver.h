@@ -0,0 +1,100 @@
+// -------------------------------------------------------------------
+// Copyright (c) 2013-2022, AIT Austrian Institute of Technology GmbH.
+// All rights reserved. See file FMIPP_LICENSE for details.
+// -------------------------------------------------------------------
+
+#ifndef _FMIPP_LINEARSOLVER_H
+#define _FMIPP_LINEARSOLVER_H
+
+#include "common/FMIPPConfig.h"
+
+#include "import/integrators/include/LinearSolverType.h"
+
+class DynamicalSystem;
+
+/**
+ * \file LinearSolver.h
+ * Linear solvers for the implicit integration methods.
+ *
+ * \class LinearSolver LinearSolver.h
+ * Linear solvers for the implicit integration methods.
+ *
+ * Implicit steppers (e.g. Rosenbrock methods) have to solve linear systems of the form
+ *
+ *        \f[ ( \alpha I - J ) y = b, \f]
+ *
+ * where \f$J\f$ is the Jacobian of the RHS of the ODE and \f$\alpha\f$ depends on the step
+ * size. A linear solver evaluates and stores the Jacobian, factorizes the matrix
+ * \f$\alpha I - J\f$ and solves the linear system for (possibly many) right-hand sides.
+ * Since the storage of the Jacobian depends on the linear solver, the evaluation of the
+ * Jacobian is done by the linear solver as well.
+ *
+ * Radau IIA methods additionally need the complex matrix \f$( \alpha + i \beta ) I - J\f$.
+ * Its factorization is stored independently of the real one, such that both can be reused
+ * over several steps.
+ */
+class __FMI_DLL LinearSolver
+{
+
+public:
+
+	/// Destructor.
+	virtual ~LinearSolver();
+
+	/**
+	 * Evaluate and store the Jacobian of the dynamical system at ( x, t ).
+	 *
+	 * \param[in]   x     the states
+	 * \param[in]   t     the time
+	 * \param[out]  dfdt  the derivative of the RHS with respect to time. This is
+	 *                    only computed in case of a numerical Jacobian and set to
+	 *                    zero otherwise.
+	 */
+	virtual void evaluateJacobian( const fmippReal* x, fmippTime t, fmippReal* dfdt ) = 0;
+
+	/**
+	 * Factorize the matrix alpha*I - J, where J is the Jacobian stored by the last
+	 * call of evaluateJacobian().
+	 *
+	 * \returns false iff the matrix is singular.
+	 */
+	virtual fmippBoolean factorize( fmippReal alpha ) = 0;
+
+	/// Solve the linear system using the last factorization. The solution overwrites b.
+	virtual void solve( fmippReal* b ) const = 0;
+
+	/**
+	 * Factorize the complex matrix ( alpha + i*beta )*I - J, where J is the Jacobian stored by
+	 * the last call of evaluateJacobian().
+	 *
+	 * \returns false iff the matrix is singular.
+	 */
+	virtual fmippBoolean factorizeComplex( fmippReal alpha, fmippReal beta ) = 0;
+
+	/**
+	 * Solve the complex linear system using the last call of factorizeComplex(). The real
+	 * and imaginary parts of the solution overwrite re and im.
+	 */
+	virtual void solveComplex( fmippReal* re, fmippReal* im ) const = 0;
+
+	/// Get the type of the linear solver.
+	virtual LinearSolverType getType() const = 0;
+
+	/**
+	 * Factory: creates a new linear solver.
+	 *
+	 * \param[in]  type  the requested type of the linear solver
+	 * \param[in]  ds    the dynamical system whose Jacobian is to be used
+	 */
+	static LinearSolver* createLinearSolver( LinearSolverType type, DynamicalSystem* ds );
+
+protected:
+
+	/// Constructor.
+	LinearSolver( DynamicalSystem* ds );
+
+	DynamicalSystem* const ds_; ///< pointer to the dynamical system
+	const fmippSize n_;         ///< dimension of the state space
+};
+
+#endif // _FMIPP_LINEARSOLVER_H
@@ -0,0 +1,24 @@
+// -------------------------------------------------------------------
+// Copyright (c) 2013-2022, AIT Austrian Institute of Technology GmbH.
+// All rights reserved. See file FMIPP_LICENSE for details.
+// -------------------------------------------------------------------
+
+#ifndef _FMIPP_LINEARSOLVERTYPE_H
+#define _FMIPP_LINEARSOLVERTYPE_H
+
+/**
+ * \file LinearSolverType.h
+ * Enumeration of available linear solvers for implicit integration methods.
+ *
+ * \enum LinearSolverType LinearSolverType.h
+ * Enumeration of available linear solvers for implicit integration methods.
+ */
+enum LinearSolverType {
+    denseLU,  ///< Dense LU factorization with partial pivoting (default).
+    sparseLU, ///< Sparse LU factorization. Exploits the sparsity pattern of the Jacobian
+              ///  given by the model structure. Uses SUNDIALS' KLU solver for the steppers
+              ///  from SUNDIALS if available and an in-tree implementation otherwise.
+    NLINEARSOLVERS, ///< dummy linear solver which counts the number of linear solvers.
+};
+
+#endif // _FMIPP_LINEARSOLVERTYPE_H
@@ -11,6 +11,7 @@
 #include <cstdio>
 #include <cassert>
 #include <limits>
+#include <algorithm>
 
 #include "common/fmi_v1.0/fmiModelTypes.h"
 
@@ -27,6 +28,8 @@ using namespace std;
 Integrator::Integrator( DynamicalSystem* fmu ) :
 	fmu_( fmu ),
 	stepper_( 0 ),
+	lastTime_( std::numeric_limits<fmippTime>::quiet_NaN() ),
+	nSavedRHSEvaluations_( 0 ),
 	is_copy_( false )
 {}
 
@@ -36,6 +39,10 @@ Integrator::Integrator( const Integrator& other ) :
 	stepper_( other.stepper_ ),
 	states_( other.states_ ),
 	time_( other.time_ ),
+	lastStates_( other.lastStates_ ),
+	lastTime_( other.lastTime_ ),
+	nSavedRHSEvaluations_( other.nSavedRHSEvaluations_ ),
+	statistics_( other.statistics_ ),
 	is_copy_( true )
 {}
 
@@ -70,6 +77,13 @@ void Integrator::initialize(){
 
 	states_      = StateType( fmu_->nStates(), std::numeric_limits<fmippReal>::quiet_NaN() );
 	time_        = std::numeric_limits<fmippReal>::quiet_NaN();
+	reset();
+}
+
+
+void Integrator::reset()
+{
+	lastTime_ = std::numeric_limits<fmippTime>::quiet_NaN();
 }
 
 
@@ -79,6 +93,9 @@ void Integrator::setType( IntegratorType type )
 
 	properties_.type  = type;
 	stepper_ = IntegratorStepper::createStepper( properties_, fmu_ );
+	if ( ( 0 != stepper_ ) && !stepper_->providesDenseOutput() )
+		properties_.eventLocation = EventLocationType::bisectionSearch;
+	reset();
 }
 
 bool Integrator::Properties::operator==(const Integrator::Properties& prop) 
@@ -92,6 +109,10 @@ bool Integrator::Properties::operator==(const Integrator::Properties& prop)
 		(abstol != abstol && prop.abstol != prop.abstol);
 	ret &= reltol == prop.reltol ||
 		(reltol != reltol && prop.reltol != prop.reltol);
+	ret &= linearSolver == prop.linearSolver;
+	ret &= eventLocation == prop.eventLocation;
+	ret &= jacobianMaxAge == prop.jacobianMaxAge;
+	ret &= refactorizationThreshold == prop.refactorizationThreshold;
 	return ret;
 }
 
@@ -100,7 +121,10 @@ void Integrator::setProperties( Integrator::Properties& properties )
 	if ( 0 != stepper_ )
 		delete stepper_;
 	stepper_ = IntegratorStepper::createStepper( properties, fmu_ );
+	if ( ( 0 != stepper_ ) && !stepper_->providesDenseOutput() )
+		properties.eventLocation = EventLocationType::bisectionSearch;
 	properties_ = properties;
+	reset();
 }
 
 Integrator::Properties Integrator::getProperties() const
@@ -109,19 +133,42 @@ Integrator::Properties Integrator::getProperties() const
 }
 
 
+Integrator::JacobianStatistics Integrator::getJacobianStatistics() const
+{
+	return stepper_->getJacobianStatistics();
+}
+
+
+Integrator::SwitchingStatistics Integrator::getSwitchingStatistics() const
+{
+	return stepper_->getSwitchingStatistics();
+}
+
+
 Integrator::EventInfo Integrator::integrate( fmippTime step_size, fmippTime dt, fmippTime eventSearchPrecision )
 {
+	StatisticsTimer integrationTimer( statistics_.integrationTime );
+
 	// Get current time.
 	time_ = fmu_->getTime();
 
 	// Get current continuous states.
 	fmu_->getContinuousStates( &states_.front() );
 
+	// Restart the stepper only if the solution is not continuous since the last call, i.e.,
+	// if time or states have been changed externally or reset() has been called.
+	if ( ( time_ != lastTime_ ) || ( states_ != lastStates_ ) )
+		stepper_->reset();
+	else
+		nSavedRHSEvaluations_ += stepper_->nRestartEvaluations();
+
 	// Invoke integration method.
 	stepper_->invokeMethod( eventInfo_, states_, time_, step_size, dt, eventSearchPrecision );
 
 	// if no event happened, return
 	if ( !eventInfo_.stateEvent ){
+		lastTime_   = fmu_->getTime();
+		lastStates_ = states_;
 		return eventInfo_;
 	} // else, use a binary search to locate the event upt to the eventSearchPrecision_
 	else{
@@ -131,9 +178,15 @@ Integrator::EventInfo Integrator::integrate( fmippTime step_size, fmippTime dt,
 		 *    * tUpper     first time where the stepper detected an event
 		 *                 this variable gets written by invokeMethod
 		 */
+		StatisticsTimer eventLocationTimer( statistics_.eventLocationTime );
+
+		// the stepper wrote the states at tLower into the fmu
+		fmu_->getContinuousStates( &states_.front() );
+
 		if ( eventInfo_.tUpper > time_ + step_size ){
 			// in case the stepper adapted the step size, make sure you only search
 			// for an event within the integration limits
+			StateType states_bak = states_;
 
 			fmippTime currentTime = fmu_->getTime();
 			fmippTime stepSize =  time_ + step_size - fmu_->getTime();
@@ -144,11 +197,26 @@ Integrator::EventInfo Integrator::integrate( fmippTime step_size, fmippTime dt,
 			fmu_->setTime( time_ + step_size );
 			if ( !fmu_->checkStateEvent() ){
 				eventInfo_.stateEvent = false;
+				lastTime_   = fmu_->getTime();
+				lastStates_ = states_;
 				return eventInfo_;
 			}
+
+			// set back to tLower
+			states_ = states_bak;
+			fmu_->setContinuousStates( &states_[0] );
+			fmu_->setTime( eventInfo_.tLower );
 			eventInfo_.tUpper = time_ + step_size;
 		}
+
+		// use the root finder if possible
+		if ( ( EventLocationType::denseRootFinding == properties_.eventLocation ) &&
+		     ( 0 != fmu_->nEventInds() ) )
+			locateStateEvent( eventSearchPrecision );
+
 		while ( eventInfo_.tUpper - eventInfo_.tLower > eventSearchPrecision/2.0 ){
+			++statistics_.eventIterations;
+
 			// create backup states
 			StateType states_bak = states_;
 
@@ -183,11 +251,86 @@ Integrator::EventInfo Integrator::integrate( fmippTime step_size, fmippTime dt,
 		// make sure the event is *strictly* inside the interval [tLower_, tUpper_]
 		eventInfo_.tUpper += eventSearchPrecision/8.0;
 		time_              = eventInfo_.tLower;
+
+		// the stepper has to be restarted after the event
+		reset();
 		return eventInfo_;
 	}
 }
 
 
+void Integrator::locateStateEvent( fmippTime eventSearchPrecision )
+{
+	const fmippSize nEventInds = fmu_->nEventInds();
+	fmippTime tLower = eventInfo_.tLower;
+	fmippTime tUpper = eventInfo_.tUpper;
+
+	// event indicators at the limits of the event interval. The fmu ( and states_ ) are
+	// at tLower.
+	StateType statesLower = states_;
+	std::vector<fmippReal> gLower( nEventInds ), gUpper( nEventInds ), g( nEventInds );
+	fmu_->getEventIndicators( &gLower.front() );
+	stepper_->calcState( tUpper, states_ );
+	fmu_->setTime( tUpper );
+	fmu_->setContinuousStates( &states_[0] );
+	fmu_->getEventIndicators( &gUpper.front() );
+
+	// side of the interval that has been replaced by the last iteration ( -1: lower, 1: upper )
+	int side = 0;
+	while ( tUpper - tLower > eventSearchPrecision/2.0 ){
+		++statistics_.eventIterations;
+
+		// regula falsi for every indicator that changes its sign, the earliest root is used
+		fmippTime t = tUpper;
+		bool signChange = false;
+		for ( fmippSize i = 0; i < nEventInds; i++ )
+			if ( gLower[i] * gUpper[i] < 0 ){
+				t = std::min( t, tLower + gLower[i] * ( tUpper - tLower ) / ( gLower[i] - gUpper[i] ) );
+				signChange = true;
+			}
+		if ( !signChange )
+			t = ( tLower + tUpper )/2.0;
+
+		// keep away from the limits, this guarantees termination
+		t = std::max( tLower + eventSearchPrecision/4.0, std::min( tUpper - eventSearchPrecision/4.0, t ) );
+
+		// evaluate the event indicators at the interpolated states
+		stepper_->calcState( t, states_ );
+		fmu_->setTime( t );
+		fmu_->setContinuousStates( &states_[0] );
+		fmu_->getEventIndicators( &g.front() );
+
+		bool event = false;
+		for ( fmippSize i = 0; i < nEventInds; i++ )
+			event |= ( gLower[i] * g[i] < 0 );
+
+		// Illinois: halve the indicators at the limit that is retained for the second time
+		if ( event ){
+			tUpper = t;
+			gUpper.swap( g );
+			if ( 1 == side )
+				for ( fmippSize i = 0; i < nEventInds; i++ ) gLower[i] /= 2.0;
+			side = 1;
+		} else {
+			tLower = t;
+			gLower.swap( g );
+			statesLower = states_;
+			if ( -1 == side )
+				for ( fmippSize i = 0; i < nEventInds; i++ ) gUpper[i] /= 2.0;
+			side = -1;
+		}
+	}
+
+	// write the states at tLower into the fmu
+	states_ = statesLower;
+	fmu_->setTime( tLower );
+	fmu_->setContinuousStates( &states_[0] );
+
+	eventInfo_.tLower = tLower;
+	eventInfo_.tUpper = tUpper;
+}
+
+
 // get time horizon for the event
 void Integrator::getEventHorizon( fmippTime& tLower, fmippTime& tUpper ){
 	tLower = eventInfo_.tLower;
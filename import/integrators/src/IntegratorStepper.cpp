@@ -10,6 +10,10 @@
  */
 
 #include <cstdio>
+#include <cmath>
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
 
 // Boost Ublas type checks drastically slow down the rosenbrock4 integrator
 // performance. Hence, they were disabled.
@@ -24,6 +28,10 @@
 #include <sunlinsol/sunlinsol_dense.h>
 #include <sundials/sundials_dense.h> /* definitions DlsMat DENSE_ELEM */
 #include <sundials/sundials_types.h> /* definition of type realtype */
+#ifdef USE_SUNDIALS_KLU
+#include <sunmatrix/sunmatrix_sparse.h> /* sparse SUNMatrix ( CSR format ) */
+#include <sunlinsol/sunlinsol_klu.h>    /* sparse direct solver KLU */
+#endif // USE_SUNDIALS_KLU
 #define Ith(v,i)    NV_Ith_S(v,i)       /* Ith numbers components 1..NEQ */
 #endif // USE_SUNDIALS
 
@@ -33,6 +41,7 @@
 #include "import/base/include/FMUModelExchangeBase.h"
 #include "import/base/include/DynamicalSystem.h"
 #include "import/integrators/include/IntegratorStepper.h"
+#include "import/integrators/include/LinearSolver.h"
 
 using namespace boost::numeric::odeint;
 
@@ -47,12 +56,31 @@ struct SystemWrapper {
 	SystemWrapper( DynamicalSystem* ds ) : ds_( ds ){}
 
 	void operator()( const StateType& x, StateType& dx, fmippTime t ){
+		Integrator::Statistics& statistics = ds_->integratorStatistics();
+		StatisticsTimer timer( statistics.rhsTime );
+		++statistics.rhsEvaluations;
+
 		ds_->setTime( t );
 		ds_->setContinuousStates( &x[0] );
 		ds_->getDerivatives( &dx[0] );
 	}
 };
 
+/**
+ * Count an accepted step of an odeint stepper with dense output, which retries rejected steps
+ * internally. Every attempt of these steppers evaluates the RHS the same number of times
+ * ( possibly plus one evaluation at the initial point ), hence the number of attempts can be
+ * derived from the RHS evaluations since the beginning of the step.
+ */
+static void countDenseOutputStep( Integrator::Statistics& statistics, fmippSize rhsEvaluationsBefore,
+	fmippSize rhsEvaluationsPerAttempt )
+{
+	fmippSize attempts = ( statistics.rhsEvaluations - rhsEvaluationsBefore )/rhsEvaluationsPerAttempt;
+	++statistics.acceptedSteps;
+	if ( attempts > 1 )
+		statistics.rejectedSteps += attempts - 1;
+}
+
 /**
  * Base class for all implementations of odeint steppers
  *
@@ -104,7 +132,6 @@ public:
 
 				// force stepsize
 				do_step_const( eventInfo, states, currentTime, dt );
-				reset();
 
 				// exit the while loop next time
 				stop = true;
@@ -112,6 +139,8 @@ public:
 				//do_step
 				do_step( eventInfo, states, currentTime, dt );
 			}
+			++fmu_->integratorStatistics().acceptedSteps;
+
 			// update the state and time
 			fmu_->setTime( currentTime );
 			fmu_->setContinuousStates( &states[0] );
@@ -236,10 +265,11 @@ public:
 
 	void do_step( EventInfo& eventInfo, StateType& states,
 		      fmippTime& currentTime, fmippTime& dt ){
-		do {
+		res_ = stepper.try_step( sys_, states, currentTime, dt );
+		while ( res_ == fail ){
+			++fmu_->integratorStatistics().rejectedSteps;
 			res_ = stepper.try_step( sys_, states, currentTime, dt );
 		}
-		while ( res_ == fail );
 	}
 };
 
@@ -256,11 +286,13 @@ class DormandPrince : public IntegratorStepper
 	/// Runge-Kutta-Dormand-Prince controlled stepper with dense output.
 	dense_stepper stepper;
 	SystemWrapper sys_;
+	bool initialized_; ///< false iff the stepper has to be initialized by the next invokeMethod
 
 public:
 	DormandPrince( DynamicalSystem* fmu, Integrator::Properties& properties ) :
 		IntegratorStepper( fmu ),
-		sys_( fmu )
+		sys_( fmu ),
+		initialized_( false )
 	{
 		properties.name  = "Dormand Prince";
 		properties.order = 5;
@@ -282,23 +314,43 @@ public:
 			   fmippTime step_size,
 			   fmippReal dt,
 			   fmippReal eventSearchPrecision ){
-		stepper.initialize( states, time, dt );
+		if ( !initialized_ ){
+			stepper.initialize( states, time, dt );
+			initialized_ = true;
+		}
+
+		// the last step of the previous call might already cover a part of the interval
+		bool stepAhead = stepper.current_time() > time;
 		while ( true ){
 			// perform a step
-			stepper.do_step( sys_ );
+			if ( stepAhead )
+				stepAhead = false;
+			else {
+				// every attempt of dopri5 evaluates the RHS six times ( FSAL )
+				Integrator::Statistics& statistics = fmu_->integratorStatistics();
+				fmippSize rhsEvaluations = statistics.rhsEvaluations;
+				stepper.do_step( sys_ );
+				countDenseOutputStep( statistics, rhsEvaluations, 6 );
+			}
 
 			// event detection like in OdeintStepper
 			fmu_->setTime( stepper.current_time() );
 			fmu_->setContinuousStates( &stepper.current_state()[0] );
 			if ( fmu_->checkStateEvent() ){
 				// set back to the backup state/time
-				fmu_->setTime( stepper.previous_time() );
-				fmu_->setContinuousStates( &stepper.previous_state()[0] );
+				fmippTime tLower = std::max( stepper.previous_time(), time );
+				if ( tLower == time ){
+					fmu_->setTime( time );
+					fmu_->setContinuousStates( &states[0] );
+				} else {
+					fmu_->setTime( stepper.previous_time() );
+					fmu_->setContinuousStates( &stepper.previous_state()[0] );
+				}
 
 				// tell the integrator about the event
 				eventInfo.stepEvent  = false;
 				eventInfo.stateEvent = true;
-				eventInfo.tLower     = stepper.previous_time();
+				eventInfo.tLower     = tLower;
 				eventInfo.tUpper     = stepper.current_time();
 
 				return;
@@ -339,9 +391,18 @@ public:
 		fmu_->setContinuousStates( &states[0] );
 	}
 
+	bool providesDenseOutput() const { return true; }
+
+	void calcState( fmippTime t, StateType& states ){
+		stepper.calc_state( t, states );
+	}
+
 	void reset(){
-		/// \todo Test if this is really OK. Semms like initialize makes reset unnecessary.
+		initialized_ = false;
 	}
+
+	/// initialize discards the derivative at the current point ( FSAL )
+	fmippSize nRestartEvaluations() const { return 1; }
 };
 
 
@@ -383,10 +444,11 @@ public:
 
 	void do_step( EventInfo& eventInfo, StateType& states,
 		      fmippTime& currentTime, fmippTime& dt ){
-		do {
+		res_ = stepper.try_step( sys_, states, currentTime, dt );
+		while ( res_ == fail ){
+			++fmu_->integratorStatistics().rejectedSteps;
 			res_ = stepper.try_step( sys_, states, currentTime, dt );
 		}
-		while ( res_ == fail );
 	}
 };
 
@@ -402,6 +464,7 @@ class BulirschStoer : public IntegratorStepper
 	/// Bulirsch-Stoer dense output stepper.
 	bulirsch_stoer_dense_out< StateType > stepper;
 	SystemWrapper sys_;
+	bool initialized_; ///< false iff the stepper has to be initialized by the next invokeMethod
 
 public:
 	BulirschStoer( DynamicalSystem* fmu, Integrator::Properties& properties ) :
@@ -413,7 +476,8 @@ public:
 			properties.reltol != properties.reltol ?
 			1.0e-6 : properties.reltol
 			),
-		sys_( fmu )
+		sys_( fmu ),
+		initialized_( false )
 	{
 		properties.name  = "Bulirsch Stoer";
 		properties.order = 0;
@@ -432,24 +496,42 @@ public:
 			   fmippTime step_size,
 			   fmippReal dt,
 			   fmippReal eventSearchPrecision ){
-		reset();
-		stepper.initialize( states, time, dt );
+		if ( !initialized_ ){
+			stepper.reset();
+			stepper.initialize( states, time, dt );
+			initialized_ = true;
+		}
+
+		// the last step of the previous call might already cover a part of the interval
+		bool stepAhead = stepper.current_time() > time;
 		while ( true ){
 			// perform a step
-			stepper.do_step( sys_ );
+			if ( stepAhead )
+				stepAhead = false;
+			else {
+				// the rejections are not visible, the number of stages varies
+				stepper.do_step( sys_ );
+				++fmu_->integratorStatistics().acceptedSteps;
+			}
 
 			// event detection like in OdeintStepper
 			fmu_->setTime( stepper.current_time() );
 			fmu_->setContinuousStates( &stepper.current_state()[0] );
 			if( fmu_->checkStateEvent() ){
 				// set back the backup state/time
-				fmu_->setTime( stepper.previous_time() );
-				fmu_->setContinuousStates( &stepper.previous_state()[0] );
+				fmippTime tLower = std::max( stepper.previous_time(), time );
+				if ( tLower == time ){
+					fmu_->setTime( time );
+					fmu_->setContinuousStates( &states[0] );
+				} else {
+					fmu_->setTime( stepper.previous_time() );
+					fmu_->setContinuousStates( &stepper.previous_state()[0] );
+				}
 
 				// tell the integrator about the event
 				eventInfo.stateEvent = true;
 				eventInfo.stepEvent  = false;
-				eventInfo.tLower = stepper.previous_time();
+				eventInfo.tLower = tLower;
 				eventInfo.tUpper = stepper.current_time();
 
 				return;
@@ -486,9 +568,18 @@ public:
 		time += dt;
 	}
 
+	bool providesDenseOutput() const { return true; }
+
+	void calcState( fmippTime t, StateType& states ){
+		stepper.calc_state( t, states );
+	}
+
 	void reset(){
-		stepper.reset();
+		initialized_ = false;
 	}
+
+	/// initialize discards the derivative at the current point
+	fmippSize nRestartEvaluations() const { return 1; }
 };
 
 
@@ -532,17 +623,205 @@ public:
 
 
 
+/**
+ * Reuse of the Jacobian and its factorization by the Rosenbrock stepper ( Jacobian aging ).
+ *
+ * The Jacobian is evaluated again if it has been used for Properties::jacobianMaxAge accepted
+ * steps or if a step has been rejected and the Jacobian has not been evaluated at the current
+ * point anyway. The matrix is factorized again together with the Jacobian or if the step size
+ * changed by more than Properties::refactorizationThreshold.
+ */
+struct JacobianReusePolicy
+{
+	const int       maxAge;          ///< maximum number of accepted steps per Jacobian ( 0: no limit )
+	const fmippReal threshold;       ///< relative change of alpha that causes a new factorization
+	bool            valid;           ///< false iff there is no Jacobian since the last reset
+	int             age;             ///< number of accepted steps since the evaluation of the Jacobian
+	fmippTime       tLastAttempt;    ///< starting time of the last attempted step
+	fmippReal       alphaFactorized; ///< alpha of the current factorization
+	Integrator::JacobianStatistics statistics; ///< hits and misses
+
+	JacobianReusePolicy( int jacobianMaxAge, fmippReal refactorizationThreshold ) :
+		maxAge( jacobianMaxAge ),
+		threshold( refactorizationThreshold ),
+		valid( false ),
+		age( 0 ),
+		tLastAttempt( 0.0 ),
+		alphaFactorized( 0.0 )
+	{}
+};
+
+
+/**
+ * The 4th order Rosenbrock method from odeint ( rosenbrock4 ) with a pluggable linear solver.
+ *
+ * The implementation follows odeint's rosenbrock4 stepper, but uses a LinearSolver for the
+ * evaluation of the Jacobian, the factorization and the substitutions. It fulfills the
+ * requirements of odeint's rosenbrock4_controller and rosenbrock4_dense_output.
+ */
+class Rosenbrock4Stepper
+{
+public:
+	typedef fmippReal value_type;
+	typedef boost::numeric::ublas::vector< value_type > state_type;
+	typedef state_type deriv_type;
+	typedef value_type time_type;
+	typedef initially_resizer resizer_type;
+	typedef stepper_tag stepper_category;
+	typedef unsigned short order_type;
+	typedef state_wrapper< state_type > wrapped_state_type;
+	typedef state_wrapper< deriv_type > wrapped_deriv_type;
+	typedef default_rosenbrock_coefficients< value_type > rosenbrock_coefficients;
+
+	static const order_type stepper_order = rosenbrock_coefficients::stepper_order;
+	static const order_type error_order = rosenbrock_coefficients::error_order;
+
+	Rosenbrock4Stepper( LinearSolver* solver, JacobianReusePolicy* reuse, size_t n ) :
+		solver_( solver ),
+		reuse_( reuse ),
+		dfdt_( n ), dxdt_( n ), dxdtnew_( n ),
+		g1_( n ), g2_( n ), g3_( n ), g4_( n ), g5_( n ),
+		cont3_( n ), cont4_( n ), xtmp_( n )
+	{}
+
+	order_type order() const { return stepper_order; }
+
+	template< class System >
+	void do_step( System system, const state_type &x, time_type t, state_type &xout,
+		      time_type dt, state_type &xerr )
+	{
+		const size_t n = x.size();
+
+		system( x, dxdt_, t );
+		updateJacobian( x, t, 1.0 / coef_.gamma / dt );
+
+		for( size_t i = 0; i < n; ++i )
+			g1_[i] = dxdt_[i] + dt * coef_.d1 * dfdt_[i];
+		solver_->solve( &g1_[0] );
+
+		for( size_t i = 0; i < n; ++i )
+			xtmp_[i] = x[i] + coef_.a21 * g1_[i];
+		system( xtmp_, dxdtnew_, t + coef_.c2 * dt );
+		for( size_t i = 0; i < n; ++i )
+			g2_[i] = dxdtnew_[i] + dt * coef_.d2 * dfdt_[i] + coef_.c21 * g1_[i] / dt;
+		solver_->solve( &g2_[0] );
+
+		for( size_t i = 0; i < n; ++i )
+			xtmp_[i] = x[i] + coef_.a31 * g1_[i] + coef_.a32 * g2_[i];
+		system( xtmp_, dxdtnew_, t + coef_.c3 * dt );
+		for( size_t i = 0; i < n; ++i )
+			g3_[i] = dxdtnew_[i] + dt * coef_.d3 * dfdt_[i] +
+				( coef_.c31 * g1_[i] + coef_.c32 * g2_[i] ) / dt;
+		solver_->solve( &g3_[0] );
+
+		for( size_t i = 0; i < n; ++i )
+			xtmp_[i] = x[i] + coef_.a41 * g1_[i] + coef_.a42 * g2_[i] + coef_.a43 * g3_[i];
+		system( xtmp_, dxdtnew_, t + coef_.c4 * dt );
+		for( size_t i = 0; i < n; ++i )
+			g4_[i] = dxdtnew_[i] + dt * coef_.d4 * dfdt_[i] +
+				( coef_.c41 * g1_[i] + coef_.c42 * g2_[i] + coef_.c43 * g3_[i] ) / dt;
+		solver_->solve( &g4_[0] );
+
+		for( size_t i = 0; i < n; ++i )
+			xtmp_[i] = x[i] + coef_.a51 * g1_[i] + coef_.a52 * g2_[i] +
+				coef_.a53 * g3_[i] + coef_.a54 * g4_[i];
+		system( xtmp_, dxdtnew_, t + dt );
+		for( size_t i = 0; i < n; ++i )
+			g5_[i] = dxdtnew_[i] + ( coef_.c51 * g1_[i] + coef_.c52 * g2_[i] +
+						 coef_.c53 * g3_[i] + coef_.c54 * g4_[i] ) / dt;
+		solver_->solve( &g5_[0] );
+
+		for( size_t i = 0; i < n; ++i )
+			xtmp_[i] += g5_[i];
+		system( xtmp_, dxdtnew_, t + dt );
+		for( size_t i = 0; i < n; ++i )
+			xerr[i] = dxdtnew_[i] + ( coef_.c61 * g1_[i] + coef_.c62 * g2_[i] + coef_.c63 * g3_[i] +
+						  coef_.c64 * g4_[i] + coef_.c65 * g5_[i] ) / dt;
+		solver_->solve( &xerr[0] );
+
+		for( size_t i = 0; i < n; ++i )
+			xout[i] = xtmp_[i] + xerr[i];
+	}
+
+	void prepare_dense_output()
+	{
+		const size_t n = g1_.size();
+		for( size_t i = 0; i < n; ++i ) {
+			cont3_[i] = coef_.d21 * g1_[i] + coef_.d22 * g2_[i] + coef_.d23 * g3_[i] +
+				coef_.d24 * g4_[i] + coef_.d25 * g5_[i];
+			cont4_[i] = coef_.d31 * g1_[i] + coef_.d32 * g2_[i] + coef_.d33 * g3_[i] +
+				coef_.d34 * g4_[i] + coef_.d35 * g5_[i];
+		}
+	}
+
+	void calc_state( time_type t, state_type &x,
+			 const state_type &x_old, time_type t_old,
+			 const state_type &x_new, time_type t_new )
+	{
+		const size_t n = g1_.size();
+		time_type dt = t_new - t_old;
+		time_type s = ( t - t_old ) / dt;
+		time_type s1 = 1.0 - s;
+		for( size_t i = 0; i < n; ++i )
+			x[i] = x_old[i] * s1 + s * ( x_new[i] + s1 * ( cont3_[i] + s * cont4_[i] ) );
+	}
+
+	template< class StateType >
+	void adjust_size( const StateType &x ) {}
+
+private:
+	/// Evaluate the Jacobian at ( x, t ) and factorize alpha*I - J unless they can be reused.
+	void updateJacobian( const state_type &x, time_type t, value_type alpha )
+	{
+		JacobianReusePolicy& r = *reuse_;
+
+		// the controller retries a rejected step from the same point
+		const bool rejected = r.valid && ( t == r.tLastAttempt );
+		if ( r.valid && !rejected )
+			++r.age;
+		r.tLastAttempt = t;
+
+		bool factorize = false;
+		if ( !r.valid || ( r.maxAge > 0 && r.age >= r.maxAge ) || ( rejected && r.age > 0 ) ) {
+			solver_->evaluateJacobian( &x[0], t, &dfdt_[0] );
+			r.valid = true;
+			r.age = 0;
+			++r.statistics.jacobianMisses;
+			factorize = true;
+		} else {
+			++r.statistics.jacobianHits;
+		}
+
+		if ( factorize || !( std::fabs( alpha - r.alphaFactorized ) <= r.threshold*alpha ) ) {
+			solver_->factorize( alpha );
+			r.alphaFactorized = alpha;
+			++r.statistics.factorizationMisses;
+		} else {
+			++r.statistics.factorizationHits;
+		}
+	}
+
+	LinearSolver* solver_;   ///< linear solver, owned by the Rosenbrock stepper
+	JacobianReusePolicy* reuse_; ///< Jacobian reuse, owned by the Rosenbrock stepper
+	state_type dfdt_, dxdt_, dxdtnew_;
+	state_type g1_, g2_, g3_, g4_, g5_;
+	state_type cont3_, cont4_;
+	state_type xtmp_;
+	const rosenbrock_coefficients coef_;
+};
+
+
 /**
  * Implicit 4th order Rosenbrock method
  *
- * Suited for stiff systems.
+ * Suited for stiff systems. The linear systems are solved by the linear solver specified in
+ * Integrator::Properties::linearSolver. The Jacobian and its factorization are reused over
+ * several steps ( see JacobianReusePolicy ).
  */
 class Rosenbrock : public IntegratorStepper
 {
 	/// storage type for states
 	typedef boost::numeric::ublas::vector< fmippReal > VectorType;
-	/// storage type for jacobians
-	typedef boost::numeric::ublas::matrix< fmippReal > MatrixType;
 
 	/// Different system wrapper using the ublas vectors as StateType
 	struct SystemWrapper_vector{
@@ -551,6 +830,10 @@ class Rosenbrock : public IntegratorStepper
 		/// rhs function
 		void operator()( const VectorType& x , VectorType &dx , fmippTime t ) const
 		{
+			Integrator::Statistics& statistics = ds_->integratorStatistics();
+			StatisticsTimer timer( statistics.rhsTime );
+			++statistics.rhsEvaluations;
+
 			// call the rhs function from the ds_
 			ds_->setTime( t );
 			ds_->setContinuousStates( &x[0] );
@@ -558,29 +841,11 @@ class Rosenbrock : public IntegratorStepper
 		}
 	};
 
-	/// Wrapper around the Jacobian function.
-	struct jacobi_wrapper{
-		DynamicalSystem* ds_;
-		jacobi_wrapper( DynamicalSystem* ds ) : ds_( ds ){}
-		/// jacobi function
-		void operator()( const VectorType &x , MatrixType &jacobi , const fmippTime &t ,
-				 VectorType &dfdt ) const
-		{
-			if ( ds_->providesJacobian() ){
-				ds_->setTime( t );
-				ds_->setContinuousStates( &x[0] );
-				ds_->getJac( &jacobi(0,0) );
-				jacobi = boost::numeric::ublas::trans( jacobi );
-			}
-			else
-				ds_->getNumericalJacobian( &jacobi(0,0), &x[0], &dfdt[0], t );
-		}
-	};
-
-	typedef rosenbrock4_dense_output< rosenbrock4_controller< rosenbrock4< double > > > Stepper;
+	typedef rosenbrock4_dense_output< rosenbrock4_controller< Rosenbrock4Stepper > > Stepper;
 
-	SystemWrapper_vector  sys_;
-	jacobi_wrapper         jac_;
+	SystemWrapper_vector   sys_;
+	LinearSolver*          solver_;
+	JacobianReusePolicy    reuse_;
 	int                    neq;
 	fmippTime                time_bak_;
 	VectorType             statesV_;
@@ -588,6 +853,8 @@ class Rosenbrock : public IntegratorStepper
 	Stepper                stepper;
 	DynamicalSystem*       ds_;
 	controlled_step_result res;
+	bool                   initialized_; ///< false iff the stepper has to be initialized by the
+	                                     ///  next invokeMethod
 
 	/*
 	 * the rosenbrock stepper only works if the types ublas::vector and ublas::matrix is used.
@@ -609,19 +876,26 @@ public:
 	Rosenbrock( DynamicalSystem* ds, Integrator::Properties& properties ):
 		IntegratorStepper( ds ),
 		sys_( ds ),
-		jac_( ds ),
+		solver_( LinearSolver::createLinearSolver( properties.linearSolver, ds ) ),
+		// rosenbrock4 is not a W-method, an outdated Jacobian reduces its order. Hence, the
+		// Jacobian is evaluated in every step by default.
+		reuse_( properties.jacobianMaxAge < 0 ? 1 : properties.jacobianMaxAge,
+			properties.refactorizationThreshold ),
 		neq( ds->nStates() ),
 		statesV_( neq ),
-		stepper( make_dense_output( properties.abstol != properties.abstol ?
-					    1.0e-6 : properties.abstol,
-					    properties.reltol != properties.reltol ?
-					    1.0e-6 : properties.reltol,
-					    rosenbrock4< double >() )
+		stepper( rosenbrock4_controller< Rosenbrock4Stepper >(
+				 properties.abstol != properties.abstol ?
+				 1.0e-6 : properties.abstol,
+				 properties.reltol != properties.reltol ?
+				 1.0e-6 : properties.reltol,
+				 Rosenbrock4Stepper( solver_, &reuse_, neq ) )
 			 ),
-		ds_( ds )
+		ds_( ds ),
+		initialized_( false )
 	{
 		properties.name  = "Rosenbrock";
 		properties.order = 4;
+		properties.jacobianMaxAge = reuse_.maxAge;
 
 		// add missing tolerances if necessary
 		if ( properties.abstol != properties.abstol )
@@ -629,30 +903,55 @@ public:
 		if ( properties.reltol != properties.reltol )
 			properties.reltol = 1.0e-6;
 	};
+
+	~Rosenbrock()
+	{
+		delete solver_;
+	}
+
 	void invokeMethod( EventInfo& eventInfo,
 			   StateType& states,
 			   fmippTime time,
 			   fmippTime step_size,
 			   fmippTime dt,
 			   fmippTime eventSearchPrecision ){
-		reset();
-		change_type( states, statesV_ );
-		stepper.initialize( statesV_, time, dt );
+		if ( !initialized_ ){
+			change_type( states, statesV_ );
+			stepper.initialize( statesV_, time, dt );
+			initialized_ = true;
+		}
+
+		// the last step of the previous call might already cover a part of the interval
+		bool stepAhead = stepper.current_time() > time;
 		while ( true ){
 			// perform a step
-			stepper.do_step( std::make_pair( sys_, jac_ ) );
+			if ( stepAhead )
+				stepAhead = false;
+			else {
+				// every attempt of rosenbrock4 evaluates the RHS six times
+				Integrator::Statistics& statistics = fmu_->integratorStatistics();
+				fmippSize rhsEvaluations = statistics.rhsEvaluations;
+				stepper.do_step( sys_ );
+				countDenseOutputStep( statistics, rhsEvaluations, 6 );
+			}
 
 			// event detection like in OdeintStepper
 			fmu_->setTime( stepper.current_time() );
 			fmu_->setContinuousStates( &stepper.current_state()[0] );
 			if( fmu_->checkStateEvent() ){
 				// ste back the backup state/time
-				fmu_->setTime( stepper.previous_time() );
-				fmu_->setContinuousStates( &stepper.previous_state()[0] );
+				fmippTime tLower = std::max( stepper.previous_time(), time );
+				if ( tLower == time ){
+					fmu_->setTime( time );
+					fmu_->setContinuousStates( &states[0] );
+				} else {
+					fmu_->setTime( stepper.previous_time() );
+					fmu_->setContinuousStates( &stepper.previous_state()[0] );
+				}
 
 				// tell the integrator about the event
 				eventInfo.stateEvent = true;
-				eventInfo.tLower = stepper.previous_time();
+				eventInfo.tLower = tLower;
 				eventInfo.tUpper = stepper.current_time();
 
 				return;
@@ -691,8 +990,1106 @@ public:
 		time += dt;
 	}
 
+	bool providesDenseOutput() const { return true; }
+
+	void calcState( fmippTime t, StateType& states ){
+		stepper.calc_state( t, statesV_ );
+		change_type( statesV_, states );
+	}
+
+	/// The Jacobian is discarded, since the RHS might have changed.
+	void reset(){
+		initialized_ = false;
+		reuse_.valid = false;
+	}
+
+	Integrator::JacobianStatistics getJacobianStatistics() const
+	{
+		return reuse_.statistics;
+	}
+};
+
+
+/**
+ * Base class for the implicit Runge-Kutta methods RadauIIA and Esdirk.
+ *
+ * The stage equations are solved by a simplified Newton iteration ( Hairer, Wanner: Solving
+ * Ordinary Differential Equations II, Section IV.8 ). The Jacobian and the factorizations are
+ * provided by the linear solver specified in Integrator::Properties::linearSolver and are
+ * reused over several steps: the Jacobian is only evaluated again if the Newton iteration
+ * converges slowly or fails or if it is older than Properties::jacobianMaxAge steps, the
+ * matrices are only factorized again if the step size changes by more than
+ * Properties::refactorizationThreshold.
+ * Small increases of the step size proposed by the controller are ignored for this reason.
+ *
+ * The derived classes implement a single attempt of a step and the dense output, the event
+ * detection is done like in the DormandPrince stepper.
+ */
+class ImplicitRungeKutta : public IntegratorStepper
+{
+protected:
+	/// result of a single attempt of a step
+	enum AttemptResult { stepAccepted, stepRejected, newtonFailed };
+
+	/// maximum number of Newton iterations per step ( stage )
+	static const int maxNewton = 7;
+
+	LinearSolver*   solver_;          ///< linear solver, owned by the stepper
+	const fmippSize neq_;             ///< number of states
+	fmippReal       abstol_;          ///< absolute tolerance
+	fmippReal       reltol_;          ///< relative tolerance
+	fmippReal       fnewt_;           ///< stopping criterion of the Newton iteration
+	fmippReal       thetaJacobian_;   ///< the Jacobian is reused if the Newton iteration
+	                                  ///  contracts faster than this
+	fmippReal       theta_;           ///< contraction rate of the last Newton iteration
+	fmippReal       faccon_;          ///< estimate of the Newton convergence factor
+	const int       jacobianMaxAge_;  ///< maximum number of accepted steps per Jacobian ( 0: no limit )
+	int             jacobianAge_;     ///< number of accepted steps since the evaluation of the Jacobian
+	const fmippReal refactorizationThreshold_; ///< relative change of h that causes a new factorization
+	Integrator::JacobianStatistics statistics_; ///< hits and misses
+
+	fmippTime       t_;               ///< time at the end of the last step
+	fmippTime       tOld_;            ///< time at the beginning of the last step
+	fmippTime       h_;               ///< step size of the next attempt
+	fmippTime       hFactorized_;     ///< step size of the current factorization ( NaN if none )
+	StateType       x_;               ///< states at t_
+	StateType       xOld_;            ///< states at tOld_
+	StateType       dxdt_;            ///< derivatives at t_
+	StateType       dfdt_;            ///< temporary storage for the evaluation of the Jacobian
+	StateType       scal_;            ///< error weights abstol + reltol*|x|
+
+	bool initialized_;      ///< false iff the stepper has to be initialized by the next invokeMethod
+	bool firstStep_;        ///< true until the first step after the initialization is accepted
+	bool rejected_;         ///< true iff the last attempt failed
+	bool needJacobian_;     ///< true iff the Jacobian has to be evaluated before the next attempt
+	bool jacobianCurrent_;  ///< true iff the Jacobian was evaluated at the beginning of this step
+
+	ImplicitRungeKutta( DynamicalSystem* ds, Integrator::Properties& properties ) :
+		IntegratorStepper( ds ),
+		solver_( LinearSolver::createLinearSolver( properties.linearSolver, ds ) ),
+		neq_( ds->nStates() ),
+		thetaJacobian_( 0.001 ),
+		theta_( 0.0 ),
+		faccon_( 1.0 ),
+		// by default, the convergence of the Newton iteration decides when to evaluate the Jacobian
+		jacobianMaxAge_( std::max( properties.jacobianMaxAge, 0 ) ),
+		jacobianAge_( 0 ),
+		refactorizationThreshold_( properties.refactorizationThreshold ),
+		hFactorized_( std::numeric_limits<fmippTime>::quiet_NaN() ),
+		x_( neq_ ), xOld_( neq_ ), dxdt_( neq_ ), dfdt_( neq_ ), scal_( neq_ ),
+		initialized_( false ),
+		firstStep_( true ),
+		rejected_( false ),
+		needJacobian_( true ),
+		jacobianCurrent_( false )
+	{
+		// add missing tolerances if necessary
+		if ( properties.abstol != properties.abstol )
+			properties.abstol = 1.0e-6;
+		if ( properties.reltol != properties.reltol )
+			properties.reltol = 1.0e-6;
+
+		abstol_ = properties.abstol;
+		reltol_ = properties.reltol;
+		properties.jacobianMaxAge = jacobianMaxAge_;
+	}
+
+	/// Evaluate the RHS of the ODE.
+	void rhs( const StateType& x, fmippTime t, StateType& dx )
+	{
+		Integrator::Statistics& statistics = fmu_->integratorStatistics();
+		StatisticsTimer timer( statistics.rhsTime );
+		++statistics.rhsEvaluations;
+
+		fmu_->setTime( t );
+		fmu_->setContinuousStates( &x[0] );
+		fmu_->getDerivatives( &dx[0] );
+	}
+
+	/// Weighted root mean square norm using the error weights scal_.
+	fmippReal norm( const StateType& v ) const
+	{
+		fmippReal sum = 0.0;
+		for ( fmippSize i = 0; i < neq_; ++i )
+			sum += ( v[i]/scal_[i] ) * ( v[i]/scal_[i] );
+		return std::sqrt( sum/neq_ );
+	}
+
+	/// Set the stopping criterion of the Newton iteration according to the relative tolerance.
+	void setNewtonTolerance()
+	{
+		fnewt_ = std::max( 10.0*std::numeric_limits<fmippReal>::epsilon()/reltol_,
+				   std::min( 0.03, std::sqrt( reltol_ ) ) );
+	}
+
+	/**
+	 * Monitor the convergence of the simplified Newton iteration after the update of the
+	 * iteration newt ( starting with 1 ) with the scaled norm dyno.
+	 *
+	 * \returns false iff the iteration is not expected to converge within maxNewton
+	 *          iterations. In this case, hNew is set to a reduced step size.
+	 */
+	bool newtonConverging( int newt, fmippReal dyno, fmippReal& dynold, fmippReal& thqold,
+			       fmippTime& hNew )
+	{
+		if ( newt > 1 ) {
+			fmippReal thq = dyno/dynold;
+			theta_ = ( 2 == newt ) ? thq : std::sqrt( thq*thqold );
+			thqold = thq;
+			if ( theta_ >= 0.99 ) {
+				hNew = 0.5*h_;
+				return false;
+			}
+
+			faccon_ = theta_/( 1.0 - theta_ );
+			fmippReal dyth = faccon_*dyno*std::pow( theta_, maxNewton - 1 - newt )/fnewt_;
+			if ( dyth >= 1.0 ) {
+				fmippReal qnewt = std::max( 1.0e-4, std::min( 20.0, dyth ) );
+				hNew = 0.8*std::pow( qnewt, -1.0/( 4.0 + maxNewton - 1 - newt ) )*h_;
+				return false;
+			}
+		}
+		dynold = std::max( dyno, std::numeric_limits<fmippReal>::epsilon() );
+		return true;
+	}
+
+	/// Factorize the matrices needed for the step size h. Returns false iff they are singular.
+	virtual bool factorize( fmippTime h ) = 0;
+
+	/**
+	 * Try a step of size h_ from ( t_, x_ ). In case the step is accepted, the states and
+	 * times ( t_, x_, dxdt_, tOld_, xOld_ ) and the dense output are updated. In any case,
+	 * hNew is the step size proposed for the next attempt.
+	 */
+	virtual AttemptResult attemptStep( fmippTime& hNew ) = 0;
+
+	/**
+	 * Perform one accepted step, reducing the step size as long as attempts fail. The step
+	 * does not go beyond tEnd, since the dense output is only of order 3.
+	 */
+	void step( fmippTime tEnd )
+	{
+		while ( true ) {
+			if ( std::fabs( h_ ) <= 10.0*std::numeric_limits<fmippTime>::epsilon()*
+			     std::max( 1.0, std::fabs( t_ ) ) )
+				throw std::runtime_error( "step size of the implicit Runge-Kutta method too small" );
+
+			const fmippTime hPlanned = h_;
+			const bool lastStep = ( t_ + 1.0001*h_ >= tEnd );
+			if ( lastStep )
+				h_ = tEnd - t_;
+
+			if ( needJacobian_ ) {
+				solver_->evaluateJacobian( &x_[0], t_, &dfdt_[0] );
+				needJacobian_ = false;
+				jacobianCurrent_ = true;
+				jacobianAge_ = 0;
+				hFactorized_ = std::numeric_limits<fmippTime>::quiet_NaN();
+				++statistics_.jacobianMisses;
+			} else {
+				++statistics_.jacobianHits;
+			}
+
+			AttemptResult result;
+			fmippTime hNew;
+			// the simplified Newton iteration tolerates the factorization of a slightly different h
+			if ( !( std::fabs( h_ - hFactorized_ ) <= refactorizationThreshold_*std::fabs( h_ ) ) ) {
+				hFactorized_ = h_;
+				if ( !factorize( h_ ) )
+					hFactorized_ = std::numeric_limits<fmippTime>::quiet_NaN();
+				++statistics_.factorizationMisses;
+			} else {
+				++statistics_.factorizationHits;
+			}
+
+			if ( hFactorized_ != hFactorized_ ) {
+				hNew = 0.5*h_;
+				result = newtonFailed;
+			} else {
+				result = attemptStep( hNew );
+			}
+
+			if ( stepAccepted == result ) {
+				++fmu_->integratorStatistics().acceptedSteps;
+				if ( lastStep )
+					t_ = tEnd;
+				if ( rejected_ )
+					hNew = std::min( hNew, h_ );
+				firstStep_ = false;
+				rejected_ = false;
+				jacobianCurrent_ = false;
+
+				if ( theta_ <= thetaJacobian_ ) {
+					// keep the Jacobian and avoid a new factorization for small changes of h
+					fmippReal quot = hNew/h_;
+					if ( quot < 1.0 || quot > 1.2 )
+						h_ = hNew;
+				} else {
+					needJacobian_ = true;
+					h_ = hNew;
+				}
+
+				if ( ( jacobianMaxAge_ > 0 ) && ( ++jacobianAge_ >= jacobianMaxAge_ ) )
+					needJacobian_ = true;
+
+				// a shortened last step does not limit the next step size
+				if ( lastStep )
+					h_ = std::max( h_, std::min( hPlanned, hNew ) );
+				return;
+			}
+
+			h_ = ( ( stepRejected == result ) && firstStep_ ) ? 0.1*h_ : hNew;
+			rejected_ = true;
+			++fmu_->integratorStatistics().rejectedSteps;
+
+			// an outdated Jacobian might be the reason for the failure
+			if ( !jacobianCurrent_ )
+				needJacobian_ = true;
+		}
+	}
+
+public:
+
+	~ImplicitRungeKutta()
+	{
+		delete solver_;
+	}
+
+	/// Start the integration at ( t, x ) with the initial step size h.
+	void restart( fmippTime t, const StateType& x, fmippTime h )
+	{
+		t_ = tOld_ = t;
+		x_ = xOld_ = x;
+		h_ = h;
+		rhs( x_, t_, dxdt_ );
+		firstStep_ = true;
+		rejected_ = false;
+		initialized_ = true;
+	}
+
+	/// Perform one accepted step which does not go beyond tEnd ( see step() ).
+	void advance( fmippTime tEnd ) { step( tEnd ); }
+
+	fmippTime currentTime() const { return t_; }           ///< time at the end of the last step
+	fmippTime previousTime() const { return tOld_; }       ///< time at the beginning of the last step
+	const StateType& currentState() const { return x_; }  ///< states at the end of the last step
+	const StateType& previousState() const { return xOld_; } ///< states at the beginning of the last step
+	fmippTime stepSize() const { return h_; }              ///< step size of the next attempt
+
+	void invokeMethod( EventInfo& eventInfo,
+			   StateType& states,
+			   fmippTime time,
+			   fmippTime step_size,
+			   fmippTime dt,
+			   fmippTime eventSearchPrecision ){
+		if ( !initialized_ )
+			restart( time, states, dt );
+
+		// the last step of the previous call might already cover a part of the interval
+		bool stepAhead = t_ > time;
+		while ( true ){
+			// perform a step
+			if ( stepAhead )
+				stepAhead = false;
+			else
+				step( time + step_size );
+
+			// event detection like in OdeintStepper
+			fmu_->setTime( t_ );
+			fmu_->setContinuousStates( &x_[0] );
+			if ( fmu_->checkStateEvent() ){
+				// set back to the backup state/time
+				fmippTime tLower = std::max( tOld_, time );
+				if ( tLower == time ){
+					fmu_->setTime( time );
+					fmu_->setContinuousStates( &states[0] );
+				} else {
+					fmu_->setTime( tOld_ );
+					fmu_->setContinuousStates( &xOld_[0] );
+				}
+
+				// tell the integrator about the event
+				eventInfo.stepEvent  = false;
+				eventInfo.stateEvent = true;
+				eventInfo.tLower     = tLower;
+				eventInfo.tUpper     = t_;
+
+				return;
+			}
+
+			if ( t_ >= time + step_size )
+				break;
+			else if ( fmu_->checkStepEvent() ){
+				// tell the integrator about the event
+				eventInfo.stepEvent  = true;
+				eventInfo.stateEvent = false;
+
+				return;
+			}
+		}
+		// use interoplation to get an approximation for time t.
+		calcState( time + step_size, states );
+
+		// write the results in the FMU
+		fmu_->setTime( time + step_size );
+		fmu_->setContinuousStates( &states[0] );
+
+		// check for step events one more time
+		if ( fmu_->checkStepEvent() )
+			eventInfo.stepEvent = true;
+
+		eventInfo.stateEvent = false;
+	}
+
+	void do_step_const( EventInfo& eventInfo,
+			    std::vector<fmippReal>& states,
+			    fmippTime& time,
+			    fmippTime& dt ){
+		// use interpolation for do_step_const
+		calcState( time + dt, states );
+		time += dt;
+		fmu_->setTime( time );
+		fmu_->setContinuousStates( &states[0] );
+	}
+
+	bool providesDenseOutput() const { return true; }
+
+	/// The Jacobian is kept, the simplified Newton iteration detects whether it is outdated.
 	void reset(){
-		//stepper.reset();
+		initialized_ = false;
+	}
+
+	/// initialize evaluates the derivatives at the initial point
+	fmippSize nRestartEvaluations() const { return 1; }
+
+	Integrator::JacobianStatistics getJacobianStatistics() const
+	{
+		return statistics_;
+	}
+};
+
+
+/// Coefficients of the 3-stage Radau IIA method of order 5.
+struct RadauIIACoefficients
+{
+	const fmippReal c1, c2, c1m1, c2m1, c1mc2;  ///< nodes
+	const fmippReal dd1, dd2, dd3;              ///< coefficients of the error estimate
+	const fmippReal gamma;                      ///< real eigenvalue of the inverse of A
+	fmippReal alpha, beta;                      ///< complex eigenvalues of the inverse of A
+	const fmippReal t11, t12, t13, t21, t22, t23, t31;               ///< transformation T
+	const fmippReal ti11, ti12, ti13, ti21, ti22, ti23, ti31, ti32, ti33; ///< inverse of T
+
+	RadauIIACoefficients() :
+		c1( ( 4.0 - std::sqrt( 6.0 ) )/10.0 ),
+		c2( ( 4.0 + std::sqrt( 6.0 ) )/10.0 ),
+		c1m1( c1 - 1.0 ),
+		c2m1( c2 - 1.0 ),
+		c1mc2( c1 - c2 ),
+		dd1( -( 13.0 + 7.0*std::sqrt( 6.0 ) )/3.0 ),
+		dd2( ( -13.0 + 7.0*std::sqrt( 6.0 ) )/3.0 ),
+		dd3( -1.0/3.0 ),
+		gamma( 30.0/( 6.0 + std::pow( 81.0, 1.0/3.0 ) - std::pow( 9.0, 1.0/3.0 ) ) ),
+		t11( 9.1232394870892942792e-02 ),
+		t12( -0.14125529502095420843 ),
+		t13( -3.0029194105147424492e-02 ),
+		t21( 0.24171793270710701896 ),
+		t22( 0.20412935229379993199 ),
+		t23( 0.38294211275726193779 ),
+		t31( 0.96604818261509293619 ),
+		ti11( 4.3255798900631553510 ),
+		ti12( 0.33919925181580986954 ),
+		ti13( 0.54177053993587487119 ),
+		ti21( -4.1787185915519047273 ),
+		ti22( -0.32768282076106238708 ),
+		ti23( 0.47662355450055045196 ),
+		ti31( -0.50287263494578687595 ),
+		ti32( 2.5719269498556054292 ),
+		ti33( -0.59603920482822492497 )
+	{
+		// 1/( alpha + i*beta ) is an eigenvalue of A
+		const fmippReal alphaA = ( 12.0 - std::pow( 81.0, 1.0/3.0 ) + std::pow( 9.0, 1.0/3.0 ) )/60.0;
+		const fmippReal betaA = ( std::pow( 81.0, 1.0/3.0 ) + std::pow( 9.0, 1.0/3.0 ) )*std::sqrt( 3.0 )/60.0;
+		alpha = alphaA/( alphaA*alphaA + betaA*betaA );
+		beta  = betaA/( alphaA*alphaA + betaA*betaA );
+	}
+};
+
+
+/**
+ * 5th order Radau IIA method with controlled step size.
+ *
+ * The implementation follows the code RADAU5 by Hairer and Wanner. The stage equations of the
+ * collocation method are decoupled by a transformation T that diagonalizes the inverse of the
+ * Runge-Kutta matrix A, such that a real system with the matrix gamma/h*I - J and a complex
+ * system with the matrix ( alpha + i*beta )/h*I - J are solved in every Newton iteration:
+ *
+ *        \f[ T^{-1} A^{-1} T = \left( \begin{array}{ccc} \gamma & 0 & 0 \\ 0 & \alpha & -\beta \\
+ *                                     0 & \beta & \alpha \end{array} \right) \f]
+ *
+ * The method is L-stable and stiffly accurate. The collocation polynomial is used for the dense
+ * output and as starting value of the Newton iteration of the next step.
+ */
+class RadauIIA : public ImplicitRungeKutta
+{
+	const RadauIIACoefficients coef_;
+
+	StateType z1_, z2_, z3_;            ///< stage increments
+	StateType w1_, w2_, w3_;            ///< transformed stage increments
+	StateType f1_, f2_, f3_;            ///< temporary storage ( stage derivatives, Newton updates )
+	StateType cont1_, cont2_, cont3_;   ///< coefficients of the collocation polynomial
+	StateType tmp_, err_;               ///< temporary storage
+
+public:
+	RadauIIA( DynamicalSystem* ds, Integrator::Properties& properties ) :
+		ImplicitRungeKutta( ds, properties ),
+		z1_( neq_ ), z2_( neq_ ), z3_( neq_ ),
+		w1_( neq_ ), w2_( neq_ ), w3_( neq_ ),
+		f1_( neq_ ), f2_( neq_ ), f3_( neq_ ),
+		cont1_( neq_ ), cont2_( neq_ ), cont3_( neq_ ),
+		tmp_( neq_ ), err_( neq_ )
+	{
+		properties.name  = "Radau IIA";
+		properties.order = 5;
+
+		// the error estimate is of order 3, hence the tolerances are transformed like in RADAU5
+		fmippReal quot = abstol_/reltol_;
+		reltol_ = 0.1*std::pow( reltol_, 2.0/3.0 );
+		abstol_ = reltol_*quot;
+		setNewtonTolerance();
+	}
+
+	void calcState( fmippTime t, StateType& states ){
+		if ( t_ == tOld_ ){
+			states = x_;
+			return;
+		}
+		fmippReal s = ( t - t_ )/( t_ - tOld_ );
+		for ( fmippSize i = 0; i < neq_; ++i )
+			states[i] = x_[i] + s*( cont1_[i] + ( s - coef_.c2m1 )*
+						( cont2_[i] + ( s - coef_.c1m1 )*cont3_[i] ) );
+	}
+
+protected:
+
+	bool factorize( fmippTime h )
+	{
+		return solver_->factorize( coef_.gamma/h ) &&
+			solver_->factorizeComplex( coef_.alpha/h, coef_.beta/h );
+	}
+
+	AttemptResult attemptStep( fmippTime& hNew )
+	{
+		for ( fmippSize i = 0; i < neq_; ++i )
+			scal_[i] = abstol_ + reltol_*std::fabs( x_[i] );
+
+		// starting values of the Newton iteration: extrapolate the last collocation polynomial
+		if ( firstStep_ ){
+			std::fill( z1_.begin(), z1_.end(), 0.0 );
+			std::fill( z2_.begin(), z2_.end(), 0.0 );
+			std::fill( z3_.begin(), z3_.end(), 0.0 );
+			std::fill( w1_.begin(), w1_.end(), 0.0 );
+			std::fill( w2_.begin(), w2_.end(), 0.0 );
+			std::fill( w3_.begin(), w3_.end(), 0.0 );
+		} else {
+			const fmippReal c3q = h_/( t_ - tOld_ );
+			const fmippReal c1q = coef_.c1*c3q;
+			const fmippReal c2q = coef_.c2*c3q;
+			for ( fmippSize i = 0; i < neq_; ++i ){
+				const fmippReal ak1 = cont1_[i], ak2 = cont2_[i], ak3 = cont3_[i];
+				z1_[i] = c1q*( ak1 + ( c1q - coef_.c2m1 )*( ak2 + ( c1q - coef_.c1m1 )*ak3 ) );
+				z2_[i] = c2q*( ak1 + ( c2q - coef_.c2m1 )*( ak2 + ( c2q - coef_.c1m1 )*ak3 ) );
+				z3_[i] = c3q*( ak1 + ( c3q - coef_.c2m1 )*( ak2 + ( c3q - coef_.c1m1 )*ak3 ) );
+				w1_[i] = coef_.ti11*z1_[i] + coef_.ti12*z2_[i] + coef_.ti13*z3_[i];
+				w2_[i] = coef_.ti21*z1_[i] + coef_.ti22*z2_[i] + coef_.ti23*z3_[i];
+				w3_[i] = coef_.ti31*z1_[i] + coef_.ti32*z2_[i] + coef_.ti33*z3_[i];
+			}
+		}
+
+		// simplified Newton iteration
+		const fmippReal fac1  = coef_.gamma/h_;
+		const fmippReal alphn = coef_.alpha/h_;
+		const fmippReal betan = coef_.beta/h_;
+		faccon_ = std::pow( std::max( faccon_, std::numeric_limits<fmippReal>::epsilon() ), 0.8 );
+		theta_ = thetaJacobian_;
+		fmippReal dynold = 0.0, thqold = 0.0;
+		int newt = 0;
+		while ( true ){
+			if ( newt >= maxNewton ){
+				hNew = 0.5*h_;
+				return newtonFailed;
+			}
+
+			// RHS at the stages
+			for ( fmippSize i = 0; i < neq_; ++i ) tmp_[i] = x_[i] + z1_[i];
+			rhs( tmp_, t_ + coef_.c1*h_, f1_ );
+			for ( fmippSize i = 0; i < neq_; ++i ) tmp_[i] = x_[i] + z2_[i];
+			rhs( tmp_, t_ + coef_.c2*h_, f2_ );
+			for ( fmippSize i = 0; i < neq_; ++i ) tmp_[i] = x_[i] + z3_[i];
+			rhs( tmp_, t_ + h_, f3_ );
+
+			// residuals of the transformed system
+			for ( fmippSize i = 0; i < neq_; ++i ){
+				const fmippReal a1 = f1_[i], a2 = f2_[i], a3 = f3_[i];
+				f1_[i] = coef_.ti11*a1 + coef_.ti12*a2 + coef_.ti13*a3 - fac1*w1_[i];
+				f2_[i] = coef_.ti21*a1 + coef_.ti22*a2 + coef_.ti23*a3 - alphn*w2_[i] + betan*w3_[i];
+				f3_[i] = coef_.ti31*a1 + coef_.ti32*a2 + coef_.ti33*a3 - betan*w2_[i] - alphn*w3_[i];
+			}
+			solver_->solve( &f1_[0] );
+			solver_->solveComplex( &f2_[0], &f3_[0] );
+			++newt;
+
+			fmippReal dyno = 0.0;
+			for ( fmippSize i = 0; i < neq_; ++i )
+				dyno += ( f1_[i]/scal_[i] )*( f1_[i]/scal_[i] ) +
+					( f2_[i]/scal_[i] )*( f2_[i]/scal_[i] ) +
+					( f3_[i]/scal_[i] )*( f3_[i]/scal_[i] );
+			dyno = std::sqrt( dyno/( 3*neq_ ) );
+
+			if ( !newtonConverging( newt, dyno, dynold, thqold, hNew ) )
+				return newtonFailed;
+
+			// update the stage increments
+			for ( fmippSize i = 0; i < neq_; ++i ){
+				w1_[i] += f1_[i];
+				w2_[i] += f2_[i];
+				w3_[i] += f3_[i];
+				z1_[i] = coef_.t11*w1_[i] + coef_.t12*w2_[i] + coef_.t13*w3_[i];
+				z2_[i] = coef_.t21*w1_[i] + coef_.t22*w2_[i] + coef_.t23*w3_[i];
+				z3_[i] = coef_.t31*w1_[i] + w2_[i];
+			}
+
+			if ( faccon_*dyno <= fnewt_ )
+				break;
+		}
+
+		// error estimate
+		for ( fmippSize i = 0; i < neq_; ++i ){
+			f2_[i] = ( coef_.dd1*z1_[i] + coef_.dd2*z2_[i] + coef_.dd3*z3_[i] )/h_;
+			err_[i] = f2_[i] + dxdt_[i];
+		}
+		solver_->solve( &err_[0] );
+		fmippReal err = norm( err_ );
+
+		// improve the estimate for stiff components after a rejection
+		if ( err >= 1.0 && ( firstStep_ || rejected_ ) ){
+			for ( fmippSize i = 0; i < neq_; ++i ) tmp_[i] = x_[i] + err_[i];
+			rhs( tmp_, t_, f1_ );
+			for ( fmippSize i = 0; i < neq_; ++i ) err_[i] = f1_[i] + f2_[i];
+			solver_->solve( &err_[0] );
+			err = norm( err_ );
+		}
+		err = std::max( err, 1.0e-10 );
+
+		// step size proposal
+		const fmippReal fac = std::min( 0.9, 0.9*( 1 + 2*maxNewton )/( newt + 2*maxNewton ) );
+		hNew = h_/std::max( 0.125, std::min( 5.0, std::pow( err, 0.25 )/fac ) );
+
+		if ( err >= 1.0 )
+			return stepRejected;
+
+		// coefficients of the collocation polynomial for the dense output
+		for ( fmippSize i = 0; i < neq_; ++i ){
+			cont1_[i] = ( z2_[i] - z3_[i] )/coef_.c2m1;
+			const fmippReal ak = ( z1_[i] - z2_[i] )/coef_.c1mc2;
+			const fmippReal acont3 = ( ak - z1_[i]/coef_.c1 )/coef_.c2;
+			cont2_[i] = ( ak - cont1_[i] )/coef_.c1m1;
+			cont3_[i] = cont2_[i] - acont3;
+		}
+
+		tOld_ = t_;
+		xOld_ = x_;
+		t_ += h_;
+		for ( fmippSize i = 0; i < neq_; ++i )
+			x_[i] += z3_[i];
+		rhs( x_, t_, dxdt_ );
+
+		return stepAccepted;
+	}
+};
+
+
+/**
+ * Coefficients of the L-stable, stiffly accurate ESDIRK method of order 3 with an embedded
+ * method of order 2 ( ARK3(2)4L[2]SA, Kennedy, Carpenter: Additive Runge-Kutta schemes for
+ * convection-diffusion-reaction equations ).
+ */
+struct EsdirkCoefficients
+{
+	const fmippReal gamma;       ///< diagonal of the Runge-Kutta matrix
+	fmippReal c[4];              ///< nodes
+	fmippReal a[4][4];           ///< Runge-Kutta matrix ( the last row equals the weights )
+	fmippReal d[4];              ///< differences of the weights of the method and the embedded method
+
+	EsdirkCoefficients() :
+		gamma( 1767732205903.0/4055673282236.0 )
+	{
+		const fmippReal b[4] = { 1471266399579.0/7840856788654.0, -4482444167858.0/7529755066697.0,
+					 11266239266428.0/11593286722821.0, gamma };
+		const fmippReal bhat[4] = { 2756255671327.0/12835298489170.0, -10771552573575.0/22201958757719.0,
+					    9247589265047.0/10645013368117.0, 2193209047091.0/5459859503100.0 };
+
+		for ( int i = 0; i < 4; ++i ){
+			for ( int j = 0; j < 4; ++j ) a[j][i] = 0.0;
+			a[3][i] = b[i];
+			d[i] = b[i] - bhat[i];
+		}
+		a[1][0] = gamma;
+		a[1][1] = gamma;
+		a[2][0] = 2746238789719.0/10658868560708.0;
+		a[2][1] = -640167445237.0/6845629431997.0;
+		a[2][2] = gamma;
+
+		c[0] = 0.0;
+		c[1] = 2.0*gamma;
+		c[2] = 3.0/5.0;
+		c[3] = 1.0;
+	}
+};
+
+
+/**
+ * 3rd order ESDIRK method with controlled step size.
+ *
+ * A singly diagonally implicit Runge-Kutta method with an explicit first stage. The three
+ * implicit stages are solved one after the other, all of them with the same matrix
+ * 1/( gamma*h )*I - J. The method is L-stable and stiffly accurate. The error estimate of
+ * the embedded method is filtered with ( I - gamma*h*J )^-1 to avoid unnecessary step size
+ * reductions for stiff components. The dense output uses Hermite interpolation.
+ */
+class Esdirk : public ImplicitRungeKutta
+{
+	const EsdirkCoefficients coef_;
+
+	StateType k_[4];     ///< stage derivatives
+	StateType y_;        ///< stage values
+	StateType base_;     ///< explicit part of the stage values
+	StateType delta_;    ///< Newton updates
+	StateType err_;      ///< error estimate
+	StateType dxdtOld_;  ///< derivatives at tOld_
+
+public:
+	Esdirk( DynamicalSystem* ds, Integrator::Properties& properties ) :
+		ImplicitRungeKutta( ds, properties ),
+		y_( neq_ ), base_( neq_ ), delta_( neq_ ), err_( neq_ ), dxdtOld_( neq_ )
+	{
+		properties.name  = "ESDIRK";
+		properties.order = 3;
+
+		for ( int s = 0; s < 4; ++s )
+			k_[s].resize( neq_ );
+		setNewtonTolerance();
+	}
+
+	void calcState( fmippTime t, StateType& states ){
+		if ( t_ == tOld_ ){
+			states = x_;
+			return;
+		}
+		const fmippTime h = t_ - tOld_;
+		const fmippReal s = ( t - tOld_ )/h;
+		const fmippReal h00 = ( 1.0 + 2.0*s )*( 1.0 - s )*( 1.0 - s );
+		const fmippReal h10 = s*( 1.0 - s )*( 1.0 - s );
+		const fmippReal h01 = s*s*( 3.0 - 2.0*s );
+		const fmippReal h11 = s*s*( s - 1.0 );
+		for ( fmippSize i = 0; i < neq_; ++i )
+			states[i] = h00*xOld_[i] + h*h10*dxdtOld_[i] + h01*x_[i] + h*h11*dxdt_[i];
+	}
+
+protected:
+
+	bool factorize( fmippTime h )
+	{
+		return solver_->factorize( 1.0/( coef_.gamma*h ) );
+	}
+
+	AttemptResult attemptStep( fmippTime& hNew )
+	{
+		for ( fmippSize i = 0; i < neq_; ++i )
+			scal_[i] = abstol_ + reltol_*std::fabs( x_[i] );
+
+		const fmippReal hg = coef_.gamma*h_;
+		faccon_ = std::pow( std::max( faccon_, std::numeric_limits<fmippReal>::epsilon() ), 0.8 );
+		fmippReal thetaStep = thetaJacobian_;
+
+		// the first stage is explicit
+		k_[0] = dxdt_;
+
+		for ( int s = 1; s < 4; ++s ){
+			// explicit part of the stage, use the last stage derivative for the prediction
+			for ( fmippSize i = 0; i < neq_; ++i ){
+				base_[i] = x_[i];
+				for ( int j = 0; j < s; ++j )
+					base_[i] += h_*coef_.a[s][j]*k_[j][i];
+				y_[i] = base_[i] + hg*k_[s-1][i];
+			}
+
+			// simplified Newton iteration for y = base + hg*f( y )
+			theta_ = thetaJacobian_;
+			fmippReal dynold = 0.0, thqold = 0.0;
+			int newt = 0;
+			while ( true ){
+				if ( newt >= maxNewton ){
+					hNew = 0.5*h_;
+					return newtonFailed;
+				}
+
+				rhs( y_, t_ + coef_.c[s]*h_, delta_ );
+				for ( fmippSize i = 0; i < neq_; ++i )
+					delta_[i] += ( base_[i] - y_[i] )/hg;
+				solver_->solve( &delta_[0] );
+				++newt;
+
+				fmippReal dyno = norm( delta_ );
+				if ( !newtonConverging( newt, dyno, dynold, thqold, hNew ) )
+					return newtonFailed;
+
+				for ( fmippSize i = 0; i < neq_; ++i )
+					y_[i] += delta_[i];
+
+				if ( faccon_*dyno <= fnewt_ )
+					break;
+			}
+			thetaStep = std::max( thetaStep, theta_ );
+
+			// stage derivative consistent with the stage equation
+			for ( fmippSize i = 0; i < neq_; ++i )
+				k_[s][i] = ( y_[i] - base_[i] )/hg;
+		}
+		theta_ = thetaStep;
+
+		// filtered error estimate ( I - hg*J )^-1 * h * sum d_j k_j
+		for ( fmippSize i = 0; i < neq_; ++i ){
+			err_[i] = 0.0;
+			for ( int j = 0; j < 4; ++j )
+				err_[i] += coef_.d[j]*k_[j][i];
+			err_[i] /= coef_.gamma;
+			scal_[i] = abstol_ + reltol_*std::max( std::fabs( x_[i] ), std::fabs( y_[i] ) );
+		}
+		solver_->solve( &err_[0] );
+		fmippReal err = std::max( norm( err_ ), 1.0e-10 );
+
+		// step size proposal
+		hNew = h_*std::min( 5.0, std::max( 0.2, 0.9*std::pow( err, -1.0/3.0 ) ) );
+
+		if ( err >= 1.0 )
+			return stepRejected;
+
+		// the method is stiffly accurate, the last stage is the new state
+		tOld_ = t_;
+		xOld_ = x_;
+		dxdtOld_ = dxdt_;
+		t_ += h_;
+		x_ = y_;
+		dxdt_ = k_[3];
+
+		return stepAccepted;
+	}
+};
+
+
+/**
+ * Automatic switching between a nonstiff and a stiff method ( similar to LSODA ).
+ *
+ * The integration starts with the explicit Dormand-Prince method. When the problem becomes
+ * stiff, the step size of the explicit method is limited by its stability region, i.e., the
+ * product of the step size h and the spectral radius rho of the Jacobian stays close to the
+ * stability boundary ( about 3.3 on the negative real axis ). The spectral radius is estimated
+ * by a power iteration with finite differences of the RHS ( two evaluations per iteration ),
+ * the Jacobian itself is not needed. Like in DOPRI5 by Hairer and Wanner, the test is only done
+ * periodically as long as no step indicates stiffness. Once h*rho exceeded the boundary for
+ * several steps, the stepper switches to the Radau IIA method. While the implicit method is
+ * active, the stepper switches back as soon as the explicit method would be stable with the
+ * step sizes of the implicit method for several steps.
+ *
+ * Switches are done at the beginning of the next step, such that the dense output of the last
+ * step remains valid.
+ */
+class AutoSwitching : public IntegratorStepper
+{
+	typedef dense_output_runge_kutta< controlled_runge_kutta< runge_kutta_dopri5< StateType > > > dense_stepper;
+
+	/// number of consecutive steps needed for a switch
+	static const int switchSteps = 15;
+	/// number of nonstiff explicit steps which cancel an indication of stiffness
+	static const int nonStiffSteps = 6;
+	/// number of accepted explicit steps between two tests for stiffness
+	static const int testInterval = 10;
+
+	RadauIIA implicit_;       ///< stiff method
+	dense_stepper explicit_;  ///< nonstiff method
+	SystemWrapper sys_;
+	const fmippSize neq_;     ///< number of states
+
+	bool initialized_;        ///< false iff the stepper has to be initialized by the next invokeMethod
+	bool stiff_;              ///< true iff the implicit method made the last step
+	bool switchPending_;      ///< true iff the method is switched before the next step
+	int  stiffCount_;         ///< number of steps indicating a switch
+	int  nonStiffCount_;      ///< number of explicit steps without indication of stiffness
+	fmippSize nTest_;         ///< accepted explicit steps since the last test
+
+	StateType v_, xp_, fx_, fp_; ///< power iteration
+	Integrator::SwitchingStatistics statistics_;
+
+	/**
+	 * One iteration of the power method for the spectral radius of the Jacobian at ( t, x ).
+	 * The direction v_ is kept from one call to the next.
+	 */
+	fmippReal spectralRadius( fmippTime t, const StateType& x )
+	{
+		fmippReal normV = 0.0, normX = 0.0;
+		for ( fmippSize i = 0; i < neq_; ++i ) {
+			normV += v_[i]*v_[i];
+			normX += x[i]*x[i];
+		}
+		if ( 0.0 == normV ) {
+			std::fill( v_.begin(), v_.end(), 1.0 );
+			normV = neq_;
+		}
+		normV = std::sqrt( normV );
+
+		const fmippReal delta = std::sqrt( std::numeric_limits<fmippReal>::epsilon() )*
+			std::max( 1.0, std::sqrt( normX ) );
+		for ( fmippSize i = 0; i < neq_; ++i )
+			xp_[i] = x[i] + delta*v_[i]/normV;
+		sys_( x, fx_, t );
+		sys_( xp_, fp_, t );
+
+		fmippReal normD = 0.0;
+		for ( fmippSize i = 0; i < neq_; ++i ) {
+			v_[i] = fp_[i] - fx_[i];
+			normD += v_[i]*v_[i];
+		}
+		return std::sqrt( normD )/delta;
+	}
+
+	/// Decide whether the method has to be switched after the last step.
+	void testStiffness()
+	{
+		if ( stiff_ ) {
+			// the explicit method would be stable with the step size of the implicit one
+			fmippReal hrho = implicit_.stepSize()*
+				spectralRadius( implicit_.currentTime(), implicit_.currentState() );
+			stiffCount_ = ( hrho < 1.5 ) ? stiffCount_ + 1 : 0;
+		} else {
+			if ( ( ++nTest_ < testInterval ) && ( 0 == stiffCount_ ) )
+				return;
+			nTest_ = 0;
+
+			fmippReal hrho = ( explicit_.current_time() - explicit_.previous_time() )*
+				spectralRadius( explicit_.current_time(), explicit_.current_state() );
+			if ( hrho > 3.0 ) {
+				nonStiffCount_ = 0;
+				++stiffCount_;
+			} else if ( ++nonStiffCount_ == nonStiffSteps ) {
+				stiffCount_ = 0;
+			}
+		}
+
+		if ( stiffCount_ >= switchSteps )
+			switchPending_ = true;
+	}
+
+	/// Switch the method. The new one has to be initialized afterwards.
+	void switchMethod()
+	{
+		if ( stiff_ )
+			++statistics_.switchesToExplicit;
+		else
+			++statistics_.switchesToImplicit;
+		stiff_ = !stiff_;
+		switchPending_ = false;
+		stiffCount_ = 0;
+		nonStiffCount_ = 0;
+		nTest_ = 0;
+	}
+
+	/// Initialize the active method at ( t, x ) with the initial step size h.
+	void initialize( fmippTime t, const StateType& x, fmippTime h )
+	{
+		if ( stiff_ )
+			implicit_.restart( t, x, h );
+		else
+			explicit_.initialize( x, t, h );
+	}
+
+	/// Perform one step with the active method, which does not go beyond tEnd for the implicit one.
+	void step( fmippTime tEnd )
+	{
+		if ( switchPending_ ) {
+			if ( stiff_ ) {
+				switchMethod();
+				initialize( implicit_.currentTime(), implicit_.currentState(), implicit_.stepSize() );
+			} else {
+				switchMethod();
+				initialize( explicit_.current_time(), explicit_.current_state(),
+					    explicit_.current_time_step() );
+			}
+		}
+
+		if ( stiff_ ) {
+			implicit_.advance( tEnd );
+			++statistics_.implicitSteps;
+		} else {
+			// every attempt of dopri5 evaluates the RHS six times ( FSAL )
+			Integrator::Statistics& statistics = fmu_->integratorStatistics();
+			fmippSize rhsEvaluations = statistics.rhsEvaluations;
+			explicit_.do_step( sys_ );
+			countDenseOutputStep( statistics, rhsEvaluations, 6 );
+			++statistics_.explicitSteps;
+		}
+		testStiffness();
+	}
+
+	fmippTime currentTime() const
+	{
+		return stiff_ ? implicit_.currentTime() : explicit_.current_time();
+	}
+
+	fmippTime previousTime() const
+	{
+		return stiff_ ? implicit_.previousTime() : explicit_.previous_time();
+	}
+
+	const StateType& currentState() const
+	{
+		return stiff_ ? implicit_.currentState() : explicit_.current_state();
+	}
+
+	const StateType& previousState() const
+	{
+		return stiff_ ? implicit_.previousState() : explicit_.previous_state();
+	}
+
+public:
+	AutoSwitching( DynamicalSystem* fmu, Integrator::Properties& properties ) :
+		IntegratorStepper( fmu ),
+		implicit_( fmu, properties ),
+		sys_( fmu ),
+		neq_( fmu->nStates() ),
+		initialized_( false ),
+		stiff_( false ),
+		switchPending_( false ),
+		stiffCount_( 0 ),
+		nonStiffCount_( 0 ),
+		nTest_( 0 ),
+		v_( neq_ ), xp_( neq_ ), fx_( neq_ ), fp_( neq_ )
+	{
+		// the implicit stepper already added missing tolerances
+		properties.name  = "Auto Switching";
+		properties.order = 5;
+
+		explicit_ = make_dense_output( properties.abstol, properties.reltol,
+					       runge_kutta_dopri5< StateType >()
+					       );
+	}
+
+	void invokeMethod( EventInfo& eventInfo,
+			   StateType& states,
+			   fmippTime time,
+			   fmippTime step_size,
+			   fmippTime dt,
+			   fmippTime eventSearchPrecision ){
+		if ( !initialized_ ){
+			if ( switchPending_ )
+				switchMethod();
+			initialize( time, states, dt );
+			initialized_ = true;
+		}
+
+		// the last step of the previous call might already cover a part of the interval
+		bool stepAhead = currentTime() > time;
+		while ( true ){
+			// perform a step
+			if ( stepAhead )
+				stepAhead = false;
+			else
+				step( time + step_size );
+
+			// event detection like in OdeintStepper
+			fmu_->setTime( currentTime() );
+			fmu_->setContinuousStates( &currentState()[0] );
+			if ( fmu_->checkStateEvent() ){
+				// set back to the backup state/time
+				fmippTime tLower = std::max( previousTime(), time );
+				if ( tLower == time ){
+					fmu_->setTime( time );
+					fmu_->setContinuousStates( &states[0] );
+				} else {
+					fmu_->setTime( previousTime() );
+					fmu_->setContinuousStates( &previousState()[0] );
+				}
+
+				// tell the integrator about the event
+				eventInfo.stepEvent  = false;
+				eventInfo.stateEvent = true;
+				eventInfo.tLower     = tLower;
+				eventInfo.tUpper     = currentTime();
+
+				return;
+			}
+
+			if ( currentTime() >= time + step_size )
+				break;
+			else if ( fmu_->checkStepEvent() ){
+				// tell the integrator about the event
+				eventInfo.stepEvent  = true;
+				eventInfo.stateEvent = false;
+
+				return;
+			}
+		}
+		// use interoplation to get an approximation for time t.
+		calcState( time + step_size, states );
+
+		// write the results in the FMU
+		fmu_->setTime( time + step_size );
+		fmu_->setContinuousStates( &states[0] );
+
+		// check for step events one more time
+		if ( fmu_->checkStepEvent() )
+			eventInfo.stepEvent = true;
+
+		eventInfo.stateEvent = false;
+	}
+
+	void do_step_const( EventInfo& eventInfo,
+			    std::vector<fmippReal>& states,
+			    fmippTime& time,
+			    fmippTime& dt ){
+		// use interpolation for do_step_const
+		calcState( time + dt, states );
+		time += dt;
+		fmu_->setTime( time );
+		fmu_->setContinuousStates( &states[0] );
+	}
+
+	bool providesDenseOutput() const { return true; }
+
+	void calcState( fmippTime t, StateType& states ){
+		if ( stiff_ )
+			implicit_.calcState( t, states );
+		else
+			explicit_.calc_state( t, states );
+	}
+
+	/// The active method is restarted, the decision about stiffness is kept.
+	void reset(){
+		initialized_ = false;
+	}
+
+	/// both methods evaluate the derivatives at the initial point
+	fmippSize nRestartEvaluations() const { return 1; }
+
+	Integrator::JacobianStatistics getJacobianStatistics() const
+	{
+		return implicit_.getJacobianStatistics();
+	}
+
+	Integrator::SwitchingStatistics getSwitchingStatistics() const
+	{
+		Integrator::SwitchingStatistics statistics = statistics_;
+		statistics.stiff = stiff_;
+		return statistics;
 	}
 };
 
@@ -721,6 +2118,10 @@ private:
 		DynamicalSystem* fmu = (DynamicalSystem*) user_data;
 		fmippStatus status = fmippOK;
 
+		Integrator::Statistics& statistics = fmu->integratorStatistics();
+		StatisticsTimer timer( statistics.rhsTime );
+		++statistics.rhsEvaluations;
+
 		status = fmu->setTime( t );
 		if ( fmippOK != status ) return 1;
 
@@ -778,6 +2179,10 @@ private:
 	{
 		DynamicalSystem* ds = (DynamicalSystem*) user_data;
 
+		Integrator::Statistics& statistics = ds->integratorStatistics();
+		StatisticsTimer timer( statistics.jacobianTime );
+		++statistics.analyticJacobians;
+
 		// send the input state/time to the FMU
 		ds->setTime( t );
 		ds->setContinuousStates( N_VGetArrayPointer( x ) );
@@ -790,6 +2195,55 @@ private:
 			return 1;
 	}
 
+#ifdef USE_SUNDIALS_KLU
+	/**
+	 * Sparse Jacobian matrix in CSR format, to be used with the KLU linear solver.
+	 * Uses the colored directional derivatives if available and colored finite
+	 * differences otherwise.
+	 *
+	 * @param[in]      t,x                  time and state
+	 * @param[in]      fx                   current derivative
+	 * @param[out]     J                    the sparse jacobian martix
+	 * @param[in]      user_data            the dynamical system
+	 * @param[in,out]  tmp1,tmp2,tmp3       variables used internally by CVode
+	 */
+	static int JacSparse( fmippTime t, N_Vector x, N_Vector fx,
+		SUNMatrix J, void *user_data, N_Vector tmp1, N_Vector tmp2, N_Vector tmp3 )
+	{
+		DynamicalSystem* ds = (DynamicalSystem*) user_data;
+
+		Integrator::Statistics& statistics = ds->integratorStatistics();
+		StatisticsTimer timer( statistics.jacobianTime );
+
+		// send the input state/time to the FMU
+		ds->setTime( t );
+		ds->setContinuousStates( N_VGetArrayPointer( x ) );
+
+		// get the jacobian
+		SparseJacobian sparseJ( ds->getJacobianSparsity() );
+		if ( !ds->providesJacobian() || ( fmippOK != ds->getSparseJac( sparseJ ) ) ) {
+			ds->getSparseNumericalJacobian( sparseJ, N_VGetArrayPointer( x ),
+							N_VGetArrayPointer( tmp1 ), t );
+			++statistics.numericalJacobians;
+		} else {
+			++statistics.analyticJacobians;
+		}
+
+		// copy the jacobian into the SUNDIALS matrix ( same CSR layout )
+		const std::vector<fmippSize>& rowPtr = sparseJ.getRowPointers();
+		const std::vector<fmippSize>& colInd = sparseJ.getColumnIndices();
+		const std::vector<fmippReal>& values = sparseJ.getValues();
+		SUNMatZero( J );
+		for ( size_t i = 0; i < rowPtr.size(); i++ )
+			SM_INDEXPTRS_S( J )[i] = rowPtr[i];
+		for ( size_t k = 0; k < colInd.size(); k++ ){
+			SM_INDEXVALS_S( J )[k] = colInd[k];
+			SM_DATA_S( J )[k] = values[k];
+		}
+		return 0;
+	}
+#endif // USE_SUNDIALS_KLU
+
 	const int NEQ_;				///< dimension of state space
 	const int NEV_;				///< number of event indicators
 	N_Vector states_N_;			///< states in N_Vector format
@@ -799,6 +2253,9 @@ private:
 	void *cvode_mem_;			///< memory of the stepper. This memory later stores
 						///< the RHS, states, time and buffer datas for the
 						///< multistep methods
+	bool initialized_;			///< false iff cvode has to be reinitialized by
+						///< the next invokeMethod
+	bool internalJacobian_;			///< true iff CVode approximates the Jacobian itself
 
 	SUNMatrix A_;
 	SUNLinearSolver LS_;
@@ -817,7 +2274,9 @@ public:
 		states_N_( N_VNew_Serial( NEQ_ ) ),
 		reltol_( properties.reltol != properties.reltol ? 1e-10 : properties.reltol ),
 		abstol_( properties.abstol != properties.abstol ? 1e-10 : properties.abstol ),
-		cvode_mem_( 0 )
+		cvode_mem_( 0 ),
+		initialized_( false ),
+		internalJacobian_( false )
 	{
 		// add missing tolerances if necessary
 		if ( properties.abstol != properties.abstol )
@@ -847,13 +2306,29 @@ public:
 		// set tolerances
 		CVodeSStolerances( cvode_mem_ ,reltol_ ,abstol_ );
 
-		// Initialize solver with dense jacobian.
-		A_ = SUNDenseMatrix( NEQ_, NEQ_ );
-		LS_ = SUNDenseLinearSolver( states_N_, A_ );
-		CVDlsSetLinearSolver( cvode_mem_, LS_, A_ );
+#ifdef USE_SUNDIALS_KLU
+		if ( isBDF && ( LinearSolverType::sparseLU == properties.linearSolver ) &&
+		     fmu_->providesJacobianSparsity() ){
+			// Initialize solver with sparse jacobian. KLU requires a jacobian function.
+			A_ = SUNSparseMatrix( NEQ_, NEQ_,
+					      fmu_->getJacobianSparsity().getNumberOfNonZeros(), CSR_MAT );
+			LS_ = SUNKLU( states_N_, A_ );
+			CVDlsSetLinearSolver( cvode_mem_, LS_, A_ );
+			CVDlsSetJacFn( cvode_mem_, JacSparse );
+		} else
+#endif // USE_SUNDIALS_KLU
+		{
+			// Initialize solver with dense jacobian.
+			A_ = SUNDenseMatrix( NEQ_, NEQ_ );
+			LS_ = SUNDenseLinearSolver( states_N_, A_ );
+			CVDlsSetLinearSolver( cvode_mem_, LS_, A_ );
 
-		// Set the Jacobian routine to Jac if available. Do not use the numeric jacobian for sundials
-		if ( fmu_->providesJacobian() ) CVDlsSetJacFn( cvode_mem_, Jac );
+			// Set the Jacobian routine to Jac if available. Do not use the numeric jacobian for sundials
+			if ( fmu_->providesJacobian() ) CVDlsSetJacFn( cvode_mem_, Jac );
+			else internalJacobian_ = isBDF;
+
+			properties.linearSolver = LinearSolverType::denseLU;
+		}
 
 		//CVodeSetErrFile( cvode_mem, NULL ); // uncomment to suppress error messages
 
@@ -865,6 +2340,14 @@ public:
 		N_VDestroy_Serial( states_N_ );
 	}
 
+	void reset(){
+		initialized_ = false;
+	}
+
+	/// CVodeReInit discards the derivatives at the current point ( at least one RHS
+	/// evaluation ) as well as the order and step size history
+	fmippSize nRestartEvaluations() const { return 1; }
+
 
 	void invokeMethod( EventInfo& eventInfo, StateType& states,
 			   fmippTime time, fmippTime step_size, fmippTime dt,
@@ -881,15 +2364,40 @@ public:
 			Ith( states_N_ , i ) = states[ i ];
 		}
 
-		// reinitialize cvode. this deletes internal memeory
-		CVodeReInit( cvode_mem_, t_, states_N_ );     /// \todo reset only if states changed externally
+		// reinitialize cvode only if the continuity of the solution has been broken. this
+		// deletes internal memory ( order and step size history )
+		if ( !initialized_ ){
+			CVodeReInit( cvode_mem_, t_, states_N_ );
 
-		// set initial step size
-		CVodeSetInitStep( cvode_mem_, dt );
+			// set initial step size
+			CVodeSetInitStep( cvode_mem_, dt );
+
+			initialized_ = true;
+		}
+
+		// the counters of CVode are reset by CVodeReInit, hence only their increments are used
+		long int nSteps = 0, nErrTestFails = 0, nConvFails = 0, nJacEvals = 0;
+		CVodeGetNumSteps( cvode_mem_, &nSteps );
+		CVodeGetNumErrTestFails( cvode_mem_, &nErrTestFails );
+		CVodeGetNumNonlinSolvConvFails( cvode_mem_, &nConvFails );
+		if ( internalJacobian_ ) CVDlsGetNumJacEvals( cvode_mem_, &nJacEvals );
 
 		// make iteration
 		int flag = CVode( cvode_mem_, t_ + step_size, states_N_, &t_, CV_NORMAL );
 
+		Integrator::Statistics& statistics = fmu_->integratorStatistics();
+		long int counter;
+		CVodeGetNumSteps( cvode_mem_, &counter );
+		statistics.acceptedSteps += counter - nSteps;
+		CVodeGetNumErrTestFails( cvode_mem_, &counter );
+		statistics.rejectedSteps += counter - nErrTestFails;
+		CVodeGetNumNonlinSolvConvFails( cvode_mem_, &counter );
+		statistics.rejectedSteps += counter - nConvFails;
+		if ( internalJacobian_ ) {
+			CVDlsGetNumJacEvals( cvode_mem_, &counter );
+			statistics.numericalJacobians += counter - nJacEvals;
+		}
+
 		// convert output of cvode in StateType format
 		for ( int i = 0; i < NEQ_; i++ ) {
 			states[i] = Ith( states_N_, i );
@@ -1006,6 +2514,9 @@ IntegratorStepper* IntegratorStepper::createStepper( Integrator::Properties& pro
 	case IntegratorType::bs		: return new BulirschStoer        ( fmu, properties );
 	case IntegratorType::abm	: return new AdamsBashforthMoulton( fmu, properties );
 	case IntegratorType::ro         : return new Rosenbrock           ( fmu, properties );
+	case IntegratorType::ra         : return new RadauIIA             ( fmu, properties );
+	case IntegratorType::es         : return new Esdirk               ( fmu, properties );
+	case IntegratorType::au         : return new AutoSwitching        ( fmu, properties );
 #ifdef USE_SUNDIALS
 	case IntegratorType::bdf	: return new BackwardsDifferentiationFormula( fmu, properties );
 	case IntegratorType::abm2	: return new AdamsBashforthMoulton2         ( fmu, properties );
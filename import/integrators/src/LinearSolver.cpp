@@ -0,0 +1,426 @@
+// -------------------------------------------------------------------
+// Copyright (c) 2013-2022, AIT Austrian Institute of Technology GmbH.
+// All rights reserved. See file FMIPP_LICENSE for details.
+// -------------------------------------------------------------------
+
+/**
+ * \file LinearSolver.cpp
+ * The linear solvers used by the implicit integrator steppers are implemented here.
+ */
+
+#include <cmath>
+#include <complex>
+#include <set>
+#include <vector>
+#include <algorithm>
+
+// Boost Ublas type checks drastically slow down the LU factorization. Hence, they were disabled.
+#define BOOST_UBLAS_TYPE_CHECK 0
+#include <boost/numeric/ublas/matrix.hpp>
+#include <boost/numeric/ublas/vector.hpp>
+#include <boost/numeric/ublas/lu.hpp>
+
+#include "import/base/include/DynamicalSystem.h"
+#include "import/base/include/SparseJacobian.h"
+#include "import/integrators/include/LinearSolver.h"
+
+
+LinearSolver::LinearSolver( DynamicalSystem* ds ) :
+	ds_( ds ),
+	n_( ds->nStates() )
+{}
+
+
+LinearSolver::~LinearSolver() {}
+
+
+/**
+ * Dense LU factorization with partial pivoting.
+ *
+ * This is the linear solver that is used by odeint's rosenbrock4 stepper.
+ */
+class DenseLinearSolver : public LinearSolver
+{
+	/// storage type for matrices ( rowwise )
+	typedef boost::numeric::ublas::matrix< fmippReal > MatrixType;
+	/// storage type for complex matrices ( rowwise )
+	typedef boost::numeric::ublas::matrix< std::complex< fmippReal > > ComplexMatrixType;
+	/// storage type for the pivoting
+	typedef boost::numeric::ublas::permutation_matrix< size_t > PermutationType;
+
+	MatrixType jac_;           ///< the Jacobian
+	MatrixType lu_;            ///< the LU factorization of alpha*I - J
+	PermutationType pm_;       ///< row permutations of the LU factorization
+	ComplexMatrixType clu_;    ///< the LU factorization of ( alpha + i*beta )*I - J
+	PermutationType cpm_;      ///< row permutations of the complex LU factorization
+	SparseJacobian sparseJ_;   ///< storage for the sparse Jacobian ( if a sparsity pattern is known )
+	mutable boost::numeric::ublas::vector< fmippReal > rhs_; ///< temporary storage for solve()
+	mutable boost::numeric::ublas::vector< std::complex< fmippReal > > crhs_; ///< temporary storage
+	                                                                          ///  for solveComplex()
+
+public:
+	DenseLinearSolver( DynamicalSystem* ds ) :
+		LinearSolver( ds ),
+		jac_( n_, n_ ),
+		lu_( n_, n_ ),
+		pm_( n_ ),
+		cpm_( n_ ),
+		rhs_( n_ )
+	{}
+
+	void evaluateJacobian( const fmippReal* x, fmippTime t, fmippReal* dfdt )
+	{
+		Integrator::Statistics& statistics = ds_->integratorStatistics();
+		StatisticsTimer timer( statistics.jacobianTime );
+
+		if ( ds_->providesJacobianSparsity() ){
+			// evaluate the colored sparse jacobian and expand it
+			ds_->setTime( t );
+			ds_->setContinuousStates( x );
+			if ( ds_->providesJacobian() && ( fmippOK == ds_->getSparseJac( sparseJ_ ) ) ){
+				std::fill( dfdt, dfdt + n_, 0.0 );
+				++statistics.analyticJacobians;
+			} else {
+				ds_->getSparseNumericalJacobian( sparseJ_, x, dfdt, t );
+				++statistics.numericalJacobians;
+			}
+			sparseJ_.getDenseRowMajor( &jac_( 0, 0 ) );
+		}
+		else if ( ds_->providesJacobian() ){
+			ds_->setTime( t );
+			ds_->setContinuousStates( x );
+			ds_->getJac( &jac_( 0, 0 ) );
+			jac_ = boost::numeric::ublas::trans( jac_ );
+			std::fill( dfdt, dfdt + n_, 0.0 );
+			++statistics.analyticJacobians;
+		}
+		else {
+			ds_->getNumericalJacobian( &jac_( 0, 0 ), x, dfdt, t );
+			++statistics.numericalJacobians;
+		}
+	}
+
+	fmippBoolean factorize( fmippReal alpha )
+	{
+		lu_ = -jac_;
+		for ( fmippSize i = 0; i < n_; ++i ) {
+			lu_( i, i ) += alpha;
+			pm_( i ) = i;
+		}
+		return ( 0 == boost::numeric::ublas::lu_factorize( lu_, pm_ ) );
+	}
+
+	void solve( fmippReal* b ) const
+	{
+		std::copy( b, b + n_, rhs_.begin() );
+		boost::numeric::ublas::lu_substitute( lu_, pm_, rhs_ );
+		std::copy( rhs_.begin(), rhs_.end(), b );
+	}
+
+	fmippBoolean factorizeComplex( fmippReal alpha, fmippReal beta )
+	{
+		if ( clu_.size1() != n_ ) {
+			clu_.resize( n_, n_, false );
+			crhs_.resize( n_, false );
+		}
+
+		for ( fmippSize i = 0; i < n_; ++i ) {
+			for ( fmippSize j = 0; j < n_; ++j )
+				clu_( i, j ) = -jac_( i, j );
+			clu_( i, i ) += std::complex< fmippReal >( alpha, beta );
+			cpm_( i ) = i;
+		}
+		return ( 0 == boost::numeric::ublas::lu_factorize( clu_, cpm_ ) );
+	}
+
+	void solveComplex( fmippReal* re, fmippReal* im ) const
+	{
+		for ( fmippSize i = 0; i < n_; ++i )
+			crhs_( i ) = std::complex< fmippReal >( re[i], im[i] );
+		boost::numeric::ublas::lu_substitute( clu_, cpm_, crhs_ );
+		for ( fmippSize i = 0; i < n_; ++i ) {
+			re[i] = crhs_( i ).real();
+			im[i] = crhs_( i ).imag();
+		}
+	}
+
+	LinearSolverType getType() const { return denseLU; }
+};
+
+
+/**
+ * Sparse LU factorization.
+ *
+ * The sparsity pattern of the Jacobian is taken from the dynamical system ( see
+ * DynamicalSystem::getJacobianSparsity ). The symbolic factorization ( i.e., the
+ * pattern of the LU factors including fill-in ) is computed once in the constructor,
+ * every call to factorize() only performs the numerical factorization on this pattern.
+ * The real and the complex factorization share this pattern.
+ *
+ * The factorization uses the diagonal entries as pivots, which is well suited for the
+ * matrices alpha*I - J arising in implicit integrators. In case a pivot becomes too
+ * small, the factorization falls back to a dense LU factorization with partial pivoting.
+ */
+class SparseLinearSolver : public LinearSolver
+{
+	/// storage type for the pivoting
+	typedef boost::numeric::ublas::permutation_matrix< size_t > PermutationType;
+
+	/// Numerical factorization of a ( real or complex ) matrix with the pattern of the LU factors.
+	template< typename Scalar >
+	struct Factorization
+	{
+		std::vector<Scalar> lu;     ///< values of the LU factors ( L has unit diagonal )
+		std::vector<Scalar> work;   ///< dense work row for the factorization
+
+		fmippBoolean useDense;      ///< true iff the last factorization fell back to dense LU
+		boost::numeric::ublas::matrix< Scalar > denseLu; ///< dense LU factorization ( fallback )
+		PermutationType pm;         ///< row permutations of the dense LU factorization
+		mutable boost::numeric::ublas::vector< Scalar > rhs; ///< temporary storage for solve()
+
+		Factorization( fmippSize n ) : work( n, Scalar( 0.0 ) ), useDense( fmippFalse ), pm( n ), rhs( n ) {}
+	};
+
+	SparseJacobian jac_;              ///< the Jacobian
+
+	std::vector<fmippSize> rowPtr_;   ///< row pointers of the LU factors
+	std::vector<fmippSize> colInd_;   ///< column indices of the LU factors ( sorted per row )
+	std::vector<fmippSize> diag_;     ///< position of the diagonal entries within colInd_
+
+	std::vector<fmippReal> denseJ_;   ///< dense Jacobian ( only used without sparsity pattern )
+
+	Factorization< fmippReal > real_;                      ///< factorization of alpha*I - J
+	Factorization< std::complex< fmippReal > > complex_;   ///< factorization of ( alpha + i*beta )*I - J
+
+	mutable std::vector< std::complex< fmippReal > > crhs_; ///< temporary storage for solveComplex()
+
+public:
+	SparseLinearSolver( DynamicalSystem* ds ) :
+		LinearSolver( ds ),
+		real_( n_ ),
+		complex_( n_ ),
+		crhs_( n_ )
+	{
+		if ( ds_->providesJacobianSparsity() ) {
+			jac_ = ds_->getJacobianSparsity();
+		} else {
+			// without a sparsity pattern, assume that the Jacobian is dense
+			std::vector<fmippSize> rowPtr( 1, 0 );
+			std::vector<fmippSize> colInd;
+			for ( fmippSize i = 0; i < n_; ++i ) {
+				for ( fmippSize j = 0; j < n_; ++j ) colInd.push_back( j );
+				rowPtr.push_back( colInd.size() );
+			}
+			jac_.setPattern( n_, rowPtr, colInd );
+			denseJ_.resize( n_*n_ );
+		}
+
+		symbolicFactorization();
+	}
+
+	void evaluateJacobian( const fmippReal* x, fmippTime t, fmippReal* dfdt )
+	{
+		Integrator::Statistics& statistics = ds_->integratorStatistics();
+		StatisticsTimer timer( statistics.jacobianTime );
+
+		if ( ds_->providesJacobianSparsity() ) {
+			ds_->setTime( t );
+			ds_->setContinuousStates( x );
+			if ( ds_->providesJacobian() && ( fmippOK == ds_->getSparseJac( jac_ ) ) ) {
+				std::fill( dfdt, dfdt + n_, 0.0 );
+				++statistics.analyticJacobians;
+			} else {
+				ds_->getSparseNumericalJacobian( jac_, x, dfdt, t );
+				++statistics.numericalJacobians;
+			}
+			return;
+		}
+
+		// copy the dense Jacobian into the ( dense ) sparse storage
+		const std::vector<fmippSize>& rowPtr = jac_.getRowPointers();
+		const std::vector<fmippSize>& colInd = jac_.getColumnIndices();
+		std::vector<fmippReal>& values = jac_.getValues();
+
+		if ( ds_->providesJacobian() ) {
+			ds_->setTime( t );
+			ds_->setContinuousStates( x );
+			ds_->getJac( &denseJ_[0] );
+			std::fill( dfdt, dfdt + n_, 0.0 );
+			++statistics.analyticJacobians;
+			for ( fmippSize i = 0; i < n_; ++i )
+				for ( fmippSize k = rowPtr[i]; k < rowPtr[i+1]; ++k )
+					values[k] = denseJ_[ n_*colInd[k] + i ];
+		} else {
+			ds_->getNumericalJacobian( &denseJ_[0], x, dfdt, t );
+			++statistics.numericalJacobians;
+			for ( fmippSize i = 0; i < n_; ++i )
+				for ( fmippSize k = rowPtr[i]; k < rowPtr[i+1]; ++k )
+					values[k] = denseJ_[ n_*i + colInd[k] ];
+		}
+	}
+
+	fmippBoolean factorize( fmippReal alpha )
+	{
+		return factorizeNumeric( alpha, real_ );
+	}
+
+	void solve( fmippReal* b ) const
+	{
+		substitute( real_, b );
+	}
+
+	fmippBoolean factorizeComplex( fmippReal alpha, fmippReal beta )
+	{
+		return factorizeNumeric( std::complex< fmippReal >( alpha, beta ), complex_ );
+	}
+
+	void solveComplex( fmippReal* re, fmippReal* im ) const
+	{
+		for ( fmippSize i = 0; i < n_; ++i )
+			crhs_[i] = std::complex< fmippReal >( re[i], im[i] );
+		substitute( complex_, &crhs_[0] );
+		for ( fmippSize i = 0; i < n_; ++i ) {
+			re[i] = crhs_[i].real();
+			im[i] = crhs_[i].imag();
+		}
+	}
+
+	LinearSolverType getType() const { return sparseLU; }
+
+private:
+
+	/// Compute the pattern of the LU factors of alpha*I - J ( without pivoting ).
+	void symbolicFactorization()
+	{
+		const std::vector<fmippSize>& jacRowPtr = jac_.getRowPointers();
+		const std::vector<fmippSize>& jacColInd = jac_.getColumnIndices();
+
+		// pattern of the strictly upper part of each row of U
+		std::vector< std::vector<fmippSize> > upper( n_ );
+
+		rowPtr_.assign( 1, 0 );
+		colInd_.clear();
+		diag_.resize( n_ );
+
+		for ( fmippSize i = 0; i < n_; ++i ) {
+			std::set<fmippSize> row( jacColInd.begin() + jacRowPtr[i], jacColInd.begin() + jacRowPtr[i+1] );
+			row.insert( i );
+
+			// eliminating the entry ( i, j ) adds the pattern of the j-th row of U. Since only
+			// columns > j are inserted, the loop also visits the fill-in left of the diagonal.
+			for ( std::set<fmippSize>::const_iterator it = row.begin(); *it < i; ++it )
+				row.insert( upper[*it].begin(), upper[*it].end() );
+
+			for ( std::set<fmippSize>::const_iterator it = row.begin(); it != row.end(); ++it ) {
+				if ( *it == i ) diag_[i] = colInd_.size();
+				if ( *it > i ) upper[i].push_back( *it );
+				colInd_.push_back( *it );
+			}
+			rowPtr_.push_back( colInd_.size() );
+		}
+
+		real_.lu.assign( colInd_.size(), 0.0 );
+		complex_.lu.assign( colInd_.size(), 0.0 );
+	}
+
+	/// Numerical factorization of shift*I - J on the pattern of the LU factors.
+	template< typename Scalar >
+	fmippBoolean factorizeNumeric( Scalar shift, Factorization< Scalar >& f )
+	{
+		const std::vector<fmippSize>& jacRowPtr = jac_.getRowPointers();
+		const std::vector<fmippSize>& jacColInd = jac_.getColumnIndices();
+		const std::vector<fmippReal>& jacValues = jac_.getValues();
+
+		f.useDense = fmippFalse;
+
+		for ( fmippSize i = 0; i < n_; ++i ) {
+			// scatter the i-th row of shift*I - J into the work row
+			for ( fmippSize p = rowPtr_[i]; p < rowPtr_[i+1]; ++p )
+				f.work[ colInd_[p] ] = 0.0;
+			for ( fmippSize k = jacRowPtr[i]; k < jacRowPtr[i+1]; ++k )
+				f.work[ jacColInd[k] ] = -jacValues[k];
+			f.work[i] += shift;
+
+			fmippReal rowScale = 0.0;
+			for ( fmippSize p = rowPtr_[i]; p < rowPtr_[i+1]; ++p )
+				rowScale = std::max( rowScale, std::abs( f.work[ colInd_[p] ] ) );
+
+			// eliminate the entries left of the diagonal
+			for ( fmippSize p = rowPtr_[i]; p < diag_[i]; ++p ) {
+				const fmippSize j = colInd_[p];
+				const Scalar l = f.work[j] / f.lu[ diag_[j] ];
+				f.work[j] = l;
+				for ( fmippSize q = diag_[j] + 1; q < rowPtr_[j+1]; ++q )
+					f.work[ colInd_[q] ] -= l*f.lu[q];
+			}
+
+			// check the pivot, use a dense factorization with partial pivoting if it is too small
+			if ( !( std::abs( f.work[i] ) > 1.0e-12*rowScale ) )
+				return factorizeDense( shift, f );
+
+			// gather the work row into the LU factors
+			for ( fmippSize p = rowPtr_[i]; p < rowPtr_[i+1]; ++p )
+				f.lu[p] = f.work[ colInd_[p] ];
+		}
+
+		return fmippTrue;
+	}
+
+	/// Solve the linear system using the factorization f. The solution overwrites b.
+	template< typename Scalar >
+	void substitute( const Factorization< Scalar >& f, Scalar* b ) const
+	{
+		if ( f.useDense ) {
+			std::copy( b, b + n_, f.rhs.begin() );
+			boost::numeric::ublas::lu_substitute( f.denseLu, f.pm, f.rhs );
+			std::copy( f.rhs.begin(), f.rhs.end(), b );
+			return;
+		}
+
+		// forward substitution ( L has unit diagonal )
+		for ( fmippSize i = 0; i < n_; ++i )
+			for ( fmippSize p = rowPtr_[i]; p < diag_[i]; ++p )
+				b[i] -= f.lu[p]*b[ colInd_[p] ];
+
+		// backward substitution
+		for ( fmippSize i = n_; i-- > 0; ) {
+			for ( fmippSize p = diag_[i] + 1; p < rowPtr_[i+1]; ++p )
+				b[i] -= f.lu[p]*b[ colInd_[p] ];
+			b[i] /= f.lu[ diag_[i] ];
+		}
+	}
+
+	/// Fallback: dense LU factorization with partial pivoting.
+	template< typename Scalar >
+	fmippBoolean factorizeDense( Scalar shift, Factorization< Scalar >& f )
+	{
+		if ( f.denseLu.size1() != n_ ) f.denseLu.resize( n_, n_, false );
+
+		const std::vector<fmippSize>& jacRowPtr = jac_.getRowPointers();
+		const std::vector<fmippSize>& jacColInd = jac_.getColumnIndices();
+		const std::vector<fmippReal>& jacValues = jac_.getValues();
+
+		f.denseLu.clear();
+		for ( fmippSize i = 0; i < n_; ++i ) {
+			for ( fmippSize k = jacRowPtr[i]; k < jacRowPtr[i+1]; ++k )
+				f.denseLu( i, jacColInd[k] ) = -jacValues[k];
+			f.denseLu( i, i ) += shift;
+			f.pm( i ) = i;
+		}
+
+		f.useDense = fmippTrue;
+		return ( 0 == boost::numeric::ublas::lu_factorize( f.denseLu, f.pm ) );
+	}
+};
+
+
+LinearSolver* LinearSolver::createLinearSolver( LinearSolverType type, DynamicalSystem* ds )
+{
+	switch ( type ) {
+	case denseLU        : return new DenseLinearSolver ( ds );
+	case sparseLU       : return new SparseLinearSolver( ds );
+	case NLINEARSOLVERS : return 0;
+	}
+
+	return 0;
+}
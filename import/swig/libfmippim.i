@@ -37,6 +37,7 @@
 #include "import/base/include/FMUCoSimulation_v2.h"
 #include "import/base/include/LogBuffer.h"
 #include "import/integrators/include/IntegratorType.h"
+#include "import/integrators/include/IntegratorStatistics.h"
 #include "import/utility/include/RollbackFMU.h"
 #include "import/utility/include/IncrementalFMU.h"
 #include "import/utility/include/FixedStepSizeFMU.h"
@@ -89,6 +90,9 @@
 %rename(integratorFE) fe;
 %rename(integratorBS) bs;
 %rename(integratorRO) ro;
+%rename(integratorRA) ra;
+%rename(integratorES) es;
+%rename(integratorAU) au;
 %rename(integratorBDF) bdf;
 %rename(integratorABM2) abm2;
 
@@ -101,6 +105,7 @@
 namespace std {
   %template(StringVector) vector<string>;
   %template(UnsignedIntVector) vector<unsigned int>;
+  %template(DoubleVector) vector<double>;
 }
 #else
 #endif
@@ -123,6 +128,7 @@ namespace std {
 %include "import/base/include/FMUCoSimulation_v2.h"
 %include "import/base/include/LogBuffer.h"
 %include "import/integrators/include/IntegratorType.h"
+%include "import/integrators/include/IntegratorStatistics.h"
 %include "import/utility/include/IncrementalFMU.h"
 %include "import/utility/include/RollbackFMU.h"
 %include "import/utility/include/FixedStepSizeFMU.h"
@@ -0,0 +1,99 @@
+// -------------------------------------------------------------------
+// Copyright (c) 2013-2022, AIT Austrian Institute of Technology GmbH.
+// All rights reserved. See file FMIPP_LICENSE for details.
+// -------------------------------------------------------------------
+
+#ifndef _FMIPP_CHECKPOINTSTORE_H
+#define _FMIPP_CHECKPOINTSTORE_H
+
+#include <list>
+#include <map>
+
+#include "common/FMIPPConfig.h"
+#include "import/base/include/FMUSnapshot.h"
+
+/**
+ * \file CheckpointStore.h
+ *
+ * \class CheckpointStore CheckpointStore.h
+ * Bounded store of FMU snapshots ( see FMUSnapshot.h ), indexed by their time.
+ *
+ * The latest checkpoint at or before a given time is found in O(log n). The number of
+ * checkpoints and their total memory can be limited, in which case the least recently used
+ * checkpoints are evicted ( storing or restoring a checkpoint counts as using it ). Pinned
+ * checkpoints are never evicted. The memory of a checkpoint is given by the user, e.g., the
+ * size of the serialized snapshot.
+ */
+class __FMI_DLL CheckpointStore
+{
+
+public:
+
+	/// Constructor, a limit of zero means no limit.
+	CheckpointStore( fmippSize maxCheckpoints = 0, fmippSize maxMemory = 0 );
+
+	/// Set the maximum number of checkpoints and their maximum total memory ( zero means no limit ).
+	void setLimits( fmippSize maxCheckpoints, fmippSize maxMemory );
+
+	/// Store a snapshot, replacing a checkpoint at the same time. Evicts checkpoints if necessary.
+	void insert( FMUSnapshot&& snapshot, fmippSize memory, fmippBoolean pinned = fmippFalse );
+
+	/// Get the latest checkpoint at or before the given time, 0 if there is none.
+	const FMUSnapshot* find( fmippTime time );
+
+	/// Check whether there is a checkpoint at the given time.
+	fmippBoolean contains( fmippTime time ) const;
+
+	/// Remove all checkpoints after the given time ( e.g., after a rollback ).
+	void eraseAfter( fmippTime time );
+
+	/// Allow all checkpoints to be evicted.
+	void unpinAll();
+
+	/// Remove all checkpoints.
+	void clear();
+
+	/// Get an evicted snapshot, whose memory can be reused when taking a new snapshot.
+	FMUSnapshot takeSpare();
+
+	/// Number of stored checkpoints.
+	fmippSize size() const { return checkpoints_.size(); }
+
+	/// Total memory of the stored checkpoints.
+	fmippSize memory() const { return memory_; }
+
+	/// Number of checkpoints evicted so far.
+	fmippSize nEvictions() const { return nEvictions_; }
+
+private:
+
+	/// A stored snapshot.
+	struct Checkpoint
+	{
+		FMUSnapshot snapshot;
+		fmippSize memory;
+		fmippBoolean pinned;
+		std::list<fmippTime>::iterator used; ///< Position in the list of recently used checkpoints.
+	};
+
+	typedef std::map<fmippTime, Checkpoint> Checkpoints;
+
+	/// Remove a checkpoint, its snapshot becomes the spare snapshot.
+	void erase( Checkpoints::iterator it );
+
+	/// Evict the least recently used checkpoints until the limits are met.
+	void evict();
+
+	Checkpoints checkpoints_; ///< Checkpoints ordered by time.
+
+	std::list<fmippTime> used_; ///< Times of the checkpoints, least recently used first.
+
+	FMUSnapshot spare_; ///< Last evicted snapshot.
+
+	fmippSize maxCheckpoints_; ///< Maximum number of checkpoints.
+	fmippSize maxMemory_; ///< Maximum total memory.
+	fmippSize memory_; ///< Total memory.
+	fmippSize nEvictions_; ///< Number of evicted checkpoints.
+};
+
+#endif // _FMIPP_CHECKPOINTSTORE_H
@@ -0,0 +1,171 @@
+// -------------------------------------------------------------------
+// Copyright (c) 2013-2022, AIT Austrian Institute of Technology GmbH.
+// All rights reserved. See file FMIPP_LICENSE for details.
+// -------------------------------------------------------------------
+
+#ifndef _FMIPP_DELTACHECKPOINTSTORE_H
+#define _FMIPP_DELTACHECKPOINTSTORE_H
+
+#include <fstream>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "common/FMIPPConfig.h"
+
+namespace boost { namespace interprocess { class mapped_region; } }
+
+/**
+ * \file DeltaCheckpointStore.h
+ *
+ * \class DeltaCheckpointStore DeltaCheckpointStore.h
+ * Compressed store of serialized FMU states ( see FMUBase::serializeSnapshot ), indexed by their time.
+ *
+ * Consecutive serialized states of an FMU are mostly identical. Therefore, only every n-th checkpoint
+ * ( key frame ) is stored in full, the others are stored as difference to the previous checkpoint. A
+ * difference is the bytewise XOR of both states, in which runs of zeros ( i.e., unchanged bytes ) are
+ * run-length encoded. Key frames are encoded the same way, as difference to an empty state. Restoring
+ * a checkpoint applies the differences since the preceding key frame, starting from the previously
+ * restored state if possible.
+ *
+ * Checkpoints are stored in the order of their time, storing a checkpoint removes all checkpoints at
+ * or after its time. If the memory of the encoded checkpoints exceeds the given limit, the oldest
+ * checkpoints are moved to a spill file ( if set ), which is read via memory mapping, or are evicted
+ * otherwise. Pinned checkpoints and the newest checkpoint are never evicted.
+ */
+class __FMI_DLL DeltaCheckpointStore
+{
+
+public:
+
+	/// Constructor, a memory limit of zero means no limit.
+	DeltaCheckpointStore( fmippSize keyframeInterval = 16, fmippSize maxMemory = 0 );
+
+	/// Destructor, removes the spill file.
+	~DeltaCheckpointStore();
+
+	/// Set the number of checkpoints from one key frame to the next ( applies to new checkpoints ).
+	void setKeyframeInterval( fmippSize keyframeInterval );
+
+	/// Set the maximum memory of the encoded checkpoints in bytes ( zero means no limit ).
+	void setMemoryLimit( fmippSize maxMemory );
+
+	/**
+	 * Move checkpoints exceeding the memory limit to a file instead of evicting them. Checkpoints in
+	 * a previous spill file are read back into memory. An empty path disables the spill file.
+	 *
+	 * @param[in]  path  path of the spill file, an existing file is overwritten
+	 * @return fmippError if the file cannot be created
+	 */
+	fmippStatus setSpillFile( const fmippString& path );
+
+	/// Store a serialized state, removing all checkpoints at or after its time. Evicts checkpoints if necessary.
+	void insert( fmippTime time, const std::vector<fmippChar>& state, fmippBoolean pinned = fmippFalse );
+
+	/**
+	 * Restore the latest checkpoint at or before the given time.
+	 *
+	 * @param[in]  time  requested time
+	 * @param[out]  checkpointTime  time of the restored checkpoint
+	 * @param[out]  state  serialized state of the restored checkpoint
+	 * @return false if there is no such checkpoint
+	 */
+	fmippBoolean find( fmippTime time, fmippTime& checkpointTime, std::vector<fmippChar>& state );
+
+	/// Check whether there is a checkpoint at the given time.
+	fmippBoolean contains( fmippTime time ) const;
+
+	/// Remove all checkpoints after the given time ( e.g., after a rollback ).
+	void eraseAfter( fmippTime time );
+
+	/// Allow all checkpoints to be evicted.
+	void unpinAll();
+
+	/// Remove all checkpoints.
+	void clear();
+
+	/// Number of stored checkpoints.
+	fmippSize size() const { return checkpoints_.size(); }
+
+	/// Memory of the encoded checkpoints held in memory.
+	fmippSize memory() const { return memory_; }
+
+	/// Size of the encoded checkpoints in the spill file.
+	fmippSize spilledMemory() const { return spilledMemory_; }
+
+	/// Total size of the stored checkpoints before encoding.
+	fmippSize rawMemory() const { return rawMemory_; }
+
+	/// Number of checkpoints evicted so far.
+	fmippSize nEvictions() const { return nEvictions_; }
+
+private:
+
+	/// An encoded checkpoint.
+	struct Checkpoint
+	{
+		fmippBoolean keyframe; ///< Flag indicating whether the checkpoint is encoded without previous state.
+		fmippSize position; ///< Number of checkpoints since the last key frame.
+		fmippSize size; ///< Size of the serialized state.
+		std::vector<fmippChar> data; ///< Encoded state, empty if spilled.
+		fmippSize offset; ///< Offset of the encoded state in the spill file.
+		fmippSize length; ///< Length of the encoded state.
+		fmippBoolean spilled; ///< Flag indicating whether the encoded state is in the spill file.
+		fmippBoolean pinned; ///< Flag indicating whether the checkpoint must not be evicted.
+	};
+
+	typedef std::map<fmippTime, Checkpoint> Checkpoints;
+
+	/// Encode the difference between two states.
+	static void encode( const std::vector<fmippChar>& previous, const std::vector<fmippChar>& state,
+		std::vector<fmippChar>& data );
+
+	/// Apply an encoded difference to a state.
+	static void decode( const fmippChar* data, fmippSize length, fmippSize size, std::vector<fmippChar>& state );
+
+	/// Get the encoded state of a checkpoint.
+	const fmippChar* data( const Checkpoint& checkpoint );
+
+	/// Decode a checkpoint into the cached state, false if the spill file cannot be read.
+	bool restore( Checkpoints::iterator it );
+
+	/// Remove a checkpoint.
+	void erase( Checkpoints::iterator it );
+
+	/// Spill or evict the oldest checkpoints until the memory limit is met.
+	void evict();
+
+	/// Append the encoded state of a checkpoint to the spill file.
+	bool spill( Checkpoint& checkpoint );
+
+	/// Truncate the spill file, no checkpoint must be spilled.
+	void resetSpillFile();
+
+	/// Read all spilled checkpoints back into memory and remove the spill file.
+	void closeSpillFile();
+
+	Checkpoints checkpoints_; ///< Checkpoints ordered by time.
+
+	std::vector<fmippChar> cache_; ///< Decoded state of the checkpoint at cacheTime_.
+	fmippTime cacheTime_; ///< Time of the cached state.
+	fmippBoolean cacheValid_; ///< Flag indicating whether the cached state belongs to a stored checkpoint.
+
+	std::vector<fmippChar> encoded_; ///< Buffer for encoding.
+
+	fmippString spillPath_; ///< Path of the spill file, empty if there is none.
+	std::ofstream spillFile_; ///< Spill file, opened for appending.
+	fmippSize spillFileSize_; ///< Number of bytes written to the spill file.
+	std::unique_ptr<boost::interprocess::mapped_region> spillRegion_; ///< Mapping of the spill file.
+
+	fmippSize keyframeInterval_; ///< Number of checkpoints from one key frame to the next.
+	fmippSize maxMemory_; ///< Maximum memory of encoded checkpoints.
+	fmippSize memory_; ///< Memory of encoded checkpoints.
+	fmippSize spilledMemory_; ///< Size of spilled checkpoints.
+	fmippSize rawMemory_; ///< Size of the serialized states.
+	fmippSize nEvictions_; ///< Number of evicted checkpoints.
+
+	DeltaCheckpointStore( const DeltaCheckpointStore& ); ///< Prevent copying.
+	DeltaCheckpointStore& operator=( const DeltaCheckpointStore& ); ///< Prevent copying.
+};
+
+#endif // _FMIPP_DELTACHECKPOINTSTORE_H
@@ -0,0 +1,234 @@
+// -------------------------------------------------------------------
+// Copyright (c) 2013-2022, AIT Austrian Institute of Technology GmbH.
+// All rights reserved. See file FMIPP_LICENSE for details.
+// -------------------------------------------------------------------
+
+#ifndef _FMIPP_FMUINSTANCEPOOL_H
+#define _FMIPP_FMUINSTANCEPOOL_H
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "common/FMIPPConfig.h"
+
+#include "import/base/include/FMUModelExchange_v2.h"
+#include "import/base/include/FMUCoSimulation_v2.h"
+#include "import/base/include/VariableGroup.h"
+
+
+/**
+ * \file FMUInstancePool.h
+ *
+ * \struct FMUInstancePoolStatistics FMUInstancePool.h
+ * Counters and wall times of an FMUInstancePool. All times are given in seconds.
+ */
+struct __FMI_DLL FMUInstancePoolStatistics
+{
+	fmippSize acquired;       ///< Instances handed out by the pool.
+	fmippSize created;        ///< Instances created and instantiated.
+	fmippSize recycled;       ///< Instances handed out again after they have been reset.
+	fmippSize reinstantiated; ///< Returned instances replaced by a new instance, because the reset failed.
+	fmippSize discarded;      ///< Returned instances destroyed, because the pool was full or they could not be reset.
+
+	double instantiateTime;   ///< Wall time spent creating and instantiating instances.
+	double resetTime;         ///< Wall time spent resetting returned instances ( including the start values ).
+
+	FMUInstancePoolStatistics() { reset(); }
+
+	/// Set all counters and times to zero.
+	void reset() {
+		acquired = created = recycled = reinstantiated = discarded = 0;
+		instantiateTime = resetTime = 0.0;
+	}
+
+	/// Estimated wall time saved by recycling instances instead of creating new ones.
+	double getTimeSaved() const {
+		return ( 0 == created ) ? 0.0 : recycled * instantiateTime / created - resetTime;
+	}
+
+	/// Add the counters and times of another statistics.
+	FMUInstancePoolStatistics& operator+=( const FMUInstancePoolStatistics& s ) {
+		acquired += s.acquired; created += s.created; recycled += s.recycled;
+		reinstantiated += s.reinstantiated; discarded += s.discarded;
+		instantiateTime += s.instantiateTime; resetTime += s.resetTime;
+		return *this;
+	}
+};
+
+
+/**
+ * \class FMUInstancePool FMUInstancePool.h
+ * Pool of instantiated FMUs ( FMI 2.0 ), keyed by model identifier.
+ *
+ * Creating and instantiating an FMU is expensive for many models, which matters whenever many
+ * short simulations of the same model are run ( e.g., Monte-Carlo sweeps or parameter studies ).
+ * Instead of destroying an instance after a run, it is returned to the pool, which resets it
+ * with fmi2Reset and reapplies the start values of all variables that can be set before
+ * initialization. Subsequent requests for the same model then receive this instance, which is
+ * in the same state as a newly instantiated one. If the reset fails, the instance is replaced
+ * by a new one.
+ *
+ * The instances handed out by acquire() are instantiated but not yet initialized. They are
+ * returned to the pool automatically when the returned pointer is destroyed. Instances that
+ * are returned after the pool has been destroyed are simply deleted.
+ *
+ * The FMUs have to be loaded ( via the model manager ) before instances can be acquired.
+ * The pool is thread-safe. Optionally, idle instances can be bound to the thread that returned
+ * them ( see setThreadAffinity ), e.g., to avoid that the memory of an instance migrates
+ * between the caches of different cores.
+ *
+ * Explicit instantiations are provided for fmi_2_0::FMUModelExchange and fmi_2_0::FMUCoSimulation.
+ */
+template<class FMUType>
+class __FMI_DLL FMUInstancePool
+{
+
+private:
+
+	struct Pool;
+
+public:
+
+	/// Deleter returning an instance to its pool.
+	class Releaser
+	{
+	public:
+		Releaser() {}
+		Releaser( const std::shared_ptr<Pool>& pool, const fmippString& modelIdentifier ) :
+			pool_( pool ), modelIdentifier_( modelIdentifier ) {}
+		void operator()( FMUType* fmu ) const;
+	private:
+		std::weak_ptr<Pool> pool_;
+		fmippString modelIdentifier_;
+	};
+
+	/// Instance handed out by the pool, returned to the pool when destroyed.
+	typedef std::unique_ptr<FMUType, Releaser> Instance;
+
+	/**
+	 * Constructor.
+	 *
+	 * @param[in]  instanceName  prefix of the names of the instances ( followed by a number )
+	 * @param[in]  loggingOn  flag for logging
+	 */
+	FMUInstancePool( const fmippString& instanceName = "pool", const fmippBoolean loggingOn = fmippFalse );
+
+	/// Destructor. Deletes all idle instances.
+	~FMUInstancePool();
+
+	/**
+	 * Get an instantiated ( but not yet initialized ) instance of an FMU. An idle instance is
+	 * recycled if available, otherwise a new instance is created.
+	 *
+	 * @param[in]  modelIdentifier  FMI model identifier of an FMU loaded by the model manager
+	 * @return the instance, a null pointer if the FMU cannot be instantiated
+	 */
+	Instance acquire( const fmippString& modelIdentifier );
+
+	/**
+	 * Create instances in advance, such that at least the given number of instances of a model
+	 * is idle ( limited by the maximum number of idle instances ).
+	 *
+	 * @return the number of idle instances of the model
+	 */
+	fmippSize reserve( const fmippString& modelIdentifier, fmippSize nInstances );
+
+	/// Set the maximum number of idle instances per model, returned instances exceeding it are deleted.
+	void setMaxIdleInstances( fmippSize maxIdle );
+
+	/// Set the maximum number of idle instances for a specific model.
+	void setMaxIdleInstances( const fmippString& modelIdentifier, fmippSize maxIdle );
+
+	/**
+	 * Enable or disable thread affinity. If enabled, an idle instance is only handed out to the
+	 * thread that returned it to the pool ( or that created it, for instances created by reserve ).
+	 */
+	void setThreadAffinity( fmippBoolean threadAffinity );
+
+	/// Get the number of idle instances of a model.
+	fmippSize getNumberOfIdleInstances( const fmippString& modelIdentifier ) const;
+
+	/// Delete all idle instances ( of all models ).
+	void clear();
+
+	/// Get the statistics of a model.
+	FMUInstancePoolStatistics getStatistics( const fmippString& modelIdentifier ) const;
+
+	/// Get the statistics of all models.
+	FMUInstancePoolStatistics getStatistics() const;
+
+private:
+
+	/// Start values of the variables that can be set after an instance has been reset.
+	struct StartValues
+	{
+		VariableGroup group; ///< Variables with start values ( ordered by type ).
+		std::vector<fmippReal> realValues; ///< Start values of real variables.
+		std::vector<fmippInteger> integerValues; ///< Start values of integer variables.
+		std::vector<fmippBoolean> booleanValues; ///< Start values of boolean variables.
+		std::vector<fmippString> stringValues; ///< Start values of string variables.
+	};
+
+	/// Idle instance.
+	struct Idle
+	{
+		FMUType* fmu; ///< The instance.
+		std::thread::id owner; ///< Thread that returned the instance.
+	};
+
+	/// Instances and statistics of a single model.
+	struct Model
+	{
+		Model() : maxIdle( 0 ), hasMaxIdle( false ) {}
+		std::vector<Idle> idle; ///< Idle instances ( most recently returned last ).
+		std::shared_ptr<const StartValues> startValues; ///< Start values ( set when the first instance is created ).
+		fmippSize maxIdle; ///< Maximum number of idle instances ( if hasMaxIdle ).
+		fmippBoolean hasMaxIdle; ///< Flag indicating whether maxIdle overrides the default.
+		FMUInstancePoolStatistics statistics; ///< Statistics of this model.
+	};
+
+	/// State of the pool, shared with the releasers of all instances handed out.
+	struct Pool
+	{
+		fmippString instanceName; ///< Prefix of the instance names.
+		fmippBoolean loggingOn; ///< Flag for logging.
+		fmippSize maxIdle; ///< Default maximum number of idle instances per model.
+		fmippBoolean threadAffinity; ///< Flag indicating whether idle instances are bound to threads.
+		fmippSize nInstances; ///< Number of instances created ( used for the instance names ).
+		std::map<fmippString, Model> models; ///< Models, by model identifier.
+		mutable std::mutex poolMutex; ///< Protects all other members.
+
+		/// Create and instantiate a new instance, returns 0 if this fails.
+		FMUType* create( const fmippString& modelIdentifier );
+
+		/// Reset an instance and apply the start values, returns false if this fails.
+		fmippBoolean recycle( FMUType* fmu, const StartValues& startValues ) const;
+
+		/// Return an instance to the pool.
+		void release( FMUType* fmu, const fmippString& modelIdentifier );
+	};
+
+	std::shared_ptr<Pool> pool_; ///< State of the pool.
+
+	/// Collect the start values of all variables that can be set after a reset.
+	static std::shared_ptr<const StartValues> getStartValues( const FMUType& fmu );
+
+	/// Instantiate an FMU ( the arguments differ for ME and CS ).
+	static fmippStatus instantiate( FMUType& fmu, const fmippString& instanceName );
+
+	FMUInstancePool( const FMUInstancePool& ); ///< Prevent copying.
+	FMUInstancePool& operator=( const FMUInstancePool& ); ///< Prevent copying.
+};
+
+
+/// Pool of FMU instances for ME ( FMI 2.0 ).
+typedef FMUInstancePool<fmi_2_0::FMUModelExchange> FMUModelExchangePool;
+
+/// Pool of FMU instances for CS ( FMI 2.0 ).
+typedef FMUInstancePool<fmi_2_0::FMUCoSimulation> FMUCoSimulationPool;
+
+
+#endif // _FMIPP_FMUINSTANCEPOOL_H
@@ -9,6 +9,8 @@
 #include "import/base/include/FMUModelExchange_v1.h"
 #include "import/base/include/FMUModelExchange_v2.h"
 
+#include "import/utility/include/CheckpointStore.h"
+#include "import/utility/include/DeltaCheckpointStore.h"
 #include "import/utility/include/History.h"
 
 /**
@@ -16,6 +18,13 @@
  * \class RollbackFMU RollbackFMU.h 
  *  This class allows to perform rollbacks to times not longer
  *  ago than the previous update (or a saved internal state).
+ *
+ *  If checkpoints are enabled ( see enableCheckpoints ), native FMU
+ *  states are stored instead, which also restore discrete states and
+ *  internal memory of the FMU. Rollbacks are then possible to any time
+ *  not before the oldest stored checkpoint. For long rollback histories,
+ *  the checkpoints can be stored as compressed serialized states instead
+ *  ( see enableCompressedCheckpoints ).
  **/
 
 class __FMI_DLL RollbackFMU
@@ -26,7 +35,7 @@ public:
 	/**
 	 * Constructor.
 	 *
-	 * @param[in]  fmuDirUri  path to unzipped FMU directory (as URI)
+	 * @param[in]  fmuDirUri  path to unzipped FMU directory or FMU archive (as URI)
 	 * @param[in]  modelIdentifier  FMI model identifier
 	 * @param[in]  loggingOn  flag for logging
 	 * @param[in]  timeDiffResolution  resolution for time comparison and event search during integration
@@ -57,6 +66,49 @@ public:
 	    saved via "saveCurrentStateForRollback()". **/
 	void releaseRollbackState();
 
+	/**
+	 * Store native FMU states ( see FMUSnapshot.h ) as checkpoints, taken at the beginning of each
+	 * integration. A rollback restores the latest checkpoint at or before the requested time and
+	 * integrates only the remaining interval, checkpoints after the restored one are discarded. The
+	 * state saved via saveCurrentStateForRollback() is kept until releaseRollbackState() is called,
+	 * other checkpoints are evicted ( least recently used first ) when one of the limits is exceeded.
+	 *
+	 * @param[in]  maxCheckpoints  maximum number of checkpoints ( zero means no limit )
+	 * @param[in]  maxMemory  maximum memory of all checkpoints in bytes ( zero means no limit ),
+	 *                        only applies to FMUs that can serialize their state
+	 * @return fmippWarning if the FMU cannot get and set its state, the rollback is then done as before
+	 *         ( on Linux, such FMUs can be forked instead, see ModelManager::setForkedInstances )
+	 */
+	fmippStatus enableCheckpoints( fmippSize maxCheckpoints = 0, fmippSize maxMemory = 0 );
+
+	/**
+	 * Like enableCheckpoints, but store the checkpoints as serialized FMU states, of which only every
+	 * n-th is stored in full and the others as difference to the previous one ( see DeltaCheckpointStore.h ).
+	 * Taking and restoring a checkpoint is slower, but consecutive states usually differ only slightly.
+	 *
+	 * @param[in]  keyframeInterval  number of checkpoints from one fully stored state to the next
+	 * @param[in]  maxMemory  maximum memory of all checkpoints in bytes ( zero means no limit )
+	 * @param[in]  spillFile  file to which checkpoints exceeding maxMemory are moved instead of
+	 *                        evicting them ( empty for none )
+	 * @return fmippWarning if the FMU cannot serialize its state, fmippError if the spill file cannot be created
+	 */
+	fmippStatus enableCompressedCheckpoints( fmippSize keyframeInterval = 16, fmippSize maxMemory = 0,
+		const fmippString& spillFile = fmippString() );
+
+	/// Remove all checkpoints and go back to storing the continuous states only.
+	void disableCheckpoints();
+
+	/// Check whether native FMU states are stored as checkpoints.
+	fmippBoolean checkpointsEnabled() const { return checkpointsEnabled_; }
+
+#ifndef SWIG
+	/// Get the stored checkpoints.
+	const CheckpointStore& getCheckpoints() const { return checkpoints_; }
+
+	/// Get the stored compressed checkpoints.
+	const DeltaCheckpointStore& getCompressedCheckpoints() const { return compressedCheckpoints_; }
+#endif
+
 	/** getter functions for model variables **/
 
 	fmippStatus getValue( const fmippString& name, fmippReal& val );
@@ -94,10 +146,20 @@ public:
 	/// Get the status of the last operation on the FMU.
 	fmippStatus getLastStatus() const;
 
+	/// Get the runtime statistics of the integrator ( see Integrator::getStatistics() ).
+	IntegratorStatistics getIntegratorStatistics() const;
+
+	/// Set all counters and times of the integrator statistics to zero.
+	void resetIntegratorStatistics();
+
 protected:
 
 	fmippStatus rollback( fmippTime time ); ///<  Make a rollback.
 
+	void saveCheckpoint( fmippBoolean pinned ); ///< Store the current state of the FMU as checkpoint.
+
+	fmippBoolean hasCheckpoint( fmippTime time ) const; ///< Check whether there is a checkpoint at the given time.
+
 private:
 	/** pointer to fmu instance **/
 	FMUModelExchangeBase* fmu_;
@@ -109,6 +171,18 @@ private:
 
 	bool rollbackStateSaved_;
 
+	CheckpointStore checkpoints_; ///< Native FMU states, used instead of rollbackState_ if enabled.
+
+	fmippBoolean checkpointsEnabled_; ///< Flag indicating whether checkpoints are stored.
+
+	DeltaCheckpointStore compressedCheckpoints_; ///< Serialized FMU states, used instead of checkpoints_ if enabled.
+
+	fmippBoolean checkpointsCompressed_; ///< Flag indicating whether checkpoints are stored compressed.
+
+	FMUSnapshot snapshot_; ///< Snapshot for serializing and deserializing compressed checkpoints.
+
+	std::vector<fmippChar> serializedState_; ///< Buffer for compressed checkpoints.
+
 };
 
 
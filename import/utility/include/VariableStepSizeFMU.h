@@ -7,6 +7,7 @@
 #define _FMIPP_VARIABLESTEPSIZEFMU_H
 
 #include "common/FMIPPConfig.h"
+#include "import/base/include/VariableGroup.h"
 
 #include "import/utility/include/History.h"
 
@@ -27,7 +28,7 @@ public:
 	/**
 	 * Constructor.
 	 *
-	 * @param[in]  fmuDirUri  path to unzipped FMU directory (as URI)
+	 * @param[in]  fmuDirUri  path to unzipped FMU directory or FMU archive (as URI)
 	 * @param[in]  modelIdentifier  FMI model identifier
 	 * @param[in]  loggingOn  flag for logging
 	 * @param[in]  timeDiffResolution  resolution for time comparison and event search during integration
@@ -182,53 +183,11 @@ private:
 	/** The current state. **/
 	HistoryEntry currentState_;
 
-	/** Value references of the real inputs. **/
-	fmippValueReference* realInputRefs_;
+	/** Inputs of the FMU, which are set with one call per type. **/
+	VariableGroup inputs_;
 
-	/** Value references of the integer inputs. **/
-	fmippValueReference* integerInputRefs_;
-
-	/** Value references of the boolean inputs. **/
-	fmippValueReference* booleanInputRefs_;
-
-	/** Value references of the string inputs. **/
-	fmippValueReference* stringInputRefs_;
-
-	/** Number of real inputs. **/
-	fmippSize nRealInputs_;
-
-	/** Number of integer inputs. **/
-	fmippSize nIntegerInputs_;
-
-	/** Number of boolean inputs. **/
-	fmippSize nBooleanInputs_;
-
-	/** Number of string inputs. **/
-	fmippSize nStringInputs_;
-
-	/** Value references of real outputs. **/
-	fmippValueReference* realOutputRefs_;
-
-	/** Value references of integer outputs. **/
-	fmippValueReference* integerOutputRefs_;
-
-	/** Value references of boolean outputs. **/
-	fmippValueReference* booleanOutputRefs_;
-
-	/** Value references of string outputs. **/
-	fmippValueReference* stringOutputRefs_;
-
-	/** Number of real outputs. **/
-	fmippSize nRealOutputs_;
-
-	/** Number integer of outputs. **/
-	fmippSize nIntegerOutputs_;
-
-	/** Number of boolean outputs. **/
-	fmippSize nBooleanOutputs_;
-
-	/** Number of string outputs. **/
-	fmippSize nStringOutputs_;
+	/** Outputs of the FMU, which are retrieved with one call per type. **/
+	VariableGroup outputs_;
 
 	/** Flag indicating logging on/off. **/
 	fmippBoolean loggingOn_;
@@ -0,0 +1,127 @@
+// -------------------------------------------------------------------
+// Copyright (c) 2013-2022, AIT Austrian Institute of Technology GmbH.
+// All rights reserved. See file FMIPP_LICENSE for details.
+// -------------------------------------------------------------------
+
+/**
+ * \file CheckpointStore.cpp
+ */
+
+#include <utility>
+
+#include "import/utility/include/CheckpointStore.h"
+
+using namespace std;
+
+
+CheckpointStore::CheckpointStore( fmippSize maxCheckpoints, fmippSize maxMemory ) :
+	maxCheckpoints_( maxCheckpoints ),
+	maxMemory_( maxMemory ),
+	memory_( 0 ),
+	nEvictions_( 0 )
+{}
+
+
+void CheckpointStore::setLimits( fmippSize maxCheckpoints, fmippSize maxMemory )
+{
+	maxCheckpoints_ = maxCheckpoints;
+	maxMemory_ = maxMemory;
+	evict();
+}
+
+
+void CheckpointStore::insert( FMUSnapshot&& snapshot, fmippSize memory, fmippBoolean pinned )
+{
+	const fmippTime time = snapshot.getTime();
+
+	Checkpoints::iterator it = checkpoints_.find( time );
+	if ( checkpoints_.end() == it ) {
+		it = checkpoints_.insert( make_pair( time, Checkpoint() ) ).first;
+		it->second.pinned = fmippFalse;
+		it->second.used = used_.insert( used_.end(), time );
+	} else {
+		memory_ -= it->second.memory;
+		used_.splice( used_.end(), used_, it->second.used );
+	}
+
+	it->second.snapshot = move( snapshot );
+	it->second.memory = memory;
+	it->second.pinned = it->second.pinned || pinned;
+	memory_ += memory;
+
+	evict();
+}
+
+
+const FMUSnapshot* CheckpointStore::find( fmippTime time )
+{
+	Checkpoints::iterator it = checkpoints_.upper_bound( time );
+	if ( checkpoints_.begin() == it ) return 0;
+
+	--it;
+	used_.splice( used_.end(), used_, it->second.used );
+	return &it->second.snapshot;
+}
+
+
+fmippBoolean CheckpointStore::contains( fmippTime time ) const
+{
+	return checkpoints_.end() != checkpoints_.find( time );
+}
+
+
+void CheckpointStore::eraseAfter( fmippTime time )
+{
+	Checkpoints::iterator it = checkpoints_.upper_bound( time );
+	while ( checkpoints_.end() != it ) erase( it++ );
+}
+
+
+void CheckpointStore::unpinAll()
+{
+	for ( Checkpoints::iterator it = checkpoints_.begin(); it != checkpoints_.end(); ++it )
+		it->second.pinned = fmippFalse;
+	evict();
+}
+
+
+void CheckpointStore::clear()
+{
+	checkpoints_.clear();
+	used_.clear();
+	spare_.reset();
+	memory_ = 0;
+}
+
+
+FMUSnapshot CheckpointStore::takeSpare()
+{
+	return move( spare_ );
+}
+
+
+void CheckpointStore::erase( Checkpoints::iterator it )
+{
+	memory_ -= it->second.memory;
+	used_.erase( it->second.used );
+	spare_ = move( it->second.snapshot );
+	checkpoints_.erase( it );
+}
+
+
+void CheckpointStore::evict()
+{
+	list<fmippTime>::iterator candidate = used_.begin();
+
+	while ( ( ( 0 != maxCheckpoints_ ) && ( checkpoints_.size() > maxCheckpoints_ ) ) ||
+		( ( 0 != maxMemory_ ) && ( memory_ > maxMemory_ ) ) )
+	{
+		// Skip pinned checkpoints.
+		while ( ( used_.end() != candidate ) && checkpoints_.find( *candidate )->second.pinned ) ++candidate;
+		if ( used_.end() == candidate ) return;
+
+		Checkpoints::iterator it = checkpoints_.find( *candidate++ );
+		erase( it );
+		++nEvictions_;
+	}
+}
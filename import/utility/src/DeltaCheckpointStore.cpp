@@ -0,0 +1,427 @@
+// -------------------------------------------------------------------
+// Copyright (c) 2013-2022, AIT Austrian Institute of Technology GmbH.
+// All rights reserved. See file FMIPP_LICENSE for details.
+// -------------------------------------------------------------------
+
+/**
+ * \file DeltaCheckpointStore.cpp
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <iterator>
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include "import/utility/include/DeltaCheckpointStore.h"
+
+using namespace std;
+using namespace boost::interprocess;
+
+
+namespace {
+
+	/// Minimum number of unchanged bytes that end a run of changed bytes.
+	const fmippSize minUnchangedRun = 8;
+
+	/// Append a size as variable-length integer ( 7 bits per byte ).
+	void writeSize( vector<fmippChar>& data, fmippSize value )
+	{
+		while ( value >= 0x80 ) {
+			data.push_back( static_cast<fmippChar>( ( value & 0x7f ) | 0x80 ) );
+			value >>= 7;
+		}
+		data.push_back( static_cast<fmippChar>( value ) );
+	}
+
+	/// Read a size written by writeSize.
+	fmippSize readSize( const fmippChar*& data )
+	{
+		fmippSize value = 0;
+		unsigned int shift = 0;
+		unsigned char byte;
+		do {
+			byte = static_cast<unsigned char>( *data++ );
+			value |= static_cast<fmippSize>( byte & 0x7f ) << shift;
+			shift += 7;
+		} while ( byte & 0x80 );
+		return value;
+	}
+
+	/// Byte of a state, states are padded with zeros.
+	inline fmippChar byteAt( const vector<fmippChar>& state, fmippSize i )
+	{
+		return ( i < state.size() ) ? state[i] : 0;
+	}
+}
+
+
+DeltaCheckpointStore::DeltaCheckpointStore( fmippSize keyframeInterval, fmippSize maxMemory ) :
+	cacheTime_( 0 ),
+	cacheValid_( fmippFalse ),
+	spillFileSize_( 0 ),
+	keyframeInterval_( max<fmippSize>( keyframeInterval, 1 ) ),
+	maxMemory_( maxMemory ),
+	memory_( 0 ),
+	spilledMemory_( 0 ),
+	rawMemory_( 0 ),
+	nEvictions_( 0 )
+{}
+
+
+DeltaCheckpointStore::~DeltaCheckpointStore()
+{
+	spillRegion_.reset();
+	if ( spillFile_.is_open() ) spillFile_.close();
+	if ( false == spillPath_.empty() ) remove( spillPath_.c_str() );
+}
+
+
+void DeltaCheckpointStore::setKeyframeInterval( fmippSize keyframeInterval )
+{
+	keyframeInterval_ = max<fmippSize>( keyframeInterval, 1 );
+}
+
+
+void DeltaCheckpointStore::setMemoryLimit( fmippSize maxMemory )
+{
+	maxMemory_ = maxMemory;
+	evict();
+}
+
+
+fmippStatus DeltaCheckpointStore::setSpillFile( const fmippString& path )
+{
+	closeSpillFile();
+
+	fmippStatus status = fmippOK;
+
+	if ( false == path.empty() ) {
+		spillFile_.open( path.c_str(), ios::out | ios::binary | ios::trunc );
+		if ( spillFile_.is_open() ) {
+			spillPath_ = path;
+		} else {
+			status = fmippError;
+		}
+	}
+
+	evict();
+	return status;
+}
+
+
+void DeltaCheckpointStore::insert( fmippTime time, const vector<fmippChar>& state, fmippBoolean pinned )
+{
+	// Checkpoints at or after this time belong to a discarded future.
+	Checkpoints::iterator it = checkpoints_.lower_bound( time );
+	while ( checkpoints_.end() != it ) erase( it++ );
+
+	// Encode the difference to the previous checkpoint, or to an empty state for a key frame.
+	fmippBoolean keyframe = fmippTrue;
+	fmippSize position = 0;
+
+	if ( false == checkpoints_.empty() ) {
+		Checkpoints::iterator last = prev( checkpoints_.end() );
+		if ( ( last->second.position + 1 < keyframeInterval_ ) && restore( last ) ) {
+			keyframe = fmippFalse;
+			position = last->second.position + 1;
+		}
+	}
+
+	if ( keyframe ) cache_.clear();
+	encode( cache_, state, encoded_ );
+
+	Checkpoint& checkpoint = checkpoints_[time];
+	checkpoint.keyframe = keyframe;
+	checkpoint.position = position;
+	checkpoint.size = state.size();
+	checkpoint.data.assign( encoded_.begin(), encoded_.end() );
+	checkpoint.offset = 0;
+	checkpoint.length = encoded_.size();
+	checkpoint.spilled = fmippFalse;
+	checkpoint.pinned = pinned;
+
+	memory_ += checkpoint.length;
+	rawMemory_ += checkpoint.size;
+
+	// The new checkpoint is the base for the next difference.
+	cache_ = state;
+	cacheTime_ = time;
+	cacheValid_ = fmippTrue;
+
+	evict();
+}
+
+
+fmippBoolean DeltaCheckpointStore::find( fmippTime time, fmippTime& checkpointTime, vector<fmippChar>& state )
+{
+	Checkpoints::iterator it = checkpoints_.upper_bound( time );
+	if ( checkpoints_.begin() == it ) return fmippFalse;
+
+	--it;
+	if ( false == restore( it ) ) return fmippFalse;
+
+	checkpointTime = it->first;
+	state = cache_;
+	return fmippTrue;
+}
+
+
+fmippBoolean DeltaCheckpointStore::contains( fmippTime time ) const
+{
+	return checkpoints_.end() != checkpoints_.find( time );
+}
+
+
+void DeltaCheckpointStore::eraseAfter( fmippTime time )
+{
+	Checkpoints::iterator it = checkpoints_.upper_bound( time );
+	while ( checkpoints_.end() != it ) erase( it++ );
+}
+
+
+void DeltaCheckpointStore::unpinAll()
+{
+	for ( Checkpoints::iterator it = checkpoints_.begin(); it != checkpoints_.end(); ++it )
+		it->second.pinned = fmippFalse;
+	evict();
+}
+
+
+void DeltaCheckpointStore::clear()
+{
+	checkpoints_.clear();
+	cache_.clear();
+	cacheValid_ = fmippFalse;
+	memory_ = 0;
+	spilledMemory_ = 0;
+	rawMemory_ = 0;
+
+	resetSpillFile();
+}
+
+
+void DeltaCheckpointStore::encode( const vector<fmippChar>& previous, const vector<fmippChar>& state,
+	vector<fmippChar>& data )
+{
+	data.clear();
+
+	const fmippSize size = state.size();
+	fmippSize pos = 0;
+
+	while ( pos < size ) {
+		// Unchanged bytes.
+		fmippSize begin = pos;
+		while ( ( pos < size ) && ( state[pos] == byteAt( previous, pos ) ) ) ++pos;
+
+		// Trailing unchanged bytes are implied by the size.
+		if ( pos == size ) break;
+
+		const fmippSize unchanged = pos - begin;
+
+		// Changed bytes, up to the next longer run of unchanged bytes.
+		begin = pos;
+		fmippSize run = 0;
+		while ( ( pos < size ) && ( run < minUnchangedRun ) ) {
+			run = ( state[pos] == byteAt( previous, pos ) ) ? run + 1 : 0;
+			++pos;
+		}
+		pos -= run;
+
+		writeSize( data, unchanged );
+		writeSize( data, pos - begin );
+		for ( fmippSize i = begin; i < pos; ++i )
+			data.push_back( static_cast<fmippChar>( state[i] ^ byteAt( previous, i ) ) );
+	}
+}
+
+
+void DeltaCheckpointStore::decode( const fmippChar* data, fmippSize length, fmippSize size, vector<fmippChar>& state )
+{
+	state.resize( size, 0 );
+
+	const fmippChar* end = data + length;
+	fmippSize pos = 0;
+
+	while ( data < end ) {
+		pos += readSize( data );
+		const fmippSize changed = readSize( data );
+		assert( pos + changed <= size );
+
+		for ( fmippSize i = 0; i < changed; ++i ) state[pos + i] ^= data[i];
+
+		data += changed;
+		pos += changed;
+	}
+}
+
+
+const fmippChar* DeltaCheckpointStore::data( const Checkpoint& checkpoint )
+{
+	if ( false == checkpoint.spilled ) return checkpoint.data.data();
+
+	// Map the spill file again if it has grown since it was mapped.
+	if ( ( 0 == spillRegion_.get() ) || ( checkpoint.offset + checkpoint.length > spillRegion_->get_size() ) ) {
+		spillFile_.flush();
+		try {
+			file_mapping mapping( spillPath_.c_str(), read_only );
+			spillRegion_.reset( new mapped_region( mapping, read_only ) );
+		} catch ( interprocess_exception& ) {
+			spillRegion_.reset();
+			return 0;
+		}
+	}
+
+	return static_cast<const fmippChar*>( spillRegion_->get_address() ) + checkpoint.offset;
+}
+
+
+bool DeltaCheckpointStore::restore( Checkpoints::iterator it )
+{
+	if ( cacheValid_ && ( cacheTime_ == it->first ) ) return true;
+
+	// Start from the cached state if it is in the same chain of differences, otherwise from the key frame.
+	Checkpoints::iterator first = it;
+	while ( ( false == first->second.keyframe ) && ( ( false == cacheValid_ ) || ( cacheTime_ != first->first ) ) )
+		--first;
+
+	if ( cacheValid_ && ( cacheTime_ == first->first ) ) {
+		++first;
+	} else {
+		cache_.clear();
+	}
+
+	cacheValid_ = fmippFalse;
+
+	for ( ; ; ++first ) {
+		const fmippChar* encoded = data( first->second );
+		if ( 0 == encoded ) return false;
+
+		decode( encoded, first->second.length, first->second.size, cache_ );
+		if ( first == it ) break;
+	}
+
+	cacheTime_ = it->first;
+	cacheValid_ = fmippTrue;
+	return true;
+}
+
+
+void DeltaCheckpointStore::erase( Checkpoints::iterator it )
+{
+	if ( it->second.spilled ) {
+		spilledMemory_ -= it->second.length;
+	} else {
+		memory_ -= it->second.length;
+	}
+	rawMemory_ -= it->second.size;
+
+	if ( cacheValid_ && ( cacheTime_ == it->first ) ) cacheValid_ = fmippFalse;
+
+	checkpoints_.erase( it );
+
+	// Reclaim the space of the spill file once no spilled checkpoint is left.
+	if ( 0 == spilledMemory_ ) resetSpillFile();
+}
+
+
+void DeltaCheckpointStore::evict()
+{
+	if ( 0 == maxMemory_ ) return;
+
+	if ( spillFile_.is_open() ) {
+		// Move the oldest checkpoints held in memory to the spill file.
+		Checkpoints::iterator it = checkpoints_.begin();
+		while ( ( memory_ > maxMemory_ ) && ( checkpoints_.end() != it ) ) {
+			if ( ( false == it->second.spilled ) && ( 0 != it->second.length ) && ( false == spill( it->second ) ) ) return;
+			++it;
+		}
+		return;
+	}
+
+	while ( memory_ > maxMemory_ ) {
+		// Evict the oldest checkpoint that is neither pinned nor the newest one.
+		Checkpoints::iterator it = checkpoints_.begin();
+		while ( ( checkpoints_.end() != it ) && it->second.pinned ) ++it;
+		if ( ( checkpoints_.end() == it ) || ( checkpoints_.end() == std::next( it ) ) ) return;
+
+		Checkpoints::iterator next = std::next( it );
+
+		// Without the evicted checkpoint, the next one has to be encoded as key frame.
+		if ( false == next->second.keyframe ) {
+			if ( false == restore( next ) ) return;
+
+			encode( vector<fmippChar>(), cache_, encoded_ );
+			memory_ = memory_ - next->second.length + encoded_.size();
+			next->second.data.assign( encoded_.begin(), encoded_.end() );
+			next->second.length = encoded_.size();
+			next->second.keyframe = fmippTrue;
+
+			const fmippSize position = next->second.position;
+			for ( Checkpoints::iterator later = next; ( checkpoints_.end() != later ) &&
+				( later->second.position >= position ); ++later ) later->second.position -= position;
+		}
+
+		erase( it );
+		++nEvictions_;
+	}
+}
+
+
+bool DeltaCheckpointStore::spill( Checkpoint& checkpoint )
+{
+	spillFile_.write( checkpoint.data.data(), checkpoint.length );
+	if ( false == spillFile_.good() ) return false;
+
+	checkpoint.offset = spillFileSize_;
+	checkpoint.spilled = fmippTrue;
+	vector<fmippChar>().swap( checkpoint.data );
+
+	spillFileSize_ += checkpoint.length;
+	memory_ -= checkpoint.length;
+	spilledMemory_ += checkpoint.length;
+
+	return true;
+}
+
+
+void DeltaCheckpointStore::resetSpillFile()
+{
+	if ( 0 == spillFileSize_ ) return;
+
+	spillRegion_.reset();
+	spillFile_.close();
+	spillFile_.open( spillPath_.c_str(), ios::out | ios::binary | ios::trunc );
+	spillFileSize_ = 0;
+}
+
+
+void DeltaCheckpointStore::closeSpillFile()
+{
+	if ( spillPath_.empty() ) return;
+
+	// Read the spilled checkpoints back into memory.
+	for ( Checkpoints::iterator it = checkpoints_.begin(); it != checkpoints_.end(); ++it ) {
+		if ( false == it->second.spilled ) continue;
+
+		const fmippChar* encoded = data( it->second );
+		if ( 0 == encoded ) { // Without this checkpoint, the later ones cannot be decoded anymore.
+			while ( checkpoints_.end() != it ) erase( it++ );
+			break;
+		}
+
+		it->second.data.assign( encoded, encoded + it->second.length );
+		it->second.spilled = fmippFalse;
+		spilledMemory_ -= it->second.length;
+		memory_ += it->second.length;
+	}
+
+	spillRegion_.reset();
+	spillFile_.close();
+	remove( spillPath_.c_str() );
+	spillPath_.clear();
+	spillFileSize_ = 0;
+	spilledMemory_ = 0;
+}
@@ -0,0 +1,370 @@
+// -------------------------------------------------------------------
+// Copyright (c) 2013-2022, AIT Austrian Institute of Technology GmbH.
+// All rights reserved. See file FMIPP_LICENSE for details.
+// -------------------------------------------------------------------
+
+/**
+ * \file FMUInstancePool.cpp
+ */
+
+#include <sstream>
+
+#include "import/base/include/ModelDescription.h"
+#include "import/integrators/include/IntegratorStatistics.h"
+
+#include "import/utility/include/FMUInstancePool.h"
+
+using namespace std;
+
+
+template<class FMUType>
+FMUInstancePool<FMUType>::FMUInstancePool( const fmippString& instanceName, const fmippBoolean loggingOn ) :
+	pool_( new Pool )
+{
+	pool_->instanceName = instanceName;
+	pool_->loggingOn = loggingOn;
+	pool_->maxIdle = 16;
+	pool_->threadAffinity = fmippFalse;
+	pool_->nInstances = 0;
+}
+
+
+template<class FMUType>
+FMUInstancePool<FMUType>::~FMUInstancePool()
+{
+	// Instances still in use are deleted by their releasers.
+	clear();
+}
+
+
+template<class FMUType>
+typename FMUInstancePool<FMUType>::Instance
+FMUInstancePool<FMUType>::acquire( const fmippString& modelIdentifier )
+{
+	FMUType* fmu = 0;
+
+	{
+		lock_guard<mutex> lock( pool_->poolMutex );
+
+		Model& model = pool_->models[modelIdentifier];
+		++model.statistics.acquired;
+
+		// Take the most recently returned instance ( of this thread if thread affinity is enabled ).
+		const thread::id self = this_thread::get_id();
+		for ( typename vector<Idle>::reverse_iterator it = model.idle.rbegin(); it != model.idle.rend(); ++it ) {
+			if ( ( fmippFalse == pool_->threadAffinity ) || ( self == it->owner ) ) {
+				fmu = it->fmu;
+				model.idle.erase( ( ++it ).base() );
+				++model.statistics.recycled;
+				break;
+			}
+		}
+	}
+
+	// Create a new instance ( without holding the lock ).
+	if ( 0 == fmu ) fmu = pool_->create( modelIdentifier );
+
+	return Instance( fmu, Releaser( pool_, modelIdentifier ) );
+}
+
+
+template<class FMUType>
+fmippSize FMUInstancePool<FMUType>::reserve( const fmippString& modelIdentifier, fmippSize nInstances )
+{
+	while ( true )
+	{
+		{
+			lock_guard<mutex> lock( pool_->poolMutex );
+			Model& model = pool_->models[modelIdentifier];
+			const fmippSize maxIdle = model.hasMaxIdle ? model.maxIdle : pool_->maxIdle;
+			if ( ( model.idle.size() >= nInstances ) || ( model.idle.size() >= maxIdle ) )
+				return model.idle.size();
+		}
+
+		FMUType* fmu = pool_->create( modelIdentifier );
+		if ( 0 == fmu ) return getNumberOfIdleInstances( modelIdentifier );
+
+		lock_guard<mutex> lock( pool_->poolMutex );
+		Idle idle = { fmu, this_thread::get_id() };
+		pool_->models[modelIdentifier].idle.push_back( idle );
+	}
+}
+
+
+template<class FMUType>
+void FMUInstancePool<FMUType>::setMaxIdleInstances( fmippSize maxIdle )
+{
+	lock_guard<mutex> lock( pool_->poolMutex );
+	pool_->maxIdle = maxIdle;
+}
+
+
+template<class FMUType>
+void FMUInstancePool<FMUType>::setMaxIdleInstances( const fmippString& modelIdentifier, fmippSize maxIdle )
+{
+	lock_guard<mutex> lock( pool_->poolMutex );
+	Model& model = pool_->models[modelIdentifier];
+	model.maxIdle = maxIdle;
+	model.hasMaxIdle = fmippTrue;
+}
+
+
+template<class FMUType>
+void FMUInstancePool<FMUType>::setThreadAffinity( fmippBoolean threadAffinity )
+{
+	lock_guard<mutex> lock( pool_->poolMutex );
+	pool_->threadAffinity = threadAffinity;
+}
+
+
+template<class FMUType>
+fmippSize FMUInstancePool<FMUType>::getNumberOfIdleInstances( const fmippString& modelIdentifier ) const
+{
+	lock_guard<mutex> lock( pool_->poolMutex );
+	typename map<fmippString, Model>::const_iterator it = pool_->models.find( modelIdentifier );
+	return ( it == pool_->models.end() ) ? 0 : it->second.idle.size();
+}
+
+
+template<class FMUType>
+void FMUInstancePool<FMUType>::clear()
+{
+	vector<Idle> idle;
+
+	{
+		lock_guard<mutex> lock( pool_->poolMutex );
+		typename map<fmippString, Model>::iterator it;
+		for ( it = pool_->models.begin(); it != pool_->models.end(); ++it ) {
+			idle.insert( idle.end(), it->second.idle.begin(), it->second.idle.end() );
+			it->second.idle.clear();
+		}
+	}
+
+	// Delete the instances without holding the lock.
+	for ( typename vector<Idle>::iterator it = idle.begin(); it != idle.end(); ++it ) delete it->fmu;
+}
+
+
+template<class FMUType>
+FMUInstancePoolStatistics FMUInstancePool<FMUType>::getStatistics( const fmippString& modelIdentifier ) const
+{
+	lock_guard<mutex> lock( pool_->poolMutex );
+	typename map<fmippString, Model>::const_iterator it = pool_->models.find( modelIdentifier );
+	return ( it == pool_->models.end() ) ? FMUInstancePoolStatistics() : it->second.statistics;
+}
+
+
+template<class FMUType>
+FMUInstancePoolStatistics FMUInstancePool<FMUType>::getStatistics() const
+{
+	lock_guard<mutex> lock( pool_->poolMutex );
+	FMUInstancePoolStatistics statistics;
+	typename map<fmippString, Model>::const_iterator it;
+	for ( it = pool_->models.begin(); it != pool_->models.end(); ++it ) statistics += it->second.statistics;
+	return statistics;
+}
+
+
+template<class FMUType>
+void FMUInstancePool<FMUType>::Releaser::operator()( FMUType* fmu ) const
+{
+	if ( 0 == fmu ) return;
+
+	shared_ptr<Pool> pool = pool_.lock();
+	if ( pool ) {
+		pool->release( fmu, modelIdentifier_ );
+	} else {
+		delete fmu; // The pool has been destroyed.
+	}
+}
+
+
+template<class FMUType>
+FMUType* FMUInstancePool<FMUType>::Pool::create( const fmippString& modelIdentifier )
+{
+	fmippString name;
+	fmippBoolean logging;
+
+	{
+		lock_guard<mutex> lock( poolMutex );
+		ostringstream str;
+		str << instanceName << ++nInstances;
+		name = str.str();
+		logging = loggingOn;
+	}
+
+	double time = 0.0;
+	FMUType* fmu = 0;
+
+	{
+		StatisticsTimer timer( time );
+		fmu = new FMUType( modelIdentifier, logging );
+		if ( fmippOK != fmu->getLastStatus() ) {
+			delete fmu;
+			return 0;
+		}
+
+		fmippStatus status = FMUInstancePool<FMUType>::instantiate( *fmu, name );
+		if ( ( fmippOK != status ) && ( fmippWarning != status ) ) {
+			delete fmu;
+			return 0;
+		}
+	}
+
+	// Collect the start values outside the lock, the model description is immutable.
+	shared_ptr<const StartValues> startValues;
+	{
+		lock_guard<mutex> lock( poolMutex );
+		startValues = models[modelIdentifier].startValues;
+	}
+	if ( !startValues ) startValues = FMUInstancePool<FMUType>::getStartValues( *fmu );
+
+	lock_guard<mutex> lock( poolMutex );
+	Model& model = models[modelIdentifier];
+	if ( !model.startValues ) model.startValues = startValues;
+	++model.statistics.created;
+	model.statistics.instantiateTime += time;
+
+	return fmu;
+}
+
+
+template<class FMUType>
+fmippBoolean FMUInstancePool<FMUType>::Pool::recycle( FMUType* fmu, const StartValues& startValues ) const
+{
+	fmippStatus status = fmu->reset();
+	if ( ( fmippOK != status ) && ( fmippWarning != status ) ) return fmippFalse;
+
+	const VariableGroup& group = startValues.group;
+
+	if ( fmippOK != group.setValues( *fmu, startValues.realValues.data() ) ) return fmippFalse;
+	if ( fmippOK != group.setValues( *fmu, startValues.integerValues.data() ) ) return fmippFalse;
+
+	// std::vector<bool> provides no contiguous buffer.
+	if ( 0 != group.size( fmippTypeBoolean ) ) {
+		fmippBoolean* booleanValues = new fmippBoolean[group.size( fmippTypeBoolean )];
+		for ( fmippSize i = 0; i < group.size( fmippTypeBoolean ); ++i ) booleanValues[i] = startValues.booleanValues[i];
+		status = group.setValues( *fmu, booleanValues );
+		delete[] booleanValues;
+		if ( fmippOK != status ) return fmippFalse;
+	}
+
+	if ( fmippOK != group.setValues( *fmu, startValues.stringValues.data() ) ) return fmippFalse;
+
+	return fmippTrue;
+}
+
+
+template<class FMUType>
+void FMUInstancePool<FMUType>::Pool::release( FMUType* fmu, const fmippString& modelIdentifier )
+{
+	shared_ptr<const StartValues> startValues;
+	fmippBoolean full;
+	{
+		lock_guard<mutex> lock( poolMutex );
+		Model& model = models[modelIdentifier];
+		full = ( model.idle.size() >= ( model.hasMaxIdle ? model.maxIdle : this->maxIdle ) );
+		if ( full ) ++model.statistics.discarded;
+		startValues = model.startValues;
+	}
+
+	if ( full ) {
+		delete fmu;
+		return;
+	}
+
+	double time = 0.0;
+	fmippBoolean success;
+	{
+		StatisticsTimer timer( time );
+		success = startValues && recycle( fmu, *startValues );
+	}
+
+	if ( fmippFalse == success ) {
+		// Resetting failed, replace the instance by a new one.
+		delete fmu;
+		fmu = create( modelIdentifier );
+	}
+
+	{
+		lock_guard<mutex> lock( poolMutex );
+		Model& model = models[modelIdentifier];
+		model.statistics.resetTime += time;
+
+		if ( fmippFalse == success ) ++model.statistics.reinstantiated;
+
+		// Other instances may have been returned in the meantime.
+		full = ( model.idle.size() >= ( model.hasMaxIdle ? model.maxIdle : this->maxIdle ) );
+		if ( ( 0 == fmu ) || full ) {
+			++model.statistics.discarded;
+		} else {
+			Idle idle = { fmu, this_thread::get_id() };
+			model.idle.push_back( idle );
+			return;
+		}
+	}
+
+	delete fmu;
+}
+
+
+template<class FMUType>
+shared_ptr<const typename FMUInstancePool<FMUType>::StartValues>
+FMUInstancePool<FMUType>::getStartValues( const FMUType& fmu )
+{
+	shared_ptr<StartValues> startValues( new StartValues );
+
+	const ModelVariableTable& variables = fmu.getModelDescription()->getVariableTable();
+
+	for ( fmippSize i = 0; i < variables.size(); ++i )
+	{
+		// Only variables with start values can be set before initialization,
+		// except for constants and the independent variable.
+		if ( ( fmippFalse == variables.hasStart( i ) ) ||
+		     ( fmippVariabilityConstant == variables.getVariability( i ) ) ||
+		     ( fmippCausalityIndependent == variables.getCausality( i ) ) ) continue;
+
+		const FMIPPVariableType type = variables.getType( i );
+		switch ( type )
+		{
+		case fmippTypeReal:
+			startValues->realValues.push_back( variables.getStartValue( i ) );
+			break;
+		case fmippTypeInteger:
+			startValues->integerValues.push_back( static_cast<fmippInteger>( variables.getStartValue( i ) ) );
+			break;
+		case fmippTypeBoolean:
+			startValues->booleanValues.push_back( 0. != variables.getStartValue( i ) );
+			break;
+		case fmippTypeString:
+			startValues->stringValues.push_back( variables.getStartString( i ) );
+			break;
+		default:
+			continue; // Enumerations are not supported.
+		}
+
+		startValues->group.add( type, variables.getValueReference( i ) );
+	}
+
+	return startValues;
+}
+
+
+template<>
+fmippStatus FMUInstancePool<fmi_2_0::FMUModelExchange>::instantiate( fmi_2_0::FMUModelExchange& fmu,
+	const fmippString& instanceName )
+{
+	return fmu.instantiate( instanceName );
+}
+
+
+template<>
+fmippStatus FMUInstancePool<fmi_2_0::FMUCoSimulation>::instantiate( fmi_2_0::FMUCoSimulation& fmu,
+	const fmippString& instanceName )
+{
+	return fmu.instantiate( instanceName, 0., fmippFalse, fmippFalse );
+}
+
+
+template class FMUInstancePool<fmi_2_0::FMUModelExchange>;
+template class FMUInstancePool<fmi_2_0::FMUCoSimulation>;
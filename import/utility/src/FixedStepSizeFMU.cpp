@@ -25,10 +25,7 @@ FixedStepSizeFMU::FixedStepSizeFMU( const fmippString& fmuDirUri,
 	currentCommunicationPoint_( numeric_limits<fmippTime>::quiet_NaN() ),
 	finalCommunicationPoint_( numeric_limits<fmippTime>::quiet_NaN() ),
 	communicationStepSize_( numeric_limits<fmippTime>::quiet_NaN() ),	fmu_( 0 ),
-	realInputRefs_( 0 ), integerInputRefs_( 0 ), booleanInputRefs_( 0 ), stringInputRefs_( 0 ),
-	nRealInputs_( 0 ), nIntegerInputs_( 0 ), nBooleanInputs_( 0 ), nStringInputs_( 0 ),
-	realOutputRefs_( 0 ), integerOutputRefs_( 0 ), booleanOutputRefs_( 0 ), stringOutputRefs_( 0 ),
-	nRealOutputs_( 0 ), nIntegerOutputs_( 0 ), nBooleanOutputs_( 0 ), nStringOutputs_( 0 ),
+	inputs_( "inputs" ), outputs_( "outputs" ),
 	loggingOn_( loggingOn )
 {
 	// Load the FMU.
@@ -53,31 +50,17 @@ FixedStepSizeFMU::FixedStepSizeFMU( const fmippString& fmuDirUri,
 FixedStepSizeFMU::~FixedStepSizeFMU()
 {
 	if ( 0 != fmu_ ) delete fmu_;
-
-	if ( realInputRefs_ ) delete realInputRefs_;
-	if ( integerInputRefs_ ) delete integerInputRefs_;
-	if ( booleanInputRefs_ ) delete booleanInputRefs_;
-	if ( stringInputRefs_ ) delete stringInputRefs_;
-
-	if ( realOutputRefs_ ) delete realOutputRefs_;
-	if ( integerOutputRefs_ ) delete integerOutputRefs_;
-	if ( booleanOutputRefs_ ) delete booleanOutputRefs_;
-	if ( stringOutputRefs_ ) delete stringOutputRefs_;
 }
 
 void FixedStepSizeFMU::defineRealInputs( const fmippString inputs[], const size_t nInputs )
 {
-	if ( 0 != realInputRefs_ ) delete realInputRefs_;
+	inputs_.define( *fmu_, fmippTypeReal, inputs, nInputs );
 
-	nRealInputs_ = nInputs;
-	realInputRefs_ = new fmiValueReference[nInputs];
-	for ( size_t i = 0; i < nInputs; ++i ) {
-		realInputRefs_[i] = fmu_->getValueRef( inputs[i] );
-
-		if ( fmippTrue == loggingOn_ )
-		{
+	if ( fmippTrue == loggingOn_ )
+	{
+		for ( size_t i = 0; i < nInputs; ++i ) {
 			stringstream msg;
-			msg << "add " << inputs[i] << " (" << realInputRefs_[i] << ") "
+			msg << "add " << inputs[i] << " (" << inputs_.getValueRef( fmippTypeReal, i ) << ") "
 			    << "to real input variables";
 			fmu_->sendDebugMessage( msg.str() );
 		}
@@ -86,17 +69,13 @@ void FixedStepSizeFMU::defineRealInputs( const fmippString inputs[], const size_
 
 void FixedStepSizeFMU::defineIntegerInputs( const fmippString inputs[], const size_t nInputs )
 {
-	if ( 0 != integerInputRefs_ ) delete integerInputRefs_;
+	inputs_.define( *fmu_, fmippTypeInteger, inputs, nInputs );
 
-	nIntegerInputs_ = nInputs;
-	integerInputRefs_ = new fmiValueReference[nInputs];
-	for ( size_t i = 0; i < nInputs; ++i ) {
-		integerInputRefs_[i] = fmu_->getValueRef( inputs[i] );
-
-		if ( fmippTrue == loggingOn_ )
-		{
+	if ( fmippTrue == loggingOn_ )
+	{
+		for ( size_t i = 0; i < nInputs; ++i ) {
 			stringstream msg;
-			msg << "add " << inputs[i] << " (" << integerInputRefs_[i] << ") "
+			msg << "add " << inputs[i] << " (" << inputs_.getValueRef( fmippTypeInteger, i ) << ") "
 			    << "to integer input variables";
 			fmu_->sendDebugMessage( msg.str() );
 		}
@@ -105,17 +84,13 @@ void FixedStepSizeFMU::defineIntegerInputs( const fmippString inputs[], const si
 
 void FixedStepSizeFMU::defineBooleanInputs( const fmippString inputs[], const size_t nInputs )
 {
-	if ( 0 != booleanInputRefs_ ) delete booleanInputRefs_;
+	inputs_.define( *fmu_, fmippTypeBoolean, inputs, nInputs );
 
-	nBooleanInputs_ = nInputs;
-	booleanInputRefs_ = new fmiValueReference[nInputs];
-	for ( size_t i = 0; i < nInputs; ++i ) {
-		booleanInputRefs_[i] = fmu_->getValueRef( inputs[i] );
-
-		if ( fmippTrue == loggingOn_ )
-		{
+	if ( fmippTrue == loggingOn_ )
+	{
+		for ( size_t i = 0; i < nInputs; ++i ) {
 			stringstream msg;
-			msg << "add " << inputs[i] << " (" << booleanInputRefs_[i] << ") "
+			msg << "add " << inputs[i] << " (" << inputs_.getValueRef( fmippTypeBoolean, i ) << ") "
 			    << "to boolean input variables";
 			fmu_->sendDebugMessage( msg.str() );
 		}
@@ -124,17 +99,13 @@ void FixedStepSizeFMU::defineBooleanInputs( const fmippString inputs[], const si
 
 void FixedStepSizeFMU::defineStringInputs( const fmippString inputs[], const size_t nInputs )
 {
-	if ( 0 != stringInputRefs_ ) delete stringInputRefs_;
-
-	nStringInputs_ = nInputs;
-	stringInputRefs_ = new fmiValueReference[nInputs];
-	for ( size_t i = 0; i < nInputs; ++i ) {
-		stringInputRefs_[i] = fmu_->getValueRef( inputs[i] );
+	inputs_.define( *fmu_, fmippTypeString, inputs, nInputs );
 
-		if ( fmippTrue == loggingOn_ )
-		{
+	if ( fmippTrue == loggingOn_ )
+	{
+		for ( size_t i = 0; i < nInputs; ++i ) {
 			stringstream msg;
-			msg << "add " << inputs[i] << " (" << stringInputRefs_[i] << ") "
+			msg << "add " << inputs[i] << " (" << inputs_.getValueRef( fmippTypeString, i ) << ") "
 			    << "to fmippString input variables";
 			fmu_->sendDebugMessage( msg.str() );
 		}
@@ -143,17 +114,13 @@ void FixedStepSizeFMU::defineStringInputs( const fmippString inputs[], const siz
 
 void FixedStepSizeFMU::defineRealOutputs( const fmippString outputs[], const size_t nOutputs )
 {
-	if ( 0 != realOutputRefs_ ) delete realOutputRefs_;
-
-	nRealOutputs_ = nOutputs;
-	realOutputRefs_ = new fmiValueReference[nOutputs];
-	for ( size_t i = 0; i < nOutputs; ++i ) {
-		realOutputRefs_[i] = fmu_->getValueRef( outputs[i] );
+	outputs_.define( *fmu_, fmippTypeReal, outputs, nOutputs );
 
-		if ( fmippTrue == loggingOn_ )
-		{
+	if ( fmippTrue == loggingOn_ )
+	{
+		for ( size_t i = 0; i < nOutputs; ++i ) {
 			stringstream msg;
-			msg << "add " << outputs[i] << " (" << realOutputRefs_[i] << ") "
+			msg << "add " << outputs[i] << " (" << outputs_.getValueRef( fmippTypeReal, i ) << ") "
 			    << "to real output variables";
 			fmu_->sendDebugMessage( msg.str() );
 		}
@@ -162,17 +129,13 @@ void FixedStepSizeFMU::defineRealOutputs( const fmippString outputs[], const siz
 
 void FixedStepSizeFMU::defineIntegerOutputs( const fmippString outputs[], const size_t nOutputs )
 {
-	if ( 0 != integerOutputRefs_ ) delete integerOutputRefs_;
+	outputs_.define( *fmu_, fmippTypeInteger, outputs, nOutputs );
 
-	nIntegerOutputs_ = nOutputs;
-	integerOutputRefs_ = new fmiValueReference[nOutputs];
-	for ( size_t i = 0; i < nOutputs; ++i ) {
-		integerOutputRefs_[i] = fmu_->getValueRef( outputs[i] );
-
-		if ( fmippTrue == loggingOn_ )
-		{
+	if ( fmippTrue == loggingOn_ )
+	{
+		for ( size_t i = 0; i < nOutputs; ++i ) {
 			stringstream msg;
-			msg << "add " << outputs[i] << " (" << integerOutputRefs_[i] << ") "
+			msg << "add " << outputs[i] << " (" << outputs_.getValueRef( fmippTypeInteger, i ) << ") "
 			    << "to integer output variables";
 			fmu_->sendDebugMessage( msg.str() );
 		}
@@ -181,17 +144,13 @@ void FixedStepSizeFMU::defineIntegerOutputs( const fmippString outputs[], const
 
 void FixedStepSizeFMU::defineBooleanOutputs( const fmippString outputs[], const size_t nOutputs )
 {
-	if ( 0 != booleanOutputRefs_ ) delete booleanOutputRefs_;
+	outputs_.define( *fmu_, fmippTypeBoolean, outputs, nOutputs );
 
-	nBooleanOutputs_ = nOutputs;
-	booleanOutputRefs_ = new fmiValueReference[nOutputs];
-	for ( size_t i = 0; i < nOutputs; ++i ) {
-		booleanOutputRefs_[i] = fmu_->getValueRef( outputs[i] );
-
-		if ( fmippTrue == loggingOn_ )
-		{
+	if ( fmippTrue == loggingOn_ )
+	{
+		for ( size_t i = 0; i < nOutputs; ++i ) {
 			stringstream msg;
-			msg << "add " << outputs[i] << " (" << booleanOutputRefs_[i] << ") "
+			msg << "add " << outputs[i] << " (" << outputs_.getValueRef( fmippTypeBoolean, i ) << ") "
 			    << "to boolean output variables";
 			fmu_->sendDebugMessage( msg.str() );
 		}
@@ -200,17 +159,13 @@ void FixedStepSizeFMU::defineBooleanOutputs( const fmippString outputs[], const
 
 void FixedStepSizeFMU::defineStringOutputs( const fmippString outputs[], const size_t nOutputs )
 {
-	if ( 0 != stringOutputRefs_ ) delete stringOutputRefs_;
-
-	nStringOutputs_ = nOutputs;
-	stringOutputRefs_ = new fmiValueReference[nOutputs];
-	for ( size_t i = 0; i < nOutputs; ++i ) {
-		stringOutputRefs_[i] = fmu_->getValueRef( outputs[i] );
+	outputs_.define( *fmu_, fmippTypeString, outputs, nOutputs );
 
-		if ( fmippTrue == loggingOn_ )
-		{
+	if ( fmippTrue == loggingOn_ )
+	{
+		for ( size_t i = 0; i < nOutputs; ++i ) {
 			stringstream msg;
-			msg << "add " << outputs[i] << " (" << stringOutputRefs_[i] << ") "
+			msg << "add " << outputs[i] << " (" << outputs_.getValueRef( fmippTypeString, i ) << ") "
 			    << "to fmippString output variables";
 			fmu_->sendDebugMessage( msg.str() );
 		}
@@ -246,30 +201,22 @@ void FixedStepSizeFMU::setInitialInputs( const fmippString realVariableNames[],
 
 void FixedStepSizeFMU::getOutputs( fmippReal* outputs ) const
 {
-	for ( size_t i = 0; i < nRealOutputs_; ++i ) {
-		fmu_->getValue( realOutputRefs_[i], outputs[i] );
-	}
+	outputs_.getValues( *fmu_, outputs );
 }
 
 void FixedStepSizeFMU::getOutputs( fmippInteger* outputs ) const
 {
-	for ( size_t i = 0; i < nIntegerOutputs_; ++i ) {
-		fmu_->getValue( integerOutputRefs_[i], outputs[i] );
-	}
+	outputs_.getValues( *fmu_, outputs );
 }
 
 void FixedStepSizeFMU::getOutputs( fmippBoolean* outputs ) const
 {
-	for ( size_t i = 0; i < nBooleanOutputs_; ++i ) {
-		fmu_->getValue( booleanOutputRefs_[i], outputs[i] );
-	}
+	outputs_.getValues( *fmu_, outputs );
 }
 
 void FixedStepSizeFMU::getOutputs( fmippString* outputs ) const
 {
-	for ( size_t i = 0; i < nStringOutputs_; ++i ) {
-		fmu_->getValue( stringOutputRefs_[i], outputs[i] );
-	}
+	outputs_.getValues( *fmu_, outputs );
 }
 
 int FixedStepSizeFMU::init( const fmippString& instanceName,
@@ -331,7 +278,7 @@ int FixedStepSizeFMU::init( const fmippString& instanceName,
 	// Intialize FMU.
 	if ( fmu_->initialize( startTime, stopTimeDefined, stopTime ) != fmippOK ) return 0;
 
-	HistoryEntry initState( startTime, 0, nRealOutputs_, nIntegerOutputs_, nBooleanOutputs_, nStringOutputs_ );
+	HistoryEntry initState( startTime, 0, outputs_.size( fmippTypeReal ), outputs_.size( fmippTypeInteger ), outputs_.size( fmippTypeBoolean ), outputs_.size( fmippTypeString ) );
 
 	getOutputs( initState.realValues_ );
 	getOutputs( initState.integerValues_ );
@@ -443,15 +390,13 @@ fmippTime FixedStepSizeFMU::getNextSyncTime( const fmippTime& currentSyncTime )
 
 fmippStatus FixedStepSizeFMU::setInputs( fmippReal* inputs ) const
 {
-	fmippStatus status = fmippOK;
+	fmippStatus status = ( fmippOK == inputs_.setValues( *fmu_, inputs ) ) ? fmippOK : fmippError;
 
-	for ( size_t i = 0; i < nRealInputs_; ++i ) {
-		if ( fmippOK != fmu_->setValue( realInputRefs_[i], inputs[i]) ) status = fmippError;
-
-		if ( fmippTrue == loggingOn_ )
-		{
+	if ( fmippTrue == loggingOn_ )
+	{
+		for ( size_t i = 0; i < inputs_.size( fmippTypeReal ); ++i ) {
 			stringstream msg;
-			msg << "set real input " << realInputRefs_[i] << " = " << inputs[i];
+			msg << "set real input " << inputs_.getValueRef( fmippTypeReal, i ) << " = " << inputs[i];
 			fmu_->sendDebugMessage( msg.str() );
 		}
 	}
@@ -461,16 +406,13 @@ fmippStatus FixedStepSizeFMU::setInputs( fmippReal* inputs ) const
 
 fmippStatus FixedStepSizeFMU::setInputs( fmippInteger* inputs ) const
 {
+	fmippStatus status = ( fmippOK == inputs_.setValues( *fmu_, inputs ) ) ? fmippOK : fmippError;
 
-	fmippStatus status = fmippOK;
-
-	for ( size_t i = 0; i < nIntegerInputs_; ++i ) {
-		if ( fmippOK != fmu_->setValue( integerInputRefs_[i], inputs[i]) ) status = fmippError;
-
-		if ( fmippTrue == loggingOn_ )
-		{
+	if ( fmippTrue == loggingOn_ )
+	{
+		for ( size_t i = 0; i < inputs_.size( fmippTypeInteger ); ++i ) {
 			stringstream msg;
-			msg << "set integer input " << integerInputRefs_[i] << " = " << inputs[i];
+			msg << "set integer input " << inputs_.getValueRef( fmippTypeInteger, i ) << " = " << inputs[i];
 			fmu_->sendDebugMessage( msg.str() );
 		}
 	}
@@ -480,16 +422,13 @@ fmippStatus FixedStepSizeFMU::setInputs( fmippInteger* inputs ) const
 
 fmippStatus FixedStepSizeFMU::setInputs( fmippBoolean* inputs ) const
 {
+	fmippStatus status = ( fmippOK == inputs_.setValues( *fmu_, inputs ) ) ? fmippOK : fmippError;
 
-	fmippStatus status = fmippOK;
-
-	for ( size_t i = 0; i < nBooleanInputs_; ++i ) {
-		if ( fmippOK != fmu_->setValue( booleanInputRefs_[i], inputs[i]) ) status = fmippError;
-
-		if ( fmippTrue == loggingOn_ )
-		{
+	if ( fmippTrue == loggingOn_ )
+	{
+		for ( size_t i = 0; i < inputs_.size( fmippTypeBoolean ); ++i ) {
 			stringstream msg;
-			msg << "set boolean input " << booleanInputRefs_[i] << " = " << inputs[i];
+			msg << "set boolean input " << inputs_.getValueRef( fmippTypeBoolean, i ) << " = " << inputs[i];
 			fmu_->sendDebugMessage( msg.str() );
 		}
 	}
@@ -499,16 +438,13 @@ fmippStatus FixedStepSizeFMU::setInputs( fmippBoolean* inputs ) const
 
 fmippStatus FixedStepSizeFMU::setInputs( fmippString* inputs ) const
 {
+	fmippStatus status = ( fmippOK == inputs_.setValues( *fmu_, inputs ) ) ? fmippOK : fmippError;
 
-	fmippStatus status = fmippOK;
-
-	for ( size_t i = 0; i < nStringInputs_; ++i ) {
-		if ( fmippOK != fmu_->setValue( stringInputRefs_[i], inputs[i]) ) status = fmippError;
-
-		if ( fmippTrue == loggingOn_ )
-		{
+	if ( fmippTrue == loggingOn_ )
+	{
+		for ( size_t i = 0; i < inputs_.size( fmippTypeString ); ++i ) {
 			stringstream msg;
-			msg << "set fmippString input " << stringInputRefs_[i] << " = " << inputs[i];
+			msg << "set fmippString input " << inputs_.getValueRef( fmippTypeString, i ) << " = " << inputs[i];
 			fmu_->sendDebugMessage( msg.str() );
 		}
 	}
@@ -24,10 +24,7 @@ IncrementalFMU::IncrementalFMU( const fmippString& fmuDirUri,
 	const fmippReal timeDiffResolution,
 	const IntegratorType integratorType ) :
 		fmu_(NULL),
-		realInputRefs_( 0 ), integerInputRefs_( 0 ), booleanInputRefs_( 0 ), stringInputRefs_( 0 ),
-		nRealInputs_( 0 ), nIntegerInputs_( 0 ), nBooleanInputs_( 0 ), nStringInputs_( 0 ),
-		realOutputRefs_( 0 ), integerOutputRefs_( 0 ), booleanOutputRefs_( 0 ), stringOutputRefs_( 0 ),
-		nRealOutputs_( 0 ), nIntegerOutputs_( 0 ), nBooleanOutputs_( 0 ), nStringOutputs_( 0 ),
+		inputs_( "inputs" ), outputs_( "outputs" ),
 		lookAheadHorizon_( numeric_limits<fmippTime>::quiet_NaN() ),
 		lookaheadStepSize_( numeric_limits<fmippTime>::quiet_NaN() ),
 		integratorStepSize_( numeric_limits<fmippTime>::quiet_NaN() ),
@@ -53,10 +50,7 @@ IncrementalFMU::IncrementalFMU( const fmippString& modelIdentifier,
 	const fmippReal timeDiffResolution,
 	const IntegratorType integratorType ) :
 		fmu_(NULL),
-		realInputRefs_( 0 ), integerInputRefs_( 0 ), booleanInputRefs_( 0 ), stringInputRefs_( 0 ),
-		nRealInputs_( 0 ), nIntegerInputs_( 0 ), nBooleanInputs_( 0 ), nStringInputs_( 0 ),
-		realOutputRefs_( 0 ), integerOutputRefs_( 0 ), booleanOutputRefs_( 0 ), stringOutputRefs_( 0 ),
-		nRealOutputs_( 0 ), nIntegerOutputs_( 0 ), nBooleanOutputs_( 0 ), nStringOutputs_( 0 ),
+		inputs_( "inputs" ), outputs_( "outputs" ),
 		lookAheadHorizon_( numeric_limits<fmippTime>::quiet_NaN() ),
 		lookaheadStepSize_( numeric_limits<fmippTime>::quiet_NaN() ),
 		integratorStepSize_( numeric_limits<fmippTime>::quiet_NaN() ),
@@ -78,16 +72,6 @@ IncrementalFMU::IncrementalFMU( const fmippString& modelIdentifier,
 IncrementalFMU::~IncrementalFMU()
 {
 	if ( 0 != fmu_ ) delete fmu_;
-
-	if ( realInputRefs_ ) delete realInputRefs_;
-	if ( integerInputRefs_ ) delete integerInputRefs_;
-	if ( booleanInputRefs_ ) delete booleanInputRefs_;
-	if ( stringInputRefs_ ) delete stringInputRefs_;
-
-	if ( realOutputRefs_ ) delete realOutputRefs_;
-	if ( integerOutputRefs_ ) delete integerOutputRefs_;
-	if ( booleanOutputRefs_ ) delete booleanOutputRefs_;
-	if ( stringOutputRefs_ ) delete stringOutputRefs_;
 }
 
 void IncrementalFMU::setIntegratorProperties( Integrator::Properties& prop )
@@ -106,6 +90,22 @@ Integrator::Properties IncrementalFMU::getIntegratorProperties() const
 	return fmu_->getIntegratorProperties();
 }
 
+IntegratorStatistics IncrementalFMU::getIntegratorStatistics() const
+{
+	assert( fmu_ );
+	if ( !fmu_ ) return IntegratorStatistics();
+
+	return fmu_->getIntegratorStatistics();
+}
+
+void IncrementalFMU::resetIntegratorStatistics()
+{
+	assert( fmu_ );
+	if ( !fmu_ ) return;
+
+	fmu_->resetIntegratorStatistics();
+}
+
 FMIPPVariableType IncrementalFMU::getType( const fmippString& varName ) const
 {
 	return fmu_->getType( varName );
@@ -113,17 +113,13 @@ FMIPPVariableType IncrementalFMU::getType( const fmippString& varName ) const
 
 void IncrementalFMU::defineRealInputs( const fmippString inputs[], const fmippSize nInputs )
 {
-	if ( 0 != realInputRefs_ ) delete realInputRefs_;
-
-	nRealInputs_ = nInputs;
-	realInputRefs_ = new fmiValueReference[nInputs];
-	for ( fmippSize i = 0; i < nInputs; ++i ) {
-		realInputRefs_[i] = fmu_->getValueRef( inputs[i] );
+	inputs_.define( *fmu_, fmippTypeReal, inputs, nInputs );
 
-		if ( fmippTrue == loggingOn_ )
-		{
+	if ( fmippTrue == loggingOn_ )
+	{
+		for ( size_t i = 0; i < nInputs; ++i ) {
 			stringstream msg;
-			msg << "add " << inputs[i] << " (" << realInputRefs_[i] << ") "
+			msg << "add " << inputs[i] << " (" << inputs_.getValueRef( fmippTypeReal, i ) << ") "
 			    << "to real input variables";
 			fmu_->sendDebugMessage( msg.str() );
 		}
@@ -132,17 +128,13 @@ void IncrementalFMU::defineRealInputs( const fmippString inputs[], const fmippSi
 
 void IncrementalFMU::defineIntegerInputs( const fmippString inputs[], const fmippSize nInputs )
 {
-	if ( 0 != integerInputRefs_ ) delete integerInputRefs_;
+	inputs_.define( *fmu_, fmippTypeInteger, inputs, nInputs );
 
-	nIntegerInputs_ = nInputs;
-	integerInputRefs_ = new fmiValueReference[nInputs];
-	for ( fmippSize i = 0; i < nInputs; ++i ) {
-		integerInputRefs_[i] = fmu_->getValueRef( inputs[i] );
-
-		if ( fmippTrue == loggingOn_ )
-		{
+	if ( fmippTrue == loggingOn_ )
+	{
+		for ( size_t i = 0; i < nInputs; ++i ) {
 			stringstream msg;
-			msg << "add " << inputs[i] << " (" << integerInputRefs_[i] << ") "
+			msg << "add " << inputs[i] << " (" << inputs_.getValueRef( fmippTypeInteger, i ) << ") "
 			    << "to integer input variables";
 			fmu_->sendDebugMessage( msg.str() );
 		}
@@ -151,17 +143,13 @@ void IncrementalFMU::defineIntegerInputs( const fmippString inputs[], const fmip
 
 void IncrementalFMU::defineBooleanInputs( const fmippString inputs[], const fmippSize nInputs )
 {
-	if ( 0 != booleanInputRefs_ ) delete booleanInputRefs_;
-
-	nBooleanInputs_ = nInputs;
-	booleanInputRefs_ = new fmiValueReference[nInputs];
-	for ( fmippSize i = 0; i < nInputs; ++i ) {
-		booleanInputRefs_[i] = fmu_->getValueRef( inputs[i] );
+	inputs_.define( *fmu_, fmippTypeBoolean, inputs, nInputs );
 
-		if ( fmippTrue == loggingOn_ )
-		{
+	if ( fmippTrue == loggingOn_ )
+	{
+		for ( size_t i = 0; i < nInputs; ++i ) {
 			stringstream msg;
-			msg << "add " << inputs[i] << " (" << booleanInputRefs_[i] << ") "
+			msg << "add " << inputs[i] << " (" << inputs_.getValueRef( fmippTypeBoolean, i ) << ") "
 			    << "to boolean input variables";
 			fmu_->sendDebugMessage( msg.str() );
 		}
@@ -170,17 +158,13 @@ void IncrementalFMU::defineBooleanInputs( const fmippString inputs[], const fmip
 
 void IncrementalFMU::defineStringInputs( const fmippString inputs[], const fmippSize nInputs )
 {
-	if ( 0 != stringInputRefs_ ) delete stringInputRefs_;
+	inputs_.define( *fmu_, fmippTypeString, inputs, nInputs );
 
-	nStringInputs_ = nInputs;
-	stringInputRefs_ = new fmiValueReference[nInputs];
-	for ( fmippSize i = 0; i < nInputs; ++i ) {
-		stringInputRefs_[i] = fmu_->getValueRef( inputs[i] );
-
-		if ( fmippTrue == loggingOn_ )
-		{
+	if ( fmippTrue == loggingOn_ )
+	{
+		for ( size_t i = 0; i < nInputs; ++i ) {
 			stringstream msg;
-			msg << "add " << inputs[i] << " (" << stringInputRefs_[i] << ") "
+			msg << "add " << inputs[i] << " (" << inputs_.getValueRef( fmippTypeString, i ) << ") "
 			    << "to fmippString input variables";
 			fmu_->sendDebugMessage( msg.str() );
 		}
@@ -189,17 +173,13 @@ void IncrementalFMU::defineStringInputs( const fmippString inputs[], const fmipp
 
 void IncrementalFMU::defineRealOutputs( const fmippString outputs[], const fmippSize nOutputs )
 {
-	if ( 0 != realOutputRefs_ ) delete realOutputRefs_;
-
-	nRealOutputs_ = nOutputs;
-	realOutputRefs_ = new fmiValueReference[nOutputs];
-	for ( fmippSize i = 0; i < nOutputs; ++i ) {
-		realOutputRefs_[i] = fmu_->getValueRef( outputs[i] );
+	outputs_.define( *fmu_, fmippTypeReal, outputs, nOutputs );
 
-		if ( fmippTrue == loggingOn_ )
-		{
+	if ( fmippTrue == loggingOn_ )
+	{
+		for ( size_t i = 0; i < nOutputs; ++i ) {
 			stringstream msg;
-			msg << "add " << outputs[i] << " (" << realOutputRefs_[i] << ") "
+			msg << "add " << outputs[i] << " (" << outputs_.getValueRef( fmippTypeReal, i ) << ") "
 			    << "to real output variables";
 			fmu_->sendDebugMessage( msg.str() );
 		}
@@ -208,17 +188,13 @@ void IncrementalFMU::defineRealOutputs( const fmippString outputs[], const fmipp
 
 void IncrementalFMU::defineIntegerOutputs( const fmippString outputs[], const fmippSize nOutputs )
 {
-	if ( 0 != integerOutputRefs_ ) delete integerOutputRefs_;
+	outputs_.define( *fmu_, fmippTypeInteger, outputs, nOutputs );
 
-	nIntegerOutputs_ = nOutputs;
-	integerOutputRefs_ = new fmiValueReference[nOutputs];
-	for ( fmippSize i = 0; i < nOutputs; ++i ) {
-		integerOutputRefs_[i] = fmu_->getValueRef( outputs[i] );
-
-		if ( fmippTrue == loggingOn_ )
-		{
+	if ( fmippTrue == loggingOn_ )
+	{
+		for ( size_t i = 0; i < nOutputs; ++i ) {
 			stringstream msg;
-			msg << "add " << outputs[i] << " (" << integerOutputRefs_[i] << ") "
+			msg << "add " << outputs[i] << " (" << outputs_.getValueRef( fmippTypeInteger, i ) << ") "
 			    << "to integer output variables";
 			fmu_->sendDebugMessage( msg.str() );
 		}
@@ -227,17 +203,13 @@ void IncrementalFMU::defineIntegerOutputs( const fmippString outputs[], const fm
 
 void IncrementalFMU::defineBooleanOutputs( const fmippString outputs[], const fmippSize nOutputs )
 {
-	if ( 0 != booleanOutputRefs_ ) delete booleanOutputRefs_;
+	outputs_.define( *fmu_, fmippTypeBoolean, outputs, nOutputs );
 
-	nBooleanOutputs_ = nOutputs;
-	booleanOutputRefs_ = new fmiValueReference[nOutputs];
-	for ( fmippSize i = 0; i < nOutputs; ++i ) {
-		booleanOutputRefs_[i] = fmu_->getValueRef( outputs[i] );
-
-		if ( fmippTrue == loggingOn_ )
-		{
+	if ( fmippTrue == loggingOn_ )
+	{
+		for ( size_t i = 0; i < nOutputs; ++i ) {
 			stringstream msg;
-			msg << "add " << outputs[i] << " (" << booleanOutputRefs_[i] << ") "
+			msg << "add " << outputs[i] << " (" << outputs_.getValueRef( fmippTypeBoolean, i ) << ") "
 			    << "to boolean output variables";
 			fmu_->sendDebugMessage( msg.str() );
 		}
@@ -246,17 +218,13 @@ void IncrementalFMU::defineBooleanOutputs( const fmippString outputs[], const fm
 
 void IncrementalFMU::defineStringOutputs( const fmippString outputs[], const fmippSize nOutputs )
 {
-	if ( 0 != stringOutputRefs_ ) delete stringOutputRefs_;
-
-	nStringOutputs_ = nOutputs;
-	stringOutputRefs_ = new fmiValueReference[nOutputs];
-	for ( fmippSize i = 0; i < nOutputs; ++i ) {
-		stringOutputRefs_[i] = fmu_->getValueRef( outputs[i] );
+	outputs_.define( *fmu_, fmippTypeString, outputs, nOutputs );
 
-		if ( fmippTrue == loggingOn_ )
-		{
+	if ( fmippTrue == loggingOn_ )
+	{
+		for ( size_t i = 0; i < nOutputs; ++i ) {
 			stringstream msg;
-			msg << "add " << outputs[i] << " (" << stringOutputRefs_[i] << ") "
+			msg << "add " << outputs[i] << " (" << outputs_.getValueRef( fmippTypeString, i ) << ") "
 			    << "to fmippString output variables";
 			fmu_->sendDebugMessage( msg.str() );
 		}
@@ -322,30 +290,22 @@ void IncrementalFMU::getContinuousStates( fmippReal* state ) const
 
 void IncrementalFMU::getOutputs( fmippReal* outputs ) const
 {
-	for ( fmippSize i = 0; i < nRealOutputs_; ++i ) {
-		fmu_->getValue( realOutputRefs_[i], outputs[i] );
-	}
+	outputs_.getValues( *fmu_, outputs );
 }
 
 void IncrementalFMU::getOutputs( fmippInteger* outputs ) const
 {
-	for ( fmippSize i = 0; i < nIntegerOutputs_; ++i ) {
-		fmu_->getValue( integerOutputRefs_[i], outputs[i] );
-	}
+	outputs_.getValues( *fmu_, outputs );
 }
 
 void IncrementalFMU::getOutputs( fmippBoolean* outputs ) const
 {
-	for ( fmippSize i = 0; i < nBooleanOutputs_; ++i ) {
-		fmu_->getValue( booleanOutputRefs_[i], outputs[i] );
-	}
+	outputs_.getValues( *fmu_, outputs );
 }
 
 void IncrementalFMU::getOutputs( fmippString* outputs ) const
 {
-	for ( fmippSize i = 0; i < nStringOutputs_; ++i ) {
-		fmu_->getValue( stringOutputRefs_[i], outputs[i] );
-	}
+	outputs_.getValues( *fmu_, outputs );
 }
 
 int IncrementalFMU::init( const fmippString& instanceName,
@@ -391,7 +351,7 @@ int IncrementalFMU::init( const fmippString& instanceName,
 	// cases we have to raise an event (and iterate over fmiEventUpdate) until the
 	// FMU has found a solution ...
 
-	HistoryEntry init( startTime, fmu_->nStates(), nRealOutputs_, nIntegerOutputs_, nBooleanOutputs_, nStringOutputs_ );
+	HistoryEntry init( startTime, fmu_->nStates(), outputs_.size( fmippTypeReal ), outputs_.size( fmippTypeInteger ), outputs_.size( fmippTypeBoolean ), outputs_.size( fmippTypeString ) );
 	getContinuousStates( init.state_ );
 	getOutputs( init.realValues_ );
 	getOutputs( init.integerValues_ );
@@ -430,7 +390,7 @@ void IncrementalFMU::interpolateState( fmippTime t,
 		result.state_[i] = interpolateValue( t, left.time_, left.state_[i], right.time_, right.state_[i] );
 	}
 
-	for ( fmippSize i = 0; i < nRealOutputs_; ++i ) {
+	for ( fmippSize i = 0; i < outputs_.size( fmippTypeReal ); ++i ) {
 		result.realValues_[i] = interpolateValue( t, left.time_, left.realValues_[i], right.time_, right.realValues_[i] );
 	}
 
@@ -679,31 +639,20 @@ IncrementalFMU::getModelDescription() const
 void IncrementalFMU::retrieveFMUState( fmippReal* result, fmippReal* realValues, fmippInteger* integerValues, fmippBoolean* booleanValues, fmippString* stringValues ) const
 {
 	fmu_->getContinuousStates(result);
-	for ( fmippSize i = 0; i < nRealOutputs_; ++i ) {
-		fmu_->getValue(realOutputRefs_[i], realValues[i]);
-	}
-	for ( fmippSize i = 0; i < nIntegerOutputs_; ++i ) {
-		fmu_->getValue(integerOutputRefs_[i], integerValues[i]);
-	}
-	for ( fmippSize i = 0; i < nBooleanOutputs_; ++i ) {
-		fmu_->getValue(booleanOutputRefs_[i], booleanValues[i]);
-	}
-	for ( fmippSize i = 0; i < nStringOutputs_; ++i ) {
-		fmu_->getValue(stringOutputRefs_[i], stringValues[i]);
-	}
+	outputs_.getValues( *fmu_, realValues );
+	outputs_.getValues( *fmu_, integerValues );
+	outputs_.getValues( *fmu_, booleanValues );
+	outputs_.getValues( *fmu_, stringValues );
 }
 
 fmippStatus IncrementalFMU::setInputs(fmippReal* inputs) const {
+	fmippStatus status = ( fmippOK == inputs_.setValues( *fmu_, inputs ) ) ? fmippOK : fmippError;
 
-	fmippStatus status = fmippOK;
-
-	for ( fmippSize i = 0; i < nRealInputs_; ++i ) {
-		if ( fmippOK != fmu_->setValue(realInputRefs_[i], inputs[i]) ) status = fmippError;
-
-		if ( fmippTrue == loggingOn_ )
-		{
+	if ( fmippTrue == loggingOn_ )
+	{
+		for ( size_t i = 0; i < inputs_.size( fmippTypeReal ); ++i ) {
 			stringstream msg;
-			msg << "set real input " << realInputRefs_[i] << " = " << inputs[i];
+			msg << "set real input " << inputs_.getValueRef( fmippTypeReal, i ) << " = " << inputs[i];
 			fmu_->sendDebugMessage( msg.str() );
 		}
 	}
@@ -712,16 +661,13 @@ fmippStatus IncrementalFMU::setInputs(fmippReal* inputs) const {
 }
 
 fmippStatus IncrementalFMU::setInputs(fmippInteger* inputs) const {
+	fmippStatus status = ( fmippOK == inputs_.setValues( *fmu_, inputs ) ) ? fmippOK : fmippError;
 
-	fmippStatus status = fmippOK;
-
-	for ( fmippSize i = 0; i < nIntegerInputs_; ++i ) {
-		if ( fmippOK != fmu_->setValue(integerInputRefs_[i], inputs[i]) ) status = fmippError;
-
-		if ( fmippTrue == loggingOn_ )
-		{
+	if ( fmippTrue == loggingOn_ )
+	{
+		for ( size_t i = 0; i < inputs_.size( fmippTypeInteger ); ++i ) {
 			stringstream msg;
-			msg << "set integer input " << integerInputRefs_[i] << " = " << inputs[i];
+			msg << "set integer input " << inputs_.getValueRef( fmippTypeInteger, i ) << " = " << inputs[i];
 			fmu_->sendDebugMessage( msg.str() );
 		}
 	}
@@ -730,16 +676,13 @@ fmippStatus IncrementalFMU::setInputs(fmippInteger* inputs) const {
 }
 
 fmippStatus IncrementalFMU::setInputs(fmippBoolean* inputs) const {
+	fmippStatus status = ( fmippOK == inputs_.setValues( *fmu_, inputs ) ) ? fmippOK : fmippError;
 
-	fmippStatus status = fmippOK;
-
-	for ( fmippSize i = 0; i < nBooleanInputs_; ++i ) {
-		if ( fmippOK != fmu_->setValue(booleanInputRefs_[i], inputs[i]) ) status = fmippError;
-
-		if ( fmippTrue == loggingOn_ )
-		{
+	if ( fmippTrue == loggingOn_ )
+	{
+		for ( size_t i = 0; i < inputs_.size( fmippTypeBoolean ); ++i ) {
 			stringstream msg;
-			msg << "set boolean input " << booleanInputRefs_[i] << " = " << inputs[i];
+			msg << "set boolean input " << inputs_.getValueRef( fmippTypeBoolean, i ) << " = " << inputs[i];
 			fmu_->sendDebugMessage( msg.str() );
 		}
 	}
@@ -748,16 +691,13 @@ fmippStatus IncrementalFMU::setInputs(fmippBoolean* inputs) const {
 }
 
 fmippStatus IncrementalFMU::setInputs(fmippString* inputs) const {
+	fmippStatus status = ( fmippOK == inputs_.setValues( *fmu_, inputs ) ) ? fmippOK : fmippError;
 
-	fmippStatus status = fmippOK;
-
-	for ( fmippSize i = 0; i < nStringInputs_; ++i ) {
-		if ( fmippOK != fmu_->setValue(stringInputRefs_[i], inputs[i]) ) status = fmippError;
-
-		if ( fmippTrue == loggingOn_ )
-		{
+	if ( fmippTrue == loggingOn_ )
+	{
+		for ( size_t i = 0; i < inputs_.size( fmippTypeString ); ++i ) {
 			stringstream msg;
-			msg << "set fmippString input " << stringInputRefs_[i] << " = " << inputs[i];
+			msg << "set fmippString input " << inputs_.getValueRef( fmippTypeString, i ) << " = " << inputs[i];
 			fmu_->sendDebugMessage( msg.str() );
 		}
 	}
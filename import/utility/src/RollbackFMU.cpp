@@ -15,6 +15,7 @@
 #include <stdarg.h>
 #include <cassert>
 #include <limits>
+#include <utility>
 
 #include "import/base/include/ModelDescription.h"
 #include "import/base/include/ModelManager.h"
@@ -30,7 +31,9 @@ RollbackFMU::RollbackFMU( const fmippString& fmuDirUri,
 		const IntegratorType integratorType ) :
 	fmu_( 0 ),
 	rollbackState_(),
-	rollbackStateSaved_( false )
+	rollbackStateSaved_( false ),
+	checkpointsEnabled_( fmippFalse ),
+	checkpointsCompressed_( fmippFalse )
 {
 	// Load the FMU.
 	FMUType fmuType = invalid;
@@ -64,6 +67,8 @@ fmippReal RollbackFMU::integrate( fmippReal tstop, unsigned int nsteps )
 
 	if ( tstop < now ) { // Make a rollback.
 		if ( fmippOK != rollback( tstop ) ) return now;
+	} else if ( checkpointsEnabled_ ) { // Store the current state as checkpoint.
+		if ( false == hasCheckpoint( now ) ) saveCheckpoint( fmippFalse );
 	} else if ( false == rollbackStateSaved_ ) { // Retrieve current state and store it as rollback state.
 		rollbackState_.time_ = now;
 		if ( 0 != fmu_->nStates() ) fmu_->getContinuousStates( rollbackState_.state_ );
@@ -81,6 +86,8 @@ fmippReal RollbackFMU::integrate( fmippReal tstop, fmippTime deltaT )
 
 	if ( tstop < now ) { // Make a rollback.
 		if ( fmippOK != rollback( tstop ) ) return now;
+	} else if ( checkpointsEnabled_ ) { // Store the current state as checkpoint.
+		if ( false == hasCheckpoint( now ) ) saveCheckpoint( fmippFalse );
 	} else if ( false == rollbackStateSaved_ ) { // Retrieve current state and store it as rollback state.
 		rollbackState_.time_ = now;
 		if ( 0 != fmu_->nStates() ) fmu_->getContinuousStates( rollbackState_.state_ );
@@ -95,7 +102,10 @@ fmippReal RollbackFMU::integrate( fmippReal tstop, fmippTime deltaT )
     "releaseRollbackState()" is called; **/
 void RollbackFMU::saveCurrentStateForRollback()
 {
-	if ( false == rollbackStateSaved_ ) {
+	if ( checkpointsEnabled_ ) {
+		if ( false == rollbackStateSaved_ ) saveCheckpoint( fmippTrue );
+		rollbackStateSaved_ = true;
+	} else if ( false == rollbackStateSaved_ ) {
 		rollbackState_.time_ = fmu_->getTime();
 		if ( 0 != fmu_->nStates() )
 			fmu_->getContinuousStates( rollbackState_.state_ );
@@ -109,10 +119,108 @@ void RollbackFMU::saveCurrentStateForRollback()
 void RollbackFMU::releaseRollbackState()
 {
 	rollbackStateSaved_ = false;
+	checkpoints_.unpinAll();
+	compressedCheckpoints_.unpinAll();
+}
+
+fmippStatus RollbackFMU::enableCheckpoints( fmippSize maxCheckpoints, fmippSize maxMemory )
+{
+	if ( ( 0 == fmu_ ) || ( false == fmu_->canGetAndSetFMUstate() ) ) return fmippWarning;
+
+	compressedCheckpoints_.clear();
+	checkpoints_.setLimits( maxCheckpoints, maxMemory );
+	checkpointsEnabled_ = fmippTrue;
+	checkpointsCompressed_ = fmippFalse;
+	rollbackStateSaved_ = false;
+
+	return fmippOK;
+}
+
+fmippStatus RollbackFMU::enableCompressedCheckpoints( fmippSize keyframeInterval, fmippSize maxMemory,
+	const fmippString& spillFile )
+{
+	if ( ( 0 == fmu_ ) || ( false == fmu_->canSerializeFMUstate() ) ) return fmippWarning;
+
+	checkpoints_.clear();
+	compressedCheckpoints_.clear();
+	compressedCheckpoints_.setKeyframeInterval( keyframeInterval );
+	compressedCheckpoints_.setMemoryLimit( maxMemory );
+	if ( fmippOK != compressedCheckpoints_.setSpillFile( spillFile ) ) return fmippError;
+
+	checkpointsEnabled_ = fmippTrue;
+	checkpointsCompressed_ = fmippTrue;
+	rollbackStateSaved_ = false;
+
+	return fmippOK;
+}
+
+void RollbackFMU::disableCheckpoints()
+{
+	checkpoints_.clear();
+	compressedCheckpoints_.clear();
+	snapshot_.reset();
+	checkpointsEnabled_ = fmippFalse;
+	checkpointsCompressed_ = fmippFalse;
+	rollbackStateSaved_ = false;
+}
+
+void RollbackFMU::saveCheckpoint( fmippBoolean pinned )
+{
+	if ( checkpointsCompressed_ ) {
+		fmippStatus status = fmu_->getSnapshot( snapshot_ );
+		if ( ( fmippOK != status ) && ( fmippWarning != status ) ) return;
+
+		if ( fmippOK != fmu_->serializeSnapshot( snapshot_, serializedState_ ) ) return;
+
+		compressedCheckpoints_.insert( snapshot_.getTime(), serializedState_, pinned );
+		return;
+	}
+
+	// Reuse the memory of an evicted checkpoint.
+	FMUSnapshot snapshot = checkpoints_.takeSpare();
+
+	fmippStatus status = fmu_->getSnapshot( snapshot );
+	if ( ( fmippOK != status ) && ( fmippWarning != status ) ) return;
+
+	// The memory is only known for FMUs that can serialize their state.
+	fmippSize memory = 0;
+	if ( fmu_->canSerializeFMUstate() && ( fmippOK != fmu_->getSnapshotSize( snapshot, memory ) ) ) memory = 0;
+
+	checkpoints_.insert( move( snapshot ), memory, pinned );
+}
+
+fmippBoolean RollbackFMU::hasCheckpoint( fmippTime time ) const
+{
+	return checkpointsCompressed_ ? compressedCheckpoints_.contains( time ) : checkpoints_.contains( time );
 }
 
 fmippStatus RollbackFMU::rollback( fmippTime time )
 {
+	if ( checkpointsCompressed_ ) {
+		fmippTime checkpointTime;
+		if ( false == compressedCheckpoints_.find( time, checkpointTime, serializedState_ ) ) return fmippFatal;
+
+		// Later checkpoints belong to the discarded future.
+		compressedCheckpoints_.eraseAfter( checkpointTime );
+
+		fmippStatus status = fmu_->deserializeSnapshot( serializedState_, snapshot_ );
+		if ( ( fmippOK != status ) && ( fmippWarning != status ) ) return status;
+
+		status = fmu_->setSnapshot( snapshot_ );
+		return ( fmippWarning == status ) ? fmippOK : status;
+	}
+
+	if ( checkpointsEnabled_ ) {
+		const FMUSnapshot* checkpoint = checkpoints_.find( time );
+		if ( 0 == checkpoint ) return fmippFatal;
+
+		// Later checkpoints belong to the discarded future.
+		checkpoints_.eraseAfter( checkpoint->getTime() );
+
+		fmippStatus status = fmu_->setSnapshot( *checkpoint );
+		return ( fmippWarning == status ) ? fmippOK : status;
+	}
+
 	if ( time < rollbackState_.time_ ) {
 		return fmippFatal;
 	}
@@ -239,3 +347,16 @@ fmippStatus RollbackFMU::getLastStatus() const
 	if ( 0 == fmu_ ) return fmippFatal;
 	return fmu_->getLastStatus();
 }
+
+
+IntegratorStatistics RollbackFMU::getIntegratorStatistics() const
+{
+	if ( 0 == fmu_ ) return IntegratorStatistics();
+	return fmu_->getIntegratorStatistics();
+}
+
+
+void RollbackFMU::resetIntegratorStatistics()
+{
+	if ( 0 != fmu_ ) fmu_->resetIntegratorStatistics();
+}
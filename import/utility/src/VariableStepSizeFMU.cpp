@@ -26,10 +26,7 @@ VariableStepSizeFMU::VariableStepSizeFMU( const fmippString& fmuDirUri,
 	currentCommunicationPoint_( numeric_limits<fmippTime>::quiet_NaN() ),
 	finalCommunicationPoint_( numeric_limits<fmippTime>::quiet_NaN() ),
 	defaultCommunicationStepSize_( numeric_limits<fmippTime>::quiet_NaN() ), fmu_( 0 ),
-	realInputRefs_( 0 ), integerInputRefs_( 0 ), booleanInputRefs_( 0 ), stringInputRefs_( 0 ),
-	nRealInputs_( 0 ), nIntegerInputs_( 0 ), nBooleanInputs_( 0 ), nStringInputs_( 0 ),
-	realOutputRefs_( 0 ), integerOutputRefs_( 0 ), booleanOutputRefs_( 0 ), stringOutputRefs_( 0 ),
-	nRealOutputs_( 0 ), nIntegerOutputs_( 0 ), nBooleanOutputs_( 0 ), nStringOutputs_( 0 ),
+	inputs_( "inputs" ), outputs_( "outputs" ),
 	loggingOn_( loggingOn ), timeDiffResolution_( timeDiffResolution )
 {
 	// Load the FMU.
@@ -54,31 +51,17 @@ VariableStepSizeFMU::VariableStepSizeFMU( const fmippString& fmuDirUri,
 VariableStepSizeFMU::~VariableStepSizeFMU()
 {
 	if ( 0 != fmu_ ) delete fmu_;
-
-	if ( realInputRefs_ ) delete realInputRefs_;
-	if ( integerInputRefs_ ) delete integerInputRefs_;
-	if ( booleanInputRefs_ ) delete booleanInputRefs_;
-	if ( stringInputRefs_ ) delete stringInputRefs_;
-
-	if ( realOutputRefs_ ) delete realOutputRefs_;
-	if ( integerOutputRefs_ ) delete integerOutputRefs_;
-	if ( booleanOutputRefs_ ) delete booleanOutputRefs_;
-	if ( stringOutputRefs_ ) delete stringOutputRefs_;
 }
 
 void VariableStepSizeFMU::defineRealInputs( const fmippString inputs[], const fmippSize nInputs )
 {
-	if ( 0 != realInputRefs_ ) delete realInputRefs_;
-
-	nRealInputs_ = nInputs;
-	realInputRefs_ = new fmiValueReference[nInputs];
-	for ( fmippSize i = 0; i < nInputs; ++i ) {
-		realInputRefs_[i] = fmu_->getValueRef( inputs[i] );
+	inputs_.define( *fmu_, fmippTypeReal, inputs, nInputs );
 
-		if ( fmippTrue == loggingOn_ )
-		{
+	if ( fmippTrue == loggingOn_ )
+	{
+		for ( size_t i = 0; i < nInputs; ++i ) {
 			stringstream msg;
-			msg << "add " << inputs[i] << " (" << realInputRefs_[i] << ") "
+			msg << "add " << inputs[i] << " (" << inputs_.getValueRef( fmippTypeReal, i ) << ") "
 			    << "to real input variables";
 			fmu_->sendDebugMessage( msg.str() );
 		}
@@ -87,17 +70,13 @@ void VariableStepSizeFMU::defineRealInputs( const fmippString inputs[], const fm
 
 void VariableStepSizeFMU::defineIntegerInputs( const fmippString inputs[], const fmippSize nInputs )
 {
-	if ( 0 != integerInputRefs_ ) delete integerInputRefs_;
+	inputs_.define( *fmu_, fmippTypeInteger, inputs, nInputs );
 
-	nIntegerInputs_ = nInputs;
-	integerInputRefs_ = new fmiValueReference[nInputs];
-	for ( fmippSize i = 0; i < nInputs; ++i ) {
-		integerInputRefs_[i] = fmu_->getValueRef( inputs[i] );
-
-		if ( fmippTrue == loggingOn_ )
-		{
+	if ( fmippTrue == loggingOn_ )
+	{
+		for ( size_t i = 0; i < nInputs; ++i ) {
 			stringstream msg;
-			msg << "add " << inputs[i] << " (" << integerInputRefs_[i] << ") "
+			msg << "add " << inputs[i] << " (" << inputs_.getValueRef( fmippTypeInteger, i ) << ") "
 			    << "to integer input variables";
 			fmu_->sendDebugMessage( msg.str() );
 		}
@@ -106,17 +85,13 @@ void VariableStepSizeFMU::defineIntegerInputs( const fmippString inputs[], const
 
 void VariableStepSizeFMU::defineBooleanInputs( const fmippString inputs[], const fmippSize nInputs )
 {
-	if ( 0 != booleanInputRefs_ ) delete booleanInputRefs_;
+	inputs_.define( *fmu_, fmippTypeBoolean, inputs, nInputs );
 
-	nBooleanInputs_ = nInputs;
-	booleanInputRefs_ = new fmiValueReference[nInputs];
-	for ( fmippSize i = 0; i < nInputs; ++i ) {
-		booleanInputRefs_[i] = fmu_->getValueRef( inputs[i] );
-
-		if ( fmippTrue == loggingOn_ )
-		{
+	if ( fmippTrue == loggingOn_ )
+	{
+		for ( size_t i = 0; i < nInputs; ++i ) {
 			stringstream msg;
-			msg << "add " << inputs[i] << " (" << booleanInputRefs_[i] << ") "
+			msg << "add " << inputs[i] << " (" << inputs_.getValueRef( fmippTypeBoolean, i ) << ") "
 			    << "to boolean input variables";
 			fmu_->sendDebugMessage( msg.str() );
 		}
@@ -125,17 +100,13 @@ void VariableStepSizeFMU::defineBooleanInputs( const fmippString inputs[], const
 
 void VariableStepSizeFMU::defineStringInputs( const fmippString inputs[], const fmippSize nInputs )
 {
-	if ( 0 != stringInputRefs_ ) delete stringInputRefs_;
-
-	nStringInputs_ = nInputs;
-	stringInputRefs_ = new fmiValueReference[nInputs];
-	for ( fmippSize i = 0; i < nInputs; ++i ) {
-		stringInputRefs_[i] = fmu_->getValueRef( inputs[i] );
+	inputs_.define( *fmu_, fmippTypeString, inputs, nInputs );
 
-		if ( fmippTrue == loggingOn_ )
-		{
+	if ( fmippTrue == loggingOn_ )
+	{
+		for ( size_t i = 0; i < nInputs; ++i ) {
 			stringstream msg;
-			msg << "add " << inputs[i] << " (" << stringInputRefs_[i] << ") "
+			msg << "add " << inputs[i] << " (" << inputs_.getValueRef( fmippTypeString, i ) << ") "
 			    << "to fmippString input variables";
 			fmu_->sendDebugMessage( msg.str() );
 		}
@@ -144,17 +115,13 @@ void VariableStepSizeFMU::defineStringInputs( const fmippString inputs[], const
 
 void VariableStepSizeFMU::defineRealOutputs( const fmippString outputs[], const fmippSize nOutputs )
 {
-	if ( 0 != realOutputRefs_ ) delete realOutputRefs_;
-
-	nRealOutputs_ = nOutputs;
-	realOutputRefs_ = new fmiValueReference[nOutputs];
-	for ( fmippSize i = 0; i < nOutputs; ++i ) {
-		realOutputRefs_[i] = fmu_->getValueRef( outputs[i] );
+	outputs_.define( *fmu_, fmippTypeReal, outputs, nOutputs );
 
-		if ( fmippTrue == loggingOn_ )
-		{
+	if ( fmippTrue == loggingOn_ )
+	{
+		for ( size_t i = 0; i < nOutputs; ++i ) {
 			stringstream msg;
-			msg << "add " << outputs[i] << " (" << realOutputRefs_[i] << ") "
+			msg << "add " << outputs[i] << " (" << outputs_.getValueRef( fmippTypeReal, i ) << ") "
 			    << "to real output variables";
 			fmu_->sendDebugMessage( msg.str() );
 		}
@@ -163,17 +130,13 @@ void VariableStepSizeFMU::defineRealOutputs( const fmippString outputs[], const
 
 void VariableStepSizeFMU::defineIntegerOutputs( const fmippString outputs[], const fmippSize nOutputs )
 {
-	if ( 0 != integerOutputRefs_ ) delete integerOutputRefs_;
+	outputs_.define( *fmu_, fmippTypeInteger, outputs, nOutputs );
 
-	nIntegerOutputs_ = nOutputs;
-	integerOutputRefs_ = new fmiValueReference[nOutputs];
-	for ( fmippSize i = 0; i < nOutputs; ++i ) {
-		integerOutputRefs_[i] = fmu_->getValueRef( outputs[i] );
-
-		if ( fmippTrue == loggingOn_ )
-		{
+	if ( fmippTrue == loggingOn_ )
+	{
+		for ( size_t i = 0; i < nOutputs; ++i ) {
 			stringstream msg;
-			msg << "add " << outputs[i] << " (" << integerOutputRefs_[i] << ") "
+			msg << "add " << outputs[i] << " (" << outputs_.getValueRef( fmippTypeInteger, i ) << ") "
 			    << "to integer output variables";
 			fmu_->sendDebugMessage( msg.str() );
 		}
@@ -182,17 +145,13 @@ void VariableStepSizeFMU::defineIntegerOutputs( const fmippString outputs[], con
 
 void VariableStepSizeFMU::defineBooleanOutputs( const fmippString outputs[], const fmippSize nOutputs )
 {
-	if ( 0 != booleanOutputRefs_ ) delete booleanOutputRefs_;
-
-	nBooleanOutputs_ = nOutputs;
-	booleanOutputRefs_ = new fmiValueReference[nOutputs];
-	for ( fmippSize i = 0; i < nOutputs; ++i ) {
-		booleanOutputRefs_[i] = fmu_->getValueRef( outputs[i] );
+	outputs_.define( *fmu_, fmippTypeBoolean, outputs, nOutputs );
 
-		if ( fmippTrue == loggingOn_ )
-		{
+	if ( fmippTrue == loggingOn_ )
+	{
+		for ( size_t i = 0; i < nOutputs; ++i ) {
 			stringstream msg;
-			msg << "add " << outputs[i] << " (" << booleanOutputRefs_[i] << ") "
+			msg << "add " << outputs[i] << " (" << outputs_.getValueRef( fmippTypeBoolean, i ) << ") "
 			    << "to boolean output variables";
 			fmu_->sendDebugMessage( msg.str() );
 		}
@@ -201,17 +160,13 @@ void VariableStepSizeFMU::defineBooleanOutputs( const fmippString outputs[], con
 
 void VariableStepSizeFMU::defineStringOutputs( const fmippString outputs[], const fmippSize nOutputs )
 {
-	if ( 0 != stringOutputRefs_ ) delete stringOutputRefs_;
-
-	nStringOutputs_ = nOutputs;
-	stringOutputRefs_ = new fmiValueReference[nOutputs];
-	for ( fmippSize i = 0; i < nOutputs; ++i ) {
-		stringOutputRefs_[i] = fmu_->getValueRef( outputs[i] );
+	outputs_.define( *fmu_, fmippTypeString, outputs, nOutputs );
 
-		if ( fmippTrue == loggingOn_ )
-		{
+	if ( fmippTrue == loggingOn_ )
+	{
+		for ( size_t i = 0; i < nOutputs; ++i ) {
 			stringstream msg;
-			msg << "add " << outputs[i] << " (" << stringOutputRefs_[i] << ") "
+			msg << "add " << outputs[i] << " (" << outputs_.getValueRef( fmippTypeString, i ) << ") "
 			    << "to fmippString output variables";
 			fmu_->sendDebugMessage( msg.str() );
 		}
@@ -247,30 +202,22 @@ void VariableStepSizeFMU::setInitialInputs( const fmippString realVariableNames[
 
 void VariableStepSizeFMU::getOutputs( fmippReal* outputs ) const
 {
-	for ( fmippSize i = 0; i < nRealOutputs_; ++i ) {
-		fmu_->getValue( realOutputRefs_[i], outputs[i] );
-	}
+	outputs_.getValues( *fmu_, outputs );
 }
 
 void VariableStepSizeFMU::getOutputs( fmippInteger* outputs ) const
 {
-	for ( fmippSize i = 0; i < nIntegerOutputs_; ++i ) {
-		fmu_->getValue( integerOutputRefs_[i], outputs[i] );
-	}
+	outputs_.getValues( *fmu_, outputs );
 }
 
 void VariableStepSizeFMU::getOutputs( fmippBoolean* outputs ) const
 {
-	for ( fmippSize i = 0; i < nBooleanOutputs_; ++i ) {
-		fmu_->getValue( booleanOutputRefs_[i], outputs[i] );
-	}
+	outputs_.getValues( *fmu_, outputs );
 }
 
 void VariableStepSizeFMU::getOutputs( fmippString* outputs ) const
 {
-	for ( fmippSize i = 0; i < nStringOutputs_; ++i ) {
-		fmu_->getValue( stringOutputRefs_[i], outputs[i] );
-	}
+	outputs_.getValues( *fmu_, outputs );
 }
 
 int VariableStepSizeFMU::init( const string& instanceName,
@@ -339,7 +286,7 @@ int VariableStepSizeFMU::init( const string& instanceName,
 	// Intialize FMU.
 	if ( fmu_->initialize( startTime, stopTimeDefined, stopTime ) != fmippOK ) return 0;
 
-	HistoryEntry initState( startTime, 0, nRealOutputs_, nIntegerOutputs_, nBooleanOutputs_, nStringOutputs_ );
+	HistoryEntry initState( startTime, 0, outputs_.size( fmippTypeReal ), outputs_.size( fmippTypeInteger ), outputs_.size( fmippTypeBoolean ), outputs_.size( fmippTypeString ) );
 
 	getOutputs( initState.realValues_ );
 	getOutputs( initState.integerValues_ );
@@ -468,15 +415,13 @@ fmippTime VariableStepSizeFMU::getNextSyncTime( const fmippTime& currentSyncTime
 
 fmippStatus VariableStepSizeFMU::setInputs( fmippReal* inputs ) const
 {
-	fmippStatus status = fmippOK;
+	fmippStatus status = ( fmippOK == inputs_.setValues( *fmu_, inputs ) ) ? fmippOK : fmippError;
 
-	for ( fmippSize i = 0; i < nRealInputs_; ++i ) {
-		if ( fmippOK != fmu_->setValue( realInputRefs_[i], inputs[i]) ) status = fmippError;
-
-		if ( fmippTrue == loggingOn_ )
-		{
+	if ( fmippTrue == loggingOn_ )
+	{
+		for ( size_t i = 0; i < inputs_.size( fmippTypeReal ); ++i ) {
 			stringstream msg;
-			msg << "set real input " << realInputRefs_[i] << " = " << inputs[i];
+			msg << "set real input " << inputs_.getValueRef( fmippTypeReal, i ) << " = " << inputs[i];
 			fmu_->sendDebugMessage( msg.str() );
 		}
 	}
@@ -486,16 +431,13 @@ fmippStatus VariableStepSizeFMU::setInputs( fmippReal* inputs ) const
 
 fmippStatus VariableStepSizeFMU::setInputs( fmippInteger* inputs ) const
 {
+	fmippStatus status = ( fmippOK == inputs_.setValues( *fmu_, inputs ) ) ? fmippOK : fmippError;
 
-	fmippStatus status = fmippOK;
-
-	for ( fmippSize i = 0; i < nIntegerInputs_; ++i ) {
-		if ( fmippOK != fmu_->setValue( integerInputRefs_[i], inputs[i]) ) status = fmippError;
-
-		if ( fmippTrue == loggingOn_ )
-		{
+	if ( fmippTrue == loggingOn_ )
+	{
+		for ( size_t i = 0; i < inputs_.size( fmippTypeInteger ); ++i ) {
 			stringstream msg;
-			msg << "set integer input " << integerInputRefs_[i] << " = " << inputs[i];
+			msg << "set integer input " << inputs_.getValueRef( fmippTypeInteger, i ) << " = " << inputs[i];
 			fmu_->sendDebugMessage( msg.str() );
 		}
 	}
@@ -505,16 +447,13 @@ fmippStatus VariableStepSizeFMU::setInputs( fmippInteger* inputs ) const
 
 fmippStatus VariableStepSizeFMU::setInputs( fmippBoolean* inputs ) const
 {
+	fmippStatus status = ( fmippOK == inputs_.setValues( *fmu_, inputs ) ) ? fmippOK : fmippError;
 
-	fmippStatus status = fmippOK;
-
-	for ( fmippSize i = 0; i < nBooleanInputs_; ++i ) {
-		if ( fmippOK != fmu_->setValue( booleanInputRefs_[i], inputs[i]) ) status = fmippError;
-
-		if ( fmippTrue == loggingOn_ )
-		{
+	if ( fmippTrue == loggingOn_ )
+	{
+		for ( size_t i = 0; i < inputs_.size( fmippTypeBoolean ); ++i ) {
 			stringstream msg;
-			msg << "set boolean input " << booleanInputRefs_[i] << " = " << inputs[i];
+			msg << "set boolean input " << inputs_.getValueRef( fmippTypeBoolean, i ) << " = " << inputs[i];
 			fmu_->sendDebugMessage( msg.str() );
 		}
 	}
@@ -524,16 +463,13 @@ fmippStatus VariableStepSizeFMU::setInputs( fmippBoolean* inputs ) const
 
 fmippStatus VariableStepSizeFMU::setInputs( fmippString* inputs ) const
 {
+	fmippStatus status = ( fmippOK == inputs_.setValues( *fmu_, inputs ) ) ? fmippOK : fmippError;
 
-	fmippStatus status = fmippOK;
-
-	for ( fmippSize i = 0; i < nStringInputs_; ++i ) {
-		if ( fmippOK != fmu_->setValue( stringInputRefs_[i], inputs[i]) ) status = fmippError;
-
-		if ( fmippTrue == loggingOn_ )
-		{
+	if ( fmippTrue == loggingOn_ )
+	{
+		for ( size_t i = 0; i < inputs_.size( fmippTypeString ); ++i ) {
 			stringstream msg;
-			msg << "set fmippString input " << stringInputRefs_[i] << " = " << inputs[i];
+			msg << "set fmippString input " << inputs_.getValueRef( fmippTypeString, i ) << " = " << inputs[i];
 			fmu_->sendDebugMessage( msg.str() );
 		}
 	}
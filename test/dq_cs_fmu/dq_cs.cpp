@@ -0,0 +1,223 @@
+// -------------------------------------------------------------------
+// Copyright (c) 2013-2022, AIT Austrian Institute of Technology GmbH.
+// All rights reserved. See file FMIPP_LICENSE for details.
+// -------------------------------------------------------------------
+
+// FMI CS 1.0 version of the Dahlquist test equation der(x) = - k * x, each
+// communication step is solved analytically: x(t+h) = x(t) * exp(-k*h).
+
+#define MODEL_IDENTIFIER dq_cs
+#include "export/functions/fmi_v1.0/fmiFunctions.h"
+
+#include <cmath>
+#include <cstring>
+
+#define x_ 0
+#define k_ 1
+
+struct fmustruct
+{
+	fmiReal time;
+	fmiReal rvar[2];
+};
+
+
+DllExport const char* fmiGetTypesPlatform()
+{
+	return fmiModelTypesPlatform;
+}
+
+
+DllExport const char* fmiGetVersion()
+{
+	return fmiVersion;
+}
+
+
+DllExport fmiComponent fmiInstantiateSlave( fmiString instanceName,
+					    fmiString fmuGUID,
+					    fmiString fmuLocation,
+					    fmiString mimeType,
+					    fmiReal timeout,
+					    fmiBoolean visible,
+					    fmiBoolean interactive,
+					    fmiCallbackFunctions functions,
+					    fmiBoolean loggingOn )
+{
+	if ( strcmp( fmuGUID, "{8c4e810f-3df3-4a00-8276-176fa3c9f001}" ) ) return 0;
+
+	fmustruct* fmu = new fmustruct;
+	fmu->time = 0;
+	fmu->rvar[x_] = 1;
+	fmu->rvar[k_] = 1;
+
+	return fmu;
+}
+
+
+DllExport fmiStatus fmiInitializeSlave( fmiComponent c, fmiReal tStart, fmiBoolean StopTimeDefined, fmiReal tStop )
+{
+	fmustruct* fmu = (fmustruct*) c;
+	fmu->time = tStart;
+
+	return fmiOK;
+}
+
+
+DllExport fmiStatus fmiTerminateSlave( fmiComponent c )
+{
+	return fmiOK;
+}
+
+
+DllExport fmiStatus fmiResetSlave( fmiComponent c )
+{
+	fmustruct* fmu = (fmustruct*) c;
+	fmu->time = 0;
+	fmu->rvar[x_] = 1;
+
+	return fmiOK;
+}
+
+
+DllExport void fmiFreeSlaveInstance( fmiComponent c )
+{
+	delete (fmustruct*) c;
+}
+
+
+DllExport fmiStatus fmiSetDebugLogging( fmiComponent c, fmiBoolean loggingOn )
+{
+	return fmiOK;
+}
+
+
+DllExport fmiStatus fmiSetReal( fmiComponent c, const fmiValueReference vr[], size_t nvr, const fmiReal value[] )
+{
+	fmustruct* fmu = (fmustruct*) c;
+	for ( size_t i = 0; i < nvr; ++i ) {
+		if ( vr[i] > k_ ) return fmiError;
+		fmu->rvar[vr[i]] = value[i];
+	}
+
+	return fmiOK;
+}
+
+
+DllExport fmiStatus fmiSetInteger( fmiComponent c, const fmiValueReference vr[], size_t nvr, const fmiInteger value[] )
+{
+	return ( 0 == nvr ) ? fmiOK : fmiError;
+}
+
+
+DllExport fmiStatus fmiSetBoolean( fmiComponent c, const fmiValueReference vr[], size_t nvr, const fmiBoolean value[] )
+{
+	return ( 0 == nvr ) ? fmiOK : fmiError;
+}
+
+
+DllExport fmiStatus fmiSetString( fmiComponent c, const fmiValueReference vr[], size_t nvr, const fmiString value[] )
+{
+	return ( 0 == nvr ) ? fmiOK : fmiError;
+}
+
+
+DllExport fmiStatus fmiGetReal( fmiComponent c, const fmiValueReference vr[], size_t nvr, fmiReal value[] )
+{
+	fmustruct* fmu = (fmustruct*) c;
+	for ( size_t i = 0; i < nvr; ++i ) {
+		if ( vr[i] > k_ ) return fmiError;
+		value[i] = fmu->rvar[vr[i]];
+	}
+
+	return fmiOK;
+}
+
+
+DllExport fmiStatus fmiGetInteger( fmiComponent c, const fmiValueReference vr[], size_t nvr, fmiInteger value[] )
+{
+	return ( 0 == nvr ) ? fmiOK : fmiError;
+}
+
+
+DllExport fmiStatus fmiGetBoolean( fmiComponent c, const fmiValueReference vr[], size_t nvr, fmiBoolean value[] )
+{
+	return ( 0 == nvr ) ? fmiOK : fmiError;
+}
+
+
+DllExport fmiStatus fmiGetString( fmiComponent c, const fmiValueReference vr[], size_t nvr, fmiString value[] )
+{
+	return ( 0 == nvr ) ? fmiOK : fmiError;
+}
+
+
+DllExport fmiStatus fmiSetRealInputDerivatives( fmiComponent c, const fmiValueReference vr[], size_t nvr,
+						const fmiInteger order[], const fmiReal value[] )
+{
+	return fmiError;
+}
+
+
+DllExport fmiStatus fmiGetRealOutputDerivatives( fmiComponent c, const fmiValueReference vr[], size_t nvr,
+						 const fmiInteger order[], fmiReal value[] )
+{
+	return fmiError;
+}
+
+
+DllExport fmiStatus fmiCancelStep( fmiComponent c )
+{
+	return fmiError;
+}
+
+
+DllExport fmiStatus fmiDoStep( fmiComponent c, fmiReal currentCommunicationPoint,
+			       fmiReal communicationStepSize, fmiBoolean newStep )
+{
+	fmustruct* fmu = (fmustruct*) c;
+	if ( ( communicationStepSize < 0 ) || ( std::fabs( currentCommunicationPoint - fmu->time ) > 1e-9 ) )
+		return fmiError;
+
+	fmu->rvar[x_] *= std::exp( -fmu->rvar[k_] * communicationStepSize );
+	fmu->time = currentCommunicationPoint + communicationStepSize;
+
+	return fmiOK;
+}
+
+
+DllExport fmiStatus fmiGetStatus( fmiComponent c, const fmiStatusKind s, fmiStatus* value )
+{
+	if ( fmiDoStepStatus != s ) return fmiDiscard;
+	*value = fmiOK;
+
+	return fmiOK;
+}
+
+
+DllExport fmiStatus fmiGetRealStatus( fmiComponent c, const fmiStatusKind s, fmiReal* value )
+{
+	fmustruct* fmu = (fmustruct*) c;
+	if ( fmiLastSuccessfulTime != s ) return fmiDiscard;
+	*value = fmu->time;
+
+	return fmiOK;
+}
+
+
+DllExport fmiStatus fmiGetIntegerStatus( fmiComponent c, const fmiStatusKind s, fmiInteger* value )
+{
+	return fmiDiscard;
+}
+
+
+DllExport fmiStatus fmiGetBooleanStatus( fmiComponent c, const fmiStatusKind s, fmiBoolean* value )
+{
+	return fmiDiscard;
+}
+
+
+DllExport fmiStatus fmiGetStringStatus( fmiComponent c, const fmiStatusKind s, fmiString* value )
+{
+	return fmiDiscard;
+}
@@ -570,24 +570,184 @@ fmi2Status fmi2SetString (fmi2Component c, const fmi2ValueReference vr[], size_t
     return fmi2OK;
 }
 
+// ---------------------------------------------------------------------------
+// Private helpers for the FMU state
+// An FMU state is stored in serialized form: its size, followed by the values
+// of all variables, the time, the mode and the event info of the instance.
+// ---------------------------------------------------------------------------
+
+static size_t serializedSize(ModelInstance *comp) {
+    size_t size = sizeof(size_t)
+        + NUMBER_OF_REALS * sizeof(fmi2Real)
+        + NUMBER_OF_INTEGERS * sizeof(fmi2Integer)
+        + NUMBER_OF_BOOLEANS * sizeof(fmi2Boolean)
+        + NUMBER_OF_EVENT_INDICATORS * sizeof(fmi2Boolean)
+        + sizeof(fmi2Real) + sizeof(ModelState) + sizeof(fmi2EventInfo);
+    unsigned int i;
+    for (i = 0; i < NUMBER_OF_STRINGS; i++) {
+        size += 1 + (comp->s[i] ? strlen(comp->s[i]) : 0);
+    }
+    return size;
+}
+
+static char *writeBytes(char *dest, const void *src, size_t n) {
+    if (n > 0) memcpy(dest, src, n);
+    return dest + n;
+}
+
+static const char *readBytes(const char *src, void *dest, size_t n) {
+    if (n > 0) memcpy(dest, src, n);
+    return src + n;
+}
+
+static void serializeInstance(ModelInstance *comp, char *data, size_t size) {
+    unsigned int i;
+    data = writeBytes(data, &size, sizeof(size_t));
+    data = writeBytes(data, comp->r, NUMBER_OF_REALS * sizeof(fmi2Real));
+    data = writeBytes(data, comp->i, NUMBER_OF_INTEGERS * sizeof(fmi2Integer));
+    data = writeBytes(data, comp->b, NUMBER_OF_BOOLEANS * sizeof(fmi2Boolean));
+    data = writeBytes(data, comp->isPositive, NUMBER_OF_EVENT_INDICATORS * sizeof(fmi2Boolean));
+    data = writeBytes(data, &comp->time, sizeof(fmi2Real));
+    data = writeBytes(data, &comp->state, sizeof(ModelState));
+    data = writeBytes(data, &comp->eventInfo, sizeof(fmi2EventInfo));
+    for (i = 0; i < NUMBER_OF_STRINGS; i++) {
+        data = writeBytes(data, comp->s[i] ? comp->s[i] : "", 1 + (comp->s[i] ? strlen(comp->s[i]) : 0));
+    }
+}
+
+static fmi2Status deserializeInstance(ModelInstance *comp, const char *f, const char *data, size_t size) {
+    size_t storedSize;
+    unsigned int i;
+    if (size < sizeof(size_t) || (readBytes(data, &storedSize, sizeof(size_t)), storedSize != size)) {
+        FILTERED_LOG(comp, fmi2Error, LOG_ERROR, "%s: Invalid FMU state.", f)
+        return fmi2Error;
+    }
+    data += sizeof(size_t);
+    data = readBytes(data, comp->r, NUMBER_OF_REALS * sizeof(fmi2Real));
+    data = readBytes(data, comp->i, NUMBER_OF_INTEGERS * sizeof(fmi2Integer));
+    data = readBytes(data, comp->b, NUMBER_OF_BOOLEANS * sizeof(fmi2Boolean));
+    data = readBytes(data, comp->isPositive, NUMBER_OF_EVENT_INDICATORS * sizeof(fmi2Boolean));
+    data = readBytes(data, &comp->time, sizeof(fmi2Real));
+    data = readBytes(data, &comp->state, sizeof(ModelState));
+    data = readBytes(data, &comp->eventInfo, sizeof(fmi2EventInfo));
+    for (i = 0; i < NUMBER_OF_STRINGS; i++) {
+        fmi2ValueReference vr = i;
+        fmi2String value = data;
+        ModelState state = comp->state;
+        data += 1 + strlen(data);
+        comp->state = modelInstantiated; // fmi2SetString is not allowed in every mode
+        if (fmi2OK != fmi2SetString(comp, &vr, 1, &value)) return fmi2Error;
+        comp->state = state;
+    }
+    comp->isDirtyValues = 1;
+    return fmi2OK;
+}
+
+// ---------------------------------------------------------------------------
+// FMI functions: FMU state
+// ---------------------------------------------------------------------------
+
 fmi2Status fmi2GetFMUstate (fmi2Component c, fmi2FMUstate* FMUstate) {
-    return unsupportedFunction(c, "fmi2GetFMUstate", MASK_fmi2GetFMUstate);
+    ModelInstance *comp = (ModelInstance *)c;
+    size_t size;
+    if (invalidState(comp, "fmi2GetFMUstate", MASK_fmi2GetFMUstate))
+        return fmi2Error;
+    if (nullPointer(comp, "fmi2GetFMUstate", "FMUstate", FMUstate))
+        return fmi2Error;
+    FILTERED_LOG(comp, fmi2OK, LOG_FMI_CALL, "fmi2GetFMUstate")
+
+    // reuse the memory of an existing state if it is large enough
+    size = serializedSize(comp);
+    if (*FMUstate && *(size_t *)*FMUstate < size) {
+        comp->functions->freeMemory(*FMUstate);
+        *FMUstate = NULL;
+    }
+    if (!*FMUstate) {
+        *FMUstate = comp->functions->allocateMemory(1, size);
+        if (!*FMUstate) {
+            FILTERED_LOG(comp, fmi2Error, LOG_ERROR, "fmi2GetFMUstate: Out of memory.")
+            return fmi2Error;
+        }
+    }
+    serializeInstance(comp, (char *)*FMUstate, size);
+    return fmi2OK;
 }
 fmi2Status fmi2SetFMUstate (fmi2Component c, fmi2FMUstate FMUstate) {
-    return unsupportedFunction(c, "fmi2SetFMUstate", MASK_fmi2SetFMUstate);
+    ModelInstance *comp = (ModelInstance *)c;
+    if (invalidState(comp, "fmi2SetFMUstate", MASK_fmi2SetFMUstate))
+        return fmi2Error;
+    if (nullPointer(comp, "fmi2SetFMUstate", "FMUstate", FMUstate))
+        return fmi2Error;
+    FILTERED_LOG(comp, fmi2OK, LOG_FMI_CALL, "fmi2SetFMUstate")
+
+    return deserializeInstance(comp, "fmi2SetFMUstate", (const char *)FMUstate, *(size_t *)FMUstate);
 }
 fmi2Status fmi2FreeFMUstate(fmi2Component c, fmi2FMUstate* FMUstate) {
-    return unsupportedFunction(c, "fmi2FreeFMUstate", MASK_fmi2FreeFMUstate);
+    ModelInstance *comp = (ModelInstance *)c;
+    if (invalidState(comp, "fmi2FreeFMUstate", MASK_fmi2FreeFMUstate))
+        return fmi2Error;
+    if (nullPointer(comp, "fmi2FreeFMUstate", "FMUstate", FMUstate))
+        return fmi2Error;
+    FILTERED_LOG(comp, fmi2OK, LOG_FMI_CALL, "fmi2FreeFMUstate")
+
+    if (*FMUstate) comp->functions->freeMemory(*FMUstate);
+    *FMUstate = NULL;
+    return fmi2OK;
 }
 fmi2Status fmi2SerializedFMUstateSize(fmi2Component c, fmi2FMUstate FMUstate, size_t *size) {
-    return unsupportedFunction(c, "fmi2SerializedFMUstateSize", MASK_fmi2SerializedFMUstateSize);
+    ModelInstance *comp = (ModelInstance *)c;
+    if (invalidState(comp, "fmi2SerializedFMUstateSize", MASK_fmi2SerializedFMUstateSize))
+        return fmi2Error;
+    if (nullPointer(comp, "fmi2SerializedFMUstateSize", "FMUstate", FMUstate))
+        return fmi2Error;
+    if (nullPointer(comp, "fmi2SerializedFMUstateSize", "size", size))
+        return fmi2Error;
+    FILTERED_LOG(comp, fmi2OK, LOG_FMI_CALL, "fmi2SerializedFMUstateSize")
+
+    *size = *(size_t *)FMUstate;
+    return fmi2OK;
 }
 fmi2Status fmi2SerializeFMUstate (fmi2Component c, fmi2FMUstate FMUstate, fmi2Byte serializedState[], size_t size) {
-    return unsupportedFunction(c, "fmi2SerializeFMUstate", MASK_fmi2SerializeFMUstate);
+    ModelInstance *comp = (ModelInstance *)c;
+    if (invalidState(comp, "fmi2SerializeFMUstate", MASK_fmi2SerializeFMUstate))
+        return fmi2Error;
+    if (nullPointer(comp, "fmi2SerializeFMUstate", "FMUstate", FMUstate))
+        return fmi2Error;
+    if (nullPointer(comp, "fmi2SerializeFMUstate", "serializedState", serializedState))
+        return fmi2Error;
+    FILTERED_LOG(comp, fmi2OK, LOG_FMI_CALL, "fmi2SerializeFMUstate")
+
+    if (size < *(size_t *)FMUstate) {
+        FILTERED_LOG(comp, fmi2Error, LOG_ERROR, "fmi2SerializeFMUstate: Buffer too small.")
+        return fmi2Error;
+    }
+    memcpy(serializedState, FMUstate, *(size_t *)FMUstate);
+    return fmi2OK;
 }
 fmi2Status fmi2DeSerializeFMUstate (fmi2Component c, const fmi2Byte serializedState[], size_t size,
                                     fmi2FMUstate* FMUstate) {
-    return unsupportedFunction(c, "fmi2DeSerializeFMUstate", MASK_fmi2DeSerializeFMUstate);
+    ModelInstance *comp = (ModelInstance *)c;
+    size_t storedSize;
+    if (invalidState(comp, "fmi2DeSerializeFMUstate", MASK_fmi2DeSerializeFMUstate))
+        return fmi2Error;
+    if (nullPointer(comp, "fmi2DeSerializeFMUstate", "serializedState", serializedState))
+        return fmi2Error;
+    if (nullPointer(comp, "fmi2DeSerializeFMUstate", "FMUstate", FMUstate))
+        return fmi2Error;
+    FILTERED_LOG(comp, fmi2OK, LOG_FMI_CALL, "fmi2DeSerializeFMUstate")
+
+    if (size < sizeof(size_t) || (memcpy(&storedSize, serializedState, sizeof(size_t)), storedSize != size)) {
+        FILTERED_LOG(comp, fmi2Error, LOG_ERROR, "fmi2DeSerializeFMUstate: Invalid FMU state.")
+        return fmi2Error;
+    }
+    if (*FMUstate) comp->functions->freeMemory(*FMUstate);
+    *FMUstate = comp->functions->allocateMemory(1, size);
+    if (!*FMUstate) {
+        FILTERED_LOG(comp, fmi2Error, LOG_ERROR, "fmi2DeSerializeFMUstate: Out of memory.")
+        return fmi2Error;
+    }
+    memcpy(*FMUstate, serializedState, size);
+    return fmi2OK;
 }
 
 fmi2Status fmi2GetDirectionalDerivative(fmi2Component c, const fmi2ValueReference vUnknown_ref[], size_t nUnknown,
@@ -643,11 +803,11 @@ fmi2Status fmi2DoStep(fmi2Component c, fmi2Real currentCommunicationPoint,
                     fmi2Real communicationStepSize, fmi2Boolean noSetFMUStatePriorToCurrentPoint) {
     ModelInstance *comp = (ModelInstance *)c;
     double h = communicationStepSize / 10;
+    unsigned int k;
+#if NUMBER_OF_REALS>0 || NUMBER_OF_EVENT_INDICATORS>0
     unsigned int i;
-    const unsigned int n = 10; // how many Euler steps to perform for one do step
-#if NUMBER_OF_REALS>0
-    double prevState[max(NUMBER_OF_STATES, 1)];
 #endif
+    const unsigned int n = 10; // how many Euler steps to perform for one do step
 #if NUMBER_OF_EVENT_INDICATORS>0
     double prevEventIndicators[max(NUMBER_OF_EVENT_INDICATORS, 1)];
 #endif
@@ -679,13 +839,10 @@ fmi2Status fmi2DoStep(fmi2Component c, fmi2Real currentCommunicationPoint,
 
     // break the step into n steps and do forward Euler.
     comp->time = currentCommunicationPoint;
-    for (i = 0; i < n; i++) {
+    for (k = 0; k < n; k++) { // separate counter, the loops below reuse i
         comp->time += h;
 
 #if NUMBER_OF_REALS>0
-        for (i = 0; i < NUMBER_OF_STATES; i++) {
-            prevState[i] = r(vrStates[i]);
-        }
         for (i = 0; i < NUMBER_OF_STATES; i++) {
             fmi2ValueReference vr = vrStates[i];
             r(vr) += h * getReal(comp, vr + 1); // forward Euler step
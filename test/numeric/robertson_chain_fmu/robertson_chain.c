@@ -0,0 +1,576 @@
+/**-------------------------------------------------------------------
+ * Copyright (c) 2013-2022, AIT Austrian Institute of Technology GmbH.
+ * All rights reserved. See file FMIPP_LICENSE for details.
+ * -------------------------------------------------------------------
+ *
+ * robertson_chain test-fmu for fmi++
+ *
+ * this fmu consists of N_CELLS cells of the robertson chemical reaction, which are coupled
+ * by diffusion. For k = 0, ..., N_CELLS - 1 it corresponds to the ODE
+ *
+ *   dot( x_k ) = -0.04 * x_k + 10^4 * y_k * z_k                        + D * L( x )_k
+ *   dot( y_k ) =  0.04 * x_k - 10^4 * y_k * z_k - 3 * 10^7 * y_k^2     + D * L( y )_k
+ *   dot( z_k ) =                                  3 * 10^7 * y_k^2     + D * L( z )_k
+ *
+ * where L( u )_k = u_{k-1} - 2 * u_k + u_{k+1} is the discrete Laplacian with homogeneous
+ * Neumann boundary conditions, with the initial conditions
+ *
+ *   x_k( 0 ) = 1 - 0.5 * k / ( N_CELLS - 1 ), y_k( 0 ) = 0, z_k( 0 ) = 0.5 * k / ( N_CELLS - 1 )
+ *
+ * The problem is stiff and its Jacobian is sparse ( block tridiagonal ). It is used to
+ * benchmark the sparse linear solvers of the implicit integrators.
+ *
+ **/
+
+#define MODEL_IDENTIFIER robertson_chain
+#include "fmi2ModelFunctions.h"
+
+#include <string.h>
+#include <stdio.h>
+#include <math.h>
+#include <stdlib.h>
+
+#define N_CELLS 50
+#define N_STATES ( 3 * N_CELLS )
+#define D 0.1
+
+// the value reference of state i is 2*i, the value reference of its derivative is 2*i+1.
+// the states of cell k are x_k = 3*k, y_k = 3*k+1 and z_k = 3*k+2.
+#define state_( i ) ( 2 * ( i ) )
+#define der_( i )   ( 2 * ( i ) + 1 )
+
+typedef struct ModelInstance
+{
+	fmi2String instanceName;
+	fmi2Real   time;
+	fmi2Real   rvar[2*N_STATES];
+	fmi2Type   type;
+	fmi2String GUID;
+	const fmi2CallbackFunctions *functions;
+	fmi2EventInfo eventInfo;
+	ModelState state;
+	fmi2ComponentEnvironment componentEnvironment;
+} ModelInstance;
+
+static void setInitialStates( ModelInstance* fmu )
+{
+	int k;
+	for ( k = 0; k < N_CELLS; k++ ){
+		fmu->rvar[state_( 3*k )]     = 1.0 - 0.5 * k / ( N_CELLS - 1 );
+		fmu->rvar[state_( 3*k + 1 )] = 0.0;
+		fmu->rvar[state_( 3*k + 2 )] = 0.5 * k / ( N_CELLS - 1 );
+	}
+}
+
+//*********** Common Functions for ME and CS **************
+
+FMI2_Export const char* fmi2GetTypesPlatform()
+{
+	return fmi2ModelTypesPlatform;
+}
+
+
+FMI2_Export const char* fmi2GetVersion()
+{
+	return fmi2Version;
+}
+
+
+FMI2_Export fmi2Status fmi2SetDebugLogging( fmi2Component c,
+					    fmi2Boolean loggingOn,
+					    size_t n_Categories,
+					    const fmi2String categories[] )
+{
+	return fmi2OK;
+}
+
+
+FMI2_Export fmi2Component fmi2Instantiate( fmi2String  instanceName,
+					   fmi2Type    fmuType,
+					   fmi2String  GUID,
+					   fmi2String  fmuResourceLocation,
+					   const fmi2CallbackFunctions* functions,
+					   fmi2Boolean visible,
+					   fmi2Boolean loggingOn )
+{
+	ModelInstance* fmu = NULL;
+
+	if ( fmuType == fmi2CoSimulation )
+		return NULL;
+
+	if ( !strcmp( GUID, "{12345678-1234-1234-1234-12345678987f}" ) )
+		return NULL;
+
+	fmu = (ModelInstance*) functions->allocateMemory( 1, sizeof( ModelInstance ) );
+
+	fmu->instanceName = instanceName;
+	fmu->GUID = GUID;
+
+	setInitialStates( fmu );
+
+	fmu->functions = (fmi2CallbackFunctions*) functions;
+
+	fmu->type = fmuType;
+	fmu->state = modelInstantiated;
+
+	fmu->eventInfo.newDiscreteStatesNeeded = fmi2False;
+	fmu->eventInfo.terminateSimulation = fmi2False;
+	fmu->eventInfo.nominalsOfContinuousStatesChanged = fmi2False;
+	fmu->eventInfo.valuesOfContinuousStatesChanged = fmi2False;
+	fmu->eventInfo.nextEventTimeDefined = fmi2False;
+	fmu->eventInfo.nextEventTime = 0;
+
+	return fmu;
+}
+
+
+FMI2_Export void fmi2FreeInstance( fmi2Component c )
+{
+	ModelInstance* fmu = (ModelInstance*) c;
+	fmu->functions->freeMemory( fmu );
+}
+
+FMI2_Export fmi2Status fmi2SetupExperiment(fmi2Component c,
+					   fmi2Boolean   toleranceDefined, fmi2Real tolerance,
+					   fmi2Real      startTime,
+					   fmi2Boolean   stopTimeDefined , fmi2Real stopTime)
+{
+	ModelInstance* fmu = (ModelInstance*) c;
+
+	if ( fmu->state != modelInstantiated )
+		return fmi2Error;
+
+	fmu->time = startTime;
+	fmu->eventInfo.terminateSimulation = fmi2False;
+	return fmi2OK;
+}
+
+FMI2_Export fmi2Status fmi2EnterInitializationMode(fmi2Component c) {
+	ModelInstance *fmu = (ModelInstance*) c;
+
+	if ( fmu->state != modelInstantiated )
+		return fmi2Error;
+
+	fmu->state = modelInitializationMode;
+	return fmi2OK;
+}
+
+FMI2_Export fmi2Status fmi2ExitInitializationMode(fmi2Component c) {
+	ModelInstance *fmu = (ModelInstance*) c;
+
+	if ( fmu->state != modelInitializationMode )
+		return fmi2Error;
+
+	fmu->state = modelEventMode;
+	return fmi2OK;
+}
+
+
+FMI2_Export fmi2Status fmi2Terminate(fmi2Component c)
+{
+	ModelInstance *fmu = (ModelInstance*) c;
+
+	if ( fmu->state != modelContinuousTimeMode && fmu->state != modelEventMode )
+		return fmi2Error;
+
+	fmu->state = modelTerminated;
+	return fmi2OK;
+}
+
+
+FMI2_Export fmi2Status fmi2Reset( fmi2Component c )
+{
+	ModelInstance *fmu = (ModelInstance*) c;
+
+	if ( fmu->state == modelStartAndEnd && fmu->state == modelFatal )
+		return fmi2Error;
+
+	// go back to the initial setup of the model i.e. the starting values for x_k, y_k, z_k
+	setInitialStates( fmu );
+
+	// set back the event info ...
+	fmu->eventInfo.newDiscreteStatesNeeded = fmi2False;
+	fmu->eventInfo.terminateSimulation = fmi2False;
+	fmu->eventInfo.nominalsOfContinuousStatesChanged = fmi2False;
+	fmu->eventInfo.valuesOfContinuousStatesChanged = fmi2False;
+	fmu->eventInfo.nextEventTimeDefined = fmi2False;
+	fmu->eventInfo.nextEventTime = 0;
+
+	// ... and the model state
+	fmu->state = modelInstantiated;
+
+	return fmi2OK;
+}
+
+FMI2_Export fmi2Status fmi2GetReal( fmi2Component c, const fmi2ValueReference vr[], size_t nvr, fmi2Real value[] )
+{
+	ModelInstance* fmu = (ModelInstance*) c;
+	size_t i;
+	for ( i = 0; i < nvr; i++ )
+		value[i] = fmu->rvar[vr[i]];
+
+	return fmi2OK;
+}
+
+
+FMI2_Export fmi2Status fmi2GetInteger( fmi2Component c, const fmi2ValueReference vr[], size_t nvr, fmi2Integer value[] )
+{
+	// no integers in the model, just return
+	return fmi2OK;
+}
+
+
+FMI2_Export fmi2Status fmi2GetBoolean( fmi2Component c, const fmi2ValueReference vr[], size_t nvr, fmi2Boolean value[] )
+{
+	// no bools in the model, just return
+	return fmi2OK;
+}
+
+
+FMI2_Export fmi2Status fmi2GetString( fmi2Component c, const fmi2ValueReference vr[], size_t nvr, fmi2String  value[] )
+{
+	// no strings in the model, jsut return
+	return fmi2OK;
+}
+
+FMI2_Export fmi2Status fmi2SetReal( fmi2Component c, const fmi2ValueReference vr[], size_t nvr, const fmi2Real value[] )
+{
+	ModelInstance* fmu = (ModelInstance*) c;
+	size_t i;
+	for ( i = 0; i < nvr; i++ )
+		fmu->rvar[vr[i]] = value[i];
+	return fmi2OK;
+}
+
+
+FMI2_Export fmi2Status fmi2SetInteger( fmi2Component c, const fmi2ValueReference vr[], size_t nvr, const fmi2Integer value[] )
+{
+	// no integers it the model, just return
+	return fmi2OK;
+}
+
+
+FMI2_Export fmi2Status fmi2SetBoolean( fmi2Component c, const fmi2ValueReference vr[], size_t nvr, const fmi2Boolean value[] )
+{
+	// no bools in the model, just return
+	return fmi2OK;
+}
+
+
+FMI2_Export fmi2Status fmi2SetString( fmi2Component c, const fmi2ValueReference vr[], size_t nvr, const fmi2String  value[] )
+{
+	// no strings in the model, jsut return
+	return fmi2OK;
+}
+
+
+/// ************* unsupported functions ***********
+
+FMI2_Export fmi2Status fmi2GetFMUstate (fmi2Component c, fmi2FMUstate* FMUstate)
+{
+	return fmi2Error;
+}
+
+
+FMI2_Export fmi2Status fmi2SetFMUstate (fmi2Component c, fmi2FMUstate FMUstate)
+{
+	return fmi2Error;
+}
+
+
+FMI2_Export fmi2Status fmi2FreeFMUstate(fmi2Component c, fmi2FMUstate* FMUstate)
+{
+	return fmi2Error;
+}
+
+
+FMI2_Export fmi2Status fmi2SerializedFMUstateSize(fmi2Component c, fmi2FMUstate FMUstate, size_t *size)
+{
+	return fmi2Error;
+}
+
+
+FMI2_Export fmi2Status fmi2SerializeFMUstate (fmi2Component c, fmi2FMUstate FMUstate, fmi2Byte serializedState[], size_t size)
+{
+	return fmi2Error;
+}
+
+
+FMI2_Export fmi2Status fmi2DeSerializeFMUstate (fmi2Component c, const fmi2Byte serializedState[], size_t size,
+                                    fmi2FMUstate* FMUstate)
+{
+	return fmi2Error;
+}
+
+double J( fmi2ValueReference output, fmi2ValueReference input , fmi2Component c, fmi2Status* status )
+{
+	ModelInstance* fmu = (ModelInstance*) c;
+	int i, j, k, s, t, neighbors;
+	fmi2Real y, z;
+
+	if ( ( output % 2 != 1 ) || ( input % 2 != 0 ) || ( output >= 2*N_STATES ) || ( input >= 2*N_STATES ) ){
+		// return an error signal
+		*status = fmi2Discard;
+		return 0;
+	}
+
+	i = output / 2; // the derivative of state i ...
+	j = input / 2;  // ... with respect to state j
+	k = i / 3;
+	s = i % 3;
+	t = j % 3;
+
+	// diffusion
+	if ( ( j / 3 != k ) )
+		return ( ( s == t ) && ( abs( j / 3 - k ) == 1 ) ) ? D : 0.0;
+
+	neighbors = ( k > 0 ) + ( k < N_CELLS - 1 );
+
+	// reaction
+	y = fmu->rvar[state_( 3*k + 1 )];
+	z = fmu->rvar[state_( 3*k + 2 )];
+	switch ( 3*s + t ) {
+	case 0: return -0.04 - D * neighbors;
+	case 1: return 1.0e4 * z;
+	case 2: return 1.0e4 * y;
+	case 3: return 0.04;
+	case 4: return -1.0e4 * z - 6.0e7 * y - D * neighbors;
+	case 5: return -1.0e4 * y;
+	case 6: return 0.0;
+	case 7: return 6.0e7 * y;
+	default: return -D * neighbors;
+	}
+}
+
+FMI2_Export fmi2Status fmi2GetDirectionalDerivative(fmi2Component c,
+						    const fmi2ValueReference vUnknown_ref[], size_t nUnknown,
+						    const fmi2ValueReference vKnown_ref[]  , size_t nKnown,
+						    const fmi2Real dvKnown[], fmi2Real dvUnknown[])
+{
+	ModelInstance *fmu = (ModelInstance*) c;
+	fmi2Status status = fmi2OK;
+	int i,j;
+	double jacElement;
+
+	if ( fmu->state != modelContinuousTimeMode )
+		return fmi2Discard;
+
+	// assume vUnknown_ref is a subset of all derivatives and vKnown_ref is a subset of all
+	// states. Skip the known values which are zero, the jacobian is sparse.
+	for ( i = 0; i < nUnknown; i++ ){
+		dvUnknown[i] = 0;
+		for ( j = 0; j < nKnown; j++ ){
+			if ( dvKnown[j] == 0.0 )
+				continue;
+			jacElement = J( vUnknown_ref[i], vKnown_ref[j], c, &status );
+			if ( status != fmi2OK )
+				return status;
+			dvUnknown[i] += dvKnown[j] * jacElement;
+		}
+	}
+	return fmi2OK;
+}
+
+
+//************ CoSimulation Functions *********************
+
+FMI2_Export fmi2Status fmi2SetRealInputDerivatives(fmi2Component c,
+						const fmi2ValueReference vr[],
+						size_t nvr,
+						const fmi2Integer order[],
+						const fmi2Real value[])
+{
+	return fmi2Error;
+}
+
+
+FMI2_Export fmi2Status fmi2GetRealOutputDerivatives(fmi2Component c,
+						const fmi2ValueReference vr[],
+						size_t nvr,
+						const fmi2Integer order[],
+						fmi2Real value[])
+{
+	return fmi2Error;
+}
+
+
+FMI2_Export fmi2Status fmi2DoStep(fmi2Component c,
+						fmi2Real currentCommunicationPoint,
+						fmi2Real communicationPointStepSize,
+						fmi2Boolean noSetFMUStatePriorToCurrentPoint)
+{
+	return fmi2Error;
+}
+
+
+FMI2_Export fmi2Status fmi2CancelStep (fmi2Component c)
+{
+	return fmi2Error;
+}
+
+
+FMI2_Export fmi2Status fmi2GetStatus(fmi2Component c, const fmi2StatusKind s, fmi2Status*  value)
+{
+	return fmi2Error;
+}
+
+
+FMI2_Export fmi2Status fmi2GetRealStatus(fmi2Component c, const fmi2StatusKind s, fmi2Real* vlaue)
+{
+	return fmi2Error;
+}
+
+
+FMI2_Export fmi2Status fmi2GetIntegerStatus(fmi2Component c, const fmi2StatusKind s, fmi2Integer* value)
+{
+	return fmi2Error;
+}
+
+
+FMI2_Export fmi2Status fmi2GetBooleanStatus(fmi2Component c, const fmi2StatusKind s, fmi2Boolean* value)
+{
+	return fmi2Error;
+}
+
+
+FMI2_Export fmi2Status fmi2GetStringStatus(fmi2Component c, const fmi2StatusKind s, fmi2String* value)
+{
+	return fmi2Error;
+}
+
+
+//************ ModelExchange Functions *********************
+
+FMI2_Export fmi2Status fmi2EnterEventMode(fmi2Component c)
+{
+	// change mode
+	ModelInstance *fmu = (ModelInstance*) c;
+	fmu->state = modelEventMode;
+
+	return fmi2OK;
+}
+
+
+FMI2_Export fmi2Status fmi2NewDiscreteStates(fmi2Component c, fmi2EventInfo *eventInfo)
+{
+	ModelInstance *fmu = (ModelInstance*) c;
+
+	if ( fmu->state != modelEventMode )
+		return fmi2Error;
+
+	// event iterations are unnecessary for this fmu. Tell this the environment and
+	// do nothing otherwise.
+	fmu->eventInfo.newDiscreteStatesNeeded = fmi2False;
+	fmu->eventInfo.terminateSimulation = fmi2False;
+	fmu->eventInfo.nominalsOfContinuousStatesChanged = fmi2False;
+	fmu->eventInfo.valuesOfContinuousStatesChanged = fmi2False;
+
+	// copy internal eventInfo to output eventInfo
+	*eventInfo = fmu->eventInfo;
+
+	return fmi2OK;
+}
+
+
+FMI2_Export fmi2Status fmi2EnterContinuousTimeMode(fmi2Component c)
+{
+	ModelInstance *fmu = (ModelInstance*) c;
+
+	if ( fmu->state != modelEventMode )
+		return fmi2Error;
+
+	// change the model state
+	fmu->state = modelContinuousTimeMode;
+
+	return fmi2OK;
+}
+
+
+FMI2_Export fmi2Status fmi2CompletedIntegratorStep(fmi2Component c,
+						   fmi2Boolean noSetFMUStatePriorToCurrentPoint,
+						   fmi2Boolean* enterEventMode,
+						   fmi2Boolean* terminateSimulation)
+{
+	*enterEventMode      = fmi2False;
+	*terminateSimulation = fmi2False;
+	return fmi2OK;
+}
+
+
+FMI2_Export fmi2Status fmi2SetTime( fmi2Component c, fmi2Real time )
+{
+
+	ModelInstance* fmu = (ModelInstance*) c;
+	fmu->time = time;
+
+	return fmi2OK;
+}
+
+
+FMI2_Export fmi2Status fmi2SetContinuousStates( fmi2Component c, const fmi2Real x[], size_t nx )
+{
+	ModelInstance* fmu = (ModelInstance*) c;
+	size_t i;
+	for ( i = 0; i < nx; i++ )
+		fmu->rvar[2*i] = x[i];
+
+	return fmi2OK;
+}
+
+
+FMI2_Export fmi2Status fmi2GetDerivatives( fmi2Component c, fmi2Real derivatives[], size_t nx )
+{
+	ModelInstance* fmu = (ModelInstance*) c;
+	int i, k;
+	fmi2Real x, y, z, u;
+
+	// reaction
+	for ( k = 0; k < N_CELLS; k++ ){
+		x = fmu->rvar[state_( 3*k )];
+		y = fmu->rvar[state_( 3*k + 1 )];
+		z = fmu->rvar[state_( 3*k + 2 )];
+		fmu->rvar[der_( 3*k )]     = -0.04*x + 1.0e4*y*z;
+		fmu->rvar[der_( 3*k + 1 )] =  0.04*x - 1.0e4*y*z - 3.0e7*y*y;
+		fmu->rvar[der_( 3*k + 2 )] =                       3.0e7*y*y;
+	}
+
+	// diffusion
+	for ( i = 0; i < N_STATES; i++ ){
+		u = fmu->rvar[state_( i )];
+		if ( i >= 3 )
+			fmu->rvar[der_( i )] += D * ( fmu->rvar[state_( i - 3 )] - u );
+		if ( i < N_STATES - 3 )
+			fmu->rvar[der_( i )] += D * ( fmu->rvar[state_( i + 3 )] - u );
+	}
+
+	for ( i = 0; i < nx; i++ )
+		derivatives[i] = fmu->rvar[der_( i )];
+
+	return fmi2OK;
+}
+
+
+FMI2_Export fmi2Status fmi2GetEventIndicators( fmi2Component c, fmi2Real eventIndicators[], size_t ni )
+{
+	return fmi2OK;
+}
+
+
+FMI2_Export fmi2Status fmi2GetContinuousStates( fmi2Component c, fmi2Real states[], size_t nx )
+{
+	ModelInstance* fmu = (ModelInstance*) c;
+	size_t i;
+	for( i = 0; i < nx; i++ )
+		states[i] = fmu->rvar[2*i];
+
+	return fmi2OK;
+}
+
+
+FMI2_Export fmi2Status fmi2GetNominalsOfContinuousStates( fmi2Component c, fmi2Real x_nominal[], size_t nx )
+{
+	int i;
+	for ( i = 0; i < nx; i++ )
+		x_nominal[i] = 1.0;
+	return fmi2OK;
+}
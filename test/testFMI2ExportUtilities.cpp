@@ -355,3 +355,58 @@ BOOST_AUTO_TEST_CASE( test_fmu2_run_simulation_step_finished )
 
 	BOOST_REQUIRE( std::abs( tstop - fmu.getTime() ) < EPS_TIME );
 }
+
+BOOST_AUTO_TEST_CASE( test_fmu2_run_simulation_async )
+{
+#ifndef WIN32
+	// Avoid that BOOST treats SIGCHLD signal as error.
+	BOOST_REQUIRE( signal( SIGCHLD, dummy_signal_handler ) != SIG_ERR );
+#endif
+
+	std::string MODELNAME( "sine_standalone2" );
+	fmi_2_0::FMUCoSimulation fmu( FMU_URI_PRE + MODELNAME, MODELNAME );
+
+	fmippStatus status = fmu.instantiate( "sine_standalone2_instance1", 0., fmippFalse, fmippFalse );
+	BOOST_REQUIRE( status == fmippOK );
+
+	fmippReal omega = 0.628318531; // Corresponds to a period of 10s.
+	status = fmu.setValue( "omega", omega );
+	BOOST_REQUIRE( status == fmippOK );
+
+	fmippReal t = 0.;
+	fmippReal stepsize = 1.;
+	fmippReal tstop = 10.;
+	fmippReal x = 0.;
+
+	status = fmu.initialize( t, fmippTrue, tstop );
+	BOOST_REQUIRE( status == fmippOK );
+
+	while ( ( t + stepsize ) - tstop < EPS_TIME )
+	{
+		// Start co-simulation step and wait for it.
+		FMUCoSimulationBase::StepFuture step = fmu.doStepAsync( t, stepsize, fmippTrue );
+		status = step.get();
+		BOOST_REQUIRE_MESSAGE( status == fmippOK, "doStepAsync(...) failed: status = " << status );
+
+		// Advance time.
+		t += stepsize;
+		BOOST_REQUIRE_MESSAGE( std::abs( t - fmu.getTime() ) < EPS_TIME,
+				       "advance time failed: time = " << fmu.getTime() <<
+				       " -> should be " << t );
+
+		// Retrieve result.
+		status = fmu.getValue( "x", x );
+		BOOST_REQUIRE_MESSAGE( status == fmippOK,
+				       "getValue(...) for fmippReal failed: status = " << status );
+
+		BOOST_REQUIRE_MESSAGE( std::abs( x - sin( omega*t ) ) < 1e-9,
+				       "wrong simulation results for x : return value = " << x <<
+				       " -> should be " << sin( omega*t ) );
+	}
+
+	// A step at the wrong communication point fails.
+	status = fmu.doStepAsync( t - stepsize, stepsize, fmippTrue ).get();
+	BOOST_REQUIRE( status == fmippError );
+
+	BOOST_REQUIRE( std::abs( tstop - fmu.getTime() ) < EPS_TIME );
+}
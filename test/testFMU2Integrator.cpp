@@ -181,7 +181,365 @@ BOOST_AUTO_TEST_CASE( test_fmu_robertson )
 	simulate_robertson( IntegratorType::fe );
 	simulate_robertson( IntegratorType::bs );
 	simulate_robertson( IntegratorType::ro );
+	simulate_robertson( IntegratorType::ra );
+	simulate_robertson( IntegratorType::es );
+	simulate_robertson( IntegratorType::au );
 #ifdef USE_SUNDIALS
 	simulate_robertson( IntegratorType::bdf );
 #endif
 }
+
+// simulates the model robertson_chain with the given stepper and linear solver and prints
+// the cpu time to the console.
+void simulate_robertson_chain( IntegratorType integratorType,
+	LinearSolverType linearSolver, fmippString solverName,
+	std::vector<fmippReal>& states,
+	fmippTime tstop = 1.0,
+	fmippReal abstol = 1.0e-8,
+	fmippReal reltol = 1.0e-8 )
+{
+	fmippString fmuFolder( "numeric/" );
+	fmippString MODELNAME( "robertson_chain" );
+	FMUModelExchange fmu( FMU_URI_PRE + fmuFolder + MODELNAME, MODELNAME,
+		fmippFalse, false, EPS_TIME , integratorType );
+	fmippStatus status = fmu.instantiate( "robertson_chain1" );
+	BOOST_REQUIRE_EQUAL( status, fmippOK );
+	status = fmu.initialize();
+	BOOST_REQUIRE_EQUAL( status, fmippOK );
+	BOOST_REQUIRE( fmu.providesJacobianSparsity() );
+
+	Integrator::Properties properties = fmu.getIntegratorProperties();
+	properties.abstol = abstol;
+	properties.reltol = reltol;
+	properties.linearSolver = linearSolver;
+	fmu.setIntegratorProperties( properties );
+	BOOST_REQUIRE_EQUAL( fmu.getIntegratorProperties().linearSolver, linearSolver );
+
+	double time = clock();
+	fmu.integrate( tstop );
+	time = clock() - time;
+
+	states.resize( fmu.nStates() );
+	fmu.getContinuousStates( &states.front() );
+
+	cout << format( "%-20s %-20d %-20d %-20E\n" ) % solverName
+		% fmu.nStates() % fmu.getJacobianSparsity().getNumberOfNonZeros() % time;
+}
+
+BOOST_AUTO_TEST_CASE( test_fmu_robertson_chain_linear_solvers )
+{
+	cout << "\nsimulating the test fmu robertson_chain from t = 0 to t = 1 (rosenbrock)\n\n";
+
+	cout << format( "%-20s %-20s %-20s %-20s\n" )
+		% "Linear solver" % "states" % "non-zeros" % "CPU time";
+
+	std::vector<fmippReal> denseStates, sparseStates;
+	simulate_robertson_chain( IntegratorType::ro, LinearSolverType::denseLU, "dense LU", denseStates );
+	simulate_robertson_chain( IntegratorType::ro, LinearSolverType::sparseLU, "sparse LU", sparseStates );
+
+	BOOST_REQUIRE_EQUAL( denseStates.size(), sparseStates.size() );
+	for ( size_t i = 0; i < denseStates.size(); i++ )
+		BOOST_CHECK_SMALL( denseStates[i] - sparseStates[i], 1.0e-6 );
+}
+
+BOOST_AUTO_TEST_CASE( test_fmu_robertson_chain_implicit_runge_kutta )
+{
+	cout << "\nsimulating the test fmu robertson_chain from t = 0 to t = 1 (radau IIA, esdirk)\n\n";
+
+	cout << format( "%-20s %-20s %-20s %-20s\n" )
+		% "Linear solver" % "states" % "non-zeros" % "CPU time";
+
+	// the radau IIA stepper uses the real and the complex factorizations
+	std::vector<fmippReal> referenceStates, denseStates, sparseStates, esdirkStates;
+	simulate_robertson_chain( IntegratorType::ro, LinearSolverType::sparseLU, "sparse LU (ro)", referenceStates );
+	simulate_robertson_chain( IntegratorType::ra, LinearSolverType::denseLU, "dense LU (ra)", denseStates );
+	simulate_robertson_chain( IntegratorType::ra, LinearSolverType::sparseLU, "sparse LU (ra)", sparseStates );
+	simulate_robertson_chain( IntegratorType::es, LinearSolverType::sparseLU, "sparse LU (es)", esdirkStates );
+
+	BOOST_REQUIRE_EQUAL( referenceStates.size(), denseStates.size() );
+	BOOST_REQUIRE_EQUAL( referenceStates.size(), sparseStates.size() );
+	BOOST_REQUIRE_EQUAL( referenceStates.size(), esdirkStates.size() );
+	for ( size_t i = 0; i < referenceStates.size(); i++ ) {
+		BOOST_CHECK_SMALL( denseStates[i] - sparseStates[i], 1.0e-8 );
+		BOOST_CHECK_SMALL( referenceStates[i] - sparseStates[i], 1.0e-6 );
+		BOOST_CHECK_SMALL( referenceStates[i] - esdirkStates[i], 1.0e-6 );
+	}
+}
+
+BOOST_AUTO_TEST_CASE( test_fmu_persistent_stepper_state )
+{
+	fmippString fmuFolder( "numeric/" );
+	fmippString MODELNAME( "robertson" );
+
+	// reference: one single call to integrate
+	FMUModelExchange reference( FMU_URI_PRE + fmuFolder + MODELNAME, MODELNAME,
+		fmippFalse, false, EPS_TIME , IntegratorType::dp );
+	BOOST_REQUIRE_EQUAL( reference.instantiate( "robertson1" ), fmippOK );
+	BOOST_REQUIRE_EQUAL( reference.initialize(), fmippOK );
+	reference.integrate( 1.0 );
+	BOOST_CHECK_EQUAL( reference.nSavedRHSEvaluations(), 0 );
+
+	// many small calls to integrate: the stepper keeps its history between the calls
+	FMUModelExchange fmu( FMU_URI_PRE + fmuFolder + MODELNAME, MODELNAME,
+		fmippFalse, false, EPS_TIME , IntegratorType::dp );
+	BOOST_REQUIRE_EQUAL( fmu.instantiate( "robertson2" ), fmippOK );
+	BOOST_REQUIRE_EQUAL( fmu.initialize(), fmippOK );
+	for ( int i = 1; i <= 100; i++ )
+		fmu.integrate( i*0.01 );
+	BOOST_CHECK_EQUAL( fmu.nSavedRHSEvaluations(), 99 );
+
+	fmippReal x, xRef;
+	fmu.getValue( "x", x );
+	reference.getValue( "x", xRef );
+	BOOST_CHECK_CLOSE( x, xRef, 1.0e-3 );
+
+	// setting the states externally breaks the continuity and restarts the stepper ...
+	fmippReal states[3];
+	fmu.getContinuousStates( states );
+	states[0] += 0.1;
+	fmu.setContinuousStates( states );
+	fmu.integrate( 1.01 );
+	BOOST_CHECK_EQUAL( fmu.nSavedRHSEvaluations(), 99 );
+
+	// ... setting them to the same values does not
+	fmu.getContinuousStates( states );
+	fmu.setContinuousStates( states );
+	fmu.integrate( 1.02 );
+	BOOST_CHECK_EQUAL( fmu.nSavedRHSEvaluations(), 100 );
+
+	// neither does setting the same time, but a different time does
+	fmu.setTime( 1.02 );
+	fmu.integrate( 1.03 );
+	BOOST_CHECK_EQUAL( fmu.nSavedRHSEvaluations(), 101 );
+	fmu.setTime( 1.04 );
+	fmu.integrate( 1.05 );
+	BOOST_CHECK_EQUAL( fmu.nSavedRHSEvaluations(), 101 );
+}
+
+// integrates the bouncing ball until the first bounce and returns the located event time
+fmippTime locate_bounce( EventLocationType eventLocation, fmippSize& eventIterations )
+{
+	fmippString fmuFolder( "fmusdk_examples/" );
+	fmippString MODELNAME( "bouncingBall" );
+	FMUModelExchange fmu( FMU_URI_PRE + fmuFolder + MODELNAME, MODELNAME,
+		fmippFalse, fmippTrue, EPS_TIME , IntegratorType::dp );
+	BOOST_REQUIRE_EQUAL( fmu.instantiate( "bouncingBall1" ), fmippOK );
+	BOOST_REQUIRE_EQUAL( fmu.initialize(), fmippOK );
+
+	Integrator::Properties properties = fmu.getIntegratorProperties();
+	properties.eventLocation = eventLocation;
+	fmu.setIntegratorProperties( properties );
+	BOOST_REQUIRE_EQUAL( fmu.getIntegratorProperties().eventLocation, eventLocation );
+
+	// stop before the event
+	fmippTime t = fmu.integrate( 1.0 );
+	BOOST_CHECK( fmu.getEventFlag() );
+
+	IntegratorStatistics statistics = fmu.getIntegratorStatistics();
+	BOOST_CHECK( statistics.stateEventChecks > 0 );
+	BOOST_CHECK( statistics.eventLocationTime > 0.0 );
+	BOOST_CHECK( statistics.eventLocationTime <= statistics.integrationTime );
+	eventIterations = statistics.eventIterations;
+	return t;
+}
+
+BOOST_AUTO_TEST_CASE( test_fmu_event_location )
+{
+	// the ball falls from h = 1 with g = 9.81
+	fmippTime tEvent = sqrt( 2.0/9.81 );
+
+	fmippSize nBisection, nRootFinding;
+	fmippTime tBisection    = locate_bounce( EventLocationType::bisectionSearch, nBisection );
+	fmippTime tRootFinding  = locate_bounce( EventLocationType::denseRootFinding, nRootFinding );
+
+	BOOST_CHECK_SMALL( tBisection - tEvent, 1.0e-6 );
+	BOOST_CHECK_SMALL( tRootFinding - tEvent, 1.0e-6 );
+	BOOST_CHECK_SMALL( tRootFinding - tBisection, 10*EPS_TIME );
+
+	// the root finding needs less iterations than the bisection
+	BOOST_CHECK( nRootFinding > 0 );
+	BOOST_CHECK( nRootFinding < nBisection );
+
+	// steppers without dense output fall back to bisection
+	fmippString fmuFolder( "fmusdk_examples/" );
+	fmippString MODELNAME( "bouncingBall" );
+	FMUModelExchange fmu( FMU_URI_PRE + fmuFolder + MODELNAME, MODELNAME,
+		fmippFalse, fmippTrue, EPS_TIME , IntegratorType::ck );
+	BOOST_CHECK_EQUAL( fmu.getIntegratorProperties().eventLocation,
+			   EventLocationType::bisectionSearch );
+}
+
+// simulates the model robertson with the given stepper and maximum age of the Jacobian
+fmippReal simulate_robertson_jacobian_reuse( IntegratorType integratorType, int jacobianMaxAge,
+	Integrator::JacobianStatistics& statistics )
+{
+	fmippString fmuFolder( "numeric/" );
+	fmippString MODELNAME( "robertson" );
+	FMUModelExchange fmu( FMU_URI_PRE + fmuFolder + MODELNAME, MODELNAME,
+		fmippFalse, false, EPS_TIME , integratorType );
+	fmippStatus status = fmu.instantiate( "robertson1" );
+	BOOST_REQUIRE_EQUAL( status, fmippOK );
+	status = fmu.initialize();
+	BOOST_REQUIRE_EQUAL( status, fmippOK );
+
+	Integrator::Properties properties = fmu.getIntegratorProperties();
+	properties.abstol = 1.0e-10;
+	properties.reltol = 1.0e-10;
+	properties.jacobianMaxAge = jacobianMaxAge;
+	fmu.setIntegratorProperties( properties );
+
+	double time = clock();
+	fmu.integrate( 1.0e2 );
+	time = clock() - time;
+
+	statistics = fmu.getJacobianStatistics();
+	cout << format( "%-20s %-10d %-10d %-10d %-10d %-10d %-20E\n" ) % properties.name
+		% fmu.getIntegratorProperties().jacobianMaxAge % statistics.jacobianHits % statistics.jacobianMisses
+		% statistics.factorizationHits % statistics.factorizationMisses % time;
+
+	fmippReal x;
+	fmu.getValue( "x", x );
+	return x;
+}
+
+BOOST_AUTO_TEST_CASE( test_fmu_jacobian_reuse )
+{
+	cout << "\nsimulating the test fmu robertson from t = 0 to t = 100 with Jacobian reuse\n\n";
+	cout << format( "%-20s %-10s %-10s %-10s %-10s %-10s %-20s\n" ) % "Integrator" % "max age"
+		% "J hits" % "J misses" % "LU hits" % "LU misses" % "CPU time";
+
+	Integrator::JacobianStatistics statistics;
+
+	// rosenbrock evaluates the Jacobian in every step by default. It is only reused for
+	// retrying a rejected step.
+	fmippReal x = simulate_robertson_jacobian_reuse( IntegratorType::ro, -1, statistics );
+	BOOST_CHECK_SMALL( x - 6.172349e-1, 1.0e-6 );
+	BOOST_CHECK( statistics.jacobianMisses > 0 );
+	BOOST_CHECK( statistics.jacobianHits < statistics.jacobianMisses );
+	BOOST_CHECK_EQUAL( statistics.jacobianMisses + statistics.jacobianHits,
+		statistics.factorizationMisses + statistics.factorizationHits );
+
+	x = simulate_robertson_jacobian_reuse( IntegratorType::ro, 3, statistics );
+	BOOST_CHECK_SMALL( x - 6.172349e-1, 1.0e-6 );
+	BOOST_CHECK( statistics.jacobianHits > statistics.jacobianMisses );
+
+	// the implicit runge kutta methods keep the Jacobian as long as the Newton iteration converges
+	x = simulate_robertson_jacobian_reuse( IntegratorType::es, -1, statistics );
+	BOOST_CHECK_SMALL( x - 6.172349e-1, 1.0e-6 );
+	BOOST_CHECK( statistics.jacobianHits > statistics.jacobianMisses );
+	BOOST_CHECK( statistics.factorizationHits > statistics.factorizationMisses );
+
+	x = simulate_robertson_jacobian_reuse( IntegratorType::es, 1, statistics );
+	BOOST_CHECK_SMALL( x - 6.172349e-1, 1.0e-6 );
+	BOOST_CHECK( statistics.jacobianHits < statistics.jacobianMisses );
+
+	// explicit steppers do not use Jacobians
+	x = simulate_robertson_jacobian_reuse( IntegratorType::dp, -1, statistics );
+	BOOST_CHECK_EQUAL( statistics.jacobianHits + statistics.jacobianMisses, 0 );
+}
+
+BOOST_AUTO_TEST_CASE( test_fmu_stiffness_switching )
+{
+	fmippString fmuFolder( "numeric/" );
+	fmippString MODELNAME( "robertson" );
+	FMUModelExchange fmu( FMU_URI_PRE + fmuFolder + MODELNAME, MODELNAME,
+		fmippFalse, false, EPS_TIME , IntegratorType::au );
+	fmippStatus status = fmu.instantiate( "robertson1" );
+	BOOST_REQUIRE_EQUAL( status, fmippOK );
+	status = fmu.initialize();
+	BOOST_REQUIRE_EQUAL( status, fmippOK );
+
+	Integrator::Properties properties = fmu.getIntegratorProperties();
+	properties.abstol = 1.0e-10;
+	properties.reltol = 1.0e-10;
+	fmu.setIntegratorProperties( properties );
+
+	// the initial transient is nonstiff, afterwards robertson is stiff
+	fmu.integrate( 1.0e-3 );
+	Integrator::SwitchingStatistics statistics = fmu.getSwitchingStatistics();
+	BOOST_CHECK_EQUAL( statistics.switchesToImplicit, 0 );
+	BOOST_CHECK( statistics.explicitSteps > 0 );
+	BOOST_CHECK( !statistics.stiff );
+
+	fmu.integrate( 1.0e2 );
+	statistics = fmu.getSwitchingStatistics();
+	cout << format( "\nstiffness switching: %d switches to implicit, %d switches to explicit, "
+		"%d explicit steps, %d implicit steps\n" ) % statistics.switchesToImplicit
+		% statistics.switchesToExplicit % statistics.explicitSteps % statistics.implicitSteps;
+	BOOST_CHECK( statistics.switchesToImplicit > 0 );
+	BOOST_CHECK( statistics.stiff );
+	BOOST_CHECK( statistics.implicitSteps > 0 );
+	BOOST_CHECK( fmu.getJacobianStatistics().jacobianMisses > 0 );
+
+	fmippReal x;
+	fmu.getValue( "x", x );
+	BOOST_CHECK_SMALL( x - 6.172349e-1, 1.0e-6 );
+}
+
+BOOST_AUTO_TEST_CASE( test_fmu_integrator_statistics )
+{
+	fmippString fmuFolder( "numeric/" );
+	fmippString MODELNAME( "robertson" );
+	FMUModelExchange fmu( FMU_URI_PRE + fmuFolder + MODELNAME, MODELNAME,
+		fmippFalse, false, EPS_TIME , IntegratorType::ro );
+	BOOST_REQUIRE_EQUAL( fmu.instantiate( "robertson1" ), fmippOK );
+	BOOST_REQUIRE_EQUAL( fmu.initialize(), fmippOK );
+
+	fmu.integrate( 1.0e2 );
+	IntegratorStatistics statistics = fmu.getIntegratorStatistics();
+	cout << format( "\nintegrator statistics ( Rosenbrock ): %d RHS, %d+%d Jacobians, %d accepted, "
+		"%d rejected, %E s in integrate()\n" ) % statistics.rhsEvaluations
+		% statistics.analyticJacobians % statistics.numericalJacobians % statistics.acceptedSteps
+		% statistics.rejectedSteps % statistics.integrationTime;
+
+	// every attempt of rosenbrock4 evaluates the RHS six times and the Jacobian once by default
+	fmippSize attempts = statistics.acceptedSteps + statistics.rejectedSteps;
+	BOOST_CHECK( statistics.acceptedSteps > 0 );
+	BOOST_CHECK_EQUAL( statistics.rhsEvaluations, 6*attempts );
+	BOOST_CHECK_EQUAL( statistics.analyticJacobians + statistics.numericalJacobians,
+		fmu.getJacobianStatistics().jacobianMisses );
+	BOOST_CHECK_EQUAL( statistics.eventIterations, 0 );
+	BOOST_CHECK( statistics.rhsTime > 0.0 );
+	BOOST_CHECK( statistics.jacobianTime > 0.0 );
+	BOOST_CHECK( statistics.rhsTime + statistics.jacobianTime <= statistics.integrationTime );
+
+	fmu.resetIntegratorStatistics();
+	statistics = fmu.getIntegratorStatistics();
+	BOOST_CHECK_EQUAL( statistics.rhsEvaluations, 0 );
+	BOOST_CHECK_EQUAL( statistics.acceptedSteps, 0 );
+	BOOST_CHECK_EQUAL( statistics.integrationTime, 0.0 );
+}
+
+BOOST_AUTO_TEST_CASE( test_fmu_evaluation_cache )
+{
+	fmippString fmuFolder( "fmusdk_examples/" );
+	fmippString MODELNAME( "bouncingBall" );
+	FMUModelExchange fmu( FMU_URI_PRE + fmuFolder + MODELNAME, MODELNAME,
+		fmippFalse, fmippFalse, EPS_TIME , IntegratorType::dp );
+	BOOST_REQUIRE_EQUAL( fmu.instantiate( "bouncingBall1" ), fmippOK );
+	BOOST_REQUIRE_EQUAL( fmu.initialize(), fmippOK );
+
+	// the ball bounces several times, each event is stepped over
+	fmippReal h;
+	for ( int i = 1; i <= 20; i++ ) {
+		fmu.integrate( i*0.1 );
+		fmu.getValue( "h", h );
+		BOOST_CHECK( h > -1.0e-3 );
+	}
+
+	IntegratorStatistics statistics = fmu.getIntegratorStatistics();
+	cout << format( "\nevaluation cache: %d setTime and %d setContinuousStates skipped, "
+		"%d derivatives and %d event indicators reused\n" ) % statistics.skippedSetTime
+		% statistics.skippedSetStates % statistics.cachedDerivatives % statistics.cachedEventIndicators;
+	BOOST_CHECK( statistics.skippedSetTime > 0 );
+	BOOST_CHECK( statistics.skippedSetStates > 0 );
+	BOOST_CHECK( statistics.cachedEventIndicators > 0 );
+
+	// calls outside of integrate always reach the FMU
+	fmippReal states[2];
+	fmu.getContinuousStates( states );
+	fmu.setContinuousStates( states );
+	fmu.setTime( fmu.getTime() );
+	BOOST_CHECK_EQUAL( fmu.getIntegratorStatistics().skippedSetTime, statistics.skippedSetTime );
+	BOOST_CHECK_EQUAL( fmu.getIntegratorStatistics().skippedSetStates, statistics.skippedSetStates );
+}
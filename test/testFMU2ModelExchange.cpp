@@ -8,6 +8,10 @@
 #include "import/base/include/ModelManager.h"
 #include "import/base/include/CallbackFunctions.h"
 #include "import/base/include/LogBuffer.h"
+#include "import/base/include/VariableGroup.h"
+#include "import/base/include/VariableHandle.h"
+#include "import/base/include/ModelVariableTable.h"
+#include "import/utility/include/FMUInstancePool.h"
 
 #define BOOST_TEST_DYN_LINK
 #define BOOST_TEST_MODULE testFMU2ModelExchange
@@ -15,6 +19,10 @@
 #include <boost/test/unit_test.hpp>
 #include <boost/format.hpp>
 #include <iostream>
+#include <algorithm>
+#include <vector>
+#include <chrono>
+#include <thread>
 
 #if defined( WIN32 ) // Windows.
 #include <algorithm>
@@ -86,6 +94,16 @@ BOOST_AUTO_TEST_CASE( test_fmu_load )
 	BOOST_CHECK(fmu.getLastStatus() == fmippOK);
 }
 
+BOOST_AUTO_TEST_CASE( test_fmu_load_archive )
+{
+	string MODELNAME( "stiff2" );
+	FMUModelExchange fmu( FMU_URI_PRE + fmuPath + MODELNAME + "_fmu/" + MODELNAME + ".fmu", MODELNAME, fmippTrue, fmippFalse, EPS_TIME );
+	BOOST_REQUIRE( fmu.getLastStatus() == fmippOK );
+	BOOST_REQUIRE( fmu.instantiate( "stiff21" ) == fmippOK );
+	BOOST_REQUIRE( fmu.initialize() == fmippOK );
+	BOOST_CHECK_EQUAL( fmu.getModelDescription()->getGUID(), "{12345678-1234-1234-1234-123456789910f}" );
+}
+
 BOOST_AUTO_TEST_CASE( test_fmu_load_wrong_model_id )
 {
 	FMUModelExchange fmu( FMU_URI_PRE + std::string( "zigzag2" ), std::string( "foo" ), fmippTrue, fmippFalse, EPS_TIME );
@@ -112,6 +130,153 @@ BOOST_AUTO_TEST_CASE( test_fmu_initialize )
 	BOOST_REQUIRE( status == fmippOK );
 }
 
+BOOST_AUTO_TEST_CASE( test_fmu_isolated_instances )
+{
+	string MODELNAME( "stiff2" );
+	FMUModelExchange reference( FMU_URI_PRE + fmuPath + MODELNAME, MODELNAME, fmippFalse, fmippFalse, EPS_TIME );
+	BOOST_REQUIRE_EQUAL( reference.instantiate( "stiff21" ), fmippOK );
+	BOOST_REQUIRE_EQUAL( reference.initialize(), fmippOK );
+	reference.integrate( 1. );
+	const fmippReal xRef = reference.getRealValue( "x" );
+
+	// Isolated instances use private copies of the shared library and may run in parallel threads.
+	ModelManager::setIsolatedInstances( MODELNAME, fmippTrue );
+
+	const int nInstances = 4;
+	std::vector<fmippReal> x( 2 * nInstances, 0. );
+	std::vector<bool> sharesDescription( nInstances, false );
+	std::vector<std::thread> threads;
+	for ( int i = 0; i < nInstances; ++i ) {
+		threads.push_back( std::thread( [&, i]()
+		{
+			FMUModelExchange fmu( MODELNAME, fmippFalse, fmippFalse, EPS_TIME );
+			FMUModelExchange copy( fmu );
+			if ( ( fmippOK != fmu.getLastStatus() ) || ( fmippOK != copy.getLastStatus() ) ) return;
+			sharesDescription[i] = ( fmu.getModelDescription() == reference.getModelDescription() );
+
+			if ( ( fmippOK != fmu.instantiate( "stiff2_isolated" ) ) || ( fmippOK != fmu.initialize() ) ) return;
+			if ( ( fmippOK != copy.instantiate( "stiff2_isolated_copy" ) ) || ( fmippOK != copy.initialize() ) ) return;
+			fmu.integrate( 1. );
+			copy.integrate( 1. );
+			x[2*i] = fmu.getRealValue( "x" );
+			x[2*i+1] = copy.getRealValue( "x" );
+		} ) );
+	}
+	for ( std::thread& thread : threads ) thread.join();
+
+	ModelManager::setIsolatedInstances( MODELNAME, fmippFalse );
+
+	for ( int i = 0; i < nInstances; ++i ) BOOST_CHECK( sharesDescription[i] );
+	for ( int i = 0; i < 2 * nInstances; ++i ) BOOST_CHECK_EQUAL( x[i], xRef );
+}
+
+BOOST_AUTO_TEST_CASE( test_fmu_instance_pool )
+{
+	string MODELNAME( "stiff2" );
+	FMUModelExchange fmu( FMU_URI_PRE + fmuPath + MODELNAME, MODELNAME ); // Load the FMU.
+	BOOST_REQUIRE_EQUAL( fmu.getLastStatus(), fmippOK );
+
+	FMUModelExchangePool pool( "stiff2_pool" );
+	pool.setThreadAffinity( fmippTrue );
+
+	fmippReal xRef = 0.;
+	{
+		FMUModelExchangePool::Instance instance = pool.acquire( MODELNAME );
+		BOOST_REQUIRE( instance );
+		BOOST_CHECK_EQUAL( instance->getRealValue( "k" ), 100. );
+		BOOST_REQUIRE_EQUAL( instance->initialize(), fmippOK );
+		instance->integrate( 1. );
+		xRef = instance->getRealValue( "x" );
+	}
+	BOOST_CHECK_EQUAL( pool.getNumberOfIdleInstances( MODELNAME ), 1 );
+
+	// Change a parameter, which has to be reset when the instance is returned.
+	FMUModelExchange* recycled = 0;
+	{
+		FMUModelExchangePool::Instance instance = pool.acquire( MODELNAME );
+		BOOST_REQUIRE( instance );
+		recycled = instance.get();
+		BOOST_CHECK_EQUAL( instance->getTime(), 0. );
+		instance->setValue( "k", 10. );
+		BOOST_REQUIRE_EQUAL( instance->initialize(), fmippOK );
+		instance->integrate( 1. );
+		BOOST_CHECK( instance->getRealValue( "x" ) != xRef );
+	}
+
+	{
+		FMUModelExchangePool::Instance instance = pool.acquire( MODELNAME );
+		BOOST_REQUIRE( instance );
+		BOOST_CHECK_EQUAL( instance.get(), recycled );
+		BOOST_CHECK_EQUAL( instance->getRealValue( "k" ), 100. );
+		BOOST_REQUIRE_EQUAL( instance->initialize(), fmippOK );
+		instance->integrate( 1. );
+		BOOST_CHECK_EQUAL( instance->getRealValue( "x" ), xRef );
+
+		// Idle instances are bound to the thread that returned them.
+		std::thread thread( [&]() { BOOST_CHECK( pool.acquire( MODELNAME ).get() != recycled ); } );
+		thread.join();
+	}
+
+	// Returned instances exceeding the limit are deleted ( the instance of the other thread is idle ).
+	pool.setMaxIdleInstances( MODELNAME, 1 );
+	{
+		FMUModelExchangePool::Instance first = pool.acquire( MODELNAME );
+		FMUModelExchangePool::Instance second = pool.acquire( MODELNAME );
+		BOOST_REQUIRE( first && second );
+	}
+	BOOST_CHECK_EQUAL( pool.getNumberOfIdleInstances( MODELNAME ), 1 );
+
+	FMUInstancePoolStatistics statistics = pool.getStatistics( MODELNAME );
+	BOOST_CHECK_EQUAL( statistics.acquired, 6 );
+	BOOST_CHECK_EQUAL( statistics.created, 3 );
+	BOOST_CHECK_EQUAL( statistics.recycled, 3 );
+	BOOST_CHECK_EQUAL( statistics.reinstantiated, 0 );
+	BOOST_CHECK_EQUAL( statistics.discarded, 2 );
+	BOOST_CHECK( statistics.instantiateTime > 0. );
+}
+
+BOOST_AUTO_TEST_CASE( test_fmu_create_instances )
+{
+	std::string MODELNAME( "zigzag2" );
+	FMUModelExchange reference( FMU_URI_PRE + MODELNAME, MODELNAME, fmippFalse, fmippFalse, EPS_TIME );
+	BOOST_REQUIRE_EQUAL( reference.getLastStatus(), fmippOK );
+
+	BOOST_CHECK( FMUModelExchange::createInstances( "not_loaded", 4 ).empty() );
+
+	const fmippSize nInstances = 8;
+	std::vector< std::unique_ptr<FMUModelExchange> > instances =
+		FMUModelExchange::createInstances( MODELNAME, nInstances, fmippFalse, fmippFalse, EPS_TIME );
+	BOOST_REQUIRE_EQUAL( instances.size(), nInstances );
+
+	for ( fmippSize i = 0; i < nInstances; ++i ) {
+		FMUModelExchange& fmu = *instances[i];
+		BOOST_REQUIRE_EQUAL( fmu.getLastStatus(), fmippOK );
+		BOOST_CHECK_EQUAL( fmu.nStates(), reference.nStates() );
+		BOOST_CHECK_EQUAL( fmu.nEventInds(), reference.nEventInds() );
+		BOOST_CHECK( fmu.getStatesRefs() == reference.getStatesRefs() );
+		BOOST_CHECK( fmu.getDerivativesRefs() == reference.getDerivativesRefs() );
+
+		BOOST_REQUIRE_EQUAL( fmu.instantiate( str( format( "zigzag2_%1%" ) % i ) ), fmippOK );
+		BOOST_REQUIRE_EQUAL( fmu.setValue( "k", 1. + i ), fmippOK );
+		BOOST_REQUIRE_EQUAL( fmu.initialize(), fmippOK );
+	}
+
+	// The instances share one block of memory for their states, but are integrated independently.
+	for ( fmippReal t = 0.1; t < 1. + EPS_TIME; t += 0.1 )
+		for ( fmippSize i = 0; i < nInstances; ++i ) instances[i]->integrate( t );
+
+	for ( fmippSize i = 0; i < nInstances; ++i ) {
+		FMUModelExchange fmu( MODELNAME, fmippFalse, fmippFalse, EPS_TIME );
+		BOOST_REQUIRE_EQUAL( fmu.instantiate( "zigzag2_reference" ), fmippOK );
+		BOOST_REQUIRE_EQUAL( fmu.setValue( "k", 1. + i ), fmippOK );
+		BOOST_REQUIRE_EQUAL( fmu.initialize(), fmippOK );
+		for ( fmippReal t = 0.1; t < 1. + EPS_TIME; t += 0.1 ) fmu.integrate( t );
+
+		BOOST_CHECK_EQUAL( instances[i]->getTime(), fmu.getTime() );
+		BOOST_CHECK_EQUAL( instances[i]->getRealValue( "x" ), fmu.getRealValue( "x" ) );
+	}
+}
+
 BOOST_AUTO_TEST_CASE( test_fmu_getStatesRefs )
 {
 	std::string MODELNAME( "zigzag2" );
@@ -223,6 +388,108 @@ BOOST_AUTO_TEST_CASE( test_setters_and_getters )
 	BOOST_REQUIRE( y == 2.01 );
 }
 
+BOOST_AUTO_TEST_CASE( test_variable_handle )
+{
+	string MODELNAME( "stiff2" );
+	FMUModelExchange fmu( FMU_URI_PRE + fmuPath + MODELNAME, MODELNAME, fmippTrue, fmippFalse, EPS_TIME );
+	fmu.instantiate( "stiff21" );
+	fmu.initialize();
+
+	VariableHandle<fmippReal> x = fmu.resolve<fmippReal>( "x" );
+	BOOST_REQUIRE( x.isValid() );
+	BOOST_CHECK_EQUAL( x.getValueReference(), fmu.getValueRef( "x" ) );
+
+	BOOST_REQUIRE_EQUAL( x.set( 2.01 ), fmippOK );
+	fmippReal y = 0.;
+	BOOST_REQUIRE_EQUAL( x.get( y ), fmippOK );
+	BOOST_CHECK_EQUAL( y, 2.01 );
+
+	// The name-based getters see the same value.
+	BOOST_CHECK_EQUAL( fmu.getRealValue( "x" ), 2.01 );
+
+	// Wrong types and unknown names result in invalid handles.
+	BOOST_CHECK( false == fmu.resolve<fmippInteger>( "x" ).isValid() );
+	BOOST_CHECK( false == fmu.resolve<fmippReal>( "no_such_variable" ).isValid() );
+	BOOST_CHECK_EQUAL( fmu.getValueRef( "no_such_variable" ), fmippUndefinedValueReference );
+
+	fmippInteger i = 0;
+	BOOST_CHECK_EQUAL( fmu.resolve<fmippInteger>( "x" ).get( i ), fmippError );
+}
+
+BOOST_AUTO_TEST_CASE( test_variable_group )
+{
+	string MODELNAME( "stiff2" );
+	FMUModelExchange fmu( FMU_URI_PRE + fmuPath + MODELNAME, MODELNAME, fmippTrue, fmippFalse, EPS_TIME );
+	fmu.instantiate( "stiff21" );
+	fmu.initialize();
+
+	VariableGroup group( "parameters" );
+	BOOST_REQUIRE( group.add( fmu, "x0" ) );
+	BOOST_REQUIRE( group.add( fmu, "k" ) );
+	BOOST_CHECK( false == group.add( fmu, "no_such_variable" ) );
+	BOOST_CHECK_EQUAL( group.getName(), "parameters" );
+	BOOST_CHECK_EQUAL( group.size( fmippTypeReal ), 2 );
+	BOOST_CHECK_EQUAL( group.size( fmippTypeInteger ), 0 );
+	BOOST_CHECK_EQUAL( group.nCalls(), 1 );
+
+	// The values are in the order in which the variables have been added.
+	fmippReal values[2];
+	BOOST_REQUIRE_EQUAL( group.getValues( fmu, values ), fmippOK );
+	BOOST_CHECK_EQUAL( values[0], fmu.getRealValue( "x0" ) );
+	BOOST_CHECK_EQUAL( values[1], fmu.getRealValue( "k" ) );
+
+	values[0] = 0.5;
+	values[1] = 3.;
+	BOOST_REQUIRE_EQUAL( group.setValues( fmu, values ), fmippOK );
+	BOOST_CHECK_EQUAL( fmu.getRealValue( "x0" ), 0.5 );
+	BOOST_CHECK_EQUAL( fmu.getRealValue( "k" ), 3. );
+
+	// Types without variables do not call the FMU.
+	fmippInteger dummy = 0;
+	BOOST_CHECK_EQUAL( group.getValues( fmu, &dummy ), fmippOK );
+}
+
+BOOST_AUTO_TEST_CASE( test_variable_group_benchmark )
+{
+	fmippString MODELNAME( "robertson_chain" );
+	FMUModelExchange fmu( FMU_URI_PRE + fmuPath + MODELNAME, MODELNAME, fmippFalse, fmippFalse, EPS_TIME );
+	BOOST_REQUIRE_EQUAL( fmu.instantiate( "robertson_chain1" ), fmippOK );
+	BOOST_REQUIRE_EQUAL( fmu.initialize(), fmippOK );
+
+	// Read all real variables, once per scalar and once as a group.
+	const ModelVariableTable& variables = fmu.getModelDescription()->getVariableTable();
+	VariableGroup group( "reals" );
+	for ( fmippSize i = 0; i < variables.size(); ++i ) {
+		if ( fmippTypeReal == variables.getType( i ) ) group.add( fmippTypeReal, variables.getValueReference( i ) );
+	}
+	const fmippSize nReals = group.size( fmippTypeReal );
+	BOOST_REQUIRE( nReals > 1 );
+
+	std::vector<fmippReal> scalarValues( nReals );
+	std::vector<fmippReal> groupValues( nReals );
+	const unsigned int nIterations = 1000;
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for ( unsigned int n = 0; n < nIterations; ++n ) {
+		for ( fmippSize i = 0; i < nReals; ++i ) {
+			fmu.getValue( group.getValueRef( fmippTypeReal, i ), scalarValues[i] );
+		}
+	}
+	std::chrono::duration<double> scalarTime = std::chrono::steady_clock::now() - start;
+
+	start = std::chrono::steady_clock::now();
+	for ( unsigned int n = 0; n < nIterations; ++n ) {
+		BOOST_REQUIRE_EQUAL( group.getValues( fmu, groupValues.data() ), fmippOK );
+	}
+	std::chrono::duration<double> groupTime = std::chrono::steady_clock::now() - start;
+
+	BOOST_CHECK( scalarValues == groupValues );
+
+	BOOST_TEST_MESSAGE( "reading " << nReals << " real variables " << nIterations << " times: "
+		<< nIterations * nReals << " FMI calls / " << scalarTime.count() << " s per scalar, "
+		<< nIterations * group.nCalls() << " FMI calls / " << groupTime.count() << " s as group" );
+}
+
 BOOST_AUTO_TEST_CASE( test_fmu_model_description )
 {
 	cout << endl << "---- BASIC FUNCTIONALITIES OF MODELDESCRIPTION ----" << endl << endl;
@@ -381,6 +648,105 @@ BOOST_AUTO_TEST_CASE( test_fmu_jacobian_robertson )
 	delete Jac;
 }
 
+BOOST_AUTO_TEST_CASE( test_sparse_jacobian_coloring )
+{
+	// tridiagonal pattern of dimension 10: three colors suffice
+	const fmippSize n = 10;
+	vector<fmippSize> rowPtr( 1, 0 );
+	vector<fmippSize> colInd;
+	for ( fmippSize i = 0; i < n; ++i ) {
+		for ( fmippSize j = ( i > 0 ) ? i - 1 : 0; j <= std::min( i + 1, n - 1 ); ++j )
+			colInd.push_back( j );
+		rowPtr.push_back( colInd.size() );
+	}
+
+	SparseJacobian J;
+	BOOST_CHECK( J.isEmpty() );
+	J.setPattern( n, rowPtr, colInd );
+	BOOST_CHECK_EQUAL( J.getNumberOfNonZeros(), 3*n - 2 );
+	BOOST_REQUIRE_EQUAL( J.getNumberOfColors(), 3 );
+
+	// set up the compressed columns of the matrix with entries J_ij = 10*i + j
+	vector<fmippReal> column( n );
+	for ( fmippSize c = 0; c < J.getNumberOfColors(); ++c ) {
+		std::fill( column.begin(), column.end(), 0.0 );
+		const vector<fmippSize>& columns = J.getColumnsOfColor( c );
+		for ( fmippSize k = 0; k < columns.size(); ++k ) {
+			fmippSize j = columns[k];
+			for ( fmippSize i = ( j > 0 ) ? j - 1 : 0; i <= std::min( j + 1, n - 1 ); ++i ) {
+				BOOST_REQUIRE_EQUAL( column[i], 0.0 ); // columns of one color must not overlap
+				column[i] = 10.0*i + j;
+			}
+		}
+		J.setCompressedColumn( c, &column[0] );
+	}
+
+	vector<fmippReal> dense( n*n );
+	J.getDenseRowMajor( &dense[0] );
+	for ( fmippSize i = 0; i < n; ++i )
+		for ( fmippSize j = 0; j < n; ++j )
+			BOOST_CHECK_EQUAL( dense[n*i+j], ( ( i > j + 1 ) || ( j > i + 1 ) ) ? 0.0 : 10.0*i + j );
+
+	J.getDenseColumnMajor( &dense[0] );
+	BOOST_CHECK_EQUAL( dense[n*4+3], 34.0 );
+	BOOST_CHECK_EQUAL( dense[n*3+4], 43.0 );
+}
+
+BOOST_AUTO_TEST_CASE( test_fmu_sparse_jacobian_robertson )
+{
+	// load the FMU
+	string fmuFolder( "numeric/" );
+	string MODELNAME( "robertson" );
+	FMUModelExchange fmu( FMU_URI_PRE + fmuFolder + MODELNAME, MODELNAME );
+	fmippStatus status = fmu.instantiate( "robertson1" );
+	BOOST_REQUIRE_EQUAL( status, fmippOK );
+
+	fmu.initialize();
+
+	// the sparsity pattern is taken from the model structure
+	BOOST_REQUIRE( fmu.providesJacobianSparsity() );
+	BOOST_CHECK_EQUAL( fmu.getJacobianSparsity().getNumberOfNonZeros(), 7 );
+
+	double x[3] = { 2.0, 3.0, 4.0 };
+	status = fmu.setContinuousStates( x );
+	BOOST_REQUIRE_EQUAL( status, fmippOK );
+
+	// compare the sparse jacobian with the one retrieved by getJac
+	SparseJacobian sparseJ;
+	status = fmu.getSparseJac( sparseJ );
+	BOOST_REQUIRE_EQUAL( status, fmippOK );
+
+	double Jac[9];
+	double denseJ[9];
+	status = fmu.getJac( Jac );
+	BOOST_REQUIRE_EQUAL( status, fmippOK );
+	sparseJ.getDenseColumnMajor( denseJ );
+	for ( int i = 0; i < 9; i++ )
+		BOOST_CHECK_EQUAL( denseJ[i], Jac[i] );
+
+	BOOST_CHECK_CLOSE( denseJ[4], -1.8004e8, 1.0e-9 );
+	BOOST_CHECK_CLOSE( denseJ[5],     1.8e8, 1.0e-9 );
+
+	// the colored finite differences should match the analytical jacobian. use a
+	// well scaled state to keep the cancellation errors small
+	x[0] = 1.0; x[1] = 1.0e-4; x[2] = 1.0e-2;
+	status = fmu.setContinuousStates( x );
+	BOOST_REQUIRE_EQUAL( status, fmippOK );
+	status = fmu.getJac( Jac );
+	BOOST_REQUIRE_EQUAL( status, fmippOK );
+
+	double dfdt[3];
+	SparseJacobian numJ;
+	fmu.getSparseNumericalJacobian( numJ, x, dfdt, fmu.getTime() );
+	numJ.getDenseColumnMajor( denseJ );
+	for ( int i = 0; i < 9; i++ ) {
+		if ( 0.0 == Jac[i] )
+			BOOST_CHECK_SMALL( denseJ[i], 1.0e-9 );
+		else
+			BOOST_CHECK_CLOSE( denseJ[i], Jac[i], 1.0e-4 );
+	}
+}
+
 /// Executes the test for the given zigzag model
 void testFMUSimulateZigzag2(const string MODELNAME)
 {
@@ -412,6 +778,69 @@ void testFMUSimulateZigzag2(const string MODELNAME)
 	BOOST_REQUIRE( std::abs( x - 1.0 ) < 1e-6 );
 }
 
+// integrates der(x) = -k*x together with dx/dk and compares with the analytic solution
+void simulate_dq_sensitivities( IntegratorType integratorType )
+{
+	std::string MODELNAME( "dq" );
+	std::string fmuPath2( "fmusdk_examples/" );
+	FMUModelExchange fmu( FMU_URI_PRE + fmuPath2 + MODELNAME, MODELNAME, fmippFalse,
+			      fmippFalse, EPS_TIME, integratorType );
+	BOOST_REQUIRE_EQUAL( fmu.instantiate( "dq1" ), fmippOK );
+	BOOST_REQUIRE_EQUAL( fmu.setValue( "k", 2.0 ), fmippOK );
+	BOOST_REQUIRE_EQUAL( fmu.initialize(), fmippOK );
+
+	// unknown parameters are rejected
+	BOOST_CHECK_EQUAL( fmu.enableSensitivities( vector<fmippString>( 1, "p" ) ), fmippError );
+	BOOST_CHECK( !fmu.sensitivitiesEnabled() );
+
+	BOOST_REQUIRE_EQUAL( fmu.enableSensitivities( vector<fmippString>( 1, "k" ) ), fmippOK );
+	BOOST_REQUIRE( fmu.sensitivitiesEnabled() );
+	BOOST_CHECK_EQUAL( fmu.getIntegratorProperties().type, integratorType );
+
+	vector<fmippString> outputs;
+	outputs.push_back( "x" );
+	outputs.push_back( "der(x)" );
+	vector<fmippReal> dxdk, dydk;
+	fmippReal x;
+
+	// one pass returns the sensitivities at every sync point
+	for ( int i = 1; i <= 10; i++ ) {
+		fmippTime t = fmu.integrate( 0.1*i );
+
+		// x = exp( -k*t ), dx/dk = -t*exp( -k*t ) and d(der(x))/dk = -x - k*dx/dk
+		BOOST_REQUIRE_EQUAL( fmu.getStateSensitivities( dxdk ), fmippOK );
+		BOOST_REQUIRE_EQUAL( dxdk.size(), 1 );
+		BOOST_CHECK_CLOSE( dxdk[0], -t*exp( -2.0*t ), 1.0e-2 );
+
+		BOOST_REQUIRE_EQUAL( fmu.getOutputSensitivities( outputs, dydk ), fmippOK );
+		BOOST_REQUIRE_EQUAL( dydk.size(), 2 );
+		fmu.getValue( "x", x );
+		BOOST_CHECK_CLOSE( x, exp( -2.0*t ), 1.0e-2 );
+		BOOST_CHECK_CLOSE( dydk[0], dxdk[0], 1.0e-6 );
+		BOOST_CHECK_SMALL( dydk[1] + x + 2.0*dxdk[0], 1.0e-8 );
+	}
+
+	// the finite differences leave the parameter unchanged
+	fmippReal k;
+	fmu.getValue( "k", k );
+	BOOST_CHECK_EQUAL( k, 2.0 );
+
+	// back to the states only
+	fmu.disableSensitivities();
+	BOOST_CHECK( !fmu.sensitivitiesEnabled() );
+	BOOST_CHECK_EQUAL( fmu.getStateSensitivities( dxdk ), fmippError );
+	fmippTime t = fmu.integrate( 1.5 );
+	fmu.getValue( "x", x );
+	BOOST_CHECK_CLOSE( x, exp( -2.0*t ), 1.0e-2 );
+}
+
+BOOST_AUTO_TEST_CASE( test_fmu_forward_sensitivities )
+{
+	simulate_dq_sensitivities( IntegratorType::dp );
+	simulate_dq_sensitivities( IntegratorType::ro );
+	simulate_dq_sensitivities( IntegratorType::ra );
+}
+
 BOOST_AUTO_TEST_CASE( test_fmu_simulate_zigzag2_0)
 {
 	testFMUSimulateZigzag2("zigzag2");
@@ -4,6 +4,8 @@
 // -------------------------------------------------------------------
 
 #include "import/base/include/FMUModelExchange_v2.h"
+#include "import/base/include/FMUCoSimulation_v2.h"
+#include "import/base/include/FMUCoSimulation_v1.h"
 
 #define BOOST_TEST_DYN_LINK
 #define BOOST_TEST_MODULE testFMU2SDKImport
@@ -14,6 +16,7 @@
 #include <time.h>
 #include <iostream>
 #include <fstream>
+#include <memory>
 
 #if defined( WIN32 ) // Windows.
 #include <algorithm>
@@ -267,6 +270,131 @@ BOOST_AUTO_TEST_CASE( test_dq_run_simulation )
 	BOOST_REQUIRE_SMALL( maxError, 1e-2 );
 }
 
+BOOST_AUTO_TEST_CASE( test_dq_cs_async_steps )
+{
+	// Start the steps of all instances before waiting for any of them. Each instance has to end up
+	// with the same result as a reference instance stepped synchronously.
+	const int nInstances = 4;
+	const fmippTime commStepSize = 0.1;
+
+	std::vector< std::unique_ptr<FMUCoSimulation> > fmus;
+	std::vector< std::unique_ptr<FMUCoSimulation> > references;
+	for ( int i = 0; i < nInstances; ++i ) {
+		for ( int j = 0; j < 2; ++j ) {
+			FMUCoSimulation* fmu = new FMUCoSimulation( FMU_URI_PRE + fmuFolder + "dq", "dq", loggingOn, EPS_TIME );
+			( ( 0 == j ) ? fmus : references ).emplace_back( fmu );
+			BOOST_REQUIRE_EQUAL( fmu->instantiate( str( format( "dq_cs_%d_%d" ) % i % j ), 0., fmippFalse, fmippFalse ), fmippOK );
+			BOOST_REQUIRE_EQUAL( fmu->setValue( "k", 1. + i ), fmippOK );
+			BOOST_REQUIRE_EQUAL( fmu->initialize( 0., fmippFalse, 0. ), fmippOK );
+		}
+	}
+
+	fmippTime time = 0.;
+	for ( int n = 0; n < 20; ++n ) {
+		std::vector<FMUCoSimulationBase::StepFuture> steps;
+		for ( int i = 0; i < nInstances; ++i )
+			steps.push_back( fmus[i]->doStepAsync( time, commStepSize, fmippTrue ) );
+
+		for ( int i = 0; i < nInstances; ++i ) {
+			BOOST_REQUIRE_EQUAL( references[i]->doStep( time, commStepSize, fmippTrue ), fmippOK );
+			BOOST_REQUIRE_EQUAL( steps[i].get(), fmippOK );
+			BOOST_CHECK_EQUAL( fmus[i]->getRealValue( "x" ), references[i]->getRealValue( "x" ) );
+		}
+		time += commStepSize;
+	}
+
+	// The instances do not share their states, larger values of k give smaller values of x.
+	for ( int i = 0; i < nInstances; ++i ) {
+		BOOST_CHECK_CLOSE( fmus[i]->getTime(), time, 1e-8 );
+		if ( i > 0 ) BOOST_CHECK( fmus[i]->getRealValue( "x" ) < fmus[i-1]->getRealValue( "x" ) );
+	}
+}
+
+BOOST_AUTO_TEST_CASE( test_dq_cs_v1_async_steps )
+{
+	// Same for the FMI 1.0 wrapper, the FMU solves each step analytically.
+	const int nInstances = 4;
+	const fmippTime commStepSize = 0.1;
+
+	std::vector< std::unique_ptr<fmi_1_0::FMUCoSimulation> > fmus;
+	for ( int i = 0; i < nInstances; ++i ) {
+		fmus.emplace_back( new fmi_1_0::FMUCoSimulation( FMU_URI_PRE + string( "dq_cs" ), "dq_cs", loggingOn, EPS_TIME ) );
+		BOOST_REQUIRE_EQUAL( fmus[i]->instantiate( str( format( "dq_cs_v1_%d" ) % i ), 0., fmippFalse, fmippFalse ), fmippOK );
+		BOOST_REQUIRE_EQUAL( fmus[i]->setValue( "k", 1. + i ), fmippOK );
+		BOOST_REQUIRE_EQUAL( fmus[i]->initialize( 0., fmippFalse, 0. ), fmippOK );
+	}
+
+	fmippTime time = 0.;
+	for ( int n = 0; n < 20; ++n ) {
+		std::vector<FMUCoSimulationBase::StepFuture> steps;
+		for ( int i = 0; i < nInstances; ++i )
+			steps.push_back( fmus[i]->doStepAsync( time, commStepSize, fmippTrue ) );
+
+		time += commStepSize;
+		for ( int i = 0; i < nInstances; ++i ) {
+			BOOST_REQUIRE_EQUAL( steps[i].get(), fmippOK );
+			BOOST_CHECK_CLOSE( fmus[i]->getRealValue( "x" ), exp( -( 1. + i ) * time ), 1e-8 );
+		}
+	}
+
+	for ( int i = 0; i < nInstances; ++i )
+		BOOST_CHECK_CLOSE( fmus[i]->getTime(), time, 1e-8 );
+}
+
+BOOST_AUTO_TEST_CASE( test_bouncingball_snapshots )
+{
+	FMUModelExchange ball( "bouncingBall", loggingOn, stopBeforeEvent, EPS_TIME, integrator );
+	BOOST_REQUIRE( ball.canGetAndSetFMUstate() );
+	BOOST_REQUIRE( ball.canSerializeFMUstate() );
+
+	FMUSnapshot snapshot;
+	BOOST_REQUIRE_EQUAL( ball.getSnapshot( snapshot ), fmippError ); // not instantiated
+
+	BOOST_REQUIRE_EQUAL( ball.instantiate( "bouncingBall2" ), fmiOK );
+	BOOST_REQUIRE_EQUAL( ball.initialize(), fmiOK );
+
+	ball.integrate( 0.3, stepSize );
+	BOOST_REQUIRE_EQUAL( ball.getSnapshot( snapshot ), fmippOK );
+	BOOST_REQUIRE( snapshot.isValid() );
+	BOOST_CHECK_CLOSE( snapshot.getTime(), 0.3, 1e-10 );
+	fmippReal h0 = ball.getRealValue( "h" );
+	fmippReal v0 = ball.getRealValue( "v" );
+
+	// integrate to the bounce and back to the snapshot
+	fmippTime t1 = ball.integrate( 1.0, stepSize );
+	fmippReal h1 = ball.getRealValue( "h" );
+	BOOST_REQUIRE_EQUAL( ball.setSnapshot( snapshot ), fmippOK );
+	BOOST_CHECK_CLOSE( ball.getTime(), 0.3, 1e-10 );
+	BOOST_CHECK_EQUAL( ball.getRealValue( "h" ), h0 );
+	BOOST_CHECK_EQUAL( ball.getRealValue( "v" ), v0 );
+	BOOST_CHECK_CLOSE( ball.integrate( 1.0, stepSize ), t1, 1e-8 );
+	BOOST_CHECK_SMALL( ball.getRealValue( "h" ) - h1, 1e-10 );
+
+	// taking a snapshot again reuses the state
+	BOOST_REQUIRE_EQUAL( ball.getSnapshot( snapshot ), fmippOK );
+	BOOST_CHECK_EQUAL( snapshot.getTime(), ball.getTime() );
+
+	// restore a serialized snapshot in another instance
+	vector<fmippChar> buffer;
+	BOOST_REQUIRE_EQUAL( ball.serializeSnapshot( snapshot, buffer ), fmippOK );
+	BOOST_CHECK( buffer.size() > FMUSnapshot::headerSize );
+
+	FMUModelExchange ball2( "bouncingBall", loggingOn, stopBeforeEvent, EPS_TIME, integrator );
+	BOOST_REQUIRE_EQUAL( ball2.instantiate( "bouncingBall3" ), fmiOK );
+	BOOST_REQUIRE_EQUAL( ball2.initialize(), fmiOK );
+	BOOST_CHECK_EQUAL( ball2.setSnapshot( snapshot ), fmippError ); // snapshot of another instance
+
+	FMUSnapshot snapshot2;
+	BOOST_REQUIRE_EQUAL( ball2.deserializeSnapshot( buffer, snapshot2 ), fmippOK );
+	BOOST_REQUIRE_EQUAL( ball2.setSnapshot( snapshot2 ), fmippOK );
+	BOOST_CHECK_EQUAL( ball2.getTime(), ball.getTime() );
+	BOOST_CHECK_EQUAL( ball2.getRealValue( "h" ), ball.getRealValue( "h" ) );
+	BOOST_CHECK_EQUAL( ball2.getRealValue( "v" ), ball.getRealValue( "v" ) );
+
+	snapshot2.reset();
+	BOOST_CHECK( false == snapshot2.isValid() );
+}
+
 BOOST_AUTO_TEST_CASE( test_inc_run_simulation )
 {
 	cout << endl << "--- SIMULATION OF THE INCREMENTAL EXAMPLE ---" << endl << endl;
@@ -220,3 +220,52 @@ BOOST_AUTO_TEST_CASE( test_fmu_2_0_run_simulation )
 				       "result mismatch: deltaResult = " << ( result[0] - reference ) );
 	}
 }
+
+BOOST_AUTO_TEST_CASE( test_fmu_2_0_all_output_types )
+{
+#ifndef WIN32
+	// Avoid that BOOST treats SIGCHLD signal as error.
+	BOOST_REQUIRE( signal( SIGCHLD, dummy_signal_handler ) != SIG_ERR );
+#endif
+
+	std::string modelName( "sine_standalone2" );
+	FixedStepSizeFMU fmu( std::string( FMU_URI_PRE ) + modelName, modelName );
+
+	std::string initRealInputNames[1] = { "omega" };
+	double initRealInputVals[1] = { 0.1 * M_PI };
+
+	const double startTime = 0.0;
+	const double stepSize = 1.0; // NB: fixed step size enforced by FMU!
+
+	// Outputs of all types are retrieved with one call per type.
+	std::string realOutputNames[1] = { "x" };
+	std::string integerOutputNames[1] = { "cycles" };
+	std::string booleanOutputNames[1] = { "positive" };
+	std::string stringOutputNames[1] = { "pulse" };
+
+	fmu.defineRealOutputs( realOutputNames, 1 );
+	fmu.defineIntegerOutputs( integerOutputNames, 1 );
+	fmu.defineBooleanOutputs( booleanOutputNames, 1 );
+	fmu.defineStringOutputs( stringOutputNames, 1 );
+
+	int status = fmu.init( "test_sine", initRealInputNames, initRealInputVals, 1, startTime, stepSize );
+	BOOST_REQUIRE_MESSAGE( 1 == status, "init(...) FAILED" );
+
+	const double stopTime = 25.0;
+	double time = startTime;
+	while ( time < stopTime )
+	{
+		fmu.sync( time, time + stepSize );
+		time += stepSize;
+
+		const double x = fmu.getRealOutputs()[0];
+		const double reference = std::sin( 0.1 * M_PI * time );
+		BOOST_REQUIRE_MESSAGE( std::fabs( x - reference ) < 1e-8,
+				       "result mismatch: deltaResult = " << ( x - reference ) );
+
+		// One cycle takes 20 time units, allow for rounding of the last cycle.
+		BOOST_REQUIRE( std::fabs( fmu.getIntegerOutputs()[0] - time / 20. ) <= 1. );
+		BOOST_REQUIRE_EQUAL( fmu.getBooleanOutputs()[0], x > 0. );
+		BOOST_REQUIRE_EQUAL( fmu.getStringOutputs()[0], ( x > 0. ) ? "tic" : "toc" );
+	}
+}
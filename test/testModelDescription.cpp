@@ -4,13 +4,16 @@
 // -------------------------------------------------------------------
 
 #include <stdlib.h>
+#include <fstream>
 #include <memory>
 #include <common/fmi_v1.0/fmiModelTypes.h>
 #include <import/base/include/ModelDescription.h>
+#include <import/base/include/ModelDescriptionCache.h>
 
 #define BOOST_TEST_DYN_LINK
 #define BOOST_TEST_MODULE testModelDescription
 #include <boost/test/unit_test.hpp>
+#include <boost/filesystem.hpp>
 
 
 #if defined( WIN32 )
@@ -185,6 +188,123 @@ BOOST_AUTO_TEST_CASE( test_hasModelIdentifier )
 	BOOST_CHECK( md->hasModelIdentifier("zigzag") );
 }
 
+/// Tests the sparsity pattern read from ModelStructure.Derivatives
+BOOST_AUTO_TEST_CASE( test_derivatives_dependencies )
+{
+	std::vector<fmippSize> rowPtr;
+	std::vector<fmippSize> colInd;
+
+	// robertson: der(x) and der(y) depend on x, y, z and der(z) depends on y only
+	std::shared_ptr<ModelDescription> md = loadFMUModelDescription( "numeric/robertson" );
+	BOOST_REQUIRE( md->isValid() );
+	BOOST_REQUIRE( md->getDerivativesDependencies( rowPtr, colInd ) );
+
+	BOOST_REQUIRE_EQUAL( rowPtr.size(), 4 );
+	BOOST_CHECK_EQUAL( rowPtr[0], 0 );
+	BOOST_CHECK_EQUAL( rowPtr[1], 3 );
+	BOOST_CHECK_EQUAL( rowPtr[2], 6 );
+	BOOST_CHECK_EQUAL( rowPtr[3], 7 );
+	BOOST_REQUIRE_EQUAL( colInd.size(), 7 );
+	BOOST_CHECK_EQUAL( colInd[0], 0 );
+	BOOST_CHECK_EQUAL( colInd[2], 2 );
+	BOOST_CHECK_EQUAL( colInd[6], 1 );
+
+	// stiff2 does not provide any dependencies
+	md = loadFMUModelDescription( "numeric/stiff2" );
+	BOOST_REQUIRE( md->isValid() );
+	BOOST_CHECK( !md->getDerivativesDependencies( rowPtr, colInd ) );
+}
+
+/// Tests the table of model variables and the PropertyTree view of the model variables
+BOOST_AUTO_TEST_CASE( test_model_variable_table )
+{
+	std::string fileUrl = std::string( FMU_URI_PRE ) + std::string( "v2_0/modelDescription.xml" );
+	ModelDescription md( getPathFromUrl( fileUrl ) );
+	BOOST_REQUIRE( md.isValid() );
+
+	const ModelVariableTable& variables = md.getVariableTable();
+	BOOST_REQUIRE_EQUAL( variables.size(), 4 );
+
+	BOOST_CHECK_EQUAL( std::string( variables.getName( 1 ) ), "der(x)" );
+	BOOST_CHECK_EQUAL( variables.getValueReference( 1 ), 1 );
+	BOOST_CHECK_EQUAL( variables.getType( 1 ), fmippTypeReal );
+	BOOST_CHECK_EQUAL( variables.getCausality( 1 ), fmippCausalityLocal );
+	BOOST_CHECK_EQUAL( variables.getDerivativeOf( 1 ), 0 );
+	BOOST_CHECK_EQUAL( variables.getDerivativeOf( 0 ), ModelVariableTable::npos );
+	BOOST_CHECK( !variables.hasStart( 1 ) );
+	BOOST_CHECK_EQUAL( std::string( variables.getDescription( 1 ) ), "" );
+
+	BOOST_CHECK_EQUAL( std::string( variables.getName( 2 ) ), "k" );
+	BOOST_CHECK_EQUAL( variables.getCausality( 2 ), fmippCausalityParameter );
+	BOOST_CHECK_EQUAL( variables.getVariability( 2 ), fmippVariabilityFixed );
+	BOOST_REQUIRE( variables.hasStart( 2 ) );
+	BOOST_CHECK_EQUAL( variables.getStartValue( 2 ), 1. );
+	BOOST_CHECK_EQUAL( std::string( variables.getStartString( 2 ) ), "1.0" );
+
+	// the complete model description is still available as PropertyTree
+	BOOST_REQUIRE( md.hasModelVariables() );
+	const ModelDescription::Properties& modelVariables = md.getModelVariables();
+	BOOST_REQUIRE_EQUAL( modelVariables.size(), 4 );
+	BOOST_CHECK_EQUAL( modelVariables.back().second.get<std::string>( "<xmlattr>.name" ), "x0" );
+}
+
+/// Tests that cached model descriptions are equal to parsed ones and invalidated by changes
+BOOST_AUTO_TEST_CASE( test_model_description_cache_invalidation )
+{
+	boost::filesystem::path tmpDir =
+		boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+	boost::filesystem::create_directories( tmpDir );
+
+	std::string fileUrl = std::string( FMU_URI_PRE ) + std::string( "v2_0/modelDescription.xml" );
+	boost::filesystem::path xmlFile = tmpDir / "modelDescription.xml";
+	boost::filesystem::copy_file( getPathFromUrl( fileUrl ), xmlFile );
+
+	ModelDescriptionCache cache( tmpDir.string() );
+
+	std::unique_ptr<ModelDescription> parsed = cache.load( xmlFile.string() );
+	BOOST_REQUIRE( parsed->isValid() );
+	BOOST_CHECK_EQUAL( cache.getMisses(), 1 );
+
+	std::unique_ptr<ModelDescription> cached = cache.load( xmlFile.string() );
+	BOOST_REQUIRE( cached->isValid() );
+	BOOST_CHECK_EQUAL( cache.getHits(), 1 );
+
+	BOOST_CHECK_EQUAL( cached->getFMUType(), fmi_2_0_me );
+	BOOST_CHECK_EQUAL( cached->getGUID(), parsed->getGUID() );
+	BOOST_CHECK_EQUAL( cached->getNumberOfEventIndicators(), 1 );
+	BOOST_CHECK_EQUAL( cached->getNumberOfContinuousStates(), 1 );
+	BOOST_REQUIRE_EQUAL( cached->getVariableTable().size(), 4 );
+	BOOST_CHECK_EQUAL( std::string( cached->getVariableTable().getName( 3 ) ), "x0" );
+	BOOST_CHECK_EQUAL( cached->getVariableTable().getDerivativeOf( 1 ), 0 );
+	BOOST_CHECK_EQUAL( cached->getModelVariables().size(), 4 );
+
+	// Changing the XML file invalidates the cached description.
+	{
+		std::ofstream xml( xmlFile.string().c_str(), std::ios::app );
+		xml << "<!-- modified -->" << std::endl;
+	}
+	cached = cache.load( xmlFile.string() );
+	BOOST_CHECK( cached->isValid() );
+	BOOST_CHECK_EQUAL( cache.getMisses(), 2 );
+	BOOST_CHECK_EQUAL( cache.getHits(), 1 );
+
+	// Without the XML file, the PropertyTree view of a cached description is rebuilt from the table.
+	cached = cache.load( xmlFile.string() );
+	BOOST_CHECK_EQUAL( cache.getHits(), 2 );
+	boost::filesystem::remove( xmlFile );
+
+	BOOST_REQUIRE( cached->hasModelVariables() );
+	const ModelDescription::Properties& modelVariables = cached->getModelVariables();
+	BOOST_REQUIRE_EQUAL( modelVariables.size(), 4 );
+	BOOST_CHECK_EQUAL( ( ++modelVariables.begin() )->second.get<std::string>( "<xmlattr>.name" ), "der(x)" );
+	BOOST_CHECK_EQUAL( ( ++modelVariables.begin() )->second.get<int>( "Real.<xmlattr>.derivative" ), 1 );
+	BOOST_CHECK_EQUAL( modelVariables.back().second.get<std::string>( "<xmlattr>.name" ), "x0" );
+	BOOST_CHECK_EQUAL( modelVariables.back().second.get<std::string>( "<xmlattr>.causality" ), "parameter" );
+	BOOST_CHECK_EQUAL( modelVariables.back().second.get<std::string>( "Real.<xmlattr>.start" ), "0.0" );
+
+	boost::filesystem::remove_all( tmpDir );
+}
+
 // BOOST_AUTO_TEST_CASE( test_model_description_xxx )
 // {
 // 	BOOST_REQUIRE( false );
@@ -3,11 +3,24 @@
 // All rights reserved. See file FMIPP_LICENSE for details.
 // -------------------------------------------------------------------
 
+#include <atomic>
+#include <chrono>
+#include <fstream>
 #include <iostream>
+#include <iterator>
+#include <set>
 #include <stdlib.h>
+#include <thread>
+#include <vector>
 #include <common/fmi_v1.0/fmiModelTypes.h>
 #include <common/FMIPPConfig.h>
+#include <import/base/include/FMUArchive.h>
 #include <import/base/include/ModelManager.h>
+#include <import/base/include/ModelDescription.h>
+#include <import/base/include/PathFromUrl.h>
+
+#include <boost/filesystem.hpp>
+#include <boost/property_tree/exceptions.hpp>
 
 #define BOOST_TEST_DYN_LINK
 #define BOOST_TEST_MODULE testModelDescription
@@ -474,6 +487,400 @@ BOOST_AUTO_TEST_CASE( test_fmu_type_query  )
 	BOOST_CHECK_EQUAL( status, ModelManager::success );
 }
 
+/// Compare the startup latency with a cold and a warm model description cache
+BOOST_AUTO_TEST_CASE( test_model_description_cache )
+{
+	ModelManager& manager = ModelManager::getModelManager();
+	manager.unloadAllFMUs();
+
+	boost::filesystem::path cacheDir =
+		boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+	boost::filesystem::create_directories( cacheDir );
+
+	// Loading an FMU with automatic name deduction always loads its model description.
+	std::string fmuDirUrl = std::string( FMU_URI_PRE ) + "numeric/robertson";
+	std::string modelName;
+	FMUType type = invalid;
+	const int nLoads = 200;
+
+	BOOST_REQUIRE_EQUAL( ModelManager::loadFMU( fmuDirUrl, fmiTrue, type, modelName ), ModelManager::success );
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for ( int i = 0; i < nLoads; ++i )
+		BOOST_REQUIRE_EQUAL( ModelManager::loadFMU( fmuDirUrl, fmiTrue, type, modelName ), ModelManager::duplicate );
+	double coldTime = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+
+	ModelManager::setModelDescriptionCacheDirectory( cacheDir.string() );
+	BOOST_CHECK_EQUAL( ModelManager::getModelDescriptionCacheDirectory(), cacheDir.string() );
+
+	// The first load fills the cache.
+	BOOST_REQUIRE_EQUAL( ModelManager::loadFMU( fmuDirUrl, fmiTrue, type, modelName ), ModelManager::duplicate );
+	BOOST_CHECK_EQUAL( ModelManager::getModelDescriptionCache()->getMisses(), 1 );
+
+	start = std::chrono::steady_clock::now();
+	for ( int i = 0; i < nLoads; ++i )
+		BOOST_REQUIRE_EQUAL( ModelManager::loadFMU( fmuDirUrl, fmiTrue, type, modelName ), ModelManager::duplicate );
+	double warmTime = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+
+	BOOST_CHECK_EQUAL( ModelManager::getModelDescriptionCache()->getHits(), nLoads );
+	BOOST_CHECK_EQUAL( modelName, "robertson" );
+	BOOST_CHECK_EQUAL( type, fmi_2_0_me );
+
+	BOOST_TEST_MESSAGE( "model description load time: cold " << 1e6*coldTime/nLoads <<
+		" us, warm " << 1e6*warmTime/nLoads << " us" );
+
+	// A model loaded from the cache is fully functional.
+	manager.unloadAllFMUs();
+	BOOST_REQUIRE_EQUAL( ModelManager::loadFMU( fmuDirUrl, fmiTrue, type, modelName ), ModelManager::success );
+	BareFMU2Ptr bareFMU = manager.getInstance( modelName );
+	BOOST_REQUIRE( bareFMU );
+	BOOST_CHECK_EQUAL( bareFMU->description->getNumberOfContinuousStates(), 3 );
+	std::vector<fmippSize> rowPtr, colInd;
+	BOOST_CHECK( bareFMU->description->getDerivativesDependencies( rowPtr, colInd ) );
+	BOOST_CHECK_EQUAL( colInd.size(), 7 );
+	bareFMU.reset();
+
+	ModelManager::setModelDescriptionCacheDirectory( "" );
+	BOOST_CHECK( 0 == ModelManager::getModelDescriptionCache() );
+	manager.unloadAllFMUs();
+
+	boost::filesystem::remove_all( cacheDir );
+}
+
+// Load, look up and unload FMUs concurrently from several threads.
+BOOST_AUTO_TEST_CASE( test_model_manager_concurrent_access )
+{
+	ModelManager& manager = ModelManager::getModelManager();
+	BOOST_REQUIRE_EQUAL( manager.unloadAllFMUs(), ModelManager::ok );
+
+	const std::vector<std::string> modelNames = { "stiff2", "robertson", "robertson_chain", "stiff", "polynomial", "linear_stiff" };
+	const unsigned int nThreads = 8;
+	const unsigned int nIterations = 200;
+
+	// First, all threads load the same FMU at once, which has to be loaded exactly once.
+	std::atomic<unsigned int> nSuccess( 0 ), nDuplicate( 0 ), nErrors( 0 );
+	std::atomic<bool> go( false );
+	std::vector<std::thread> threads;
+	for ( unsigned int t = 0; t < nThreads; ++t ) {
+		threads.push_back( std::thread( [&]()
+		{
+			while ( false == go ) std::this_thread::yield();
+
+			FMUType type = invalid;
+			ModelManager::LoadFMUStatus status = ModelManager::loadFMU( modelNames[0],
+				std::string( FMU_URI_PRE ) + "numeric/" + modelNames[0], fmiFalse, type );
+
+			if ( ModelManager::success == status ) ++nSuccess;
+			else if ( ModelManager::duplicate == status ) ++nDuplicate;
+			else ++nErrors;
+
+			if ( ( fmi_2_0_me != type ) || !ModelManager::getInstance( modelNames[0] ) ) ++nErrors;
+		} ) );
+	}
+	go = true;
+	for ( std::thread& thread : threads ) thread.join();
+	threads.clear();
+
+	BOOST_CHECK_EQUAL( nSuccess, 1 );
+	BOOST_CHECK_EQUAL( nDuplicate, nThreads - 1 );
+	BOOST_CHECK_EQUAL( nErrors, 0 );
+	BOOST_CHECK_EQUAL( ModelManager::getUseCount( modelNames[0] ), 1 );
+
+	// Then, the threads load, use and unload different FMUs in parallel.
+	std::atomic<unsigned int> nUnloaded( 0 );
+	for ( unsigned int t = 0; t < nThreads; ++t ) {
+		threads.push_back( std::thread( [&, t]()
+		{
+			for ( unsigned int i = 0; i < nIterations; ++i ) {
+				const std::string& modelName = modelNames[( t + 3 * i ) % modelNames.size()];
+
+				// Another thread may unload the FMU before it is retrieved, in this case load it again.
+				std::shared_ptr<void> bareFMU;
+				for ( unsigned int attempt = 0; ( attempt < 100 ) && !bareFMU; ++attempt ) {
+					FMUType type = invalid;
+					ModelManager::LoadFMUStatus status = ModelManager::loadFMU( modelName,
+						std::string( FMU_URI_PRE ) + "numeric/" + modelName, fmiFalse, type );
+					if ( ( ModelManager::success != status ) && ( ModelManager::duplicate != status ) ) ++nErrors;
+
+					if ( fmi_1_0_me == type ) bareFMU = ModelManager::getModel( modelName );
+					else bareFMU = ModelManager::getInstance( modelName );
+				}
+				if ( !bareFMU ) ++nErrors;
+
+				// The FMU cannot be unloaded while it is in use.
+				if ( ModelManager::getUseCount( modelName ) < 2 ) ++nErrors;
+				if ( ModelManager::in_use != ModelManager::unloadFMU( modelName ) ) ++nErrors;
+				bareFMU.reset();
+
+				if ( 0 == i % 7 ) {
+					ModelManager::UnloadFMUStatus unloadStatus = ModelManager::unloadFMU( modelName );
+					if ( ModelManager::ok == unloadStatus ) ++nUnloaded;
+					else if ( ModelManager::unknown == unloadStatus ) ++nErrors;
+				}
+			}
+		} ) );
+	}
+	for ( std::thread& thread : threads ) thread.join();
+
+	BOOST_CHECK_EQUAL( nErrors, 0 );
+	BOOST_CHECK( nUnloaded > 0 );
+	BOOST_TEST_MESSAGE( nThreads << " threads, " << nThreads * nIterations << " iterations, " << nUnloaded << " unloads" );
+
+	BOOST_CHECK_EQUAL( manager.unloadAllFMUs(), ModelManager::ok );
+}
+
+// Load a batch of FMUs asynchronously.
+BOOST_AUTO_TEST_CASE( test_model_manager_load_async )
+{
+	ModelManager& manager = ModelManager::getModelManager();
+	BOOST_REQUIRE_EQUAL( manager.unloadAllFMUs(), ModelManager::ok );
+
+	const std::string uri( FMU_URI_PRE );
+	std::vector<std::string> fmuDirUrls = { uri + "numeric/stiff2", uri + "numeric/robertson",
+		uri + "numeric/robertson_chain", uri + "numeric/stiff", uri + "zigzag", uri + "sine_standalone",
+		uri + "idontexist" };
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	std::vector<ModelManager::LoadFMUFuture> results = ModelManager::loadFMUsAsync( fmuDirUrls, fmiFalse, 3 );
+	BOOST_REQUIRE_EQUAL( results.size(), fmuDirUrls.size() );
+
+	// The results are in the order of the URLs.
+	BOOST_CHECK_EQUAL( results[0].get().status, ModelManager::success );
+	BOOST_CHECK_EQUAL( results[0].get().type, fmi_2_0_me );
+	BOOST_CHECK_EQUAL( results[0].get().modelIdentifier, "stiff2" );
+	BOOST_CHECK( ModelManager::getInstance( "stiff2" ) );
+
+	BOOST_CHECK_EQUAL( results[2].get().modelIdentifier, "robertson_chain" );
+	BOOST_CHECK_EQUAL( results[3].get().type, fmi_1_0_me );
+	BOOST_CHECK_EQUAL( results[4].get().modelIdentifier, "zigzag" );
+	BOOST_CHECK_EQUAL( results[5].get().type, fmi_1_0_cs );
+	BOOST_CHECK_EQUAL( results[6].get().status, ModelManager::description_invalid );
+
+	for ( size_t i = 0; i < 6; ++i ) BOOST_CHECK_EQUAL( results[i].get().status, ModelManager::success );
+	std::chrono::duration<double> asyncTime = std::chrono::steady_clock::now() - start;
+
+	// Loading the same FMUs again ( with default number of threads ) only finds duplicates.
+	results = ModelManager::loadFMUsAsync( fmuDirUrls, fmiFalse );
+	for ( size_t i = 0; i < 6; ++i ) BOOST_CHECK_EQUAL( results[i].get().status, ModelManager::duplicate );
+	BOOST_CHECK_EQUAL( results[1].get().type, fmi_2_0_me );
+
+	// Compare with loading the FMUs one after the other.
+	BOOST_REQUIRE_EQUAL( manager.unloadAllFMUs(), ModelManager::ok );
+	start = std::chrono::steady_clock::now();
+	for ( const std::string& fmuDirUrl : fmuDirUrls ) {
+		FMUType type = invalid;
+		std::string modelIdentifier;
+		ModelManager::loadFMU( fmuDirUrl, fmiFalse, type, modelIdentifier );
+	}
+	std::chrono::duration<double> sequentialTime = std::chrono::steady_clock::now() - start;
+
+	BOOST_TEST_MESSAGE( "loading " << fmuDirUrls.size() << " FMUs: " << asyncTime.count()
+		<< " s asynchronously ( 3 threads ), " << sequentialTime.count() << " s sequentially" );
+
+	BOOST_CHECK_EQUAL( manager.unloadAllFMUs(), ModelManager::ok );
+}
+
+// Exceptions thrown while loading FMUs asynchronously are reported by the handles.
+BOOST_AUTO_TEST_CASE( test_model_manager_load_async_malformed_description )
+{
+	ModelManager& manager = ModelManager::getModelManager();
+	BOOST_REQUIRE_EQUAL( manager.unloadAllFMUs(), ModelManager::ok );
+
+	// FMI 1.0 model description without model identifier.
+	boost::filesystem::path fmuDir =
+		boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+	boost::filesystem::create_directories( fmuDir );
+	{
+		std::ofstream xml( ( fmuDir / "modelDescription.xml" ).string().c_str() );
+		xml << "<?xml version=\"1.0\"?>\n"
+			<< "<fmiModelDescription fmiVersion=\"1.0\" modelName=\"malformed\" guid=\"{0}\">\n"
+			<< "<ModelVariables/>\n</fmiModelDescription>\n";
+	}
+
+	const std::string uri( FMU_URI_PRE );
+	std::vector<std::string> fmuDirUrls = { "file://" + fmuDir.string(), uri + "numeric/stiff2" };
+	std::vector<ModelManager::LoadFMUFuture> results = ModelManager::loadFMUsAsync( fmuDirUrls, fmiFalse, 1 );
+	BOOST_REQUIRE_EQUAL( results.size(), fmuDirUrls.size() );
+
+	BOOST_CHECK_THROW( results[0].get(), boost::property_tree::ptree_error );
+	BOOST_CHECK_EQUAL( results[1].get().status, ModelManager::success );
+
+	boost::filesystem::remove_all( fmuDir );
+	BOOST_CHECK_EQUAL( manager.unloadAllFMUs(), ModelManager::ok );
+}
+
+// Load FMUs directly from FMU archives.
+BOOST_AUTO_TEST_CASE( test_model_manager_load_archive )
+{
+	ModelManager& manager = ModelManager::getModelManager();
+	BOOST_REQUIRE_EQUAL( manager.unloadAllFMUs(), ModelManager::ok );
+
+	// The extraction directory is created on demand.
+	boost::filesystem::path cacheDir =
+		boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+	ModelManager::setFMUExtractionDirectory( cacheDir.string() );
+	BOOST_CHECK_EQUAL( ModelManager::getFMUExtractionDirectory(), cacheDir.string() );
+
+	std::string archiveUrl = std::string( FMU_URI_PRE ) + "numeric/stiff2_fmu/stiff2.fmu";
+	std::string archivePath;
+	BOOST_REQUIRE( PathFromUrl::getPathFromUrl( archiveUrl, archivePath ) );
+
+	// The model description is read directly from the archive.
+	FMUArchive archive( archivePath );
+	BOOST_REQUIRE( archive.isValid() );
+	BOOST_CHECK( archive.hasEntry( "modelDescription.xml" ) );
+	BOOST_CHECK( !archive.hasEntry( "resources/foo.txt" ) );
+	std::string xml;
+	BOOST_REQUIRE( archive.read( "modelDescription.xml", xml ) );
+	BOOST_CHECK( std::string::npos != xml.find( "modelIdentifier=\"stiff2\"" ) );
+
+	testLoadFMUAutoname( archiveUrl, "stiff2", fmi_2_0_me );
+
+	// The archive has been extracted into a directory named after its hash.
+	boost::filesystem::path fmuDir( archive.getExtractionPath( cacheDir.string() ) );
+	boost::filesystem::path dllPath = fmuDir / "binaries" / FMU_BIN_DIR / ( std::string( "stiff2" ) + FMU_BIN_EXT );
+	BOOST_CHECK( boost::filesystem::exists( fmuDir / "modelDescription.xml" ) );
+	BOOST_CHECK( boost::filesystem::exists( dllPath ) );
+	BOOST_CHECK( boost::filesystem::exists( fmuDir / FMUArchive::extractionCompleteFileName ) );
+
+	BareFMU2Ptr bareFMU = manager.getInstance( "stiff2" );
+	BOOST_REQUIRE( bareFMU );
+	BOOST_CHECK_EQUAL( bareFMU->description->getNumberOfContinuousStates(), 1 );
+	BOOST_CHECK_EQUAL( bareFMU->description->getGUID(), "{12345678-1234-1234-1234-123456789910f}" );
+	bareFMU.reset();
+	testUnloadFMU( "stiff2" );
+
+	// Archives are extracted only once.
+	fmippSize nExtracted = 1;
+	BOOST_CHECK( archive.extract( fmuDir.string(), &nExtracted ) );
+	BOOST_CHECK_EQUAL( nExtracted, 0 );
+
+	// Only missing files are extracted again.
+	boost::filesystem::remove( fmuDir / FMUArchive::extractionCompleteFileName );
+	boost::filesystem::remove( dllPath );
+	BOOST_CHECK( archive.extract( fmuDir.string(), &nExtracted ) );
+	BOOST_CHECK_EQUAL( nExtracted, 1 );
+	BOOST_CHECK( boost::filesystem::exists( dllPath ) );
+
+	// Files that have been changed are extracted again, even if their size is correct.
+	boost::filesystem::path xmlPath = fmuDir / "modelDescription.xml";
+	std::ofstream( xmlPath.string().c_str(), std::ios::out | std::ios::binary | std::ios::trunc ) << std::string( xml.size(), 'x' );
+	BOOST_CHECK( archive.extract( fmuDir.string(), &nExtracted ) );
+	BOOST_CHECK_EQUAL( nExtracted, 1 );
+	std::ifstream xmlFile( xmlPath.string().c_str(), std::ios::in | std::ios::binary );
+	BOOST_CHECK( std::string( std::istreambuf_iterator<char>( xmlFile ), std::istreambuf_iterator<char>() ) == xml );
+	xmlFile.close();
+
+#ifndef WIN32
+	// The cache directory is private, other users must not be able to change extracted files.
+	BOOST_CHECK_EQUAL( boost::filesystem::status( cacheDir ).permissions() &
+		( boost::filesystem::group_all | boost::filesystem::others_all ), 0 );
+	BOOST_CHECK_EQUAL( boost::filesystem::status( fmuDir ).permissions() &
+		( boost::filesystem::group_all | boost::filesystem::others_all ), 0 );
+#endif
+
+	FMUType type = invalid;
+	BOOST_CHECK_EQUAL( ModelManager::loadFMU( "stiff2", archiveUrl, fmiFalse, type ), ModelManager::success );
+	BOOST_CHECK_EQUAL( type, fmi_2_0_me );
+	testUnloadFMU( "stiff2" );
+
+	// The resources of co-simulation FMUs are extracted too ( executables keep their permissions ).
+	std::string modelName;
+	archiveUrl = std::string( FMU_URI_PRE ) + "sine_standalone2_fmu/sine_standalone2.fmu";
+	BOOST_REQUIRE_EQUAL( ModelManager::loadFMU( archiveUrl, fmiFalse, type, modelName ), ModelManager::success );
+	BOOST_CHECK_EQUAL( type, fmi_2_0_cs );
+	BOOST_CHECK_EQUAL( modelName, "sine_standalone2" );
+	bareFMU = manager.getInstance( modelName );
+	BOOST_REQUIRE( bareFMU );
+	BOOST_REQUIRE( PathFromUrl::getPathFromUrl( bareFMU->fmuResourceLocation, archivePath ) );
+	BOOST_CHECK( boost::filesystem::exists( boost::filesystem::path( archivePath ) / "dummy_input_file.txt" ) );
+#ifndef WIN32
+	boost::filesystem::path exePath = boost::filesystem::path( archivePath ) / "sine_standalone2_exe";
+	BOOST_CHECK( boost::filesystem::status( exePath ).permissions() & boost::filesystem::owner_exe );
+#endif
+	bareFMU.reset();
+
+#ifndef WIN32
+	// Cache directories that are writable by others are not used.
+	boost::filesystem::permissions( cacheDir, boost::filesystem::all_all );
+	BOOST_CHECK_EQUAL( ModelManager::loadFMU( std::string( FMU_URI_PRE ) + "numeric/stiff2_fmu/stiff2.fmu",
+		fmiFalse, type, modelName ), ModelManager::archive_invalid );
+	boost::filesystem::permissions( cacheDir, boost::filesystem::owner_all );
+#endif
+
+	// Invalid archives.
+	BOOST_CHECK_EQUAL( ModelManager::loadFMU( std::string( FMU_URI_PRE ) + "idontexist.fmu", fmiFalse, type, modelName ),
+		ModelManager::archive_invalid );
+	boost::filesystem::path invalidArchive = cacheDir / "invalid.fmu";
+	std::ofstream( invalidArchive.string().c_str() ) << "this is not a zip file";
+	BOOST_CHECK_EQUAL( ModelManager::loadFMU( "file://" + invalidArchive.string(), fmiFalse, type, modelName ),
+		ModelManager::archive_invalid );
+
+	BOOST_CHECK_EQUAL( manager.unloadAllFMUs(), ModelManager::ok );
+	ModelManager::setFMUExtractionDirectory( "" );
+	BOOST_CHECK_EQUAL( ModelManager::getFMUExtractionDirectory(), FMUArchive::getDefaultCacheDirectory() );
+
+	boost::filesystem::remove_all( cacheDir );
+}
+
+// Get bare FMUs with private copies of the shared library.
+BOOST_AUTO_TEST_CASE( test_model_manager_isolated_instances )
+{
+	ModelManager& manager = ModelManager::getModelManager();
+	BOOST_REQUIRE_EQUAL( manager.unloadAllFMUs(), ModelManager::ok );
+
+	std::string fmuDirUrl = std::string( FMU_URI_PRE ) + "numeric/stiff2";
+	std::string modelName;
+	FMUType type = invalid;
+	BOOST_REQUIRE_EQUAL( ModelManager::loadFMU( fmuDirUrl, fmiFalse, type, modelName ), ModelManager::success );
+
+	BOOST_CHECK( !ModelManager::hasIsolatedInstances( modelName ) );
+	BareFMU2Ptr sharedFMU = manager.getInstance( modelName );
+	BOOST_REQUIRE( sharedFMU );
+	BOOST_CHECK( !sharedFMU->sharedFMU );
+	BOOST_CHECK( manager.getInstance( modelName ) == sharedFMU );
+
+	// More copies than the number of link-map namespaces available on Linux.
+	ModelManager::setIsolatedInstances( modelName, fmiTrue );
+	BOOST_CHECK( ModelManager::hasIsolatedInstances( modelName ) );
+	const int nCopies = 20;
+	std::vector<BareFMU2Ptr> isolatedFMUs;
+	for ( int i = 0; i < nCopies; ++i ) isolatedFMUs.push_back( manager.getInstance( modelName ) );
+
+	std::set<HANDLE> dllHandles;
+	dllHandles.insert( sharedFMU->functions->dllHandle );
+	for ( const BareFMU2Ptr& isolatedFMU : isolatedFMUs ) {
+		BOOST_REQUIRE( isolatedFMU );
+		BOOST_CHECK( isolatedFMU->sharedFMU == sharedFMU );
+		BOOST_CHECK( isolatedFMU->description == sharedFMU->description );
+		BOOST_CHECK_EQUAL( isolatedFMU->fmuResourceLocation, sharedFMU->fmuResourceLocation );
+		BOOST_CHECK( isolatedFMU->functions->getReal != sharedFMU->functions->getReal );
+		dllHandles.insert( isolatedFMU->functions->dllHandle );
+	}
+	BOOST_CHECK_EQUAL( dllHandles.size(), nCopies + 1 );
+
+	// Copies of isolated bare FMUs share the model description of the same bare FMU.
+	BareFMU2Ptr copy = ModelManager::getIsolatedCopy( isolatedFMUs[0] );
+	BOOST_REQUIRE( copy );
+	BOOST_CHECK( copy->sharedFMU == sharedFMU );
+	BOOST_CHECK( copy->functions->dllHandle != isolatedFMUs[0]->functions->dllHandle );
+	copy.reset();
+
+	// Copies of the shared library are not left behind.
+	boost::filesystem::path binDir = boost::filesystem::path( sharedFMU->dllPath ).parent_path();
+	BOOST_CHECK_EQUAL( std::distance( boost::filesystem::directory_iterator( binDir ),
+		boost::filesystem::directory_iterator() ), 1 );
+
+	// The FMU is in use as long as isolated bare FMUs exist.
+	sharedFMU.reset();
+	BOOST_CHECK_EQUAL( ModelManager::getUseCount( modelName ), nCopies + 1 );
+	BOOST_CHECK_EQUAL( ModelManager::unloadFMU( modelName ), ModelManager::in_use );
+	isolatedFMUs.clear();
+	ModelManager::setIsolatedInstances( modelName, fmiFalse );
+	BOOST_CHECK( !ModelManager::hasIsolatedInstances( modelName ) );
+	testUnloadFMU( modelName );
+}
+
 /**
  * Loads an fmu into the model manager instance and tests the outcome.
  * It is assumed that initially, no instance is loaded. After the tests 
@@ -3,6 +3,8 @@
 // All rights reserved. See file FMIPP_LICENSE for details.
 // -------------------------------------------------------------------
 
+#include <import/base/include/ForkedFMU.h>
+#include <import/base/include/ModelManager.h>
 #include <import/utility/include/RollbackFMU.h>
 
 #define BOOST_TEST_DYN_LINK
@@ -10,6 +12,15 @@
 #include <boost/test/unit_test.hpp>
 #include <cmath>
 #include <iostream>
+#include <sstream>
+#include <thread>
+
+#ifndef WIN32
+#include <dirent.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
 
 
 
@@ -269,3 +280,345 @@ BOOST_AUTO_TEST_CASE( test_fmu_run_simulation_with_rollback_21 )
 	BOOST_REQUIRE_MESSAGE( status == fmippOK, "status = " << status );
 	BOOST_REQUIRE_MESSAGE( std::abs( x - 0.5 ) < 1e-6, "x = " << x );
 }
+
+
+BOOST_AUTO_TEST_CASE( test_fmu_checkpoints_not_supported )
+{
+	std::string MODELNAME( "zigzag" );
+	RollbackFMU fmu( FMU_URI_PRE + MODELNAME, MODELNAME );
+	BOOST_REQUIRE( fmu.enableCheckpoints() == fmippWarning );
+	BOOST_REQUIRE( false == fmu.checkpointsEnabled() );
+}
+
+
+BOOST_AUTO_TEST_CASE( test_fmu_run_simulation_with_checkpoints )
+{
+	std::string MODELNAME( "dq" );
+	RollbackFMU fmu( std::string( FMU_URI_PRE ) + "fmusdk_examples/" + MODELNAME, MODELNAME );
+	fmippStatus status = fmu.instantiate( "dq1" );
+	BOOST_REQUIRE( status == fmippOK );
+
+	status = fmu.initialize();
+	BOOST_REQUIRE( status == fmippOK );
+
+	status = fmu.enableCheckpoints( 3 );
+	BOOST_REQUIRE( status == fmippOK );
+
+	fmippTime t = 0.0;
+	fmippTime stepsize = 0.1;
+	fmippTime tstop = 1.0;
+	fmippReal x;
+
+	// Integrate, the initial state is kept as rollback state.
+	fmu.saveCurrentStateForRollback();
+	while ( ( t + stepsize ) - tstop < EPS_TIME ) {
+		t = fmu.integrate( t + stepsize );
+	}
+
+	const CheckpointStore& checkpoints = fmu.getCheckpoints();
+	BOOST_REQUIRE_EQUAL( checkpoints.size(), 3 );
+	BOOST_REQUIRE_EQUAL( checkpoints.nEvictions(), 7 );
+
+	// Rollback to the latest checkpoint before t = 0.85.
+	t = fmu.integrate( 0.85 );
+	BOOST_REQUIRE_MESSAGE( std::abs( t - 0.85 ) < EPS_TIME, "t = " << t );
+	status = fmu.getValue( "x", x );
+	BOOST_REQUIRE_MESSAGE( std::abs( x - std::exp( -0.85 ) ) < 1e-6, "x = " << x );
+	BOOST_REQUIRE_EQUAL( checkpoints.size(), 2 );
+
+	// Rollback to the initial state.
+	t = fmu.integrate( 0.3 );
+	BOOST_REQUIRE_MESSAGE( std::abs( t - 0.3 ) < EPS_TIME, "t = " << t );
+	status = fmu.getValue( "x", x );
+	BOOST_REQUIRE_MESSAGE( std::abs( x - std::exp( -0.3 ) ) < 1e-6, "x = " << x );
+	BOOST_REQUIRE_EQUAL( checkpoints.size(), 1 );
+
+	// Without the rollback state, no rollback before the oldest checkpoint is possible.
+	fmu.releaseRollbackState();
+	for ( t = 0.4; t - 0.9 < EPS_TIME; t += stepsize ) fmu.integrate( t );
+	t = fmu.integrate( 0.2 );
+	BOOST_REQUIRE_MESSAGE( std::abs( t - 0.9 ) < EPS_TIME, "t = " << t );
+}
+
+
+BOOST_AUTO_TEST_CASE( test_delta_checkpoint_store )
+{
+	// Consecutive states differ only in a few bytes.
+	std::vector< std::vector<fmippChar> > states( 20, std::vector<fmippChar>( 1 << 16, 'a' ) );
+	for ( size_t i = 1; i < states.size(); ++i ) {
+		states[i] = states[i-1];
+		states[i][( 997 * i ) % states[i].size()] ^= 0x5a;
+		states[i][( 7919 * i ) % states[i].size()] += 1;
+		if ( 10 == i ) states[i].resize( states[i].size() + 100, 'b' ); // The size may change as well.
+	}
+
+	DeltaCheckpointStore store( 4 );
+	for ( size_t i = 0; i < states.size(); ++i ) store.insert( 0.1 * i, states[i] );
+
+	BOOST_REQUIRE_EQUAL( store.size(), states.size() );
+	BOOST_REQUIRE( store.memory() < store.rawMemory() / 3 );
+
+	// Random access.
+	fmippTime time;
+	std::vector<fmippChar> state;
+	const size_t order[] = { 13, 2, 19, 0, 9, 10, 11, 4 };
+	for ( size_t i : order ) {
+		BOOST_REQUIRE( store.find( 0.1 * i + 0.01, time, state ) );
+		BOOST_REQUIRE_MESSAGE( std::abs( time - 0.1 * i ) < EPS_TIME, "time = " << time );
+		BOOST_REQUIRE_MESSAGE( state == states[i], "checkpoint " << i );
+	}
+
+	// Branch off at t = 0.5.
+	store.insert( 0.55, states[0] );
+	BOOST_REQUIRE_EQUAL( store.size(), 7 );
+	BOOST_REQUIRE( store.find( 1.0, time, state ) );
+	BOOST_REQUIRE( state == states[0] );
+
+	// Move the oldest checkpoints to a spill file.
+	BOOST_REQUIRE( fmippOK == store.setSpillFile( "testRollbackFMU_spill.bin" ) );
+	const fmippSize maxMemory = store.memory() * 3 / 4;
+	store.setMemoryLimit( maxMemory );
+	BOOST_REQUIRE( store.spilledMemory() > 0 );
+	BOOST_REQUIRE_EQUAL( store.size(), 7 );
+	BOOST_REQUIRE( store.find( 0.35, time, state ) );
+	BOOST_REQUIRE( state == states[3] );
+
+	// Without spill file, the oldest checkpoints are evicted.
+	BOOST_REQUIRE( fmippOK == store.setSpillFile( "" ) );
+	BOOST_REQUIRE_EQUAL( store.spilledMemory(), 0 );
+	BOOST_REQUIRE( store.nEvictions() > 0 );
+	BOOST_REQUIRE( store.memory() <= maxMemory );
+	BOOST_REQUIRE( store.find( 0.45, time, state ) );
+	BOOST_REQUIRE( state == states[4] );
+	BOOST_REQUIRE( false == store.find( 0.0, time, state ) );
+}
+
+
+BOOST_AUTO_TEST_CASE( test_delta_checkpoint_store_pinned )
+{
+	std::vector< std::vector<fmippChar> > states( 40, std::vector<fmippChar>( 1 << 12, 'a' ) );
+	for ( size_t i = 1; i < states.size(); ++i ) {
+		states[i] = states[i-1];
+		for ( size_t j = 0; j < 64; ++j ) states[i][( 61 * i + 127 * j ) % states[i].size()] += 1;
+	}
+
+	// The pinned first checkpoint must not stop the eviction of later ones.
+	const fmippSize maxMemory = 3 * states[0].size();
+	DeltaCheckpointStore store( 8, maxMemory );
+	store.insert( 0., states[0], fmippTrue );
+	for ( size_t i = 1; i < states.size(); ++i ) {
+		store.insert( 0.1 * i, states[i] );
+		BOOST_REQUIRE( store.memory() <= maxMemory );
+	}
+
+	BOOST_REQUIRE( store.nEvictions() > 0 );
+
+	fmippTime time;
+	std::vector<fmippChar> state;
+	BOOST_REQUIRE( store.find( 0.05, time, state ) );
+	BOOST_REQUIRE( 0. == time );
+	BOOST_REQUIRE( state == states[0] );
+	BOOST_REQUIRE( store.find( 10., time, state ) );
+	BOOST_REQUIRE( state == states.back() );
+
+	// All remaining checkpoints can still be decoded.
+	for ( size_t i = 1; i < states.size(); ++i ) {
+		if ( false == store.contains( 0.1 * i ) ) continue;
+		BOOST_REQUIRE( store.find( 0.1 * i + 0.01, time, state ) );
+		BOOST_REQUIRE_MESSAGE( state == states[i], "checkpoint " << i );
+	}
+}
+
+
+BOOST_AUTO_TEST_CASE( test_fmu_run_simulation_with_compressed_checkpoints )
+{
+	std::string MODELNAME( "dq" );
+	RollbackFMU fmu( std::string( FMU_URI_PRE ) + "fmusdk_examples/" + MODELNAME, MODELNAME );
+	fmippStatus status = fmu.instantiate( "dq1" );
+	BOOST_REQUIRE( status == fmippOK );
+
+	status = fmu.initialize();
+	BOOST_REQUIRE( status == fmippOK );
+
+	status = fmu.enableCompressedCheckpoints( 4 );
+	BOOST_REQUIRE( status == fmippOK );
+
+	fmippTime t = 0.0;
+	fmippTime stepsize = 0.1;
+	fmippTime tstop = 1.0;
+	fmippReal x;
+
+	while ( ( t + stepsize ) - tstop < EPS_TIME ) {
+		t = fmu.integrate( t + stepsize );
+	}
+
+	const DeltaCheckpointStore& checkpoints = fmu.getCompressedCheckpoints();
+	BOOST_REQUIRE_EQUAL( checkpoints.size(), 10 );
+
+	// Rollback to a checkpoint stored as difference.
+	t = fmu.integrate( 0.65 );
+	BOOST_REQUIRE_MESSAGE( std::abs( t - 0.65 ) < EPS_TIME, "t = " << t );
+	status = fmu.getValue( "x", x );
+	BOOST_REQUIRE_MESSAGE( std::abs( x - std::exp( -0.65 ) ) < 1e-6, "x = " << x );
+	BOOST_REQUIRE_EQUAL( checkpoints.size(), 7 );
+
+	// Rollback to a key frame.
+	t = fmu.integrate( 0.05 );
+	BOOST_REQUIRE_MESSAGE( std::abs( t - 0.05 ) < EPS_TIME, "t = " << t );
+	status = fmu.getValue( "x", x );
+	BOOST_REQUIRE_MESSAGE( std::abs( x - std::exp( -0.05 ) ) < 1e-6, "x = " << x );
+	BOOST_REQUIRE_EQUAL( checkpoints.size(), 1 );
+}
+
+
+#ifndef WIN32
+BOOST_AUTO_TEST_CASE( test_fmu_run_simulation_with_forked_checkpoints )
+{
+	// The FMU cannot get and set its state, its instance runs in a helper process instead.
+	std::string MODELNAME( "zigzag2" );
+	ModelManager::setForkedInstances( MODELNAME, fmippTrue );
+	RollbackFMU fmu( FMU_URI_PRE + MODELNAME, MODELNAME );
+	ModelManager::setForkedInstances( MODELNAME, fmippFalse );
+
+	fmippStatus status = fmu.instantiate( "zigzag2_forked" );
+	BOOST_REQUIRE( status == fmippOK );
+
+	status = fmu.setValue( "k", 1.0 );
+	BOOST_REQUIRE( status == fmippOK );
+
+	status = fmu.initialize();
+	BOOST_REQUIRE( status == fmippOK );
+
+	status = fmu.enableCheckpoints();
+	BOOST_REQUIRE( status == fmippOK );
+
+	fmippTime t = 0.0;
+	fmippTime stepsize = 0.1;
+	fmippTime tstop = 1.5;
+	fmippReal x;
+
+	// Integrate beyond the turning point at x = 1 ( x = t before and x = 2 - t after it ).
+	for ( fmippTime tnext = stepsize; tnext - tstop < EPS_TIME; tnext += stepsize ) {
+		t = fmu.integrate( tnext );
+	}
+
+	BOOST_REQUIRE_MESSAGE( std::abs( t - tstop ) < EPS_TIME, "t = " << t );
+	status = fmu.getValue( "x", x );
+	BOOST_REQUIRE_MESSAGE( std::abs( x - 0.5 ) < 1e-3, "x = " << x );
+
+	// Rollback to a time after the turning point, the direction is restored as well.
+	t = fmu.integrate( 1.25 );
+	BOOST_REQUIRE_MESSAGE( std::abs( t - 1.25 ) < EPS_TIME, "t = " << t );
+	status = fmu.getValue( "x", x );
+	BOOST_REQUIRE_MESSAGE( std::abs( x - 0.75 ) < 1e-3, "x = " << x );
+
+	t = fmu.integrate( 1.35 );
+	status = fmu.getValue( "x", x );
+	BOOST_REQUIRE_MESSAGE( std::abs( x - 0.65 ) < 1e-3, "x = " << x );
+
+	// Branch from a checkpoint before the turning point.
+	t = fmu.integrate( 0.55 );
+	BOOST_REQUIRE_MESSAGE( std::abs( t - 0.55 ) < EPS_TIME, "t = " << t );
+	status = fmu.getValue( "x", x );
+	BOOST_REQUIRE_MESSAGE( std::abs( x - 0.55 ) < 1e-3, "x = " << x );
+
+	t = fmu.integrate( 0.75 );
+	status = fmu.getValue( "x", x );
+	BOOST_REQUIRE_MESSAGE( std::abs( x - 0.75 ) < 1e-3, "x = " << x );
+}
+
+
+namespace {
+
+	/// Count the shared memory segments of the forked instances created by a process.
+	int countForkedSegments( pid_t pid )
+	{
+		std::ostringstream prefix;
+		prefix << "fmipp_forked_" << pid << "_";
+
+		int n = 0;
+		DIR* segments = opendir( "/dev/shm" );
+		if ( 0 == segments ) return 0;
+		while ( dirent* entry = readdir( segments ) )
+			if ( 0 == std::string( entry->d_name ).compare( 0, prefix.str().size(), prefix.str() ) ) ++n;
+		closedir( segments );
+		return n;
+	}
+
+}
+
+BOOST_AUTO_TEST_CASE( test_forked_helpers_exit_with_caller )
+{
+	int result[2];
+	BOOST_REQUIRE_EQUAL( pipe( result ), 0 );
+
+	// A copy of this process creates a forked instance with checkpoints and crashes.
+	pid_t pid = fork();
+	BOOST_REQUIRE( pid >= 0 );
+	if ( 0 == pid ) {
+		std::string MODELNAME( "zigzag2" );
+		ModelManager::setForkedInstances( MODELNAME, fmippTrue );
+		RollbackFMU fmu( FMU_URI_PRE + MODELNAME, MODELNAME );
+
+		char ok = ( fmippOK == fmu.instantiate( "zigzag2_orphaned" ) ) && ( fmippOK == fmu.initialize() ) &&
+			( fmippOK == fmu.enableCheckpoints() ) && ( std::abs( fmu.integrate( 0.5 ) - 0.5 ) < EPS_TIME );
+		if ( 1 != write( result[1], &ok, 1 ) ) _exit( 1 );
+		kill( getpid(), SIGKILL );
+	}
+
+	close( result[1] );
+	char ok = 0;
+	BOOST_CHECK_EQUAL( read( result[0], &ok, 1 ), 1 );
+	close( result[0] );
+	BOOST_REQUIRE_EQUAL( waitpid( pid, 0, 0 ), pid );
+	BOOST_REQUIRE( ok );
+
+	// The orphaned helper processes remove the shared memory segment and exit.
+	for ( int i = 0; ( i < 50 ) && ( countForkedSegments( pid ) > 0 ); ++i )
+		std::this_thread::sleep_for( std::chrono::milliseconds( 100 ) );
+	BOOST_CHECK_EQUAL( countForkedSegments( pid ), 0 );
+}
+
+BOOST_AUTO_TEST_CASE( test_forked_fmu_requires_single_thread )
+{
+	int result[2];
+	BOOST_REQUIRE_EQUAL( pipe( result ), 0 );
+
+	// A copy of this process ( which has not started a server of its own yet ) starts a thread first.
+	pid_t pid = fork();
+	BOOST_REQUIRE( pid >= 0 );
+	if ( 0 == pid ) {
+		int blocker[2];
+		if ( 0 != pipe( blocker ) ) _exit( 1 );
+		std::thread thread( [&blocker]() { char c; if ( read( blocker[0], &c, 1 ) ) {} } );
+
+		std::string MODELNAME( "zigzag2" );
+		FMUType type = invalid;
+		std::string modelIdentifier;
+		ModelManager::loadFMU( FMU_URI_PRE + MODELNAME, fmippFalse, type, modelIdentifier );
+
+		char started = ForkedFMU::startForkServer() ? 1 : 0;
+		ModelManager::setForkedInstances( MODELNAME, fmippTrue );
+		char forked = ModelManager::getInstance( MODELNAME ) ? 1 : 0;
+
+		close( blocker[1] );
+		thread.join();
+
+		// The server can be started once the thread has terminated.
+		char forkedLater = ModelManager::getInstance( MODELNAME ) ? 1 : 0;
+
+		const char answer[] = { started, forked, forkedLater };
+		_exit( ( 3 == write( result[1], answer, 3 ) ) ? 0 : 1 );
+	}
+
+	close( result[1] );
+	char answer[3] = { 1, 1, 0 };
+	BOOST_CHECK_EQUAL( read( result[0], answer, 3 ), 3 );
+	close( result[0] );
+	BOOST_REQUIRE_EQUAL( waitpid( pid, 0, 0 ), pid );
+
+	BOOST_CHECK_EQUAL( answer[0], 0 );
+	BOOST_CHECK_EQUAL( answer[1], 0 );
+	BOOST_CHECK_EQUAL( answer[2], 1 );
+}
+#endif